@@ -17,96 +17,53 @@
 
 #import <AudioToolbox/AudioConverter.h>
 #import <StubReturn.h>
-#import <NSBundleInternal.h>
-#import <NSLogging.h>
 #import "AssertARCEnabled.h"
 
-static const wchar_t* TAG = L"AudioConverter";
-
 #import <AudioToolbox/AudioConverterInternal.h>
+#include "AudioConverterPipeline.h"
 
+@implementation AudioConverter {
+    std::unique_ptr<AudioConverterPipeline> _pipeline;
+}
 
-@implementation AudioConverter
-- (instancetype)initWithSourceFormat:(const AudioStreamBasicDescription*)srcFormat
-                   destinationFormat:(const AudioStreamBasicDescription*)destFormat {
+- (instancetype)initWithPipeline:(std::unique_ptr<AudioConverterPipeline>)pipeline {
     if (self = [super init]) {
-        ComPtr<IUnknown> spTransformUnk;
-
-        RETURN_NIL_IF_FAILED(
-            CoCreateInstance(CLSID_AudioResamplerMediaObject, nullptr, CLSCTX_INPROC_SERVER, IID_IUnknown, (void**)&spTransformUnk));
-
-        RETURN_NIL_IF_FAILED(spTransformUnk.As(&_transform));
-
-        _sizeChangeMultiplier =
-            (destFormat->mSampleRate * destFormat->mBytesPerFrame) / (srcFormat->mSampleRate * srcFormat->mBytesPerFrame);
+        _pipeline = std::move(pipeline);
     }
 
     return self;
 }
 
-- (ComPtr<IMFTransform>)getTransform {
-    return _transform;
+- (AudioConverterPipeline*)pipeline {
+    return _pipeline.get();
 }
+@end
 
-- (float)getSizeChangeMultiplier {
-    return _sizeChangeMultiplier;
+static AudioConverterPipeline* _getPipeline(AudioConverterRef converter) {
+    return [(__bridge AudioConverter*)converter pipeline];
 }
-@end
 
 /**
- @Status Caveat
- @Notes AudioConverter supported only for conversions through AudioConverterConvertBuffer. 
-        Returns kAudioConverterErr_UnspecifiedError on failure and noErr (0) on success. Other return types not supported.
+ @Status Interoperable
 */
 OSStatus AudioConverterDispose(AudioConverterRef inAudioConverter) {
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFShutdown(), @"MFShutdown Failed");
-    CFBridgingRelease(inAudioConverter);
-    return noErr;
-}
-
-OSStatus _setMFProperties(const AudioStreamBasicDescription* format, IMFMediaType** mediaType) {
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFCreateMediaType(mediaType), @"MFCreateMediaType failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio), @"Setting the major type failed");
-
-    if (format->mFormatFlags & kAudioFormatFlagIsFloat) {
-        RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_Float), @"Setting the subtype failed");
-    } else {
-        RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM), @"Setting the subtype failed");
+    if (inAudioConverter == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
     }
 
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetUINT32(MF_MT_AUDIO_NUM_CHANNELS, format->mChannelsPerFrame),
-                                       @"Setting the number of audio channels failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetUINT32(MF_MT_AUDIO_SAMPLES_PER_SECOND, format->mSampleRate),
-                                       @"Setting the number of audio samples per second failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetUINT32(MF_MT_AUDIO_BLOCK_ALIGNMENT, format->mBytesPerFrame),
-                                       @"Setting the block alignment failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)
-                                           ->SetUINT32(MF_MT_AUDIO_AVG_BYTES_PER_SECOND, format->mSampleRate * format->mBytesPerFrame),
-                                       @"Setting the average number of bytes per second failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, format->mBitsPerChannel),
-                                       @"Setting the number of bits per audio sample failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG((*mediaType)->SetUINT32(MF_MT_ALL_SAMPLES_INDEPENDENT, TRUE),
-                                       @"Setting the audio sample independent flag failed");
-
+    CFBridgingRelease(inAudioConverter);
     return noErr;
 }
 
 /**
 @Status Caveat
-@Notes AudioConverter supported only for conversions through AudioConverterConvertBuffer.
-       Only Linear PCM formats are supported with 1 Frame per Packet and equal source & destination Channels per Frame.
-       Returns kAudioConverterErr_UnspecifiedError on failure and noErr (0) on success. Other return types not supported.
+@Notes Only packed linear PCM formats with 1 Frame per Packet are supported. Conversions between sample formats, bit depths,
+       interleaving, channel counts and sample rates run in-process.
 */
 OSStatus AudioConverterNew(const AudioStreamBasicDescription* inSourceFormat,
                            const AudioStreamBasicDescription* inDestinationFormat,
                            AudioConverterRef _Nullable* outAudioConverter) {
-    if (inSourceFormat == nullptr || inDestinationFormat == nullptr) {
+    if (inSourceFormat == nullptr || inDestinationFormat == nullptr || outAudioConverter == nullptr) {
         return kAudioConverterErr_UnspecifiedError;
     }
 
@@ -115,41 +72,13 @@ OSStatus AudioConverterNew(const AudioStreamBasicDescription* inSourceFormat,
         return StubReturn();
     }
 
-    if (inSourceFormat->mChannelsPerFrame != inDestinationFormat->mChannelsPerFrame) {
-        UNIMPLEMENTED();
-        return StubReturn();
-    }
-
-    if (inSourceFormat->mFramesPerPacket != 1 || inSourceFormat->mFramesPerPacket != inDestinationFormat->mFramesPerPacket) {
-        UNIMPLEMENTED();
-        return StubReturn();
+    std::unique_ptr<AudioConverterPipeline> pipeline;
+    OSStatus status = AudioConverterPipeline::Create(*inSourceFormat, *inDestinationFormat, &pipeline);
+    if (status != noErr) {
+        return status;
     }
 
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFStartup(MF_VERSION, MFSTARTUP_NOSOCKET), @"MFStartup Failed");
-
-    AudioConverter* outConverter = [[AudioConverter alloc] initWithSourceFormat:inSourceFormat destinationFormat:inDestinationFormat];
-
-    ComPtr<IMFTransform> mediaTransform = [outConverter getTransform];
-
-    ComPtr<IMFMediaType> sourceMediaType;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(_setMFProperties(inSourceFormat, &sourceMediaType), @"Creating source mediatype Failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->SetInputType(0, sourceMediaType.Get(), 0), @"MFTransform InputStream Failed");
-
-    ComPtr<IMFMediaType> destinationMediaType;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(_setMFProperties(inDestinationFormat, &destinationMediaType),
-                                       @"Creating destination mediatype Failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->SetOutputType(0, destinationMediaType.Get(), 0), @"MFTransform OutputStream Failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_COMMAND_FLUSH, NULL), @"MFTransform Flush Failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_BEGIN_STREAMING, NULL),
-                                       @"MFTransform Begin Streaming Failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_START_OF_STREAM, NULL),
-                                       @"MFTransform Start Streaming Failed");
-
+    AudioConverter* outConverter = [[AudioConverter alloc] initWithPipeline:std::move(pipeline)];
     *outAudioConverter = (AudioConverterRef)CFBridgingRetain(outConverter);
     return noErr;
 }
@@ -168,53 +97,68 @@ OSStatus AudioConverterNewSpecific(const AudioStreamBasicDescription* inSourceFo
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 OSStatus AudioConverterReset(AudioConverterRef inAudioConverter) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    _getPipeline(inAudioConverter)->Reset();
+    return noErr;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Supports the stream descriptions, sample rate converter quality and complexity, channel map, maximum packet sizes
+        and buffer size calculations.
 */
 OSStatus AudioConverterGetProperty(AudioConverterRef inAudioConverter,
                                    AudioConverterPropertyID inPropertyID,
                                    UInt32* ioPropertyDataSize,
                                    void* outPropertyData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    return _getPipeline(inAudioConverter)->GetProperty(inPropertyID, ioPropertyDataSize, outPropertyData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes See AudioConverterGetProperty for the supported properties.
 */
 OSStatus AudioConverterGetPropertyInfo(AudioConverterRef inAudioConverter,
                                        AudioConverterPropertyID inPropertyID,
                                        UInt32* outSize,
                                        Boolean* outWritable) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    return _getPipeline(inAudioConverter)->GetPropertyInfo(inPropertyID, outSize, outWritable);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Supports kAudioConverterSampleRateConverterQuality, kAudioConverterSampleRateConverterComplexity and kAudioConverterChannelMap.
+        Setting one resets the converter.
 */
 OSStatus AudioConverterSetProperty(AudioConverterRef inAudioConverter,
                                    AudioConverterPropertyID inPropertyID,
                                    UInt32 inPropertyDataSize,
                                    const void* inPropertyData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    return _getPipeline(inAudioConverter)->SetProperty(inPropertyID, inPropertyDataSize, inPropertyData);
 }
 
 /**
  @Status Caveat
- @Notes Returns kAudioConverterErr_UnspecifiedError, kAudioConverterErr_InvalidInputSize or
+ @Notes Only interleaved formats. A sample rate change converts each buffer as a complete signal.
+        Returns kAudioConverterErr_UnspecifiedError, kAudioConverterErr_InvalidInputSize or
         kAudioConverterErr_InvalidOutputSize on failure and noErr (0) on success. Other return types not supported.
 */
 OSStatus AudioConverterConvertBuffer(
@@ -227,95 +171,17 @@ OSStatus AudioConverterConvertBuffer(
         return kAudioConverterErr_InvalidInputSize;
     }
 
-    float multiplier = [(__bridge AudioConverter*)inAudioConverter getSizeChangeMultiplier];
-    if (outOutputData == nullptr || ioOutputDataSize == 0 || *ioOutputDataSize < ceil(float(inInputDataSize) * multiplier)) {
+    if (outOutputData == nullptr || ioOutputDataSize == nullptr) {
         return kAudioConverterErr_InvalidOutputSize;
     }
 
-    ComPtr<IMFMediaBuffer> mediaBufferIn = nullptr;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFCreateMemoryBuffer(inInputDataSize, &mediaBufferIn), @"Temp buffer creation failed");
-
-    BYTE* byteBufferIn = nullptr;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaBufferIn->Lock(&byteBufferIn, nullptr, nullptr), @"Buffer Lock failed");
-
-    memcpy(byteBufferIn, inInputData, inInputDataSize);
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaBufferIn->Unlock(), @"Buffer Unlock failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaBufferIn->SetCurrentLength(inInputDataSize), @"Set Length failed");
-
-    ComPtr<IMFSample> sampleIn = nullptr;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFCreateSample(&sampleIn), @"MFSample creation failed");
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(sampleIn->AddBuffer(mediaBufferIn.Get()), @"Buffer Addition failed");
-
-    ComPtr<IMFTransform> mediaTransform = [(__bridge AudioConverter*)inAudioConverter getTransform];
-
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessInput(0, sampleIn.Get(), 0), @"Input processing failed");
-
-    // Create the output sample
-    ComPtr<IMFSample> sampleOut = NULL;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFCreateSample(&sampleOut), @"Output sample creation failed");
-
-    // Create a buffer for the output sample
-    ComPtr<IMFMediaBuffer> bufferOut = NULL;
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(MFCreateMemoryBuffer(*ioOutputDataSize, &bufferOut), @"Output buffer creation failed");
-
-    // Add the output buffer
-    RETURN_AUDIOERR_IF_FAILED_WITH_MSG(sampleOut->AddBuffer(bufferOut.Get()), @"Adding output buffer failed");
-
-    // Starting the counter for number of bytes written to "outOutputData"
-    *ioOutputDataSize = 0;
-    bool drainFlag = false;
-    MFT_OUTPUT_DATA_BUFFER dataBuffer;
-    dataBuffer.pSample = sampleOut.Get();
-    dataBuffer.dwStreamID = 0;
-    dataBuffer.dwStatus = 0;
-    dataBuffer.pEvents = NULL;
-    DWORD outputStatus;
-
-    for (;;) {
-        HRESULT status = mediaTransform->ProcessOutput(0, 1, &dataBuffer, &outputStatus);
-
-        // State 0: All of the Input data has been processed. There may still be some Output data yet to be processed.
-        if (status == MF_E_TRANSFORM_NEED_MORE_INPUT && drainFlag == false) {
-            RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_OF_STREAM, NULL),
-                                               @"End Stream notification failed");
-
-            RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_COMMAND_DRAIN, NULL),
-                                               @"Drain notification failed");
-
-            drainFlag = true;
-            continue;
-        }
-
-        // State 1: The remaining Output data has been processed.
-        if (status == MF_E_TRANSFORM_NEED_MORE_INPUT && drainFlag == true) {
-            RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaTransform->ProcessMessage(MFT_MESSAGE_NOTIFY_END_STREAMING, NULL),
-                                               @"Nearing-End Stream notification failed");
-            break;
-        }
-
-        ComPtr<IMFMediaBuffer> mediaBufferOut;
-        RETURN_AUDIOERR_IF_FAILED_WITH_MSG(sampleOut->ConvertToContiguousBuffer(&mediaBufferOut), @"Buffer conversion failed");
-
-        DWORD outputBytes = 0;
-        mediaBufferOut->GetCurrentLength(&outputBytes);
-
-        BYTE* outputByteBuffer = nullptr;
-        RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaBufferOut->Lock(&outputByteBuffer, nullptr, nullptr), @"Output Buffer Lock failed");
-
-        memcpy(static_cast<BYTE*>(outOutputData) + *ioOutputDataSize, outputByteBuffer, outputBytes);
-        *ioOutputDataSize += outputBytes;
-
-        RETURN_AUDIOERR_IF_FAILED_WITH_MSG(mediaBufferOut->Unlock(), @"Output Buffer Unlock failed");
-    }
-
-    return noErr;
+    return _getPipeline(inAudioConverter)->ConvertBuffer(inInputDataSize, inInputData, ioOutputDataSize, outOutputData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Linear PCM only, so outPacketDescription is not used. Input is pulled as the output needs it and read in place from the
+        buffers the callback supplies.
 */
 OSStatus AudioConverterFillComplexBuffer(AudioConverterRef inAudioConverter,
                                          AudioConverterComplexInputDataProc inInputDataProc,
@@ -323,18 +189,25 @@ OSStatus AudioConverterFillComplexBuffer(AudioConverterRef inAudioConverter,
                                          UInt32* ioOutputDataPacketSize,
                                          AudioBufferList* outOutputData,
                                          AudioStreamPacketDescription* outPacketDescription) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr || inInputDataProc == nullptr || ioOutputDataPacketSize == nullptr || outOutputData == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    return _getPipeline(inAudioConverter)
+        ->FillComplexBuffer(inAudioConverter, inInputDataProc, inInputDataProcUserData, ioOutputDataPacketSize, outOutputData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes As on the reference platform, sample rate conversion is not supported.
 */
 OSStatus AudioConverterConvertComplexBuffer(AudioConverterRef inAudioConverter,
                                             UInt32 inNumberPCMFrames,
                                             const AudioBufferList* inInputData,
                                             AudioBufferList* outOutputData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (inAudioConverter == nullptr || inInputData == nullptr || outOutputData == nullptr) {
+        return kAudioConverterErr_UnspecifiedError;
+    }
+
+    return _getPipeline(inAudioConverter)->ConvertComplexBuffer(inNumberPCMFrames, inInputData, outOutputData);
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <AudioToolbox/AudioConverter.h>
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+// How one side of a conversion lays out linear PCM samples in an AudioBufferList.
+struct AudioPCMLayout {
+    enum SampleType { SignedInteger, UnsignedInteger, Float };
+
+    SampleType sampleType;
+    bool bigEndian;
+    bool interleaved;
+    uint32_t bytesPerSample;
+    uint32_t channels;
+    double sampleRate;
+
+    // Bytes between consecutive frames within one buffer.
+    uint32_t BufferFrameStride() const {
+        return interleaved ? bytesPerSample * channels : bytesPerSample;
+    }
+
+    uint32_t BufferCount() const {
+        return interleaved ? 1 : channels;
+    }
+
+    bool HasSameSamples(const AudioPCMLayout& other) const;
+
+    // Returns false for anything other than packed linear PCM with one frame per packet.
+    static bool FromDescription(const AudioStreamBasicDescription& description, AudioPCMLayout* layout);
+};
+
+// Fixed matrix from input channels to output channels.
+class AudioChannelMixer {
+public:
+    AudioChannelMixer() : _inputChannels(0), _outputChannels(0), _identity(true) {
+    }
+
+    // Mono is copied to the first two outputs, anything mixed down to mono is averaged, and otherwise channels map one to one.
+    void SetDefault(uint32_t inputChannels, uint32_t outputChannels);
+
+    // map[out] names the input channel for each output channel, or -1 for silence.
+    void SetChannelMap(uint32_t inputChannels, const std::vector<SInt32>& map);
+
+    bool IsIdentity() const {
+        return _identity;
+    }
+
+    void Mix(const float* const* input, float* const* output, uint32_t frames) const;
+
+private:
+    void _UpdateIdentity();
+
+    uint32_t _inputChannels;
+    uint32_t _outputChannels;
+    std::vector<float> _matrix;
+    bool _identity;
+};
+
+// Streaming polyphase windowed-sinc sample rate converter over planar float channels. Each output frame is centered on
+// its input time, so nothing needs priming and N input frames yield ceil(N * outputRate / inputRate) output frames.
+class AudioResampler {
+public:
+    AudioResampler(uint32_t channels, double inputRate, double outputRate, UInt32 quality, UInt32 complexity);
+
+    // Makes room for frames more input frames. InputEnd(channel) then points at where they go.
+    void ReserveInput(uint32_t frames);
+    float* InputEnd(uint32_t channel) {
+        return _history[channel].data() + _buffered;
+    }
+    void CommitInput(uint32_t frames);
+
+    // Marks the end of the input so that the last output frames can be produced.
+    void EndInput();
+
+    // Produces up to frames output frames from the input buffered so far.
+    uint32_t Produce(float* const* output, uint32_t frames);
+
+    void Reset();
+
+    uint64_t OutputFramesFor(uint64_t inputFrames) const;
+
+    // Taps per output frame, which bounds the input that has to be buffered ahead of the output.
+    uint32_t Taps() const {
+        return _taps;
+    }
+
+private:
+    void _BuildFilter(UInt32 quality, UInt32 complexity, double inputRate, double outputRate);
+
+    uint32_t _channels;
+    uint64_t _step;
+    uint32_t _taps;
+    uint32_t _phases;
+    std::vector<float> _filter;
+
+    std::vector<std::vector<float>> _history;
+    uint32_t _buffered;
+    uint64_t _time;
+    uint64_t _inputFrames;
+    uint64_t _outputFrames;
+    uint64_t _outputLimit;
+    bool _ended;
+};
+
+// In-process linear PCM conversion: sample format and bit depth, interleaving, channel mixing and sample rate.
+class AudioConverterPipeline {
+public:
+    static OSStatus Create(const AudioStreamBasicDescription& source,
+                           const AudioStreamBasicDescription& destination,
+                           std::unique_ptr<AudioConverterPipeline>* pipeline);
+
+    void Reset();
+
+    OSStatus GetPropertyInfo(AudioConverterPropertyID propertyID, UInt32* size, Boolean* writable);
+    OSStatus GetProperty(AudioConverterPropertyID propertyID, UInt32* ioSize, void* data);
+    OSStatus SetProperty(AudioConverterPropertyID propertyID, UInt32 size, const void* data);
+
+    OSStatus ConvertBuffer(UInt32 inputSize, const void* input, UInt32* ioOutputSize, void* output);
+    OSStatus ConvertComplexBuffer(UInt32 frames, const AudioBufferList* input, AudioBufferList* output);
+    OSStatus FillComplexBuffer(AudioConverterRef converter,
+                               AudioConverterComplexInputDataProc inputProc,
+                               void* userData,
+                               UInt32* ioOutputPackets,
+                               AudioBufferList* output);
+
+private:
+    AudioConverterPipeline(const AudioStreamBasicDescription& source,
+                           const AudioStreamBasicDescription& destination,
+                           const AudioPCMLayout& sourceLayout,
+                           const AudioPCMLayout& destinationLayout);
+
+    void _Configure();
+    void _Convert(const AudioBufferList& input, uint32_t inputFrame, AudioBufferList& output, uint32_t outputFrame, uint32_t frames);
+    void _PushInput(const AudioBufferList& input, uint32_t inputFrame, uint32_t frames);
+    uint32_t _ProduceOutput(AudioBufferList& output, uint32_t outputFrame, uint32_t frames);
+
+    AudioStreamBasicDescription _sourceDescription;
+    AudioStreamBasicDescription _destinationDescription;
+    AudioPCMLayout _source;
+    AudioPCMLayout _destination;
+    UInt32 _quality;
+    UInt32 _complexity;
+    std::vector<SInt32> _channelMap;
+
+    AudioChannelMixer _mixer;
+    std::unique_ptr<AudioResampler> _resampler;
+    bool _mixBeforeResampling;
+    bool _passthrough;
+
+    // Planar blocks for the source and destination channels.
+    std::vector<float> _sourceBlock;
+    std::vector<float> _destinationBlock;
+
+    // Input handed over by the last FillComplexBuffer callback and not yet consumed.
+    std::vector<uint8_t> _pendingStorage;
+    uint32_t _pendingFrame;
+    uint32_t _pendingFrames;
+    bool _endOfInput;
+};
@@ -0,0 +1,1113 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "AudioConverterPipeline.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define AUDIO_CONVERTER_SSE2 1
+#include <emmintrin.h>
+#elif defined(_M_ARM) || defined(__ARM_NEON)
+#define AUDIO_CONVERTER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const uint32_t c_blockFrames = 256;
+const uint32_t c_filterPhases = 256;
+// Bounds the filter, and so the work per output frame, at extreme downsampling ratios.
+const uint32_t c_maxFilterTaps = 1024;
+const double c_fixedPointOne = 4294967296.0;
+
+//
+// Sample format conversion. Samples are floats in [-1, 1) while in flight.
+//
+
+inline uint32_t _LoadRaw(const uint8_t* sample, uint32_t bytes, bool bigEndian) {
+    uint32_t raw = 0;
+    for (uint32_t i = 0; i < bytes; ++i) {
+        raw |= uint32_t(sample[bigEndian ? bytes - 1 - i : i]) << (8 * i);
+    }
+    return raw;
+}
+
+inline void _StoreRaw(uint8_t* sample, uint32_t bytes, bool bigEndian, uint32_t raw) {
+    for (uint32_t i = 0; i < bytes; ++i) {
+        sample[bigEndian ? bytes - 1 - i : i] = static_cast<uint8_t>(raw >> (8 * i));
+    }
+}
+
+// Rounds to nearest even, matching the vector conversions.
+inline int32_t _RoundToInt(double value) {
+    return static_cast<int32_t>(std::nearbyint(value));
+}
+
+void _Int16ToFloat(const int16_t* input, float* output, uint32_t count) {
+    const float scale = 1.0f / 32768.0f;
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scaleVector));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scaleVector));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t samples = vld1q_s16(input + i);
+        vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+        vst1q_f32(output + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = input[i] * scale;
+    }
+}
+
+void _DeinterleaveInt16Stereo(const int16_t* input, float* left, float* right, uint32_t frames) {
+    const float scale = 1.0f / 32768.0f;
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    for (; i + 4 <= frames; i += 4) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 2 * i));
+        __m128i even = _mm_srai_epi32(_mm_slli_epi32(samples, 16), 16);
+        __m128i odd = _mm_srai_epi32(samples, 16);
+        _mm_storeu_ps(left + i, _mm_mul_ps(_mm_cvtepi32_ps(even), scaleVector));
+        _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(odd), scaleVector));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        int16x4x2_t samples = vld2_s16(input + 2 * i);
+        vst1q_f32(left + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(samples.val[0])), scale));
+        vst1q_f32(right + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(samples.val[1])), scale));
+    }
+#endif
+    for (; i < frames; ++i) {
+        left[i] = input[2 * i] * scale;
+        right[i] = input[2 * i + 1] * scale;
+    }
+}
+
+#if defined(AUDIO_CONVERTER_SSE2)
+inline __m128i _FloatToInt32x4(__m128 samples) {
+    samples = _mm_mul_ps(samples, _mm_set1_ps(32768.0f));
+    samples = _mm_min_ps(_mm_max_ps(samples, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    return _mm_cvtps_epi32(samples);
+}
+#elif defined(AUDIO_CONVERTER_NEON)
+// ARMv7 has no rounding float to integer conversion, so round by adding 1.5 * 2^23, which leaves the nearest even
+// integer in the low mantissa bits.
+inline int32x4_t _FloatToInt32x4(float32x4_t samples) {
+    samples = vmulq_n_f32(samples, 32768.0f);
+    samples = vminq_f32(vmaxq_f32(samples, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f));
+    const float32x4_t magic = vdupq_n_f32(12582912.0f);
+    return vsubq_s32(vreinterpretq_s32_f32(vaddq_f32(samples, magic)), vreinterpretq_s32_f32(magic));
+}
+#endif
+
+inline int16_t _FloatToInt16(float sample) {
+    return static_cast<int16_t>(_RoundToInt(std::min(std::max(sample * 32768.0f, -32768.0f), 32767.0f)));
+}
+
+void _FloatToInt16(const float* input, int16_t* output, uint32_t count) {
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = _FloatToInt32x4(_mm_loadu_ps(input + i));
+        __m128i high = _FloatToInt32x4(_mm_loadu_ps(input + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(low, high));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16x4_t low = vqmovn_s32(_FloatToInt32x4(vld1q_f32(input + i)));
+        int16x4_t high = vqmovn_s32(_FloatToInt32x4(vld1q_f32(input + i + 4)));
+        vst1q_s16(output + i, vcombine_s16(low, high));
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = _FloatToInt16(input[i]);
+    }
+}
+
+void _InterleaveInt16Stereo(const float* left, const float* right, int16_t* output, uint32_t frames) {
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    for (; i + 4 <= frames; i += 4) {
+        __m128i l = _FloatToInt32x4(_mm_loadu_ps(left + i));
+        __m128i r = _FloatToInt32x4(_mm_loadu_ps(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * i), _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        int16x4x2_t samples;
+        samples.val[0] = vqmovn_s32(_FloatToInt32x4(vld1q_f32(left + i)));
+        samples.val[1] = vqmovn_s32(_FloatToInt32x4(vld1q_f32(right + i)));
+        vst2_s16(output + 2 * i, samples);
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[2 * i] = _FloatToInt16(left[i]);
+        output[2 * i + 1] = _FloatToInt16(right[i]);
+    }
+}
+
+void _DeinterleaveFloatStereo(const float* input, float* left, float* right, uint32_t frames) {
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(input + 2 * i);
+        __m128 b = _mm_loadu_ps(input + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t samples = vld2q_f32(input + 2 * i);
+        vst1q_f32(left + i, samples.val[0]);
+        vst1q_f32(right + i, samples.val[1]);
+    }
+#endif
+    for (; i < frames; ++i) {
+        left[i] = input[2 * i];
+        right[i] = input[2 * i + 1];
+    }
+}
+
+void _InterleaveFloatStereo(const float* left, const float* right, float* output, uint32_t frames) {
+    uint32_t i = 0;
+#if defined(AUDIO_CONVERTER_SSE2)
+    for (; i + 4 <= frames; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(output + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(output + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif defined(AUDIO_CONVERTER_NEON)
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t samples = { { vld1q_f32(left + i), vld1q_f32(right + i) } };
+        vst2q_f32(output + 2 * i, samples);
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[2 * i] = left[i];
+        output[2 * i + 1] = right[i];
+    }
+}
+
+// Any packed integer or float sample, one at a time.
+void _DecodeStrided(const AudioPCMLayout& layout, const uint8_t* input, uint32_t stride, uint32_t frames, float* output) {
+    uint32_t bytes = layout.bytesPerSample;
+    if (layout.sampleType == AudioPCMLayout::Float) {
+        for (uint32_t i = 0; i < frames; ++i, input += stride) {
+            if (bytes == 4) {
+                uint32_t raw = _LoadRaw(input, 4, layout.bigEndian);
+                float sample;
+                memcpy(&sample, &raw, sizeof(sample));
+                output[i] = sample;
+            } else {
+                uint64_t raw = uint64_t(_LoadRaw(input, 4, layout.bigEndian)) | (uint64_t(_LoadRaw(input + 4, 4, layout.bigEndian)) << 32);
+                if (layout.bigEndian) {
+                    raw = (raw << 32) | (raw >> 32);
+                }
+                double sample;
+                memcpy(&sample, &raw, sizeof(sample));
+                output[i] = static_cast<float>(sample);
+            }
+        }
+        return;
+    }
+
+    // Align every integer width to the top of an int32 so that one scale fits all.
+    uint32_t shift = 32 - 8 * bytes;
+    uint32_t signFlip = (layout.sampleType == AudioPCMLayout::UnsignedInteger) ? (1u << (8 * bytes - 1)) : 0;
+    for (uint32_t i = 0; i < frames; ++i, input += stride) {
+        int32_t aligned = static_cast<int32_t>((_LoadRaw(input, bytes, layout.bigEndian) ^ signFlip) << shift);
+        output[i] = static_cast<float>(aligned * (1.0 / 2147483648.0));
+    }
+}
+
+void _EncodeStrided(const AudioPCMLayout& layout, const float* input, uint32_t frames, uint8_t* output, uint32_t stride) {
+    uint32_t bytes = layout.bytesPerSample;
+    if (layout.sampleType == AudioPCMLayout::Float) {
+        for (uint32_t i = 0; i < frames; ++i, output += stride) {
+            if (bytes == 4) {
+                uint32_t raw;
+                memcpy(&raw, &input[i], sizeof(raw));
+                _StoreRaw(output, 4, layout.bigEndian, raw);
+            } else {
+                double sample = input[i];
+                uint64_t raw;
+                memcpy(&raw, &sample, sizeof(raw));
+                if (layout.bigEndian) {
+                    raw = (raw << 32) | (raw >> 32);
+                }
+                _StoreRaw(output, 4, layout.bigEndian, static_cast<uint32_t>(raw));
+                _StoreRaw(output + 4, 4, layout.bigEndian, static_cast<uint32_t>(raw >> 32));
+            }
+        }
+        return;
+    }
+
+    double scale = double(1u << (8 * bytes - 1));
+    double minimum = -scale;
+    double maximum = scale - 1.0;
+    uint32_t mask = (bytes == 4) ? 0xFFFFFFFF : ((1u << (8 * bytes)) - 1);
+    uint32_t signFlip = (layout.sampleType == AudioPCMLayout::UnsignedInteger) ? (1u << (8 * bytes - 1)) : 0;
+    for (uint32_t i = 0; i < frames; ++i, output += stride) {
+        int32_t value = _RoundToInt(std::min(std::max(input[i] * scale, minimum), maximum));
+        _StoreRaw(output, bytes, layout.bigEndian, (static_cast<uint32_t>(value) & mask) ^ signFlip);
+    }
+}
+
+inline bool _IsNativeInt16(const AudioPCMLayout& layout) {
+    return layout.sampleType == AudioPCMLayout::SignedInteger && layout.bytesPerSample == 2 && !layout.bigEndian;
+}
+
+inline bool _IsNativeFloat32(const AudioPCMLayout& layout) {
+    return layout.sampleType == AudioPCMLayout::Float && layout.bytesPerSample == 4 && !layout.bigEndian;
+}
+
+inline uint8_t* _BufferData(const AudioBufferList& buffers, const AudioPCMLayout& layout, uint32_t channel, uint32_t frame) {
+    const AudioBuffer& buffer = buffers.mBuffers[layout.interleaved ? 0 : channel];
+    return static_cast<uint8_t*>(buffer.mData) + frame * layout.BufferFrameStride() + (layout.interleaved ? channel * layout.bytesPerSample : 0);
+}
+
+void _DecodePCM(const AudioPCMLayout& layout, const AudioBufferList& buffers, uint32_t firstFrame, uint32_t frames, float* const* planes) {
+    if (layout.interleaved && layout.channels == 2) {
+        const void* input = _BufferData(buffers, layout, 0, firstFrame);
+        if (_IsNativeInt16(layout)) {
+            _DeinterleaveInt16Stereo(static_cast<const int16_t*>(input), planes[0], planes[1], frames);
+            return;
+        }
+        if (_IsNativeFloat32(layout)) {
+            _DeinterleaveFloatStereo(static_cast<const float*>(input), planes[0], planes[1], frames);
+            return;
+        }
+    }
+
+    bool contiguous = !layout.interleaved || layout.channels == 1;
+    for (uint32_t channel = 0; channel < layout.channels; ++channel) {
+        const uint8_t* input = _BufferData(buffers, layout, channel, firstFrame);
+        if (contiguous && _IsNativeInt16(layout)) {
+            _Int16ToFloat(reinterpret_cast<const int16_t*>(input), planes[channel], frames);
+        } else if (contiguous && _IsNativeFloat32(layout)) {
+            memcpy(planes[channel], input, frames * sizeof(float));
+        } else {
+            _DecodeStrided(layout, input, layout.BufferFrameStride(), frames, planes[channel]);
+        }
+    }
+}
+
+void _EncodePCM(const AudioPCMLayout& layout, const float* const* planes, uint32_t frames, AudioBufferList& buffers, uint32_t firstFrame) {
+    if (layout.interleaved && layout.channels == 2) {
+        void* output = _BufferData(buffers, layout, 0, firstFrame);
+        if (_IsNativeInt16(layout)) {
+            _InterleaveInt16Stereo(planes[0], planes[1], static_cast<int16_t*>(output), frames);
+            return;
+        }
+        if (_IsNativeFloat32(layout)) {
+            _InterleaveFloatStereo(planes[0], planes[1], static_cast<float*>(output), frames);
+            return;
+        }
+    }
+
+    bool contiguous = !layout.interleaved || layout.channels == 1;
+    for (uint32_t channel = 0; channel < layout.channels; ++channel) {
+        uint8_t* output = _BufferData(buffers, layout, channel, firstFrame);
+        if (contiguous && _IsNativeInt16(layout)) {
+            _FloatToInt16(planes[channel], reinterpret_cast<int16_t*>(output), frames);
+        } else if (contiguous && _IsNativeFloat32(layout)) {
+            memcpy(output, planes[channel], frames * sizeof(float));
+        } else {
+            _EncodeStrided(layout, planes[channel], frames, output, layout.BufferFrameStride());
+        }
+    }
+}
+
+// Frames each buffer of the list has room for, or holds.
+uint32_t _BufferListFrames(const AudioPCMLayout& layout, const AudioBufferList& buffers) {
+    if (buffers.mNumberBuffers < layout.BufferCount()) {
+        return 0;
+    }
+
+    uint32_t frames = UINT32_MAX;
+    for (uint32_t i = 0; i < layout.BufferCount(); ++i) {
+        if (!buffers.mBuffers[i].mData) {
+            return 0;
+        }
+        frames = std::min(frames, buffers.mBuffers[i].mDataByteSize / layout.BufferFrameStride());
+    }
+    return frames;
+}
+
+void _SetBufferListFrames(const AudioPCMLayout& layout, AudioBufferList& buffers, uint32_t frames) {
+    for (uint32_t i = 0; i < layout.BufferCount(); ++i) {
+        buffers.mBuffers[i].mDataByteSize = frames * layout.BufferFrameStride();
+    }
+}
+
+//
+// Resampling filter
+//
+
+double _BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Dot products of samples against two adjacent filter phases, blended by fraction.
+inline float _InterpolatedDot(const float* samples, const float* phase, const float* nextPhase, uint32_t taps, float fraction) {
+    uint32_t k = 0;
+    float a = 0.0f;
+    float b = 0.0f;
+#if defined(AUDIO_CONVERTER_SSE2)
+    __m128 sumA = _mm_setzero_ps();
+    __m128 sumB = _mm_setzero_ps();
+    for (; k + 4 <= taps; k += 4) {
+        __m128 x = _mm_loadu_ps(samples + k);
+        sumA = _mm_add_ps(sumA, _mm_mul_ps(x, _mm_loadu_ps(phase + k)));
+        sumB = _mm_add_ps(sumB, _mm_mul_ps(x, _mm_loadu_ps(nextPhase + k)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sumA);
+    a = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm_storeu_ps(lanes, sumB);
+    b = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(AUDIO_CONVERTER_NEON)
+    float32x4_t sumA = vdupq_n_f32(0.0f);
+    float32x4_t sumB = vdupq_n_f32(0.0f);
+    for (; k + 4 <= taps; k += 4) {
+        float32x4_t x = vld1q_f32(samples + k);
+        sumA = vmlaq_f32(sumA, x, vld1q_f32(phase + k));
+        sumB = vmlaq_f32(sumB, x, vld1q_f32(nextPhase + k));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sumA);
+    a = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    vst1q_f32(lanes, sumB);
+    b = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; k < taps; ++k) {
+        a += samples[k] * phase[k];
+        b += samples[k] * nextPhase[k];
+    }
+    return a + (b - a) * fraction;
+}
+
+} // namespace
+
+//
+// AudioPCMLayout
+//
+
+bool AudioPCMLayout::HasSameSamples(const AudioPCMLayout& other) const {
+    return sampleType == other.sampleType && bigEndian == other.bigEndian && interleaved == other.interleaved &&
+           bytesPerSample == other.bytesPerSample && channels == other.channels;
+}
+
+bool AudioPCMLayout::FromDescription(const AudioStreamBasicDescription& description, AudioPCMLayout* layout) {
+    if (description.mFormatID != kAudioFormatLinearPCM || description.mFramesPerPacket != 1 || description.mChannelsPerFrame == 0 ||
+        description.mSampleRate <= 0) {
+        return false;
+    }
+
+    layout->interleaved = (description.mFormatFlags & kAudioFormatFlagIsNonInterleaved) == 0;
+    layout->channels = description.mChannelsPerFrame;
+    layout->bytesPerSample = layout->interleaved ? description.mBytesPerFrame / description.mChannelsPerFrame : description.mBytesPerFrame;
+    layout->bigEndian = (description.mFormatFlags & kAudioFormatFlagIsBigEndian) != 0;
+    layout->sampleRate = description.mSampleRate;
+
+    // Only packed samples, where the container is exactly as wide as the sample.
+    if (description.mBitsPerChannel != 8 * layout->bytesPerSample || description.mBytesPerPacket != description.mBytesPerFrame ||
+        (layout->interleaved && description.mBytesPerFrame != layout->bytesPerSample * layout->channels)) {
+        return false;
+    }
+
+    if (description.mFormatFlags & kAudioFormatFlagIsFloat) {
+        layout->sampleType = Float;
+        return layout->bytesPerSample == 4 || layout->bytesPerSample == 8;
+    }
+
+    layout->sampleType = (description.mFormatFlags & kAudioFormatFlagIsSignedInteger) ? SignedInteger : UnsignedInteger;
+    return layout->bytesPerSample >= 1 && layout->bytesPerSample <= 4;
+}
+
+//
+// AudioChannelMixer
+//
+
+void AudioChannelMixer::SetDefault(uint32_t inputChannels, uint32_t outputChannels) {
+    _inputChannels = inputChannels;
+    _outputChannels = outputChannels;
+    _matrix.assign(outputChannels * inputChannels, 0.0f);
+
+    if (inputChannels == 1) {
+        for (uint32_t out = 0; out < std::min(outputChannels, 2u); ++out) {
+            _matrix[out * inputChannels] = 1.0f;
+        }
+    } else if (outputChannels == 1) {
+        for (uint32_t in = 0; in < inputChannels; ++in) {
+            _matrix[in] = 1.0f / inputChannels;
+        }
+    } else {
+        for (uint32_t channel = 0; channel < std::min(inputChannels, outputChannels); ++channel) {
+            _matrix[channel * inputChannels + channel] = 1.0f;
+        }
+    }
+
+    _UpdateIdentity();
+}
+
+void AudioChannelMixer::SetChannelMap(uint32_t inputChannels, const std::vector<SInt32>& map) {
+    _inputChannels = inputChannels;
+    _outputChannels = map.size();
+    _matrix.assign(_outputChannels * inputChannels, 0.0f);
+    for (uint32_t out = 0; out < _outputChannels; ++out) {
+        if (map[out] >= 0 && static_cast<uint32_t>(map[out]) < inputChannels) {
+            _matrix[out * inputChannels + map[out]] = 1.0f;
+        }
+    }
+
+    _UpdateIdentity();
+}
+
+void AudioChannelMixer::_UpdateIdentity() {
+    _identity = (_inputChannels == _outputChannels);
+    for (uint32_t out = 0; _identity && out < _outputChannels; ++out) {
+        for (uint32_t in = 0; in < _inputChannels; ++in) {
+            if (_matrix[out * _inputChannels + in] != ((in == out) ? 1.0f : 0.0f)) {
+                _identity = false;
+                break;
+            }
+        }
+    }
+}
+
+void AudioChannelMixer::Mix(const float* const* input, float* const* output, uint32_t frames) const {
+    for (uint32_t out = 0; out < _outputChannels; ++out) {
+        float* destination = output[out];
+        const float* gains = &_matrix[out * _inputChannels];
+        memset(destination, 0, frames * sizeof(float));
+        for (uint32_t in = 0; in < _inputChannels; ++in) {
+            float gain = gains[in];
+            if (gain == 0.0f) {
+                continue;
+            }
+
+            const float* source = input[in];
+            for (uint32_t i = 0; i < frames; ++i) {
+                destination[i] += gain * source[i];
+            }
+        }
+    }
+}
+
+//
+// AudioResampler
+//
+
+AudioResampler::AudioResampler(uint32_t channels, double inputRate, double outputRate, UInt32 quality, UInt32 complexity)
+    : _channels(channels), _step(static_cast<uint64_t>(std::llround(inputRate / outputRate * c_fixedPointOne))), _history(channels) {
+    _BuildFilter(quality, complexity, inputRate, outputRate);
+    Reset();
+}
+
+void AudioResampler::_BuildFilter(UInt32 quality, UInt32 complexity, double inputRate, double outputRate) {
+    if (complexity == kAudioConverterSampleRateConverterComplexity_Linear) {
+        // Two taps and a single phase, which interpolation between the phases turns into a straight line.
+        _taps = 2;
+        _phases = 1;
+        _filter = { 1.0f, 0.0f, 0.0f, 1.0f };
+        return;
+    }
+
+    if (complexity == kAudioConverterSampleRateConverterComplexity_Mastering) {
+        quality = kAudioConverterQuality_Max;
+    }
+
+    // Longer filters buy a narrower transition band, so the passband can reach closer to Nyquist.
+    double beta;
+    double rolloff;
+    if (quality >= kAudioConverterQuality_Max) {
+        _taps = 64;
+        beta = 10.0;
+        rolloff = 0.96;
+    } else if (quality >= kAudioConverterQuality_High) {
+        _taps = 48;
+        beta = 9.0;
+        rolloff = 0.94;
+    } else if (quality >= kAudioConverterQuality_Medium) {
+        _taps = 32;
+        beta = 8.0;
+        rolloff = 0.91;
+    } else if (quality >= kAudioConverterQuality_Low) {
+        _taps = 16;
+        beta = 6.0;
+        rolloff = 0.86;
+    } else {
+        _taps = 8;
+        beta = 5.0;
+        rolloff = 0.8;
+    }
+    _phases = c_filterPhases;
+
+    // Downsampling moves the cutoff below the output Nyquist frequency, which stretches the impulse response by the rate
+    // ratio. The filter widens by the same ratio so the transition band stays as narrow relative to the output rate.
+    double ratio = inputRate / outputRate;
+    if (ratio > 1.0) {
+        _taps = std::min(static_cast<uint32_t>(std::ceil(_taps * ratio / 2.0)) * 2, c_maxFilterTaps);
+    }
+
+    const double pi = 3.14159265358979323846;
+    double cutoff = std::min(1.0, outputRate / inputRate) * rolloff;
+    double half = _taps / 2;
+    double windowScale = 1.0 / _BesselI0(beta);
+
+    // Phase p holds the taps for an output frame p / phases of the way from one input frame to the next, so that tap k
+    // weighs input frame k - (half - 1) relative to it. The extra last phase makes interpolation between phases uniform.
+    _filter.resize((_phases + 1) * _taps);
+    for (uint32_t p = 0; p <= _phases; ++p) {
+        float* row = &_filter[p * _taps];
+        double sum = 0.0;
+        for (uint32_t k = 0; k < _taps; ++k) {
+            double x = double(p) / _phases + (half - 1) - k;
+            double sinc = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+            double r = x / half;
+            double window = (std::fabs(r) >= 1.0) ? 0.0 : _BesselI0(beta * std::sqrt(1.0 - r * r)) * windowScale;
+            row[k] = static_cast<float>(sinc * window);
+            sum += row[k];
+        }
+
+        // Unity gain at DC for every phase
+        for (uint32_t k = 0; k < _taps; ++k) {
+            row[k] = static_cast<float>(row[k] / sum);
+        }
+    }
+}
+
+void AudioResampler::Reset() {
+    // Output frame 0 sits on input frame 0, so the taps before it see silence.
+    _buffered = _taps / 2 - 1;
+    for (auto& history : _history) {
+        history.assign(_buffered + c_blockFrames, 0.0f);
+    }
+
+    _time = 0;
+    _inputFrames = 0;
+    _outputFrames = 0;
+    _outputLimit = UINT64_MAX;
+    _ended = false;
+}
+
+void AudioResampler::ReserveInput(uint32_t frames) {
+    // Drop input that no output frame will look at again.
+    uint32_t consumed = static_cast<uint32_t>(std::min<uint64_t>(_time >> 32, _buffered));
+    if (consumed > 0) {
+        for (auto& history : _history) {
+            memmove(history.data(), history.data() + consumed, (_buffered - consumed) * sizeof(float));
+        }
+        _buffered -= consumed;
+        _time -= uint64_t(consumed) << 32;
+    }
+
+    if (_history[0].size() < _buffered + frames) {
+        for (auto& history : _history) {
+            history.resize(_buffered + frames);
+        }
+    }
+}
+
+void AudioResampler::CommitInput(uint32_t frames) {
+    _buffered += frames;
+    _inputFrames += frames;
+}
+
+void AudioResampler::EndInput() {
+    if (_ended) {
+        return;
+    }
+
+    uint32_t padding = _taps / 2;
+    ReserveInput(padding);
+    for (uint32_t channel = 0; channel < _channels; ++channel) {
+        std::fill_n(InputEnd(channel), padding, 0.0f);
+    }
+    _buffered += padding;
+
+    _outputLimit = OutputFramesFor(_inputFrames);
+    _ended = true;
+}
+
+uint64_t AudioResampler::OutputFramesFor(uint64_t inputFrames) const {
+    // The number of output times k * step that fall before the last input frame.
+    if (inputFrames == 0) {
+        return 0;
+    }
+    long double end = static_cast<long double>(inputFrames) * c_fixedPointOne;
+    return static_cast<uint64_t>(std::ceil(end / _step));
+}
+
+uint32_t AudioResampler::Produce(float* const* output, uint32_t frames) {
+    uint32_t produced = 0;
+    for (; produced < frames && _outputFrames < _outputLimit; ++produced) {
+        uint64_t first = _time >> 32;
+        if (first + _taps > _buffered) {
+            break;
+        }
+
+        uint64_t phasePosition = (_time & 0xFFFFFFFF) * _phases;
+        uint32_t phase = static_cast<uint32_t>(phasePosition >> 32);
+        float fraction = static_cast<float>((phasePosition & 0xFFFFFFFF) * (1.0 / c_fixedPointOne));
+        const float* coefficients = &_filter[phase * _taps];
+        for (uint32_t channel = 0; channel < _channels; ++channel) {
+            output[channel][produced] =
+                _InterpolatedDot(_history[channel].data() + first, coefficients, coefficients + _taps, _taps, fraction);
+        }
+
+        _time += _step;
+        ++_outputFrames;
+    }
+
+    return produced;
+}
+
+//
+// AudioConverterPipeline
+//
+
+OSStatus AudioConverterPipeline::Create(const AudioStreamBasicDescription& source,
+                                        const AudioStreamBasicDescription& destination,
+                                        std::unique_ptr<AudioConverterPipeline>* pipeline) {
+    AudioPCMLayout sourceLayout;
+    AudioPCMLayout destinationLayout;
+    if (!AudioPCMLayout::FromDescription(source, &sourceLayout) || !AudioPCMLayout::FromDescription(destination, &destinationLayout)) {
+        return kAudioConverterErr_FormatNotSupported;
+    }
+
+    pipeline->reset(new AudioConverterPipeline(source, destination, sourceLayout, destinationLayout));
+    return noErr;
+}
+
+AudioConverterPipeline::AudioConverterPipeline(const AudioStreamBasicDescription& source,
+                                               const AudioStreamBasicDescription& destination,
+                                               const AudioPCMLayout& sourceLayout,
+                                               const AudioPCMLayout& destinationLayout)
+    : _sourceDescription(source),
+      _destinationDescription(destination),
+      _source(sourceLayout),
+      _destination(destinationLayout),
+      _quality(kAudioConverterQuality_Medium),
+      _complexity(kAudioConverterSampleRateConverterComplexity_Normal),
+      _sourceBlock(c_blockFrames * sourceLayout.channels),
+      _destinationBlock(c_blockFrames * std::max(sourceLayout.channels, destinationLayout.channels)),
+      _pendingFrame(0),
+      _pendingFrames(0),
+      _endOfInput(false) {
+    _Configure();
+}
+
+void AudioConverterPipeline::_Configure() {
+    if (_channelMap.empty()) {
+        _mixer.SetDefault(_source.channels, _destination.channels);
+    } else {
+        _mixer.SetChannelMap(_source.channels, _channelMap);
+    }
+
+    // Resample whichever side has fewer channels.
+    _mixBeforeResampling = _destination.channels <= _source.channels;
+    _resampler.reset();
+    if (_source.sampleRate != _destination.sampleRate) {
+        uint32_t channels = _mixBeforeResampling ? _destination.channels : _source.channels;
+        _resampler.reset(new AudioResampler(channels, _source.sampleRate, _destination.sampleRate, _quality, _complexity));
+    }
+
+    _passthrough = !_resampler && _mixer.IsIdentity() && _source.HasSameSamples(_destination);
+    Reset();
+}
+
+void AudioConverterPipeline::Reset() {
+    if (_resampler) {
+        _resampler->Reset();
+    }
+
+    _pendingFrames = 0;
+    _endOfInput = false;
+}
+
+// Same-rate conversion, one cache-sized block at a time straight from the input buffers to the output buffers.
+void AudioConverterPipeline::_Convert(
+    const AudioBufferList& input, uint32_t inputFrame, AudioBufferList& output, uint32_t outputFrame, uint32_t frames) {
+    if (_passthrough) {
+        for (uint32_t i = 0; i < _source.BufferCount(); ++i) {
+            memcpy(_BufferData(output, _destination, i, outputFrame),
+                   _BufferData(input, _source, i, inputFrame),
+                   frames * _source.BufferFrameStride());
+        }
+        return;
+    }
+
+    std::vector<float*> sourcePlanes(_source.channels);
+    std::vector<float*> destinationPlanes(_destination.channels);
+    for (uint32_t c = 0; c < _source.channels; ++c) {
+        sourcePlanes[c] = &_sourceBlock[c * c_blockFrames];
+    }
+    for (uint32_t c = 0; c < _destination.channels; ++c) {
+        destinationPlanes[c] = &_destinationBlock[c * c_blockFrames];
+    }
+
+    for (uint32_t done = 0; done < frames;) {
+        uint32_t count = std::min(c_blockFrames, frames - done);
+        _DecodePCM(_source, input, inputFrame + done, count, sourcePlanes.data());
+        if (_mixer.IsIdentity()) {
+            _EncodePCM(_destination, sourcePlanes.data(), count, output, outputFrame + done);
+        } else {
+            _mixer.Mix(sourcePlanes.data(), destinationPlanes.data(), count);
+            _EncodePCM(_destination, destinationPlanes.data(), count, output, outputFrame + done);
+        }
+        done += count;
+    }
+}
+
+// Decodes input into the resampler, directly into its history unless the channels are mixed first.
+void AudioConverterPipeline::_PushInput(const AudioBufferList& input, uint32_t inputFrame, uint32_t frames) {
+    bool mixFirst = _mixBeforeResampling && !_mixer.IsIdentity();
+    uint32_t channels = mixFirst ? _destination.channels : _source.channels;
+    std::vector<float*> planes(channels);
+    std::vector<float*> sourcePlanes(_source.channels);
+    for (uint32_t c = 0; c < _source.channels; ++c) {
+        sourcePlanes[c] = &_sourceBlock[c * c_blockFrames];
+    }
+
+    for (uint32_t done = 0; done < frames;) {
+        uint32_t count = std::min(c_blockFrames, frames - done);
+        _resampler->ReserveInput(count);
+        for (uint32_t c = 0; c < channels; ++c) {
+            planes[c] = _resampler->InputEnd(c);
+        }
+
+        if (mixFirst) {
+            _DecodePCM(_source, input, inputFrame + done, count, sourcePlanes.data());
+            _mixer.Mix(sourcePlanes.data(), planes.data(), count);
+        } else {
+            _DecodePCM(_source, input, inputFrame + done, count, planes.data());
+        }
+
+        _resampler->CommitInput(count);
+        done += count;
+    }
+}
+
+uint32_t AudioConverterPipeline::_ProduceOutput(AudioBufferList& output, uint32_t outputFrame, uint32_t frames) {
+    bool mixAfter = !_mixBeforeResampling && !_mixer.IsIdentity();
+    std::vector<float*> resampledPlanes(mixAfter ? _source.channels : _destination.channels);
+    std::vector<float*> destinationPlanes(_destination.channels);
+    for (uint32_t c = 0; c < resampledPlanes.size(); ++c) {
+        resampledPlanes[c] = mixAfter ? &_sourceBlock[c * c_blockFrames] : &_destinationBlock[c * c_blockFrames];
+    }
+    for (uint32_t c = 0; c < _destination.channels; ++c) {
+        destinationPlanes[c] = &_destinationBlock[c * c_blockFrames];
+    }
+
+    uint32_t produced = 0;
+    while (produced < frames) {
+        uint32_t count = _resampler->Produce(resampledPlanes.data(), std::min(c_blockFrames, frames - produced));
+        if (count == 0) {
+            break;
+        }
+
+        if (mixAfter) {
+            _mixer.Mix(resampledPlanes.data(), destinationPlanes.data(), count);
+        }
+        _EncodePCM(_destination, destinationPlanes.data(), count, output, outputFrame + produced);
+        produced += count;
+    }
+
+    return produced;
+}
+
+OSStatus AudioConverterPipeline::ConvertBuffer(UInt32 inputSize, const void* input, UInt32* ioOutputSize, void* output) {
+    // A single buffer each way only holds interleaved frames.
+    if (_source.BufferCount() != 1 || _destination.BufferCount() != 1) {
+        return kAudioConverterErr_FormatNotSupported;
+    }
+
+    uint32_t inputFrames = inputSize / _source.BufferFrameStride();
+    uint64_t outputFrames = _resampler ? _resampler->OutputFramesFor(inputFrames) : inputFrames;
+    if (*ioOutputSize < outputFrames * _destination.BufferFrameStride()) {
+        return kAudioConverterErr_InvalidOutputSize;
+    }
+
+    AudioBufferList inputList = { 1, { { _source.channels, inputSize, const_cast<void*>(input) } } };
+    AudioBufferList outputList = { 1, { { _destination.channels, *ioOutputSize, output } } };
+
+    if (!_resampler) {
+        _Convert(inputList, 0, outputList, 0, inputFrames);
+    } else {
+        // Each call converts a complete signal, so the filter starts and ends in silence.
+        _resampler->Reset();
+        uint32_t produced = 0;
+        for (uint32_t pushed = 0; pushed < inputFrames;) {
+            uint32_t count = std::min<uint32_t>(inputFrames - pushed, 16 * c_blockFrames);
+            _PushInput(inputList, pushed, count);
+            pushed += count;
+            produced += _ProduceOutput(outputList, produced, outputFrames - produced);
+        }
+        _resampler->EndInput();
+        produced += _ProduceOutput(outputList, produced, outputFrames - produced);
+        _resampler->Reset();
+        outputFrames = produced;
+    }
+
+    *ioOutputSize = outputFrames * _destination.BufferFrameStride();
+    return noErr;
+}
+
+OSStatus AudioConverterPipeline::ConvertComplexBuffer(UInt32 frames, const AudioBufferList* input, AudioBufferList* output) {
+    if (_resampler) {
+        return kAudioConverterErr_InvalidInputSize;
+    }
+
+    if (_BufferListFrames(_source, *input) < frames) {
+        return kAudioConverterErr_InvalidInputSize;
+    }
+
+    if (_BufferListFrames(_destination, *output) < frames) {
+        return kAudioConverterErr_InvalidOutputSize;
+    }
+
+    _Convert(*input, 0, *output, 0, frames);
+    _SetBufferListFrames(_destination, *output, frames);
+    return noErr;
+}
+
+OSStatus AudioConverterPipeline::FillComplexBuffer(AudioConverterRef converter,
+                                                   AudioConverterComplexInputDataProc inputProc,
+                                                   void* userData,
+                                                   UInt32* ioOutputPackets,
+                                                   AudioBufferList* output) {
+    uint32_t wanted = std::min(*ioOutputPackets, _BufferListFrames(_destination, *output));
+    uint32_t produced = 0;
+    OSStatus status = noErr;
+
+    size_t listSize = offsetof(AudioBufferList, mBuffers) + _source.BufferCount() * sizeof(AudioBuffer);
+    _pendingStorage.resize(std::max(listSize, sizeof(AudioBufferList)));
+    AudioBufferList* pending = reinterpret_cast<AudioBufferList*>(_pendingStorage.data());
+
+    while (produced < wanted) {
+        if (_resampler) {
+            uint32_t count = _ProduceOutput(*output, produced, wanted - produced);
+            if (count > 0) {
+                produced += count;
+                continue;
+            }
+
+            if (_endOfInput) {
+                break;
+            }
+        }
+
+        if (_pendingFrames == 0) {
+            if (_endOfInput) {
+                break;
+            }
+
+            // Ask for about as much input as the remaining output needs. The callback's buffers are read in place.
+            double ratio = _source.sampleRate / _destination.sampleRate;
+            UInt32 packets = std::max<UInt32>(1, static_cast<UInt32>(std::ceil((wanted - produced) * ratio)));
+            memset(pending, 0, listSize);
+            pending->mNumberBuffers = _source.BufferCount();
+            AudioStreamPacketDescription* packetDescriptions = nullptr;
+            status = inputProc(converter, &packets, pending, &packetDescriptions, userData);
+
+            _pendingFrame = 0;
+            _pendingFrames = (status == noErr || packets > 0) ? std::min<uint32_t>(packets, _BufferListFrames(_source, *pending)) : 0;
+            if (_pendingFrames == 0) {
+                // An error ends this call but leaves the stream open, while no data and no error is the end of the stream.
+                if (status != noErr) {
+                    break;
+                }
+
+                _endOfInput = true;
+                if (_resampler) {
+                    _resampler->EndInput();
+                }
+                continue;
+            }
+        }
+
+        if (_resampler) {
+            uint32_t count = std::min(_pendingFrames, _resampler->Taps() + c_blockFrames);
+            _PushInput(*pending, _pendingFrame, count);
+            _pendingFrame += count;
+            _pendingFrames -= count;
+        } else {
+            uint32_t count = std::min(_pendingFrames, wanted - produced);
+            _Convert(*pending, _pendingFrame, *output, produced, count);
+            _pendingFrame += count;
+            _pendingFrames -= count;
+            produced += count;
+        }
+    }
+
+    *ioOutputPackets = produced;
+    _SetBufferListFrames(_destination, *output, produced);
+    return (produced == wanted) ? noErr : status;
+}
+
+OSStatus AudioConverterPipeline::GetPropertyInfo(AudioConverterPropertyID propertyID, UInt32* size, Boolean* writable) {
+    UInt32 propertySize = 0;
+    Boolean propertyWritable = false;
+    switch (propertyID) {
+        case kAudioConverterCurrentInputStreamDescription:
+        case kAudioConverterCurrentOutputStreamDescription:
+            propertySize = sizeof(AudioStreamBasicDescription);
+            break;
+
+        case kAudioConverterSampleRateConverterQuality:
+        case kAudioConverterSampleRateConverterComplexity:
+            propertySize = sizeof(UInt32);
+            propertyWritable = true;
+            break;
+
+        case kAudioConverterChannelMap:
+            propertySize = _destination.channels * sizeof(SInt32);
+            propertyWritable = true;
+            break;
+
+        case kAudioConverterPropertyMaximumInputPacketSize:
+        case kAudioConverterPropertyMaximumOutputPacketSize:
+        case kAudioConverterPropertyCalculateInputBufferSize:
+        case kAudioConverterPropertyCalculateOutputBufferSize:
+            propertySize = sizeof(UInt32);
+            break;
+
+        default:
+            return kAudioConverterErr_PropertyNotSupported;
+    }
+
+    if (size) {
+        *size = propertySize;
+    }
+    if (writable) {
+        *writable = propertyWritable;
+    }
+    return noErr;
+}
+
+OSStatus AudioConverterPipeline::GetProperty(AudioConverterPropertyID propertyID, UInt32* ioSize, void* data) {
+    UInt32 size;
+    OSStatus status = GetPropertyInfo(propertyID, &size, nullptr);
+    if (status != noErr) {
+        return status;
+    }
+
+    if (!ioSize || !data || *ioSize < size) {
+        return kAudioConverterErr_BadPropertySizeError;
+    }
+
+    double ratio = _destination.sampleRate / _source.sampleRate;
+    switch (propertyID) {
+        case kAudioConverterCurrentInputStreamDescription:
+            memcpy(data, &_sourceDescription, sizeof(_sourceDescription));
+            break;
+
+        case kAudioConverterCurrentOutputStreamDescription:
+            memcpy(data, &_destinationDescription, sizeof(_destinationDescription));
+            break;
+
+        case kAudioConverterSampleRateConverterQuality:
+            *static_cast<UInt32*>(data) = _quality;
+            break;
+
+        case kAudioConverterSampleRateConverterComplexity:
+            *static_cast<UInt32*>(data) = _complexity;
+            break;
+
+        case kAudioConverterChannelMap:
+            for (uint32_t out = 0; out < _destination.channels; ++out) {
+                static_cast<SInt32*>(data)[out] = _channelMap.empty() ? ((out < _source.channels) ? out : -1) : _channelMap[out];
+            }
+            break;
+
+        case kAudioConverterPropertyMaximumInputPacketSize:
+            *static_cast<UInt32*>(data) = _sourceDescription.mBytesPerPacket;
+            break;
+
+        case kAudioConverterPropertyMaximumOutputPacketSize:
+            *static_cast<UInt32*>(data) = _destinationDescription.mBytesPerPacket;
+            break;
+
+        // Both take a byte count on one side of the conversion and return the matching count on the other.
+        case kAudioConverterPropertyCalculateOutputBufferSize: {
+            UInt32 frames = *static_cast<UInt32*>(data) / _source.BufferFrameStride();
+            uint64_t outputFrames = _resampler ? _resampler->OutputFramesFor(frames) : frames;
+            *static_cast<UInt32*>(data) = static_cast<UInt32>(outputFrames * _destination.BufferFrameStride());
+            break;
+        }
+
+        case kAudioConverterPropertyCalculateInputBufferSize: {
+            UInt32 frames = *static_cast<UInt32*>(data) / _destination.BufferFrameStride();
+            *static_cast<UInt32*>(data) = static_cast<UInt32>(std::ceil(frames / ratio)) * _source.BufferFrameStride();
+            break;
+        }
+    }
+
+    *ioSize = size;
+    return noErr;
+}
+
+OSStatus AudioConverterPipeline::SetProperty(AudioConverterPropertyID propertyID, UInt32 size, const void* data) {
+    switch (propertyID) {
+        case kAudioConverterSampleRateConverterQuality:
+        case kAudioConverterSampleRateConverterComplexity:
+            if (size != sizeof(UInt32)) {
+                return kAudioConverterErr_BadPropertySizeError;
+            }
+
+            (propertyID == kAudioConverterSampleRateConverterQuality ? _quality : _complexity) = *static_cast<const UInt32*>(data);
+            break;
+
+        case kAudioConverterChannelMap:
+            if (size != _destination.channels * sizeof(SInt32)) {
+                return kAudioConverterErr_BadPropertySizeError;
+            }
+
+            _channelMap.assign(static_cast<const SInt32*>(data), static_cast<const SInt32*>(data) + _destination.channels);
+            break;
+
+        default:
+            return kAudioConverterErr_PropertyNotSupported;
+    }
+
+    _Configure();
+    return noErr;
+}
@@ -21,12 +21,11 @@
 
 #import "Starboard.h"
 #import "Etc.h"
-#include "CAFDecoder.h"
+#include "AudioStreamDecoder.h"
 #include "LoggingNative.h"
 
 static const wchar_t* TAG = L"AudioFile";
 
-#import "stb_vorbis.h"
 #import <AudioToolbox/AudioFile.h>
 #import <AudioToolbox/AudioFileTypes.h>
 #import <AudioToolbox/ExtendedAudioFile.h>
@@ -51,6 +50,13 @@ public:
         return 0;
     }
 
+    // Reads whole packets starting at firstPacket, never more than *ioNumBytes bytes.
+    virtual int readPackets(i64 firstPacket, u32* ioNumPackets, u32* ioNumBytes, void* buffer) {
+        *ioNumPackets = 0;
+        *ioNumBytes = 0;
+        return kAudioFileOperationNotSupportedError;
+    }
+
     virtual u32 getProperty(u32 propID, u32* dataSize, void* out) {
         return 0;
     }
@@ -71,100 +77,134 @@ public:
     }
 };
 
-class AudioFileOGG : public OpaqueAudioFileID {
-    stb_vorbis* _handle;
-    StrongId<NSData> _data;
+typedef std::unique_ptr<AudioStreamDecoder> (*AudioDecoderFactory)(std::unique_ptr<AudioByteSource>);
+
+// OGG and CAF files are decoded on demand into a bounded decode-ahead buffer rather than loaded whole, and present
+// themselves as 16-bit linear PCM with one frame per packet.
+class AudioFileDecoded : public OpaqueAudioFileID {
+    AudioDecodeAheadBuffer _buffer;
+    const wchar_t* _name;
+
+    AudioFileDecoded(std::unique_ptr<AudioStreamDecoder> decoder, const wchar_t* name) : _buffer(std::move(decoder)), _name(name) {
+        const AudioStreamDecoder& streamDecoder = _buffer.Decoder();
+        fileFormat.mFormatID = kAudioFormatLinearPCM;
+        fileFormat.mFormatFlags = kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked;
+        fileFormat.mChannelsPerFrame = streamDecoder.ChannelCount();
+        fileFormat.mSampleRate = streamDecoder.SampleRate();
+        fileFormat.mBytesPerFrame = streamDecoder.ChannelCount() * sizeof(short);
+        fileFormat.mBitsPerChannel = 16;
+        fileFormat.mFramesPerPacket = 1;
+        fileFormat.mBytesPerPacket = fileFormat.mBytesPerFrame;
+    }
+
+    bool _seekTo(i64 frame) {
+        if (_buffer.Position() == frame) {
+            return true;
+        }
 
-    AudioFileOGG(stb_vorbis* handle, NSData* data) : _handle(handle), _data(data) {
+        return _buffer.Seek(frame);
+    }
+
+    i64 _frameCount() const {
+        return std::max<i64>(_buffer.Decoder().FrameCount(), 0);
     }
 
 public:
-    ~AudioFileOGG() {
-        if (_handle) {
-            stb_vorbis_close(_handle);
-            _handle = 0;
+    static OpaqueAudioFileID* open(std::unique_ptr<AudioByteSource> source, AudioDecoderFactory createDecoder, const wchar_t* name) {
+        if (!source) {
+            TraceError(TAG, L"[%ls] Could not open audio data", name);
+            return nullptr;
         }
-    }
 
-    static OpaqueAudioFileID* openURL(NSURL* url) {
-        NSData* data = [NSData dataWithContentsOfURL:url];
-        if ([data length] > 0) {
-            int err = 0;
-            stb_vorbis* handle = stb_vorbis_open_memory((unsigned char*)[data bytes], [data length], &err, nullptr);
+        std::unique_ptr<AudioStreamDecoder> decoder = createDecoder(std::move(source));
+        if (!decoder) {
+            TraceError(TAG, L"[%ls] Unsupported or malformed audio data", name);
+            return nullptr;
+        }
 
-            if (handle && err == 0) {
-                return new AudioFileOGG(handle, data);
-            }
+        return new AudioFileDecoded(std::move(decoder), name);
+    }
 
-            TraceError(TAG, L"[OGG] OGG open error: %d", err);
-        }
-        return 0;
+    static OpaqueAudioFileID* openURL(NSURL* url, AudioDecoderFactory createDecoder, const wchar_t* name) {
+        return open(AudioByteSource::CreateWithPath([[url path] UTF8String]), createDecoder, name);
     }
 
-    virtual int read(u32* outFrameCount, AudioBufferList* buffers) {
+    int read(u32* outFrameCount, AudioBufferList* buffers) {
         // Right now we only support reading into one buffer
         if (buffers->mNumberBuffers != 1) {
-            UNIMPLEMENTED_WITH_MSG("OGG decoding only supported with 1 AudioBuffer");
+            UNIMPLEMENTED_WITH_MSG("Decoding only supported with 1 AudioBuffer");
             *outFrameCount = 0;
             return 0;
         }
 
-        u32 numBytes = buffers->mBuffers[0].mDataByteSize;
-        int ret = readBytes(0, &numBytes, buffers->mBuffers[0].mData);
-        *outFrameCount = numBytes / 2;
+        u32 frames = std::min<u32>(*outFrameCount, buffers->mBuffers[0].mDataByteSize / fileFormat.mBytesPerFrame);
+        *outFrameCount = _buffer.Read(static_cast<int16_t*>(buffers->mBuffers[0].mData), frames);
+        buffers->mBuffers[0].mDataByteSize = *outFrameCount * fileFormat.mBytesPerFrame;
 
-        return ret;
+        return 0;
     }
 
     int readBytes(i64 start, u32* numBytes, void* buffer) {
-        int remainingShorts = *numBytes / 2;
-        short* data = (short*)buffer;
-        stb_vorbis_info info = stb_vorbis_get_info(_handle);
-
+        u32 requested = *numBytes;
         *numBytes = 0;
-        for (;;) {
-            int n = stb_vorbis_get_frame_short_interleaved(_handle, info.channels, data, remainingShorts);
 
-            // Are we done?
-            if (n == 0) {
-                break;
-            }
+        if (start < 0 || (start % fileFormat.mBytesPerFrame) != 0) {
+            TraceError(TAG, L"[%ls] Reads must start on a frame boundary", _name);
+            return kAudioFilePositionError;
+        }
+
+        if (!_seekTo(start / fileFormat.mBytesPerFrame)) {
+            return kAudioFileEndOfFileError;
+        }
+
+        *numBytes = _buffer.Read(static_cast<int16_t*>(buffer), requested / fileFormat.mBytesPerFrame) * fileFormat.mBytesPerFrame;
+        return (*numBytes < requested) ? kAudioFileEndOfFileError : 0;
+    }
+
+    int readPackets(i64 firstPacket, u32* ioNumPackets, u32* ioNumBytes, void* buffer) {
+        u32 packets = std::min<u32>(*ioNumPackets, *ioNumBytes / fileFormat.mBytesPerPacket);
+        *ioNumPackets = 0;
+        *ioNumBytes = 0;
+
+        if (firstPacket < 0 || firstPacket > _frameCount()) {
+            return kAudioFileInvalidPacketOffsetError;
+        }
 
-            data += n * info.channels;
-            remainingShorts -= n * info.channels;
-            *numBytes += n * info.channels * 2;
+        if (!_seekTo(firstPacket)) {
+            return kAudioFileEndOfFileError;
         }
 
+        *ioNumPackets = _buffer.Read(static_cast<int16_t*>(buffer), packets);
+        *ioNumBytes = *ioNumPackets * fileFormat.mBytesPerPacket;
         return 0;
     }
 
     u32 getProperty(u32 propID, u32* dataSize, void* out) {
-        stb_vorbis_info info = stb_vorbis_get_info(_handle);
         switch (propID) {
             case kExtAudioFileProperty_FileLengthFrames: {
-                *(i64*)out = stb_vorbis_stream_length_in_samples(_handle);
+                *(i64*)out = _frameCount();
                 break;
             }
 
             case kExtAudioFileProperty_FileDataFormat:
             case kAudioFilePropertyDataFormat: {
                 AudioStreamBasicDescription* desc = (AudioStreamBasicDescription*)out;
-                desc->mFormatID = 'lpcm';
-                desc->mChannelsPerFrame = info.channels;
-                desc->mSampleRate = info.sample_rate;
-                desc->mBytesPerFrame = info.channels * sizeof(short);
-                desc->mBitsPerChannel = 16;
+                memcpy(desc, &fileFormat, sizeof(AudioStreamBasicDescription));
+                break;
+            }
 
-                // This packet information confuses me, we don't really support it in the
-                // same way...
-                desc->mFramesPerPacket = 1;
-                desc->mBytesPerPacket = sizeof(short) * info.channels;
+            case kAudioFilePropertyAudioDataByteCount: {
+                *(u64*)out = _frameCount() * fileFormat.mBytesPerFrame;
+                break;
+            }
 
+            case kAudioFilePropertyAudioDataPacketCount: {
+                *(u64*)out = _frameCount();
                 break;
             }
 
             default:
-                TraceError(TAG, L"[OGG] Unrecognized property for getProperty: %d", propID);
+                TraceError(TAG, L"[%ls] Unrecognized property for getProperty: %d", _name, propID);
                 break;
         }
 
@@ -381,107 +421,6 @@ public:
     }
 };
 
-class AudioFileCAF : public OpaqueAudioFileID {
-    CAFDecoder _decoder;
-
-    // Storing this in here really sucks but we can't really know until
-    // we've read it all.. Refactor decoder?
-    std::vector<i16> _data;
-
-public:
-    static OpaqueAudioFileID* openURL(NSURL* url) {
-        NSInputStream* inStream = [NSInputStream inputStreamWithURL:url];
-        [inStream open];
-
-        if (NSStreamStatusOpen != inStream.streamStatus) {
-            TraceError(TAG, L"CAF %hs doesn't exist..", url);
-            return NULL;
-        }
-
-        AudioFileCAF* self = new AudioFileCAF();
-        if (!self->_decoder.InitForRead(inStream)) {
-            TraceError(TAG, L"CAF %hs has an unsupported format..", url);
-            return NULL;
-        }
-
-        i16 buffer[1024];
-        while (true) {
-            uint numBytes = sizeof(buffer) / 2;
-            self->_decoder.ReadBuf(inStream, buffer, numBytes);
-
-            if (numBytes == 0) {
-                // Done!
-                break;
-            }
-
-            self->_data.insert(self->_data.end(), buffer, buffer + numBytes / 2);
-        }
-
-        return self;
-    }
-
-    u32 getProperty(u32 propID, u32* dataSize, void* out) {
-        // Note that we NEED to do a copy here since this is not aligned sanely.
-        // Any access through a pointer/reference will cause a SIGBUS on ~win32.
-        OutputDescription outDesc = _decoder.OutputFormat;
-
-        switch (propID) {
-            case kExtAudioFileProperty_FileLengthFrames: {
-                TraceVerbose(TAG, L"CAF getting filelengthframes");
-                *(i64*)out = _data.size() / outDesc.mChannelsPerFrame;
-                break;
-            }
-
-            case kExtAudioFileProperty_FileDataFormat:
-            case kAudioFilePropertyDataFormat: {
-                TraceVerbose(TAG, L"CAF getting data format");
-                AudioStreamBasicDescription* desc = (AudioStreamBasicDescription*)out;
-                desc->mFormatID = 'lpcm';
-                desc->mChannelsPerFrame = outDesc.mChannelsPerFrame;
-                desc->mSampleRate = outDesc.mSampleRate;
-                desc->mBytesPerFrame = outDesc.mChannelsPerFrame * sizeof(short);
-                desc->mBitsPerChannel = outDesc.mBitsPerChannel;
-
-                // This packet information confuses me, we don't really support it in the
-                // same way...
-                desc->mFramesPerPacket = 1024;
-                desc->mBytesPerPacket = sizeof(short) * outDesc.mChannelsPerFrame;
-
-                break;
-            }
-
-            case kAudioFilePropertyAudioDataByteCount: {
-                TraceVerbose(TAG, L"CAF getting byte count");
-                *(u64*)out = _data.size() * sizeof(short);
-                break;
-            }
-
-            default:
-                TraceError(TAG, L"[CAF] Unrecognized property for getProperty: %d", propID);
-                break;
-        }
-
-        return 0;
-    }
-
-    int read(u32* outFrameCount, AudioBufferList* buffers) {
-        return 0;
-    }
-
-    int readBytes(i64 start, u32* numBytes, void* buffer) {
-        if (start != 0) {
-            TraceError(TAG, L"Attempting to read CAF with non-zero offset, unsupported.");
-            return -1;
-        }
-
-        int readSize = min(*numBytes, _data.size() * 2);
-        memcpy(buffer, &*_data.begin(), readSize);
-        *numBytes = readSize;
-
-        return 0;
-    }
-};
-
 class OpaqueExtAudioFile {
 public:
     AudioFileID pAudioFile;
@@ -519,11 +458,11 @@ OSStatus AudioFileOpenURL(CFURLRef url, AudioFilePermissions permissions, AudioF
     // Try to figure out what this is:
     if (out) {
         if (strncmp(header, "OggS", 4) == 0) {
-            *out = AudioFileOGG::openURL(nsURL);
+            *out = AudioFileDecoded::openURL(nsURL, &AudioStreamDecoder::CreateOggVorbis, L"OGG");
         } else if (strncmp(header, "RIFF", 4) == 0) {
             *out = AudioFileWAV::openURL(nsURL);
         } else if (strncmp(header, "caff", 4) == 0) {
-            *out = AudioFileCAF::openURL(nsURL);
+            *out = AudioFileDecoded::openURL(nsURL, &AudioStreamDecoder::CreateCAF, L"CAF");
         } else if (strncmp(header, "ID3", 3) == 0) {
             TraceError(TAG, L"MP3s not supported!");
             return 1234;
@@ -635,6 +574,14 @@ DWORD AudioFileOpenWithCallbacks(void* context,
     if (out) {
         if (strncmp(header, "RIFF", 4) == 0) {
             *out = AudioFileWAV::openFile(in);
+        } else if (strncmp(header, "OggS", 4) == 0) {
+            *out = AudioFileDecoded::open(AudioByteSource::CreateWithCallbacks(context, readFunc, getSizeFunc),
+                                          &AudioStreamDecoder::CreateOggVorbis,
+                                          L"OGG");
+        } else if (strncmp(header, "caff", 4) == 0) {
+            *out = AudioFileDecoded::open(AudioByteSource::CreateWithCallbacks(context, readFunc, getSizeFunc),
+                                          &AudioStreamDecoder::CreateCAF,
+                                          L"CAF");
         } else {
             TraceError(TAG, L"What is this format?!");
             return 1234;
@@ -720,28 +667,28 @@ OSStatus AudioFileReadBytes(AudioFileID fileID, Boolean useCached, SInt64 startB
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Supported for OGG and CAF files, which read as 16-bit linear PCM with one frame per packet. useCached parameter not supported
 */
 OSStatus AudioFileReadPacketData(AudioFileID fileID,
                                  Boolean useCached,
-                                 UInt32* outNumBytes,
+                                 UInt32* ioNumBytes,
                                  AudioStreamPacketDescription* packetDescs,
                                  SInt64 firstPacket,
-                                 UInt32* numPackets,
+                                 UInt32* ioNumPackets,
                                  void* outBuf) {
-    UNIMPLEMENTED();
-    TraceWarning(TAG, L"AudioFileReadPacketData not supported");
-
-    *outNumBytes = 0;
-    *numPackets = 0;
+    if (fileID == NULL) {
+        *ioNumBytes = 0;
+        *ioNumPackets = 0;
+        return kAudioFileUnspecifiedError;
+    }
 
-    return 0;
+    return fileID->readPackets(firstPacket, ioNumPackets, ioNumBytes, outBuf);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Supported for OGG and CAF files, which read as 16-bit linear PCM with one frame per packet. useCached parameter not supported
 */
 OSStatus AudioFileReadPackets(AudioFileID fileID,
                               Boolean useCached,
@@ -750,13 +697,14 @@ OSStatus AudioFileReadPackets(AudioFileID fileID,
                               SInt64 firstPacket,
                               UInt32* numPackets,
                               void* outBuf) {
-    UNIMPLEMENTED();
     if (fileID == NULL) {
         *outNumBytes = 0;
         return 1234;
     }
 
-    return 0;
+    // The caller guarantees room for numPackets packets.
+    *outNumBytes = UINT32_MAX;
+    return fileID->readPackets(firstPacket, numPackets, outNumBytes, outBuf);
 }
 
 /**
@@ -0,0 +1,264 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <AudioToolbox/AudioUnitProcessingGraph.h>
+#import <AudioUnit/AudioUnitInternal.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AudioGraph;
+struct AudioGraphSchedule;
+
+// Bounded single-producer single-consumer queue. Push and Pop never block or allocate, so one side can be the render thread.
+template <typename T, size_t Capacity>
+class AudioGraphRing {
+public:
+    AudioGraphRing() : _head(0), _tail(0) {
+    }
+
+    bool Push(const T& value) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        _items[tail % Capacity] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T* value) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *value = _items[head % Capacity];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+// An audio unit owned by an AudioGraph node. Every unit processes non-interleaved 32-bit float and has one output bus.
+// Properties are changed under the graph's control lock; the render thread only reads the compiled schedule and atomics.
+class AudioGraphUnit : public OpaqueAudioComponentInstance {
+public:
+    // Returns nullptr for components the graph cannot instantiate.
+    static std::shared_ptr<AudioGraphUnit> Create(AudioGraph* graph, AUNode node, const AudioComponentDescription& description);
+    static bool IsSupported(const AudioComponentDescription& description);
+
+    AUNode Node() const {
+        return _node;
+    }
+
+    const AudioComponentDescription& Description() const {
+        return _description;
+    }
+
+    bool IsOutput() const {
+        return _description.componentType == kAudioUnitType_Output;
+    }
+
+    UInt32 InputBusCount() const {
+        return _inputFormats.size();
+    }
+
+    const AudioStreamBasicDescription& InputFormat(UInt32 bus) const {
+        return _inputFormats[bus];
+    }
+
+    const AudioStreamBasicDescription& OutputFormat() const {
+        return _outputFormat;
+    }
+
+    UInt32 MaximumFramesPerSlice() const {
+        return _maximumFramesPerSlice;
+    }
+
+    const std::vector<AURenderCallbackStruct>& RenderNotifies() const {
+        return _renderNotifies;
+    }
+
+    // Called by the graph with its control lock held.
+    void SetInitialized(bool initialized) {
+        _initialized = initialized;
+    }
+    void PropagateInputFormat(UInt32 bus, const AudioStreamBasicDescription& format);
+    OSStatus AddRenderNotifyLocked(AURenderCallback proc, void* userData);
+    OSStatus RemoveRenderNotifyLocked(AURenderCallback proc, void* userData);
+
+    // Called on the render thread. inputs holds one buffer list per input bus, or nullptr where the bus is silent.
+    virtual void Process(UInt32 frames, const AudioBufferList* const* inputs, AudioBufferList* output) = 0;
+
+    // OpaqueAudioComponentInstance
+    OSStatus Initialize() override;
+    OSStatus Uninitialize() override;
+    OSStatus Reset(AudioUnitScope scope, AudioUnitElement element) override;
+    OSStatus GetPropertyInfo(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, UInt32* outSize, Boolean* outWritable) override;
+    OSStatus GetProperty(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, void* outData, UInt32* ioSize) override;
+    OSStatus SetProperty(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, const void* data, UInt32 size) override;
+    OSStatus GetParameter(AudioUnitParameterID parameterID,
+                          AudioUnitScope scope,
+                          AudioUnitElement element,
+                          AudioUnitParameterValue* outValue) override;
+    OSStatus SetParameter(AudioUnitParameterID parameterID,
+                          AudioUnitScope scope,
+                          AudioUnitElement element,
+                          AudioUnitParameterValue value,
+                          UInt32 bufferOffsetInFrames) override;
+    OSStatus AddRenderNotify(AURenderCallback proc, void* userData) override;
+    OSStatus RemoveRenderNotify(AURenderCallback proc, void* userData) override;
+    OSStatus Render(AudioUnitRenderActionFlags* ioActionFlags,
+                    const AudioTimeStamp* timeStamp,
+                    UInt32 outputBusNumber,
+                    UInt32 frames,
+                    AudioBufferList* ioData) override;
+
+protected:
+    AudioGraphUnit(AudioGraph* graph, AUNode node, const AudioComponentDescription& description, UInt32 inputBuses);
+
+    virtual bool _CanSetInputBusCount() const {
+        return false;
+    }
+    virtual void _SetInputBusCount(UInt32 count);
+
+    // Parameters are read on the render thread, so units keep them in atomics. Both are called with the control lock held.
+    virtual OSStatus _GetParameter(AudioUnitParameterID parameterID,
+                                   AudioUnitScope scope,
+                                   AudioUnitElement element,
+                                   AudioUnitParameterValue* outValue) {
+        return kAudioUnitErr_InvalidParameter;
+    }
+    virtual OSStatus _SetParameter(AudioUnitParameterID parameterID,
+                                   AudioUnitScope scope,
+                                   AudioUnitElement element,
+                                   AudioUnitParameterValue value) {
+        return kAudioUnitErr_InvalidParameter;
+    }
+
+    AudioGraph* _graph;
+
+private:
+    AUNode _node;
+    AudioComponentDescription _description;
+    std::vector<AudioStreamBasicDescription> _inputFormats;
+    AudioStreamBasicDescription _outputFormat;
+    UInt32 _maximumFramesPerSlice;
+    std::vector<AURenderCallbackStruct> _renderNotifies;
+    bool _initialized;
+};
+
+// The nodes, connections and units behind an AUGraph.
+//
+// Edits change the graph on the control side only. AUGraphInitialize and AUGraphUpdate compile it into an immutable
+// render schedule, with the nodes in dependency order and every buffer preallocated, and publish that to the render
+// thread through an atomic slot. The render thread adopts a newly published schedule at the start of a buffer and
+// passes the one it replaced back through a ring to be freed on the control side, so rendering never locks or frees.
+class AudioGraph {
+public:
+    AudioGraph();
+    ~AudioGraph();
+
+    OSStatus AddNode(const AudioComponentDescription& description, AUNode* outNode);
+    OSStatus RemoveNode(AUNode node);
+    OSStatus GetNodeCount(UInt32* outCount);
+    OSStatus GetIndNode(UInt32 index, AUNode* outNode);
+    OSStatus NodeInfo(AUNode node, AudioComponentDescription* outDescription, AudioUnit* outUnit);
+
+    OSStatus ConnectNodeInput(AUNode sourceNode, UInt32 sourceOutput, AUNode destinationNode, UInt32 destinationInput);
+    OSStatus SetNodeInputCallback(AUNode destinationNode, UInt32 destinationInput, const AURenderCallbackStruct& callback);
+    OSStatus DisconnectNodeInput(AUNode destinationNode, UInt32 destinationInput);
+    OSStatus ClearConnections();
+    OSStatus GetNumberOfInteractions(UInt32* outCount);
+    OSStatus GetInteractionInfo(UInt32 index, AUNodeInteraction* outInteraction);
+    OSStatus CountNodeInteractions(AUNode node, UInt32* outCount);
+    OSStatus GetNodeInteractions(AUNode node, UInt32* ioCount, AUNodeInteraction* outInteractions);
+
+    OSStatus Open();
+    OSStatus Close();
+    OSStatus Initialize();
+    OSStatus Uninitialize();
+    OSStatus Start();
+    OSStatus Stop();
+    OSStatus Update(Boolean* outIsUpdated);
+    bool IsOpen();
+    bool IsInitialized();
+    bool IsRunning();
+
+    OSStatus AddRenderNotify(AURenderCallback proc, void* userData);
+    OSStatus RemoveRenderNotify(AURenderCallback proc, void* userData);
+
+    float CPULoad() const {
+        return _cpuLoad.load(std::memory_order_relaxed);
+    }
+    float TakeMaxCPULoad() {
+        return _maxCPULoad.exchange(0.0f, std::memory_order_relaxed);
+    }
+
+    // Used by the units.
+    std::mutex& ControlLock() {
+        return _controlLock;
+    }
+    bool IsInitializedLocked() const {
+        return _initialized;
+    }
+    OSStatus SetNodeInputCallbackLocked(AUNode destinationNode, UInt32 destinationInput, const AURenderCallbackStruct& callback);
+    OSStatus RepublishLocked();
+
+    // Renders the current schedule into ioData. Called on the render thread by the output unit.
+    OSStatus Render(AudioUnitRenderActionFlags* ioActionFlags, const AudioTimeStamp* timeStamp, UInt32 frames, AudioBufferList* ioData);
+
+private:
+    struct Node {
+        AUNode node;
+        AudioComponentDescription description;
+        std::shared_ptr<AudioGraphUnit> unit;
+    };
+
+    Node* _FindNode(AUNode node);
+    OSStatus _AddInteraction(const AUNodeInteraction& interaction);
+    OSStatus _Compile(std::unique_ptr<AudioGraphSchedule>* outSchedule);
+    void _Publish(std::unique_ptr<AudioGraphSchedule> schedule);
+    void _FreeRetiredSchedules();
+
+    std::mutex _controlLock;
+    std::vector<Node> _nodes;
+    std::vector<AUNodeInteraction> _interactions;
+    AUNode _nextNode;
+    bool _open;
+    bool _initialized;
+    bool _running;
+
+    // Control to render: the most recently published schedule not yet adopted.
+    std::atomic<AudioGraphSchedule*> _publishedSchedule;
+    // Render to control: schedules the render thread has stopped using.
+    AudioGraphRing<AudioGraphSchedule*, 8> _retiredSchedules;
+    // Owned by the render thread.
+    AudioGraphSchedule* _renderSchedule;
+
+    std::atomic<float> _cpuLoad;
+    std::atomic<float> _maxCPULoad;
+};
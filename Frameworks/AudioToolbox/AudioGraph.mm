@@ -0,0 +1,1247 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "AudioGraph.h"
+
+#import <AudioUnit/AudioUnitParameters.h>
+
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define AUDIO_GRAPH_SSE2 1
+#include <emmintrin.h>
+#elif defined(_M_ARM) || defined(__ARM_NEON)
+#define AUDIO_GRAPH_NEON 1
+#include <arm_neon.h>
+#endif
+
+static const UInt32 c_defaultMaximumFramesPerSlice = 4096;
+static const UInt32 c_defaultMixerInputBuses = 8;
+static const Float64 c_defaultSampleRate = 44100;
+
+static AudioStreamBasicDescription _canonicalFormat(Float64 sampleRate, UInt32 channels) {
+    AudioStreamBasicDescription format = {};
+    format.mSampleRate = sampleRate;
+    format.mFormatID = kAudioFormatLinearPCM;
+    format.mFormatFlags = kAudioFormatFlagsNativeFloatPacked | kAudioFormatFlagIsNonInterleaved;
+    format.mBytesPerPacket = sizeof(float);
+    format.mFramesPerPacket = 1;
+    format.mBytesPerFrame = sizeof(float);
+    format.mChannelsPerFrame = channels;
+    format.mBitsPerChannel = 32;
+    return format;
+}
+
+static bool _isCanonicalFormat(const AudioStreamBasicDescription& format) {
+    return format.mFormatID == kAudioFormatLinearPCM && (format.mFormatFlags & kAudioFormatFlagIsFloat) &&
+           (format.mFormatFlags & kAudioFormatFlagIsNonInterleaved) && !(format.mFormatFlags & kAudioFormatFlagIsBigEndian) &&
+           format.mBitsPerChannel == 32 && format.mBytesPerFrame == sizeof(float) && format.mFramesPerPacket == 1 &&
+           format.mChannelsPerFrame > 0 && format.mSampleRate > 0;
+}
+
+//
+// Kernels
+//
+
+// output[i] = input[i] * gain
+static void _Scale(float* output, const float* input, float gain, UInt32 frames) {
+    UInt32 i = 0;
+#if defined(AUDIO_GRAPH_SSE2)
+    __m128 scale = _mm_set1_ps(gain);
+    for (; i + 8 <= frames; i += 8) {
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(input + i), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_loadu_ps(input + i + 4), scale));
+    }
+#elif defined(AUDIO_GRAPH_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        vst1q_f32(output + i, vmulq_n_f32(vld1q_f32(input + i), gain));
+        vst1q_f32(output + i + 4, vmulq_n_f32(vld1q_f32(input + i + 4), gain));
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[i] = input[i] * gain;
+    }
+}
+
+// output[i] += input[i] * gain
+static void _Accumulate(float* output, const float* input, float gain, UInt32 frames) {
+    UInt32 i = 0;
+#if defined(AUDIO_GRAPH_SSE2)
+    __m128 scale = _mm_set1_ps(gain);
+    for (; i + 8 <= frames; i += 8) {
+        __m128 low = _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(input + i), scale));
+        __m128 high = _mm_add_ps(_mm_loadu_ps(output + i + 4), _mm_mul_ps(_mm_loadu_ps(input + i + 4), scale));
+        _mm_storeu_ps(output + i, low);
+        _mm_storeu_ps(output + i + 4, high);
+    }
+#elif defined(AUDIO_GRAPH_NEON)
+    for (; i + 8 <= frames; i += 8) {
+        vst1q_f32(output + i, vmlaq_n_f32(vld1q_f32(output + i), vld1q_f32(input + i), gain));
+        vst1q_f32(output + i + 4, vmlaq_n_f32(vld1q_f32(output + i + 4), vld1q_f32(input + i + 4), gain));
+    }
+#endif
+    for (; i < frames; ++i) {
+        output[i] += input[i] * gain;
+    }
+}
+
+static float* _channel(const AudioBufferList* list, UInt32 channel) {
+    return static_cast<float*>(list->mBuffers[channel].mData);
+}
+
+// Mono feeds every output channel; otherwise channels pair up one to one.
+static bool _sourceChannel(UInt32 inputChannels, UInt32 outputChannel, UInt32* inputChannel) {
+    *inputChannel = (inputChannels == 1) ? 0 : outputChannel;
+    return *inputChannel < inputChannels;
+}
+
+//
+// AudioGraphUnit
+//
+
+AudioGraphUnit::AudioGraphUnit(AudioGraph* graph, AUNode node, const AudioComponentDescription& description, UInt32 inputBuses)
+    : _graph(graph),
+      _node(node),
+      _description(description),
+      _inputFormats(inputBuses, _canonicalFormat(c_defaultSampleRate, 2)),
+      _outputFormat(_canonicalFormat(c_defaultSampleRate, 2)),
+      _maximumFramesPerSlice(c_defaultMaximumFramesPerSlice),
+      _initialized(false) {
+}
+
+void AudioGraphUnit::PropagateInputFormat(UInt32 bus, const AudioStreamBasicDescription& format) {
+    _inputFormats[bus] = format;
+}
+
+void AudioGraphUnit::_SetInputBusCount(UInt32 count) {
+    _inputFormats.resize(count, _canonicalFormat(_outputFormat.mSampleRate, 2));
+}
+
+static OSStatus _checkElement(AudioUnitScope scope, AudioUnitElement element, UInt32 inputBuses) {
+    UInt32 elements;
+    switch (scope) {
+        case kAudioUnitScope_Global:
+        case kAudioUnitScope_Output:
+            elements = 1;
+            break;
+        case kAudioUnitScope_Input:
+            elements = inputBuses;
+            break;
+        default:
+            return kAudioUnitErr_InvalidScope;
+    }
+    return (element < elements) ? noErr : static_cast<OSStatus>(kAudioUnitErr_InvalidElement);
+}
+
+OSStatus AudioGraphUnit::Initialize() {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    _initialized = true;
+    return noErr;
+}
+
+OSStatus AudioGraphUnit::Uninitialize() {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    _initialized = false;
+    return noErr;
+}
+
+OSStatus AudioGraphUnit::Reset(AudioUnitScope scope, AudioUnitElement element) {
+    // None of the units carry state from one buffer to the next.
+    return noErr;
+}
+
+OSStatus AudioGraphUnit::GetPropertyInfo(
+    AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, UInt32* outSize, Boolean* outWritable) {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    OSStatus status = _checkElement(scope, element, InputBusCount());
+    if (status != noErr) {
+        return status;
+    }
+
+    UInt32 size;
+    Boolean writable = true;
+    switch (propertyID) {
+        case kAudioUnitProperty_StreamFormat:
+            size = sizeof(AudioStreamBasicDescription);
+            break;
+        case kAudioUnitProperty_ElementCount:
+            size = sizeof(UInt32);
+            writable = (scope == kAudioUnitScope_Input) && _CanSetInputBusCount();
+            break;
+        case kAudioUnitProperty_MaximumFramesPerSlice:
+            size = sizeof(UInt32);
+            break;
+        case kAudioUnitProperty_SetRenderCallback:
+            size = sizeof(AURenderCallbackStruct);
+            break;
+        default:
+            return kAudioUnitErr_InvalidProperty;
+    }
+
+    if (outSize) {
+        *outSize = size;
+    }
+    if (outWritable) {
+        *outWritable = writable;
+    }
+    return noErr;
+}
+
+OSStatus AudioGraphUnit::GetProperty(
+    AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, void* outData, UInt32* ioSize) {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    OSStatus status = _checkElement(scope, element, InputBusCount());
+    if (status != noErr) {
+        return status;
+    }
+
+    switch (propertyID) {
+        case kAudioUnitProperty_StreamFormat:
+            if (scope == kAudioUnitScope_Global) {
+                return kAudioUnitErr_InvalidScope;
+            }
+            if (!outData || *ioSize < sizeof(AudioStreamBasicDescription)) {
+                return kAudio_ParamError;
+            }
+            *static_cast<AudioStreamBasicDescription*>(outData) = (scope == kAudioUnitScope_Input) ? _inputFormats[element] : _outputFormat;
+            *ioSize = sizeof(AudioStreamBasicDescription);
+            return noErr;
+
+        case kAudioUnitProperty_ElementCount:
+            if (!outData || *ioSize < sizeof(UInt32)) {
+                return kAudio_ParamError;
+            }
+            *static_cast<UInt32*>(outData) = (scope == kAudioUnitScope_Input) ? InputBusCount() : 1;
+            *ioSize = sizeof(UInt32);
+            return noErr;
+
+        case kAudioUnitProperty_MaximumFramesPerSlice:
+            if (!outData || *ioSize < sizeof(UInt32)) {
+                return kAudio_ParamError;
+            }
+            *static_cast<UInt32*>(outData) = _maximumFramesPerSlice;
+            *ioSize = sizeof(UInt32);
+            return noErr;
+
+        default:
+            return kAudioUnitErr_InvalidProperty;
+    }
+}
+
+OSStatus AudioGraphUnit::SetProperty(
+    AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, const void* data, UInt32 size) {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    OSStatus status = _checkElement(scope, element, InputBusCount());
+    if (status != noErr) {
+        return status;
+    }
+
+    switch (propertyID) {
+        case kAudioUnitProperty_StreamFormat: {
+            if (scope == kAudioUnitScope_Global) {
+                return kAudioUnitErr_InvalidScope;
+            }
+            if (!data || size < sizeof(AudioStreamBasicDescription)) {
+                return kAudio_ParamError;
+            }
+            if (_initialized) {
+                return kAudioUnitErr_Initialized;
+            }
+
+            const AudioStreamBasicDescription& format = *static_cast<const AudioStreamBasicDescription*>(data);
+            if (!_isCanonicalFormat(format)) {
+                return kAudioUnitErr_FormatNotSupported;
+            }
+            ((scope == kAudioUnitScope_Input) ? _inputFormats[element] : _outputFormat) = format;
+            return noErr;
+        }
+
+        case kAudioUnitProperty_ElementCount:
+            if (scope != kAudioUnitScope_Input || !_CanSetInputBusCount()) {
+                return kAudioUnitErr_PropertyNotWritable;
+            }
+            if (!data || size < sizeof(UInt32) || *static_cast<const UInt32*>(data) == 0) {
+                return kAudio_ParamError;
+            }
+            if (_initialized) {
+                return kAudioUnitErr_Initialized;
+            }
+            _SetInputBusCount(*static_cast<const UInt32*>(data));
+            return noErr;
+
+        case kAudioUnitProperty_MaximumFramesPerSlice:
+            if (!data || size < sizeof(UInt32) || *static_cast<const UInt32*>(data) == 0) {
+                return kAudio_ParamError;
+            }
+            if (_initialized) {
+                return kAudioUnitErr_Initialized;
+            }
+            _maximumFramesPerSlice = *static_cast<const UInt32*>(data);
+            return noErr;
+
+        case kAudioUnitProperty_SetRenderCallback:
+            if (scope != kAudioUnitScope_Input) {
+                return kAudioUnitErr_InvalidScope;
+            }
+            if (!data || size < sizeof(AURenderCallbackStruct)) {
+                return kAudio_ParamError;
+            }
+
+            // Unlike the graph's own edits, a unit's render callback takes effect without an AUGraphUpdate.
+            status = _graph->SetNodeInputCallbackLocked(_node, element, *static_cast<const AURenderCallbackStruct*>(data));
+            if (status == noErr && _graph->IsInitializedLocked()) {
+                status = _graph->RepublishLocked();
+            }
+            return status;
+
+        default:
+            return kAudioUnitErr_InvalidProperty;
+    }
+}
+
+OSStatus AudioGraphUnit::GetParameter(AudioUnitParameterID parameterID,
+                                      AudioUnitScope scope,
+                                      AudioUnitElement element,
+                                      AudioUnitParameterValue* outValue) {
+    OSStatus status = _checkElement(scope, element, InputBusCount());
+    if (status != noErr) {
+        return status;
+    }
+    return _GetParameter(parameterID, scope, element, outValue);
+}
+
+OSStatus AudioGraphUnit::SetParameter(AudioUnitParameterID parameterID,
+                                      AudioUnitScope scope,
+                                      AudioUnitElement element,
+                                      AudioUnitParameterValue value,
+                                      UInt32 bufferOffsetInFrames) {
+    OSStatus status = _checkElement(scope, element, InputBusCount());
+    if (status != noErr) {
+        return status;
+    }
+    return _SetParameter(parameterID, scope, element, value);
+}
+
+OSStatus AudioGraphUnit::AddRenderNotifyLocked(AURenderCallback proc, void* userData) {
+    _renderNotifies.push_back({ proc, userData });
+    return _graph->IsInitializedLocked() ? _graph->RepublishLocked() : noErr;
+}
+
+OSStatus AudioGraphUnit::RemoveRenderNotifyLocked(AURenderCallback proc, void* userData) {
+    auto found = std::find_if(_renderNotifies.begin(), _renderNotifies.end(), [proc, userData](const AURenderCallbackStruct& notify) {
+        return notify.inputProc == proc && notify.inputProcRefCon == userData;
+    });
+    if (found == _renderNotifies.end()) {
+        return kAudio_ParamError;
+    }
+
+    _renderNotifies.erase(found);
+    return _graph->IsInitializedLocked() ? _graph->RepublishLocked() : noErr;
+}
+
+OSStatus AudioGraphUnit::AddRenderNotify(AURenderCallback proc, void* userData) {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    return AddRenderNotifyLocked(proc, userData);
+}
+
+OSStatus AudioGraphUnit::RemoveRenderNotify(AURenderCallback proc, void* userData) {
+    std::lock_guard<std::mutex> lock(_graph->ControlLock());
+    return RemoveRenderNotifyLocked(proc, userData);
+}
+
+OSStatus AudioGraphUnit::Render(AudioUnitRenderActionFlags* ioActionFlags,
+                                const AudioTimeStamp* timeStamp,
+                                UInt32 outputBusNumber,
+                                UInt32 frames,
+                                AudioBufferList* ioData) {
+    // Only the output unit pulls the graph; everything upstream of it runs from the compiled schedule.
+    return kAudioUnitErr_CannotDoInCurrentContext;
+}
+
+//
+// Units
+//
+
+// kAudioUnitSubType_MultiChannelMixer: sums its enabled input buses with per-bus volume and pan and an output volume.
+class AudioMixerUnit : public AudioGraphUnit {
+public:
+    AudioMixerUnit(AudioGraph* graph, AUNode node, const AudioComponentDescription& description)
+        : AudioGraphUnit(graph, node, description, c_defaultMixerInputBuses), _outputVolume(1.0f) {
+        _buses.reset(new Bus[c_defaultMixerInputBuses]);
+    }
+
+    void Process(UInt32 frames, const AudioBufferList* const* inputs, AudioBufferList* output) override {
+        UInt32 outputChannels = output->mNumberBuffers;
+        float outputVolume = _outputVolume.load(std::memory_order_relaxed);
+
+        // The first contribution to a channel is written rather than added, so the output is only cleared where nothing mixes in.
+        uint32_t written = 0;
+        for (UInt32 bus = 0; bus < InputBusCount(); ++bus) {
+            const AudioBufferList* input = inputs[bus];
+            float volume = _buses[bus].volume.load(std::memory_order_relaxed) * outputVolume;
+            if (!input || _buses[bus].enable.load(std::memory_order_relaxed) == 0.0f || volume == 0.0f) {
+                continue;
+            }
+
+            float pan = _buses[bus].pan.load(std::memory_order_relaxed);
+            for (UInt32 channel = 0; channel < outputChannels && channel < 32; ++channel) {
+                UInt32 inputChannel;
+                if (!_sourceChannel(input->mNumberBuffers, channel, &inputChannel)) {
+                    continue;
+                }
+
+                float gain = volume;
+                if (outputChannels == 2) {
+                    gain *= std::min(1.0f, (channel == 0) ? 1.0f - pan : 1.0f + pan);
+                }
+
+                if (written & (1u << channel)) {
+                    _Accumulate(_channel(output, channel), _channel(input, inputChannel), gain, frames);
+                } else {
+                    _Scale(_channel(output, channel), _channel(input, inputChannel), gain, frames);
+                    written |= 1u << channel;
+                }
+            }
+        }
+
+        for (UInt32 channel = 0; channel < outputChannels; ++channel) {
+            if (channel >= 32 || !(written & (1u << channel))) {
+                memset(_channel(output, channel), 0, frames * sizeof(float));
+            }
+        }
+    }
+
+protected:
+    bool _CanSetInputBusCount() const override {
+        return true;
+    }
+
+    void _SetInputBusCount(UInt32 count) override {
+        std::unique_ptr<Bus[]> buses(new Bus[count]);
+        for (UInt32 bus = 0; bus < std::min(count, InputBusCount()); ++bus) {
+            buses[bus].volume.store(_buses[bus].volume.load());
+            buses[bus].enable.store(_buses[bus].enable.load());
+            buses[bus].pan.store(_buses[bus].pan.load());
+        }
+        _buses = std::move(buses);
+        AudioGraphUnit::_SetInputBusCount(count);
+    }
+
+    OSStatus _GetParameter(AudioUnitParameterID parameterID,
+                           AudioUnitScope scope,
+                           AudioUnitElement element,
+                           AudioUnitParameterValue* outValue) override {
+        std::atomic<float>* parameter = _Parameter(parameterID, scope, element);
+        if (!parameter) {
+            return kAudioUnitErr_InvalidParameter;
+        }
+        *outValue = parameter->load(std::memory_order_relaxed);
+        return noErr;
+    }
+
+    OSStatus _SetParameter(AudioUnitParameterID parameterID,
+                           AudioUnitScope scope,
+                           AudioUnitElement element,
+                           AudioUnitParameterValue value) override {
+        std::atomic<float>* parameter = _Parameter(parameterID, scope, element);
+        if (!parameter) {
+            return kAudioUnitErr_InvalidParameter;
+        }
+
+        if (parameterID == kMultiChannelMixerParam_Pan) {
+            value = std::max(-1.0f, std::min(1.0f, value));
+        } else if (parameterID == kMultiChannelMixerParam_Volume) {
+            value = std::max(0.0f, value);
+        }
+        parameter->store(value, std::memory_order_relaxed);
+        return noErr;
+    }
+
+private:
+    struct Bus {
+        Bus() : volume(1.0f), enable(1.0f), pan(0.0f) {
+        }
+
+        std::atomic<float> volume;
+        std::atomic<float> enable;
+        std::atomic<float> pan;
+    };
+
+    std::atomic<float>* _Parameter(AudioUnitParameterID parameterID, AudioUnitScope scope, AudioUnitElement element) {
+        if (scope == kAudioUnitScope_Output) {
+            return (parameterID == kMultiChannelMixerParam_Volume) ? &_outputVolume : nullptr;
+        }
+        if (scope != kAudioUnitScope_Input) {
+            return nullptr;
+        }
+
+        switch (parameterID) {
+            case kMultiChannelMixerParam_Volume:
+                return &_buses[element].volume;
+            case kMultiChannelMixerParam_Enable:
+                return &_buses[element].enable;
+            case kMultiChannelMixerParam_Pan:
+                return &_buses[element].pan;
+            default:
+                return nullptr;
+        }
+    }
+
+    std::unique_ptr<Bus[]> _buses;
+    std::atomic<float> _outputVolume;
+};
+
+// kAudioUnitType_Output: the head of the graph. Rendering it runs the whole schedule into the caller's buffers.
+class AudioOutputUnit : public AudioGraphUnit {
+public:
+    AudioOutputUnit(AudioGraph* graph, AUNode node, const AudioComponentDescription& description)
+        : AudioGraphUnit(graph, node, description, 1) {
+    }
+
+    void Process(UInt32 frames, const AudioBufferList* const* inputs, AudioBufferList* output) override {
+        const AudioBufferList* input = inputs[0];
+        for (UInt32 channel = 0; channel < output->mNumberBuffers; ++channel) {
+            UInt32 inputChannel;
+            if (input && _sourceChannel(input->mNumberBuffers, channel, &inputChannel)) {
+                memcpy(_channel(output, channel), _channel(input, inputChannel), frames * sizeof(float));
+            } else {
+                memset(_channel(output, channel), 0, frames * sizeof(float));
+            }
+        }
+    }
+
+    OSStatus Render(AudioUnitRenderActionFlags* ioActionFlags,
+                    const AudioTimeStamp* timeStamp,
+                    UInt32 outputBusNumber,
+                    UInt32 frames,
+                    AudioBufferList* ioData) override {
+        if (outputBusNumber != 0) {
+            return kAudioUnitErr_InvalidElement;
+        }
+        return _graph->Render(ioActionFlags, timeStamp, frames, ioData);
+    }
+};
+
+bool AudioGraphUnit::IsSupported(const AudioComponentDescription& description) {
+    if (description.componentManufacturer != 0 && description.componentManufacturer != kAudioUnitManufacturer_Apple) {
+        return false;
+    }
+
+    switch (description.componentType) {
+        case kAudioUnitType_Mixer:
+            return description.componentSubType == kAudioUnitSubType_MultiChannelMixer;
+        case kAudioUnitType_Output:
+            return description.componentSubType == kAudioUnitSubType_GenericOutput ||
+                   description.componentSubType == kAudioUnitSubType_RemoteIO ||
+                   description.componentSubType == kAudioUnitSubType_VoiceProcessingIO;
+        default:
+            return false;
+    }
+}
+
+std::shared_ptr<AudioGraphUnit> AudioGraphUnit::Create(AudioGraph* graph, AUNode node, const AudioComponentDescription& description) {
+    if (!IsSupported(description)) {
+        return nullptr;
+    }
+    if (description.componentType == kAudioUnitType_Mixer) {
+        return std::make_shared<AudioMixerUnit>(graph, node, description);
+    }
+    return std::make_shared<AudioOutputUnit>(graph, node, description);
+}
+
+//
+// AudioGraphSchedule
+//
+
+// A buffer list with its own storage, for one node's output or one callback's input.
+struct AudioGraphBuffer {
+    AudioGraphBuffer(UInt32 channels, UInt32 maximumFrames)
+        : _list(new uint8_t[offsetof(AudioBufferList, mBuffers) + channels * sizeof(AudioBuffer)]),
+          _samples(new float[channels * maximumFrames]),
+          _maximumFrames(maximumFrames) {
+        List()->mNumberBuffers = channels;
+    }
+
+    AudioBufferList* List() {
+        return reinterpret_cast<AudioBufferList*>(_list.get());
+    }
+
+    float* Channel(UInt32 channel) {
+        return _samples.get() + channel * _maximumFrames;
+    }
+
+    // Render callbacks may point the buffers at their own memory, so every use starts from the storage again.
+    AudioBufferList* Reset(UInt32 frames) {
+        AudioBufferList* list = List();
+        for (UInt32 channel = 0; channel < list->mNumberBuffers; ++channel) {
+            list->mBuffers[channel].mNumberChannels = 1;
+            list->mBuffers[channel].mDataByteSize = frames * sizeof(float);
+            list->mBuffers[channel].mData = Channel(channel);
+        }
+        return list;
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> _list;
+    std::unique_ptr<float[]> _samples;
+    UInt32 _maximumFrames;
+};
+
+struct AudioGraphSchedule {
+    enum InputKind { SilentInput, NodeInput, CallbackInput };
+
+    struct Input {
+        InputKind kind;
+        size_t sourceStep;
+        UInt32 bus;
+        AURenderCallbackStruct callback;
+        AudioGraphBuffer* buffer;
+    };
+
+    struct Step {
+        AudioGraphUnit* unit;
+        std::vector<Input> inputs;
+        std::vector<const AudioBufferList*> inputLists;
+        AudioGraphBuffer* output;
+        std::vector<AURenderCallbackStruct> notifies;
+    };
+
+    AudioGraphSchedule() : active(false), maximumFrames(0), sampleRate(0) {
+    }
+
+    AudioGraphBuffer* AllocateBuffer(UInt32 channels) {
+        buffers.emplace_back(new AudioGraphBuffer(channels, maximumFrames));
+        return buffers.back().get();
+    }
+
+    OSStatus Render(AudioUnitRenderActionFlags* ioActionFlags, const AudioTimeStamp* timeStamp, UInt32 frames, AudioBufferList* ioData);
+
+    bool active;
+    UInt32 maximumFrames;
+    Float64 sampleRate;
+    std::vector<Step> steps;
+    std::vector<std::shared_ptr<AudioGraphUnit>> units;
+    std::vector<std::unique_ptr<AudioGraphBuffer>> buffers;
+};
+
+static void _notify(const std::vector<AURenderCallbackStruct>& notifies,
+                    AudioUnitRenderActionFlags flags,
+                    const AudioTimeStamp* timeStamp,
+                    UInt32 frames,
+                    AudioBufferList* data) {
+    for (const AURenderCallbackStruct& notify : notifies) {
+        AudioUnitRenderActionFlags notifyFlags = flags;
+        notify.inputProc(notify.inputProcRefCon, &notifyFlags, timeStamp, 0, frames, data);
+    }
+}
+
+OSStatus AudioGraphSchedule::Render(AudioUnitRenderActionFlags* ioActionFlags,
+                                    const AudioTimeStamp* timeStamp,
+                                    UInt32 frames,
+                                    AudioBufferList* ioData) {
+    if (!active) {
+        return kAudioUnitErr_Uninitialized;
+    }
+    if (frames > maximumFrames) {
+        return kAudioUnitErr_TooManyFramesToProcess;
+    }
+
+    // The caller may leave mData empty for the graph to supply the buffers.
+    Step& head = steps.back();
+    if (ioData->mNumberBuffers == 0) {
+        return kAudio_ParamError;
+    }
+    for (UInt32 channel = 0; channel < ioData->mNumberBuffers; ++channel) {
+        AudioBuffer& buffer = ioData->mBuffers[channel];
+        if (!buffer.mData) {
+            if (channel >= head.output->List()->mNumberBuffers) {
+                return kAudio_ParamError;
+            }
+            buffer.mData = head.output->Channel(channel);
+            buffer.mDataByteSize = frames * sizeof(float);
+        } else if (buffer.mDataByteSize < frames * sizeof(float)) {
+            return kAudio_ParamError;
+        }
+    }
+
+    for (size_t index = 0; index < steps.size(); ++index) {
+        Step& step = steps[index];
+        AudioBufferList* output = (index + 1 == steps.size()) ? ioData : step.output->Reset(frames);
+        _notify(step.notifies, kAudioUnitRenderAction_PreRender, timeStamp, frames, output);
+
+        for (size_t bus = 0; bus < step.inputs.size(); ++bus) {
+            Input& input = step.inputs[bus];
+            switch (input.kind) {
+                case SilentInput:
+                    step.inputLists[bus] = nullptr;
+                    break;
+
+                case NodeInput:
+                    step.inputLists[bus] = steps[input.sourceStep].output->List();
+                    break;
+
+                case CallbackInput: {
+                    AudioBufferList* list = input.buffer->Reset(frames);
+                    AudioUnitRenderActionFlags flags = 0;
+                    OSStatus status = input.callback.inputProc(input.callback.inputProcRefCon, &flags, timeStamp, input.bus, frames, list);
+                    if (status != noErr) {
+                        return status;
+                    }
+                    step.inputLists[bus] = (flags & kAudioUnitRenderAction_OutputIsSilence) ? nullptr : list;
+                    break;
+                }
+            }
+        }
+
+        step.unit->Process(frames, step.inputLists.data(), output);
+        _notify(step.notifies, kAudioUnitRenderAction_PostRender, timeStamp, frames, output);
+    }
+
+    return noErr;
+}
+
+//
+// AudioGraph
+//
+
+AudioGraph::AudioGraph()
+    : _nextNode(1),
+      _open(false),
+      _initialized(false),
+      _running(false),
+      _publishedSchedule(nullptr),
+      _renderSchedule(nullptr),
+      _cpuLoad(0.0f),
+      _maxCPULoad(0.0f) {
+}
+
+AudioGraph::~AudioGraph() {
+    // Disposing a graph that is still being rendered is the caller's error, so the render side is gone by now.
+    _FreeRetiredSchedules();
+    delete _publishedSchedule.exchange(nullptr);
+    delete _renderSchedule;
+}
+
+AudioGraph::Node* AudioGraph::_FindNode(AUNode node) {
+    auto found = std::find_if(_nodes.begin(), _nodes.end(), [node](const Node& candidate) { return candidate.node == node; });
+    return (found == _nodes.end()) ? nullptr : &*found;
+}
+
+OSStatus AudioGraph::AddNode(const AudioComponentDescription& description, AUNode* outNode) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (!AudioGraphUnit::IsSupported(description)) {
+        return kAUGraphErr_InvalidAudioUnit;
+    }
+
+    if (description.componentType == kAudioUnitType_Output) {
+        for (const Node& node : _nodes) {
+            if (node.description.componentType == kAudioUnitType_Output) {
+                return kAUGraphErr_OutputNodeErr;
+            }
+        }
+    }
+
+    Node node = { _nextNode++, description, nullptr };
+    if (_open) {
+        node.unit = AudioGraphUnit::Create(this, node.node, description);
+    }
+    _nodes.push_back(node);
+    *outNode = node.node;
+    return noErr;
+}
+
+static bool _interactionTargets(const AUNodeInteraction& interaction, AUNode node, UInt32 input) {
+    if (interaction.nodeInteractionType == kAUNodeInteraction_Connection) {
+        return interaction.nodeInteraction.connection.destNode == node && interaction.nodeInteraction.connection.destInputNumber == input;
+    }
+    return interaction.nodeInteraction.inputCallback.destNode == node && interaction.nodeInteraction.inputCallback.destInputNumber == input;
+}
+
+static bool _interactionInvolves(const AUNodeInteraction& interaction, AUNode node) {
+    if (interaction.nodeInteractionType == kAUNodeInteraction_Connection) {
+        return interaction.nodeInteraction.connection.destNode == node || interaction.nodeInteraction.connection.sourceNode == node;
+    }
+    return interaction.nodeInteraction.inputCallback.destNode == node;
+}
+
+OSStatus AudioGraph::RemoveNode(AUNode node) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    Node* found = _FindNode(node);
+    if (!found) {
+        return kAUGraphErr_NodeNotFound;
+    }
+
+    // A schedule that is still rendering keeps its own reference to the unit until it is retired.
+    _interactions.erase(std::remove_if(_interactions.begin(),
+                                       _interactions.end(),
+                                       [node](const AUNodeInteraction& interaction) { return _interactionInvolves(interaction, node); }),
+                        _interactions.end());
+    _nodes.erase(_nodes.begin() + (found - _nodes.data()));
+    return noErr;
+}
+
+OSStatus AudioGraph::GetNodeCount(UInt32* outCount) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    *outCount = _nodes.size();
+    return noErr;
+}
+
+OSStatus AudioGraph::GetIndNode(UInt32 index, AUNode* outNode) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (index >= _nodes.size()) {
+        return kAUGraphErr_NodeNotFound;
+    }
+    *outNode = _nodes[index].node;
+    return noErr;
+}
+
+OSStatus AudioGraph::NodeInfo(AUNode node, AudioComponentDescription* outDescription, AudioUnit* outUnit) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    Node* found = _FindNode(node);
+    if (!found) {
+        return kAUGraphErr_NodeNotFound;
+    }
+
+    if (outDescription) {
+        *outDescription = found->description;
+    }
+    if (outUnit) {
+        *outUnit = found->unit.get();
+    }
+    return noErr;
+}
+
+OSStatus AudioGraph::_AddInteraction(const AUNodeInteraction& interaction) {
+    _interactions.push_back(interaction);
+    return noErr;
+}
+
+OSStatus AudioGraph::ConnectNodeInput(AUNode sourceNode, UInt32 sourceOutput, AUNode destinationNode, UInt32 destinationInput) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    Node* source = _FindNode(sourceNode);
+    Node* destination = _FindNode(destinationNode);
+    if (!source || !destination) {
+        return kAUGraphErr_NodeNotFound;
+    }
+
+    // Every unit has a single output bus, and an input takes one connection at a time.
+    if (sourceNode == destinationNode || sourceOutput != 0 || source->description.componentType == kAudioUnitType_Output ||
+        (destination->unit && destinationInput >= destination->unit->InputBusCount())) {
+        return kAUGraphErr_InvalidConnection;
+    }
+    for (const AUNodeInteraction& interaction : _interactions) {
+        if (_interactionTargets(interaction, destinationNode, destinationInput)) {
+            return kAUGraphErr_InvalidConnection;
+        }
+    }
+
+    AUNodeInteraction interaction = {};
+    interaction.nodeInteractionType = kAUNodeInteraction_Connection;
+    interaction.nodeInteraction.connection = { sourceNode, sourceOutput, destinationNode, destinationInput };
+    return _AddInteraction(interaction);
+}
+
+OSStatus AudioGraph::SetNodeInputCallbackLocked(AUNode destinationNode, UInt32 destinationInput, const AURenderCallbackStruct& callback) {
+    Node* destination = _FindNode(destinationNode);
+    if (!destination) {
+        return kAUGraphErr_NodeNotFound;
+    }
+    if (destination->unit && destinationInput >= destination->unit->InputBusCount()) {
+        return kAUGraphErr_InvalidConnection;
+    }
+
+    // A callback replaces whatever fed the input before; a null callback just disconnects it.
+    _interactions.erase(std::remove_if(_interactions.begin(),
+                                       _interactions.end(),
+                                       [destinationNode, destinationInput](const AUNodeInteraction& interaction) {
+                                           return _interactionTargets(interaction, destinationNode, destinationInput);
+                                       }),
+                        _interactions.end());
+    if (!callback.inputProc) {
+        return noErr;
+    }
+
+    AUNodeInteraction interaction = {};
+    interaction.nodeInteractionType = kAUNodeInteraction_InputCallback;
+    interaction.nodeInteraction.inputCallback = { destinationNode, destinationInput, callback };
+    return _AddInteraction(interaction);
+}
+
+OSStatus AudioGraph::SetNodeInputCallback(AUNode destinationNode, UInt32 destinationInput, const AURenderCallbackStruct& callback) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    return SetNodeInputCallbackLocked(destinationNode, destinationInput, callback);
+}
+
+OSStatus AudioGraph::DisconnectNodeInput(AUNode destinationNode, UInt32 destinationInput) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (!_FindNode(destinationNode)) {
+        return kAUGraphErr_NodeNotFound;
+    }
+
+    auto found = std::find_if(_interactions.begin(),
+                              _interactions.end(),
+                              [destinationNode, destinationInput](const AUNodeInteraction& interaction) {
+                                  return _interactionTargets(interaction, destinationNode, destinationInput);
+                              });
+    if (found == _interactions.end()) {
+        return kAUGraphErr_InvalidConnection;
+    }
+    _interactions.erase(found);
+    return noErr;
+}
+
+OSStatus AudioGraph::ClearConnections() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    _interactions.clear();
+    return noErr;
+}
+
+OSStatus AudioGraph::GetNumberOfInteractions(UInt32* outCount) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    *outCount = _interactions.size();
+    return noErr;
+}
+
+OSStatus AudioGraph::GetInteractionInfo(UInt32 index, AUNodeInteraction* outInteraction) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (index >= _interactions.size()) {
+        return kAudio_ParamError;
+    }
+    *outInteraction = _interactions[index];
+    return noErr;
+}
+
+OSStatus AudioGraph::CountNodeInteractions(AUNode node, UInt32* outCount) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (!_FindNode(node)) {
+        return kAUGraphErr_NodeNotFound;
+    }
+    *outCount = std::count_if(_interactions.begin(), _interactions.end(), [node](const AUNodeInteraction& interaction) {
+        return _interactionInvolves(interaction, node);
+    });
+    return noErr;
+}
+
+OSStatus AudioGraph::GetNodeInteractions(AUNode node, UInt32* ioCount, AUNodeInteraction* outInteractions) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (!_FindNode(node)) {
+        return kAUGraphErr_NodeNotFound;
+    }
+
+    UInt32 count = 0;
+    for (const AUNodeInteraction& interaction : _interactions) {
+        if (count < *ioCount && _interactionInvolves(interaction, node)) {
+            outInteractions[count++] = interaction;
+        }
+    }
+    *ioCount = count;
+    return noErr;
+}
+
+OSStatus AudioGraph::Open() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    for (Node& node : _nodes) {
+        if (!node.unit) {
+            node.unit = AudioGraphUnit::Create(this, node.node, node.description);
+        }
+    }
+    _open = true;
+    return noErr;
+}
+
+OSStatus AudioGraph::Close() {
+    OSStatus status = Uninitialize();
+    if (status != noErr) {
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(_controlLock);
+    for (Node& node : _nodes) {
+        node.unit = nullptr;
+    }
+    _open = false;
+    return noErr;
+}
+
+OSStatus AudioGraph::_Compile(std::unique_ptr<AudioGraphSchedule>* outSchedule) {
+    if (!_open) {
+        return kAUGraphErr_CannotDoInCurrentContext;
+    }
+
+    auto head = std::find_if(_nodes.begin(), _nodes.end(), [](const Node& node) { return node.unit->IsOutput(); });
+    if (head == _nodes.end()) {
+        return kAUGraphErr_OutputNodeErr;
+    }
+
+    auto indexOf = [this](AUNode node) { return static_cast<size_t>(_FindNode(node) - _nodes.data()); };
+
+    // Depth-first from the output node, so every node is scheduled after the nodes that feed it. Nodes that do not reach
+    // the output are left out, and a node met again while its own inputs are still being visited closes a cycle.
+    enum { Unvisited, Visiting, Visited };
+    std::vector<int> state(_nodes.size(), Unvisited);
+    std::vector<size_t> order;
+    std::vector<std::pair<size_t, size_t>> stack = { { static_cast<size_t>(head - _nodes.begin()), 0 } };
+    state[stack.back().first] = Visiting;
+    while (!stack.empty()) {
+        size_t node = stack.back().first;
+        size_t next = stack.back().second;
+
+        bool descended = false;
+        while (next < _interactions.size() && !descended) {
+            const AUNodeInteraction& interaction = _interactions[next++];
+            if (interaction.nodeInteractionType != kAUNodeInteraction_Connection ||
+                interaction.nodeInteraction.connection.destNode != _nodes[node].node) {
+                continue;
+            }
+
+            size_t source = indexOf(interaction.nodeInteraction.connection.sourceNode);
+            if (state[source] == Visiting) {
+                return kAUGraphErr_InvalidConnection;
+            }
+            if (state[source] == Unvisited) {
+                state[source] = Visiting;
+                stack.back().second = next;
+                stack.push_back({ source, 0 });
+                descended = true;
+            }
+        }
+
+        if (!descended) {
+            state[node] = Visited;
+            order.push_back(node);
+            stack.pop_back();
+        }
+    }
+
+    std::unique_ptr<AudioGraphSchedule> schedule(new AudioGraphSchedule());
+    schedule->active = true;
+    schedule->maximumFrames = head->unit->MaximumFramesPerSlice();
+    schedule->sampleRate = head->unit->OutputFormat().mSampleRate;
+
+    std::vector<size_t> stepOf(_nodes.size());
+    for (size_t node : order) {
+        AudioGraphUnit* unit = _nodes[node].unit.get();
+        stepOf[node] = schedule->steps.size();
+
+        AudioGraphSchedule::Step step;
+        step.unit = unit;
+        step.inputs.resize(unit->InputBusCount(), { AudioGraphSchedule::SilentInput, 0, 0, {}, nullptr });
+        step.inputLists.resize(unit->InputBusCount(), nullptr);
+        step.notifies = unit->RenderNotifies();
+
+        for (const AUNodeInteraction& interaction : _interactions) {
+            if (interaction.nodeInteractionType == kAUNodeInteraction_Connection) {
+                const AUNodeConnection& connection = interaction.nodeInteraction.connection;
+                if (connection.destNode != _nodes[node].node) {
+                    continue;
+                }
+                if (connection.destInputNumber >= unit->InputBusCount()) {
+                    return kAUGraphErr_InvalidConnection;
+                }
+
+                // A connection carries the source's format to the destination's input.
+                size_t source = indexOf(connection.sourceNode);
+                unit->PropagateInputFormat(connection.destInputNumber, _nodes[source].unit->OutputFormat());
+                step.inputs[connection.destInputNumber].kind = AudioGraphSchedule::NodeInput;
+                step.inputs[connection.destInputNumber].sourceStep = stepOf[source];
+            } else {
+                const AUNodeRenderCallback& callback = interaction.nodeInteraction.inputCallback;
+                if (callback.destNode != _nodes[node].node) {
+                    continue;
+                }
+                if (callback.destInputNumber >= unit->InputBusCount()) {
+                    return kAUGraphErr_InvalidConnection;
+                }
+
+                AudioGraphSchedule::Input& input = step.inputs[callback.destInputNumber];
+                input.kind = AudioGraphSchedule::CallbackInput;
+                input.bus = callback.destInputNumber;
+                input.callback = callback.cback;
+                input.buffer = schedule->AllocateBuffer(unit->InputFormat(callback.destInputNumber).mChannelsPerFrame);
+            }
+        }
+
+        step.output = schedule->AllocateBuffer(unit->OutputFormat().mChannelsPerFrame);
+        schedule->steps.push_back(std::move(step));
+        schedule->units.push_back(_nodes[node].unit);
+    }
+
+    *outSchedule = std::move(schedule);
+    return noErr;
+}
+
+void AudioGraph::_FreeRetiredSchedules() {
+    AudioGraphSchedule* retired;
+    while (_retiredSchedules.Pop(&retired)) {
+        delete retired;
+    }
+}
+
+void AudioGraph::_Publish(std::unique_ptr<AudioGraphSchedule> schedule) {
+    // The render thread retires at most one schedule per publish, so draining here keeps the ring from ever filling.
+    _FreeRetiredSchedules();
+
+    // A schedule the render thread never picked up was never seen by it, so it can be freed here.
+    delete _publishedSchedule.exchange(schedule.release(), std::memory_order_acq_rel);
+}
+
+OSStatus AudioGraph::RepublishLocked() {
+    std::unique_ptr<AudioGraphSchedule> schedule;
+    OSStatus status = _Compile(&schedule);
+    if (status == noErr) {
+        _Publish(std::move(schedule));
+    }
+    return status;
+}
+
+OSStatus AudioGraph::Initialize() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (_initialized) {
+        return noErr;
+    }
+
+    OSStatus status = RepublishLocked();
+    if (status != noErr) {
+        return status;
+    }
+
+    for (Node& node : _nodes) {
+        node.unit->SetInitialized(true);
+    }
+    _initialized = true;
+    return noErr;
+}
+
+OSStatus AudioGraph::Uninitialize() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (!_initialized) {
+        return noErr;
+    }
+
+    // An inactive schedule makes the output unit fail its renders until the graph is initialized again.
+    _Publish(std::unique_ptr<AudioGraphSchedule>(new AudioGraphSchedule()));
+    for (Node& node : _nodes) {
+        node.unit->SetInitialized(false);
+    }
+    _initialized = false;
+    _running = false;
+    return noErr;
+}
+
+OSStatus AudioGraph::Start() {
+    OSStatus status = Initialize();
+    if (status != noErr) {
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(_controlLock);
+    _running = true;
+    return noErr;
+}
+
+OSStatus AudioGraph::Stop() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    _running = false;
+    return noErr;
+}
+
+OSStatus AudioGraph::Update(Boolean* outIsUpdated) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    if (_initialized) {
+        OSStatus status = RepublishLocked();
+        if (status != noErr) {
+            return status;
+        }
+    }
+
+    // The new schedule is in place for the next buffer the render thread starts.
+    if (outIsUpdated) {
+        *outIsUpdated = true;
+    }
+    return noErr;
+}
+
+bool AudioGraph::IsOpen() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    return _open;
+}
+
+bool AudioGraph::IsInitialized() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    return _initialized;
+}
+
+bool AudioGraph::IsRunning() {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    return _running;
+}
+
+OSStatus AudioGraph::AddRenderNotify(AURenderCallback proc, void* userData) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    auto head = std::find_if(_nodes.begin(), _nodes.end(), [](const Node& node) { return node.unit && node.unit->IsOutput(); });
+    if (head == _nodes.end()) {
+        return kAUGraphErr_OutputNodeErr;
+    }
+    return head->unit->AddRenderNotifyLocked(proc, userData);
+}
+
+OSStatus AudioGraph::RemoveRenderNotify(AURenderCallback proc, void* userData) {
+    std::lock_guard<std::mutex> lock(_controlLock);
+    auto head = std::find_if(_nodes.begin(), _nodes.end(), [](const Node& node) { return node.unit && node.unit->IsOutput(); });
+    if (head == _nodes.end()) {
+        return kAUGraphErr_OutputNodeErr;
+    }
+    return head->unit->RemoveRenderNotifyLocked(proc, userData);
+}
+
+OSStatus AudioGraph::Render(AudioUnitRenderActionFlags* ioActionFlags,
+                            const AudioTimeStamp* timeStamp,
+                            UInt32 frames,
+                            AudioBufferList* ioData) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Graph edits land here, between buffers.
+    AudioGraphSchedule* published = _publishedSchedule.exchange(nullptr, std::memory_order_acq_rel);
+    if (published) {
+        if (_renderSchedule) {
+            _retiredSchedules.Push(_renderSchedule);
+        }
+        _renderSchedule = published;
+    }
+
+    if (!_renderSchedule) {
+        return kAudioUnitErr_Uninitialized;
+    }
+
+    AudioTimeStamp emptyTimeStamp = {};
+    OSStatus status = _renderSchedule->Render(ioActionFlags, timeStamp ? timeStamp : &emptyTimeStamp, frames, ioData);
+
+    if (status == noErr && frames > 0) {
+        // Load is the share of the buffer's duration spent rendering it.
+        float load = static_cast<float>(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() *
+                                        _renderSchedule->sampleRate / frames);
+        float average = _cpuLoad.load(std::memory_order_relaxed);
+        _cpuLoad.store(average + 0.1f * (load - average), std::memory_order_relaxed);
+
+        float maximum = _maxCPULoad.load(std::memory_order_relaxed);
+        while (load > maximum && !_maxCPULoad.compare_exchange_weak(maximum, load, std::memory_order_relaxed)) {
+        }
+    }
+    return status;
+}
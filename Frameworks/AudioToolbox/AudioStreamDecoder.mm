@@ -0,0 +1,727 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import "Starboard.h"
+#import "AudioStreamDecoder.h"
+#import "CAFDecoder.h"
+#import "stb_vorbis.h"
+
+#import <dispatch/dispatch.h>
+#import <fcntl.h>
+#import <algorithm>
+
+static const wchar_t* TAG = L"AudioStreamDecoder";
+
+namespace {
+
+class FileByteSource : public AudioByteSource {
+public:
+    FileByteSource(int fileDescriptor) : _fileDescriptor(fileDescriptor), _length(EbrLseek(fileDescriptor, 0, SEEK_END)) {
+    }
+
+    ~FileByteSource() {
+        EbrClose(_fileDescriptor);
+    }
+
+    int64_t ReadAt(int64_t offset, void* buffer, uint32_t length) override {
+        if (EbrLseek(_fileDescriptor, offset, SEEK_SET) != offset) {
+            return -1;
+        }
+
+        uint32_t total = 0;
+        while (total < length) {
+            int count = EbrRead(_fileDescriptor, static_cast<uint8_t*>(buffer) + total, length - total);
+            if (count < 0) {
+                return -1;
+            } else if (count == 0) {
+                break;
+            }
+            total += count;
+        }
+
+        return total;
+    }
+
+    int64_t Length() override {
+        return _length;
+    }
+
+private:
+    int _fileDescriptor;
+    int64_t _length;
+};
+
+class CallbackByteSource : public AudioByteSource {
+public:
+    CallbackByteSource(void* context, AudioFile_ReadProc readFunc, AudioFile_GetSizeProc getSizeFunc)
+        : _context(context), _readFunc(readFunc), _getSizeFunc(getSizeFunc) {
+    }
+
+    int64_t ReadAt(int64_t offset, void* buffer, uint32_t length) override {
+        UInt32 actualCount = 0;
+        OSStatus status = _readFunc(_context, offset, length, buffer, &actualCount);
+        if (actualCount == 0 && status != 0 && status != kAudioFileEndOfFileError) {
+            return -1;
+        }
+
+        return actualCount;
+    }
+
+    int64_t Length() override {
+        return _getSizeFunc(_context);
+    }
+
+private:
+    void* _context;
+    AudioFile_ReadProc _readFunc;
+    AudioFile_GetSizeProc _getSizeFunc;
+};
+
+// Same rounding and clamping as stb_vorbis' own 16-bit output.
+inline int16_t _SampleFromFloat(float value) {
+    union {
+        float f;
+        int32_t i;
+    } temp;
+    temp.f = value + (1.5f * (1 << (23 - 15)) + 0.5f / (1 << 15));
+    int32_t sample = temp.i - (((150 - 15) << 23) + (1 << 22));
+    return static_cast<int16_t>(std::min(std::max(sample, -32768), 32767));
+}
+
+inline int64_t _ReadInt64LE(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return static_cast<int64_t>(value);
+}
+
+// Feeds an Ogg Vorbis file to stb_vorbis' pushdata API through a sliding window, so only the pages being decoded are in
+// memory. Seeking binary searches an index of page granule positions, built on the first seek.
+class OggVorbisStreamDecoder : public AudioStreamDecoder {
+public:
+    OggVorbisStreamDecoder(std::unique_ptr<AudioByteSource> source)
+        : _source(std::move(source)),
+          _length(0),
+          _handle(nullptr),
+          _inputStart(0),
+          _inputEnd(0),
+          _readOffset(0),
+          _audioOffset(0),
+          _frame(nullptr),
+          _frameSamples(0),
+          _frameOffset(0),
+          _position(0),
+          _atEnd(false),
+          _pagesIndexed(false) {
+    }
+
+    ~OggVorbisStreamDecoder() {
+        if (_handle) {
+            stb_vorbis_close(_handle);
+        }
+    }
+
+    bool Open() {
+        _length = _source->Length();
+        if (!_OpenHandle()) {
+            return false;
+        }
+
+        stb_vorbis_info info = stb_vorbis_get_info(_handle);
+        _channelCount = info.channels;
+        _sampleRate = info.sample_rate;
+        _frameCount = _ReadFrameCount();
+        return _channelCount > 0;
+    }
+
+    uint32_t Decode(int16_t* samples, uint32_t frameCount) override {
+        uint32_t produced = 0;
+        while (produced < frameCount) {
+            if (_frameOffset == _frameSamples && !_NextFrame()) {
+                break;
+            }
+
+            uint32_t count = std::min<uint32_t>(frameCount - produced, _frameSamples - _frameOffset);
+            int16_t* out = samples + produced * _channelCount;
+            for (uint32_t i = 0; i < count; ++i) {
+                for (uint32_t channel = 0; channel < _channelCount; ++channel) {
+                    *out++ = _SampleFromFloat(_frame[channel][_frameOffset + i]);
+                }
+            }
+
+            produced += count;
+            _frameOffset += count;
+            _position += count;
+        }
+
+        return produced;
+    }
+
+    bool Seek(int64_t frame) override {
+        if (frame < 0) {
+            return false;
+        }
+
+        if (_frameCount >= 0 && frame >= _frameCount) {
+            _ClearFrame();
+            _atEnd = true;
+            _position = _frameCount;
+            return true;
+        }
+
+        // Close enough to decode forward, or back within the frame already decoded.
+        int64_t frameStart = _position - _frameOffset;
+        if (!_atEnd && frame >= frameStart && frame < _position + c_forwardSeekFrames) {
+            if (frame < _position) {
+                _frameOffset = static_cast<int>(frame - frameStart);
+                _position = frame;
+                return true;
+            }
+            return _SkipTo(frame);
+        }
+
+        if (!_pagesIndexed) {
+            _BuildPageIndex();
+        }
+
+        // Resynchronize on the page before one that ends at or before the target, backing off further whenever the first
+        // exact position still lands past it. The last page is never used, since stb_vorbis trims the final frame.
+        auto it = std::upper_bound(_pages.begin(), _pages.end(), frame, [](int64_t value, const Page& page) {
+            return value < page.granule;
+        });
+        ptrdiff_t exactIndex = std::min<ptrdiff_t>((it - _pages.begin()) - 1, static_cast<ptrdiff_t>(_pages.size()) - 2);
+        ptrdiff_t backoff = 1;
+        while (exactIndex >= 1) {
+            if (!_ResyncAt(_pages[exactIndex - 1], _pages[exactIndex])) {
+                break;
+            }
+            if (_position <= frame) {
+                return _SkipTo(frame);
+            }
+            exactIndex -= backoff;
+            backoff *= 2;
+        }
+
+        // The target is within the first pages; decode from the start.
+        return _OpenHandle() && _SkipTo(frame);
+    }
+
+private:
+    static const size_t c_inputWindowBytes = 64 * 1024;
+    static const size_t c_inputLowWaterBytes = 16 * 1024;
+    static const int64_t c_pageHeaderBytes = 27;
+    static const int64_t c_maximumPageBytes = c_pageHeaderBytes + 255 + 255 * 255;
+    static const int64_t c_forwardSeekFrames = 16384;
+
+    struct Page {
+        int64_t offset;
+        int64_t end;
+        int64_t granule;
+    };
+
+    void _ClearFrame() {
+        _frame = nullptr;
+        _frameSamples = 0;
+        _frameOffset = 0;
+    }
+
+    // Moves the unconsumed input to the front of the window and reads more behind it, doubling the window when it is
+    // already full. Returns false once nothing more can be read.
+    bool _Refill() {
+        if (_inputStart > 0) {
+            memmove(_input.data(), _input.data() + _inputStart, _inputEnd - _inputStart);
+            _inputEnd -= _inputStart;
+            _inputStart = 0;
+        }
+
+        if (_inputEnd == _input.size()) {
+            _input.resize(std::max(c_inputWindowBytes, _input.size() * 2));
+        }
+
+        if (_readOffset >= _length) {
+            return false;
+        }
+
+        int64_t count = _source->ReadAt(_readOffset, _input.data() + _inputEnd, static_cast<uint32_t>(_input.size() - _inputEnd));
+        if (count <= 0) {
+            _length = _readOffset;
+            return false;
+        }
+
+        _inputEnd += static_cast<size_t>(count);
+        _readOffset += count;
+        return true;
+    }
+
+    void _ResetInput(int64_t offset) {
+        _inputStart = 0;
+        _inputEnd = 0;
+        _readOffset = offset;
+    }
+
+    bool _OpenHandle() {
+        if (_handle) {
+            stb_vorbis_close(_handle);
+            _handle = nullptr;
+        }
+
+        _ResetInput(0);
+
+        // The setup header holds the codebooks and can be large, so grow the window until it fits.
+        int error = VORBIS_need_more_data;
+        while (error == VORBIS_need_more_data && _Refill()) {
+            int used = 0;
+            error = 0;
+            _handle = stb_vorbis_open_pushdata(_input.data() + _inputStart, static_cast<int>(_inputEnd - _inputStart), &used, &error, nullptr);
+            if (_handle) {
+                _inputStart += used;
+                break;
+            }
+        }
+
+        if (!_handle) {
+            TraceError(TAG, L"Ogg Vorbis open error: %d", error);
+            return false;
+        }
+
+        _audioOffset = _ConsumedOffset();
+        _ClearFrame();
+        _position = 0;
+        _atEnd = false;
+        return true;
+    }
+
+    bool _NextFrame() {
+        _ClearFrame();
+        if (_atEnd) {
+            return false;
+        }
+
+        for (;;) {
+            if (_inputEnd - _inputStart < c_inputLowWaterBytes) {
+                _Refill();
+            }
+
+            int channels = 0;
+            int samples = 0;
+            float** output = nullptr;
+            int used = stb_vorbis_decode_frame_pushdata(
+                _handle, _input.data() + _inputStart, static_cast<int>(_inputEnd - _inputStart), &channels, &output, &samples);
+            _inputStart += used;
+
+            if (samples > 0) {
+                _frame = output;
+                _frameSamples = samples;
+                return true;
+            }
+
+            // Nothing consumed means stb_vorbis needs a whole packet it doesn't have yet.
+            if (used == 0 && !_Refill()) {
+                _atEnd = true;
+                return false;
+            }
+        }
+    }
+
+    // Decodes and drops frames up to the target.
+    bool _SkipTo(int64_t frame) {
+        while (_position < frame) {
+            if (_frameOffset == _frameSamples && !_NextFrame()) {
+                break;
+            }
+
+            int count = static_cast<int>(std::min<int64_t>(frame - _position, _frameSamples - _frameOffset));
+            _frameOffset += count;
+            _position += count;
+        }
+
+        return true;
+    }
+
+    int64_t _ConsumedOffset() const {
+        return _readOffset - static_cast<int64_t>(_inputEnd - _inputStart);
+    }
+
+    // Restarts decoding after page. stb_vorbis takes its position from the granule of the page it resynchronizes on, which
+    // is off by the window overlap when block sizes change, until it decodes the packet completing a later page. So decode
+    // past the end of exactPage before reading the position.
+    bool _ResyncAt(const Page& page, const Page& exactPage) {
+        stb_vorbis_flush_pushdata(_handle);
+        _ResetInput(page.offset);
+        _atEnd = false;
+
+        while (_NextFrame()) {
+            if (_ConsumedOffset() >= exactPage.end) {
+                int end = stb_vorbis_get_sample_offset(_handle);
+                if (end < 0) {
+                    return false;
+                }
+
+                _position = end - _frameSamples;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // The stream length is the granule position of the last page, found by scanning back from the end of the file.
+    int64_t _ReadFrameCount() {
+        int64_t tailBytes = std::min(_length, c_maximumPageBytes);
+        std::vector<uint8_t> tail(static_cast<size_t>(tailBytes));
+        if (tailBytes < c_pageHeaderBytes || _source->ReadAt(_length - tailBytes, tail.data(), static_cast<uint32_t>(tailBytes)) != tailBytes) {
+            return -1;
+        }
+
+        for (int64_t i = tailBytes - c_pageHeaderBytes; i >= 0; --i) {
+            const uint8_t* page = &tail[i];
+            if (memcmp(page, "OggS", 4) != 0 || page[4] != 0 || i + c_pageHeaderBytes + page[26] > tailBytes) {
+                continue;
+            }
+
+            int64_t pageBytes = c_pageHeaderBytes + page[26];
+            for (int segment = 0; segment < page[26]; ++segment) {
+                pageBytes += page[c_pageHeaderBytes + segment];
+            }
+
+            int64_t granule = _ReadInt64LE(page + 6);
+            if (i + pageBytes <= tailBytes && granule >= 0) {
+                return granule;
+            }
+        }
+
+        return -1;
+    }
+
+    // Walks the page headers after the Vorbis headers without reading the page bodies.
+    void _BuildPageIndex() {
+        _pagesIndexed = true;
+
+        uint8_t header[c_pageHeaderBytes + 255];
+        int64_t offset = _audioOffset;
+        while (offset + c_pageHeaderBytes <= _length) {
+            int64_t count = _source->ReadAt(offset, header, sizeof(header));
+            if (count < c_pageHeaderBytes || memcmp(header, "OggS", 4) != 0 || count < c_pageHeaderBytes + header[26]) {
+                break;
+            }
+
+            uint8_t segmentCount = header[26];
+            int64_t bodyBytes = 0;
+            for (int segment = 0; segment < segmentCount; ++segment) {
+                bodyBytes += header[c_pageHeaderBytes + segment];
+            }
+
+            // Only pages whose last packet ends on them carry an exact position.
+            int64_t end = offset + c_pageHeaderBytes + segmentCount + bodyBytes;
+            int64_t granule = _ReadInt64LE(header + 6);
+            if (granule >= 0 && segmentCount > 0 && header[c_pageHeaderBytes + segmentCount - 1] != 255) {
+                _pages.push_back({ offset, end, granule });
+            }
+
+            offset = end;
+        }
+    }
+
+    std::unique_ptr<AudioByteSource> _source;
+    int64_t _length;
+    stb_vorbis* _handle;
+
+    // Bytes [_inputStart, _inputEnd) of _input are the file bytes just before _readOffset.
+    std::vector<uint8_t> _input;
+    size_t _inputStart;
+    size_t _inputEnd;
+    int64_t _readOffset;
+    int64_t _audioOffset;
+
+    // The last frame stb_vorbis decoded, per channel, and how much of it has been returned.
+    float** _frame;
+    int _frameSamples;
+    int _frameOffset;
+    int64_t _position;
+    bool _atEnd;
+
+    std::vector<Page> _pages;
+    bool _pagesIndexed;
+};
+
+const size_t OggVorbisStreamDecoder::c_inputWindowBytes;
+const size_t OggVorbisStreamDecoder::c_inputLowWaterBytes;
+const int64_t OggVorbisStreamDecoder::c_pageHeaderBytes;
+const int64_t OggVorbisStreamDecoder::c_maximumPageBytes;
+const int64_t OggVorbisStreamDecoder::c_forwardSeekFrames;
+
+// Reads CAF packets straight from the data chunk. CAFDecoder handles fixed-size packets only, so the packet holding any
+// frame is found by arithmetic rather than through the packet table.
+class CAFStreamDecoder : public AudioStreamDecoder {
+public:
+    CAFStreamDecoder(std::unique_ptr<AudioByteSource> source)
+        : _source(std::move(source)), _framesPerPacket(1), _packetsPerRead(1), _nextPacket(0), _blockFrames(0), _blockOffset(0), _position(0) {
+    }
+
+    bool Open() {
+        if (!_decoder.InitForRead(*_source)) {
+            return false;
+        }
+
+        _channelCount = _decoder.OutputFormat.mChannelsPerFrame;
+        _sampleRate = _decoder.OutputFormat.mSampleRate;
+        _frameCount = _decoder.FrameCount();
+        _framesPerPacket = _decoder.FramesPerPacket();
+        _packetsPerRead = std::max<uint32_t>(1, AudioDecodeAheadBuffer::c_decodeChunkFrames / _framesPerPacket);
+        _packets.resize(_packetsPerRead * _decoder.BytesPerPacket());
+        _block.resize(_packetsPerRead * _framesPerPacket * _channelCount);
+        return Seek(0);
+    }
+
+    uint32_t Decode(int16_t* samples, uint32_t frameCount) override {
+        uint32_t produced = 0;
+        while (produced < frameCount && _position < _frameCount) {
+            if (_blockOffset == _blockFrames && !_ReadBlock()) {
+                break;
+            }
+
+            uint32_t count = static_cast<uint32_t>(
+                std::min<int64_t>(std::min(frameCount - produced, _blockFrames - _blockOffset), _frameCount - _position));
+            memcpy(samples + produced * _channelCount, &_block[_blockOffset * _channelCount], count * _channelCount * sizeof(int16_t));
+
+            produced += count;
+            _blockOffset += count;
+            _position += count;
+        }
+
+        return produced;
+    }
+
+    bool Seek(int64_t frame) override {
+        if (frame < 0) {
+            return false;
+        }
+
+        frame = std::min(frame, _frameCount);
+        int64_t fileFrame = frame + _decoder.PrimingFrames();
+
+        _nextPacket = fileFrame / _framesPerPacket;
+        _blockFrames = 0;
+        _blockOffset = 0;
+        _position = frame;
+        _decoder.ResetChannelState();
+
+        uint32_t skip = static_cast<uint32_t>(fileFrame % _framesPerPacket);
+        if (skip > 0 && frame < _frameCount) {
+            if (!_ReadBlock()) {
+                return false;
+            }
+            _blockOffset = skip;
+        }
+
+        return true;
+    }
+
+private:
+    bool _ReadBlock() {
+        uint32_t bytesPerPacket = _decoder.BytesPerPacket();
+        int64_t packetCount = std::min<int64_t>(_packetsPerRead, _decoder.PacketCount() - _nextPacket);
+        if (packetCount <= 0) {
+            return false;
+        }
+
+        int64_t count = _source->ReadAt(
+            _decoder.DataOffset() + _nextPacket * bytesPerPacket, _packets.data(), static_cast<uint32_t>(packetCount * bytesPerPacket));
+        if (count < bytesPerPacket) {
+            return false;
+        }
+
+        packetCount = count / bytesPerPacket;
+        _decoder.DecodePackets(_packets.data(), static_cast<uint32_t>(packetCount), _block.data());
+
+        _nextPacket += packetCount;
+        _blockFrames = static_cast<uint32_t>(packetCount) * _framesPerPacket;
+        _blockOffset = 0;
+        return true;
+    }
+
+    std::unique_ptr<AudioByteSource> _source;
+    CAFDecoder _decoder;
+    uint32_t _framesPerPacket;
+    uint32_t _packetsPerRead;
+    std::vector<uint8_t> _packets;
+
+    // Frames decoded from the packets before _nextPacket.
+    std::vector<int16_t> _block;
+    int64_t _nextPacket;
+    uint32_t _blockFrames;
+    uint32_t _blockOffset;
+    int64_t _position;
+};
+
+} // namespace
+
+const uint32_t AudioDecodeAheadBuffer::c_defaultCapacityFrames;
+const uint32_t AudioDecodeAheadBuffer::c_decodeChunkFrames;
+
+std::unique_ptr<AudioByteSource> AudioByteSource::CreateWithPath(const char* path) {
+    int fileDescriptor = EbrOpen(path, O_RDONLY | _O_BINARY, _SH_DENYWR);
+    if (fileDescriptor == -1) {
+        return nullptr;
+    }
+
+    return std::make_unique<FileByteSource>(fileDescriptor);
+}
+
+std::unique_ptr<AudioByteSource> AudioByteSource::CreateWithCallbacks(void* context,
+                                                                      AudioFile_ReadProc readFunc,
+                                                                      AudioFile_GetSizeProc getSizeFunc) {
+    return std::make_unique<CallbackByteSource>(context, readFunc, getSizeFunc);
+}
+
+std::unique_ptr<AudioStreamDecoder> AudioStreamDecoder::CreateOggVorbis(std::unique_ptr<AudioByteSource> source) {
+    auto decoder = std::make_unique<OggVorbisStreamDecoder>(std::move(source));
+    if (!decoder->Open()) {
+        return nullptr;
+    }
+
+    return std::move(decoder);
+}
+
+std::unique_ptr<AudioStreamDecoder> AudioStreamDecoder::CreateCAF(std::unique_ptr<AudioByteSource> source) {
+    auto decoder = std::make_unique<CAFStreamDecoder>(std::move(source));
+    if (!decoder->Open()) {
+        return nullptr;
+    }
+
+    return std::move(decoder);
+}
+
+AudioDecodeAheadBuffer::AudioDecodeAheadBuffer(std::unique_ptr<AudioStreamDecoder> decoder, uint32_t capacityFrames)
+    : _decoder(std::move(decoder)),
+      _channelCount(_decoder->ChannelCount()),
+      _capacityFrames(std::max(capacityFrames, c_decodeChunkFrames)),
+      _scratch(c_decodeChunkFrames * _channelCount),
+      _ring(_capacityFrames * _channelCount),
+      _head(0),
+      _bufferedFrames(0),
+      _position(0),
+      _endOfStream(false),
+      _filling(false),
+      _closing(false) {
+    // Start decoding right away so the first read finds frames waiting.
+    std::lock_guard<std::mutex> lock(_lock);
+    _ScheduleFillLocked();
+}
+
+AudioDecodeAheadBuffer::~AudioDecodeAheadBuffer() {
+    std::unique_lock<std::mutex> lock(_lock);
+    _closing = true;
+    _changed.wait(lock, [this]() { return !_filling; });
+}
+
+uint32_t AudioDecodeAheadBuffer::Read(int16_t* samples, uint32_t frameCount) {
+    std::unique_lock<std::mutex> lock(_lock);
+
+    uint32_t copied = 0;
+    while (copied < frameCount) {
+        if (_bufferedFrames == 0) {
+            if (_endOfStream) {
+                break;
+            }
+
+            _ScheduleFillLocked();
+            _changed.wait(lock);
+            continue;
+        }
+
+        uint32_t count = std::min(std::min(frameCount - copied, _bufferedFrames), _capacityFrames - _head);
+        memcpy(samples + copied * _channelCount, &_ring[_head * _channelCount], count * _channelCount * sizeof(int16_t));
+
+        _head = (_head + count) % _capacityFrames;
+        _bufferedFrames -= count;
+        _position += count;
+        copied += count;
+    }
+
+    if (_bufferedFrames < _capacityFrames / 2) {
+        _ScheduleFillLocked();
+    }
+
+    return copied;
+}
+
+bool AudioDecodeAheadBuffer::Seek(int64_t frame) {
+    std::lock_guard<std::mutex> decodeLock(_decodeLock);
+    bool succeeded = _decoder->Seek(frame);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _head = 0;
+    _bufferedFrames = 0;
+    _position = frame;
+    if (_decoder->FrameCount() >= 0) {
+        _position = std::min(_position, _decoder->FrameCount());
+    }
+
+    // A failed seek leaves the decoder somewhere unknown, so don't hand out anything more from it.
+    _endOfStream = !succeeded;
+    _ScheduleFillLocked();
+    return succeeded;
+}
+
+int64_t AudioDecodeAheadBuffer::Position() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _position;
+}
+
+void AudioDecodeAheadBuffer::_ScheduleFillLocked() {
+    if (_filling || _endOfStream || _closing) {
+        return;
+    }
+
+    _filling = true;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        _Fill();
+    });
+}
+
+void AudioDecodeAheadBuffer::_Fill() {
+    for (;;) {
+        {
+            // The destructor may run as soon as _filling clears, so nothing after this may touch the object.
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_closing || _endOfStream || _capacityFrames - _bufferedFrames < c_decodeChunkFrames) {
+                _filling = false;
+                _changed.notify_all();
+                return;
+            }
+        }
+
+        // Seeks wait on _decodeLock, so the frames decoded here always continue the frames already in the ring.
+        std::lock_guard<std::mutex> decodeLock(_decodeLock);
+        uint32_t frames = _decoder->Decode(_scratch.data(), c_decodeChunkFrames);
+
+        std::lock_guard<std::mutex> lock(_lock);
+        uint32_t tail = (_head + _bufferedFrames) % _capacityFrames;
+        uint32_t first = std::min(frames, _capacityFrames - tail);
+        memcpy(&_ring[tail * _channelCount], _scratch.data(), first * _channelCount * sizeof(int16_t));
+        memcpy(&_ring[0], _scratch.data() + first * _channelCount, (frames - first) * _channelCount * sizeof(int16_t));
+        _bufferedFrames += frames;
+
+        // Decoders only come up short at the end of the stream.
+        if (frames < c_decodeChunkFrames) {
+            _endOfStream = true;
+        }
+
+        _changed.notify_all();
+    }
+}
@@ -15,268 +15,341 @@
 //******************************************************************************
 
 #import <AudioToolbox/AudioUnitProcessingGraph.h>
-#import <StubReturn.h>
+
+#include "AudioGraph.h"
+
+static AudioGraph* _graph(AUGraph graph) {
+    return reinterpret_cast<AudioGraph*>(graph);
+}
+
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Supports the multichannel mixer and the generic, remote and voice processing output units.
 */
 OSStatus AUGraphAddNode(AUGraph inGraph, const AudioComponentDescription* inDescription, AUNode* outNode) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !inDescription || !outNode) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->AddNode(*inDescription, outNode);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Notifies around the output unit's render.
 */
 OSStatus AUGraphAddRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !inCallback) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->AddRenderNotify(inCallback, inRefCon);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphClearConnections(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->ClearConnections();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphClose(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Close();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Units have a single output bus. Takes effect on AUGraphUpdate once the graph is initialized.
 */
 OSStatus AUGraphConnectNodeInput(
     AUGraph inGraph, AUNode inSourceNode, UInt32 inSourceOutputNumber, AUNode inDestNode, UInt32 inDestInputNumber) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->ConnectNodeInput(inSourceNode, inSourceOutputNumber, inDestNode, inDestInputNumber);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphCountNodeInteractions(AUGraph inGraph, AUNode inNode, UInt32* outNumInteractions) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outNumInteractions) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->CountNodeInteractions(inNode, outNumInteractions);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Takes effect on AUGraphUpdate once the graph is initialized.
 */
 OSStatus AUGraphDisconnectNodeInput(AUGraph inGraph, AUNode inDestNode, UInt32 inDestInputNumber) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->DisconnectNodeInput(inDestNode, inDestInputNumber);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes A running average of the time spent rendering as a share of each buffer's duration.
 */
 OSStatus AUGraphGetCPULoad(AUGraph inGraph, Float32* outAverageCPULoad) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outAverageCPULoad) {
+        return kAudio_ParamError;
+    }
+    *outAverageCPULoad = _graph(inGraph)->CPULoad();
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphGetIndNode(AUGraph inGraph, UInt32 inIndex, AUNode* outNode) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outNode) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->GetIndNode(inIndex, outNode);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphGetInteractionInfo(AUGraph inGraph, UInt32 inInteractionIndex, AUNodeInteraction* outInteraction) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outInteraction) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->GetInteractionInfo(inInteractionIndex, outInteraction);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Returns the highest load since the previous call.
 */
 OSStatus AUGraphGetMaxCPULoad(AUGraph inGraph, Float32* outMaxLoad) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outMaxLoad) {
+        return kAudio_ParamError;
+    }
+    *outMaxLoad = _graph(inGraph)->TakeMaxCPULoad();
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphGetNodeCount(AUGraph inGraph, UInt32* outNumberOfNodes) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outNumberOfNodes) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->GetNodeCount(outNumberOfNodes);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphGetNodeInteractions(AUGraph inGraph, AUNode inNode, UInt32* ioNumInteractions, AUNodeInteraction* outInteractions) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !ioNumInteractions || (*ioNumInteractions > 0 && !outInteractions)) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->GetNodeInteractions(inNode, ioNumInteractions, outInteractions);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphGetNumberOfInteractions(AUGraph inGraph, UInt32* outNumInteractions) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outNumInteractions) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->GetNumberOfInteractions(outNumInteractions);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Compiles the graph into its render schedule. The graph must be open and have an output node.
 */
 OSStatus AUGraphInitialize(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Initialize();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphIsInitialized(AUGraph inGraph, Boolean* outIsInitialized) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outIsInitialized) {
+        return kAudio_ParamError;
+    }
+    *outIsInitialized = _graph(inGraph)->IsInitialized();
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphIsOpen(AUGraph inGraph, Boolean* outIsOpen) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outIsOpen) {
+        return kAudio_ParamError;
+    }
+    *outIsOpen = _graph(inGraph)->IsOpen();
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphIsRunning(AUGraph inGraph, Boolean* outIsRunning) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !outIsRunning) {
+        return kAudio_ParamError;
+    }
+    *outIsRunning = _graph(inGraph)->IsRunning();
+    return noErr;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes The audio unit is only available while the graph is open.
 */
 OSStatus AUGraphNodeInfo(AUGraph inGraph, AUNode inNode, AudioComponentDescription* outDescription, AudioUnit _Nullable* outAudioUnit) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->NodeInfo(inNode, outDescription, outAudioUnit);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphOpen(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Open();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Takes effect on AUGraphUpdate once the graph is initialized.
 */
 OSStatus AUGraphRemoveNode(AUGraph inGraph, AUNode inNode) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->RemoveNode(inNode);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphRemoveRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !inCallback) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->RemoveRenderNotify(inCallback, inRefCon);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Takes effect on AUGraphUpdate once the graph is initialized.
 */
 OSStatus AUGraphSetNodeInputCallback(AUGraph inGraph,
                                      AUNode inDestNode,
                                      UInt32 inDestInputNumber,
                                      const AURenderCallbackStruct* inInputCallback) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph || !inInputCallback) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->SetNodeInputCallback(inDestNode, inDestInputNumber, *inInputCallback);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Initializes the graph if needed and marks it running, but nothing drives a device yet: the graph renders when its
+        output unit is pulled with AudioUnitRender, which also works offline without starting the graph.
 */
 OSStatus AUGraphStart(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Start();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphStop(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Stop();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus AUGraphUninitialize(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Uninitialize();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Recompiles an initialized graph. The render thread switches to the new schedule at the start of its next buffer,
+        without the render callback ever taking a lock.
 */
 OSStatus AUGraphUpdate(AUGraph inGraph, Boolean* outIsUpdated) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    return _graph(inGraph)->Update(outIsUpdated);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes The graph must no longer be rendering.
 */
 OSStatus DisposeAUGraph(AUGraph inGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inGraph) {
+        return kAudio_ParamError;
+    }
+    delete _graph(inGraph);
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSStatus NewAUGraph(AUGraph _Nullable* outGraph) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!outGraph) {
+        return kAudio_ParamError;
+    }
+    *outGraph = reinterpret_cast<AUGraph>(new AudioGraph());
+    return noErr;
 }
\ No newline at end of file
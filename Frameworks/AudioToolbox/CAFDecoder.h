@@ -17,7 +17,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <vector>
-#include <Foundation/NSInputStream.h>
+
+class AudioByteSource;
 
 uint32_t int32Swap(uint32_t val);
 uint64_t int64Swap(uint64_t val);
@@ -42,6 +43,11 @@ private:
             mPredictedSample = 0;
             mStepTableIndex = 0;
         }
+        // No stored step index matches, so CheckState takes the next packet header as is.
+        inline void Invalidate() {
+            mPredictedSample = 0;
+            mStepTableIndex = -1;
+        }
     };
 
     enum {
@@ -53,6 +59,7 @@ private:
     };
 
     bool isPcm;
+    bool isBigEndianPcm;
     static const SInt32 kPredTolerance;
     static const UInt32 kIndexMask;
     static const UInt32 kPredictorMask;
@@ -120,30 +127,49 @@ private:
 
 #pragma pack(pop)
 
-    enum {
-        kAudioCodecProduceOutputPacketSuccess,
-        kAudioCodecProduceOutputPacketNeedsMoreInputData,
-        kAudioCodecProduceOutputPacketSuccessHasMore
-    } Result;
-
-    Byte* GetBytes(NSInputStream* stream, int len);
-
     typedef std::vector<ChannelState> ChannelStateList;
 
-    void ProduceOutputPackets(NSInputStream* stream,
-                              ChannelStateList& mChannelStateList,
-                              void* outOutputData,
-                              UInt32& ioOutputDataByteSize,
-                              OutputDescription& mOutputFormat,
-                              CAFAudioDescription& mInputFormat);
     CAFAudioDescription cafDesc;
     CAFPacketTableHeader cafPacketTbl;
+    bool hasPacketTable;
+    int64_t dataOffset;
+    int64_t dataByteCount;
 
     ChannelStateList channelStates;
 
 public:
     OutputDescription OutputFormat;
 
-    bool InitForRead(NSInputStream* stream);
-    int ReadBuf(NSInputStream* stream, int16_t* samplesOut, uint32_t& ioOutputDataByteSize);
+    // Parses the chunks up to the audio data. The packets themselves are left in the source.
+    bool InitForRead(AudioByteSource& source);
+
+    // Location of the packet data within the file.
+    int64_t DataOffset() const {
+        return dataOffset;
+    }
+    int64_t DataByteCount() const {
+        return dataByteCount;
+    }
+
+    uint32_t BytesPerPacket() const {
+        return cafDesc.mBytesPerPacket;
+    }
+    uint32_t FramesPerPacket() const {
+        return isPcm ? 1 : kIMAFramesPerPacket;
+    }
+    int64_t PacketCount() const {
+        return dataByteCount / cafDesc.mBytesPerPacket;
+    }
+
+    // Frames of encoder delay at the start of the first packet.
+    int64_t PrimingFrames() const;
+
+    // Playable frames, which the packet table can trim below PacketCount() * FramesPerPacket().
+    int64_t FrameCount() const;
+
+    // Decodes whole packets read from DataOffset() into interleaved 16-bit samples.
+    void DecodePackets(const Byte* packets, uint32_t packetCount, int16_t* samplesOut);
+
+    // Forgets the IMA4 predictor state so the next packet decodes from its own header, as after a seek.
+    void ResetChannelState();
 };
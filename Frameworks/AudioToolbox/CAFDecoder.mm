@@ -17,8 +17,11 @@
 #include "Starboard.h"
 #include "AudioToolbox/AudioFile.h"
 #include "CAFDecoder.h"
+#include "AudioStreamDecoder.h"
 #include "LoggingNative.h"
 
+#include <algorithm>
+
 static const wchar_t* TAG = L"CAFDecoder";
 
 const SInt32 CAFDecoder::kPredTolerance = 0x007F;
@@ -184,172 +187,170 @@ double dSwap(double val) {
     return ret;
 }
 
-Byte* CAFDecoder::GetBytes(NSInputStream* stream, int len) {
-    Byte* ret = (Byte*)IwMalloc(len);
-    [stream read:ret maxLength:len];
-    return ret;
-}
-
-void CAFDecoder::ProduceOutputPackets(NSInputStream* stream,
-                                      ChannelStateList& mChannelStateList,
-                                      void* outOutputData,
-                                      UInt32& ioOutputDataByteSize,
-                                      OutputDescription& mOutputFormat,
-                                      CAFAudioDescription& mInputFormat) {
-    UInt32 ioNumberPackets = 1;
-
-    if (isPcm) {
-        NSInteger result =
-            [stream read:(uint8_t*)outOutputData maxLength:(cafDesc.mBytesPerPacket * (ioOutputDataByteSize / cafDesc.mBytesPerPacket))];
-        ioNumberPackets = (result / cafDesc.mBytesPerPacket);
-        ioOutputDataByteSize = result;
-        return;
-    }
-
-    //  Note that the decoder doesn't suffer from the same problem the encoder
-    //  does with not having enough data for a packet, since the encoded data
-    //  is always going to be in whole packets.
-
-    //  clamp the number of packets to produce based on what is available in the
-    //  input buffer
-    UInt32 inputPacketSize = mInputFormat.mBytesPerPacket;
-    UInt32 numberOfInputPackets = ([stream hasBytesAvailable] ? 1 : 0);
-    if (ioNumberPackets < numberOfInputPackets) {
-        numberOfInputPackets = ioNumberPackets;
-    } else if (ioNumberPackets > numberOfInputPackets) {
-        ioNumberPackets = numberOfInputPackets;
+bool CAFDecoder::InitForRead(AudioByteSource& source) {
+    isPcm = false;
+    isBigEndianPcm = false;
+    hasPacketTable = false;
+    dataOffset = 0;
+    dataByteCount = 0;
+    memset(&cafDesc, 0, sizeof(cafDesc));
+    memset(&cafPacketTbl, 0, sizeof(cafPacketTbl));
+
+    CAFFileHeader fileHeader;
+    if (source.ReadAt(0, &fileHeader, sizeof(fileHeader)) != sizeof(fileHeader) || memcmp(&fileHeader.mFileType, "caff", 4) != 0) {
+        TraceError(TAG, L"Not a CAF file");
+        return false;
     }
 
-    // We only produce 1 at a time
-    if (ioNumberPackets > 1 && numberOfInputPackets > 1) {
-        numberOfInputPackets = ioNumberPackets = 1;
-    }
+    bool hasDescription = false;
+    int64_t fileLength = source.Length();
+    int64_t offset = sizeof(CAFFileHeader);
 
-    UInt32 inputByteSize = numberOfInputPackets * inputPacketSize;
-
-    if (ioNumberPackets > 0) {
-        //  make sure that there is enough space in the output buffer for the
-        //  encoded data
-        //  it is an error to ask for more output than you pass in buffer space for
-        UInt32 theOutputByteSize = ioNumberPackets * mInputFormat.mFramesPerPacket * mOutputFormat.mBytesPerFrame;
-
-        //  set the return value
-        ioOutputDataByteSize = theOutputByteSize;
-
-        //  decode the input data for each channel
-        Byte* theInputData = GetBytes(stream, inputByteSize);
-        SInt16* theOutputData = reinterpret_cast<SInt16*>(outOutputData);
-
-        ChannelStateList::iterator theIterator = mChannelStateList.begin();
-        for (int theChannelIndex = 0; theChannelIndex < mOutputFormat.mChannelsPerFrame; ++theChannelIndex) {
-            DecodeChannelSInt16(*theIterator,
-                                mOutputFormat.mChannelsPerFrame,
-                                theChannelIndex,
-                                ioNumberPackets,
-                                theInputData,
-                                theOutputData);
-            std::advance(theIterator, 1);
+    //  Walk the chunk headers, skipping over the bodies we don't need without reading them
+    while (offset + (int64_t)sizeof(CAFChunkHeader) <= fileLength) {
+        CAFChunkHeader chunkHeader{};
+        if (source.ReadAt(offset, &chunkHeader, sizeof(CAFChunkHeader)) != sizeof(CAFChunkHeader)) {
+            break;
         }
+        offset += sizeof(CAFChunkHeader);
 
-        IwFree(theInputData);
-    } else {
-        //  set the return value since we're not actually doing any work
-        ioOutputDataByteSize = 0;
-    }
-
-    return;
-}
-
-bool CAFDecoder::InitForRead(NSInputStream* inStream) {
-    CAFFileHeader header;
-    [inStream read:(uint8_t*)&header maxLength:sizeof(CAFFileHeader)];
-    bool stop = false;
-    isPcm = false;
-
-    while ([inStream hasBytesAvailable] && !stop) {
-        CAFChunkHeader chunkHeader{};
-        [inStream read:(uint8_t*)&chunkHeader maxLength:sizeof(CAFChunkHeader)];
         chunkHeader.mChunkType = int32Swap(chunkHeader.mChunkType);
         chunkHeader.mChunkSize = int64Swap(chunkHeader.mChunkSize);
 
-        int64_t bytesLeftUntilChunkEnd = chunkHeader.mChunkSize;
-        std::vector<uint8_t> bytesToSkip;
-        uint8_t editCount[4];
-
         switch (chunkHeader.mChunkType) {
             case CAF_StreamDescriptionChunkID:
-                bytesLeftUntilChunkEnd -= [inStream read:(uint8_t*)&cafDesc maxLength:sizeof(CAFAudioDescription)];
-                cafDesc.mSampleRate = dSwap(cafDesc.mSampleRate);
+                if (source.ReadAt(offset, &cafDesc, sizeof(CAFAudioDescription)) != sizeof(CAFAudioDescription)) {
+                    return false;
+                }
 
+                cafDesc.mSampleRate = dSwap(cafDesc.mSampleRate);
                 cafDesc.mFormatID = int32Swap(cafDesc.mFormatID);
+                cafDesc.mFormatFlags = int32Swap(cafDesc.mFormatFlags);
+                cafDesc.mBytesPerPacket = int32Swap(cafDesc.mBytesPerPacket);
+                cafDesc.mFramesPerPacket = int32Swap(cafDesc.mFramesPerPacket);
+                cafDesc.mChannelsPerFrame = int32Swap(cafDesc.mChannelsPerFrame);
+                cafDesc.mBitsPerChannel = int32Swap(cafDesc.mBitsPerChannel);
 
-                switch (cafDesc.mFormatID) //  switch(me)
-                {
+                switch (cafDesc.mFormatID) {
                     case 'lpcm':
+                        //  kCAFLinearPCMFormatFlagIsLittleEndian
                         isPcm = true;
+                        isBigEndianPcm = (cafDesc.mFormatFlags & 2) == 0;
+                        if (cafDesc.mBitsPerChannel != 16 || cafDesc.mBytesPerPacket != 2 * cafDesc.mChannelsPerFrame) {
+                            TraceError(TAG, L"Unsupported CAF linear PCM layout, %d bits per channel", cafDesc.mBitsPerChannel);
+                            return false;
+                        }
                         break;
 
                     case 'ima4':
                         isPcm = false;
+                        if (cafDesc.mBytesPerPacket != kIMA4PacketBytes * cafDesc.mChannelsPerFrame) {
+                            TraceError(TAG, L"Unsupported CAF IMA4 packet size %d", cafDesc.mBytesPerPacket);
+                            return false;
+                        }
                         break;
 
                     default:
-                        TraceError(TAG, L"Unrecognized CAF format %d", cafDesc.mFormatFlags);
+                        TraceError(TAG, L"Unrecognized CAF format %d", cafDesc.mFormatID);
                         return false;
                 }
 
-                cafDesc.mFormatFlags = int32Swap(cafDesc.mFormatFlags);
-                cafDesc.mBytesPerPacket = int32Swap(cafDesc.mBytesPerPacket);
-                cafDesc.mFramesPerPacket = int32Swap(cafDesc.mFramesPerPacket);
-                cafDesc.mChannelsPerFrame = int32Swap(cafDesc.mChannelsPerFrame);
-                cafDesc.mBitsPerChannel = int32Swap(cafDesc.mBitsPerChannel);
+                if (cafDesc.mChannelsPerFrame == 0) {
+                    return false;
+                }
+
+                hasDescription = true;
                 break;
 
             case CAF_PacketTableChunkID:
-                bytesLeftUntilChunkEnd -= [inStream read:(uint8_t*)&cafPacketTbl maxLength:sizeof(cafPacketTbl)];
+                if (source.ReadAt(offset, &cafPacketTbl, sizeof(cafPacketTbl)) != sizeof(cafPacketTbl)) {
+                    return false;
+                }
 
                 cafPacketTbl.mNumberPackets = int64Swap(cafPacketTbl.mNumberPackets);
                 cafPacketTbl.mNumberValidFrames = int64Swap(cafPacketTbl.mNumberValidFrames);
                 cafPacketTbl.mPrimingFrames = int32Swap(cafPacketTbl.mPrimingFrames);
                 cafPacketTbl.mRemainderFrames = int32Swap(cafPacketTbl.mRemainderFrames);
+                hasPacketTable = true;
                 break;
 
             case CAF_AudioDataChunkID:
-                //  Skip edit count
-                bytesLeftUntilChunkEnd -= [inStream read:(uint8_t*)editCount maxLength:_countof(editCount)];
-                stop = true;
+                if (!hasDescription) {
+                    TraceError(TAG, L"CAF audio data precedes its description");
+                    return false;
+                }
+
+                //  Skip edit count. A size of -1 means the data runs to the end of the file.
+                dataOffset = offset + sizeof(CAFDataChunk);
+                if (chunkHeader.mChunkSize < (int64_t)sizeof(CAFDataChunk) || offset + chunkHeader.mChunkSize > fileLength) {
+                    dataByteCount = fileLength - dataOffset;
+                } else {
+                    dataByteCount = chunkHeader.mChunkSize - sizeof(CAFDataChunk);
+                }
 
                 OutputFormat.mBytesPerFrame = 2 * cafDesc.mChannelsPerFrame;
                 OutputFormat.mChannelsPerFrame = cafDesc.mChannelsPerFrame;
                 OutputFormat.mSampleRate = cafDesc.mSampleRate;
                 OutputFormat.mBitsPerChannel = 16;
 
-                for (int i = 0; i < OutputFormat.mChannelsPerFrame; i++) {
-                    channelStates.push_back(ChannelState());
-                }
-
-                break;
+                channelStates.assign(OutputFormat.mChannelsPerFrame, ChannelState());
+                return true;
 
             default:
-                if (chunkHeader.mChunkSize > 0) {
-                    bytesToSkip.resize(chunkHeader.mChunkSize);
-                    bytesLeftUntilChunkEnd -= [inStream read:(uint8_t*)&bytesToSkip[0] maxLength:chunkHeader.mChunkSize];
-                }
                 break;
         }
 
-        if (!stop) {
-            if (bytesLeftUntilChunkEnd > 0) {
-                bytesToSkip.resize(bytesLeftUntilChunkEnd);
-                [inStream read:(uint8_t*)&bytesToSkip[0] maxLength:bytesLeftUntilChunkEnd];
+        if (chunkHeader.mChunkSize < 0) {
+            break;
+        }
+        offset += chunkHeader.mChunkSize;
+    }
+
+    TraceError(TAG, L"CAF file has no audio data chunk");
+    return false;
+}
+
+int64_t CAFDecoder::PrimingFrames() const {
+    return hasPacketTable ? std::max<int64_t>(cafPacketTbl.mPrimingFrames, 0) : 0;
+}
+
+int64_t CAFDecoder::FrameCount() const {
+    int64_t frames = PacketCount() * FramesPerPacket() - PrimingFrames();
+    if (hasPacketTable && cafPacketTbl.mNumberValidFrames > 0 && cafPacketTbl.mNumberValidFrames < frames) {
+        frames = cafPacketTbl.mNumberValidFrames;
+    }
+
+    return std::max<int64_t>(frames, 0);
+}
+
+void CAFDecoder::DecodePackets(const Byte* packets, uint32_t packetCount, int16_t* samplesOut) {
+    UInt32 channels = OutputFormat.mChannelsPerFrame;
+
+    if (isPcm) {
+        size_t sampleCount = packetCount * channels;
+        if (isBigEndianPcm) {
+            for (size_t i = 0; i < sampleCount; ++i) {
+                samplesOut[i] = (int16_t)((packets[2 * i] << 8) | packets[2 * i + 1]);
             }
+        } else {
+            memcpy(samplesOut, packets, sampleCount * sizeof(int16_t));
         }
+        return;
     }
 
-    return true;
+    //  One packet at a time, so that each packet header gets checked against the running state
+    for (UInt32 i = 0; i < packetCount; ++i) {
+        for (UInt32 theChannelIndex = 0; theChannelIndex < channels; ++theChannelIndex) {
+            DecodeChannelSInt16(channelStates[theChannelIndex], channels, theChannelIndex, 1, packets, samplesOut);
+        }
+
+        packets += cafDesc.mBytesPerPacket;
+        samplesOut += kIMAFramesPerPacket * channels;
+    }
 }
 
-int CAFDecoder::ReadBuf(NSInputStream* inputStream, int16_t* out, uint32_t& ioOutputDataByteSize) {
-    ProduceOutputPackets(inputStream, channelStates, out, ioOutputDataByteSize, OutputFormat, cafDesc);
-    return ioOutputDataByteSize;
-}
\ No newline at end of file
+void CAFDecoder::ResetChannelState() {
+    for (auto& state : channelStates) {
+        state.Invalidate();
+    }
+}
@@ -16,46 +16,56 @@
 
 #import <StubReturn.h>
 #import <AudioUnit/AudioUnit.h>
+#import <AudioUnit/AudioUnitInternal.h>
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitInitialize(AudioUnit inUnit) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->Initialize();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitUninitialize(AudioUnit inUnit) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->Uninitialize();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitAddRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || !inProc) {
+        return kAudio_ParamError;
+    }
+    return inUnit->AddRenderNotify(inProc, inProcUserData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitRemoveRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || !inProc) {
+        return kAudio_ParamError;
+    }
+    return inUnit->RemoveRenderNotify(inProc, inProcUserData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Available for the output unit of an AUGraph, which renders the whole graph.
+        Buffers must be non-interleaved 32-bit float.
 */
 OSStatus AudioUnitRender(AudioUnit inUnit,
                          AudioUnitRenderActionFlags* ioActionFlags,
@@ -63,17 +73,21 @@ OSStatus AudioUnitRender(AudioUnit inUnit,
                          UInt32 inOutputBusNumber,
                          UInt32 inNumberFrames,
                          AudioBufferList* ioData) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || !ioData) {
+        return kAudio_ParamError;
+    }
+    return inUnit->Render(ioActionFlags, inTimeStamp, inOutputBusNumber, inNumberFrames, ioData);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitReset(AudioUnit inUnit, AudioUnitScope inScope, AudioUnitElement inElement) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->Reset(inScope, inElement);
 }
 
 /**
@@ -101,18 +115,20 @@ OSStatus AudioUnitRemovePropertyListenerWithUserData(AudioUnit inUnit,
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitGetProperty(
     AudioUnit inUnit, AudioUnitPropertyID inID, AudioUnitScope inScope, AudioUnitElement inElement, void* outData, UInt32* ioDataSize) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || !ioDataSize) {
+        return kAudio_ParamError;
+    }
+    return inUnit->GetProperty(inID, inScope, inElement, outData, ioDataSize);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitGetPropertyInfo(AudioUnit inUnit,
                                   AudioUnitPropertyID inID,
@@ -120,33 +136,39 @@ OSStatus AudioUnitGetPropertyInfo(AudioUnit inUnit,
                                   AudioUnitElement inElement,
                                   UInt32* outDataSize,
                                   Boolean* outWritable) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->GetPropertyInfo(inID, inScope, inElement, outDataSize, outWritable);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitSetProperty(
     AudioUnit inUnit, AudioUnitPropertyID inID, AudioUnitScope inScope, AudioUnitElement inElement, const void* inData, UInt32 inDataSize) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->SetProperty(inID, inScope, inElement, inData, inDataSize);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Available for the units of an AUGraph.
 */
 OSStatus AudioUnitGetParameter(
     AudioUnit inUnit, AudioUnitParameterID inID, AudioUnitScope inScope, AudioUnitElement inElement, AudioUnitParameterValue* outValue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || !outValue) {
+        return kAudio_ParamError;
+    }
+    return inUnit->GetParameter(inID, inScope, inElement, outValue);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Available for the units of an AUGraph. Values apply from the start of the next rendered buffer.
 */
 OSStatus AudioUnitSetParameter(AudioUnit inUnit,
                                AudioUnitParameterID inID,
@@ -154,15 +176,29 @@ OSStatus AudioUnitSetParameter(AudioUnit inUnit,
                                AudioUnitElement inElement,
                                AudioUnitParameterValue inValue,
                                UInt32 inBufferOffsetInFrames) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit) {
+        return kAudio_ParamError;
+    }
+    return inUnit->SetParameter(inID, inScope, inElement, inValue, inBufferOffsetInFrames);
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Each event sets its final value from the start of the next rendered buffer; ramps are not interpolated.
 */
 OSStatus AudioUnitScheduleParameters(AudioUnit inUnit, const AudioUnitParameterEvent* inParameterEvent, UInt32 inNumParamEvents) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!inUnit || (inNumParamEvents > 0 && !inParameterEvent)) {
+        return kAudio_ParamError;
+    }
+
+    for (UInt32 i = 0; i < inNumParamEvents; ++i) {
+        const AudioUnitParameterEvent& event = inParameterEvent[i];
+        AudioUnitParameterValue value =
+            (event.eventType == kParameterEvent_Ramped) ? event.eventValues.ramp.endValue : event.eventValues.immediate.value;
+        OSStatus status = inUnit->SetParameter(event.parameter, event.scope, event.element, value, 0);
+        if (status != noErr) {
+            return status;
+        }
+    }
+    return noErr;
 }
@@ -20,6 +20,7 @@
 #include <NSLayoutConstraint+AutoLayout.h>
 #include <UIView+AutoLayout.h>
 #include "LoggingNative.h"
+#include "Instrumentation.h"
 
 #define CL_NO_IO
 #define CL_NO_ID
@@ -425,6 +426,7 @@ public:
 }
 
 - (void)autoLayoutLayoutSubviews {
+    INSTRUMENT_SPAN("AutoLayout", "layoutSubviews");
     UIView* topView = [self autolayoutRoot];
 
     if (DEBUG_AUTO_LAYOUT_LIGHT) {
@@ -609,6 +611,7 @@ public:
 }
 
 - (void)autoLayoutUpdateConstraints {
+    INSTRUMENT_SPAN("AutoLayout", "updateConstraints");
     AutoLayoutProperties* layoutProperties = self._autoLayoutProperties;
 
     if (DEBUG_AUTO_LAYOUT_LIGHT) {
@@ -635,6 +638,7 @@ public:
 
         if ((layoutProperties->_vars[AutoLayoutProperties::Right].Value() != convFrame.origin.x + convFrame.size.width) ||
             (layoutProperties->_vars[AutoLayoutProperties::Left].Value() != convFrame.origin.x)) {
+            INSTRUMENT_SPAN("AutoLayout", "solve");
             c_solver.AddEditVar(layoutProperties->_vars[AutoLayoutProperties::Right], ClsStrong(), 2.0);
             c_solver.AddEditVar(layoutProperties->_vars[AutoLayoutProperties::Left], ClsStrong(), 2.0);
 
@@ -647,6 +651,7 @@ public:
 
         if ((layoutProperties->_vars[AutoLayoutProperties::Bottom].Value() != convFrame.origin.y + convFrame.size.height) ||
             (layoutProperties->_vars[AutoLayoutProperties::Top].Value() != convFrame.origin.y)) {
+            INSTRUMENT_SPAN("AutoLayout", "solve");
             c_solver.AddEditVar(layoutProperties->_vars[AutoLayoutProperties::Bottom], ClsStrong(), 2.0);
             c_solver.AddEditVar(layoutProperties->_vars[AutoLayoutProperties::Top], ClsStrong(), 2.0);
 
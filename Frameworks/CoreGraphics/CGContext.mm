@@ -39,6 +39,7 @@
 #include <COMIncludes.h>
 #import <d2d1.h>
 #import <d2d1_1.h>
+#import <d2d1_3.h>
 #import <d2d1effects_2.h>
 #import <wrl/client.h>
 #include <COMIncludes_end.h>
@@ -3109,6 +3110,100 @@ void _CGContextDrawImageRect(CGContextRef context, CGImageRef image, CGRect sour
         }));
 }
 
+void _CGContextDrawImageSprites(CGContextRef context,
+                                CGImageRef image,
+                                CGRect sourceRegion,
+                                CGSize size,
+                                const CGAffineTransform* transforms,
+                                const float* colors,
+                                size_t count) {
+    NOISY_RETURN_IF_NULL(context);
+    NOISY_RETURN_IF_NULL(image);
+    RETURN_IF(count == 0);
+
+    woc::unique_cf<CGImageRef> refImage{ __CGContextCreateRenderableImage(image) };
+
+    ComPtr<ID2D1Bitmap> d2dBitmap;
+    FAIL_FAST_IF_FAILED(__CreateD2DBitmapFromCGImage(context, refImage.get(), &d2dBitmap));
+
+    // The destination is centered on the origin, so flipping each sprite for the change in coordinate system origin is
+    // a reflection about the x axis ahead of its own transform.
+    D2D1_RECT_F destination = D2D1::RectF(-size.width / 2.0f, -size.height / 2.0f, size.width / 2.0f, size.height / 2.0f);
+    D2D1_RECT_F source = __CGRectToD2D_F(sourceRegion);
+    D2D1_RECT_U sourceU = D2D1::RectU(static_cast<UINT32>(sourceRegion.origin.x),
+                                      static_cast<UINT32>(sourceRegion.origin.y),
+                                      static_cast<UINT32>(CGRectGetMaxX(sourceRegion)),
+                                      static_cast<UINT32>(CGRectGetMaxY(sourceRegion)));
+
+    std::vector<D2D1_MATRIX_3X2_F> spriteTransforms(count);
+    std::vector<D2D1_COLOR_F> spriteColors(count);
+    float alpha = context->CurrentGState().alpha;
+    for (size_t i = 0; i < count; ++i) {
+        spriteTransforms[i] = __CGAffineTransformToD2D_F(CGAffineTransformConcat(CGAffineTransformMakeScale(1.0, -1.0), transforms[i]));
+        spriteColors[i] = D2D1::ColorF(colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3] * alpha);
+    }
+
+    FAIL_FAST_IF_FAILED(
+        context->Draw(_kCGCoordinateModeUserSpace, nullptr, false, [&](CGContextRef context, ID2D1DeviceContext* deviceContext) {
+            auto& state = context->CurrentGState();
+
+            ComPtr<ID2D1DeviceContext3> deviceContext3;
+            if (SUCCEEDED(deviceContext->QueryInterface(IID_PPV_ARGS(&deviceContext3)))) {
+                // Sprite batches can only be drawn aliased.
+                ComPtr<ID2D1SpriteBatch> spriteBatch;
+                RETURN_IF_FAILED(deviceContext3->CreateSpriteBatch(&spriteBatch));
+
+                std::vector<D2D1_RECT_F> destinations(count, destination);
+                RETURN_IF_FAILED(spriteBatch->AddSprites(static_cast<UINT32>(count),
+                                                         destinations.data(),
+                                                         &sourceU,
+                                                         spriteColors.data(),
+                                                         spriteTransforms.data(),
+                                                         sizeof(D2D1_RECT_F),
+                                                         0,
+                                                         sizeof(D2D1_COLOR_F),
+                                                         sizeof(D2D1_MATRIX_3X2_F)));
+
+                D2D1_ANTIALIAS_MODE antialiasMode = deviceContext3->GetAntialiasMode();
+                deviceContext3->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+                deviceContext3->DrawSpriteBatch(spriteBatch.Get(),
+                                                d2dBitmap.Get(),
+                                                state.GetInterpolationModeForCGImage(refImage.get()) ==
+                                                        D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR ?
+                                                    D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR :
+                                                    D2D1_BITMAP_INTERPOLATION_MODE_LINEAR);
+                deviceContext3->SetAntialiasMode(antialiasMode);
+                return S_OK;
+            }
+
+            // Without sprite batches, tint through one color matrix effect whose matrix is updated per sprite.
+            ComPtr<ID2D1Effect> tintEffect;
+            RETURN_IF_FAILED(deviceContext->CreateEffect(CLSID_D2D1ColorMatrix, &tintEffect));
+            tintEffect->SetInput(0, d2dBitmap.Get());
+
+            // DrawImage puts the top left of the source region at the origin; this maps it onto the destination rect.
+            D2D1::Matrix3x2F placement = D2D1::Matrix3x2F::Scale((destination.right - destination.left) / (source.right - source.left),
+                                                                 (destination.bottom - destination.top) / (source.bottom - source.top)) *
+                                         D2D1::Matrix3x2F::Translation(destination.left, destination.top);
+
+            D2D1::Matrix3x2F worldTransform;
+            deviceContext->GetTransform(&worldTransform);
+            for (size_t i = 0; i < count; ++i) {
+                D2D1_MATRIX_5X4_F tint = D2D1::Matrix5x4F();
+                tint._11 = spriteColors[i].r;
+                tint._22 = spriteColors[i].g;
+                tint._33 = spriteColors[i].b;
+                tint._44 = spriteColors[i].a;
+                RETURN_IF_FAILED(tintEffect->SetValue(D2D1_COLORMATRIX_PROP_COLOR_MATRIX, tint));
+
+                deviceContext->SetTransform(placement * *D2D1::Matrix3x2F::ReinterpretBaseType(&spriteTransforms[i]) * worldTransform);
+                deviceContext->DrawImage(tintEffect.Get(), nullptr, &source, state.GetInterpolationModeForCGImage(refImage.get()));
+            }
+            deviceContext->SetTransform(worldTransform);
+            return S_OK;
+        }));
+}
+
 /**
  @Status Interoperable
 */
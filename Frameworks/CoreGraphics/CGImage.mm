@@ -24,6 +24,7 @@
 #import <CoreGraphics/CGGeometry.h>
 #import <CoreGraphics/CGDataProvider.h>
 #import <LoggingNative.h>
+#import <Instrumentation.h>
 #import <CFRuntime.h>
 #import <CFBridgeUtilities.h>
 #import <CoreGraphics/D2DWrapper.h>
@@ -682,6 +683,9 @@ CGImageRef _CGImageLoadJPEG(void* bytes, int length) {
 }
 
 CGImageRef _CGImageLoadImageWithWICDecoder(REFGUID decoderCls, void* bytes, int length) {
+    INSTRUMENT_SPAN("CoreGraphics", "CGImage.decode");
+    INSTRUMENT_COUNTER_ADD("CoreGraphics", "CGImage.encodedBytesDecoded", length);
+
     ComPtr<IWICImagingFactory> imageFactory;
     RETURN_NULL_IF_FAILED(_CGGetWICFactory(&imageFactory));
 
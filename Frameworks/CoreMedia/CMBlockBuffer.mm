@@ -16,28 +16,482 @@
 
 #import <CoreMedia/CMBlockBuffer.h>
 #import <StubReturn.h>
+#import <CFCppBase.h>
 #import "AssertARCEnabled.h"
 
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// A memory block shared by every block buffer that references it. The block frees its memory through the custom block
+// source or allocator it was created with once the last reference goes away.
+class _CMMemoryBlock {
+public:
+    _CMMemoryBlock(void* data, size_t size, CFAllocatorRef allocator, const CMBlockBufferCustomBlockSource* customBlockSource)
+        : _data(static_cast<char*>(data)),
+          _size(size),
+          _allocator(allocator ? allocator : kCFAllocatorDefault),
+          _hasCustomBlockSource(customBlockSource != nullptr),
+          _customBlockSource() {
+        if (customBlockSource) {
+            _customBlockSource = *customBlockSource;
+        }
+        CFRetain(_allocator);
+    }
+
+    ~_CMMemoryBlock() {
+        char* data = _data.load(std::memory_order_acquire);
+        if (data) {
+            _Free(data);
+        }
+        CFRelease(_allocator);
+    }
+
+    _CMMemoryBlock(const _CMMemoryBlock&) = delete;
+    _CMMemoryBlock& operator=(const _CMMemoryBlock&) = delete;
+
+    // Returns nullptr until the block's memory has been allocated.
+    char* Data() const {
+        return _data.load(std::memory_order_acquire);
+    }
+
+    size_t Size() const {
+        return _size;
+    }
+
+    // Blocks created without memory allocate it on first demand. Buffers sharing the block may race to do so, so the
+    // first allocation to land wins and the others are returned.
+    OSStatus Allocate() {
+        if (_data.load(std::memory_order_acquire)) {
+            return kCMBlockBufferNoErr;
+        }
+
+        char* data = nullptr;
+        if (_hasCustomBlockSource) {
+            if (_customBlockSource.AllocateBlock) {
+                data = static_cast<char*>(_customBlockSource.AllocateBlock(_customBlockSource.refCon, _size));
+            }
+        } else if (_allocator != kCFAllocatorNull) {
+            data = static_cast<char*>(CFAllocatorAllocate(_allocator, _size, 0));
+        }
+        if (!data) {
+            return kCMBlockBufferBlockAllocationFailedErr;
+        }
+
+        char* expected = nullptr;
+        if (!_data.compare_exchange_strong(expected, data, std::memory_order_acq_rel)) {
+            _Free(data);
+        }
+        return kCMBlockBufferNoErr;
+    }
+
+private:
+    void _Free(char* data) {
+        if (_hasCustomBlockSource) {
+            if (_customBlockSource.FreeBlock) {
+                _customBlockSource.FreeBlock(_customBlockSource.refCon, data, _size);
+            }
+        } else if (_allocator != kCFAllocatorNull) {
+            CFAllocatorDeallocate(_allocator, data);
+        }
+    }
+
+    std::atomic<char*> _data;
+    size_t _size;
+    CFAllocatorRef _allocator;
+    bool _hasCustomBlockSource;
+    CMBlockBufferCustomBlockSource _customBlockSource;
+};
+
+// A run of bytes within a memory block.
+struct _CMBlockSegment {
+    std::shared_ptr<_CMMemoryBlock> block;
+    size_t offset;
+    size_t length;
+};
+
+static OSStatus _createMemoryBlock(void* memoryBlock,
+                                   size_t blockLength,
+                                   CFAllocatorRef blockAllocator,
+                                   const CMBlockBufferCustomBlockSource* customBlockSource,
+                                   CMBlockBufferFlags flags,
+                                   std::shared_ptr<_CMMemoryBlock>* outBlock) {
+    if (blockLength == 0) {
+        return kCMBlockBufferBadLengthParameterErr;
+    }
+    if (customBlockSource && customBlockSource->version != kCMBlockBufferCustomBlockSourceVersion) {
+        return kCMBlockBufferBadCustomBlockSourceErr;
+    }
+
+    auto block = std::make_shared<_CMMemoryBlock>(memoryBlock, blockLength, blockAllocator, customBlockSource);
+    if (!memoryBlock && (flags & kCMBlockBufferAssureMemoryNowFlag)) {
+        OSStatus status = block->Allocate();
+        if (status != kCMBlockBufferNoErr) {
+            return status;
+        }
+    }
+    *outBlock = std::move(block);
+    return kCMBlockBufferNoErr;
+}
+}
+
+// A CMBlockBuffer is a rope: an ordered list of segments, each a range within a reference-counted memory block.
+// Appending a reference to another buffer copies that buffer's segment descriptors rather than its bytes, so data can pass
+// through any number of stages without being copied. _starts holds the offset of each segment within the buffer for
+// binary search.
+//
+// The segment list is guarded by a lock because CMBlockBufferAccessDataBytes may coalesce a range on what is otherwise a
+// read. The memory blocks replaced by coalescing are kept until the buffer is destroyed, so pointers already handed out
+// stay valid.
+struct OpaqueCMBlockBuffer : CoreFoundation::CppBase<OpaqueCMBlockBuffer> {
+    OpaqueCMBlockBuffer(size_t capacity) : _length(0) {
+        _segments.reserve(capacity);
+        _starts.reserve(capacity);
+    }
+
+    size_t Length() {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _length;
+    }
+
+    void AppendSegments(const std::vector<_CMBlockSegment>& segments) {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (const _CMBlockSegment& segment : segments) {
+            _AppendLocked(segment);
+        }
+    }
+
+    void AppendSegment(const _CMBlockSegment& segment) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _AppendLocked(segment);
+    }
+
+    // Copies the descriptors of the segments covering [offset, offset + length).
+    OSStatus CopySegments(size_t offset, size_t length, std::vector<_CMBlockSegment>* outSegments) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_IsValidRangeLocked(offset, length)) {
+            return (offset > _length) ? kCMBlockBufferBadOffsetParameterErr : kCMBlockBufferBadLengthParameterErr;
+        }
+
+        for (size_t index = _FindLocked(offset); length > 0; ++index) {
+            const _CMBlockSegment& segment = _segments[index];
+            size_t skip = offset - _starts[index];
+            size_t count = std::min(length, segment.length - skip);
+            outSegments->push_back({ segment.block, segment.offset + skip, count });
+            offset += count;
+            length -= count;
+        }
+        return kCMBlockBufferNoErr;
+    }
+
+    OSStatus AssureMemory() {
+        std::lock_guard<std::mutex> lock(_lock);
+        for (const _CMBlockSegment& segment : _segments) {
+            OSStatus status = segment.block->Allocate();
+            if (status != kCMBlockBufferNoErr) {
+                return status;
+            }
+        }
+        return kCMBlockBufferNoErr;
+    }
+
+    bool IsRangeContiguous(size_t offset, size_t length) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (length == 0 && offset < _length) {
+            length = _length - offset;
+        }
+        if (length == 0 || !_IsValidRangeLocked(offset, length)) {
+            return false;
+        }
+        size_t index = _FindLocked(offset);
+        return offset + length <= _starts[index] + _segments[index].length;
+    }
+
+    OSStatus GetDataPointer(size_t offset, size_t* outLengthAtOffset, char** outPointer) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (offset >= _length) {
+            return kCMBlockBufferBadOffsetParameterErr;
+        }
+
+        size_t index = _FindLocked(offset);
+        const _CMBlockSegment& segment = _segments[index];
+        char* data = segment.block->Data();
+        if (!data) {
+            return kCMBlockBufferUnallocatedBlockErr;
+        }
+        size_t skip = offset - _starts[index];
+        *outLengthAtOffset = segment.length - skip;
+        *outPointer = data + segment.offset + skip;
+        return kCMBlockBufferNoErr;
+    }
+
+    // Returns a pointer to [offset, offset + length). A range spanning several segments is copied to temporaryBlock, or
+    // coalesced into a new block of its own when there is none, after which the range is contiguous.
+    OSStatus Access(size_t offset, size_t length, void* temporaryBlock, char** outPointer) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_IsValidRangeLocked(offset, length) || length == 0) {
+            return (offset >= _length) ? kCMBlockBufferBadOffsetParameterErr : kCMBlockBufferBadLengthParameterErr;
+        }
+
+        size_t first = _FindLocked(offset);
+        const _CMBlockSegment& segment = _segments[first];
+        size_t skip = offset - _starts[first];
+        if (skip + length <= segment.length) {
+            char* data = segment.block->Data();
+            if (!data) {
+                return kCMBlockBufferUnallocatedBlockErr;
+            }
+            *outPointer = data + segment.offset + skip;
+            return kCMBlockBufferNoErr;
+        }
+
+        if (temporaryBlock) {
+            OSStatus status = _CopyOutLocked(offset, length, static_cast<char*>(temporaryBlock));
+            if (status == kCMBlockBufferNoErr) {
+                *outPointer = static_cast<char*>(temporaryBlock);
+            }
+            return status;
+        }
+        return _CoalesceLocked(offset, length, outPointer);
+    }
+
+    OSStatus CopyOut(size_t offset, size_t length, char* destination) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_IsValidRangeLocked(offset, length)) {
+            return (offset > _length) ? kCMBlockBufferBadOffsetParameterErr : kCMBlockBufferBadLengthParameterErr;
+        }
+        return _CopyOutLocked(offset, length, destination);
+    }
+
+    // Writes length bytes from source, or length copies of fill when source is null.
+    OSStatus CopyIn(size_t offset, size_t length, const char* source, char fill) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_IsValidRangeLocked(offset, length)) {
+            return (offset > _length) ? kCMBlockBufferBadOffsetParameterErr : kCMBlockBufferInsufficientSpaceErr;
+        }
+
+        for (size_t index = (length > 0) ? _FindLocked(offset) : 0; length > 0; ++index) {
+            const _CMBlockSegment& segment = _segments[index];
+            OSStatus status = segment.block->Allocate();
+            if (status != kCMBlockBufferNoErr) {
+                return status;
+            }
+
+            size_t skip = offset - _starts[index];
+            size_t count = std::min(length, segment.length - skip);
+            char* destination = segment.block->Data() + segment.offset + skip;
+            if (source) {
+                memcpy(destination, source, count);
+                source += count;
+            } else {
+                memset(destination, fill, count);
+            }
+            offset += count;
+            length -= count;
+        }
+        return kCMBlockBufferNoErr;
+    }
+
+private:
+    bool _IsValidRangeLocked(size_t offset, size_t length) const {
+        return offset <= _length && length <= _length - offset;
+    }
+
+    // The index of the segment holding offset, which must be within the buffer.
+    size_t _FindLocked(size_t offset) const {
+        return std::upper_bound(_starts.begin(), _starts.end(), offset) - _starts.begin() - 1;
+    }
+
+    void _AppendLocked(const _CMBlockSegment& segment) {
+        if (segment.length == 0) {
+            return;
+        }
+
+        // Consecutive ranges of the same block, as produced by referencing adjacent slices of one buffer, merge back into a
+        // single segment.
+        if (!_segments.empty()) {
+            _CMBlockSegment& last = _segments.back();
+            if (last.block == segment.block && last.offset + last.length == segment.offset) {
+                last.length += segment.length;
+                _length += segment.length;
+                return;
+            }
+        }
+
+        _segments.push_back(segment);
+        _starts.push_back(_length);
+        _length += segment.length;
+    }
+
+    OSStatus _CopyOutLocked(size_t offset, size_t length, char* destination) const {
+        for (size_t index = (length > 0) ? _FindLocked(offset) : 0; length > 0; ++index) {
+            const _CMBlockSegment& segment = _segments[index];
+            char* data = segment.block->Data();
+            if (!data) {
+                return kCMBlockBufferUnallocatedBlockErr;
+            }
+
+            size_t skip = offset - _starts[index];
+            size_t count = std::min(length, segment.length - skip);
+            memcpy(destination, data + segment.offset + skip, count);
+            destination += count;
+            offset += count;
+            length -= count;
+        }
+        return kCMBlockBufferNoErr;
+    }
+
+    OSStatus _CoalesceLocked(size_t offset, size_t length, char** outPointer) {
+        size_t first = _FindLocked(offset);
+        size_t last = _FindLocked(offset + length - 1);
+
+        std::shared_ptr<_CMMemoryBlock> block;
+        OSStatus status = _createMemoryBlock(nullptr, length, kCFAllocatorDefault, nullptr, kCMBlockBufferAssureMemoryNowFlag, &block);
+        if (status != kCMBlockBufferNoErr) {
+            return status;
+        }
+        status = _CopyOutLocked(offset, length, block->Data());
+        if (status != kCMBlockBufferNoErr) {
+            return status;
+        }
+
+        // Splice [first, last] into the part of the first segment before offset, the new block, and the part of the last
+        // segment after the range.
+        std::vector<_CMBlockSegment> replacement;
+        const _CMBlockSegment& head = _segments[first];
+        size_t headLength = offset - _starts[first];
+        if (headLength > 0) {
+            replacement.push_back({ head.block, head.offset, headLength });
+        }
+        replacement.push_back({ block, 0, length });
+        const _CMBlockSegment& tail = _segments[last];
+        size_t tailSkip = offset + length - _starts[last];
+        if (tailSkip < tail.length) {
+            replacement.push_back({ tail.block, tail.offset + tailSkip, tail.length - tailSkip });
+        }
+
+        for (size_t index = first; index <= last; ++index) {
+            _retired.emplace_back(std::move(_segments[index].block));
+        }
+        _segments.erase(_segments.begin() + first, _segments.begin() + last + 1);
+        _segments.insert(_segments.begin() + first, replacement.begin(), replacement.end());
+
+        _starts.resize(_segments.size());
+        size_t start = (first > 0) ? _starts[first - 1] + _segments[first - 1].length : 0;
+        for (size_t index = first; index < _segments.size(); ++index) {
+            _starts[index] = start;
+            start += _segments[index].length;
+        }
+
+        *outPointer = block->Data();
+        return kCMBlockBufferNoErr;
+    }
+
+    std::mutex _lock;
+    std::vector<_CMBlockSegment> _segments;
+    std::vector<size_t> _starts;
+    size_t _length;
+    std::vector<std::shared_ptr<_CMMemoryBlock>> _retired;
+};
+
+static OSStatus _createEmpty(CFAllocatorRef structureAllocator, size_t capacity, CMBlockBufferRef* newBBufOut) {
+    CMBlockBufferRef buffer = OpaqueCMBlockBuffer::CreateInstance(structureAllocator, capacity);
+    if (!buffer) {
+        return kCMBlockBufferStructureAllocationFailedErr;
+    }
+    *newBBufOut = buffer;
+    return kCMBlockBufferNoErr;
+}
+
+// Copies dataLength bytes at offsetToData in source into a new memory block.
+static OSStatus _copyToNewBlock(CMBlockBufferRef source,
+                                size_t offsetToData,
+                                size_t dataLength,
+                                CFAllocatorRef blockAllocator,
+                                const CMBlockBufferCustomBlockSource* customBlockSource,
+                                _CMBlockSegment* outSegment) {
+    std::shared_ptr<_CMMemoryBlock> block;
+    OSStatus status =
+        _createMemoryBlock(nullptr, dataLength, blockAllocator, customBlockSource, kCMBlockBufferAssureMemoryNowFlag, &block);
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+    status = source->CopyOut(offsetToData, dataLength, block->Data());
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+    *outSegment = { std::move(block), 0, dataLength };
+    return kCMBlockBufferNoErr;
+}
+
+// Appends [offsetToData, offsetToData + dataLength) of target to buffer, by reference unless the flags ask for a copy.
+static OSStatus _appendReference(
+    CMBlockBufferRef buffer, CMBlockBufferRef target, size_t offsetToData, size_t dataLength, CMBlockBufferFlags flags) {
+    if (dataLength == 0) {
+        return (flags & kCMBlockBufferPermitEmptyReferenceFlag) ? kCMBlockBufferNoErr : kCMBlockBufferBadLengthParameterErr;
+    }
+
+    if (flags & kCMBlockBufferAlwaysCopyDataFlag) {
+        _CMBlockSegment segment;
+        OSStatus status = _copyToNewBlock(target, offsetToData, dataLength, kCFAllocatorDefault, nullptr, &segment);
+        if (status == kCMBlockBufferNoErr) {
+            buffer->AppendSegment(segment);
+        }
+        return status;
+    }
+
+    // The target's segments are copied out before buffer is locked, so a buffer can reference itself and two buffers can
+    // reference each other from different threads.
+    std::vector<_CMBlockSegment> segments;
+    OSStatus status = target->CopySegments(offsetToData, dataLength, &segments);
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+    if (flags & kCMBlockBufferAssureMemoryNowFlag) {
+        for (const _CMBlockSegment& segment : segments) {
+            status = segment.block->Allocate();
+            if (status != kCMBlockBufferNoErr) {
+                return status;
+            }
+        }
+    }
+    buffer->AppendSegments(segments);
+    return kCMBlockBufferNoErr;
+}
+
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes A range within a single memory block is returned in place. Otherwise the range is copied to temporaryBlock, or,
+        if temporaryBlock is NULL, coalesced into a new memory block so that later accesses to it are contiguous.
 */
 OSStatus CMBlockBufferAccessDataBytes(
     CMBlockBufferRef theBuffer, size_t offset, size_t length, void* temporaryBlock, char* _Nullable* returnedPointer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theBuffer || !returnedPointer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return theBuffer->Access(offset, length, temporaryBlock, returnedPointer);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Appends the target's memory blocks by reference; no data is copied unless kCMBlockBufferAlwaysCopyDataFlag is set.
 */
 OSStatus CMBlockBufferAppendBufferReference(
     CMBlockBufferRef theBuffer, CMBlockBufferRef targetBBuf, size_t offsetToData, size_t dataLength, CMBlockBufferFlags flags) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theBuffer || !targetBBuf) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return _appendReference(theBuffer, targetBBuf, offsetToData, dataLength, flags);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBlockBufferAppendMemoryBlock(CMBlockBufferRef theBuffer,
                                         void* memoryBlock,
@@ -47,28 +501,46 @@ OSStatus CMBlockBufferAppendMemoryBlock(CMBlockBufferRef theBuffer,
                                         size_t offsetToData,
                                         size_t dataLength,
                                         CMBlockBufferFlags flags) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theBuffer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    if (offsetToData > blockLength || dataLength > blockLength - offsetToData) {
+        return kCMBlockBufferBadLengthParameterErr;
+    }
+
+    std::shared_ptr<_CMMemoryBlock> block;
+    OSStatus status = _createMemoryBlock(memoryBlock, blockLength, blockAllocator, customBlockSource, flags, &block);
+    if (status == kCMBlockBufferNoErr) {
+        theBuffer->AppendSegment({ std::move(block), offsetToData, dataLength });
+    }
+    return status;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBlockBufferAssureBlockMemory(CMBlockBufferRef theBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theBuffer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return theBuffer->AssureMemory();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBlockBufferCopyDataBytes(CMBlockBufferRef theSourceBuffer, size_t offsetToData, size_t dataLength, void* destination) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theSourceBuffer || !destination) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return theSourceBuffer->CopyOut(offsetToData, dataLength, static_cast<char*>(destination));
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes A range that is already contiguous is referenced rather than copied unless kCMBlockBufferAlwaysCopyDataFlag is set.
 */
 OSStatus CMBlockBufferCreateContiguous(CFAllocatorRef structureAllocator,
                                        CMBlockBufferRef sourceBuffer,
@@ -78,23 +550,57 @@ OSStatus CMBlockBufferCreateContiguous(CFAllocatorRef structureAllocator,
                                        size_t dataLength,
                                        CMBlockBufferFlags flags,
                                        CMBlockBufferRef _Nullable* newBBufOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!sourceBuffer || !newBBufOut) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+
+    size_t sourceLength = sourceBuffer->Length();
+    if (sourceLength == 0) {
+        return kCMBlockBufferEmptyBBufErr;
+    }
+    if (offsetToData >= sourceLength) {
+        return kCMBlockBufferBadOffsetParameterErr;
+    }
+    if (dataLength == 0) {
+        dataLength = sourceLength - offsetToData;
+    }
+
+    if (!(flags & kCMBlockBufferAlwaysCopyDataFlag) && sourceBuffer->IsRangeContiguous(offsetToData, dataLength)) {
+        return CMBlockBufferCreateWithBufferReference(structureAllocator, sourceBuffer, offsetToData, dataLength, 0, newBBufOut);
+    }
+
+    _CMBlockSegment segment;
+    OSStatus status = _copyToNewBlock(sourceBuffer, offsetToData, dataLength, blockAllocator, customBlockSource, &segment);
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+
+    CMBlockBufferRef buffer;
+    status = _createEmpty(structureAllocator, 1, &buffer);
+    if (status == kCMBlockBufferNoErr) {
+        buffer->AppendSegment(segment);
+        *newBBufOut = buffer;
+    }
+    return status;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBlockBufferCreateEmpty(CFAllocatorRef structureAllocator,
                                   uint32_t subBlockCapacity,
                                   CMBlockBufferFlags flags,
                                   CMBlockBufferRef _Nullable* newBBufOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!newBBufOut) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return _createEmpty(structureAllocator, subBlockCapacity, newBBufOut);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes The new buffer shares the target's memory blocks; no data is copied unless kCMBlockBufferAlwaysCopyDataFlag is set.
 */
 OSStatus CMBlockBufferCreateWithBufferReference(CFAllocatorRef structureAllocator,
                                                 CMBlockBufferRef targetBuffer,
@@ -102,12 +608,28 @@ OSStatus CMBlockBufferCreateWithBufferReference(CFAllocatorRef structureAllocato
                                                 size_t dataLength,
                                                 CMBlockBufferFlags flags,
                                                 CMBlockBufferRef _Nullable* newBBufOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!targetBuffer || !newBBufOut) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+
+    CMBlockBufferRef buffer;
+    OSStatus status = _createEmpty(structureAllocator, 1, &buffer);
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+    status = _appendReference(buffer, targetBuffer, offsetToData, dataLength, flags);
+    if (status != kCMBlockBufferNoErr) {
+        CFRelease(buffer);
+        return status;
+    }
+    *newBBufOut = buffer;
+    return kCMBlockBufferNoErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes When memoryBlock is NULL the block is allocated on CMBlockBufferAssureBlockMemory, on the first write, or at once
+        with kCMBlockBufferAssureMemoryNowFlag.
 */
 OSStatus CMBlockBufferCreateWithMemoryBlock(CFAllocatorRef structureAllocator,
                                             void* memoryBlock,
@@ -118,66 +640,103 @@ OSStatus CMBlockBufferCreateWithMemoryBlock(CFAllocatorRef structureAllocator,
                                             size_t dataLength,
                                             CMBlockBufferFlags flags,
                                             CMBlockBufferRef _Nullable* newBBufOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!newBBufOut) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+
+    CMBlockBufferRef buffer;
+    OSStatus status = _createEmpty(structureAllocator, 1, &buffer);
+    if (status != kCMBlockBufferNoErr) {
+        return status;
+    }
+    status = CMBlockBufferAppendMemoryBlock(
+        buffer, memoryBlock, blockLength, blockAllocator, customBlockSource, offsetToData, dataLength, flags);
+    if (status != kCMBlockBufferNoErr) {
+        CFRelease(buffer);
+        return status;
+    }
+    *newBBufOut = buffer;
+    return kCMBlockBufferNoErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBlockBufferFillDataBytes(char fillByte, CMBlockBufferRef destinationBuffer, size_t offsetIntoDestination, size_t dataLength) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!destinationBuffer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return destinationBuffer->CopyIn(offsetIntoDestination, dataLength, nullptr, fillByte);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 size_t CMBlockBufferGetDataLength(CMBlockBufferRef theBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return theBuffer ? theBuffer->Length() : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes lengthAtOffset is the number of bytes contiguous with the returned pointer.
 */
 OSStatus CMBlockBufferGetDataPointer(
     CMBlockBufferRef theBuffer, size_t offset, size_t* lengthAtOffset, size_t* totalLength, char* _Nullable* dataPointer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!theBuffer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+
+    size_t contiguousLength = 0;
+    char* pointer = nullptr;
+    OSStatus status = theBuffer->GetDataPointer(offset, &contiguousLength, &pointer);
+    if (lengthAtOffset) {
+        *lengthAtOffset = contiguousLength;
+    }
+    if (totalLength) {
+        *totalLength = theBuffer->Length();
+    }
+    if (dataPointer) {
+        *dataPointer = pointer;
+    }
+    return status;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CFTypeID CMBlockBufferGetTypeID() {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return OpaqueCMBlockBuffer::GetTypeID();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 Boolean CMBlockBufferIsEmpty(CMBlockBufferRef theBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return !theBuffer || theBuffer->Length() == 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes A length of zero checks the rest of the buffer from offset.
 */
 Boolean CMBlockBufferIsRangeContiguous(CMBlockBufferRef theBuffer, size_t offset, size_t length) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return theBuffer && theBuffer->IsRangeContiguous(offset, length);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Allocates any unallocated memory blocks in the range. Writes are visible through every buffer sharing the blocks.
 */
 OSStatus CMBlockBufferReplaceDataBytes(const void* sourceBytes,
                                        CMBlockBufferRef destinationBuffer,
                                        size_t offsetIntoDestination,
                                        size_t dataLength) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!sourceBytes || !destinationBuffer) {
+        return kCMBlockBufferBadPointerParameterErr;
+    }
+    return destinationBuffer->CopyIn(offsetIntoDestination, dataLength, static_cast<const char*>(sourceBytes), 0);
 }
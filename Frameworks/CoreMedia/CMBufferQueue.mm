@@ -15,54 +15,801 @@
 //******************************************************************************
 
 #import <CoreMedia/CMBufferQueue.h>
+#import <CoreMedia/CMSampleBuffer.h>
 #import <StubReturn.h>
+#import <CFCppBase.h>
 #import "AssertARCEnabled.h"
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A buffer and the timing and size its callbacks reported when it was enqueued.
+struct _CMBufferQueueEntry {
+    CMBufferRef buffer;
+    CMTime decodeTimeStamp;
+    CMTime presentationTimeStamp;
+    CMTime duration;
+    size_t size;
+};
+
+struct _CMBufferQueueSlot {
+    std::atomic<size_t> sequence;
+    _CMBufferQueueEntry entry;
+};
+
+struct _CMBufferQueueTrigger {
+    CMBufferQueueTriggerCallback callback;
+    void* refcon;
+    CMBufferQueueTriggerCondition condition;
+    CMTime time;
+    CMItemCount threshold;
+};
+
+// The parts of the queue's state that trigger conditions are tested against.
+struct _CMBufferQueueState {
+    CMItemCount count;
+    CMTime duration;
+    CMTime minPresentationTimeStamp;
+    CMTime maxPresentationTimeStamp;
+    bool headIsReady;
+    bool atEndOfData;
+};
+
+struct _CMBufferQueueFiring {
+    CMBufferQueueTriggerCallback callback;
+    void* refcon;
+    CMBufferQueueTriggerToken token;
+};
+
+static bool _conditionHolds(const _CMBufferQueueTrigger& trigger, const _CMBufferQueueState& state) {
+    switch (trigger.condition) {
+        case kCMBufferQueueTrigger_WhenDurationBecomesLessThan:
+            return CMTimeCompare(state.duration, trigger.time) < 0;
+        case kCMBufferQueueTrigger_WhenDurationBecomesLessThanOrEqualTo:
+            return CMTimeCompare(state.duration, trigger.time) <= 0;
+        case kCMBufferQueueTrigger_WhenDurationBecomesGreaterThan:
+            return CMTimeCompare(state.duration, trigger.time) > 0;
+        case kCMBufferQueueTrigger_WhenDurationBecomesGreaterThanOrEqualTo:
+            return CMTimeCompare(state.duration, trigger.time) >= 0;
+        case kCMBufferQueueTrigger_WhenDataBecomesReady:
+            return state.headIsReady;
+        case kCMBufferQueueTrigger_WhenEndOfDataReached:
+            return state.atEndOfData;
+        case kCMBufferQueueTrigger_WhenBufferCountBecomesLessThan:
+            return state.count < trigger.threshold;
+        case kCMBufferQueueTrigger_WhenBufferCountBecomesGreaterThan:
+            return state.count > trigger.threshold;
+        default:
+            return false;
+    }
+}
+
+// Triggers fire on the edge: when their condition goes from false to true, or when the time they watch changes.
+static bool _triggerFires(const _CMBufferQueueTrigger& trigger, const _CMBufferQueueState& before, const _CMBufferQueueState& after) {
+    switch (trigger.condition) {
+        case kCMBufferQueueTrigger_WhenMinPresentationTimeStampChanges:
+            return CMTimeCompare(before.minPresentationTimeStamp, after.minPresentationTimeStamp) != 0;
+        case kCMBufferQueueTrigger_WhenMaxPresentationTimeStampChanges:
+            return CMTimeCompare(before.maxPresentationTimeStamp, after.maxPresentationTimeStamp) != 0;
+        case kCMBufferQueueTrigger_WhenReset:
+            return false;
+        default:
+            return !_conditionHolds(trigger, before) && _conditionHolds(trigger, after);
+    }
+}
+
+static void _fire(const std::vector<_CMBufferQueueFiring>& firings) {
+    for (const _CMBufferQueueFiring& firing : firings) {
+        firing.callback(firing.refcon, firing.token);
+    }
+}
+}
+
+// A CMBufferQueue is a bounded multi-producer multi-consumer ring. Each slot carries a sequence number that says whether
+// it is ready to be written or read at a given position, so enqueue and dequeue claim positions with a compare-exchange
+// and never take a lock. A separate count, reserved before a position is claimed, enforces the capacity.
+//
+// Everything else - sorted insertion, triggers, validation, growing an unbounded queue, and the queries that walk the
+// queue - runs exclusively: it takes the lock, closes the gate to new lock-free operations and waits for those in flight
+// to drain. While the queue sorts, validates or has triggers installed, the gate stays shut and every operation takes
+// the exclusive path so that trigger conditions are tested against each change in turn.
+//
+// Durations are summed as they are enqueued and dequeued while every buffer shares one timescale, which is the common
+// case for a single media stream. Mixed timescales fall back to adding up the queue's contents. Sizes are always summed
+// as they are enqueued and dequeued.
+struct opaqueCMBufferQueue : CoreFoundation::CppBase<opaqueCMBufferQueue> {
+    opaqueCMBufferQueue(CMItemCount capacity, const CMBufferCallbacks& callbacks)
+        : _callbacks(callbacks),
+          _capacity(std::max<CMItemCount>(capacity, 0)),
+          _gate(0),
+          _count(0),
+          _endOfData(false),
+          _durationTimescale(0),
+          _durationValue(0),
+          _totalSize(0),
+          _validationCallback(nullptr),
+          _validationRefCon(nullptr) {
+        size_t size = 16;
+        while (size < static_cast<size_t>(_capacity)) {
+            size *= 2;
+        }
+        _Allocate(size, 0);
+        _limit = _capacity ? static_cast<size_t>(_capacity) : size;
+        _enqueuePosition.store(0, std::memory_order_relaxed);
+        _dequeuePosition.store(0, std::memory_order_relaxed);
+        _gate.store(_callbacks.compare ? c_slowPath : 0, std::memory_order_relaxed);
+    }
+
+    ~opaqueCMBufferQueue() {
+        size_t end = _enqueuePosition.load(std::memory_order_relaxed);
+        for (size_t position = _dequeuePosition.load(std::memory_order_relaxed); position != end; ++position) {
+            CFRelease(_ring[position & _mask].entry.buffer);
+        }
+    }
+
+    const CMBufferCallbacks& Callbacks() const {
+        return _callbacks;
+    }
+
+    CMItemCount Count() const {
+        return _count.load(std::memory_order_acquire);
+    }
+
+    bool ContainsEndOfData() const {
+        return _endOfData.load(std::memory_order_acquire);
+    }
+
+    size_t TotalSize() const {
+        return _totalSize.load(std::memory_order_relaxed);
+    }
+
+    // Takes ownership of the entry's buffer reference on success.
+    OSStatus Enqueue(const _CMBufferQueueEntry& entry) {
+        OSStatus status;
+        if (_TryEnqueueShared(entry, &status)) {
+            return status;
+        }
+
+        CMBufferValidationCallback validationCallback;
+        void* validationRefCon;
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            validationCallback = _validationCallback;
+            validationRefCon = _validationRefCon;
+        }
+        if (validationCallback) {
+            status = validationCallback(this, entry.buffer, validationRefCon);
+            if (status != noErr) {
+                return status;
+            }
+        }
+
+        std::vector<_CMBufferQueueFiring> firings;
+        {
+            _Exclusive exclusive(this);
+            if (_endOfData.load(std::memory_order_relaxed)) {
+                return kCMBufferQueueError_EnqueueAfterEndOfData;
+            }
+            size_t count = _count.load(std::memory_order_relaxed);
+            if (count >= _limit) {
+                if (_capacity) {
+                    return kCMBufferQueueError_QueueIsFull;
+                }
+                _Grow();
+            }
+
+            _CMBufferQueueState before = _StateLocked();
+            _count.store(count + 1, std::memory_order_relaxed);
+            _AccountDuration(entry.duration, 1);
+            _totalSize.fetch_add(entry.size, std::memory_order_relaxed);
+            _Push(entry);
+            if (_callbacks.compare) {
+                _SortTailLocked();
+            }
+            _CollectFiringsLocked(before, false, &firings);
+        }
+        _fire(firings);
+        return noErr;
+    }
+
+    // Returns a buffer reference the caller owns, or nullptr.
+    CMBufferRef Dequeue(bool requireDataReady) {
+        bool checkReady = requireDataReady && _callbacks.isDataReady;
+        CMBufferRef buffer;
+        if (!checkReady && _TryDequeueShared(&buffer)) {
+            return buffer;
+        }
+
+        std::vector<_CMBufferQueueFiring> firings;
+        {
+            _Exclusive exclusive(this);
+            size_t count = _count.load(std::memory_order_relaxed);
+            if (count == 0) {
+                return nullptr;
+            }
+            if (checkReady && !_callbacks.isDataReady(_EntryAt(0).buffer, _callbacks.refcon)) {
+                return nullptr;
+            }
+
+            _CMBufferQueueState before = _StateLocked();
+            _count.store(count - 1, std::memory_order_relaxed);
+            _CMBufferQueueEntry entry = _Pop();
+            _AccountDuration(entry.duration, -1);
+            _totalSize.fetch_sub(entry.size, std::memory_order_relaxed);
+            buffer = entry.buffer;
+            _CollectFiringsLocked(before, false, &firings);
+        }
+        _fire(firings);
+        return buffer;
+    }
+
+    void MarkEndOfData() {
+        std::vector<_CMBufferQueueFiring> firings;
+        {
+            _Exclusive exclusive(this);
+            _CMBufferQueueState before = _StateLocked();
+            _endOfData.store(true, std::memory_order_release);
+            _CollectFiringsLocked(before, false, &firings);
+        }
+        _fire(firings);
+    }
+
+    void Reset(void (*callback)(CMBufferRef, void*), void* refcon) {
+        std::vector<CMBufferRef> buffers;
+        std::vector<_CMBufferQueueFiring> firings;
+        {
+            _Exclusive exclusive(this);
+            _CMBufferQueueState before = _StateLocked();
+            for (size_t count = _count.load(std::memory_order_relaxed); count > 0; --count) {
+                buffers.push_back(_Pop().buffer);
+            }
+            _count.store(0, std::memory_order_relaxed);
+            _endOfData.store(false, std::memory_order_release);
+            _AccountDuration(kCMTimeInvalid, 0);
+            _totalSize.store(0, std::memory_order_relaxed);
+            _CollectFiringsLocked(before, true, &firings);
+        }
+
+        for (CMBufferRef buffer : buffers) {
+            if (callback) {
+                callback(buffer, refcon);
+            }
+            CFRelease(buffer);
+        }
+        _fire(firings);
+    }
+
+    OSStatus CallForEachBuffer(OSStatus (*callback)(CMBufferRef, void*), void* refcon) {
+        _Exclusive exclusive(this);
+        for (size_t index = 0, count = _count.load(std::memory_order_relaxed); index < count; ++index) {
+            OSStatus status = callback(_EntryAt(index).buffer, refcon);
+            if (status != noErr) {
+                return status;
+            }
+        }
+        return noErr;
+    }
+
+    void SetValidationCallback(CMBufferValidationCallback callback, void* refcon) {
+        _Exclusive exclusive(this);
+        _validationCallback = callback;
+        _validationRefCon = refcon;
+        _UpdateGateLocked();
+    }
+
+    CMBufferQueueTriggerToken InstallTrigger(const _CMBufferQueueTrigger& trigger) {
+        _Exclusive exclusive(this);
+        _triggers.emplace_back(new _CMBufferQueueTrigger(trigger));
+        _UpdateGateLocked();
+        return reinterpret_cast<CMBufferQueueTriggerToken>(_triggers.back().get());
+    }
+
+    OSStatus RemoveTrigger(CMBufferQueueTriggerToken token) {
+        _Exclusive exclusive(this);
+        auto found = _FindTriggerLocked(token);
+        if (found == _triggers.end()) {
+            return kCMBufferQueueError_InvalidTriggerToken;
+        }
+        _triggers.erase(found);
+        _UpdateGateLocked();
+        return noErr;
+    }
+
+    bool TestTrigger(CMBufferQueueTriggerToken token) {
+        _Exclusive exclusive(this);
+        auto found = _FindTriggerLocked(token);
+        return found != _triggers.end() && _conditionHolds(**found, _StateLocked());
+    }
+
+    CMBufferRef Head() {
+        _Exclusive exclusive(this);
+        return (_count.load(std::memory_order_relaxed) > 0) ? _EntryAt(0).buffer : nullptr;
+    }
+
+    CMTime Duration() {
+        CMTime duration;
+        if (_SummedDuration(&duration)) {
+            return duration;
+        }
+        _Exclusive exclusive(this);
+        return _DurationLocked();
+    }
+
+    CMTime FirstTime(CMTime _CMBufferQueueEntry::*time) {
+        _Exclusive exclusive(this);
+        return (_count.load(std::memory_order_relaxed) > 0) ? _EntryAt(0).*time : kCMTimeInvalid;
+    }
+
+    CMTime ExtremeTime(CMTime _CMBufferQueueEntry::*time, int32_t sign) {
+        _Exclusive exclusive(this);
+        return _ExtremeTimeLocked(time, sign);
+    }
+
+    CMTime EndPresentationTimeStamp() {
+        _Exclusive exclusive(this);
+        CMTime end = kCMTimeInvalid;
+        for (size_t index = 0, count = _count.load(std::memory_order_relaxed); index < count; ++index) {
+            const _CMBufferQueueEntry& entry = _EntryAt(index);
+            CMTime time = CMTIME_IS_NUMERIC(entry.duration) ? CMTimeAdd(entry.presentationTimeStamp, entry.duration)
+                                                            : entry.presentationTimeStamp;
+            if (CMTIME_IS_NUMERIC(time) && (CMTIME_IS_INVALID(end) || CMTimeCompare(time, end) > 0)) {
+                end = time;
+            }
+        }
+        return end;
+    }
+
+private:
+    static const uint32_t c_exclusive = 0x80000000;
+    static const uint32_t c_slowPath = 0x40000000;
+    static const uint32_t c_sharedMask = 0x3fffffff;
+
+    // Holds the lock with the gate closed and no lock-free operation in flight, so the ring can be treated as plain memory.
+    class _Exclusive {
+    public:
+        _Exclusive(opaqueCMBufferQueue* queue) : _queue(queue), _lock(queue->_lock) {
+            _queue->_gate.fetch_or(c_exclusive, std::memory_order_acquire);
+            while ((_queue->_gate.load(std::memory_order_acquire) & c_sharedMask) != 0) {
+                std::this_thread::yield();
+            }
+        }
+
+        ~_Exclusive() {
+            _queue->_gate.fetch_and(~c_exclusive, std::memory_order_release);
+        }
+
+    private:
+        opaqueCMBufferQueue* _queue;
+        std::lock_guard<std::mutex> _lock;
+    };
+
+    bool _EnterShared() {
+        uint32_t gate = _gate.load(std::memory_order_relaxed);
+        do {
+            if (gate & (c_exclusive | c_slowPath)) {
+                return false;
+            }
+        } while (!_gate.compare_exchange_weak(gate, gate + 1, std::memory_order_acquire, std::memory_order_relaxed));
+        return true;
+    }
+
+    void _LeaveShared() {
+        _gate.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Returns false if the operation has to run exclusively.
+    bool _TryEnqueueShared(const _CMBufferQueueEntry& entry, OSStatus* outStatus) {
+        if (!_EnterShared()) {
+            return false;
+        }
+        if (_endOfData.load(std::memory_order_relaxed)) {
+            _LeaveShared();
+            *outStatus = kCMBufferQueueError_EnqueueAfterEndOfData;
+            return true;
+        }
+
+        CMItemCount count = _count.load(std::memory_order_relaxed);
+        do {
+            if (static_cast<size_t>(count) >= _limit) {
+                _LeaveShared();
+                // An unbounded queue grows exclusively.
+                *outStatus = kCMBufferQueueError_QueueIsFull;
+                return _capacity != 0;
+            }
+        } while (!_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+        _AccountDuration(entry.duration, 1);
+        _totalSize.fetch_add(entry.size, std::memory_order_relaxed);
+        _Push(entry);
+        _LeaveShared();
+        *outStatus = noErr;
+        return true;
+    }
+
+    bool _TryDequeueShared(CMBufferRef* outBuffer) {
+        if (!_EnterShared()) {
+            return false;
+        }
+
+        CMItemCount count = _count.load(std::memory_order_relaxed);
+        do {
+            if (count == 0) {
+                _LeaveShared();
+                *outBuffer = nullptr;
+                return true;
+            }
+        } while (!_count.compare_exchange_weak(count, count - 1, std::memory_order_relaxed));
+
+        _CMBufferQueueEntry entry = _Pop();
+        _AccountDuration(entry.duration, -1);
+        _totalSize.fetch_sub(entry.size, std::memory_order_relaxed);
+        _LeaveShared();
+        *outBuffer = entry.buffer;
+        return true;
+    }
+
+    // The caller has reserved room in _count, so a slot is free or about to be freed by a dequeue that already claimed it.
+    void _Push(const _CMBufferQueueEntry& entry) {
+        size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            _CMBufferQueueSlot& slot = _ring[position & _mask];
+            intptr_t difference = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire) - position);
+            if (difference == 0) {
+                if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.entry = entry;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return;
+                }
+            } else {
+                if (difference < 0) {
+                    std::this_thread::yield();
+                }
+                position = _enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // The caller has reserved an item in _count, so the head slot is filled or about to be by an enqueue that claimed it.
+    _CMBufferQueueEntry _Pop() {
+        size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            _CMBufferQueueSlot& slot = _ring[position & _mask];
+            intptr_t difference = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire) - (position + 1));
+            if (difference == 0) {
+                if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    _CMBufferQueueEntry entry = slot.entry;
+                    slot.sequence.store(position + _mask + 1, std::memory_order_release);
+                    return entry;
+                }
+            } else {
+                if (difference < 0) {
+                    std::this_thread::yield();
+                }
+                position = _dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void _Allocate(size_t size, size_t count) {
+        std::unique_ptr<_CMBufferQueueSlot[]> ring(new _CMBufferQueueSlot[size]);
+        for (size_t index = 0; index < size; ++index) {
+            ring[index].sequence.store((index < count) ? index + 1 : index, std::memory_order_relaxed);
+            if (index < count) {
+                ring[index].entry = _EntryAt(index);
+            }
+        }
+        _ring = std::move(ring);
+        _mask = size - 1;
+    }
+
+    void _Grow() {
+        size_t count = _count.load(std::memory_order_relaxed);
+        _Allocate((_mask + 1) * 2, count);
+        _enqueuePosition.store(count, std::memory_order_relaxed);
+        _dequeuePosition.store(0, std::memory_order_relaxed);
+        _limit = _mask + 1;
+    }
+
+    _CMBufferQueueEntry& _EntryAt(size_t index) {
+        return _ring[(_dequeuePosition.load(std::memory_order_relaxed) + index) & _mask].entry;
+    }
+
+    // Moves the newest entry back to its place in the order defined by the compare callback.
+    void _SortTailLocked() {
+        for (size_t index = _count.load(std::memory_order_relaxed) - 1; index > 0; --index) {
+            _CMBufferQueueEntry& previous = _EntryAt(index - 1);
+            _CMBufferQueueEntry& current = _EntryAt(index);
+            if (_callbacks.compare(previous.buffer, current.buffer, _callbacks.refcon) != kCFCompareGreaterThan) {
+                break;
+            }
+            std::swap(previous, current);
+        }
+    }
+
+    // Adds sign * duration to the running sum while every duration shares a timescale. A sign of zero clears the sum.
+    void _AccountDuration(const CMTime& duration, int sign) {
+        if (sign == 0) {
+            _durationTimescale.store(0, std::memory_order_relaxed);
+            _durationValue.store(0, std::memory_order_relaxed);
+            return;
+        }
+        if (CMTIME_IS_INVALID(duration)) {
+            return;
+        }
+
+        int32_t timescale = _durationTimescale.load(std::memory_order_relaxed);
+        if (timescale == 0 && CMTIME_IS_NUMERIC(duration) && duration.epoch == 0) {
+            _durationTimescale.compare_exchange_strong(timescale, duration.timescale, std::memory_order_relaxed);
+            timescale = _durationTimescale.load(std::memory_order_relaxed);
+        }
+        if (CMTIME_IS_NUMERIC(duration) && duration.epoch == 0 && timescale == duration.timescale) {
+            _durationValue.fetch_add(sign * duration.value, std::memory_order_relaxed);
+        } else {
+            _durationTimescale.store(-1, std::memory_order_relaxed);
+        }
+    }
+
+    bool _SummedDuration(CMTime* outDuration) const {
+        int32_t timescale = _durationTimescale.load(std::memory_order_relaxed);
+        if (timescale < 0) {
+            return false;
+        }
+        *outDuration = (timescale == 0) ? kCMTimeZero : CMTimeMake(_durationValue.load(std::memory_order_relaxed), timescale);
+        return true;
+    }
+
+    CMTime _DurationLocked() {
+        CMTime duration;
+        if (_SummedDuration(&duration)) {
+            return duration;
+        }
+
+        size_t count = _count.load(std::memory_order_relaxed);
+        duration = kCMTimeZero;
+        for (size_t index = 0; index < count; ++index) {
+            const CMTime& time = _EntryAt(index).duration;
+            if (CMTIME_IS_VALID(time)) {
+                duration = CMTimeAdd(duration, time);
+            }
+        }
+        if (count == 0) {
+            _AccountDuration(kCMTimeInvalid, 0);
+        }
+        return duration;
+    }
+
+    // The smallest time for a sign of -1 and the largest for 1, ignoring buffers without one.
+    CMTime _ExtremeTimeLocked(CMTime _CMBufferQueueEntry::*time, int32_t sign) {
+        CMTime extreme = kCMTimeInvalid;
+        for (size_t index = 0, count = _count.load(std::memory_order_relaxed); index < count; ++index) {
+            const CMTime& candidate = _EntryAt(index).*time;
+            if (CMTIME_IS_VALID(candidate) && (CMTIME_IS_INVALID(extreme) || CMTimeCompare(candidate, extreme) == sign)) {
+                extreme = candidate;
+            }
+        }
+        return extreme;
+    }
+
+    void _UpdateGateLocked() {
+        if (_callbacks.compare || _validationCallback || !_triggers.empty()) {
+            _gate.fetch_or(c_slowPath, std::memory_order_relaxed);
+        } else {
+            _gate.fetch_and(~c_slowPath, std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<std::unique_ptr<_CMBufferQueueTrigger>>::iterator _FindTriggerLocked(CMBufferQueueTriggerToken token) {
+        return std::find_if(_triggers.begin(), _triggers.end(), [token](const std::unique_ptr<_CMBufferQueueTrigger>& trigger) {
+            return reinterpret_cast<CMBufferQueueTriggerToken>(trigger.get()) == token;
+        });
+    }
+
+    // Only what the installed triggers look at is computed.
+    _CMBufferQueueState _StateLocked() {
+        size_t count = _count.load(std::memory_order_relaxed);
+        _CMBufferQueueState state = { static_cast<CMItemCount>(count), kCMTimeInvalid, kCMTimeInvalid, kCMTimeInvalid, false,
+                                      _endOfData.load(std::memory_order_relaxed) && count == 0 };
+        for (const std::unique_ptr<_CMBufferQueueTrigger>& trigger : _triggers) {
+            switch (trigger->condition) {
+                case kCMBufferQueueTrigger_WhenDurationBecomesLessThan:
+                case kCMBufferQueueTrigger_WhenDurationBecomesLessThanOrEqualTo:
+                case kCMBufferQueueTrigger_WhenDurationBecomesGreaterThan:
+                case kCMBufferQueueTrigger_WhenDurationBecomesGreaterThanOrEqualTo:
+                    state.duration = _DurationLocked();
+                    break;
+                case kCMBufferQueueTrigger_WhenMinPresentationTimeStampChanges:
+                    state.minPresentationTimeStamp = _ExtremeTimeLocked(&_CMBufferQueueEntry::presentationTimeStamp, -1);
+                    break;
+                case kCMBufferQueueTrigger_WhenMaxPresentationTimeStampChanges:
+                    state.maxPresentationTimeStamp = _ExtremeTimeLocked(&_CMBufferQueueEntry::presentationTimeStamp, 1);
+                    break;
+                case kCMBufferQueueTrigger_WhenDataBecomesReady:
+                    state.headIsReady =
+                        count > 0 && (!_callbacks.isDataReady || _callbacks.isDataReady(_EntryAt(0).buffer, _callbacks.refcon));
+                    break;
+                default:
+                    break;
+            }
+        }
+        return state;
+    }
+
+    // Trigger callbacks run after the lock is released, so they may call back into the queue.
+    void _CollectFiringsLocked(const _CMBufferQueueState& before, bool reset, std::vector<_CMBufferQueueFiring>* outFirings) {
+        if (_triggers.empty()) {
+            return;
+        }
+
+        _CMBufferQueueState after = _StateLocked();
+        for (const std::unique_ptr<_CMBufferQueueTrigger>& trigger : _triggers) {
+            bool fires = (reset && trigger->condition == kCMBufferQueueTrigger_WhenReset) || _triggerFires(*trigger, before, after);
+            if (fires && trigger->callback) {
+                outFirings->push_back({ trigger->callback, trigger->refcon, reinterpret_cast<CMBufferQueueTriggerToken>(trigger.get()) });
+            }
+        }
+    }
+
+    CMBufferCallbacks _callbacks;
+    CMItemCount _capacity;
+
+    // Lock-free state. The positions are on their own cache lines so producers and consumers do not contend.
+    std::atomic<uint32_t> _gate;
+    char _gatePadding[64];
+    std::atomic<size_t> _enqueuePosition;
+    char _enqueuePadding[64];
+    std::atomic<size_t> _dequeuePosition;
+    char _dequeuePadding[64];
+    std::atomic<CMItemCount> _count;
+    std::atomic<bool> _endOfData;
+    std::atomic<int32_t> _durationTimescale;
+    std::atomic<int64_t> _durationValue;
+    std::atomic<size_t> _totalSize;
+
+    // Changed only while exclusive.
+    std::unique_ptr<_CMBufferQueueSlot[]> _ring;
+    size_t _mask;
+    size_t _limit;
+
+    std::mutex _lock;
+    CMBufferValidationCallback _validationCallback;
+    void* _validationRefCon;
+    std::vector<std::unique_ptr<_CMBufferQueueTrigger>> _triggers;
+};
+
+static _CMBufferQueueEntry _makeEntry(CMBufferQueueRef queue, CMBufferRef buffer) {
+    const CMBufferCallbacks& callbacks = queue->Callbacks();
+    return { buffer,
+             callbacks.getDecodeTimeStamp ? callbacks.getDecodeTimeStamp(buffer, callbacks.refcon) : kCMTimeInvalid,
+             callbacks.getPresentationTimeStamp ? callbacks.getPresentationTimeStamp(buffer, callbacks.refcon) : kCMTimeInvalid,
+             callbacks.getDuration ? callbacks.getDuration(buffer, callbacks.refcon) : kCMTimeInvalid,
+             callbacks.getSize ? callbacks.getSize(buffer, callbacks.refcon) : 0 };
+}
+
+static OSStatus _installTrigger(CMBufferQueueRef queue,
+                                CMBufferQueueTriggerCallback triggerCallback,
+                                void* triggerRefcon,
+                                CMBufferQueueTriggerCondition triggerCondition,
+                                CMTime triggerTime,
+                                CMItemCount triggerThreshold,
+                                CMBufferQueueTriggerToken* triggerTokenOut) {
+    if (!queue) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+
+    CMBufferQueueTriggerToken token =
+        queue->InstallTrigger({ triggerCallback, triggerRefcon, triggerCondition, triggerTime, triggerThreshold });
+    if (triggerTokenOut) {
+        *triggerTokenOut = token;
+    }
+    return noErr;
+}
+
+static CMTime _sampleBufferDecodeTimeStamp(CMBufferRef buffer, void* refcon) {
+    return CMSampleBufferGetDecodeTimeStamp(static_cast<CMSampleBufferRef>(const_cast<void*>(buffer)));
+}
+
+static CMTime _sampleBufferPresentationTimeStamp(CMBufferRef buffer, void* refcon) {
+    return CMSampleBufferGetPresentationTimeStamp(static_cast<CMSampleBufferRef>(const_cast<void*>(buffer)));
+}
+
+static CMTime _sampleBufferDuration(CMBufferRef buffer, void* refcon) {
+    return CMSampleBufferGetDuration(static_cast<CMSampleBufferRef>(const_cast<void*>(buffer)));
+}
+
+static Boolean _sampleBufferDataIsReady(CMBufferRef buffer, void* refcon) {
+    return CMSampleBufferDataIsReady(static_cast<CMSampleBufferRef>(const_cast<void*>(buffer)));
+}
+
+static size_t _sampleBufferTotalSampleSize(CMBufferRef buffer, void* refcon) {
+    return CMSampleBufferGetTotalSampleSize(static_cast<CMSampleBufferRef>(const_cast<void*>(buffer)));
+}
+
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes A capacity of zero makes the queue unbounded. Enqueue and dequeue are lock-free unless the queue has a compare
+        callback, a validation callback or installed triggers. Version 0 callbacks end before getSize, so a queue created
+        with them reports a total size of zero.
 */
 OSStatus CMBufferQueueCreate(CFAllocatorRef allocator,
                              CMItemCount capacity,
                              const CMBufferCallbacks* callbacks,
                              CMBufferQueueRef _Nullable* queueOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!callbacks || !queueOut) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    if (callbacks->version > 1) {
+        return kCMBufferQueueError_InvalidCMBufferCallbacksStruct;
+    }
+
+    // A version 0 struct may be allocated without getSize, so only the fields its version has are read.
+    CMBufferCallbacks copy = {};
+    memcpy(&copy, callbacks, (callbacks->version == 0) ? offsetof(CMBufferCallbacks, getSize) : sizeof(CMBufferCallbacks));
+
+    CMBufferQueueRef queue = opaqueCMBufferQueue::CreateInstance(allocator, capacity, copy);
+    if (!queue) {
+        return kCMBufferQueueError_AllocationFailed;
+    }
+    *queueOut = queue;
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes The callback must not modify the queue.
 */
 OSStatus CMBufferQueueCallForEachBuffer(CMBufferQueueRef queue, OSStatus (*callback)(CMBufferRef, void*), void* refcon) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue || !callback) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    return queue->CallForEachBuffer(callback, refcon);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMBufferRef CMBufferQueueDequeueAndRetain(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->Dequeue(false) : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMBufferRef CMBufferQueueDequeueIfDataReadyAndRetain(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->Dequeue(true) : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes The buffer's timing and size are read through the queue's callbacks once, when it is enqueued.
 */
 OSStatus CMBufferQueueEnqueue(CMBufferQueueRef queue, CMBufferRef buf) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue || !buf) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+
+    CFRetain(buf);
+    OSStatus status = queue->Enqueue(_makeEntry(queue, buf));
+    if (status != noErr) {
+        CFRelease(buf);
+    }
+    return status;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Triggers fire when their condition becomes true, not when they are installed; use CMBufferQueueTestTrigger to
+        check the current state. Callbacks are invoked after the queue's lock is released.
 */
 OSStatus CMBufferQueueInstallTrigger(CMBufferQueueRef queue,
                                      CMBufferQueueTriggerCallback triggerCallback,
@@ -70,12 +817,18 @@ OSStatus CMBufferQueueInstallTrigger(CMBufferQueueRef queue,
                                      CMBufferQueueTriggerCondition triggerCondition,
                                      CMTime triggerTime,
                                      CMBufferQueueTriggerToken _Nullable* triggerTokenOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (triggerCondition < kCMBufferQueueTrigger_WhenDurationBecomesLessThan || triggerCondition > kCMBufferQueueTrigger_WhenReset) {
+        return kCMBufferQueueError_InvalidTriggerCondition;
+    }
+    if (triggerCondition <= kCMBufferQueueTrigger_WhenDurationBecomesGreaterThanOrEqualTo && !CMTIME_IS_NUMERIC(triggerTime)) {
+        return kCMBufferQueueError_BadTriggerDuration;
+    }
+    return _installTrigger(queue, triggerCallback, triggerRefcon, triggerCondition, triggerTime, 0, triggerTokenOut);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Supports the buffer count conditions.
 */
 OSStatus CMBufferQueueInstallTriggerWithIntegerThreshold(CMBufferQueueRef queue,
                                                          CMBufferQueueTriggerCallback triggerCallback,
@@ -83,166 +836,197 @@ OSStatus CMBufferQueueInstallTriggerWithIntegerThreshold(CMBufferQueueRef queue,
                                                          CMBufferQueueTriggerCondition triggerCondition,
                                                          CMItemCount triggerThreshold,
                                                          CMBufferQueueTriggerToken _Nullable* triggerTokenOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (triggerCondition != kCMBufferQueueTrigger_WhenBufferCountBecomesLessThan &&
+        triggerCondition != kCMBufferQueueTrigger_WhenBufferCountBecomesGreaterThan) {
+        return kCMBufferQueueError_InvalidTriggerCondition;
+    }
+    return _installTrigger(queue, triggerCallback, triggerRefcon, triggerCondition, kCMTimeInvalid, triggerThreshold, triggerTokenOut);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBufferQueueMarkEndOfData(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    queue->MarkEndOfData();
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBufferQueueRemoveTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    return queue->RemoveTrigger(triggerToken);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Also clears the end of data marker.
 */
 OSStatus CMBufferQueueReset(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CMBufferQueueResetWithCallback(queue, nullptr, nullptr);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes The callback is invoked for each buffer, in queue order, before the queue releases it.
 */
 OSStatus CMBufferQueueResetWithCallback(CMBufferQueueRef queue, void (*callback)(CMBufferRef, void*), void* refcon) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    queue->Reset(callback, refcon);
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 OSStatus CMBufferQueueSetValidationCallback(CMBufferQueueRef queue, CMBufferValidationCallback validationCallback, void* validationRefCon) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!queue) {
+        return kCMBufferQueueError_RequiredParameterMissing;
+    }
+    queue->SetValidationCallback(validationCallback, validationRefCon);
+    return noErr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 Boolean CMBufferQueueContainsEndOfData(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue && queue->ContainsEndOfData();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 Boolean CMBufferQueueIsAtEndOfData(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue && queue->ContainsEndOfData() && queue->Count() == 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 Boolean CMBufferQueueIsEmpty(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return !queue || queue->Count() == 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Conditions that watch for changes or resets never test true.
 */
 Boolean CMBufferQueueTestTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue && queue->TestTrigger(triggerToken);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMItemCount CMBufferQueueGetBufferCount(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->Count() : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetMaxPresentationTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->ExtremeTime(&_CMBufferQueueEntry::presentationTimeStamp, 1) : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Caveat
+ @Notes The callbacks read the sample buffer's timing, readiness and size through CMSampleBuffer, which is not yet
+        implemented.
 */
 const CMBufferCallbacks* CMBufferQueueGetCallbacksForUnsortedSampleBuffers() {
-    UNIMPLEMENTED();
-    return StubReturn();
+    static const CMBufferCallbacks s_callbacks = {
+        1, nullptr, _sampleBufferDecodeTimeStamp, _sampleBufferPresentationTimeStamp, _sampleBufferDuration, _sampleBufferDataIsReady,
+        nullptr, nullptr, _sampleBufferTotalSampleSize
+    };
+    return &s_callbacks;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes Constant time while every buffer's duration shares a timescale.
 */
 CMTime CMBufferQueueGetDuration(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->Duration() : kCMTimeInvalid;
+}
+
+/**
+ @Status Interoperable
+ @Notes Constant time. The sum of the sizes the getSize callback reported, or zero if the queue has none.
+*/
+size_t CMBufferQueueGetTotalSize(CMBufferQueueRef queue) {
+    return queue ? queue->TotalSize() : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetEndPresentationTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->EndPresentationTimeStamp() : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetFirstDecodeTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->FirstTime(&_CMBufferQueueEntry::decodeTimeStamp) : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetMinDecodeTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->ExtremeTime(&_CMBufferQueueEntry::decodeTimeStamp, -1) : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetFirstPresentationTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->FirstTime(&_CMBufferQueueEntry::presentationTimeStamp) : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes The buffer is not retained.
 */
 CMBufferRef CMBufferQueueGetHead(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->Head() : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CMTime CMBufferQueueGetMinPresentationTimeStamp(CMBufferQueueRef queue) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return queue ? queue->ExtremeTime(&_CMBufferQueueEntry::presentationTimeStamp, -1) : kCMTimeInvalid;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
 */
 CFTypeID CMBufferQueueGetTypeID() {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return opaqueCMBufferQueue::GetTypeID();
 }
@@ -18,6 +18,10 @@
 #import <StubReturn.h>
 #import "AssertARCEnabled.h"
 
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+
 const CMTime kCMTimeInvalid = { 0, 0, 0, 0 };
 const CMTime kCMTimeIndefinite = { 0, 0, 17, 0 };
 const CMTime kCMTimePositiveInfinity = { 0, 0, 5, 0 };
@@ -28,12 +32,123 @@ const CFStringRef kCMTimeScaleKey = static_cast<CFStringRef>(@"timescale");
 const CFStringRef kCMTimeEpochKey = static_cast<CFStringRef>(@"epoch");
 const CFStringRef kCMTimeFlagsKey = static_cast<CFStringRef>(@"flags");
 
+static CMTime _makeNumeric(CMTimeValue value, CMTimeScale timescale, CMTimeFlags flags, CMTimeEpoch epoch) {
+    CMTime time = { value, timescale, kCMTimeFlags_Valid | (flags & kCMTimeFlags_HasBeenRounded), epoch };
+    return time;
+}
+
+// Rounds numerator / denominator, where the quotient has already been truncated toward zero.
+static int64_t _round(int64_t quotient, int64_t numerator, int64_t denominator, CMTimeRoundingMethod method) {
+    int64_t remainder = numerator % denominator;
+    if (remainder == 0) {
+        return quotient;
+    }
+
+    bool negative = (numerator < 0) != (denominator < 0);
+    int64_t away = negative ? quotient - 1 : quotient + 1;
+    switch (method) {
+        case kCMTimeRoundingMethod_RoundTowardZero:
+            return quotient;
+        case kCMTimeRoundingMethod_RoundAwayFromZero:
+            return away;
+        case kCMTimeRoundingMethod_RoundTowardPositiveInfinity:
+            return negative ? quotient : away;
+        case kCMTimeRoundingMethod_RoundTowardNegativeInfinity:
+            return negative ? away : quotient;
+        default: {
+            // Half away from zero. |remainder| < |denominator| <= INT32_MAX, so doubling it cannot overflow.
+            int64_t twice = 2 * (remainder < 0 ? -remainder : remainder);
+            return (twice >= (denominator < 0 ? -denominator : denominator)) ? away : quotient;
+        }
+    }
+}
+
+// value * to / from without overflowing the intermediate product. Returns false if the result does not fit.
+static bool _rescale(CMTimeValue value, CMTimeScale from, CMTimeScale to, CMTimeRoundingMethod method, CMTimeValue* out, bool* rounded) {
+    if (from == to) {
+        *out = value;
+        return true;
+    }
+
+    // Split value into whole units of from and a remainder so that every product stays within 64 bits.
+    int64_t whole = value / from;
+    int64_t remainder = value % from;
+    if (whole > INT64_MAX / to || whole < INT64_MIN / to) {
+        return false;
+    }
+
+    int64_t scaledRemainder = remainder * to;
+    int64_t fraction = _round(scaledRemainder / from, scaledRemainder, from, method);
+    *rounded = *rounded || (scaledRemainder % from != 0);
+
+    int64_t base = whole * to;
+    if ((fraction > 0 && base > INT64_MAX - fraction) || (fraction < 0 && base < INT64_MIN - fraction)) {
+        return false;
+    }
+    *out = base + fraction;
+    return true;
+}
+
+static int32_t _gcd(int32_t a, int32_t b) {
+    while (b != 0) {
+        int32_t next = a % b;
+        a = b;
+        b = next;
+    }
+    return a;
+}
+
+static CMTime _negate(CMTime time) {
+    if (CMTIME_IS_POSITIVE_INFINITY(time)) {
+        return kCMTimeNegativeInfinity;
+    }
+    if (CMTIME_IS_NEGATIVE_INFINITY(time)) {
+        return kCMTimePositiveInfinity;
+    }
+    if (CMTIME_IS_NUMERIC(time)) {
+        if (time.value == INT64_MIN) {
+            return kCMTimePositiveInfinity;
+        }
+        time.value = -time.value;
+    }
+    return time;
+}
+
+// Orders invalid times above every other time, then positive infinity, then indefinite times.
+static int _rank(CMTime time) {
+    if (CMTIME_IS_INVALID(time)) {
+        return 4;
+    }
+    if (CMTIME_IS_POSITIVE_INFINITY(time)) {
+        return 3;
+    }
+    if (CMTIME_IS_INDEFINITE(time)) {
+        return 2;
+    }
+    if (CMTIME_IS_NEGATIVE_INFINITY(time)) {
+        return 0;
+    }
+    return 1;
+}
+
+// Floor division, so that remainders share the sign of the divisor and compare directly.
+static void _divide(int64_t value, int32_t timescale, int64_t* whole, int64_t* remainder) {
+    *whole = value / timescale;
+    *remainder = value % timescale;
+    if (*remainder < 0) {
+        *whole -= 1;
+        *remainder += timescale;
+    }
+}
+
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeMake(int64_t value, int32_t timescale) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (timescale <= 0) {
+        return kCMTimeInvalid;
+    }
+    return _makeNumeric(value, timescale, 0, 0);
 }
 
 /**
@@ -45,11 +160,13 @@ CMTime CMTimeMakeFromDictionary(CFDictionaryRef dict) {
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeMakeWithEpoch(int64_t value, int32_t timescale, int64_t epoch) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (timescale <= 0) {
+        return kCMTimeInvalid;
+    }
+    return _makeNumeric(value, timescale, 0, epoch);
 }
 
 /**
@@ -61,35 +178,102 @@ CMTime CMTimeMakeWithSeconds(Float64 seconds, int32_t preferredTimeScale) {
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeAbsoluteValue(CMTime time) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (CMTIME_IS_NEGATIVE_INFINITY(time) || (CMTIME_IS_NUMERIC(time) && time.value < 0)) {
+        return _negate(time);
+    }
+    return time;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeAdd(CMTime addend1, CMTime addend2) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (CMTIME_IS_INVALID(addend1) || CMTIME_IS_INVALID(addend2) || addend1.epoch != addend2.epoch) {
+        return kCMTimeInvalid;
+    }
+    if ((CMTIME_IS_POSITIVE_INFINITY(addend1) && CMTIME_IS_NEGATIVE_INFINITY(addend2)) ||
+        (CMTIME_IS_NEGATIVE_INFINITY(addend1) && CMTIME_IS_POSITIVE_INFINITY(addend2))) {
+        return kCMTimeInvalid;
+    }
+    if (CMTIME_IS_INDEFINITE(addend1) || CMTIME_IS_INDEFINITE(addend2)) {
+        return kCMTimeIndefinite;
+    }
+    if (!CMTIME_IS_NUMERIC(addend1)) {
+        return addend1;
+    }
+    if (!CMTIME_IS_NUMERIC(addend2)) {
+        return addend2;
+    }
+
+    // Sums are exact in the least common timescale when it is representable, and rounded to the finer timescale otherwise.
+    CMTimeScale timescale = addend1.timescale;
+    if (addend1.timescale != addend2.timescale) {
+        int64_t common = static_cast<int64_t>(addend1.timescale / _gcd(addend1.timescale, addend2.timescale)) * addend2.timescale;
+        timescale = (common <= kCMTimeMaxTimescale) ? static_cast<CMTimeScale>(common) : std::max(addend1.timescale, addend2.timescale);
+    }
+
+    bool rounded = ((addend1.flags | addend2.flags) & kCMTimeFlags_HasBeenRounded) != 0;
+    CMTimeValue value1, value2;
+    bool fits = _rescale(addend1.value, addend1.timescale, timescale, kCMTimeRoundingMethod_Default, &value1, &rounded) &&
+                _rescale(addend2.value, addend2.timescale, timescale, kCMTimeRoundingMethod_Default, &value2, &rounded);
+    if (!fits || (value2 > 0 && value1 > INT64_MAX - value2) || (value2 < 0 && value1 < INT64_MIN - value2)) {
+        bool negative = fits ? value2 < 0 : (addend1.value < 0);
+        return negative ? kCMTimeNegativeInfinity : kCMTimePositiveInfinity;
+    }
+    return _makeNumeric(value1 + value2, timescale, rounded ? kCMTimeFlags_HasBeenRounded : 0, addend1.epoch);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 int32_t CMTimeCompare(CMTime time1, CMTime time2) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    int rank1 = _rank(time1);
+    int rank2 = _rank(time2);
+    if (rank1 != rank2) {
+        return (rank1 < rank2) ? -1 : 1;
+    }
+    if (rank1 != 1) {
+        return 0;
+    }
+    if (time1.epoch != time2.epoch) {
+        return (time1.epoch < time2.epoch) ? -1 : 1;
+    }
+    if (time1.timescale == time2.timescale) {
+        return (time1.value < time2.value) ? -1 : (time1.value > time2.value) ? 1 : 0;
+    }
+
+    // Compare whole seconds first; the remainders are below their timescales, so their cross products fit in 64 bits.
+    int64_t whole1, remainder1, whole2, remainder2;
+    _divide(time1.value, time1.timescale, &whole1, &remainder1);
+    _divide(time2.value, time2.timescale, &whole2, &remainder2);
+    if (whole1 != whole2) {
+        return (whole1 < whole2) ? -1 : 1;
+    }
+    int64_t fraction1 = remainder1 * time2.timescale;
+    int64_t fraction2 = remainder2 * time1.timescale;
+    return (fraction1 < fraction2) ? -1 : (fraction1 > fraction2) ? 1 : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeConvertScale(CMTime time, int32_t newTimescale, CMTimeRoundingMethod method) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!CMTIME_IS_NUMERIC(time)) {
+        return time;
+    }
+    if (newTimescale <= 0) {
+        return kCMTimeInvalid;
+    }
+
+    bool rounded = (time.flags & kCMTimeFlags_HasBeenRounded) != 0;
+    CMTimeValue value;
+    if (!_rescale(time.value, time.timescale, newTimescale, method, &value, &rounded)) {
+        return (time.value < 0) ? kCMTimeNegativeInfinity : kCMTimePositiveInfinity;
+    }
+    return _makeNumeric(value, newTimescale, rounded ? kCMTimeFlags_HasBeenRounded : 0, time.epoch);
 }
 
 /**
@@ -109,27 +293,39 @@ CFStringRef CMTimeCopyDescription(CFAllocatorRef allocator, CMTime time) {
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 Float64 CMTimeGetSeconds(CMTime time) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (CMTIME_IS_POSITIVE_INFINITY(time)) {
+        return INFINITY;
+    }
+    if (CMTIME_IS_NEGATIVE_INFINITY(time)) {
+        return -INFINITY;
+    }
+    if (!CMTIME_IS_NUMERIC(time)) {
+        return NAN;
+    }
+    return static_cast<Float64>(time.value) / time.timescale;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeMaximum(CMTime time1, CMTime time2) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (CMTIME_IS_INVALID(time1) || CMTIME_IS_INVALID(time2)) {
+        return kCMTimeInvalid;
+    }
+    return (CMTimeCompare(time1, time2) >= 0) ? time1 : time2;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeMinimum(CMTime time1, CMTime time2) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (CMTIME_IS_INVALID(time1) || CMTIME_IS_INVALID(time2)) {
+        return kCMTimeInvalid;
+    }
+    return (CMTimeCompare(time1, time2) <= 0) ? time1 : time2;
 }
 
 /**
@@ -156,9 +352,8 @@ void CMTimeShow(CMTime time) {
 }
 
 /**
- @Status Stub
+ @Status Interoperable
 */
 CMTime CMTimeSubtract(CMTime minuend, CMTime subtrahend) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CMTimeAdd(minuend, _negate(subtrahend));
 }
@@ -21,6 +21,7 @@
 #import "CGPathInternal.h"
 #import <CFCppBase.h>
 #import "DWriteWrapper_CoreText.h"
+#import "Instrumentation.h"
 
 struct __CTFramesetter : CoreFoundation::CppBase<__CTFramesetter> {
     __CTFramesetter(CTTypesetterRef typesetter) : _typesetter(typesetter) {
@@ -48,6 +49,7 @@ CTFramesetterRef CTFramesetterCreateWithAttributedString(CFAttributedStringRef s
 */
 CTFrameRef CTFramesetterCreateFrame(CTFramesetterRef framesetter, CFRange range, CGPathRef path, CFDictionaryRef frameAttributes) {
     RETURN_NULL_IF(framesetter == nil || path == nullptr);
+    INSTRUMENT_SPAN("CoreText", "CTFramesetter.createFrame");
 
     CGRect frameRect = CGPathGetBoundingBox(path);
 
@@ -50,11 +50,13 @@ void CVBufferPropagateAttachments(CVBufferRef sourceBuffer, CVBufferRef destinat
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 void CVBufferRelease(CVBufferRef buffer) {
-    UNIMPLEMENTED();
+    if (buffer) {
+        CFRelease(buffer);
+    }
 }
 
 /**
@@ -74,12 +76,14 @@ void CVBufferRemoveAttachment(CVBufferRef buffer, CFStringRef key) {
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVBufferRef CVBufferRetain(CVBufferRef buffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (buffer) {
+        CFRetain(buffer);
+    }
+    return buffer;
 }
 
 /**
@@ -16,6 +16,15 @@
 
 #import <StubReturn.h>
 #import <CoreVideo/CVPixelBuffer.h>
+#import <CoreVideo/CVPixelFormatDescription.h>
+#import <CoreFoundation/CFByteOrder.h>
+#import <CoreFoundation/CFNumber.h>
+#import "CVPixelBufferInternal.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
 
 const CFStringRef kCVPixelBufferPixelFormatTypeKey = static_cast<CFStringRef>(@"kCVPixelBufferPixelFormatTypeKey");
 const CFStringRef kCVPixelBufferMemoryAllocatorKey = static_cast<CFStringRef>(@"kCVPixelBufferMemoryAllocatorKey");
@@ -35,9 +44,249 @@ const CFStringRef kCVPixelBufferIOSurfacePropertiesKey = static_cast<CFStringRef
 const CFStringRef kCVPixelBufferOpenGLESCompatibilityKey = static_cast<CFStringRef>(@"kCVPixelBufferOpenGLESCompatibilityKey");
 const CFStringRef kCVPixelBufferMetalCompatibilityKey = static_cast<CFStringRef>(@"kCVPixelBufferMetalCompatibilityKey");
 
+namespace {
+
+// Pixel formats CoreVideo can allocate. Chunky formats use the first entry of each per-plane array.
+struct _CVPixelFormatInfo {
+    OSType pixelFormat;
+    size_t planeCount;
+    size_t bytesPerPixel[c_CVPixelBufferMaxPlanes];
+    size_t horizontalSubsampling[c_CVPixelBufferMaxPlanes];
+    size_t verticalSubsampling[c_CVPixelBufferMaxPlanes];
+    // Formats that pack two pixels into one block, such as 4:2:2, round each row up to a whole block.
+    size_t blockWidth;
+};
+
+const _CVPixelFormatInfo c_pixelFormats[] = {
+    { kCVPixelFormatType_32BGRA, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_32ARGB, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_32ABGR, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_32RGBA, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_24RGB, 0, { 3 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_24BGR, 0, { 3 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16BE555, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16LE555, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16LE5551, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16BE565, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16LE565, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_16Gray, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_32AlphaGray, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_48RGB, 0, { 6 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_64ARGB, 0, { 8 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_30RGB, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_422YpCbCr8, 0, { 2 }, { 1 }, { 1 }, 2 },
+    { kCVPixelFormatType_422YpCbCr8_yuvs, 0, { 2 }, { 1 }, { 1 }, 2 },
+    { kCVPixelFormatType_422YpCbCr8FullRange, 0, { 2 }, { 1 }, { 1 }, 2 },
+    { kCVPixelFormatType_OneComponent8, 0, { 1 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_TwoComponent8, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_OneComponent16Half, 0, { 2 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_OneComponent32Float, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_TwoComponent16Half, 0, { 4 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_TwoComponent32Float, 0, { 8 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_64RGBAHalf, 0, { 8 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_128RGBAFloat, 0, { 16 }, { 1 }, { 1 }, 1 },
+    { kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange, 2, { 1, 2 }, { 1, 2 }, { 1, 2 }, 1 },
+    { kCVPixelFormatType_420YpCbCr8BiPlanarFullRange, 2, { 1, 2 }, { 1, 2 }, { 1, 2 }, 1 },
+    { kCVPixelFormatType_420YpCbCr8Planar, 3, { 1, 1, 1 }, { 1, 2, 2 }, { 1, 2, 2 }, 1 },
+    { kCVPixelFormatType_420YpCbCr8PlanarFullRange, 3, { 1, 1, 1 }, { 1, 2, 2 }, { 1, 2, 2 }, 1 },
+};
+
+// Larger dimensions are rejected before any size arithmetic, so strides and plane sizes cannot overflow.
+const size_t c_maximumDimension = 1 << 15;
+
+// Extended pixels can't be more than the image itself; this keeps the layout arithmetic bounded too.
+const size_t c_maximumExtension = c_maximumDimension;
+
+const size_t c_maximumAlignment = 4096;
+
+} // namespace
+
+static const _CVPixelFormatInfo* _getPixelFormatInfo(OSType pixelFormat) {
+    for (const _CVPixelFormatInfo& info : c_pixelFormats) {
+        if (info.pixelFormat == pixelFormat) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+static size_t _divideRoundingUp(size_t value, size_t divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+static size_t _roundUp(size_t value, size_t alignment) {
+    return _divideRoundingUp(value, alignment) * alignment;
+}
+
+// Returns the least multiple of both CoreVideo's own alignment and the one requested in attributes under key, or 0 if the
+// requested alignment is unreasonably large.
+static size_t _alignment(CFDictionaryRef attributes, CFStringRef key) {
+    size_t requested = std::max<size_t>(_CVPixelBufferGetSizeAttribute(attributes, key, 1), 1);
+    if (requested > c_maximumAlignment) {
+        return 0;
+    }
+
+    size_t divisor = requested;
+    size_t remainder = c_CVPixelBufferAlignment;
+    while (remainder != 0) {
+        size_t next = divisor % remainder;
+        divisor = remainder;
+        remainder = next;
+    }
+    return requested / divisor * c_CVPixelBufferAlignment;
+}
+
+size_t _CVPixelBufferGetSizeAttribute(CFDictionaryRef attributes, CFStringRef key, size_t defaultValue) {
+    CFTypeRef value = attributes ? CFDictionaryGetValue(attributes, key) : nullptr;
+    if (!value || CFGetTypeID(value) != CFNumberGetTypeID()) {
+        return defaultValue;
+    }
+
+    long long number = 0;
+    CFNumberGetValue(static_cast<CFNumberRef>(value), kCFNumberLongLongType, &number);
+    return number < 0 ? defaultValue : static_cast<size_t>(number);
+}
+
+CVReturn _CVPixelBufferComputeLayout(
+    size_t width, size_t height, OSType pixelFormat, CFDictionaryRef attributes, CVPixelBufferLayout* layout) {
+    const _CVPixelFormatInfo* info = _getPixelFormatInfo(pixelFormat);
+    if (!info) {
+        return kCVReturnInvalidPixelFormat;
+    }
+    if (width == 0 || height == 0 || width > c_maximumDimension || height > c_maximumDimension) {
+        return kCVReturnInvalidSize;
+    }
+
+    *layout = {};
+    layout->width = width;
+    layout->height = height;
+    layout->pixelFormat = pixelFormat;
+    layout->extendedLeft = _CVPixelBufferGetSizeAttribute(attributes, kCVPixelBufferExtendedPixelsLeftKey, 0);
+    layout->extendedRight = _CVPixelBufferGetSizeAttribute(attributes, kCVPixelBufferExtendedPixelsRightKey, 0);
+    layout->extendedTop = _CVPixelBufferGetSizeAttribute(attributes, kCVPixelBufferExtendedPixelsTopKey, 0);
+    layout->extendedBottom = _CVPixelBufferGetSizeAttribute(attributes, kCVPixelBufferExtendedPixelsBottomKey, 0);
+    if (std::max({ layout->extendedLeft, layout->extendedRight, layout->extendedTop, layout->extendedBottom }) > c_maximumExtension) {
+        return kCVReturnInvalidPixelBufferAttributes;
+    }
+    layout->planeCount = info->planeCount;
+
+    size_t rowAlignment = _alignment(attributes, kCVPixelBufferBytesPerRowAlignmentKey);
+    size_t planeAlignment = _alignment(attributes, kCVPixelBufferPlaneAlignmentKey);
+    if (rowAlignment == 0 || planeAlignment == 0) {
+        return kCVReturnInvalidPixelBufferAttributes;
+    }
+
+    // Planar buffers start with one big-endian CVPlanarComponentInfo per plane.
+    uint64_t offset = info->planeCount * sizeof(CVPlanarComponentInfo);
+    for (size_t plane = 0; plane < std::max<size_t>(info->planeCount, 1); ++plane) {
+        size_t horizontal = info->horizontalSubsampling[plane];
+        size_t vertical = info->verticalSubsampling[plane];
+        size_t bytesPerPixel = info->bytesPerPixel[plane];
+        size_t planeWidth = _divideRoundingUp(width, horizontal);
+        size_t planeHeight = _divideRoundingUp(height, vertical);
+        size_t left = _divideRoundingUp(layout->extendedLeft, horizontal);
+        size_t right = _divideRoundingUp(layout->extendedRight, horizontal);
+        size_t top = _divideRoundingUp(layout->extendedTop, vertical);
+        size_t bottom = _divideRoundingUp(layout->extendedBottom, vertical);
+
+        size_t bytesPerRow = _roundUp((left + _roundUp(planeWidth, info->blockWidth) + right) * bytesPerPixel, rowAlignment);
+        offset = _roundUp(offset, planeAlignment);
+        size_t firstPixel = static_cast<size_t>(offset) + top * bytesPerRow + left * bytesPerPixel;
+        layout->planes[plane] = { planeWidth, planeHeight, bytesPerRow, firstPixel };
+        offset += static_cast<uint64_t>(bytesPerRow) * (top + planeHeight + bottom);
+    }
+
+    offset = _roundUp(offset, c_CVPixelBufferAlignment);
+    if (offset > SIZE_MAX) {
+        return kCVReturnInvalidSize;
+    }
+    layout->dataSize = static_cast<size_t>(offset);
+
+    // Planes can only be aligned in memory to the power of two dividing the plane alignment.
+    layout->dataAlignment = planeAlignment & (~planeAlignment + 1);
+    return kCVReturnSuccess;
+}
+
+void* _CVPixelBufferAllocate(const CVPixelBufferLayout& layout) {
+    return _aligned_malloc(layout.dataSize, layout.dataAlignment);
+}
+
+void _CVPixelBufferFree(void* data) {
+    _aligned_free(data);
+}
+
+__CVBuffer::__CVBuffer(const CVPixelBufferLayout& layout, void* data, const std::shared_ptr<CVPixelBufferRecycler>& recycler)
+    : layout(layout),
+      baseAddress(static_cast<uint8_t*>(data)),
+      planeBaseAddresses(),
+      lockCount(0),
+      data(data),
+      recycler(recycler),
+      releaseBytes(nullptr),
+      releasePlanarBytes(nullptr),
+      releaseRefCon(nullptr) {
+    if (layout.planeCount == 0) {
+        baseAddress += layout.planes[0].offset;
+        return;
+    }
+
+    CVPlanarComponentInfo* header = static_cast<CVPlanarComponentInfo*>(data);
+    for (size_t plane = 0; plane < layout.planeCount; ++plane) {
+        planeBaseAddresses[plane] = baseAddress + layout.planes[plane].offset;
+        header[plane].offset = static_cast<int32_t>(CFSwapInt32HostToBig(static_cast<uint32_t>(layout.planes[plane].offset)));
+        header[plane].rowBytes = CFSwapInt32HostToBig(static_cast<uint32_t>(layout.planes[plane].bytesPerRow));
+    }
+}
+
+__CVBuffer::__CVBuffer(const CVPixelBufferLayout& layout, void* baseAddress, void* const* planeBaseAddresses)
+    : layout(layout),
+      baseAddress(static_cast<uint8_t*>(baseAddress)),
+      planeBaseAddresses(),
+      lockCount(0),
+      data(nullptr),
+      releaseBytes(nullptr),
+      releasePlanarBytes(nullptr),
+      releaseRefCon(nullptr) {
+    for (size_t plane = 0; plane < layout.planeCount; ++plane) {
+        this->planeBaseAddresses[plane] = static_cast<uint8_t*>(planeBaseAddresses[plane]);
+    }
+}
+
+__CVBuffer::~__CVBuffer() {
+    if (data) {
+        if (recycler) {
+            recycler->Recycle(data);
+        } else {
+            _CVPixelBufferFree(data);
+        }
+    } else if (releaseBytes) {
+        releaseBytes(releaseRefCon, baseAddress);
+    } else if (releasePlanarBytes) {
+        const void* planes[c_CVPixelBufferMaxPlanes] = { planeBaseAddresses[0], planeBaseAddresses[1], planeBaseAddresses[2] };
+        releasePlanarBytes(releaseRefCon, baseAddress, layout.dataSize, layout.planeCount, planes);
+    }
+}
+
+// Writes count bytes at destination by repeating pattern, with the pattern ending exactly at destination + count when
+// alignToEnd is set (so the copy lines up with a left edge) and starting at destination otherwise.
+static void _replicate(uint8_t* destination, size_t count, const uint8_t* pattern, size_t patternSize, bool alignToEnd) {
+    size_t phase = alignToEnd ? patternSize - count % patternSize : 0;
+    for (size_t i = 0; i < count; ++i) {
+        destination[i] = pattern[(i + phase) % patternSize];
+    }
+}
+
+static bool _isValidPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) {
+    return pixelBuffer && planeIndex < pixelBuffer->layout.planeCount;
+}
+
+static void _addApplier(const void* key, const void* value, void* context) {
+    CFDictionaryAddValue(static_cast<CFMutableDictionaryRef>(context), key, value);
+}
+
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes kCVPixelBufferMemoryAllocatorKey and the compatibility keys are ignored. Rows and planes are aligned to 64 bytes.
 */
 CVReturn CVPixelBufferCreate(CFAllocatorRef allocator,
                              size_t width,
@@ -45,23 +294,52 @@ CVReturn CVPixelBufferCreate(CFAllocatorRef allocator,
                              OSType pixelFormatType,
                              CFDictionaryRef pixelBufferAttributes,
                              CVPixelBufferRef _Nullable* pixelBufferOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBufferOut) {
+        return kCVReturnInvalidArgument;
+    }
+
+    CVPixelBufferLayout layout;
+    CVReturn status = _CVPixelBufferComputeLayout(width, height, pixelFormatType, pixelBufferAttributes, &layout);
+    if (status != kCVReturnSuccess) {
+        return status;
+    }
+
+    void* data = _CVPixelBufferAllocate(layout);
+    if (!data) {
+        return kCVReturnAllocationFailed;
+    }
+
+    *pixelBufferOut = __CVBuffer::CreateInstance(allocator, layout, data, std::shared_ptr<CVPixelBufferRecycler>());
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Conflicting values are not reported; the first dictionary in the array that sets a key wins.
 */
 CVReturn CVPixelBufferCreateResolvedAttributesDictionary(CFAllocatorRef allocator,
                                                          CFArrayRef attributes,
                                                          CFDictionaryRef _Nullable* resolvedDictionaryOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!resolvedDictionaryOut) {
+        return kCVReturnInvalidArgument;
+    }
+
+    CFMutableDictionaryRef resolved =
+        CFDictionaryCreateMutable(allocator, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    CFIndex count = attributes ? CFArrayGetCount(attributes) : 0;
+    for (CFIndex i = 0; i < count; ++i) {
+        CFTypeRef dictionary = CFArrayGetValueAtIndex(attributes, i);
+        if (dictionary && CFGetTypeID(dictionary) == CFDictionaryGetTypeID()) {
+            CFDictionaryApplyFunction(static_cast<CFDictionaryRef>(dictionary), _addApplier, resolved);
+        }
+    }
+
+    *resolvedDictionaryOut = resolved;
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVReturn CVPixelBufferCreateWithBytes(CFAllocatorRef allocator,
@@ -74,12 +352,31 @@ CVReturn CVPixelBufferCreateWithBytes(CFAllocatorRef allocator,
                                       void* releaseRefCon,
                                       CFDictionaryRef pixelBufferAttributes,
                                       CVPixelBufferRef _Nullable* pixelBufferOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBufferOut || !baseAddress || width == 0 || height == 0) {
+        return kCVReturnInvalidArgument;
+    }
+
+    const _CVPixelFormatInfo* info = _getPixelFormatInfo(pixelFormatType);
+    if (info && info->planeCount != 0) {
+        return kCVReturnInvalidPixelFormat;
+    }
+
+    CVPixelBufferLayout layout = {};
+    layout.width = width;
+    layout.height = height;
+    layout.pixelFormat = pixelFormatType;
+    layout.planes[0] = { width, height, bytesPerRow, 0 };
+    layout.dataSize = bytesPerRow * height;
+
+    CVPixelBufferRef pixelBuffer = __CVBuffer::CreateInstance(allocator, layout, baseAddress, static_cast<void* const*>(nullptr));
+    pixelBuffer->releaseBytes = releaseCallback;
+    pixelBuffer->releaseRefCon = releaseRefCon;
+    *pixelBufferOut = pixelBuffer;
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVReturn CVPixelBufferCreateWithPlanarBytes(CFAllocatorRef allocator,
@@ -97,66 +394,118 @@ CVReturn CVPixelBufferCreateWithPlanarBytes(CFAllocatorRef allocator,
                                             void* releaseRefCon,
                                             CFDictionaryRef pixelBufferAttributes,
                                             CVPixelBufferRef _Nullable* pixelBufferOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBufferOut || numberOfPlanes == 0 || numberOfPlanes > c_CVPixelBufferMaxPlanes || !planeBaseAddress || !planeWidth ||
+        !planeHeight || !planeBytesPerRow || width == 0 || height == 0) {
+        return kCVReturnInvalidArgument;
+    }
+
+    CVPixelBufferLayout layout = {};
+    layout.width = width;
+    layout.height = height;
+    layout.pixelFormat = pixelFormatType;
+    layout.planeCount = numberOfPlanes;
+    for (size_t plane = 0; plane < numberOfPlanes; ++plane) {
+        layout.planes[plane] = { planeWidth[plane], planeHeight[plane], planeBytesPerRow[plane], 0 };
+    }
+    layout.dataSize = dataSize;
+
+    CVPixelBufferRef pixelBuffer = __CVBuffer::CreateInstance(allocator, layout, dataPtr, planeBaseAddress);
+    pixelBuffer->releasePlanarBytes = releaseCallback;
+    pixelBuffer->releaseRefCon = releaseRefCon;
+    *pixelBufferOut = pixelBuffer;
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Extended pixels are filled by repeating the nearest edge pixel.
 */
 CVReturn CVPixelBufferFillExtendedPixels(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBuffer) {
+        return kCVReturnInvalidArgument;
+    }
+
+    const CVPixelBufferLayout& layout = pixelBuffer->layout;
+    const _CVPixelFormatInfo* info = _getPixelFormatInfo(layout.pixelFormat);
+    if (!pixelBuffer->data || !info) {
+        return kCVReturnSuccess;
+    }
+
+    for (size_t plane = 0; plane < std::max<size_t>(layout.planeCount, 1); ++plane) {
+        const CVPixelBufferPlaneLayout& planeLayout = layout.planes[plane];
+        size_t horizontal = info->horizontalSubsampling[plane];
+        size_t vertical = info->verticalSubsampling[plane];
+        size_t bytesPerPixel = info->bytesPerPixel[plane];
+        size_t blockSize = bytesPerPixel * info->blockWidth;
+        size_t left = _divideRoundingUp(layout.extendedLeft, horizontal) * bytesPerPixel;
+        size_t right = _divideRoundingUp(layout.extendedRight, horizontal) * bytesPerPixel;
+        size_t top = _divideRoundingUp(layout.extendedTop, vertical);
+        size_t bottom = _divideRoundingUp(layout.extendedBottom, vertical);
+        size_t visible = _roundUp(planeLayout.width, info->blockWidth) * bytesPerPixel;
+
+        uint8_t* first = static_cast<uint8_t*>(pixelBuffer->data) + planeLayout.offset;
+        for (size_t row = 0; row < planeLayout.height; ++row) {
+            uint8_t* pixels = first + row * planeLayout.bytesPerRow;
+            _replicate(pixels - left, left, pixels, blockSize, true);
+            _replicate(pixels + visible, right, pixels + visible - blockSize, blockSize, false);
+        }
+
+        uint8_t* last = first + (planeLayout.height - 1) * planeLayout.bytesPerRow;
+        for (size_t row = 1; row <= top; ++row) {
+            memcpy(first - row * planeLayout.bytesPerRow - left, first - left, left + visible + right);
+        }
+        for (size_t row = 1; row <= bottom; ++row) {
+            memcpy(last + row * planeLayout.bytesPerRow - left, last - left, left + visible + right);
+        }
+    }
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes For planar buffers this is the big-endian CVPlanarPixelBufferInfo header describing the planes.
 */
 void* CVPixelBufferGetBaseAddress(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->baseAddress : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 void* CVPixelBufferGetBaseAddressOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _isValidPlane(pixelBuffer, planeIndex) ? pixelBuffer->planeBaseAddresses[planeIndex] : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetBytesPerRow(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBuffer) {
+        return 0;
+    }
+    return pixelBuffer->layout.planeCount == 0 ? pixelBuffer->layout.planes[0].bytesPerRow : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetBytesPerRowOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _isValidPlane(pixelBuffer, planeIndex) ? pixelBuffer->layout.planes[planeIndex].bytesPerRow : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetDataSize(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->layout.dataSize : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 void CVPixelBufferGetExtendedPixels(CVPixelBufferRef pixelBuffer,
@@ -164,112 +513,133 @@ void CVPixelBufferGetExtendedPixels(CVPixelBufferRef pixelBuffer,
                                     size_t* extraColumnsOnRight,
                                     size_t* extraRowsOnTop,
                                     size_t* extraRowsOnBottom) {
-    UNIMPLEMENTED();
+    CVPixelBufferLayout empty = {};
+    const CVPixelBufferLayout& layout = pixelBuffer ? pixelBuffer->layout : empty;
+    if (extraColumnsOnLeft) {
+        *extraColumnsOnLeft = layout.extendedLeft;
+    }
+    if (extraColumnsOnRight) {
+        *extraColumnsOnRight = layout.extendedRight;
+    }
+    if (extraRowsOnTop) {
+        *extraRowsOnTop = layout.extendedTop;
+    }
+    if (extraRowsOnBottom) {
+        *extraRowsOnBottom = layout.extendedBottom;
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetHeight(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->layout.height : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetHeightOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _isValidPlane(pixelBuffer, planeIndex) ? pixelBuffer->layout.planes[planeIndex].height : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 OSType CVPixelBufferGetPixelFormatType(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->layout.pixelFormat : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetPlaneCount(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->layout.planeCount : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CFTypeID CVPixelBufferGetTypeID() {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return __CVBuffer::GetTypeID();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetWidth(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer ? pixelBuffer->layout.width : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 size_t CVPixelBufferGetWidthOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _isValidPlane(pixelBuffer, planeIndex) ? pixelBuffer->layout.planes[planeIndex].width : 0;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 Boolean CVPixelBufferIsPlanar(CVPixelBufferRef pixelBuffer) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pixelBuffer && pixelBuffer->layout.planeCount != 0;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Pixel buffers always live in CPU memory, so locking never moves or copies the pixels.
 */
 CVReturn CVPixelBufferLockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags lockFlags) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBuffer) {
+        return kCVReturnInvalidArgument;
+    }
+    pixelBuffer->lockCount.fetch_add(1, std::memory_order_acquire);
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 void CVPixelBufferRelease(CVPixelBufferRef texture) {
-    UNIMPLEMENTED();
+    if (texture) {
+        CFRelease(texture);
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVPixelBufferRef CVPixelBufferRetain(CVPixelBufferRef texture) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (texture) {
+        CFRetain(texture);
+    }
+    return texture;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVReturn CVPixelBufferUnlockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags unlockFlags) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBuffer) {
+        return kCVReturnInvalidArgument;
+    }
+
+    uint32_t count = pixelBuffer->lockCount.load(std::memory_order_relaxed);
+    do {
+        if (count == 0) {
+            return kCVReturnError;
+        }
+    } while (!pixelBuffer->lockCount.compare_exchange_weak(count, count - 1, std::memory_order_release));
+    return kCVReturnSuccess;
 }
@@ -0,0 +1,123 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <CoreVideo/CVPixelBuffer.h>
+#import <CoreVideo/CoreVideoConstants.h>
+#import <CFCppBase.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+static const size_t c_CVPixelBufferMaxPlanes = 3;
+
+// Every row and every plane of a buffer allocated by CoreVideo starts on a boundary of at least this many bytes.
+static const size_t c_CVPixelBufferAlignment = 64;
+
+struct CVPixelBufferPlaneLayout {
+    size_t width;
+    size_t height;
+    size_t bytesPerRow;
+    // Byte offset of the first visible pixel, past any extended rows and columns.
+    size_t offset;
+};
+
+// The geometry of a buffer allocated by CoreVideo: plane sizes, strides and offsets into one allocation of dataSize bytes.
+// Planar layouts begin with a big-endian CVPlanarPixelBufferInfo header, as on the reference platform.
+struct CVPixelBufferLayout {
+    size_t width;
+    size_t height;
+    OSType pixelFormat;
+    size_t extendedLeft;
+    size_t extendedRight;
+    size_t extendedTop;
+    size_t extendedBottom;
+    size_t planeCount;
+    CVPixelBufferPlaneLayout planes[c_CVPixelBufferMaxPlanes];
+    size_t dataSize;
+    // Alignment of the allocation itself, so that plane offsets aligned to it yield aligned addresses.
+    size_t dataAlignment;
+};
+
+// Computes the layout of a width x height buffer of pixelFormat, honoring the extended pixel and alignment keys in attributes.
+CVReturn _CVPixelBufferComputeLayout(
+    size_t width, size_t height, OSType pixelFormat, CFDictionaryRef attributes, CVPixelBufferLayout* layout);
+
+// Reads an integer attribute, returning defaultValue when the key is absent or not a number.
+size_t _CVPixelBufferGetSizeAttribute(CFDictionaryRef attributes, CFStringRef key, size_t defaultValue);
+
+void* _CVPixelBufferAllocate(const CVPixelBufferLayout& layout);
+void _CVPixelBufferFree(void* data);
+
+// Holds the free allocations of a pixel buffer pool. Buffers vended by the pool keep it alive and hand their memory back
+// when they are finalized; once the pool itself is released, returned memory is freed instead.
+class CVPixelBufferRecycler {
+public:
+    CVPixelBufferRecycler(const CVPixelBufferLayout& layout, size_t minimumBufferCount, double maximumBufferAge);
+    ~CVPixelBufferRecycler();
+
+    // Returns a free allocation, or a new one if none is free and fewer than threshold allocations exist (0 means no limit).
+    CVReturn Acquire(size_t threshold, void** data);
+    void Recycle(void* data);
+
+    // Frees the allocations that have aged out, or every free allocation if excess is set.
+    void Flush(bool excess);
+    void Drain();
+
+private:
+    typedef std::chrono::steady_clock _Clock;
+
+    struct _FreeEntry {
+        void* data;
+        _Clock::time_point freedAt;
+    };
+
+    void _AgeLocked(_Clock::time_point now);
+
+    std::mutex _lock;
+    std::deque<_FreeEntry> _free;
+    CVPixelBufferLayout _layout;
+    size_t _minimumBufferCount;
+    _Clock::duration _maximumBufferAge;
+    size_t _allocated;
+    bool _drained;
+};
+
+struct __CVBuffer : CoreFoundation::CppBase<__CVBuffer> {
+    // A buffer over memory allocated by CoreVideo, returned to recycler (if any) when the buffer is finalized.
+    __CVBuffer(const CVPixelBufferLayout& layout, void* data, const std::shared_ptr<CVPixelBufferRecycler>& recycler);
+
+    // A buffer over client memory; the release callbacks are set by the caller.
+    __CVBuffer(const CVPixelBufferLayout& layout, void* baseAddress, void* const* planeBaseAddresses);
+
+    ~__CVBuffer();
+
+    CVPixelBufferLayout layout;
+    uint8_t* baseAddress;
+    uint8_t* planeBaseAddresses[c_CVPixelBufferMaxPlanes];
+    std::atomic<uint32_t> lockCount;
+
+    // Memory allocated by CoreVideo, or nullptr for client memory.
+    void* data;
+    std::shared_ptr<CVPixelBufferRecycler> recycler;
+
+    CVPixelBufferReleaseBytesCallback releaseBytes;
+    CVPixelBufferReleasePlanarBytesCallback releasePlanarBytes;
+    void* releaseRefCon;
+};
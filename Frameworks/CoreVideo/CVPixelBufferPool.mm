@@ -16,87 +16,291 @@
 
 #import <StubReturn.h>
 #import <CoreVideo/CVPixelBufferPool.h>
+#import <CoreFoundation/CFNumber.h>
+#import <Starboard/SmartTypes.h>
+#import "CVPixelBufferInternal.h"
 
 const CFStringRef kCVPixelBufferPoolMinimumBufferCountKey = static_cast<CFStringRef>(@"kCVPixelBufferPoolMinimumBufferCountKey");
 const CFStringRef kCVPixelBufferPoolMaximumBufferAgeKey = static_cast<CFStringRef>(@"kCVPixelBufferPoolMaximumBufferAgeKey");
 const CFStringRef kCVPixelBufferPoolAllocationThresholdKey = static_cast<CFStringRef>(@"kCVPixelBufferPoolAllocationThresholdKey");
 const CFStringRef kCVPixelBufferPoolFreeBufferNotification = static_cast<CFStringRef>(@"kCVPixelBufferPoolFreeBufferNotification");
 
+// Free buffers older than this are released when the pool attributes don't set kCVPixelBufferPoolMaximumBufferAgeKey.
+static const double sc_defaultMaximumBufferAge = 1.0;
+
+CVPixelBufferRecycler::CVPixelBufferRecycler(const CVPixelBufferLayout& layout, size_t minimumBufferCount, double maximumBufferAge)
+    : _layout(layout),
+      _minimumBufferCount(minimumBufferCount),
+      _maximumBufferAge(std::chrono::duration_cast<_Clock::duration>(std::chrono::duration<double>(maximumBufferAge))),
+      _allocated(0),
+      _drained(false) {
+}
+
+CVPixelBufferRecycler::~CVPixelBufferRecycler() {
+    Drain();
+}
+
+CVReturn CVPixelBufferRecycler::Acquire(size_t threshold, void** data) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _AgeLocked(_Clock::now());
+        if (!_free.empty()) {
+            // The most recently freed allocation is the likeliest to still be in the cache.
+            *data = _free.back().data;
+            _free.pop_back();
+            return kCVReturnSuccess;
+        }
+
+        if (threshold != 0 && _allocated >= threshold) {
+            return kCVReturnWouldExceedAllocationThreshold;
+        }
+        ++_allocated;
+    }
+
+    *data = _CVPixelBufferAllocate(_layout);
+    if (!*data) {
+        std::lock_guard<std::mutex> lock(_lock);
+        --_allocated;
+        return kCVReturnAllocationFailed;
+    }
+    return kCVReturnSuccess;
+}
+
+void CVPixelBufferRecycler::Recycle(void* data) {
+    std::unique_lock<std::mutex> lock(_lock);
+    if (_drained) {
+        --_allocated;
+        lock.unlock();
+        _CVPixelBufferFree(data);
+        return;
+    }
+
+    _Clock::time_point now = _Clock::now();
+    _free.push_back({ data, now });
+    _AgeLocked(now);
+}
+
+void CVPixelBufferRecycler::Flush(bool excess) {
+    std::deque<_FreeEntry> free;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!excess) {
+            _AgeLocked(_Clock::now());
+            return;
+        }
+        _allocated -= _free.size();
+        free.swap(_free);
+    }
+
+    for (const _FreeEntry& entry : free) {
+        _CVPixelBufferFree(entry.data);
+    }
+}
+
+void CVPixelBufferRecycler::Drain() {
+    std::deque<_FreeEntry> free;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _drained = true;
+        _allocated -= _free.size();
+        free.swap(_free);
+    }
+
+    for (const _FreeEntry& entry : free) {
+        _CVPixelBufferFree(entry.data);
+    }
+}
+
+// Frees allocations that have sat unused for longer than the maximum age, oldest first, keeping at least the minimum count.
+// Freeing under the lock keeps the bookkeeping simple; it only happens when the pool is already shrinking.
+void CVPixelBufferRecycler::_AgeLocked(_Clock::time_point now) {
+    if (_maximumBufferAge == _Clock::duration::zero()) {
+        return;
+    }
+
+    while (!_free.empty() && _allocated > _minimumBufferCount && now - _free.front().freedAt > _maximumBufferAge) {
+        _CVPixelBufferFree(_free.front().data);
+        _free.pop_front();
+        --_allocated;
+    }
+}
+
+struct _CVPixelBufferPool : CoreFoundation::CppBase<_CVPixelBufferPool> {
+    _CVPixelBufferPool(CFDictionaryRef poolAttributes,
+                       CFDictionaryRef pixelBufferAttributes,
+                       const CVPixelBufferLayout& layout,
+                       size_t minimumBufferCount,
+                       double maximumBufferAge)
+        : poolAttributes(poolAttributes),
+          pixelBufferAttributes(pixelBufferAttributes),
+          layout(layout),
+          recycler(std::make_shared<CVPixelBufferRecycler>(layout, minimumBufferCount, maximumBufferAge)) {
+    }
+
+    // Buffers still in use outlive the pool; their memory is freed rather than recycled once the pool is gone.
+    ~_CVPixelBufferPool() {
+        recycler->Drain();
+    }
+
+    woc::StrongCF<CFDictionaryRef> poolAttributes;
+    woc::StrongCF<CFDictionaryRef> pixelBufferAttributes;
+    CVPixelBufferLayout layout;
+    std::shared_ptr<CVPixelBufferRecycler> recycler;
+};
+
+static CFDictionaryRef _copyAttributes(CFAllocatorRef allocator, CFDictionaryRef attributes) {
+    if (attributes) {
+        return CFDictionaryCreateCopy(allocator, attributes);
+    }
+    return CFDictionaryCreate(allocator, nullptr, nullptr, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+}
+
+// kCVPixelBufferPixelFormatTypeKey is either a number or an array of acceptable formats, of which the pool uses the first.
+static bool _getPixelFormat(CFDictionaryRef attributes, OSType* pixelFormat) {
+    CFTypeRef value = CFDictionaryGetValue(attributes, kCVPixelBufferPixelFormatTypeKey);
+    if (value && CFGetTypeID(value) == CFArrayGetTypeID() && CFArrayGetCount(static_cast<CFArrayRef>(value)) > 0) {
+        value = CFArrayGetValueAtIndex(static_cast<CFArrayRef>(value), 0);
+    }
+    if (!value || CFGetTypeID(value) != CFNumberGetTypeID()) {
+        return false;
+    }
+
+    SInt64 number = 0;
+    CFNumberGetValue(static_cast<CFNumberRef>(value), kCFNumberSInt64Type, &number);
+    *pixelFormat = static_cast<OSType>(number);
+    return true;
+}
+
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Buffers are allocated lazily. kCVPixelBufferPoolFreeBufferNotification is never posted.
 */
 CVReturn CVPixelBufferPoolCreate(CFAllocatorRef allocator,
                                  CFDictionaryRef poolAttributes,
                                  CFDictionaryRef pixelBufferAttributes,
                                  CVPixelBufferPoolRef _Nullable* poolOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!poolOut) {
+        return kCVReturnInvalidArgument;
+    }
+
+    OSType pixelFormat;
+    size_t width = _CVPixelBufferGetSizeAttribute(pixelBufferAttributes, kCVPixelBufferWidthKey, 0);
+    size_t height = _CVPixelBufferGetSizeAttribute(pixelBufferAttributes, kCVPixelBufferHeightKey, 0);
+    if (!pixelBufferAttributes || !_getPixelFormat(pixelBufferAttributes, &pixelFormat) || width == 0 || height == 0) {
+        return kCVReturnInvalidPixelBufferAttributes;
+    }
+
+    CVPixelBufferLayout layout;
+    CVReturn status = _CVPixelBufferComputeLayout(width, height, pixelFormat, pixelBufferAttributes, &layout);
+    if (status != kCVReturnSuccess) {
+        return status;
+    }
+
+    double maximumBufferAge = sc_defaultMaximumBufferAge;
+    CFTypeRef age = poolAttributes ? CFDictionaryGetValue(poolAttributes, kCVPixelBufferPoolMaximumBufferAgeKey) : nullptr;
+    if (age) {
+        if (CFGetTypeID(age) != CFNumberGetTypeID()) {
+            return kCVReturnInvalidPoolAttributes;
+        }
+        CFNumberGetValue(static_cast<CFNumberRef>(age), kCFNumberDoubleType, &maximumBufferAge);
+        if (maximumBufferAge < 0) {
+            return kCVReturnInvalidPoolAttributes;
+        }
+    }
+    size_t minimumBufferCount = _CVPixelBufferGetSizeAttribute(poolAttributes, kCVPixelBufferPoolMinimumBufferCountKey, 0);
+
+    woc::StrongCF<CFDictionaryRef> poolCopy = woc::MakeStrongCF(_copyAttributes(allocator, poolAttributes));
+    woc::StrongCF<CFDictionaryRef> pixelBufferCopy = woc::MakeStrongCF(_copyAttributes(allocator, pixelBufferAttributes));
+    *poolOut = _CVPixelBufferPool::CreateInstance(
+        allocator, poolCopy.get(), pixelBufferCopy.get(), layout, minimumBufferCount, maximumBufferAge);
+    return kCVReturnSuccess;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVReturn CVPixelBufferPoolCreatePixelBuffer(CFAllocatorRef allocator,
                                             CVPixelBufferPoolRef pixelBufferPool,
                                             CVPixelBufferRef _Nullable* pixelBufferOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(allocator, pixelBufferPool, nullptr, pixelBufferOut);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVReturn CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(CFAllocatorRef allocator,
                                                              CVPixelBufferPoolRef pixelBufferPool,
                                                              CFDictionaryRef auxAttributes,
                                                              CVPixelBufferRef _Nullable* pixelBufferOut) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (!pixelBufferPool || !pixelBufferOut) {
+        return kCVReturnInvalidArgument;
+    }
+
+    size_t threshold = _CVPixelBufferGetSizeAttribute(auxAttributes, kCVPixelBufferPoolAllocationThresholdKey, 0);
+    void* data;
+    CVReturn status = pixelBufferPool->recycler->Acquire(threshold, &data);
+    if (status != kCVReturnSuccess) {
+        return status;
+    }
+
+    *pixelBufferOut = __CVBuffer::CreateInstance(allocator, pixelBufferPool->layout, data, pixelBufferPool->recycler);
+    return kCVReturnSuccess;
+}
+
+/**
+ @Status Interoperable
+ @Notes Free buffers are otherwise aged out only when the pool vends or recycles a buffer, so an idle pool keeps them
+        until it is flushed or released.
+*/
+void CVPixelBufferPoolFlush(CVPixelBufferPoolRef pool, CVPixelBufferPoolFlushFlags options) {
+    if (pool) {
+        pool->recycler->Flush((options & kCVPixelBufferPoolFlushExcessBuffers) != 0);
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CFDictionaryRef CVPixelBufferPoolGetAttributes(CVPixelBufferPoolRef pool) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pool ? pool->poolAttributes.get() : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CFDictionaryRef CVPixelBufferPoolGetPixelBufferAttributes(CVPixelBufferPoolRef pool) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return pool ? pool->pixelBufferAttributes.get() : nullptr;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CFTypeID CVPixelBufferPoolGetTypeID() {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _CVPixelBufferPool::GetTypeID();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 void CVPixelBufferPoolRelease(CVPixelBufferPoolRef pixelBufferPool) {
-    UNIMPLEMENTED();
+    if (pixelBufferPool) {
+        CFRelease(pixelBufferPool);
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 CVPixelBufferPoolRef CVPixelBufferPoolRetain(CVPixelBufferPoolRef pixelBufferPool) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (pixelBufferPool) {
+        CFRetain(pixelBufferPool);
+    }
+    return pixelBufferPool;
 }
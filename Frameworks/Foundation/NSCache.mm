@@ -15,7 +15,9 @@
 //******************************************************************************
 
 #import <Foundation/NSCache.h>
+#import <Foundation/NSDiscardableContent.h>
 
+#import <NSMemoryPressure.h>
 #import <Starboard/SmartTypes.h>
 
 #include <list>
@@ -66,7 +68,7 @@ struct equal_to<id> {
 }
 
 using cacheType = std::list<StrongId<_NSCacheEntry>>;
-@interface NSCache () {
+@interface NSCache () <_NSMemoryPressureClient> {
     cacheType _cacheEntries;
     std::unordered_map<id, cacheType::iterator> _iterators;
 
@@ -87,11 +89,13 @@ using cacheType = std::list<StrongId<_NSCacheEntry>>;
 - (instancetype)init {
     if (self = [super init]) {
         _evictsObjectsWithDiscardedContent = YES;
+        _NSMemoryPressureAddClient(self, _NSMemoryPressurePriorityCache);
     }
     return self;
 }
 
 - (void)dealloc {
+    _NSMemoryPressureRemoveClient(self);
     [_name release];
     [super dealloc];
 }
@@ -297,4 +301,29 @@ using cacheType = std::list<StrongId<_NSCacheEntry>>;
         }
     } while ((overCost > 0 || overCount > 0) && rit != _cacheEntries.begin());
 }
+
+// Under warning pressure, evicts the entries whose content has already been discarded and then the least recently used
+// half of the rest. Under critical pressure, evicts everything.
+- (void)_shedMemoryForPressureLevel:(_NSMemoryPressureLevel)level {
+    if (level == _NSMemoryPressureLevelCritical) {
+        [self removeAllObjects];
+        return;
+    }
+
+    @synchronized(self) {
+        if (_evictsObjectsWithDiscardedContent) {
+            for (auto it = _cacheEntries.begin(); it != _cacheEntries.end();) {
+                _NSCacheEntry* entry = *it++;
+                if ([entry discardable] && [(id<NSDiscardableContent>)[entry object] isContentDiscarded]) {
+                    [self _evictEntry:entry force:true];
+                }
+            }
+        }
+
+        size_t remaining = _cacheEntries.size() / 2;
+        while (_cacheEntries.size() > remaining) {
+            [self _evictEntry:_cacheEntries.back() force:false];
+        }
+    }
+}
 @end
@@ -14,181 +14,293 @@
 //
 //******************************************************************************
 
-#import <StubReturn.h>
+#import <Foundation/NSCoder.h>
 #import <Foundation/NSHashTable.h>
+#import <Foundation/NSMutableArray.h>
+#import <Foundation/NSMutableSet.h>
+#import <NSPointerFunctionsConcrete.h>
+#import <NSPointerTable.h>
+#import <Starboard.h>
+
+#import <memory>
+
+static NSString* const NSHashTableOptionsEncodingKey = @"NSHashTableOptionsEncodingKey";
+static NSString* const NSHashTableObjectsEncodingKey = @"NSHashTableObjectsEncodingKey";
+
+@implementation NSHashTable {
+@private
+    std::unique_ptr<_NSPointerTable> _table;
+}
 
-@implementation NSHashTable
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Creates a hash table with strong memory and object personality
+*/
+- (instancetype)init {
+    return [self initWithOptions:NSHashTableStrongMemory capacity:0];
+}
+
+/**
+ @Status Interoperable
 */
 - (instancetype)initWithOptions:(NSPointerFunctionsOptions)options capacity:(NSUInteger)capacity {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [self initWithPointerFunctions:[NSPointerFunctions pointerFunctionsWithOptions:options] capacity:capacity];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Designated Initializer
 */
 - (instancetype)initWithPointerFunctions:(NSPointerFunctions*)functions capacity:(NSUInteger)initialCapacity {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (self = [super init]) {
+        _pointerFunctions = [functions copy];
+        _table.reset(new _NSPointerTable(_pointerFunctions, nil, initialCapacity));
+    }
+
+    return self;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+*/
+- (void)dealloc {
+    [self removeAllObjects];
+    [_pointerFunctions release];
+
+    [super dealloc];
+}
+
+/**
+ @Status Interoperable
  @Notes
 */
 + (NSHashTable*)weakObjectsHashTable {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [self hashTableWithOptions:NSHashTableWeakMemory];
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 + (NSHashTable*)hashTableWithOptions:(NSPointerFunctionsOptions)options {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [[[self alloc] initWithOptions:options capacity:0] autorelease];
+}
+
+/**
+ @Status Interoperable
+ @Notes
+*/
+- (NSArray*)allObjects {
+    NSMutableArray* ret = [NSMutableArray array];
+    for (NSUInteger index = 0; index < _table->SlotCount(); ++index) {
+        id object;
+        if (_table->EntryAtSlot(index, &object, nullptr)) {
+            [ret addObject:object];
+        }
+    }
+
+    return ret;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes
+*/
+- (id)anyObject {
+    for (NSUInteger index = 0; index < _table->SlotCount(); ++index) {
+        id object;
+        if (_table->EntryAtSlot(index, &object, nullptr)) {
+            return object;
+        }
+    }
+
+    return nil;
+}
+
+/**
+ @Status Interoperable
  @Notes
 */
 - (BOOL)containsObject:(id)anObject {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return anObject && _table->Contains(anObject);
 }
 
 /**
- @Status Stub
+ @Status Interoperable
+ @Notes For weak tables, reclaims the entries of deallocated objects first
+*/
+- (NSUInteger)count {
+    return _table->Count();
+}
+
+/**
+ @Status Interoperable
  @Notes
 */
 - (id)member:(id)object {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return object ? _table->Member(object) : nil;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (NSEnumerator*)objectEnumerator {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [[[_NSPointerTableEnumerator alloc] initWithCollection:self table:_table.get() returnKeys:YES] autorelease];
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
+- (NSSet*)setRepresentation {
+    return [NSSet setWithArray:[self allObjects]];
+}
+
+/**
+ @Status Interoperable
+ @Notes Adding an object equal to one already in the table leaves the table unchanged
+*/
 - (void)addObject:(id)object {
-    UNIMPLEMENTED();
+    if (object) {
+        _table->Insert(object, nil, false);
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (void)removeAllObjects {
-    UNIMPLEMENTED();
+    _table->RemoveAll();
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (void)removeObject:(id)object {
-    UNIMPLEMENTED();
+    if (object) {
+        _table->Remove(object);
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (BOOL)intersectsHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
-    return StubReturn();
+    for (id object in self) {
+        if ([other containsObject:object]) {
+            return YES;
+        }
+    }
+
+    return NO;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (void)intersectHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
+    for (id object in [self allObjects]) {
+        if (![other containsObject:object]) {
+            [self removeObject:object];
+        }
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (BOOL)isEqualToHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (self == other) {
+        return YES;
+    }
+
+    return ([self count] == [other count]) && [self isSubsetOfHashTable:other];
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (BOOL)isSubsetOfHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
-    return StubReturn();
+    for (id object in self) {
+        if (![other containsObject:object]) {
+            return NO;
+        }
+    }
+
+    return YES;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (void)minusHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
+    for (id object in [other allObjects]) {
+        [self removeObject:object];
+    }
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (void)unionHashTable:(NSHashTable*)other {
-    UNIMPLEMENTED();
+    for (id object in [other allObjects]) {
+        [self addObject:object];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes For encoding/decoding, all objects must also support NSCoding
 */
 - (instancetype)initWithCoder:(NSCoder*)decoder {
-    UNIMPLEMENTED();
-    return StubReturn();
+    NSPointerFunctionsOptions options = [decoder decodeIntForKey:NSHashTableOptionsEncodingKey];
+
+    if (self = [self initWithOptions:options capacity:0]) {
+        for (id object in [decoder decodeObjectOfClass:[NSArray class] forKey:NSHashTableObjectsEncodingKey]) {
+            [self addObject:object];
+        }
+    }
+
+    return self;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes For encoding/decoding, all objects must also support NSCoding
 */
 - (void)encodeWithCoder:(NSCoder*)encoder {
-    UNIMPLEMENTED();
+    [encoder encodeInt:[reinterpret_cast<_NSConcretePointerFunctions*>(_pointerFunctions) options] forKey:NSHashTableOptionsEncodingKey];
+    [encoder encodeObject:[self allObjects] forKey:NSHashTableObjectsEncodingKey];
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (id)copyWithZone:(NSZone*)zone {
-    UNIMPLEMENTED();
-    return StubReturn();
+    NSHashTable* ret = [[[self class] alloc] initWithPointerFunctions:_pointerFunctions capacity:[self count]];
+    for (id object in self) {
+        [ret addObject:object];
+    }
+
+    return ret;
 }
 
 /**
- @Status Stub
+ @Status Interoperable
  @Notes
 */
 - (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState*)state objects:(id _Nonnull[])stackbuf count:(NSUInteger)len {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return _table->CountByEnumerating(state, stackbuf, len, true);
 }
 
 @end
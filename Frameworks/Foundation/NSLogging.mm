@@ -22,6 +22,10 @@
 static const wchar_t* g_TraceFormat = L"%ws";
 
 void NSTraceVerbose(const wchar_t* tag, NSString* format, ...) {
+    if (!TraceIsEnabled(TraceLevelVerbose, tag)) {
+        return;
+    }
+
     va_list list;
     va_start(list, format);
     StrongId<NSString> formattedString;
@@ -32,6 +36,10 @@ void NSTraceVerbose(const wchar_t* tag, NSString* format, ...) {
 }
 
 void NSTraceInfo(const wchar_t* tag, NSString* format, ...) {
+    if (!TraceIsEnabled(TraceLevelInfo, tag)) {
+        return;
+    }
+
     va_list list;
     va_start(list, format);
     StrongId<NSString> formattedString;
@@ -42,6 +50,10 @@ void NSTraceInfo(const wchar_t* tag, NSString* format, ...) {
 }
 
 void NSTraceWarning(const wchar_t* tag, NSString* format, ...) {
+    if (!TraceIsEnabled(TraceLevelWarning, tag)) {
+        return;
+    }
+
     va_list list;
     va_start(list, format);
     StrongId<NSString> formattedString;
@@ -52,6 +64,10 @@ void NSTraceWarning(const wchar_t* tag, NSString* format, ...) {
 }
 
 void NSTraceError(const wchar_t* tag, NSString* format, ...) {
+    if (!TraceIsEnabled(TraceLevelError, tag)) {
+        return;
+    }
+
     va_list list;
     va_start(list, format);
     StrongId<NSString> formattedString;
@@ -62,6 +78,10 @@ void NSTraceError(const wchar_t* tag, NSString* format, ...) {
 }
 
 void NSTraceCritical(const wchar_t* tag, NSString* format, ...) {
+    if (!TraceIsEnabled(TraceLevelCritical, tag)) {
+        return;
+    }
+
     va_list list;
     va_start(list, format);
     StrongId<NSString> formattedString;
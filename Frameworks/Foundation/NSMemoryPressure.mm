@@ -0,0 +1,243 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <NSMemoryPressure.h>
+#import <Starboard.h>
+
+#import <objc/objc-arc.h>
+#import <dispatch/dispatch.h>
+
+#include <windows.h>
+#include <psapi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+
+static const wchar_t* TAG = L"NSMemoryPressure";
+
+// How often the monitor samples the process and the system while it polls.
+static const uint64_t sc_pollIntervalNanoseconds = 250 * NSEC_PER_MSEC;
+
+namespace {
+struct _NSMemoryPressureClientEntry {
+    NSInteger priority;
+    // Identifies the client once it has started deallocating, when the weak reference already reads as nil.
+    void* identity;
+    id weakClient;
+};
+
+// The list holds the weak references in place, since they cannot be copied or moved by value.
+struct _NSMemoryPressureState {
+    std::mutex mutex;
+    std::list<_NSMemoryPressureClientEntry> clients;
+    dispatch_source_t timer = nullptr;
+    HANDLE lowMemoryNotification = nullptr;
+    HANDLE lowMemoryWait = nullptr;
+    // Set once a client or budget has been added; the monitor does not run before then.
+    bool monitoring = false;
+    // Whether the last poll found any pressure.
+    bool pressured = false;
+    _NSMemoryPressureLevel lastLevel = _NSMemoryPressureLevelNormal;
+    std::atomic<size_t> budget{ 0 };
+
+    // Serializes the monitor's ticks with direct polls from tests.
+    std::mutex pollMutex;
+};
+
+_NSMemoryPressureState& _state() {
+    static _NSMemoryPressureState* state = new _NSMemoryPressureState();
+    return *state;
+}
+}
+
+static size_t _warningMarkForBudget(size_t budget) {
+    return budget - budget / 4;
+}
+
+size_t _NSMemoryPressureProcessUsage() {
+    PROCESS_MEMORY_COUNTERS_EX counters = { sizeof(counters) };
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        return 0;
+    }
+    return counters.PrivateUsage;
+}
+
+// Asks the clients to shed memory in priority order. With stopWhenRelieved, stops once the process is back under the
+// warning mark of its budget.
+static void _shedMemory(_NSMemoryPressureLevel level, bool stopWhenRelieved) {
+    auto& state = _state();
+
+    std::vector<StrongId<id>> clients;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (auto it = state.clients.begin(); it != state.clients.end();) {
+            StrongId<id> client;
+            client.attach(objc_loadWeakRetained(&it->weakClient));
+            if (!client) {
+                objc_destroyWeak(&it->weakClient);
+                it = state.clients.erase(it);
+                continue;
+            }
+            clients.emplace_back(std::move(client));
+            ++it;
+        }
+    }
+
+    TraceVerbose(TAG, L"Shedding memory for pressure level %u across %u clients", level, static_cast<unsigned int>(clients.size()));
+
+    for (auto& client : clients) {
+        @autoreleasepool {
+            [client _shedMemoryForPressureLevel:level];
+        }
+
+        size_t budget = state.budget.load();
+        if (stopWhenRelieved && (budget != 0) && (_NSMemoryPressureProcessUsage() < _warningMarkForBudget(budget))) {
+            break;
+        }
+    }
+}
+
+static void _updateMonitor(_NSMemoryPressureState& state);
+
+void _NSMemoryPressurePoll() {
+    auto& state = _state();
+    std::lock_guard<std::mutex> pollLock(state.pollMutex);
+
+    _NSMemoryPressureLevel level = _NSMemoryPressureLevelNormal;
+
+    size_t budget = state.budget.load();
+    if (budget != 0) {
+        size_t usage = _NSMemoryPressureProcessUsage();
+        if (usage >= budget) {
+            level = _NSMemoryPressureLevelCritical;
+        } else if (usage >= _warningMarkForBudget(budget)) {
+            level = _NSMemoryPressureLevelWarning;
+        }
+    }
+
+    BOOL systemLow = FALSE;
+    if (state.lowMemoryNotification && QueryMemoryResourceNotification(state.lowMemoryNotification, &systemLow) && systemLow) {
+        level = std::max(level, _NSMemoryPressureLevelWarning);
+    }
+
+    if ((level != _NSMemoryPressureLevelNormal) && ((level > state.lastLevel) || (level == _NSMemoryPressureLevelCritical))) {
+        _shedMemory(level, budget != 0);
+    }
+
+    state.lastLevel = level;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.pressured = (level != _NSMemoryPressureLevelNormal);
+    if (state.monitoring) {
+        _updateMonitor(state);
+    }
+}
+
+static VOID CALLBACK _lowMemorySignaled(PVOID context, BOOLEAN timedOut) {
+    auto& state = _state();
+    {
+        // The wait only fires once; the poll registers a new one if it is still wanted.
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.lowMemoryWait) {
+            UnregisterWaitEx(state.lowMemoryWait, nullptr);
+            state.lowMemoryWait = nullptr;
+        }
+    }
+
+    _NSMemoryPressurePoll();
+}
+
+// invariant: under state.mutex
+// Polls on a timer while there is a budget to check usage against, or while there is pressure, so that the clients hear
+// about pressure that grows or stays critical. Otherwise only the system running low on memory can raise the level, so
+// the monitor just waits for its notification.
+static void _updateMonitor(_NSMemoryPressureState& state) {
+    if (!state.lowMemoryNotification) {
+        state.lowMemoryNotification = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+    }
+
+    bool poll = (state.budget.load() != 0) || state.pressured;
+    if (poll && !state.timer) {
+        state.timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+        dispatch_source_set_timer(state.timer, dispatch_time(DISPATCH_TIME_NOW, sc_pollIntervalNanoseconds), sc_pollIntervalNanoseconds, 0);
+        dispatch_source_set_event_handler(state.timer, ^{
+            _NSMemoryPressurePoll();
+        });
+        dispatch_resume(state.timer);
+    } else if (!poll && state.timer) {
+        dispatch_source_cancel(state.timer);
+        dispatch_release(state.timer);
+        state.timer = nullptr;
+    }
+
+    bool wait = !poll && state.lowMemoryNotification;
+    if (wait && !state.lowMemoryWait) {
+        if (!RegisterWaitForSingleObject(
+                &state.lowMemoryWait, state.lowMemoryNotification, _lowMemorySignaled, nullptr, INFINITE, WT_EXECUTEONLYONCE)) {
+            TraceError(TAG, L"Failed to wait for low memory notifications: %u", GetLastError());
+            state.lowMemoryWait = nullptr;
+        }
+    } else if (!wait && state.lowMemoryWait) {
+        UnregisterWaitEx(state.lowMemoryWait, nullptr);
+        state.lowMemoryWait = nullptr;
+    }
+}
+
+void _NSMemoryPressureAddClient(id<_NSMemoryPressureClient> client, NSInteger priority) {
+    auto& state = _state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    // Clients of equal priority shed memory in the order they were added.
+    auto position = std::find_if(state.clients.begin(), state.clients.end(), [priority](const _NSMemoryPressureClientEntry& entry) {
+        return entry.priority > priority;
+    });
+    auto entry = state.clients.emplace(position, _NSMemoryPressureClientEntry{ priority, client, nil });
+    objc_storeWeak(&entry->weakClient, client);
+
+    state.monitoring = true;
+    _updateMonitor(state);
+}
+
+void _NSMemoryPressureRemoveClient(id<_NSMemoryPressureClient> client) {
+    auto& state = _state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    auto found = std::find_if(state.clients.begin(), state.clients.end(), [client](const _NSMemoryPressureClientEntry& entry) {
+        return entry.identity == client;
+    });
+    if (found != state.clients.end()) {
+        objc_destroyWeak(&found->weakClient);
+        state.clients.erase(found);
+    }
+}
+
+void _NSMemoryPressureSignal(_NSMemoryPressureLevel level) {
+    if (level != _NSMemoryPressureLevelNormal) {
+        _shedMemory(level, false);
+    }
+}
+
+void _NSMemoryPressureSetBudget(size_t bytes) {
+    auto& state = _state();
+    state.budget = bytes;
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.monitoring = true;
+    _updateMonitor(state);
+}
@@ -14,27 +14,32 @@
 //
 //******************************************************************************
 
+#import <Foundation/NSIndexSet.h>
+#import <Foundation/NSMutableIndexSet.h>
 #import <Foundation/NSMutableOrderedSet.h>
+#import <Foundation/NSPredicate.h>
+#import <Foundation/NSSet.h>
 #import <NSOrderedSetInternal.h>
-#import <StubReturn.h>
+#import <Starboard.h>
+
+#import <algorithm>
 
 @implementation NSMutableOrderedSet
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 + (instancetype)orderedSetWithCapacity:(NSUInteger)numItems {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [[[self alloc] initWithCapacity:numItems] autorelease];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (instancetype)initWithCapacity:(NSUInteger)numItems {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (self = [self init]) {
+        _index.reserve(numItems);
+    }
+    return self;
 }
 
 /**
@@ -52,19 +57,21 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)addObjects:(id _Nonnull const[])objects count:(NSUInteger)count {
-    UNIMPLEMENTED();
+    for (NSUInteger i = 0; i < count; ++i) {
+        [self addObject:objects[i]];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)addObjectsFromArray:(NSArray*)array {
-    UNIMPLEMENTED();
+    for (id object in array) {
+        [self addObject:object];
+    }
 }
 
 /**
@@ -73,212 +80,303 @@
 - (void)insertObject:(id)object atIndex:(NSUInteger)idx {
     THROW_NS_IF_FALSE(E_INVALIDARG, object != nil);
 
-    if ([self containsObject:object]) {
+    NSUInteger count = [self count];
+    THROW_NS_IF_FALSE(E_BOUNDS, idx <= count);
+
+    if (idx == count) {
+        [self _insertObject:object];
+        return;
+    }
+
+    if (!_index.emplace(object, idx).second) {
         return;
     }
 
     [_arrayContainer insertObject:object atIndex:idx];
-    [_setContainer addObject:object];
+    [self _invalidateIndexesFrom:idx];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)setObject:(id)object atIndexedSubscript:(NSUInteger)idx {
-    UNIMPLEMENTED();
+    [self setObject:object atIndex:idx];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Objects that are already in the set, or that appear earlier in objects, are skipped, and the later indexes are
+        adjusted to close the gaps.
 */
 - (void)insertObjects:(NSArray*)objects atIndexes:(NSIndexSet*)indexes {
-    UNIMPLEMENTED();
+    THROW_NS_IF_FALSE(E_INVALIDARG, [objects count] == [indexes count]);
+
+    __block NSUInteger objectIndex = 0;
+    __block NSUInteger skipped = 0;
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL* stop) {
+        id object = [objects objectAtIndex:objectIndex++];
+        if ([self containsObject:object]) {
+            ++skipped;
+        } else {
+            [self insertObject:object atIndex:idx - skipped];
+        }
+    }];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeObject:(id)object {
-    UNIMPLEMENTED();
+    NSUInteger idx = [self _positionOfObject:object];
+    if (idx != NSNotFound) {
+        [self removeObjectAtIndex:idx];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeObjectAtIndex:(NSUInteger)idx {
-    UNIMPLEMENTED();
+    _index.erase([_arrayContainer objectAtIndex:idx]);
+    [_arrayContainer removeObjectAtIndex:idx];
+    [self _invalidateIndexesFrom:idx];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeObjectsAtIndexes:(NSIndexSet*)indexes {
-    UNIMPLEMENTED();
+    if ([indexes count] == 0) {
+        return;
+    }
+
+    THROW_NS_IF_FALSE(E_BOUNDS, [indexes lastIndex] < [self count]);
+
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL* stop) {
+        _index.erase([_arrayContainer objectAtIndex:idx]);
+    }];
+    [_arrayContainer removeObjectsAtIndexes:indexes];
+    [self _invalidateIndexesFrom:[indexes firstIndex]];
+}
+
+// Removes the elements equal to any of objects, in one pass over the array.
+- (void)_removeObjectsIn:(id<NSFastEnumeration>)objects {
+    NSMutableIndexSet* indexes = [NSMutableIndexSet indexSet];
+    for (id object in objects) {
+        NSUInteger idx = [self _positionOfObject:object];
+        if (idx != NSNotFound) {
+            [indexes addIndex:idx];
+        }
+    }
+
+    [self removeObjectsAtIndexes:indexes];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeObjectsInArray:(NSArray*)array {
-    UNIMPLEMENTED();
+    [self _removeObjectsIn:array];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeObjectsInRange:(NSRange)range {
-    UNIMPLEMENTED();
+    [self removeObjectsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:range]];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)removeAllObjects {
-    UNIMPLEMENTED();
+    _index.clear();
+    [_arrayContainer removeAllObjects];
+    _validIndexCount = 0;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Does nothing if an object equal to object is already in the set at another index.
 */
 - (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(id)object {
-    UNIMPLEMENTED();
+    THROW_NS_IF_FALSE(E_INVALIDARG, object != nil);
+    THROW_NS_IF_FALSE(E_BOUNDS, idx < [self count]);
+
+    NSUInteger existing = [self _positionOfObject:object];
+    if ((existing != NSNotFound) && (existing != idx)) {
+        return;
+    }
+
+    _index.erase([_arrayContainer objectAtIndex:idx]);
+    [_arrayContainer replaceObjectAtIndex:idx withObject:object];
+    _index[object] = idx;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)replaceObjectsAtIndexes:(NSIndexSet*)indexes withObjects:(NSArray*)objects {
-    UNIMPLEMENTED();
+    THROW_NS_IF_FALSE(E_INVALIDARG, [objects count] == [indexes count]);
+
+    __block NSUInteger objectIndex = 0;
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL* stop) {
+        [self replaceObjectAtIndex:idx withObject:[objects objectAtIndex:objectIndex++]];
+    }];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)replaceObjectsInRange:(NSRange)range withObjects:(id _Nonnull const[])objects count:(NSUInteger)count {
-    UNIMPLEMENTED();
+    THROW_NS_IF_FALSE(E_BOUNDS, NSMaxRange(range) <= [self count]);
+
+    [self removeObjectsInRange:range];
+
+    NSUInteger idx = range.location;
+    for (NSUInteger i = 0; i < count; ++i) {
+        if (![self containsObject:objects[i]]) {
+            [self insertObject:objects[i] atIndex:idx++];
+        }
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)setObject:(id)obj atIndex:(NSUInteger)idx {
-    UNIMPLEMENTED();
+    if (idx == [self count]) {
+        [self addObject:obj];
+    } else {
+        [self replaceObjectAtIndex:idx withObject:obj];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes idx is an index into the set after the objects at indexes have been removed.
 */
 - (void)moveObjectsAtIndexes:(NSIndexSet*)indexes toIndex:(NSUInteger)idx {
-    UNIMPLEMENTED();
+    if ([indexes count] == 0) {
+        return;
+    }
+
+    // The moved objects stay in the set, so their entries in the index only need their positions fixed up.
+    NSArray* objects = [_arrayContainer objectsAtIndexes:indexes];
+    [_arrayContainer removeObjectsAtIndexes:indexes];
+    THROW_NS_IF_FALSE(E_BOUNDS, idx <= [_arrayContainer count]);
+    [_arrayContainer insertObjects:objects atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(idx, [objects count])]];
+    [self _invalidateIndexesFrom:std::min(idx, [indexes firstIndex])];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)exchangeObjectAtIndex:(NSUInteger)idx1 withObjectAtIndex:(NSUInteger)idx2 {
-    UNIMPLEMENTED();
+    [_arrayContainer exchangeObjectAtIndex:idx1 withObjectAtIndex:idx2];
+    _index[[_arrayContainer objectAtIndex:idx1]] = idx1;
+    _index[[_arrayContainer objectAtIndex:idx2]] = idx2;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)filterUsingPredicate:(NSPredicate*)predicate {
-    UNIMPLEMENTED();
+    [self removeObjectsAtIndexes:[_arrayContainer indexesOfObjectsPassingTest:^BOOL(id object, NSUInteger idx, BOOL* stop) {
+                  return ![predicate evaluateWithObject:object];
+              }]];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)sortUsingDescriptors:(NSArray*)sortDescriptors {
-    UNIMPLEMENTED();
+    [_arrayContainer sortUsingDescriptors:sortDescriptors];
+    [self _invalidateIndexesFrom:0];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)sortUsingComparator:(NSComparator)cmptr {
-    UNIMPLEMENTED();
+    [_arrayContainer sortUsingComparator:cmptr];
+    [self _invalidateIndexesFrom:0];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)sortWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr {
-    UNIMPLEMENTED();
+    [_arrayContainer sortWithOptions:opts usingComparator:cmptr];
+    [self _invalidateIndexesFrom:0];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)sortRange:(NSRange)range options:(NSSortOptions)opts usingComparator:(NSComparator)cmptr {
-    UNIMPLEMENTED();
+    THROW_NS_IF_FALSE(E_BOUNDS, NSMaxRange(range) <= [self count]);
+
+    NSArray* sorted = [[_arrayContainer subarrayWithRange:range] sortedArrayWithOptions:opts usingComparator:cmptr];
+    [_arrayContainer replaceObjectsInRange:range withObjectsFromArray:sorted];
+    [self _invalidateIndexesFrom:range.location];
+}
+
+// Removes, in one pass over the array, the elements for which contains returns NO.
+- (void)_retainObjectsPassingTest:(BOOL (^)(id))contains {
+    [self removeObjectsAtIndexes:[_arrayContainer indexesOfObjectsPassingTest:^BOOL(id object, NSUInteger idx, BOOL* stop) {
+                  return !contains(object);
+              }]];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)intersectOrderedSet:(NSOrderedSet*)other {
-    UNIMPLEMENTED();
+    [self _retainObjectsPassingTest:^BOOL(id object) {
+        return [other containsObject:object];
+    }];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)intersectSet:(NSSet*)other {
-    UNIMPLEMENTED();
+    [self _retainObjectsPassingTest:^BOOL(id object) {
+        return [other containsObject:object];
+    }];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)minusOrderedSet:(NSOrderedSet*)other {
-    UNIMPLEMENTED();
+    [self _removeObjectsIn:other];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)minusSet:(NSSet*)other {
-    UNIMPLEMENTED();
+    [self _removeObjectsIn:other];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)unionOrderedSet:(NSOrderedSet*)other {
-    UNIMPLEMENTED();
+    for (id object in other) {
+        [self addObject:object];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)unionSet:(NSSet*)other {
-    UNIMPLEMENTED();
+    for (id object in other) {
+        [self addObject:object];
+    }
 }
 
 /**
@@ -19,6 +19,13 @@
 #import <Foundation/NSNotificationCenter.h>
 #import <LoggingNative.h>
 
+#import <algorithm>
+#import <atomic>
+#import <iterator>
+#import <memory>
+#import <mutex>
+#import <unordered_map>
+#import <unordered_set>
 #import <vector>
 
 static const wchar_t* TAG = L"NSNotificationCenter";
@@ -41,7 +48,8 @@ static const wchar_t* TAG = L"NSNotificationCenter";
 }
 
 - (void)invokeWithNotification:(NSNotification*)note {
-    if (_queue) {
+    // Waiting on the queue we are already running on would never finish.
+    if (_queue && [NSOperationQueue currentQueue] != _queue) {
         // Through observation, it was determined that the reference platform will block
         // until the notification is fired.
         [_queue addOperations:@[ [NSBlockOperation blockOperationWithBlock:^{
@@ -66,12 +74,20 @@ static const wchar_t* TAG = L"NSNotificationCenter";
     NSObject* sender;
 
     NSString* name;
+
+    // Registration order, used to deliver a notification in the order its observers were added.
+    uint64_t sequence;
+
+    // Set once the receiver is removed, so that posts still holding an older snapshot skip it.
+    std::atomic<bool> removed;
 }
 @end
 
 @implementation _NSNotificationReceiver
 - (void)postNotification:(NSNotification*)note {
-    [observer performSelector:selector withObject:note];
+    if (!removed.load(std::memory_order_acquire)) {
+        [observer performSelector:selector withObject:note];
+    }
 }
 
 - (void)dealloc {
@@ -84,12 +100,55 @@ static const wchar_t* TAG = L"NSNotificationCenter";
 }
 @end
 
+namespace {
+struct _NSNotificationNameHash {
+    size_t operator()(const StrongId<NSString>& name) const {
+        return [name hash];
+    }
+};
+
+struct _NSNotificationNameEqual {
+    bool operator()(const StrongId<NSString>& left, const StrongId<NSString>& right) const {
+        return [left isEqualToString:right];
+    }
+};
+
+// The receivers for one name and sender, in registration order. Never modified once published.
+typedef std::vector<StrongId<_NSNotificationReceiver>> _NSNotificationReceiverList;
+typedef std::shared_ptr<const _NSNotificationReceiverList> _NSNotificationReceiverSnapshot;
+
+// Receivers for one name by sender; nil holds the receivers for any sender. Never modified once published.
+typedef std::unordered_map<id, _NSNotificationReceiverSnapshot> _NSNotificationSenderTable;
+
+// Everything registered for one name. senders is swapped atomically: a change to the name publishes a new table that
+// shares the lists of every sender it did not touch, and a post loads whichever table is current.
+struct _NSNotificationNameEntry {
+    std::shared_ptr<const _NSNotificationSenderTable> senders;
+};
+
+typedef std::unordered_map<StrongId<NSString>, std::shared_ptr<_NSNotificationNameEntry>, _NSNotificationNameHash, _NSNotificationNameEqual>
+    _NSNotificationNameTable;
+
+// Returns the receivers registered for name and sender in table, if any.
+const _NSNotificationReceiverList* _receiverListFor(const _NSNotificationSenderTable& table, id sender) {
+    auto found = table.find(sender);
+    return (found == table.end()) ? nullptr : found->second.get();
+}
+}
+
 @interface NSNotificationCenter () {
-    // Dictionary for quick lookups on post
-    StrongId<NSMutableDictionary<NSString*, NSMutableSet<_NSNotificationReceiver*>*>> _observers;
+    // Serializes changes to the tables below. Posting does not take it.
+    std::mutex _lock;
+
+    // The entry for every name that has ever been observed. Notification names are few and long-lived, so this is
+    // copy-on-write: it is only copied when a name is observed for the first time, and a name keeps its entry once it has
+    // one. Adding and removing observers of a known name only swaps that name's sender table.
+    std::shared_ptr<const _NSNotificationNameTable> _names;
+
+    // Every registration of each observer, so removeObserver: only visits that observer's registrations.
+    std::unordered_map<id, std::vector<StrongId<_NSNotificationReceiver>>> _registrationsByObserver;
 
-    // All known receivers
-    StrongId<NSMutableSet<_NSNotificationReceiver*>> _allReceivers;
+    uint64_t _nextSequence;
 }
 @end
 
@@ -107,84 +166,117 @@ static const wchar_t* TAG = L"NSNotificationCenter";
 */
 - (instancetype)init {
     if (self = [super init]) {
-        _observers.attach([[NSMutableDictionary alloc] init]);
-        _allReceivers.attach([[NSMutableSet alloc] init]);
+        _names = std::make_shared<const _NSNotificationNameTable>();
     }
     return self;
 }
 
 // INVARIANT: Called under lock.
-- (NSMutableSet<_NSNotificationReceiver*>*)_receiverSetForNotificationName:(NSString*)notification createIfMissing:(BOOL)create {
-    NSMutableSet<_NSNotificationReceiver*>* receiverSet = [_observers objectForKey:notification];
-    if (receiverSet || !create) {
-        return receiverSet;
+// Returns the entry for name, adding one if it has none.
+- (_NSNotificationNameEntry*)_entryForName:(NSString*)name {
+    StrongId<NSString> key = name;
+    auto found = _names->find(key);
+    if (found != _names->end()) {
+        return found->second.get();
     }
 
-    receiverSet = [NSMutableSet set];
-    [_observers setObject:receiverSet forKey:notification];
-    return receiverSet;
-}
-
-// INVARIANT: Called under lock.
-- (NSSet<_NSNotificationReceiver*>*)_receiversForName:(NSString*)name observer:(id)observer object:(id)object {
-    NSSet<_NSNotificationReceiver*>* searchSet = _allReceivers;
-    if (name) {
-        searchSet = [self _receiverSetForNotificationName:name createIfMissing:NO];
-        if (!searchSet) {
-            return nil;
-        }
-    }
+    auto entry = std::make_shared<_NSNotificationNameEntry>();
+    entry->senders = std::make_shared<const _NSNotificationSenderTable>();
 
-    __block id blockObserver = observer;
-    __block NSString* blockName = name;
-    __block id blockObject = object;
-    return [searchSet objectsPassingTest:^BOOL(_NSNotificationReceiver* receiver, BOOL* stop) {
-        return (blockObserver == nil || receiver->observer == blockObserver) && (blockObject == nil || receiver->sender == blockObject) &&
-               (blockName == nil || [receiver->name isEqual:blockName]);
-    }];
+    auto names = std::make_shared<_NSNotificationNameTable>(*_names);
+    names->emplace(key, entry);
+    std::atomic_store(&_names, std::shared_ptr<const _NSNotificationNameTable>(std::move(names)));
+    return entry.get();
 }
 
 // INVARIANT: Called under lock.
 - (void)_addReceiver:(_NSNotificationReceiver*)receiver {
-    StrongId<NSMutableSet<_NSNotificationReceiver*>> receivers = [self _receiverSetForNotificationName:receiver->name createIfMissing:YES];
-    [receivers addObject:receiver];
-    [_allReceivers addObject:receiver];
+    receiver->sequence = _nextSequence++;
+    _registrationsByObserver[receiver->observer].emplace_back(receiver);
+
+    _NSNotificationNameEntry* entry = [self _entryForName:receiver->name];
+    auto senders = std::make_shared<_NSNotificationSenderTable>(*entry->senders);
+
+    auto receivers = std::make_shared<_NSNotificationReceiverList>();
+    if (const _NSNotificationReceiverList* existing = _receiverListFor(*senders, receiver->sender)) {
+        receivers->reserve(existing->size() + 1);
+        *receivers = *existing;
+    }
+    receivers->emplace_back(receiver);
+    (*senders)[receiver->sender] = std::move(receivers);
+
+    std::atomic_store(&entry->senders, std::shared_ptr<const _NSNotificationSenderTable>(std::move(senders)));
 }
 
 // INVARIANT: Called under lock.
-- (void)_removeReceivers:(NSSet<_NSNotificationReceiver*>*)receivers forName:(NSString*)name {
-    if ([receivers count] == 0) {
-        return;
+// Unregisters the receivers that match observer (nil for any), name (nil for any) and object (nil for any), appending them
+// to removed. The caller must hold removed until the lock is released: releasing a receiver can deallocate an observer
+// that calls back into this center.
+- (void)_removeReceiversForObserver:(id)observer
+                               name:(NSString*)name
+                             object:(id)object
+                            removed:(std::vector<StrongId<_NSNotificationReceiver>>&)removed {
+    auto matches = [name, object](_NSNotificationReceiver* receiver) {
+        return (object == nil || receiver->sender == object) && (name == nil || [receiver->name isEqualToString:name]);
+    };
+
+    // Pull the matching registrations out of the reverse index: just the observer's when there is one, or every observer's.
+    auto removeFromObserver = [&](std::unordered_map<id, std::vector<StrongId<_NSNotificationReceiver>>>::iterator entry) {
+        std::vector<StrongId<_NSNotificationReceiver>>& registrations = entry->second;
+        auto kept = std::stable_partition(registrations.begin(), registrations.end(), [&matches](_NSNotificationReceiver* receiver) {
+            return !matches(receiver);
+        });
+        std::move(kept, registrations.end(), std::back_inserter(removed));
+        registrations.erase(kept, registrations.end());
+        return registrations.empty() ? _registrationsByObserver.erase(entry) : std::next(entry);
+    };
+
+    size_t firstRemoved = removed.size();
+    if (observer) {
+        auto entry = _registrationsByObserver.find(observer);
+        if (entry != _registrationsByObserver.end()) {
+            removeFromObserver(entry);
+        }
+    } else {
+        for (auto entry = _registrationsByObserver.begin(); entry != _registrationsByObserver.end();) {
+            entry = removeFromObserver(entry);
+        }
     }
 
-    // Update the global receiver table ...
-    [_allReceivers minusSet:receivers];
+    // Rebuild only the names and lists that lost a receiver, each once.
+    std::unordered_set<_NSNotificationReceiver*> removedSet;
+    std::unordered_map<_NSNotificationNameEntry*, std::unordered_set<id>> touched;
+    for (size_t i = firstRemoved; i < removed.size(); ++i) {
+        _NSNotificationReceiver* receiver = removed[i];
+        receiver->removed.store(true, std::memory_order_release);
+        removedSet.insert(receiver);
+        touched[[self _entryForName:receiver->name]].insert(receiver->sender);
+    }
 
-    // ... and the name lookup tables.
-    if (name) {
-        // Fast path: remove these observers from the provided name's table.
-        StrongId<NSMutableSet<_NSNotificationReceiver*>> nameReceivers = [self _receiverSetForNotificationName:name createIfMissing:NO];
-        if (!nameReceivers) {
-            return;
-        }
+    for (const auto& touchedName : touched) {
+        _NSNotificationNameEntry* entry = touchedName.first;
+        auto senders = std::make_shared<_NSNotificationSenderTable>(*entry->senders);
+        for (id sender : touchedName.second) {
+            const _NSNotificationReceiverList* existing = _receiverListFor(*senders, sender);
+            if (!existing) {
+                continue;
+            }
 
-        [nameReceivers minusSet:receivers];
+            auto receivers = std::make_shared<_NSNotificationReceiverList>();
+            for (const StrongId<_NSNotificationReceiver>& receiver : *existing) {
+                if (removedSet.find(receiver) == removedSet.end()) {
+                    receivers->emplace_back(receiver);
+                }
+            }
 
-        if ([nameReceivers count] == 0) {
-            // This can release nameReceivers; it will be retained for the scope of this method.
-            [_observers removeObjectForKey:name];
-        }
-    } else {
-        // Slow path: remove these observers from every name table.
-        NSArray<NSString*>* copiedAllKeys = [[_observers allKeys] copy];
-        for (NSString* key in copiedAllKeys) {
-            StrongId<NSMutableSet<_NSNotificationReceiver*>> nameReceivers = [_observers objectForKey:key];
-            [nameReceivers minusSet:receivers];
-            if ([nameReceivers count] == 0) {
-                [_observers removeObjectForKey:key];
+            if (receivers->empty()) {
+                senders->erase(sender);
+            } else {
+                (*senders)[sender] = std::move(receivers);
             }
         }
-        [copiedAllKeys release];
+
+        std::atomic_store(&entry->senders, std::shared_ptr<const _NSNotificationSenderTable>(std::move(senders)));
     }
 }
 
@@ -214,36 +306,40 @@ static const wchar_t* TAG = L"NSNotificationCenter";
         return;
     }
 
-    NSString* name = [notification name];
+    std::shared_ptr<const _NSNotificationNameTable> names = std::atomic_load(&_names);
+    auto foundName = names->find(StrongId<NSString>([notification name]));
+    if (foundName == names->end()) {
+        return;
+    }
+
+    // The sender table, and every receiver list in it, stays alive and unchanged for as long as this post holds it.
+    // Receivers are free to add or remove observers while it is delivered; those changes apply to later posts.
+    std::shared_ptr<const _NSNotificationSenderTable> senderTable = std::atomic_load(&foundName->second->senders);
 
-    // This method does not use _receiversForName:(...) above as it treats a nil _notification_ sender as a wildcard.
-    // We want to treat a nil _receiver_ sender as a wildcard.
+    // A nil _notification_ sender is not a wildcard; only a nil _receiver_ sender is.
     // We'd like to avoid using autoreleased objects here: since a notification can be dispatched against a deallocating
     // object, tight control over its lifetime is required.
-    std::vector<StrongId<_NSNotificationReceiver>> validReceivers{ 0 };
-    @synchronized(self) {
-        NSMutableSet<_NSNotificationReceiver*>* receivers = [self _receiverSetForNotificationName:name createIfMissing:NO];
-        if (!receivers) {
-            return;
-        }
-
-        @autoreleasepool { // If the NSNotification subclass's object getter autoreleases object, catch it in this pool.
-            NSObject* sender = [notification object];
-            validReceivers.reserve([receivers count]);
-            for (_NSNotificationReceiver* receiver in receivers) {
-                if (receiver->sender == nil || receiver->sender == sender) {
-                    validReceivers.emplace_back(receiver);
-                }
-            }
-        }
+    NSObject* sender;
+    @autoreleasepool { // If the NSNotification subclass's object getter autoreleases object, catch it in this pool.
+        sender = [notification object];
     }
 
-    // Notification post happens outside of the lock over self; receivers are allowed to
-    // manipulate the notification center's state.
-
-    // Receivers are retained for the duration of this notification post.
-    for (auto& receiver : validReceivers) {
-        [receiver postNotification:notification];
+    const _NSNotificationSenderTable& senders = *senderTable;
+    const _NSNotificationReceiverList* anySender = _receiverListFor(senders, nil);
+    const _NSNotificationReceiverList* thisSender = sender ? _receiverListFor(senders, sender) : nullptr;
+
+    // Deliver to both lists in registration order.
+    static const _NSNotificationReceiverList s_empty;
+    const _NSNotificationReceiverList& first = anySender ? *anySender : s_empty;
+    const _NSNotificationReceiverList& second = thisSender ? *thisSender : s_empty;
+    auto left = first.begin();
+    auto right = second.begin();
+    while (left != first.end() || right != second.end()) {
+        if (right == second.end() || (left != first.end() && (*left)->sequence < (*right)->sequence)) {
+            [*left++ postNotification:notification];
+        } else {
+            [*right++ postNotification:notification];
+        }
     }
 }
 
@@ -263,7 +359,8 @@ static const wchar_t* TAG = L"NSNotificationCenter";
     newReceiver->sender = object;
     newReceiver->name = [name copy]; // Contractually released by _NSNotificationReceiver.
 
-    @synchronized(self) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
         [self _addReceiver:newReceiver];
     }
 
@@ -302,9 +399,11 @@ static const wchar_t* TAG = L"NSNotificationCenter";
  @Status Interoperable
 */
 - (void)removeObserver:(id)observer name:(NSString*)name object:(id)object {
-    @synchronized(self) {
-        NSSet<_NSNotificationReceiver*>* receiversToRemove = [self _receiversForName:name observer:observer object:object];
-        [self _removeReceivers:receiversToRemove forName:name];
+    // Removed receivers may own their observers; they are released after the lock.
+    std::vector<StrongId<_NSNotificationReceiver>> removed;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        [self _removeReceiversForObserver:observer name:name object:object removed:removed];
     }
 }
 
@@ -312,9 +411,6 @@ static const wchar_t* TAG = L"NSNotificationCenter";
  @Status Interoperable
 */
 - (void)removeObserver:(id)observer {
-    @synchronized(self) {
-        NSSet<_NSNotificationReceiver*>* receiversToRemove = [self _receiversForName:nil observer:observer object:nil];
-        [self _removeReceivers:receiversToRemove forName:nil];
-    }
+    [self removeObserver:observer name:nil object:nil];
 }
 @end
@@ -14,56 +14,276 @@
 //
 //******************************************************************************
 
-#include "Starboard.h"
-#include "StubReturn.h"
-#include "Foundation/NSNotificationQueue.h"
+#import "Starboard.h"
+#import <Foundation/NSArray.h>
+#import <Foundation/NSException.h>
+#import <Foundation/NSNotification.h>
+#import <Foundation/NSNotificationCenter.h>
+#import <Foundation/NSNotificationQueue.h>
+#import <Foundation/NSRunLoop.h>
+#import <Foundation/NSString.h>
+#import "NSNotificationQueue+Internal.h"
+
+#import <map>
+#import <mutex>
+#import <unordered_map>
+#import <unordered_set>
+#import <vector>
+
+namespace {
+struct _NSNotificationQueueNameHash {
+    size_t operator()(const StrongId<NSString>& name) const {
+        return [name hash];
+    }
+};
+
+struct _NSNotificationQueueNameEqual {
+    bool operator()(const StrongId<NSString>& left, const StrongId<NSString>& right) const {
+        return [left isEqualToString:right];
+    }
+};
+
+struct _NSQueuedNotification {
+    StrongId<NSNotification> notification;
+    StrongId<NSString> name;
+    id sender;
+    // nil when queued for the default mode only.
+    StrongId<NSArray<NSString*>> modes;
+    NSPostingStyle postingStyle;
+};
+
+// Queued notifications by the order they were enqueued in.
+typedef std::map<uint64_t, _NSQueuedNotification> _NSQueuedNotifications;
+
+bool _isQueuedForMode(const _NSQueuedNotification& queued, NSString* mode) {
+    if (!queued.modes) {
+        return [mode isEqualToString:NSDefaultRunLoopMode];
+    }
+
+    return [queued.modes containsObject:mode] ||
+           ([queued.modes containsObject:NSRunLoopCommonModes] && [mode isEqualToString:NSDefaultRunLoopMode]);
+}
+}
+
+@interface NSNotificationQueue () {
+    StrongId<NSNotificationCenter> _center;
+
+    std::mutex _lock;
+    uint64_t _nextSequence;
+    _NSQueuedNotifications _asap;
+    _NSQueuedNotifications _idle;
+
+    // Sequence numbers of queued notifications by name and by sender, so that coalescing never walks the queue.
+    std::unordered_map<StrongId<NSString>, std::unordered_set<uint64_t>, _NSNotificationQueueNameHash, _NSNotificationQueueNameEqual>
+        _byName;
+    std::unordered_map<id, std::unordered_set<uint64_t>> _bySender;
+}
+@end
 
 @implementation NSNotificationQueue
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Each thread has its own default queue, posting to the default notification center from that thread's run loop.
 */
 + (instancetype)defaultQueue {
-    // TODO: Intentionally commented out for now to prevent flooded debug spew from NSRunLoop's usage.
-    // UNIMPLEMENTED();
-    return StubReturn();
+    thread_local static StrongId<NSNotificationQueue> tls_defaultQueue;
+    if (!tls_defaultQueue) {
+        tls_defaultQueue.attach([[NSNotificationQueue alloc] initWithNotificationCenter:[NSNotificationCenter defaultCenter]]);
+    }
+    return tls_defaultQueue;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (instancetype)initWithNotificationCenter:(NSNotificationCenter*)notificationCenter {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if (self = [super init]) {
+        _center = notificationCenter;
+    }
+    return self;
+}
+
+// INVARIANT: Called under lock.
+- (void)_unindexSequence:(uint64_t)sequence name:(NSString*)name sender:(id)sender {
+    auto foundName = _byName.find(name);
+    if (foundName != _byName.end()) {
+        foundName->second.erase(sequence);
+        if (foundName->second.empty()) {
+            _byName.erase(foundName);
+        }
+    }
+
+    auto foundSender = _bySender.find(sender);
+    if (foundSender != _bySender.end()) {
+        foundSender->second.erase(sequence);
+        if (foundSender->second.empty()) {
+            _bySender.erase(foundSender);
+        }
+    }
+}
+
+// INVARIANT: Called under lock.
+// Removes the queued notifications that match notification on the attributes in coalesceMask, appending them to removed so
+// that the caller can release them after unlocking.
+- (void)_dequeueNotificationsMatching:(NSNotification*)notification
+                         coalesceMask:(NSUInteger)coalesceMask
+                              removed:(std::vector<_NSQueuedNotification>&)removed {
+    NSString* name = [notification name];
+    id sender = [notification object];
+    bool onName = (coalesceMask & NSNotificationCoalescingOnName) != 0;
+    bool onSender = (coalesceMask & NSNotificationCoalescingOnSender) != 0;
+
+    // Start from whichever index narrows the candidates down most; with no mask, every queued notification matches.
+    std::vector<uint64_t> candidates;
+    const std::unordered_set<uint64_t>* nameMatches = nullptr;
+    const std::unordered_set<uint64_t>* senderMatches = nullptr;
+    if (onName) {
+        auto found = _byName.find(name);
+        if (found == _byName.end()) {
+            return;
+        }
+        nameMatches = &found->second;
+    }
+    if (onSender) {
+        auto found = _bySender.find(sender);
+        if (found == _bySender.end()) {
+            return;
+        }
+        senderMatches = &found->second;
+    }
+
+    if (nameMatches && senderMatches) {
+        const std::unordered_set<uint64_t>& smaller = (nameMatches->size() < senderMatches->size()) ? *nameMatches : *senderMatches;
+        const std::unordered_set<uint64_t>& larger = (&smaller == nameMatches) ? *senderMatches : *nameMatches;
+        for (uint64_t sequence : smaller) {
+            if (larger.find(sequence) != larger.end()) {
+                candidates.push_back(sequence);
+            }
+        }
+    } else if (nameMatches || senderMatches) {
+        const std::unordered_set<uint64_t>& matches = nameMatches ? *nameMatches : *senderMatches;
+        candidates.assign(matches.begin(), matches.end());
+    } else {
+        for (const auto& queued : _asap) {
+            candidates.push_back(queued.first);
+        }
+        for (const auto& queued : _idle) {
+            candidates.push_back(queued.first);
+        }
+    }
+
+    for (uint64_t sequence : candidates) {
+        _NSQueuedNotifications& queue = (_asap.find(sequence) != _asap.end()) ? _asap : _idle;
+        auto found = queue.find(sequence);
+        if (found == queue.end()) {
+            continue;
+        }
+
+        [self _unindexSequence:sequence name:found->second.name sender:found->second.sender];
+        removed.emplace_back(std::move(found->second));
+        queue.erase(found);
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)enqueueNotification:(NSNotification*)notification postingStyle:(NSPostingStyle)postingStyle {
-    UNIMPLEMENTED();
+    [self enqueueNotification:notification
+                 postingStyle:postingStyle
+                 coalesceMask:(NSNotificationCoalescingOnName | NSNotificationCoalescingOnSender)
+                     forModes:nil];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Coalescing removes the matching notifications already in the queue; the new one takes its place at the back.
 */
 - (void)enqueueNotification:(NSNotification*)notification
                postingStyle:(NSPostingStyle)postingStyle
                coalesceMask:(NSNotificationCoalescing)coalesceMask
                    forModes:(NSArray*)modes {
-    UNIMPLEMENTED();
+    if (!notification) {
+        [NSException raise:NSInvalidArgumentException format:@"%hs: Notification cannot be nil", __PRETTY_FUNCTION__];
+        return;
+    }
+
+    std::vector<_NSQueuedNotification> coalesced;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (coalesceMask != NSNotificationNoCoalescing) {
+            [self _dequeueNotificationsMatching:notification coalesceMask:coalesceMask removed:coalesced];
+        }
+
+        if (postingStyle != NSPostNow) {
+            uint64_t sequence = _nextSequence++;
+            _NSQueuedNotification queued;
+            queued.notification = notification;
+            queued.name = [notification name];
+            queued.sender = [notification object];
+            queued.modes.attach([modes copy]);
+            queued.postingStyle = postingStyle;
+
+            _byName[queued.name].insert(sequence);
+            _bySender[queued.sender].insert(sequence);
+            ((postingStyle == NSPostWhenIdle) ? _idle : _asap).emplace(sequence, std::move(queued));
+        }
+    }
+
+    if (postingStyle == NSPostNow) {
+        [_center postNotification:notification];
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)dequeueNotificationsMatching:(NSNotification*)notification coalesceMask:(NSUInteger)coalesceMask {
-    UNIMPLEMENTED();
+    std::vector<_NSQueuedNotification> removed;
+    std::lock_guard<std::mutex> lock(_lock);
+    [self _dequeueNotificationsMatching:notification coalesceMask:coalesceMask removed:removed];
+}
+
+// Posts, in the order they were enqueued, the idle or ASAP notifications queued for mode. Notifications enqueued while these
+// are posted wait for the next pass.
+- (void)_postQueuedNotifications:(bool)idle forMode:(NSString*)mode {
+    std::vector<_NSQueuedNotification> ready;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _NSQueuedNotifications& queue = idle ? _idle : _asap;
+        for (auto queued = queue.begin(); queued != queue.end();) {
+            if (_isQueuedForMode(queued->second, mode)) {
+                [self _unindexSequence:queued->first name:queued->second.name sender:queued->second.sender];
+                ready.emplace_back(std::move(queued->second));
+                queued = queue.erase(queued);
+            } else {
+                ++queued;
+            }
+        }
+    }
+
+    for (const _NSQueuedNotification& queued : ready) {
+        [_center postNotification:queued.notification];
+    }
+}
+
+- (void)asapProcessMode:(NSString*)mode {
+    [self _postQueuedNotifications:false forMode:mode];
+}
+
+- (BOOL)hasIdleNotificationsInMode:(NSString*)mode {
+    std::lock_guard<std::mutex> lock(_lock);
+    for (const auto& queued : _idle) {
+        if (_isQueuedForMode(queued.second, mode)) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (void)idleProcessMode:(NSString*)mode {
+    [self _postQueuedNotifications:true forMode:mode];
 }
 
 @end
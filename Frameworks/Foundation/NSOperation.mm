@@ -41,6 +41,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #import <mutex>
 
 #import "NSOperationInternal.h"
+#import "Instrumentation.h"
 
 static wchar_t TAG[] = L"NSOperation";
 
@@ -66,6 +67,7 @@ static wchar_t TAG[] = L"NSOperation";
 @synthesize finished = _finished;
 @synthesize ready = _ready;
 @synthesize _completionQueue = _completionQueue;
+@synthesize _enqueueTimestamp = _enqueueTimestamp;
 
 static const NSString* NSOperationContext = @"context";
 
@@ -388,7 +390,12 @@ static const NSString* NSOperationContext = @"context";
 }
 
 - (BOOL)_markInQueue {
-    return !_inQueue.fetch_or(YES); // only returns true for the first caller
+    if (_inQueue.fetch_or(YES)) {
+        return NO; // only returns true for the first caller
+    }
+
+    _enqueueTimestamp = INSTRUMENT_TIMESTAMP();
+    return YES;
 }
 
 @end
@@ -18,5 +18,7 @@
 
 @interface NSOperation ()
 @property (nonatomic, assign, getter=_completionQueue, setter=_setCompletionQueue:) dispatch_queue_t _completionQueue;
+// When the operation was added to a queue, or 0 if instrumentation was not recording then.
+@property (nonatomic, readonly, getter=_enqueueTimestamp) int64_t _enqueueTimestamp;
 - (BOOL)_markInQueue;
 @end
\ No newline at end of file
@@ -20,6 +20,7 @@
 #import <Foundation/NSCondition.h>
 
 #import "NSOperationInternal.h"
+#import "Instrumentation.h"
 #import "Starboard.h"
 
 #import <atomic>
@@ -186,7 +187,11 @@ static char _NSOperationQueue_IsReadyContext;
         } // _concurrentOperationCountLock scope
 
         std::lock_guard<std::recursive_mutex> lock(_dispatchQueueLock);
+        int64_t dispatchTimestamp = INSTRUMENT_TIMESTAMP();
         dispatch_async(_dispatchQueue, ^{
+            INSTRUMENT_SPAN_SINCE("Foundation", "NSOperationQueue.dispatchLatency", dispatchTimestamp);
+            INSTRUMENT_SPAN_SINCE("Foundation", "NSOperationQueue.wait", operation._enqueueTimestamp);
+
             // Check if currentQueue needs to be changed
             StrongId<NSOperationQueue*>& currentQueue = _getCurrentQueue();
             StrongId<NSOperationQueue*> prevCurrentQueue(currentQueue.get());
@@ -210,6 +215,7 @@ static char _NSOperationQueue_IsReadyContext;
             });
 
             // Run the actual operation
+            INSTRUMENT_SPAN("Foundation", "NSOperationQueue.run");
             [operation start];
         });
     }
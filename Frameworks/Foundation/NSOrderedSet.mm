@@ -15,10 +15,17 @@
 //******************************************************************************
 
 #import <Foundation/NSException.h>
+#import <Foundation/NSIndexSet.h>
+#import <Foundation/NSKeyedArchiver.h>
+#import <Foundation/NSMutableSet.h>
 #import <NSOrderedSetInternal.h>
 #import <Starboard.h>
 #import <StubReturn.h>
 #import <VAListHelper.h>
+#import "NSKeyedArchiverInternal.h"
+
+#import <algorithm>
+#import <vector>
 
 // Needed to make sure that the returned array behaves like a one way proxy to an array
 @implementation _NSProxyOrderedSetArray
@@ -146,6 +153,7 @@
     THROW_NS_IF_FALSE(E_BOUNDS, NSMaxRange(range) <= [array count]);
 
     if (self = [self init]) {
+        _index.reserve(range.length);
         NSUInteger start = range.location;
         NSUInteger end = NSMaxRange(range);
 
@@ -164,13 +172,55 @@
     return self;
 }
 
+// Appends object unless an equal object is already in the set.
 - (void)_insertObject:(id)object {
-    if ([self containsObject:object]) {
+    NSUInteger position = [_arrayContainer count];
+    if (!_index.emplace(object, position).second) {
         return;
     }
 
     [_arrayContainer addObject:object];
-    [_setContainer addObject:object];
+    if (_validIndexCount == position) {
+        _validIndexCount = position + 1;
+    }
+}
+
+- (void)_invalidateIndexesFrom:(NSUInteger)index {
+    _validIndexCount = std::min(_validIndexCount, index);
+}
+
+// Recomputes the positions at and above _validIndexCount in one pass.
+- (void)_updateIndexes {
+    NSUInteger count = [_arrayContainer count];
+    if (_validIndexCount >= count) {
+        return;
+    }
+
+    std::vector<id> objects(count - _validIndexCount);
+    [_arrayContainer getObjects:objects.data() range:NSMakeRange(_validIndexCount, objects.size())];
+    for (NSUInteger i = 0; i < objects.size(); ++i) {
+        _index[objects[i]] = _validIndexCount + i;
+    }
+
+    _validIndexCount = count;
+}
+
+// Returns the position of the element equal to object, or NSNotFound.
+- (NSUInteger)_positionOfObject:(id)object {
+    if (object == nil) {
+        return NSNotFound;
+    }
+
+    auto found = _index.find(object);
+    if (found == _index.end()) {
+        return NSNotFound;
+    }
+
+    if (found->second >= _validIndexCount) {
+        [self _updateIndexes];
+    }
+
+    return found->second;
 }
 
 /**
@@ -192,7 +242,7 @@
  @Notes returned set does not reflect future changes.
 */
 - (NSSet*)set {
-    return [[_setContainer copy] autorelease];
+    return [NSSet setWithArray:_arrayContainer];
 }
 
 /**
@@ -273,9 +323,17 @@
         return [self init];
     }
 
-    if (self = [super init]) {
-        _setContainer.attach([[NSMutableSet alloc] initWithSet:set copyItems:flag]);
-        _arrayContainer.attach([[NSMutableArray alloc] initWithArray:[set allObjects] copyItems:flag]);
+    if (self = [self init]) {
+        _index.reserve([set count]);
+        for (id object in set) {
+            if (flag) {
+                object = [object copy];
+                [self _insertObject:object];
+                [object release];
+            } else {
+                [self _insertObject:object];
+            }
+        }
     }
 
     return self;
@@ -286,8 +344,8 @@
 */
 - (instancetype)init {
     if (self = [super init]) {
-        _setContainer = [NSMutableSet new];
-        _arrayContainer = [NSMutableArray new];
+        _arrayContainer.attach([NSMutableArray new]);
+        _validIndexCount = 0;
     }
 
     return self;
@@ -300,17 +358,16 @@
     if (object == nil) {
         return NO;
     }
-    return [_setContainer containsObject:object];
+    return _index.find(object) != _index.end();
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)enumerateObjectsAtIndexes:(NSIndexSet*)indexSet
                           options:(NSEnumerationOptions)opts
                        usingBlock:(void (^)(id, NSUInteger, BOOL*))block {
-    UNIMPLEMENTED();
+    [_arrayContainer enumerateObjectsAtIndexes:indexSet options:opts usingBlock:block];
 }
 
 /**
@@ -366,7 +423,7 @@
  @Status Interoperable
 */
 - (NSUInteger)indexOfObject:(id)object {
-    return [_arrayContainer indexOfObject:object];
+    return [self _positionOfObject:object];
 }
 
 /**
@@ -396,23 +453,19 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSUInteger)indexOfObjectWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id, NSUInteger, BOOL*))predicate {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [_arrayContainer indexOfObjectWithOptions:opts passingTest:predicate];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSIndexSet*)indexesOfObjectsAtIndexes:(NSIndexSet*)indexSet
                                  options:(NSEnumerationOptions)opts
                              passingTest:(BOOL (^)(id, NSUInteger, BOOL*))predicate {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [_arrayContainer indexesOfObjectsAtIndexes:indexSet options:opts passingTest:predicate];
 }
 
 /**
@@ -423,12 +476,10 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSIndexSet*)indexesOfObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id, NSUInteger, BOOL*))predicate {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [_arrayContainer indexesOfObjectsWithOptions:opts passingTest:predicate];
 }
 
 /**
@@ -445,6 +496,13 @@
     return [_arrayContainer reverseObjectEnumerator];
 }
 
+/**
+ @Status Interoperable
+*/
+- (NSOrderedSet*)reversedOrderedSet {
+    return [NSOrderedSet orderedSetWithArray:[[_arrayContainer reverseObjectEnumerator] allObjects]];
+}
+
 /**
  @Status Interoperable
 */
@@ -453,20 +511,17 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)setValue:(id)value forKey:(NSString*)key {
-    UNIMPLEMENTED();
+    [_arrayContainer setValue:value forKey:key];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (id)valueForKey:(NSString*)key {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [NSOrderedSet orderedSetWithArray:[_arrayContainer valueForKey:key]];
 }
 
 /**
@@ -500,32 +555,82 @@
     return [[other array] isEqualToArray:_arrayContainer];
 }
 
+/**
+ @Status Interoperable
+*/
+- (BOOL)isEqual:(id)other {
+    if (self == other) {
+        return YES;
+    }
+
+    if (![other isKindOfClass:[NSOrderedSet class]]) {
+        return NO;
+    }
+
+    return [self isEqualToOrderedSet:static_cast<NSOrderedSet*>(other)];
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSUInteger)hash {
+    return [self count];
+}
+
 /**
  @Status Interoperable
 */
 - (BOOL)intersectsOrderedSet:(NSOrderedSet*)other {
-    return [self intersectsSet:[other set]];
+    for (id object in other) {
+        if ([self containsObject:object]) {
+            return YES;
+        }
+    }
+    return NO;
 }
 
 /**
  @Status Interoperable
 */
 - (BOOL)intersectsSet:(NSSet*)set {
-    return [_setContainer intersectsSet:set];
+    for (id object in set) {
+        if ([self containsObject:object]) {
+            return YES;
+        }
+    }
+    return NO;
 }
 
 /**
  @Status Interoperable
 */
 - (BOOL)isSubsetOfOrderedSet:(NSOrderedSet*)other {
-    return [self isSubsetOfSet:[other set]];
+    if ([self count] > [other count]) {
+        return NO;
+    }
+
+    for (id object in _arrayContainer.get()) {
+        if (![other containsObject:object]) {
+            return NO;
+        }
+    }
+    return YES;
 }
 
 /**
  @Status Interoperable
 */
 - (BOOL)isSubsetOfSet:(NSSet*)set {
-    return [_setContainer isSubsetOfSet:set];
+    if ([self count] > [set count]) {
+        return NO;
+    }
+
+    for (id object in _arrayContainer.get()) {
+        if (![set containsObject:object]) {
+            return NO;
+        }
+    }
+    return YES;
 }
 
 /**
@@ -543,39 +648,38 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSArray*)sortedArrayWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [_arrayContainer sortedArrayWithOptions:opts usingComparator:cmptr];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSOrderedSet*)filteredOrderedSetUsingPredicate:(NSPredicate*)predicate {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [NSOrderedSet orderedSetWithArray:[_arrayContainer filteredArrayUsingPredicate:predicate]];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+*/
+- (NSString*)description {
+    return [self descriptionWithLocale:nil indent:0];
+}
+
+/**
+ @Status Interoperable
 */
 - (NSString*)descriptionWithLocale:(id)locale {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [self descriptionWithLocale:locale indent:0];
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (NSString*)descriptionWithLocale:(id)locale indent:(NSUInteger)level {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return [_arrayContainer descriptionWithLocale:locale indent:level];
 }
 
 /**
@@ -600,29 +704,36 @@
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 + (BOOL)supportsSecureCoding {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return YES;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Only supports NSKeyedUnarchiver NSCoder type.
 */
 - (id)initWithCoder:(NSCoder*)decoder {
-    UNIMPLEMENTED();
-    return StubReturn();
+    if ([decoder isKindOfClass:[NSKeyedUnarchiver class]]) {
+        return [self initWithArray:[decoder decodeObjectForKey:@"NS.objects"]];
+    } else {
+        UNIMPLEMENTED_WITH_MSG("initWithCoder only supports NSKeyedUnarchiver coder type!");
+        [self release];
+        return nil;
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Caveat
+ @Notes Only supports NSKeyedArchiver NSCoder type.
 */
 - (void)encodeWithCoder:(NSCoder*)coder {
-    UNIMPLEMENTED();
+    if ([coder isKindOfClass:[NSKeyedArchiver class]]) {
+        [static_cast<NSKeyedArchiver*>(coder) _encodeArrayOfObjects:_arrayContainer forKey:@"NS.objects"];
+    } else {
+        UNIMPLEMENTED();
+    }
 }
 
 @end
\ No newline at end of file
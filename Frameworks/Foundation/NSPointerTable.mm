@@ -0,0 +1,450 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <NSPointerFunctionsConcrete.h>
+#import <NSPointerTable.h>
+#import <Starboard.h>
+
+#import <objc/objc-arc.h>
+
+static const NSUInteger c_minimumCapacity = 8;
+
+// Spreads a hash over all of its bits (the murmur3 finalizer), since the table is indexed by the low bits only and the default
+// pointer hashes leave those clear.
+static inline NSUInteger _mixHash(uintptr_t hash) {
+    uint32_t mixed = static_cast<uint32_t>(hash ^ (static_cast<uint64_t>(hash) >> 32));
+    mixed ^= mixed >> 16;
+    mixed *= 0x85ebca6b;
+    mixed ^= mixed >> 13;
+    mixed *= 0xc2b2ae35;
+    mixed ^= mixed >> 16;
+    return mixed;
+}
+
+static NSUInteger _capacityFor(NSUInteger count) {
+    // Keep the load factor at or below one half after a resize.
+    NSUInteger capacity = c_minimumCapacity;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+_NSPointerTable::_Operation::_Operation(_NSPointerTable& table) : _table(table) {
+    ++_table._operationDepth;
+}
+
+_NSPointerTable::_Operation::~_Operation() {
+    if (--_table._operationDepth == 0 && !_table._relinquished.empty()) {
+        _table._DrainRelinquished();
+    }
+}
+
+_NSPointerTable::_Functions _NSPointerTable::_FunctionsFrom(NSPointerFunctions* functions) {
+    _Functions ret = {};
+    if (!functions) {
+        return ret;
+    }
+
+    _NSConcretePointerFunctions* concrete = reinterpret_cast<_NSConcretePointerFunctions*>(functions);
+    ret.hash = functions.hashFunction;
+    ret.isEqual = functions.isEqualFunction;
+    ret.size = functions.sizeFunction;
+    ret.acquire = functions.acquireFunction;
+    ret.relinquish = functions.relinquishFunction;
+    ret.copyIn = [concrete copyIn];
+    ret.weak = [concrete weakMemory];
+    ret.addressIdentity =
+        ((ret.hash == &_NSPointerFunctionsHashShiftedPointer) || (ret.hash == &_NSPointerFunctionsHashUnshiftedPointer)) &&
+        (ret.isEqual == &_NSPointerFunctionsIsEqualDirectCompare);
+    return ret;
+}
+
+_NSPointerTable::_NSPointerTable(NSPointerFunctions* keyFunctions, NSPointerFunctions* valueFunctions, NSUInteger capacity)
+    : _keys(_FunctionsFrom(keyFunctions)),
+      _values(_FunctionsFrom(valueFunctions)),
+      _hasValues(valueFunctions != nil),
+      _capacity(0),
+      _count(0),
+      _deleted(0),
+      _mutations(0),
+      _operationDepth(0) {
+    if (capacity > 0) {
+        _capacity = _capacityFor(capacity);
+        _slots.reset(new _Slot[_capacity]());
+    }
+}
+
+_NSPointerTable::~_NSPointerTable() {
+    RemoveAll();
+}
+
+NSUInteger _NSPointerTable::_Hash(id key) const {
+    if (_keys.addressIdentity) {
+        return _mixHash(reinterpret_cast<uintptr_t>(key));
+    }
+    return _mixHash(_keys.hash ? _keys.hash(key, _keys.size) : 0);
+}
+
+bool _NSPointerTable::_IsEqual(id key, id storedKey) const {
+    if (_keys.addressIdentity || !_keys.isEqual) {
+        return key == storedKey;
+    }
+    return _keys.isEqual(key, storedKey, _keys.size);
+}
+
+// Whether the slot's key is still alive. Only weak keys can die.
+bool _NSPointerTable::_IsLive(_Slot& slot) {
+    if (!_keys.weak) {
+        return true;
+    }
+
+    id key = objc_loadWeakRetained(&slot.key);
+    if (!key) {
+        return false;
+    }
+    objc_release(key);
+    return true;
+}
+
+id _NSPointerTable::_Acquire(const _Functions& functions, id item) {
+    return functions.acquire ? reinterpret_cast<id>(functions.acquire(item, functions.size, functions.copyIn)) : item;
+}
+
+void _NSPointerTable::_Relinquish(const _Functions& functions, id item) {
+    if (functions.relinquish && item) {
+        _relinquished.push_back({ item, functions.relinquish, functions.size });
+    }
+}
+
+void _NSPointerTable::_Store(const _Functions& functions, id* location, id item) {
+    if (functions.weak) {
+        objc_storeWeak(location, item);
+    } else {
+        *location = item;
+    }
+}
+
+void _NSPointerTable::_DrainRelinquished() {
+    // Relinquishing can deallocate this table's owner, so nothing on this is touched once relinquishing starts.
+    std::vector<_Relinquished> relinquished;
+    relinquished.swap(_relinquished);
+    for (const _Relinquished& item : relinquished) {
+        item.relinquish(item.item, item.size);
+    }
+}
+
+// Returns the slot holding a key equal to key, or nullptr. Dead weak keys that have to be loaded for the comparison are
+// reclaimed on the way.
+_NSPointerTable::_Slot* _NSPointerTable::_Find(id key) {
+    if (_capacity == 0) {
+        return nullptr;
+    }
+
+    NSUInteger hash = _Hash(key);
+    NSUInteger mask = _capacity - 1;
+    for (NSUInteger index = hash & mask, probes = 0; probes < _capacity; index = (index + 1) & mask, ++probes) {
+        _Slot& slot = _slots[index];
+        if (slot.state == _SlotState::Empty) {
+            return nullptr;
+        }
+
+        if ((slot.state == _SlotState::Deleted) || (slot.hash != hash)) {
+            continue;
+        }
+
+        if (!_keys.weak) {
+            if (_IsEqual(key, slot.key)) {
+                return &slot;
+            }
+            continue;
+        }
+
+        if (_keys.addressIdentity && (slot.identity != reinterpret_cast<uintptr_t>(key))) {
+            continue;
+        }
+
+        id storedKey = objc_loadWeakRetained(&slot.key);
+        if (!storedKey) {
+            _Clear(slot);
+            continue;
+        }
+
+        bool equal = _IsEqual(key, storedKey);
+        objc_release(storedKey);
+        if (equal) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+void _NSPointerTable::_Clear(_Slot& slot) {
+    if (_keys.weak) {
+        objc_destroyWeak(&slot.key);
+    } else {
+        _Relinquish(_keys, slot.key);
+    }
+
+    if (_hasValues) {
+        if (_values.weak) {
+            objc_destroyWeak(&slot.value);
+        } else {
+            _Relinquish(_values, slot.value);
+        }
+    }
+
+    slot.key = nil;
+    slot.value = nil;
+    slot.state = _SlotState::Deleted;
+    --_count;
+    ++_deleted;
+}
+
+// Moves the live entries into a new slot array, dropping tombstones and reclaiming the entries of dead weak keys.
+void _NSPointerTable::_Rehash(NSUInteger capacity) {
+    std::unique_ptr<_Slot[]> oldSlots(std::move(_slots));
+    NSUInteger oldCapacity = _capacity;
+
+    _slots.reset(new _Slot[capacity]());
+    _capacity = capacity;
+
+    NSUInteger mask = _capacity - 1;
+    for (NSUInteger oldIndex = 0; oldIndex < oldCapacity; ++oldIndex) {
+        _Slot& oldSlot = oldSlots[oldIndex];
+        if (oldSlot.state != _SlotState::Occupied) {
+            continue;
+        }
+
+        if (!_IsLive(oldSlot)) {
+            // Keep _count in step with the slot being dropped.
+            _Clear(oldSlot);
+            continue;
+        }
+
+        NSUInteger index = oldSlot.hash & mask;
+        while (_slots[index].state != _SlotState::Empty) {
+            index = (index + 1) & mask;
+        }
+
+        _Slot& slot = _slots[index];
+        if (_keys.weak) {
+            objc_moveWeak(&slot.key, &oldSlot.key);
+        } else {
+            slot.key = oldSlot.key;
+        }
+        if (_values.weak) {
+            objc_moveWeak(&slot.value, &oldSlot.value);
+        } else {
+            slot.value = oldSlot.value;
+        }
+        slot.identity = oldSlot.identity;
+        slot.hash = oldSlot.hash;
+        slot.state = _SlotState::Occupied;
+    }
+
+    _deleted = 0;
+}
+
+// Returns whether any entry was reclaimed.
+bool _NSPointerTable::_ReclaimDeadKeys() {
+    bool reclaimed = false;
+    for (NSUInteger index = 0; index < _capacity; ++index) {
+        _Slot& slot = _slots[index];
+        if ((slot.state == _SlotState::Occupied) && !_IsLive(slot)) {
+            _Clear(slot);
+            reclaimed = true;
+        }
+    }
+    return reclaimed;
+}
+
+bool _NSPointerTable::Contains(id key) {
+    _Operation operation(*this);
+    return _Find(key) != nullptr;
+}
+
+id _NSPointerTable::Member(id key) {
+    _Operation operation(*this);
+    _Slot* slot = _Find(key);
+    if (!slot) {
+        return nil;
+    }
+    return _keys.weak ? objc_loadWeak(&slot->key) : slot->key;
+}
+
+id _NSPointerTable::ObjectForKey(id key) {
+    _Operation operation(*this);
+    _Slot* slot = _Find(key);
+    if (!slot) {
+        return nil;
+    }
+    return _values.weak ? objc_loadWeak(&slot->value) : slot->value;
+}
+
+void _NSPointerTable::Insert(id key, id value, bool replaceExisting) {
+    _Operation operation(*this);
+
+    if (_Slot* existing = _Find(key)) {
+        if (!replaceExisting) {
+            return;
+        }
+        _Clear(*existing);
+    }
+
+    key = _Acquire(_keys, key);
+    if (_hasValues) {
+        value = _Acquire(_values, value);
+    }
+
+    if ((_count + _deleted + 1) * 4 > _capacity * 3) {
+        _Rehash(_capacityFor(_count + 1));
+    }
+
+    // Reuse the first tombstone on the probe path, reclaiming dead weak keys along the way so that churn reuses their slots
+    // instead of growing the table.
+    NSUInteger hash = _Hash(key);
+    NSUInteger mask = _capacity - 1;
+    NSUInteger index = hash & mask;
+    while (_slots[index].state != _SlotState::Empty) {
+        _Slot& candidate = _slots[index];
+        if ((candidate.state == _SlotState::Occupied) && !_IsLive(candidate)) {
+            _Clear(candidate);
+        }
+        if (candidate.state == _SlotState::Deleted) {
+            --_deleted;
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    _Slot& slot = _slots[index];
+    _Store(_keys, &slot.key, key);
+    if (_hasValues) {
+        _Store(_values, &slot.value, value);
+    }
+    slot.identity = reinterpret_cast<uintptr_t>(key);
+    slot.hash = hash;
+    slot.state = _SlotState::Occupied;
+    ++_count;
+    ++_mutations;
+}
+
+void _NSPointerTable::Remove(id key) {
+    _Operation operation(*this);
+    if (_Slot* slot = _Find(key)) {
+        _Clear(*slot);
+        ++_mutations;
+    }
+}
+
+void _NSPointerTable::RemoveAll() {
+    _Operation operation(*this);
+    for (NSUInteger index = 0; index < _capacity; ++index) {
+        if (_slots[index].state == _SlotState::Occupied) {
+            _Clear(_slots[index]);
+        }
+    }
+
+    _slots.reset();
+    _capacity = 0;
+    _count = 0;
+    _deleted = 0;
+    ++_mutations;
+}
+
+NSUInteger _NSPointerTable::Count() {
+    if (_keys.weak) {
+        // Relinquishing a reclaimed value can deallocate another weak key in this table, so sweep until nothing more dies.
+        bool reclaimed;
+        do {
+            _Operation operation(*this);
+            reclaimed = _ReclaimDeadKeys();
+        } while (reclaimed);
+    }
+    return _count;
+}
+
+bool _NSPointerTable::EntryAtSlot(NSUInteger index, id* key, id* value) {
+    _Slot& slot = _slots[index];
+    if (slot.state != _SlotState::Occupied) {
+        return false;
+    }
+
+    id storedKey = _keys.weak ? objc_loadWeak(&slot.key) : slot.key;
+    if (!storedKey) {
+        return false;
+    }
+
+    if (key) {
+        *key = storedKey;
+    }
+    if (value) {
+        *value = _values.weak ? objc_loadWeak(&slot.value) : slot.value;
+    }
+    return true;
+}
+
+NSUInteger _NSPointerTable::CountByEnumerating(NSFastEnumerationState* state, id* stackbuf, NSUInteger len, bool returnKeys) {
+    NSUInteger index = state->state;
+    NSUInteger count = 0;
+    while ((index < _capacity) && (count < len)) {
+        id key;
+        id value;
+        if (EntryAtSlot(index++, &key, &value)) {
+            stackbuf[count++] = returnKeys ? key : value;
+        }
+    }
+
+    state->state = index;
+    state->itemsPtr = stackbuf;
+    state->mutationsPtr = &_mutations;
+    return count;
+}
+
+@implementation _NSPointerTableEnumerator {
+@private
+    StrongId<id> _collection;
+    _NSPointerTable* _table; // owned by _collection
+    NSUInteger _index;
+    BOOL _returnKeys;
+}
+
+- (instancetype)initWithCollection:(id)collection table:(_NSPointerTable*)table returnKeys:(BOOL)returnKeys {
+    if (self = [super init]) {
+        _collection = collection;
+        _table = table;
+        _index = 0;
+        _returnKeys = returnKeys;
+    }
+
+    return self;
+}
+
+- (id)nextObject {
+    while (_index < _table->SlotCount()) {
+        id key;
+        id value;
+        if (_table->EntryAtSlot(_index++, &key, &value)) {
+            return _returnKeys ? key : value;
+        }
+    }
+
+    return nil;
+}
+
+@end
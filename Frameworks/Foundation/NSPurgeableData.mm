@@ -14,42 +14,219 @@
 //
 //******************************************************************************
 
-#import <StubReturn.h>
+#import <Starboard.h>
 #import <Foundation/NSPurgeableData.h>
+#import <NSMemoryPressure.h>
+
+#include <list>
+#include <mutex>
+
+// Content that is not being accessed can be discarded at any time by the memory pressure monitor, so the access counts, the
+// discarded flags and the list of discardable instances are all guarded by one lock.
+namespace {
+struct _NSPurgeableDataState {
+    std::mutex mutex;
+    // The instances with an access count of 0 whose content has not been discarded yet, least recently released first.
+    std::list<NSPurgeableData*> discardable;
+};
+
+_NSPurgeableDataState& _state() {
+    static _NSPurgeableDataState* state = new _NSPurgeableDataState();
+    return *state;
+}
+}
+
+@interface NSPurgeableData () {
+    StrongId<NSMutableData> _data;
+    NSUInteger _accessCount;
+    BOOL _discarded;
+    std::list<NSPurgeableData*>::iterator _discardablePosition;
+}
+// Marks the content as discarded and returns it, +1, so that the caller can release it outside the lock.
+// invariant: under _state().mutex
+- (NSMutableData*)_detachContent;
+@end
+
+// Discards the content of every NSPurgeableData that is not being accessed. Registered once, ahead of the caches that may
+// hold the instances.
+@interface _NSPurgeableDataPurger : NSObject <_NSMemoryPressureClient>
+@end
+
+@implementation _NSPurgeableDataPurger
++ (void)ensureRegistered {
+    static _NSPurgeableDataPurger* purger = []() {
+        _NSPurgeableDataPurger* purger = [_NSPurgeableDataPurger new];
+        _NSMemoryPressureAddClient(purger, _NSMemoryPressurePriorityPurgeableData);
+        return purger;
+    }();
+    (void)purger;
+}
+
+- (void)_shedMemoryForPressureLevel:(_NSMemoryPressureLevel)level {
+    // Released outside the lock: freeing a large buffer can take a while.
+    std::list<StrongId<NSMutableData>> released;
+    {
+        auto& state = _state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (NSPurgeableData* data : state.discardable) {
+            released.emplace_back();
+            released.back().attach([data _detachContent]);
+        }
+        state.discardable.clear();
+    }
+}
+@end
 
 @implementation NSPurgeableData
+// NSPurgeableData is created with an access count of 1, as if beginContentAccess had been called on it.
+- (instancetype)_initWithData:(NSMutableData*)data {
+    if (self = [super init]) {
+        if (!data) {
+            [self release];
+            return nil;
+        }
+
+        _data = data;
+        _accessCount = 1;
+        [_NSPurgeableDataPurger ensureRegistered];
+    }
+    return self;
+}
+
+/**
+ @Status Interoperable
+*/
+- (instancetype)init {
+    return [self initWithCapacity:0];
+}
+
+/**
+ @Status Interoperable
+*/
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    return [self _initWithData:[NSMutableData dataWithCapacity:capacity]];
+}
+
+/**
+ @Status Caveat
+ @Notes The CRT used between Islandwood and the application must match if freeWhenDone=TRUE
+*/
+- (instancetype)initWithBytesNoCopy:(void*)bytes length:(NSUInteger)length freeWhenDone:(BOOL)freeWhenDone {
+    StrongId<NSMutableData> data;
+    data.attach([[NSMutableData alloc] initWithBytesNoCopy:bytes length:length freeWhenDone:freeWhenDone]);
+    return [self _initWithData:data];
+}
+
+- (void)dealloc {
+    auto& state = _state();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if ((_accessCount == 0) && !_discarded) {
+            state.discardable.erase(_discardablePosition);
+        }
+    }
+
+    _data = nil;
+    [super dealloc];
+}
+
+/**
+ @Status Interoperable
+ @Notes Returns NULL once the content has been discarded.
+*/
+- (const void*)bytes {
+    return [_data bytes];
+}
+
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Returns 0 once the content has been discarded.
+*/
+- (NSUInteger)length {
+    return [_data length];
+}
+
+/**
+ @Status Interoperable
+ @Notes Returns NULL once the content has been discarded.
+*/
+- (void*)mutableBytes {
+    return [_data mutableBytes];
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setLength:(NSUInteger)length {
+    [_data setLength:length];
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)replaceBytesInRange:(NSRange)range withBytes:(const void*)bytes length:(NSUInteger)length {
+    [_data replaceBytesInRange:range withBytes:bytes length:length];
+}
+
+/**
+ @Status Interoperable
 */
 - (BOOL)beginContentAccess {
-    UNIMPLEMENTED();
-    return StubReturn();
+    auto& state = _state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (_discarded) {
+        return NO;
+    }
+
+    if (_accessCount++ == 0) {
+        state.discardable.erase(_discardablePosition);
+    }
+    return YES;
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)endContentAccess {
-    UNIMPLEMENTED();
+    auto& state = _state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (_accessCount == 0) {
+        return;
+    }
+
+    if ((--_accessCount == 0) && !_discarded) {
+        _discardablePosition = state.discardable.emplace(state.discardable.end(), self);
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (void)discardContentIfPossible {
-    UNIMPLEMENTED();
+    StrongId<NSMutableData> released;
+    {
+        auto& state = _state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if ((_accessCount != 0) || _discarded) {
+            return;
+        }
+
+        state.discardable.erase(_discardablePosition);
+        released.attach([self _detachContent]);
+    }
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (BOOL)isContentDiscarded {
-    UNIMPLEMENTED();
-    return StubReturn();
+    std::lock_guard<std::mutex> lock(_state().mutex);
+    return _discarded;
+}
+
+- (NSMutableData*)_detachContent {
+    _discarded = YES;
+    return _data.detach();
 }
 
 @end
@@ -24,6 +24,7 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #import <Foundation/NSDate.h>
 #import <Foundation/NSAutoreleasePool.h>
 #import <Foundation/NSNotificationCenter.h>
+#import <Foundation/NSNotificationQueue.h>
 #import <Foundation/NSOperationQueue.h>
 #import <Windows.h>
 #import "NSInputSource.h"
@@ -31,8 +32,10 @@ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 #import "NSDelayedPerform.h"
 #import "NSOrderedPerform.h"
 #import "NSRunLoop+Internal.h"
+#import "NSNotificationQueue+Internal.h"
 #import "dispatch/dispatch.h"
 #import "LoggingNative.h"
+#import "Instrumentation.h"
 #import "NSThread-Internal.h"
 
 static const wchar_t* TAG = L"NSRunLoop";
@@ -54,6 +57,12 @@ extern "C" NSRunLoopMode const NSRunLoopCommonModes = @"kCFRunLoopCommonModes";
 @property (readwrite, copy) NSRunLoopMode currentMode;
 @end
 
+// Runs the blocks queued to the main dispatch queue.
+static void _drainMainDispatchQueue() {
+    INSTRUMENT_SPAN("Foundation", "NSRunLoop.drainMainQueue");
+    dispatch_main_queue_callback();
+}
+
 static void DispatchMainRunLoopWakeup(void* arg) {
     [[NSRunLoop mainRunLoop] _wakeUp];
 }
@@ -253,7 +262,7 @@ static void DispatchMainRunLoopWakeup(void* arg) {
 
     NSAutoreleasePool* pool = [NSAutoreleasePool new];
     if ([NSThread currentThread] == [NSThread mainThread]) {
-        dispatch_main_queue_callback();
+        _drainMainDispatchQueue();
     }
     NSDate* limitDate = [self limitDateForMode:mode];
 
@@ -498,7 +507,7 @@ static void DispatchMainRunLoopWakeup(void* arg) {
     // Wrap code in a autorelease pool so all the auto released objects from calling the event
     // handlers can be manually released.
     @autoreleasepool {
-        dispatch_main_queue_callback();
+        _drainMainDispatchQueue();
         [state _handleSignaledInput:value];
     }
 }
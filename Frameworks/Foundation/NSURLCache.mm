@@ -16,6 +16,7 @@
 
 #include "Starboard.h"
 #include "Foundation/NSURLCache.h"
+#include "NSMemoryPressure.h"
 
 #include <list>
 #include <mutex>
@@ -25,7 +26,7 @@
 // FIXME: Libclang crashes on a decltype in an ivar block. Once the bug is fixed, go back to using decltype.
 using cacheType = std::list<std::pair<std::string, StrongId<NSCachedURLResponse>>>;
 
-@interface NSURLCache () {
+@interface NSURLCache () <_NSMemoryPressureClient> {
     std::recursive_mutex _mutex;
     cacheType _cache;
     std::map<std::string, cacheType::iterator> _iterators;
@@ -67,10 +68,16 @@ static StrongId<NSURLCache> _sharedURLCache;
     if (self = [super init]) {
         _memoryCapacity = memCapacity;
         _diskCapacity = diskCapacity;
+        _NSMemoryPressureAddClient(self, _NSMemoryPressurePriorityURLCache);
     }
     return self;
 }
 
+- (void)dealloc {
+    _NSMemoryPressureRemoveClient(self);
+    [super dealloc];
+}
+
 - (instancetype)_initWithSharedDefaults {
     return [self initWithMemoryCapacity:kNSURLCacheDefaultMemoryCapacity
                            diskCapacity:kNSURLCacheDefaultDiskCapacity
@@ -87,6 +94,17 @@ static StrongId<NSURLCache> _sharedURLCache;
     return [absoluteString substringToIndex:hashRange.location];
 }
 
+// Evicts the least recently used responses until the cache holds no more than memoryUsage bytes.
+- (void)_trimToMemoryUsage:(NSUInteger)memoryUsage {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    while ((_currentMemoryUsage > memoryUsage) && (_cache.size() > 0)) {
+        auto lastEntry = _cache.back();
+        _cache.pop_back();
+        _iterators.erase(lastEntry.first);
+        _currentMemoryUsage -= [[lastEntry.second data] length];
+    }
+}
+
 - (void)_insertResponse:(NSCachedURLResponse*)response forKey:(const std::string&)key {
     _cache.emplace_front(key, response);
     _iterators[key] = _cache.begin();
@@ -129,16 +147,11 @@ static StrongId<NSURLCache> _sharedURLCache;
     [self removeCachedResponseForRequest:request];
 
     auto cachedResponseLength = [[cachedResponse data] length];
-    while (_currentMemoryUsage > _memoryCapacity - cachedResponseLength) {
-        if (_cache.size() == 0) {
-            // We could not satisfy the request: do not cache this response.
-            return;
-        }
-        auto lastEntry = _cache.back();
-        _cache.pop_back();
-        _iterators.erase(lastEntry.first);
-        _currentMemoryUsage -= [[lastEntry.second data] length];
+    if (cachedResponseLength > _memoryCapacity) {
+        // We could not satisfy the request: do not cache this response.
+        return;
     }
+    [self _trimToMemoryUsage:_memoryCapacity - cachedResponseLength];
 
     std::string cacheKey([[self _cacheKeyForURL:[request URL]] UTF8String]);
     [self _insertResponse:cachedResponse forKey:cacheKey];
@@ -170,4 +183,16 @@ static StrongId<NSURLCache> _sharedURLCache;
     _iterators.clear();
 }
 
+// Under warning pressure, evicts the least recently used responses until half of the memory in use is freed. Under
+// critical pressure, evicts everything.
+- (void)_shedMemoryForPressureLevel:(_NSMemoryPressureLevel)level {
+    if (level == _NSMemoryPressureLevelCritical) {
+        [self removeAllCachedResponses];
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    [self _trimToMemoryUsage:_currentMemoryUsage / 2];
+}
+
 @end
@@ -0,0 +1,1206 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#import <Starboard.h>
+#import <Foundation/Foundation.h>
+
+#import "NSURLProtocol_HTTP.h"
+#import "NSURLProtocolInternal.h"
+#import "NSURLSessionTask-Internal.h"
+#import "LoggingNative.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+static const wchar_t TAG[] = L"NSURLProtocol (pooled HTTP)";
+
+// Each receive is sized by what the socket reports as available, but never smaller than this.
+static const size_t c_minimumReceiveSize = 16384;
+// A response head, chunk header or trailer that does not fit in this many bytes is treated as a bad response.
+static const size_t c_maximumLineBufferSize = 65536;
+// Request bodies are produced this much at a time, and only once the previous piece has been written: however large the
+// body, no more than this is buffered for it.
+static const size_t c_bodyChunkSize = 131072;
+static const size_t c_maximumPipelineDepth = 4;
+static const std::chrono::seconds c_idleConnectionLifetime(30);
+static const std::chrono::seconds c_addressLifetime(60);
+static const unsigned short c_defaultPort = 80;
+
+static std::atomic<NSUInteger> s_connectionsOpened(0);
+static std::atomic<NSUInteger> s_requestsSent(0);
+
+@interface NSURLProtocol_HTTP ()
+@property (assign, atomic) bool cancelled;
+@end
+
+// A view into a receive buffer. Every receive fills a fresh buffer that is not written again once it has been parsed, so
+// body bytes can be handed to the client without a copy; the slice keeps the whole buffer alive for as long as it lives.
+@interface _NSHTTPDataSlice : NSData {
+    StrongId<NSData> _buffer;
+    const void* _bytes;
+    NSUInteger _length;
+}
+- (instancetype)initWithBuffer:(NSData*)buffer range:(NSRange)range;
+@end
+
+@implementation _NSHTTPDataSlice
+- (instancetype)initWithBuffer:(NSData*)buffer range:(NSRange)range {
+    if (self = [super init]) {
+        _buffer = buffer;
+        _bytes = static_cast<const uint8_t*>([buffer bytes]) + range.location;
+        _length = range.length;
+    }
+    return self;
+}
+
+- (const void*)bytes {
+    return _bytes;
+}
+
+- (NSUInteger)length {
+    return _length;
+}
+
+- (id)copyWithZone:(NSZone*)zone {
+    return [self retain];
+}
+@end
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct _HTTPHost;
+
+// One request and the response to it. The pool owns exchanges until they complete or fail; the protocol instance is
+// reached only through the strong reference, and is told about nothing once it has been cancelled.
+struct _HTTPExchange {
+    StrongId<NSURLProtocol_HTTP> protocol;
+    std::string hostKey;
+    sockaddr_storage address;
+    int addressLength;
+    std::string serialized;
+    bool isHead;
+    bool idempotent;
+    bool pipelinable;
+    size_t maximumConnections;
+    Clock::duration timeout;
+    // While the exchange waits for a connection, the time by which it must have been written.
+    Clock::time_point deadline;
+    bool retried = false;
+    bool responseStarted = false;
+    // Redirected or cancelled: the rest of the response is read to keep the connection usable, and dropped.
+    bool discardResponse = false;
+
+    // The request body comes from bodyData, or is read from bodyStream off the I/O thread. A body of unknown length is
+    // sent chunked, and reported with a negative bodyLength.
+    StrongId<NSData> bodyData;
+    StrongId<NSInputStream> bodyStream;
+    int64_t bodyLength = 0;
+    int64_t bodyRead = 0;
+    int64_t bodySent = 0;
+    bool bodyReadPending = false;
+    bool bodyFinished = false;
+
+    ~_HTTPExchange() {
+        [bodyStream close];
+    }
+
+    bool HasBody() const {
+        return bodyStream || bodyLength > 0;
+    }
+};
+
+enum class _HTTPReadState { Head, FixedBody, ChunkSize, ChunkData, ChunkDataEnd, ChunkTrailers, UntilClose };
+
+struct _HTTPConnection {
+    SOCKET socket = INVALID_SOCKET;
+    _HTTPHost* host = nullptr;
+    bool connecting = true;
+    bool closed = false;
+    // Written or waiting to be written, in request order. The response being read belongs to the front one.
+    std::deque<std::shared_ptr<_HTTPExchange>> exchanges;
+    std::string outgoing;
+    size_t outgoingOffset = 0;
+    // The exchange whose request body is still being written. Requests with bodies are never pipelined, so while there is
+    // one it is the only exchange on the connection.
+    std::shared_ptr<_HTTPExchange> writing;
+    // Body bytes in outgoing that have not yet been reported as sent.
+    size_t unreportedBodyBytes = 0;
+    // Bytes left unparsed by the last receive: only ever a partial response head, chunk header or trailer line.
+    std::string incoming;
+    _HTTPReadState readState = _HTTPReadState::Head;
+    uint64_t remaining = 0;
+    bool keepAlive = true;
+    size_t completed = 0;
+    Clock::time_point lastActivity;
+};
+
+struct _HTTPHost {
+    std::string key;
+    std::deque<std::shared_ptr<_HTTPExchange>> pending;
+    std::vector<std::unique_ptr<_HTTPConnection>> connections;
+};
+
+enum class _HTTPFailure { None, Cancelled, ConnectFailed, ConnectionLost, TimedOut, BadResponse, BodyFailed };
+
+static void _failExchange(const std::shared_ptr<_HTTPExchange>& exchange, NSInteger code) {
+    NSURLProtocol_HTTP* protocol = exchange->protocol;
+    if (exchange->discardResponse || [protocol cancelled]) {
+        return;
+    }
+
+    NSError* error = [NSError errorWithDomain:NSURLErrorDomain
+                                         code:code
+                                     userInfo:@{ NSURLErrorFailingURLErrorKey : protocol.request.URL }];
+    [protocol.client URLProtocol:protocol didFailWithError:error];
+}
+
+static void _reportBodySent(const std::shared_ptr<_HTTPExchange>& exchange, int64_t bytesSent) {
+    NSURLProtocol_HTTP* protocol = exchange->protocol;
+    id client = protocol.client;
+    if (exchange->discardResponse || [protocol cancelled] ||
+        ![client respondsToSelector:@selector(URLProtocol:didSendBodyData:totalBytesSent:totalBytesExpectedToSend:)]) {
+        return;
+    }
+
+    [static_cast<id<_NSURLProtocolClientBodyProgress>>(client) URLProtocol:protocol
+                                                          didSendBodyData:bytesSent
+                                                           totalBytesSent:exchange->bodySent
+                                                 totalBytesExpectedToSend:exchange->bodyLength];
+}
+
+static std::string _lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+static std::string _trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) {
+        --end;
+    }
+    return std::string(begin, end);
+}
+
+static const char* _findCRLF(const char* begin, const char* end) {
+    for (const char* cursor = begin; cursor + 1 < end; ++cursor) {
+        if (cursor[0] == '\r' && cursor[1] == '\n') {
+            return cursor;
+        }
+    }
+    return nullptr;
+}
+
+// All sockets are driven by a single I/O thread, which waits on every open connection at once. Other threads talk to it
+// only through the command queue; everything else here belongs to the I/O thread.
+class _HTTPConnectionPool {
+public:
+    static _HTTPConnectionPool& Get() {
+        static _HTTPConnectionPool* pool = new _HTTPConnectionPool();
+        return *pool;
+    }
+
+    // Resolves host on the calling thread, so that a slow lookup never holds up the I/O thread. Answers are cached briefly.
+    bool Resolve(const std::string& host, unsigned short port, sockaddr_storage* address, int* addressLength) {
+        std::string key = host + ":" + std::to_string(port);
+        {
+            std::lock_guard<std::mutex> lock(_addressMutex);
+            auto found = _addresses.find(key);
+            if (found != _addresses.end() && Clock::now() < found->second.expiry) {
+                *address = found->second.address;
+                *addressLength = found->second.length;
+                return true;
+            }
+        }
+
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        addrinfo* results = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &results) != 0 || !results) {
+            return false;
+        }
+
+        _CachedAddress cached;
+        memcpy(&cached.address, results->ai_addr, results->ai_addrlen);
+        cached.length = static_cast<int>(results->ai_addrlen);
+        cached.expiry = Clock::now() + c_addressLifetime;
+        freeaddrinfo(results);
+
+        *address = cached.address;
+        *addressLength = cached.length;
+        std::lock_guard<std::mutex> lock(_addressMutex);
+        _addresses[key] = cached;
+        return true;
+    }
+
+    void Enqueue(std::shared_ptr<_HTTPExchange> exchange) {
+        _post([this, exchange]() {
+            auto& host = _hosts[exchange->hostKey];
+            host.key = exchange->hostKey;
+            exchange->deadline = Clock::now() + exchange->timeout;
+            host.pending.emplace_back(exchange);
+        });
+    }
+
+    void Cancel(NSURLProtocol_HTTP* protocol, const std::string& hostKey) {
+        StrongId<NSURLProtocol_HTTP> strongProtocol(protocol);
+        _post([this, strongProtocol, hostKey]() { _cancel(strongProtocol, hostKey); });
+    }
+
+private:
+    struct _CachedAddress {
+        sockaddr_storage address;
+        int length;
+        Clock::time_point expiry;
+    };
+
+    _HTTPConnectionPool() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+
+        // The I/O thread is woken by a datagram sent to a loopback socket connected to itself.
+        _wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        sockaddr_in loopback = {};
+        loopback.sin_family = AF_INET;
+        loopback.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int length = sizeof(loopback);
+        bind(_wakeSocket, reinterpret_cast<sockaddr*>(&loopback), length);
+        getsockname(_wakeSocket, reinterpret_cast<sockaddr*>(&loopback), &length);
+        connect(_wakeSocket, reinterpret_cast<sockaddr*>(&loopback), length);
+        u_long nonblocking = 1;
+        ioctlsocket(_wakeSocket, FIONBIO, &nonblocking);
+
+        std::thread([this]() { _run(); }).detach();
+    }
+
+    void _post(std::function<void()> command) {
+        {
+            std::lock_guard<std::mutex> lock(_commandMutex);
+            _commands.emplace_back(std::move(command));
+        }
+        char wake = 0;
+        send(_wakeSocket, &wake, 1, 0);
+    }
+
+    void _run() {
+        while (true) {
+            @autoreleasepool {
+                std::vector<std::function<void()>> commands;
+                {
+                    std::lock_guard<std::mutex> lock(_commandMutex);
+                    commands.swap(_commands);
+                }
+                for (auto& command : commands) {
+                    command();
+                }
+
+                for (auto& entry : _hosts) {
+                    _schedule(entry.second);
+                }
+
+                std::vector<WSAPOLLFD> descriptors;
+                std::vector<_HTTPConnection*> polled;
+                descriptors.push_back({ _wakeSocket, POLLRDNORM, 0 });
+                for (auto& entry : _hosts) {
+                    for (auto& connection : entry.second.connections) {
+                        SHORT events = POLLRDNORM;
+                        if (connection->connecting || !connection->outgoing.empty()) {
+                            events |= POLLWRNORM;
+                        }
+                        descriptors.push_back({ connection->socket, events, 0 });
+                        polled.push_back(connection.get());
+                    }
+                }
+
+                if (WSAPoll(descriptors.data(), static_cast<ULONG>(descriptors.size()), _pollTimeout()) == SOCKET_ERROR) {
+                    TraceError(TAG, L"WSAPoll failed: %d", WSAGetLastError());
+                }
+
+                if (descriptors[0].revents) {
+                    char drain[64];
+                    while (recv(_wakeSocket, drain, sizeof(drain), 0) > 0) {
+                    }
+                }
+
+                for (size_t i = 0; i < polled.size(); ++i) {
+                    SHORT events = descriptors[i + 1].revents;
+                    if (events && !polled[i]->closed) {
+                        _service(*polled[i], events);
+                    }
+                }
+
+                _expire();
+                _collect();
+            }
+        }
+    }
+
+    // Wakes up for the nearest timeout, and at least once a second.
+    INT _pollTimeout() {
+        auto now = Clock::now();
+        auto nearest = now + std::chrono::seconds(1);
+        for (auto& entry : _hosts) {
+            for (auto& exchange : entry.second.pending) {
+                nearest = std::min(nearest, exchange->deadline);
+            }
+            for (auto& connection : entry.second.connections) {
+                if (connection->exchanges.empty()) {
+                    nearest = std::min(nearest, connection->lastActivity + c_idleConnectionLifetime);
+                } else {
+                    nearest = std::min(nearest, connection->lastActivity + connection->exchanges.front()->timeout);
+                }
+            }
+        }
+        return static_cast<INT>(std::max<long long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(nearest - now).count()));
+    }
+
+    void _schedule(_HTTPHost& host) {
+        while (!host.pending.empty()) {
+            auto exchange = host.pending.front();
+            _HTTPConnection* target = nullptr;
+            size_t open = 0;
+            for (auto& connection : host.connections) {
+                if (connection->closed) {
+                    continue;
+                }
+                ++open;
+                if (!target && connection->exchanges.empty()) {
+                    target = connection.get();
+                }
+            }
+
+            if (!target && open < exchange->maximumConnections) {
+                target = _open(host, *exchange);
+                if (!target) {
+                    host.pending.pop_front();
+                    _failExchange(exchange, NSURLErrorCannotConnectToHost);
+                    continue;
+                }
+            }
+
+            // Pipeline only onto connections that have already kept a response alive, behind other pipelinable requests.
+            if (!target && exchange->pipelinable) {
+                for (auto& connection : host.connections) {
+                    if (connection->closed || connection->completed == 0 || !connection->keepAlive ||
+                        connection->exchanges.size() >= c_maximumPipelineDepth) {
+                        continue;
+                    }
+                    bool pipelinable = std::all_of(connection->exchanges.begin(),
+                                                   connection->exchanges.end(),
+                                                   [](const std::shared_ptr<_HTTPExchange>& queued) { return queued->pipelinable; });
+                    if (pipelinable && (!target || connection->exchanges.size() < target->exchanges.size())) {
+                        target = connection.get();
+                    }
+                }
+            }
+
+            if (!target) {
+                return;
+            }
+
+            host.pending.pop_front();
+            _assign(*target, exchange);
+        }
+    }
+
+    _HTTPConnection* _open(_HTTPHost& host, const _HTTPExchange& exchange) {
+        SOCKET newSocket = socket(exchange.address.ss_family, SOCK_STREAM, IPPROTO_TCP);
+        if (newSocket == INVALID_SOCKET) {
+            TraceError(TAG, L"Unable to create a socket: %d", WSAGetLastError());
+            return nullptr;
+        }
+
+        u_long nonblocking = 1;
+        BOOL noDelay = TRUE;
+        ioctlsocket(newSocket, FIONBIO, &nonblocking);
+        setsockopt(newSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        if (connect(newSocket, reinterpret_cast<const sockaddr*>(&exchange.address), exchange.addressLength) == SOCKET_ERROR &&
+            WSAGetLastError() != WSAEWOULDBLOCK) {
+            closesocket(newSocket);
+            return nullptr;
+        }
+
+        ++s_connectionsOpened;
+        auto connection = std::make_unique<_HTTPConnection>();
+        connection->socket = newSocket;
+        connection->host = &host;
+        connection->lastActivity = Clock::now();
+        host.connections.emplace_back(std::move(connection));
+        return host.connections.back().get();
+    }
+
+    void _assign(_HTTPConnection& connection, const std::shared_ptr<_HTTPExchange>& exchange) {
+        if (connection.exchanges.empty()) {
+            // Time spent idle in the pool does not count against the request.
+            connection.lastActivity = Clock::now();
+        }
+
+        exchange->responseStarted = false;
+        connection.exchanges.emplace_back(exchange);
+        connection.outgoing.append(exchange->serialized);
+        ++s_requestsSent;
+        if (exchange->HasBody()) {
+            exchange->bodyRead = 0;
+            exchange->bodySent = 0;
+            exchange->bodyFinished = false;
+            connection.writing = exchange;
+            _produceBody(connection);
+        }
+        if (!connection.connecting) {
+            _flush(connection);
+        }
+    }
+
+    void _service(_HTTPConnection& connection, SHORT events) {
+        if (connection.connecting) {
+            int error = 0;
+            int length = sizeof(error);
+            getsockopt(connection.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+            if (error != 0 || (events & (POLLERR | POLLHUP))) {
+                _abandon(connection, _HTTPFailure::ConnectFailed);
+                return;
+            }
+            if (!(events & POLLWRNORM)) {
+                return;
+            }
+            connection.connecting = false;
+        }
+
+        if ((events & POLLWRNORM) && !connection.outgoing.empty()) {
+            _flush(connection);
+        }
+        if (!connection.closed && (events & (POLLRDNORM | POLLERR | POLLHUP))) {
+            _receive(connection);
+        }
+    }
+
+    void _flush(_HTTPConnection& connection) {
+        while (connection.outgoingOffset < connection.outgoing.size()) {
+            int sent = send(connection.socket,
+                            connection.outgoing.data() + connection.outgoingOffset,
+                            static_cast<int>(std::min<size_t>(connection.outgoing.size() - connection.outgoingOffset, INT_MAX)),
+                            0);
+            if (sent == SOCKET_ERROR) {
+                if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                    _closed(connection);
+                }
+                return;
+            }
+            connection.outgoingOffset += sent;
+            connection.lastActivity = Clock::now();
+        }
+        connection.outgoing.clear();
+        connection.outgoingOffset = 0;
+
+        if (connection.writing) {
+            auto exchange = connection.writing;
+            if (connection.unreportedBodyBytes > 0) {
+                int64_t bytesSent = connection.unreportedBodyBytes;
+                connection.unreportedBodyBytes = 0;
+                exchange->bodySent += bytesSent;
+                _reportBodySent(exchange, bytesSent);
+            }
+            if (exchange->bodyFinished) {
+                connection.writing.reset();
+            } else {
+                _produceBody(connection);
+            }
+        }
+    }
+
+    // Queues the next piece of the request body being written on connection, once everything produced before it has been
+    // written. Pieces of a stream are read on a background queue, since a stream may block; they come back to the I/O thread
+    // through _bodyRead.
+    void _produceBody(_HTTPConnection& connection) {
+        auto exchange = connection.writing;
+        if (exchange->bodyFinished || exchange->bodyReadPending || connection.unreportedBodyBytes > 0) {
+            return;
+        }
+
+        if (!exchange->bodyStream) {
+            NSData* body = exchange->bodyData;
+            size_t offset = static_cast<size_t>(exchange->bodyRead);
+            size_t length = std::min(c_bodyChunkSize, [body length] - offset);
+            _appendBody(connection, static_cast<const char*>([body bytes]) + offset, length, offset + length == [body length]);
+            return;
+        }
+
+        exchange->bodyReadPending = true;
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            NSInputStream* stream = exchange->bodyStream;
+            if ([stream streamStatus] == NSStreamStatusNotOpen) {
+                [stream open];
+            }
+
+            auto chunk = std::make_shared<std::string>(c_bodyChunkSize, '\0');
+            NSInteger read = [stream read:reinterpret_cast<uint8_t*>(&(*chunk)[0]) maxLength:chunk->size()];
+            chunk->resize(std::max<NSInteger>(read, 0));
+            _post([this, exchange, chunk, read]() { _bodyRead(exchange, *chunk, read < 0); });
+        });
+    }
+
+    void _bodyRead(const std::shared_ptr<_HTTPExchange>& exchange, const std::string& chunk, bool failed) {
+        exchange->bodyReadPending = false;
+        auto found = _hosts.find(exchange->hostKey);
+        if (found == _hosts.end()) {
+            return;
+        }
+
+        // The exchange may have been cancelled, or its connection lost, while the read was under way.
+        auto& connections = found->second.connections;
+        auto writer = std::find_if(connections.begin(), connections.end(), [&exchange](const std::unique_ptr<_HTTPConnection>& connection) {
+            return !connection->closed && connection->writing == exchange;
+        });
+        if (writer == connections.end()) {
+            return;
+        }
+
+        _HTTPConnection& connection = **writer;
+        size_t length = chunk.size();
+        bool last = chunk.empty();
+        if (exchange->bodyLength >= 0) {
+            // A stream that runs past its declared length is cut short; one that ends before it cannot be sent.
+            length = static_cast<size_t>(std::min<int64_t>(length, exchange->bodyLength - exchange->bodyRead));
+            last = (exchange->bodyRead + static_cast<int64_t>(length) == exchange->bodyLength);
+            failed = failed || (chunk.empty() && !last);
+        }
+        if (failed) {
+            _abandon(connection, _HTTPFailure::BodyFailed);
+            return;
+        }
+
+        _appendBody(connection, chunk.data(), length, last);
+        if (!connection.connecting) {
+            _flush(connection);
+        }
+    }
+
+    void _appendBody(_HTTPConnection& connection, const char* bytes, size_t length, bool last) {
+        auto& exchange = *connection.writing;
+        if (exchange.bodyLength < 0) {
+            if (length > 0) {
+                char size[20];
+                sprintf_s(size, "%zx\r\n", length);
+                connection.outgoing.append(size).append(bytes, length).append("\r\n");
+            }
+            if (last) {
+                connection.outgoing.append("0\r\n\r\n");
+            }
+        } else {
+            connection.outgoing.append(bytes, length);
+        }
+
+        exchange.bodyRead += length;
+        exchange.bodyFinished = last;
+        connection.unreportedBodyBytes += length;
+    }
+
+    void _receive(_HTTPConnection& connection) {
+        u_long available = 0;
+        ioctlsocket(connection.socket, FIONREAD, &available);
+        size_t carried = connection.incoming.size();
+        size_t capacity = std::max<size_t>(available, c_minimumReceiveSize);
+
+        uint8_t* storage = static_cast<uint8_t*>(malloc(carried + capacity));
+        memcpy(storage, connection.incoming.data(), carried);
+        int received = recv(connection.socket, reinterpret_cast<char*>(storage + carried), static_cast<int>(capacity), 0);
+        if (received <= 0) {
+            free(storage);
+            if (received == 0 || WSAGetLastError() != WSAEWOULDBLOCK) {
+                _closed(connection);
+            }
+            return;
+        }
+
+        StrongId<NSData> buffer;
+        buffer.attach([[NSData alloc] initWithBytesNoCopy:storage length:carried + received freeWhenDone:YES]);
+        connection.incoming.clear();
+        connection.lastActivity = Clock::now();
+
+        size_t consumed = _parse(connection, buffer);
+        if (connection.closed) {
+            return;
+        }
+
+        connection.incoming.assign(reinterpret_cast<const char*>(storage) + consumed, carried + received - consumed);
+        if (connection.incoming.size() > c_maximumLineBufferSize) {
+            _abandon(connection, _HTTPFailure::BadResponse);
+        }
+    }
+
+    // Consumes as much of buffer as forms whole response heads, chunk headers and body bytes, and returns how much that was.
+    size_t _parse(_HTTPConnection& connection, NSData* buffer) {
+        const char* bytes = static_cast<const char*>([buffer bytes]);
+        const char* end = bytes + [buffer length];
+        const char* position = bytes;
+
+        while (position < end && !connection.closed) {
+            if (connection.exchanges.empty()) {
+                TraceWarning(TAG, L"Dropping a connection that sent an unsolicited response.");
+                _abandon(connection, _HTTPFailure::None);
+                break;
+            }
+
+            auto exchange = connection.exchanges.front();
+            exchange->responseStarted = true;
+            switch (connection.readState) {
+                case _HTTPReadState::Head: {
+                    const char* headEnd = nullptr;
+                    for (const char* line = position; (line = _findCRLF(line, end)); line += 2) {
+                        if (line + 3 < end && line[2] == '\r' && line[3] == '\n') {
+                            headEnd = line;
+                            break;
+                        }
+                    }
+                    if (!headEnd) {
+                        return position - bytes;
+                    }
+                    const char* headStart = position;
+                    position = headEnd + 4;
+                    _receiveHead(connection, exchange, headStart, headEnd);
+                    break;
+                }
+
+                case _HTTPReadState::FixedBody:
+                case _HTTPReadState::ChunkData:
+                case _HTTPReadState::UntilClose: {
+                    size_t length = end - position;
+                    if (connection.readState != _HTTPReadState::UntilClose) {
+                        length = static_cast<size_t>(std::min<uint64_t>(length, connection.remaining));
+                        connection.remaining -= length;
+                    }
+                    _deliver(exchange, buffer, NSMakeRange(position - bytes, length));
+                    position += length;
+
+                    if (connection.remaining == 0) {
+                        if (connection.readState == _HTTPReadState::FixedBody) {
+                            _complete(connection);
+                        } else if (connection.readState == _HTTPReadState::ChunkData) {
+                            connection.readState = _HTTPReadState::ChunkDataEnd;
+                        }
+                    }
+                    break;
+                }
+
+                case _HTTPReadState::ChunkDataEnd:
+                    if (end - position < 2) {
+                        return position - bytes;
+                    }
+                    if (position[0] != '\r' || position[1] != '\n') {
+                        _abandon(connection, _HTTPFailure::BadResponse);
+                        break;
+                    }
+                    position += 2;
+                    connection.readState = _HTTPReadState::ChunkSize;
+                    break;
+
+                case _HTTPReadState::ChunkSize: {
+                    const char* lineEnd = _findCRLF(position, end);
+                    if (!lineEnd) {
+                        return position - bytes;
+                    }
+                    // Chunk extensions after the size are ignored.
+                    char* sizeEnd = nullptr;
+                    unsigned long long size = strtoull(position, &sizeEnd, 16);
+                    if (sizeEnd == position || sizeEnd > lineEnd) {
+                        _abandon(connection, _HTTPFailure::BadResponse);
+                        break;
+                    }
+                    position = lineEnd + 2;
+                    connection.remaining = size;
+                    connection.readState = (size == 0) ? _HTTPReadState::ChunkTrailers : _HTTPReadState::ChunkData;
+                    break;
+                }
+
+                case _HTTPReadState::ChunkTrailers: {
+                    const char* lineEnd = _findCRLF(position, end);
+                    if (!lineEnd) {
+                        return position - bytes;
+                    }
+                    bool last = (lineEnd == position);
+                    position = lineEnd + 2;
+                    if (last) {
+                        _complete(connection);
+                    }
+                    break;
+                }
+            }
+        }
+
+        return position - bytes;
+    }
+
+    void _receiveHead(_HTTPConnection& connection, const std::shared_ptr<_HTTPExchange>& exchange, const char* begin, const char* end) {
+        int major = 0;
+        int minor = 0;
+        int statusCode = 0;
+        const char* statusEnd = _findCRLF(begin, end + 2);
+        std::string statusLine(begin, statusEnd);
+        if (sscanf_s(statusLine.c_str(), "HTTP/%d.%d %d", &major, &minor, &statusCode) != 3 || statusCode < 100 || statusCode == 101) {
+            _abandon(connection, _HTTPFailure::BadResponse);
+            return;
+        }
+
+        if (statusCode < 200) {
+            // Informational responses precede the real one.
+            return;
+        }
+
+        NSMutableDictionary* headerFields = [NSMutableDictionary dictionary];
+        NSMutableDictionary* cookieFields = [NSMutableDictionary dictionary];
+        std::string contentLength;
+        std::string transferEncoding;
+        std::string connectionOptions;
+        std::string location;
+        for (const char* line = statusEnd + 2; line < end;) {
+            const char* lineEnd = _findCRLF(line, end + 2);
+            const char* colon = std::find(line, lineEnd, ':');
+            if (colon != lineEnd) {
+                std::string name = _trim(line, colon);
+                std::string value = _trim(colon + 1, lineEnd);
+                std::string lowercaseName = _lowercase(name);
+                if (lowercaseName == "content-length") {
+                    contentLength = value;
+                } else if (lowercaseName == "transfer-encoding") {
+                    transferEncoding = _lowercase(value);
+                } else if (lowercaseName == "connection") {
+                    connectionOptions += _lowercase(value);
+                } else if (lowercaseName == "location") {
+                    location = value;
+                }
+
+                NSString* nsName = [NSString stringWithUTF8String:name.c_str()];
+                NSString* nsValue = [NSString stringWithUTF8String:value.c_str()];
+                if (lowercaseName.compare(0, 10, "set-cookie") == 0) {
+                    // Kept apart so that each Set-Cookie header reaches NSHTTPCookie whole, rather than joined with the others.
+                    [cookieFields setObject:nsValue forKey:[NSString stringWithFormat:@"%u", static_cast<unsigned>([cookieFields count])]];
+                }
+                NSString* existing = [headerFields objectForKey:nsName];
+                [headerFields setObject:(existing ? [NSString stringWithFormat:@"%@, %@", existing, nsValue] : nsValue) forKey:nsName];
+            }
+            line = lineEnd + 2;
+        }
+
+        bool chunked = transferEncoding.find("chunked") != std::string::npos;
+        if (major > 1 || (major == 1 && minor >= 1)) {
+            connection.keepAlive = connectionOptions.find("close") == std::string::npos;
+        } else {
+            connection.keepAlive = connectionOptions.find("keep-alive") != std::string::npos;
+        }
+
+        bool hasBody = true;
+        if (exchange->isHead || statusCode == 204 || statusCode == 304) {
+            hasBody = false;
+        } else if (chunked) {
+            connection.readState = _HTTPReadState::ChunkSize;
+        } else if (!contentLength.empty()) {
+            char* lengthEnd = nullptr;
+            connection.remaining = strtoull(contentLength.c_str(), &lengthEnd, 10);
+            if (*lengthEnd != '\0') {
+                _abandon(connection, _HTTPFailure::BadResponse);
+                return;
+            }
+            connection.readState = _HTTPReadState::FixedBody;
+            hasBody = connection.remaining > 0;
+        } else {
+            connection.readState = _HTTPReadState::UntilClose;
+            connection.keepAlive = false;
+        }
+
+        NSURLProtocol_HTTP* protocol = exchange->protocol;
+        if (!exchange->discardResponse && ![protocol cancelled]) {
+            NSURLRequest* request = protocol.request;
+            if ([request HTTPShouldHandleCookies] && [cookieFields count] > 0) {
+                NSArray* cookies = [NSHTTPCookie cookiesWithResponseHeaderFields:cookieFields forURL:[request URL]];
+                [[NSHTTPCookieStorage sharedHTTPCookieStorage] setCookies:cookies forURL:[request URL] mainDocumentURL:nil];
+            }
+
+            NSHTTPURLResponse* response = [[[NSHTTPURLResponse alloc] initWithURL:[request URL]
+                                                                       statusCode:statusCode
+                                                                      HTTPVersion:[NSString stringWithFormat:@"HTTP/%d.%d", major, minor]
+                                                                     headerFields:headerFields] autorelease];
+
+            if (statusCode >= 300 && statusCode <= 399 && statusCode != 304 && !location.empty()) {
+                // The rest of this response is read and dropped: the client will load the target with a new protocol.
+                exchange->discardResponse = true;
+                NSURL* targetURL = [NSURL URLWithString:[NSString stringWithUTF8String:location.c_str()] relativeToURL:[request URL]];
+                [protocol.client URLProtocol:protocol
+                      wasRedirectedToRequest:[NSURLRequest requestWithURL:targetURL]
+                            redirectResponse:response];
+            } else {
+                [protocol.client URLProtocol:protocol didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+            }
+        }
+
+        if (!hasBody) {
+            _complete(connection);
+        }
+    }
+
+    void _deliver(const std::shared_ptr<_HTTPExchange>& exchange, NSData* buffer, NSRange range) {
+        NSURLProtocol_HTTP* protocol = exchange->protocol;
+        if (range.length == 0 || exchange->discardResponse || [protocol cancelled]) {
+            return;
+        }
+
+        StrongId<_NSHTTPDataSlice> slice;
+        slice.attach([[_NSHTTPDataSlice alloc] initWithBuffer:buffer range:range]);
+        [protocol.client URLProtocol:protocol didLoadData:slice];
+    }
+
+    void _complete(_HTTPConnection& connection) {
+        auto exchange = connection.exchanges.front();
+        connection.exchanges.pop_front();
+        if (connection.writing == exchange) {
+            // The server answered before taking the whole body; what is left of it will not be sent.
+            connection.writing.reset();
+            connection.keepAlive = connection.keepAlive && exchange->bodyFinished;
+        }
+        connection.readState = _HTTPReadState::Head;
+        connection.remaining = 0;
+        ++connection.completed;
+
+        NSURLProtocol_HTTP* protocol = exchange->protocol;
+        if (!exchange->discardResponse && ![protocol cancelled]) {
+            [protocol.client URLProtocolDidFinishLoading:protocol];
+        }
+
+        if (!connection.keepAlive) {
+            // Requests pipelined behind this one will not be answered here.
+            _abandon(connection, _HTTPFailure::None);
+        }
+    }
+
+    // The peer closed the connection, or it failed.
+    void _closed(_HTTPConnection& connection) {
+        if (!connection.exchanges.empty() && connection.readState == _HTTPReadState::UntilClose) {
+            _complete(connection);
+            return;
+        }
+        _abandon(connection, connection.connecting ? _HTTPFailure::ConnectFailed : _HTTPFailure::ConnectionLost);
+    }
+
+    // Closes the connection. failure describes what happens to the request whose response was being read; any requests
+    // behind it never saw a byte of their responses, and go back to the front of the queue.
+    void _abandon(_HTTPConnection& connection, _HTTPFailure failure) {
+        auto exchanges = std::move(connection.exchanges);
+        connection.exchanges.clear();
+        connection.writing.reset();
+        connection.closed = true;
+        closesocket(connection.socket);
+        connection.socket = INVALID_SOCKET;
+
+        if (exchanges.empty()) {
+            return;
+        }
+
+        std::deque<std::shared_ptr<_HTTPExchange>> requeued;
+        if (failure != _HTTPFailure::None) {
+            auto head = exchanges.front();
+            exchanges.pop_front();
+            switch (failure) {
+                case _HTTPFailure::Cancelled:
+                    break;
+                case _HTTPFailure::ConnectFailed:
+                    _failExchange(head, NSURLErrorCannotConnectToHost);
+                    break;
+                case _HTTPFailure::TimedOut:
+                    _failExchange(head, NSURLErrorTimedOut);
+                    break;
+                case _HTTPFailure::BadResponse:
+                    _failExchange(head, NSURLErrorBadServerResponse);
+                    break;
+                case _HTTPFailure::BodyFailed:
+                    _failExchange(head, NSURLErrorRequestBodyStreamExhausted);
+                    break;
+                case _HTTPFailure::ConnectionLost:
+                    // A server may close a persistent connection just as a request is written to it. That is retried once,
+                    // on a fresh connection, if it is safe to repeat and its body can be produced again.
+                    bool rewindable = !head->bodyStream || (head->bodyRead == 0 && !head->bodyReadPending);
+                    if (!head->responseStarted && connection.completed > 0 && head->idempotent && rewindable && !head->retried) {
+                        head->retried = true;
+                        requeued.emplace_back(head);
+                    } else {
+                        _failExchange(head, NSURLErrorNetworkConnectionLost);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        requeued.insert(requeued.end(), exchanges.begin(), exchanges.end());
+        auto now = Clock::now();
+        for (auto it = requeued.rbegin(); it != requeued.rend(); ++it) {
+            (*it)->deadline = now + (*it)->timeout;
+            connection.host->pending.emplace_front(*it);
+        }
+    }
+
+    void _cancel(NSURLProtocol_HTTP* protocol, const std::string& hostKey) {
+        auto found = _hosts.find(hostKey);
+        if (found == _hosts.end()) {
+            return;
+        }
+
+        auto& host = found->second;
+        auto isCancelled = [protocol](const std::shared_ptr<_HTTPExchange>& exchange) { return exchange->protocol == protocol; };
+        host.pending.erase(std::remove_if(host.pending.begin(), host.pending.end(), isCancelled), host.pending.end());
+        for (auto& connection : host.connections) {
+            auto exchange = std::find_if(connection->exchanges.begin(), connection->exchanges.end(), isCancelled);
+            if (exchange == connection->exchanges.end()) {
+                continue;
+            }
+
+            if (exchange == connection->exchanges.begin()) {
+                // The rest of the response could be arbitrarily long: drop the connection rather than drain it.
+                _abandon(*connection, _HTTPFailure::Cancelled);
+            } else {
+                (*exchange)->discardResponse = true;
+            }
+            return;
+        }
+    }
+
+    void _expire() {
+        auto now = Clock::now();
+        for (auto& entry : _hosts) {
+            auto& host = entry.second;
+            while (!host.pending.empty() && host.pending.front()->deadline <= now) {
+                auto exchange = host.pending.front();
+                host.pending.pop_front();
+                _failExchange(exchange, NSURLErrorTimedOut);
+            }
+
+            for (size_t i = 0; i < host.connections.size(); ++i) {
+                auto& connection = *host.connections[i];
+                if (connection.closed) {
+                    continue;
+                }
+                if (connection.exchanges.empty()) {
+                    if (now - connection.lastActivity >= c_idleConnectionLifetime) {
+                        _abandon(connection, _HTTPFailure::None);
+                    }
+                } else if (now - connection.lastActivity >= connection.exchanges.front()->timeout) {
+                    // This also catches connection attempts that never complete.
+                    _abandon(connection, _HTTPFailure::TimedOut);
+                }
+            }
+        }
+    }
+
+    void _collect() {
+        for (auto it = _hosts.begin(); it != _hosts.end();) {
+            auto& connections = it->second.connections;
+            connections.erase(std::remove_if(connections.begin(),
+                                             connections.end(),
+                                             [](const std::unique_ptr<_HTTPConnection>& connection) { return connection->closed; }),
+                              connections.end());
+            if (connections.empty() && it->second.pending.empty()) {
+                it = _hosts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    SOCKET _wakeSocket;
+    std::mutex _commandMutex;
+    std::vector<std::function<void()>> _commands;
+    std::mutex _addressMutex;
+    std::unordered_map<std::string, _CachedAddress> _addresses;
+    std::unordered_map<std::string, _HTTPHost> _hosts;
+};
+
+// The Content-Length the caller set on the request, or -1 if there is none.
+static int64_t _declaredContentLength(NSURLRequest* request) {
+    NSDictionary* headers = [request allHTTPHeaderFields];
+    for (NSString* name in headers) {
+        if ([name caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame) {
+            return [[headers objectForKey:name] longLongValue];
+        }
+    }
+    return -1;
+}
+
+// Serializes the request line and headers; the body follows separately. A body of unknown length is sent chunked.
+static std::string _serializeRequestHead(NSURLRequest* request, const std::string& hostHeader, const _HTTPExchange& exchange) {
+    NSURL* url = request.URL;
+    NSURLComponents* components = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:YES];
+    NSString* target = [components percentEncodedPath];
+    if ([target length] == 0) {
+        target = @"/";
+    }
+    NSString* query = [components percentEncodedQuery];
+    if (query) {
+        target = [NSString stringWithFormat:@"%@?%@", target, query];
+    }
+
+    NSString* method = request.HTTPMethod ? request.HTTPMethod : @"GET";
+    NSMutableDictionary* headers = [[[request allHTTPHeaderFields] mutableCopy] autorelease];
+    if (!headers) {
+        headers = [NSMutableDictionary dictionary];
+    }
+    if ([request HTTPShouldHandleCookies]) {
+        NSArray* cookies = [[NSHTTPCookieStorage sharedHTTPCookieStorage] cookiesForURL:url];
+        [headers addEntriesFromDictionary:[NSHTTPCookie requestHeaderFieldsWithCookies:cookies]];
+    }
+
+    std::string serialized;
+    serialized.append([method UTF8String]).append(" ").append([target UTF8String]).append(" HTTP/1.1\r\n");
+    serialized.append("Host: ").append(hostHeader).append("\r\n");
+    for (NSString* name in headers) {
+        NSString* lowercaseName = [name lowercaseString];
+        if ([lowercaseName isEqualToString:@"host"] || [lowercaseName isEqualToString:@"content-length"] ||
+            [lowercaseName isEqualToString:@"transfer-encoding"]) {
+            continue;
+        }
+        serialized.append([name UTF8String]).append(": ").append([[headers objectForKey:name] UTF8String]).append("\r\n");
+    }
+
+    if (exchange.bodyLength < 0) {
+        serialized.append("Transfer-Encoding: chunked\r\n");
+    } else if (exchange.HasBody() || [method isEqualToString:@"POST"] || [method isEqualToString:@"PUT"]) {
+        serialized.append("Content-Length: ").append(std::to_string(exchange.bodyLength)).append("\r\n");
+    }
+    serialized.append("\r\n");
+    return serialized;
+}
+}
+
+@implementation NSURLProtocol_HTTP {
+    std::string _hostKey;
+    size_t _maximumConnections;
+    bool _started;
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest*)request {
+    return [[[request URL] scheme] caseInsensitiveCompare:@"http"] == NSOrderedSame;
+}
+
++ (NSURLRequest*)canonicalRequestForRequest:(NSURLRequest*)request {
+    return request;
+}
+
++ (NSUInteger)_connectionsOpened {
+    return s_connectionsOpened;
+}
+
++ (NSUInteger)_requestsSent {
+    return s_requestsSent;
+}
+
+- (instancetype)initWithRequest:(NSURLRequest*)request
+                 cachedResponse:(NSCachedURLResponse*)cachedResponse
+                         client:(id<NSURLProtocolClient>)client {
+    if (self = [super initWithRequest:request cachedResponse:cachedResponse client:client]) {
+        _maximumConnections = 6;
+        if ([static_cast<id>(client) isKindOfClass:[NSURLSessionTask class]]) {
+            NSURLSessionConfiguration* configuration = static_cast<NSURLSessionTask*>(client)._configuration;
+            if (configuration) {
+                _maximumConnections = std::max<NSInteger>(1, configuration.HTTPMaximumConnectionsPerHost);
+            }
+        }
+    }
+    return self;
+}
+
+- (void)startLoading {
+    @synchronized(self) {
+        if (_started) {
+            return;
+        }
+        _started = true;
+    }
+
+    NSURLRequest* request = self.request;
+    NSURL* url = request.URL;
+    NSString* host = url.host;
+    if ([host length] == 0) {
+        [self.client URLProtocol:self
+                didFailWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                     code:NSURLErrorBadURL
+                                                 userInfo:@{ NSURLErrorFailingURLErrorKey : url }]];
+        return;
+    }
+
+    unsigned short port = url.port ? [url.port unsignedShortValue] : c_defaultPort;
+    std::string hostName([host UTF8String]);
+    auto& pool = _HTTPConnectionPool::Get();
+    auto exchange = std::make_shared<_HTTPExchange>();
+    if (!pool.Resolve(hostName, port, &exchange->address, &exchange->addressLength)) {
+        [self.client URLProtocol:self
+                didFailWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                     code:NSURLErrorCannotFindHost
+                                                 userInfo:@{ NSURLErrorFailingURLErrorKey : url }]];
+        return;
+    }
+
+    std::string hostHeader = (hostName.find(':') != std::string::npos) ? "[" + hostName + "]" : hostName;
+    if (port != c_defaultPort) {
+        hostHeader += ":" + std::to_string(port);
+    }
+
+    NSString* method = request.HTTPMethod ? request.HTTPMethod : @"GET";
+    _hostKey = hostName + ":" + std::to_string(port);
+    exchange->protocol = self;
+    exchange->hostKey = _hostKey;
+    if (request.HTTPBodyStream) {
+        exchange->bodyStream = request.HTTPBodyStream;
+        exchange->bodyLength = _declaredContentLength(request);
+    } else {
+        exchange->bodyData = request.HTTPBody;
+        exchange->bodyLength = [request.HTTPBody length];
+    }
+    exchange->serialized = _serializeRequestHead(request, hostHeader, *exchange);
+    exchange->isHead = [method isEqualToString:@"HEAD"];
+    exchange->idempotent = exchange->isHead || [method isEqualToString:@"GET"] || [method isEqualToString:@"PUT"] ||
+                           [method isEqualToString:@"DELETE"] || [method isEqualToString:@"OPTIONS"];
+    exchange->pipelinable =
+        (exchange->isHead || [method isEqualToString:@"GET"]) && !exchange->HasBody() && request.HTTPShouldUsePipelining;
+    exchange->maximumConnections = _maximumConnections;
+    NSTimeInterval timeout = (request.timeoutInterval > 0) ? request.timeoutInterval : 60;
+    exchange->timeout = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+    pool.Enqueue(exchange);
+}
+
+- (void)stopLoading {
+    @synchronized(self) {
+        if (!_started || self.cancelled) {
+            return;
+        }
+        self.cancelled = true;
+    }
+    _HTTPConnectionPool::Get().Cancel(self, _hostKey);
+}
+@end
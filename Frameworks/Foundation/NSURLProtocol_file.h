@@ -16,13 +16,13 @@
 
 #include "Foundation/NSURLProtocol.h"
 
+// Streams file:// URLs to the client in chunks from a background queue. Large files are delivered as views into a read-only
+// mapping of the file, and a single "Range: bytes=" header is honored with a 206 or 416 response, as an HTTP server would.
 @interface NSURLProtocol_file : NSURLProtocol
-- (id)initWithRequest:(id)request cachedResponse:(id)response client:(id)client;
-- (id)startLoading;
-- (id)stopLoading;
-- (id)statusVersion:(id)versionStr;
-- (id)scheduleInRunLoop:(id)runLoop forMode:(id)mode;
-- (id)_doFileLoad;
-- (id)unscheduleFromRunLoop:(id)runLoop forMode:(id)mode;
-+ (BOOL)canInitWithRequest:(id)request;
+- (instancetype)initWithRequest:(NSURLRequest*)request
+                 cachedResponse:(NSCachedURLResponse*)cachedResponse
+                         client:(id<NSURLProtocolClient>)client;
+- (void)startLoading;
+- (void)stopLoading;
++ (BOOL)canInitWithRequest:(NSURLRequest*)request;
 @end
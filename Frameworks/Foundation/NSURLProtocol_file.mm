@@ -13,87 +13,370 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 //
-//******************************************************************************
 
 #import "Starboard.h"
-#import <Foundation/NSMutableString.h>
 #import <Foundation/NSURLProtocol.h>
-#import <Foundation/NSMutableArray.h>
-#import <Foundation/NSNumber.h>
 #import <Foundation/NSMutableData.h>
-#import <Foundation/NSMutableDictionary.h>
-#import <Foundation/NSRunLoop.h>
-#import <Foundation/NSTimer.h>
-#import <Foundation/NSStream.h>
 #import <Foundation/NSError.h>
+#import <Foundation/NSURLError.h>
 #import <Foundation/NSHTTPURLResponse.h>
+#import <Platform/EbrPlatform.h>
 #import "NSURLProtocol_file.h"
 #import "NSURLProtocolInternal.h"
 #import "LoggingNative.h"
 
+#include <windows.h>
+#include <fcntl.h>
+#include <share.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
 static const wchar_t* TAG = L"NSURLProtocol_file";
 
+// Files are read into buffers of this size, unless they are large enough to be mapped.
+static const size_t c_readChunkSize = 256 * 1024;
+// Loads of at least this many bytes are delivered as views of a read-only mapping, this many bytes at a time.
+static const uint64_t c_mappingThreshold = 8 * 1024 * 1024;
+static const size_t c_mappedChunkSize = 4 * 1024 * 1024;
+// Reading stops while the client holds on to this many delivered bytes, so that a slow consumer does not cause the whole
+// file to be buffered. A client that keeps every chunk is let through after c_windowStallLimit.
+static const size_t c_windowSize = 16 * 1024 * 1024;
+static const std::chrono::seconds c_windowStallLimit(2);
+static const std::chrono::milliseconds c_windowPollInterval(50);
+
+namespace {
+// The bytes delivered to the client and not yet released by it.
+struct _NSFileLoadWindow {
+    std::mutex mutex;
+    std::condition_variable released;
+    size_t outstanding = 0;
+};
+}
+
+// A chunk of a file, either copied into its own buffer or mapped. Gives its bytes back to the load window when released.
+@interface _NSFileChunk : NSData {
+    std::shared_ptr<_NSFileLoadWindow> _window;
+    void* _allocation;
+    bool _mapped;
+    const void* _bytes;
+    NSUInteger _length;
+}
+- (instancetype)initWithWindow:(const std::shared_ptr<_NSFileLoadWindow>&)window
+                    allocation:(void*)allocation
+                        mapped:(bool)mapped
+                         bytes:(const void*)bytes
+                        length:(NSUInteger)length;
+@end
+
+@implementation _NSFileChunk
+- (instancetype)initWithWindow:(const std::shared_ptr<_NSFileLoadWindow>&)window
+                    allocation:(void*)allocation
+                        mapped:(bool)mapped
+                         bytes:(const void*)bytes
+                        length:(NSUInteger)length {
+    if (self = [super init]) {
+        _window = window;
+        _allocation = allocation;
+        _mapped = mapped;
+        _bytes = bytes;
+        _length = length;
+
+        std::lock_guard<std::mutex> lock(_window->mutex);
+        _window->outstanding += _length;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_mapped) {
+        UnmapViewOfFile(_allocation);
+    } else {
+        free(_allocation);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_window->mutex);
+        _window->outstanding -= _length;
+    }
+    _window->released.notify_all();
+    _window = nullptr;
+    [super dealloc];
+}
+
+- (const void*)bytes {
+    return _bytes;
+}
+
+- (NSUInteger)length {
+    return _length;
+}
+
+- (id)copyWithZone:(NSZone*)zone {
+    return [self retain];
+}
+@end
+
+namespace {
+enum class _NSFileRange { Whole, Partial, Unsatisfiable };
+
+// Parses a single "bytes=" range against a file of size bytes. Anything else, including a list of ranges, is ignored
+// and the whole file is returned, as RFC 7233 allows.
+static _NSFileRange _parseRange(NSString* header, uint64_t size, uint64_t* first, uint64_t* last) {
+    if (!header) {
+        return _NSFileRange::Whole;
+    }
+
+    std::string spec([[header stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] UTF8String]);
+    if (_strnicmp(spec.c_str(), "bytes=", 6) != 0 || spec.find(',') != std::string::npos) {
+        return _NSFileRange::Whole;
+    }
+    spec.erase(0, 6);
+
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return _NSFileRange::Whole;
+    }
+
+    char* end = nullptr;
+    if (dash == 0) {
+        // "-N": the last N bytes.
+        uint64_t suffix = strtoull(spec.c_str() + 1, &end, 10);
+        if (*end != '\0' || end == spec.c_str() + 1) {
+            return _NSFileRange::Whole;
+        }
+        if (suffix == 0 || size == 0) {
+            return _NSFileRange::Unsatisfiable;
+        }
+        *first = (suffix < size) ? size - suffix : 0;
+        *last = size - 1;
+        return _NSFileRange::Partial;
+    }
+
+    *first = strtoull(spec.c_str(), &end, 10);
+    if (end != spec.c_str() + dash) {
+        return _NSFileRange::Whole;
+    }
+    *last = UINT64_MAX;
+    if (dash + 1 < spec.size()) {
+        *last = strtoull(spec.c_str() + dash + 1, &end, 10);
+        if (*end != '\0' || *last < *first) {
+            return _NSFileRange::Whole;
+        }
+    }
+
+    if (*first >= size) {
+        return _NSFileRange::Unsatisfiable;
+    }
+    *last = std::min(*last, size - 1);
+    return _NSFileRange::Partial;
+}
+}
+
 @implementation NSURLProtocol_file {
 @private
     StrongId<NSString> _path;
+    std::shared_ptr<_NSFileLoadWindow> _window;
+    std::atomic<bool> _cancelled;
+    bool _started;
 }
 
 + (void)load {
     [NSURLProtocol registerClass:self];
 }
 
-+ (BOOL)canInitWithRequest:(id)request {
-    id scheme = [[request URL] scheme];
-
-    if ([scheme isEqualToString:@"file"])
-        return YES;
-
-    return NO;
++ (BOOL)canInitWithRequest:(NSURLRequest*)request {
+    return [[[request URL] scheme] isEqualToString:@"file"];
 }
 
-- (id)initWithRequest:(id)request cachedResponse:(id)response client:(id)client {
-    if (self = [super initWithRequest:request cachedResponse:response client:client]) {
-        id url = [self.request URL];
+- (instancetype)initWithRequest:(NSURLRequest*)request
+                 cachedResponse:(NSCachedURLResponse*)cachedResponse
+                         client:(id<NSURLProtocolClient>)client {
+    if (self = [super initWithRequest:request cachedResponse:cachedResponse client:client]) {
+        NSURL* url = [self.request URL];
         TraceVerbose(TAG, L"Loading %hs", [[url absoluteString] UTF8String]);
 
         _path.attach([[url path] copy]);
+        _window = std::make_shared<_NSFileLoadWindow>();
+        _cancelled = false;
     }
 
     return self;
 }
 
-- (id)startLoading {
-    // TODO 1162: An NSInputStream should be initialized here and run loop events should be used to schedule
-    // the file operations.
-    return self;
+- (void)startLoading {
+    @synchronized(self) {
+        if (_started) {
+            return;
+        }
+        _started = true;
+    }
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        @autoreleasepool {
+            [self _streamFile];
+        }
+    });
 }
 
-- (id)stopLoading {
-    return self;
+- (void)stopLoading {
+    _cancelled = true;
+    _window->released.notify_all();
 }
 
-- (id)statusVersion:(id)versionStr {
-    return self;
+- (void)_failWithCode:(NSInteger)code {
+    NSURL* url = [self.request URL];
+    [self.client URLProtocol:self
+            didFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:code userInfo:@{ NSURLErrorFailingURLErrorKey : url }]];
 }
 
-- (id)scheduleInRunLoop:(id)runLoop forMode:(id)mode {
-    [runLoop performSelector:@selector(_doFileLoad) target:self argument:nil order:0 modes:[NSArray arrayWithObject:mode]];
-    return self;
+// Blocks while the client holds a full window of chunks. Returns false if the load was cancelled meanwhile.
+- (bool)_waitForWindow {
+    std::unique_lock<std::mutex> lock(_window->mutex);
+    auto stallLimit = std::chrono::steady_clock::now() + c_windowStallLimit;
+    while (_window->outstanding >= c_windowSize && !_cancelled && std::chrono::steady_clock::now() < stallLimit) {
+        _window->released.wait_for(lock, c_windowPollInterval);
+    }
+    return !_cancelled;
 }
 
-- (id)_doFileLoad {
-    NSData* dataReceived = [NSData dataWithContentsOfFile:_path];
+- (void)_streamFile {
+    NSURL* url = [self.request URL];
+    const char* path = [_path UTF8String];
+    if (EbrIsDir(path)) {
+        [self _failWithCode:NSURLErrorFileIsDirectory];
+        return;
+    }
 
-    id<NSURLProtocolClient> client = self.client;
-    [client URLProtocol:self didReceiveResponse:nil cacheStoragePolicy:NSURLCacheStorageAllowed];
-    [client URLProtocol:self didLoadData:dataReceived];
-    [client URLProtocolDidFinishLoading:self];
+    int fd = EbrOpenWithPermission(path, O_RDONLY | _O_BINARY, _SH_DENYNO, _S_IREAD);
+    if (fd < 0) {
+        [self _failWithCode:(errno == ENOENT) ? NSURLErrorFileDoesNotExist : NSURLErrorNoPermissionsToReadFile];
+        return;
+    }
 
-    return self;
-}
+    HANDLE mapping = nullptr;
+    auto cleanup = wil::ScopeExit([&]() {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        EbrClose(fd);
+    });
 
-- (id)unscheduleFromRunLoop:(id)runLoop forMode:(id)mode {
-    return self;
+    int64_t fileSize = EbrLseek(fd, 0, SEEK_END);
+    if (fileSize < 0) {
+        [self _failWithCode:NSURLErrorCannotOpenFile];
+        return;
+    }
+    uint64_t size = static_cast<uint64_t>(fileSize);
+
+    uint64_t first = 0;
+    uint64_t last = size - 1;
+    _NSFileRange range = _parseRange([self.request valueForHTTPHeaderField:@"Range"], size, &first, &last);
+    uint64_t length = (size == 0) ? 0 : last - first + 1;
+    NSString* contentType = @"application/octet-stream";
+
+    NSURLResponse* response;
+    if (range == _NSFileRange::Whole) {
+        first = 0;
+        length = size;
+        NSInteger expectedLength = (length <= NSIntegerMax) ? static_cast<NSInteger>(length) : NSURLResponseUnknownLength;
+        response = [[[NSURLResponse alloc] initWithURL:url MIMEType:contentType expectedContentLength:expectedLength textEncodingName:nil]
+            autorelease];
+    } else {
+        // Answer the way an HTTP server would, so that resumable downloads work against local files as well.
+        NSDictionary* headerFields;
+        NSInteger statusCode;
+        if (range == _NSFileRange::Partial) {
+            statusCode = 206;
+            headerFields = @{
+                @"Content-Range" : [NSString stringWithFormat:@"bytes %llu-%llu/%llu", first, last, size],
+                @"Content-Length" : [NSString stringWithFormat:@"%llu", length],
+                @"Content-Type" : contentType,
+                @"Accept-Ranges" : @"bytes",
+            };
+        } else {
+            statusCode = 416;
+            length = 0;
+            headerFields = @{
+                @"Content-Range" : [NSString stringWithFormat:@"bytes */%llu", size],
+                @"Content-Length" : @"0",
+            };
+        }
+        response = [[[NSHTTPURLResponse alloc] initWithURL:url statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headerFields]
+            autorelease];
+    }
+
+    if (_cancelled) {
+        return;
+    }
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+
+    if (length >= c_mappingThreshold) {
+        mapping = CreateFileMappingFromApp(reinterpret_cast<HANDLE>(EbrGetOSFHandle(fd)), nullptr, PAGE_READONLY, 0, nullptr);
+        if (!mapping) {
+            TraceWarning(TAG, L"Unable to map %hs (%u), reading it instead.", path, GetLastError());
+        }
+    }
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    uint64_t granularity = systemInfo.dwAllocationGranularity;
+
+    if (!mapping && EbrLseek(fd, first, SEEK_SET) < 0) {
+        [self _failWithCode:NSURLErrorCannotOpenFile];
+        return;
+    }
+
+    for (uint64_t offset = first, end = first + length; offset < end;) {
+        if (![self _waitForWindow]) {
+            return;
+        }
+
+        StrongId<_NSFileChunk> chunk;
+        if (mapping) {
+            // Views have to start on an allocation granularity boundary.
+            size_t chunkLength = static_cast<size_t>(std::min<uint64_t>(c_mappedChunkSize, end - offset));
+            uint64_t viewOffset = offset - (offset % granularity);
+            size_t viewLength = static_cast<size_t>(offset - viewOffset) + chunkLength;
+            void* view = MapViewOfFileFromApp(mapping, FILE_MAP_READ, viewOffset, viewLength);
+            if (!view) {
+                [self _failWithCode:NSURLErrorCannotOpenFile];
+                return;
+            }
+            chunk.attach([[_NSFileChunk alloc] initWithWindow:_window
+                                                   allocation:view
+                                                       mapped:true
+                                                        bytes:static_cast<uint8_t*>(view) + (offset - viewOffset)
+                                                       length:chunkLength]);
+            offset += chunkLength;
+        } else {
+            size_t chunkLength = static_cast<size_t>(std::min<uint64_t>(c_readChunkSize, end - offset));
+            void* buffer = malloc(chunkLength);
+            int read = EbrRead(fd, buffer, chunkLength);
+            if (read <= 0) {
+                free(buffer);
+                [self _failWithCode:NSURLErrorCannotOpenFile];
+                return;
+            }
+            chunk.attach([[_NSFileChunk alloc] initWithWindow:_window allocation:buffer mapped:false bytes:buffer length:read]);
+            offset += read;
+        }
+
+        if (_cancelled) {
+            return;
+        }
+        [self.client URLProtocol:self didLoadData:chunk];
+    }
+
+    if (!_cancelled) {
+        [self.client URLProtocolDidFinishLoading:self];
+    }
 }
 
 @end
@@ -242,10 +242,6 @@ static bool dispatchDelegateOptional(NSOperationQueue* queue, id object, SEL cmd
     return _taskDispatchThread;
 }
 
-- (void)_dispatchUnsupportedFailureToCompletionBlock:(NSURLSessionTaskCompletionHandler)completionHandler {
-    [self task:nil didCompleteWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:0 userInfo:nil]];
-}
-
 - (void)_registerDataTask:(NSURLSessionTask*)task withCompletionHandler:(NSURLSessionTaskCompletionHandler)completionHandler {
     std::lock_guard<std::mutex> lock(_mutex);
     if (completionHandler) {
@@ -406,19 +402,23 @@ static bool dispatchDelegateOptional(NSOperationQueue* queue, id object, SEL cmd
 }
 
 /**
-@Status Stub
+@Status Interoperable
 */
 - (NSURLSessionUploadTask*)uploadTaskWithRequest:(NSURLRequest*)request
                                         fromData:(NSData*)data
                                completionHandler:(NSURLSessionTaskCompletionHandler)completionHandler {
-    UNIMPLEMENTED();
+    _THROW_IF_NULL_REQUEST(request);
     if (_invalidating) {
         return nil;
     }
 
-    // stream data?
-    [self _dispatchUnsupportedFailureToCompletionBlock:completionHandler];
-    return nil;
+    NSURLSessionUploadTask* newTask = [[[NSURLSessionUploadTask alloc] _initWithTaskDelegate:self
+                                                                                  identifier:[self _nextTaskIdentifier]
+                                                                               configuration:_configuration
+                                                                                     request:request
+                                                                                    fromData:data] autorelease];
+    [self _registerDataTask:newTask withCompletionHandler:completionHandler];
+    return newTask;
 }
 
 /**
@@ -429,31 +429,42 @@ static bool dispatchDelegateOptional(NSOperationQueue* queue, id object, SEL cmd
 }
 
 /**
-@Status Stub
+@Status Caveat
+@Notes The file is streamed over plain http; https uploads read it into memory before sending.
 */
 - (NSURLSessionUploadTask*)uploadTaskWithRequest:(NSURLRequest*)request
                                         fromFile:(NSURL*)fileURL
                                completionHandler:(NSURLSessionTaskCompletionHandler)completionHandler {
-    UNIMPLEMENTED();
+    _THROW_IF_NULL_REQUEST(request);
     if (_invalidating) {
         return nil;
     }
 
-    [self _dispatchUnsupportedFailureToCompletionBlock:completionHandler];
-    return nil;
+    NSURLSessionUploadTask* newTask = [[[NSURLSessionUploadTask alloc] _initWithTaskDelegate:self
+                                                                                  identifier:[self _nextTaskIdentifier]
+                                                                               configuration:_configuration
+                                                                                     request:request
+                                                                                    fromFile:fileURL] autorelease];
+    [self _registerDataTask:newTask withCompletionHandler:completionHandler];
+    return newTask;
 }
 
 /**
-@Status Stub
+@Status Caveat
+@Notes The body stream is streamed over plain http; https uploads read it into memory before sending.
 */
 - (NSURLSessionUploadTask*)uploadTaskWithStreamedRequest:(NSURLRequest*)request {
-    UNIMPLEMENTED();
+    _THROW_IF_NULL_REQUEST(request);
     if (_invalidating) {
         return nil;
     }
 
-    [self _dispatchUnsupportedFailureToCompletionBlock:nil];
-    return nil;
+    NSURLSessionUploadTask* newTask = [[[NSURLSessionUploadTask alloc] _initWithTaskDelegate:self
+                                                                                  identifier:[self _nextTaskIdentifier]
+                                                                               configuration:_configuration
+                                                                             streamedRequest:request] autorelease];
+    [self _registerDataTask:newTask withCompletionHandler:nil];
+    return newTask;
 }
 
 /**
@@ -558,12 +569,13 @@ static bool dispatchDelegateOptional(NSOperationQueue* queue, id object, SEL cmd
         NSMutableArray* downloadTasks = [NSMutableArray array];
 
         for (NSURLSessionTask* task in _allTasks) {
-            if ([task isKindOfClass:[NSURLSessionDataTask class]]) {
+            // Upload tasks are data tasks too, so they are picked out first.
+            if ([task isKindOfClass:[NSURLSessionUploadTask class]]) {
+                [uploadTasks addObject:task];
+            } else if ([task isKindOfClass:[NSURLSessionDataTask class]]) {
                 [dataTasks addObject:task];
             } else if ([task isKindOfClass:[NSURLSessionDownloadTask class]]) {
                 [downloadTasks addObject:task];
-            } else if ([task isKindOfClass:[NSURLSessionUploadTask class]]) {
-                [uploadTasks addObject:task];
             }
         }
 
@@ -31,7 +31,7 @@ enum HttpStatus : int {
 };
 #pragma endregion
 
-@interface NSURLSessionTask () {
+@interface NSURLSessionTask () <_NSURLProtocolClientBodyProgress> {
     NSURLProtocol* _protocolConnection;
     NSURLSessionConfiguration* _configuration;
 }
@@ -39,11 +39,22 @@ enum HttpStatus : int {
 
 @implementation NSURLSessionTask
 @synthesize _taskDelegate = _taskDelegate;
+@synthesize _configuration = _configuration;
 
 + (Class)_protocolClassForRequest:(NSURLRequest*)request {
     return [NSURLProtocol _URLProtocolClassForRequest:request];
 }
 
+// Protocol classes named by the session configuration are consulted, in order, ahead of the registered ones.
+- (Class)_protocolClassForCurrentRequest {
+    for (Class protocolClass in _configuration.protocolClasses) {
+        if ([protocolClass canInitWithRequest:_currentRequest]) {
+            return protocolClass;
+        }
+    }
+    return [[self class] _protocolClassForRequest:_currentRequest];
+}
+
 - (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
                  identifier:(NSUInteger)identifier
               configuration:(NSURLSessionConfiguration*)configuration
@@ -165,7 +176,7 @@ enum HttpStatus : int {
 
 - (void)__startLoadingThread {
     if (!_protocolConnection) {
-        Class protocolClass = [[self class] _protocolClassForRequest:_currentRequest];
+        Class protocolClass = [self _protocolClassForCurrentRequest];
         if (!protocolClass || ![protocolClass canInitWithRequest:_currentRequest]) {
             NSError* error = [NSError
                 errorWithDomain:NSCocoaErrorDomain
@@ -304,6 +315,15 @@ enum HttpStatus : int {
     self.countOfBytesReceived = self.countOfBytesReceived + [data length];
 }
 
+- (void)URLProtocol:(NSURLProtocol*)connection
+             didSendBodyData:(int64_t)bytesSent
+              totalBytesSent:(int64_t)totalBytesSent
+    totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
+    self.countOfBytesSent = totalBytesSent;
+    self.countOfBytesExpectedToSend = totalBytesExpectedToSend;
+    [_taskDelegate task:self didSendBodyData:bytesSent totalBytesSent:totalBytesSent totalBytesExpectedToSend:totalBytesExpectedToSend];
+}
+
 /**
  @Status Interoperable
 */
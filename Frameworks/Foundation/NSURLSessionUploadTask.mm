@@ -14,8 +14,144 @@
 //
 //******************************************************************************
 
-#import <StubReturn.h>
-#import <Foundation/NSURLSession.h>
+#import <Foundation/Foundation.h>
+#import <Starboard.h>
+#import <objc/runtime.h>
+#import "NSURLSessionTask-Internal.h"
+#import "NSURLProtocol_HTTP.h"
+
+@interface NSURLSessionUploadTask () {
+    // A streamed upload asks the session for its body stream when it is first resumed, and only starts once the stream
+    // arrives; resuming it again while the request is outstanding does nothing.
+    bool _needsBodyStream;
+    bool _bodyStreamRequested;
+    StrongId<NSError> _bodyError;
+}
+@end
 
 @implementation NSURLSessionUploadTask
++ (Class)_protocolClassForRequest:(NSURLRequest*)request {
+    // Protocols registered with +[NSURLProtocol registerClass:] come first. Only the default protocol, which needs the
+    // whole body in memory before it sends any of it, is swapped for the pooled one, which streams it.
+    static Class winHTTPProtocolClass = objc_getClass("NSURLProtocol_WinHTTP");
+    Class protocolClass = [super _protocolClassForRequest:request];
+    if (protocolClass == winHTTPProtocolClass && [NSURLProtocol_HTTP canInitWithRequest:request]) {
+        return [NSURLProtocol_HTTP class];
+    }
+    return protocolClass;
+}
+
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+                    request:(NSURLRequest*)request
+                   fromData:(NSData*)data {
+    NSMutableURLRequest* uploadRequest = [[request mutableCopy] autorelease];
+    uploadRequest.HTTPBodyStream = nil;
+    uploadRequest.HTTPBody = data;
+    if (self = [self _initWithTaskDelegate:taskDelegate identifier:identifier configuration:configuration request:uploadRequest]) {
+        self.countOfBytesExpectedToSend = [data length];
+    }
+    return self;
+}
+
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+                    request:(NSURLRequest*)request
+                   fromFile:(NSURL*)fileURL {
+    // The file is read a piece at a time as it is sent, so its length is declared up front.
+    NSDictionary* attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[fileURL path] error:nil];
+    NSMutableURLRequest* uploadRequest = [[request mutableCopy] autorelease];
+    uploadRequest.HTTPBody = nil;
+    if (attributes) {
+        uploadRequest.HTTPBodyStream = [NSInputStream inputStreamWithURL:fileURL];
+        [uploadRequest setValue:[NSString stringWithFormat:@"%llu", [attributes fileSize]] forHTTPHeaderField:@"Content-Length"];
+    }
+
+    if (self = [self _initWithTaskDelegate:taskDelegate identifier:identifier configuration:configuration request:uploadRequest]) {
+        if (attributes) {
+            self.countOfBytesExpectedToSend = [attributes fileSize];
+        } else {
+            _bodyError = [NSError errorWithDomain:NSURLErrorDomain
+                                             code:NSURLErrorFileDoesNotExist
+                                         userInfo:@{ NSURLErrorFailingURLErrorKey : fileURL }];
+        }
+    }
+    return self;
+}
+
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+            streamedRequest:(NSURLRequest*)request {
+    // Any body already on the request is ignored in favour of the stream the session provides.
+    NSMutableURLRequest* uploadRequest = [[request mutableCopy] autorelease];
+    uploadRequest.HTTPBody = nil;
+    uploadRequest.HTTPBodyStream = nil;
+    if (self = [self _initWithTaskDelegate:taskDelegate identifier:identifier configuration:configuration request:uploadRequest]) {
+        _needsBodyStream = true;
+    }
+    return self;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)resume {
+    @synchronized(self) {
+        if (self.state != NSURLSessionTaskStateSuspended) {
+            return;
+        }
+
+        if (_bodyError) {
+            StrongId<NSError> error = _bodyError;
+            _bodyError = nil;
+            self.state = NSURLSessionTaskStateRunning;
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [self _signalCompletionInState:NSURLSessionTaskStateCompleted withError:error];
+            });
+            return;
+        }
+
+        if (_bodyStreamRequested) {
+            return;
+        }
+
+        if (_needsBodyStream) {
+            _bodyStreamRequested = true;
+            [self _requestBodyStream];
+            return;
+        }
+    }
+
+    [super resume];
+}
+
+- (void)_requestBodyStream {
+    auto continuation = ^(NSInputStream* bodyStream) {
+        if (!bodyStream) {
+            @synchronized(self) {
+                _bodyStreamRequested = false;
+                self.state = NSURLSessionTaskStateRunning;
+            }
+            [self _signalCompletionInState:NSURLSessionTaskStateCompleted
+                                 withError:[NSError errorWithDomain:NSURLErrorDomain
+                                                               code:NSURLErrorRequestBodyStreamExhausted
+                                                           userInfo:@{ NSURLErrorFailingURLErrorKey : self.currentRequest.URL }]];
+            return;
+        }
+
+        @synchronized(self) {
+            NSMutableURLRequest* request = [[self.currentRequest mutableCopy] autorelease];
+            request.HTTPBodyStream = bodyStream;
+            self.currentRequest = request;
+            _needsBodyStream = false;
+            _bodyStreamRequested = false;
+        }
+        [super resume];
+    };
+
+    [self._taskDelegate task:self needNewBodyStream:continuation];
+}
 @end
@@ -21,6 +21,7 @@
 #import "CGImageSourceInternal.h"
 #import <ImageIO/ImageIO.h>
 #include <NSLogging.h>
+#include <Instrumentation.h>
 #import <Starboard.h>
 #import <StubReturn.h>
 #import <objc/runtime.h>
@@ -1661,6 +1662,7 @@ CGImageRef CGImageSourceCreateImageAtIndex(CGImageSourceRef isrc, size_t index,
     // This API returns a reference to an image only if the current source status is either Incomplete or Complete 
     RETURN_NULL_IF(source.loadStatus != kCGImageStatusIncomplete && source.loadStatus != kCGImageStatusComplete);
     RETURN_NULL_IF(index > (CGImageSourceGetCount(isrc) - 1));
+    INSTRUMENT_SPAN("ImageIO", "CGImageSource.createImage");
 
     MULTI_QI imageQueryInterface = { 0 };
     static const GUID IID_IWICImagingFactory = { 0xec5ec8a9, 0xc395, 0x4314, 0x9c, 0x77, 0x54, 0xd7, 0xa9, 0x35, 0xff, 0x70 };
@@ -1702,6 +1704,7 @@ CGImageRef CGImageSourceCreateThumbnailAtIndex(CGImageSourceRef isrc, size_t ind
     NSData* imageData = ((ImageSource*)isrc).data;
     RETURN_NULL_IF(!imageData);
     RETURN_NULL_IF(index > (CGImageSourceGetCount(isrc) - 1));
+    INSTRUMENT_SPAN("ImageIO", "CGImageSource.createThumbnail");
 
     MULTI_QI imageQueryInterface = { 0 };
     static const GUID IID_IWICImagingFactory = { 0xec5ec8a9, 0xc395, 0x4314, 0x9c, 0x77, 0x54, 0xd7, 0xa9, 0x35, 0xff, 0x70 };
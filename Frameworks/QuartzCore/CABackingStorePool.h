@@ -0,0 +1,68 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <CoreGraphics/CGContext.h>
+
+#include <deque>
+#include <mutex>
+
+// Implemented in CALayer.mm
+CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float scale);
+
+// Pool of layer backing stores (32bpp bitmap contexts backed by display textures), bucketed by pixel size and scale.
+// CALayer hands its backing store back here when it is resized or torn down, and draws into a recycled one
+// instead of allocating a fresh texture when a matching bucket is available.
+class CABackingStorePool {
+public:
+    static CABackingStorePool& Shared();
+
+    // Returns a +1 bitmap context of exactly width x height pixels at the given scale, or nullptr on failure.
+    // Recycled contexts have their pixels cleared before they are returned.
+    CGContextRef Acquire(int width, int height, float scale);
+
+    // Takes ownership of the caller's reference to context.
+    // Contexts whose backing image is still referenced elsewhere are released instead of pooled.
+    void Recycle(CGContextRef context, float scale);
+
+    // Releases every pooled context.
+    void Purge();
+
+    size_t GetPooledCount();
+    size_t GetPooledBytes();
+
+    // Pool limits; exceeding either evicts the least recently recycled backing stores.
+    static const size_t c_maxPooledCount = 16;
+    static const size_t c_maxPooledBytes = 32 * 1024 * 1024;
+
+private:
+    struct Entry {
+        CGContextRef context;
+        int width;
+        int height;
+        float scale;
+
+        size_t GetBytes() const {
+            return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+        }
+    };
+
+    void _TrimLocked();
+
+    std::mutex _lock;
+    std::deque<Entry> _entries;
+    size_t _pooledBytes = 0;
+};
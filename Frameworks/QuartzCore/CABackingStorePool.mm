@@ -0,0 +1,122 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Starboard.h>
+#import "CABackingStorePool.h"
+#import "CGContextInternal.h"
+
+#include "LoggingNative.h"
+
+static const wchar_t* TAG = L"CABackingStorePool";
+
+static const bool DEBUG_VERBOSE = false;
+
+CABackingStorePool& CABackingStorePool::Shared() {
+    static CABackingStorePool s_pool;
+    return s_pool;
+}
+
+CGContextRef CABackingStorePool::Acquire(int width, int height, float scale) {
+    CGContextRef context = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+
+        // Search from the most recently recycled entry; it is the most likely to still be resident.
+        for (auto it = _entries.rbegin(); it != _entries.rend(); ++it) {
+            if (it->width == width && it->height == height && it->scale == scale) {
+                context = it->context;
+                _pooledBytes -= it->GetBytes();
+                _entries.erase(std::next(it).base());
+                break;
+            }
+        }
+    }
+
+    if (context == nullptr) {
+        return CreateLayerContentsBitmapContext32(width, height, scale);
+    }
+
+    if (DEBUG_VERBOSE) {
+        TraceVerbose(TAG, L"Reusing %dx%d@%.1f backing store", width, height, scale);
+    }
+
+    // Recycled stores still hold their previous owner's pixels.
+    _CGContextPushBeginDraw(context);
+    CGContextSaveGState(context);
+    CGContextClearRect(context, CGRectMake(0, 0, width / scale, height / scale));
+    CGContextRestoreGState(context);
+    _CGContextPopEndDraw(context);
+
+    return context;
+}
+
+void CABackingStorePool::Recycle(CGContextRef context, float scale) {
+    if (context == nullptr) {
+        return;
+    }
+
+    // If anyone other than the context itself still references its image (for instance a CGImage handed out
+    // through the layer's presentation), the pixels can't be reused.
+    CGImageRef image = _CGBitmapContextGetImage(context);
+    if (image == nullptr || CFGetRetainCount(image) > 1 || CFGetRetainCount(context) > 1) {
+        CGContextRelease(context);
+        return;
+    }
+
+    Entry entry{ context, static_cast<int>(CGImageGetWidth(image)), static_cast<int>(CGImageGetHeight(image)), scale };
+    if (entry.GetBytes() > c_maxPooledBytes) {
+        CGContextRelease(context);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.push_back(entry);
+    _pooledBytes += entry.GetBytes();
+    _TrimLocked();
+}
+
+void CABackingStorePool::Purge() {
+    std::deque<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        entries.swap(_entries);
+        _pooledBytes = 0;
+    }
+
+    for (auto& entry : entries) {
+        CGContextRelease(entry.context);
+    }
+}
+
+size_t CABackingStorePool::GetPooledCount() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
+
+size_t CABackingStorePool::GetPooledBytes() {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _pooledBytes;
+}
+
+void CABackingStorePool::_TrimLocked() {
+    while (!_entries.empty() && (_entries.size() > c_maxPooledCount || _pooledBytes > c_maxPooledBytes)) {
+        Entry& oldest = _entries.front();
+        _pooledBytes -= oldest.GetBytes();
+        CGContextRelease(oldest.context);
+        _entries.pop_front();
+    }
+}
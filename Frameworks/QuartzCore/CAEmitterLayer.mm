@@ -16,7 +16,20 @@
 
 #include "Starboard.h"
 #include "QuartzCore/CAEmitterLayer.h"
-#include "CAEmitterCellInternal.h"
+#include "QuartzCore/CAEmitterCell.h"
+#include "QuartzCore/CADisplayLink.h"
+#include "QuartzCore/CoreAnimationFunctions.h"
+#include "CAEmitterLayerInternal.h"
+#include "CGContextInternal.h"
+#include "LoggingNative.h"
+
+#include <algorithm>
+#include <math.h>
+
+static const wchar_t* TAG = L"CAEmitterLayer";
+
+// Longest interval simulated in one tick, so a stalled frame doesn't fling particles across the layer.
+static const CFTimeInterval c_maxStepInterval = 0.1;
 
 NSString* const kCAEmitterLayerPoint = @"kCAEmitterLayerPoint";
 NSString* const kCAEmitterLayerLine = @"kCAEmitterLayerLine";
@@ -34,57 +47,318 @@ NSString* const kCAEmitterLayerOldestLast = @"kCAEmitterLayerOldestLast";
 NSString* const kCAEmitterLayerBackToFront = @"kCAEmitterLayerBackToFront";
 NSString* const kCAEmitterLayerAdditive = @"kCAEmitterLayerAdditive";
 
-// TODO improve performance and change the replay time to 1 second.
+namespace {
+
+CAParticleCellParameters _ParametersFromCell(CAEmitterCell* cell, int32_t parentCell) {
+    CAParticleCellParameters parameters;
+    parameters.birthRate = cell.birthRate;
+    parameters.lifetime = cell.lifetime;
+    parameters.lifetimeRange = cell.lifetimeRange;
+    parameters.velocity = cell.velocity;
+    parameters.velocityRange = cell.velocityRange;
+    parameters.xAcceleration = cell.xAcceleration;
+    parameters.yAcceleration = cell.yAcceleration;
+    parameters.emissionLongitude = cell.emissionLongitude;
+    parameters.emissionLatitude = cell.emissionLatitude;
+    parameters.emissionRange = cell.emissionRange;
+    parameters.scale = cell.scale;
+    parameters.scaleRange = cell.scaleRange;
+    parameters.scaleSpeed = cell.scaleSpeed;
+    parameters.spin = cell.spin;
+    parameters.spinRange = cell.spinRange;
+
+    if (CGColorRef color = cell.color) {
+        // Colors are always stored as RGBA.
+        const CGFloat* components = CGColorGetComponents(color);
+        std::copy(components, components + 4, parameters.color);
+    }
+
+    parameters.colorRange[0] = cell.redRange;
+    parameters.colorRange[1] = cell.greenRange;
+    parameters.colorRange[2] = cell.blueRange;
+    parameters.colorRange[3] = cell.alphaRange;
+    parameters.colorSpeed[0] = cell.redSpeed;
+    parameters.colorSpeed[1] = cell.greenSpeed;
+    parameters.colorSpeed[2] = cell.blueSpeed;
+    parameters.colorSpeed[3] = cell.alphaSpeed;
+    parameters.parentCell = parentCell;
+    return parameters;
+}
+
+CAEmitterShape _ShapeFromString(NSString* shape) {
+    if ([shape isEqualToString:kCAEmitterLayerLine]) {
+        return CAEmitterShape::Line;
+    } else if ([shape isEqualToString:kCAEmitterLayerRectangle]) {
+        return CAEmitterShape::Rectangle;
+    } else if ([shape isEqualToString:kCAEmitterLayerCuboid]) {
+        return CAEmitterShape::Cuboid;
+    } else if ([shape isEqualToString:kCAEmitterLayerCircle]) {
+        return CAEmitterShape::Circle;
+    } else if ([shape isEqualToString:kCAEmitterLayerSphere]) {
+        return CAEmitterShape::Sphere;
+    }
+
+    return CAEmitterShape::Point;
+}
+
+CAEmitterMode _ModeFromString(NSString* mode) {
+    if ([mode isEqualToString:kCAEmitterLayerPoints]) {
+        return CAEmitterMode::Points;
+    } else if ([mode isEqualToString:kCAEmitterLayerOutline]) {
+        return CAEmitterMode::Outline;
+    } else if ([mode isEqualToString:kCAEmitterLayerSurface]) {
+        return CAEmitterMode::Surface;
+    }
+
+    return CAEmitterMode::Volume;
+}
+
+// The source region of cell's contents that each particle draws, in pixels, or CGRectNull if the cell has no contents.
+CGRect _SpriteSourceRect(CAEmitterCell* cell) {
+    CGImageRef contents = static_cast<CGImageRef>(cell.contents);
+    if (contents == nullptr) {
+        return CGRectNull;
+    }
+
+    CGRect unitRect = cell.contentsRect;
+    CGFloat imageWidth = CGImageGetWidth(contents);
+    CGFloat imageHeight = CGImageGetHeight(contents);
+    return CGRectMake(unitRect.origin.x * imageWidth,
+                      unitRect.origin.y * imageHeight,
+                      unitRect.size.width * imageWidth,
+                      unitRect.size.height * imageHeight);
+}
+
+inline bool _IsParticleVisible(const CAParticleBuffer& particles, size_t i) {
+    return particles.alpha[i] > 0.0f && particles.scale[i] != 0.0f;
+}
+
+// Bounds of every visible particle of one cell. A particle is drawn centered on its position and may be rotated, so
+// its sprite's half diagonal, scaled, bounds it in every direction.
+CGRect _ParticleBatchBounds(CAEmitterCell* cell, const CAParticleBuffer& particles) {
+    CGRect source = _SpriteSourceRect(cell);
+    if (particles.count == 0 || CGRectIsNull(source)) {
+        return CGRectNull;
+    }
+
+    float radius = hypotf(source.size.width, source.size.height) / 2.0f;
+    float minX = INFINITY;
+    float minY = INFINITY;
+    float maxX = -INFINITY;
+    float maxY = -INFINITY;
+    for (size_t i = 0; i < particles.count; ++i) {
+        if (!_IsParticleVisible(particles, i)) {
+            continue;
+        }
+
+        float extent = radius * fabsf(particles.scale[i]);
+        minX = std::min(minX, particles.x[i] - extent);
+        minY = std::min(minY, particles.y[i] - extent);
+        maxX = std::max(maxX, particles.x[i] + extent);
+        maxY = std::max(maxY, particles.y[i] + extent);
+    }
+
+    return minX <= maxX ? CGRectMake(minX, minY, maxX - minX, maxY - minY) : CGRectNull;
+}
+
+// Draws every visible particle of one cell that intersects clip in a single batch, tinted by its color.
+void _DrawParticleBatch(CGContextRef context, CGRect clip, CAEmitterCell* cell, const CAParticleBuffer& particles) {
+    CGRect source = _SpriteSourceRect(cell);
+    if (particles.count == 0 || CGRectIsNull(source)) {
+        return;
+    }
+
+    float radius = hypotf(source.size.width, source.size.height) / 2.0f;
+    std::vector<CGAffineTransform> transforms;
+    std::vector<float> colors;
+    transforms.reserve(particles.count);
+    colors.reserve(particles.count * 4);
+
+    for (size_t i = 0; i < particles.count; ++i) {
+        if (!_IsParticleVisible(particles, i)) {
+            continue;
+        }
+
+        float extent = radius * fabsf(particles.scale[i]);
+        if (!CGRectIntersectsRect(clip, CGRectMake(particles.x[i] - extent, particles.y[i] - extent, extent * 2.0f, extent * 2.0f))) {
+            continue;
+        }
+
+        CGAffineTransform transform = CGAffineTransformMakeTranslation(particles.x[i], particles.y[i]);
+        transform = CGAffineTransformRotate(transform, particles.rotation[i]);
+        transform = CGAffineTransformScale(transform, particles.scale[i], particles.scale[i]);
+        transforms.emplace_back(transform);
+
+        colors.insert(colors.end(), { particles.red[i], particles.green[i], particles.blue[i], particles.alpha[i] });
+    }
+
+    _CGContextDrawImageSprites(context,
+                               static_cast<CGImageRef>(cell.contents),
+                               source,
+                               source.size,
+                               transforms.data(),
+                               colors.data(),
+                               transforms.size());
+}
+
+} // namespace
+
 @implementation CAEmitterLayer {
     idretaintype(NSArray) _emitterCells;
-    idretaintype(NSTimer) _replayTimer;
+    StrongId<CADisplayLink> _displayLink;
+    CFTimeInterval _lastStepTime;
+    // Where particles were last drawn; a tick redraws this and where they are now, rather than the whole layer.
+    CGRect _drawnParticleBounds;
+
+    CAParticleSystem _particleSystem;
+    // The CAEmitterCell behind each of _particleSystem's cells, by index.
+    std::vector<StrongId<CAEmitterCell>> _particleCells;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _birthRate = 1.0f;
+        _lifetime = 1.0f;
+        _velocity = 1.0f;
+        _scale = 1.0f;
+        _spin = 1.0f;
+        _drawnParticleBounds = CGRectNull;
+    }
+
+    return self;
 }
 
-- (void)generateCALayersFromEmitterCells:(NSTimer*)withTimer {
-    if (_emitterCells == nil || self.hidden || self.superlayer == nil) {
-        [self endReplayingEmitters];
+- (void)dealloc {
+    [_displayLink invalidate];
+    [super dealloc];
+}
+
+- (void)_addParticleCell:(CAEmitterCell*)cell parent:(int32_t)parentCell {
+    // Disabled cells don't emit, and neither do their sub-cells.
+    if (!cell.enabled) {
         return;
     }
-    NSUInteger count = [_emitterCells count];
-    // Go through my emitter cells and add them to my subview.
-    for (NSUInteger i = 0; i < count; i++) {
-        CAEmitterCell* emitterCell = ((CAEmitterCell*)[_emitterCells objectAtIndex:i]);
-        CALayer* ca = [emitterCell generateCALayerFromEmitterCell:_emitterPosition
-                                             withParentOffsetLong:0
-                                              withParentOffsetLat:0
-                                                withParentCALayer:self
-                                              withBabyEmitterCell:nil];
 
-        [self addSublayer:ca];
+    size_t index = _particleSystem.AddCell(_ParametersFromCell(cell, parentCell));
+    _particleCells.emplace_back(cell);
+
+    for (CAEmitterCell* subcell in cell.emitterCells) {
+        [self _addParticleCell:subcell parent:static_cast<int32_t>(index)];
     }
 }
 
-- (void)startReplayingEmitters {
-    [self endReplayingEmitters];
-    // Set to 2 seconds to reduce latency on low end devices.
-    _replayTimer = [NSTimer scheduledTimerWithTimeInterval:2.0
-                                                    target:self
-                                                  selector:@selector(generateCALayersFromEmitterCells:)
-                                                  userInfo:nil
-                                                   repeats:YES];
+- (void)_resetParticleSystem {
+    _particleSystem.RemoveAllCells();
+    _particleCells.clear();
+    _particleSystem.SetSeed(_seed);
+
+    for (CAEmitterCell* cell in static_cast<NSArray*>(_emitterCells)) {
+        [self _addParticleCell:cell parent:-1];
+    }
 }
 
-- (void)endReplayingEmitters {
-    if (_replayTimer != nil) {
-        [_replayTimer invalidate];
-        _replayTimer = nil;
+- (CAParticleEmitterParameters)_emitterParameters {
+    CAParticleEmitterParameters emitter;
+    emitter.shape = _ShapeFromString(_emitterShape);
+    emitter.mode = _ModeFromString(_emitterMode);
+    emitter.positionX = _emitterPosition.x;
+    emitter.positionY = _emitterPosition.y;
+    emitter.width = _emitterSize.width;
+    emitter.height = _emitterSize.height;
+    emitter.depth = _emitterDepth;
+    emitter.birthRate = _birthRate;
+    emitter.lifetime = _lifetime;
+    emitter.velocity = _velocity;
+    emitter.scale = _scale;
+    emitter.spin = _spin;
+    return emitter;
+}
+
+- (void)_advanceParticles:(CFTimeInterval)dt {
+    _particleSystem.SetEmitter([self _emitterParameters]);
+    _particleSystem.Step(static_cast<float>(dt));
+}
+
+- (size_t)_particleCount {
+    return _particleSystem.GetParticleCount();
+}
+
+- (CGRect)_particleBounds {
+    CGRect bounds = CGRectNull;
+    for (size_t i = 0; i < _particleSystem.GetCellCount(); ++i) {
+        bounds = CGRectUnion(bounds, _ParticleBatchBounds(_particleCells[i], _particleSystem.GetParticles(i)));
     }
+
+    // Leave room for antialiased edges.
+    return CGRectIsNull(bounds) ? bounds : CGRectIntegral(CGRectInset(bounds, -1.0f, -1.0f));
+}
+
+- (void)_startEmitting {
+    if (_displayLink != nil) {
+        return;
+    }
+
+    _lastStepTime = CACurrentMediaTime();
+    _displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(_displayLinkFired:)];
+    [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSDefaultRunLoopMode];
+}
+
+- (void)_stopEmitting {
+    [_displayLink invalidate];
+    _displayLink = nil;
+}
+
+- (void)_displayLinkFired:(CADisplayLink*)displayLink {
+    // The display link retains the layer, so stop as soon as there's nothing to show; the next display restarts it.
+    if ([_emitterCells count] == 0 || self.hidden || self.superlayer == nil) {
+        TraceVerbose(TAG, L"Stopping particle simulation for emitter layer %p", self);
+        [self _stopEmitting];
+        return;
+    }
+
+    CFTimeInterval now = CACurrentMediaTime();
+    [self _advanceParticles:std::min(now - _lastStepTime, c_maxStepInterval)];
+    _lastStepTime = now;
+
+    // Erase the particles where they were and draw them where they are; the rest of the layer keeps its pixels.
+    CGRect bounds = [self _particleBounds];
+    [self setNeedsDisplayInRect:CGRectUnion(_drawnParticleBounds, bounds)];
+    _drawnParticleBounds = bounds;
+}
+
+/**
+ @Status Caveat
+ @Notes emitterZPosition and preservesDepth have no effect.
+*/
+- (void)drawInContext:(CGContextRef)context {
+    if ([_emitterCells count] > 0) {
+        [self _startEmitting];
+    }
+
+    CGContextSaveGState(context);
+    if ([_renderMode isEqualToString:kCAEmitterLayerAdditive]) {
+        CGContextSetBlendMode(context, kCGBlendModePlusLighter);
+    }
+
+    // Only particles inside the region being redrawn need to be drawn.
+    CGRect clip = CGContextGetClipBoundingBox(context);
+    for (size_t i = 0; i < _particleSystem.GetCellCount(); ++i) {
+        _DrawParticleBatch(context, clip, _particleCells[i], _particleSystem.GetParticles(i));
+    }
+
+    CGContextRestoreGState(context);
 }
 
 /**
  @Status Interoperable
+ @Notes Replaces any live particles. Changes made to the cells after they are set take effect the next time emitterCells is set.
 */
 - (void)setEmitterCells:(NSArray*)emitterCells {
     _emitterCells = [NSArray arrayWithArray:emitterCells];
 
-    [self generateCALayersFromEmitterCells:_replayTimer];
-    [self setNeedsLayout];
-    [self startReplayingEmitters];
+    [self _resetParticleSystem];
+    _drawnParticleBounds = CGRectNull;
+    [self setNeedsDisplay];
 }
 
 /**
@@ -16,6 +16,18 @@
 
 #include "Starboard.h"
 #include "QuartzCore/CAKeyframeAnimation.h"
+#include "QuartzCore/CATransform3D.h"
+#include "CoreGraphics/CGColor.h"
+
+#include "CACompositor.h"
+#include "CAAnimationInternal.h"
+#include "CAKeyframeAnimationInternal.h"
+#include "LoggingNative.h"
+
+#include <algorithm>
+#include <string.h>
+
+static const wchar_t* TAG = L"CAKeyframeAnimation";
 
 NSString* const kCAAnimationLinear = @"kCAAnimationLinear";
 NSString* const kCAAnimationDiscrete = @"kCAAnimationDiscrete";
@@ -25,7 +37,182 @@ NSString* const kCAAnimationCubicPaced = @"kCAAnimationCubicPaced";
 NSString* const kCAAnimationRotateAuto = @"kCAAnimationRotateAuto";
 NSString* const kCAAnimationRotateAutoReverse = @"kCAAnimationRotateAutoReverse";
 
-@implementation CAKeyframeAnimation
+namespace {
+
+// The compositor interpolates linearly between samples of the track; curved and timed segments get this many samples
+// each, up to c_maxCompositorSamples for the whole animation.
+const size_t c_compositorSamplesPerSegment = 16;
+const size_t c_maxCompositorSamples = 512;
+
+// The types keyframe values can be interpolated as; each maps to a fixed number of float components.
+enum class KeyframeValueType { Unsupported, Number, Point, Size, Rect, Color, Transform };
+
+size_t _ComponentCountForType(KeyframeValueType type) {
+    switch (type) {
+        case KeyframeValueType::Number:
+            return 1;
+        case KeyframeValueType::Point:
+        case KeyframeValueType::Size:
+            return 2;
+        case KeyframeValueType::Rect:
+        case KeyframeValueType::Color:
+            return 4;
+        case KeyframeValueType::Transform:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+KeyframeValueType _ValueType(id value) {
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return KeyframeValueType::Number;
+    }
+
+    if ([value isKindOfClass:[NSValue class]]) {
+        const char* type = [static_cast<NSValue*>(value) objCType];
+        if (strcmp(type, @encode(CGPoint)) == 0) {
+            return KeyframeValueType::Point;
+        } else if (strcmp(type, @encode(CGSize)) == 0) {
+            return KeyframeValueType::Size;
+        } else if (strcmp(type, @encode(CGRect)) == 0) {
+            return KeyframeValueType::Rect;
+        } else if (strcmp(type, @encode(CATransform3D)) == 0) {
+            return KeyframeValueType::Transform;
+        }
+    }
+
+    // CGColors are UIColors underneath, which QuartzCore can't link against directly.
+    static Class s_colorClass = NSClassFromString(@"UIColor");
+    if (s_colorClass && [value isKindOfClass:s_colorClass]) {
+        return KeyframeValueType::Color;
+    }
+
+    return KeyframeValueType::Unsupported;
+}
+
+void _GetComponents(id value, KeyframeValueType type, float* components) {
+    switch (type) {
+        case KeyframeValueType::Number:
+            components[0] = [value floatValue];
+            break;
+        case KeyframeValueType::Point: {
+            CGPoint point = [value CGPointValue];
+            components[0] = point.x;
+            components[1] = point.y;
+            break;
+        }
+        case KeyframeValueType::Size: {
+            CGSize size = [value CGSizeValue];
+            components[0] = size.width;
+            components[1] = size.height;
+            break;
+        }
+        case KeyframeValueType::Rect: {
+            CGRect rect = [value CGRectValue];
+            components[0] = rect.origin.x;
+            components[1] = rect.origin.y;
+            components[2] = rect.size.width;
+            components[3] = rect.size.height;
+            break;
+        }
+        case KeyframeValueType::Color: {
+            // Colors are always stored as RGBA.
+            const CGFloat* rgba = CGColorGetComponents(static_cast<CGColorRef>(value));
+            std::copy(rgba, rgba + 4, components);
+            break;
+        }
+        case KeyframeValueType::Transform: {
+            // Transforms are interpolated element-wise rather than decomposed.
+            CATransform3D transform = [value CATransform3DValue];
+            memcpy(components, transform.m, sizeof(transform.m));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+id _ValueFromComponents(KeyframeValueType type, const float* components) {
+    switch (type) {
+        case KeyframeValueType::Number:
+            return [NSNumber numberWithFloat:components[0]];
+        case KeyframeValueType::Point:
+            return [NSValue valueWithCGPoint:CGPointMake(components[0], components[1])];
+        case KeyframeValueType::Size:
+            return [NSValue valueWithCGSize:CGSizeMake(components[0], components[1])];
+        case KeyframeValueType::Rect:
+            return [NSValue valueWithCGRect:CGRectMake(components[0], components[1], components[2], components[3])];
+        case KeyframeValueType::Color: {
+            CGFloat rgba[] = { components[0], components[1], components[2], components[3] };
+            CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+            id color = [static_cast<id>(CGColorCreate(colorSpace, rgba)) autorelease];
+            CGColorSpaceRelease(colorSpace);
+            return color;
+        }
+        case KeyframeValueType::Transform: {
+            CATransform3D transform;
+            memcpy(transform.m, components, sizeof(transform.m));
+            return [NSValue valueWithCATransform3D:transform];
+        }
+        default:
+            return nil;
+    }
+}
+
+CAKeyframeTrack::CalculationMode _CalculationModeFromString(NSString* mode) {
+    if ([mode isEqualToString:kCAAnimationDiscrete]) {
+        return CAKeyframeTrack::CalculationMode::Discrete;
+    } else if ([mode isEqualToString:kCAAnimationPaced]) {
+        return CAKeyframeTrack::CalculationMode::Paced;
+    } else if ([mode isEqualToString:kCAAnimationCubic]) {
+        return CAKeyframeTrack::CalculationMode::Cubic;
+    } else if ([mode isEqualToString:kCAAnimationCubicPaced]) {
+        return CAKeyframeTrack::CalculationMode::CubicPaced;
+    }
+
+    return CAKeyframeTrack::CalculationMode::Linear;
+}
+
+CAKeyframeTrack::RotationMode _RotationModeFromString(NSString* mode) {
+    if ([mode isEqualToString:kCAAnimationRotateAuto]) {
+        return CAKeyframeTrack::RotationMode::Auto;
+    } else if ([mode isEqualToString:kCAAnimationRotateAutoReverse]) {
+        return CAKeyframeTrack::RotationMode::AutoReverse;
+    }
+
+    return CAKeyframeTrack::RotationMode::None;
+}
+
+// Converts an NSArray of NSNumbers to floats; returns nullptr if the array is empty so the track treats it as absent.
+const float* _FloatsFromArray(NSArray* array, std::vector<float>& storage) {
+    storage.clear();
+    for (NSNumber* number in array) {
+        storage.push_back([number floatValue]);
+    }
+
+    return storage.empty() ? nullptr : storage.data();
+}
+
+} // namespace
+
+@implementation CAKeyframeAnimation {
+    StrongId<NSArray> _values;
+    StrongId<NSArray> _keyTimes;
+    StrongId<NSArray> _timingFunctions;
+    StrongId<NSString> _calculationMode;
+    StrongId<NSString> _rotationMode;
+    StrongId<NSArray> _tensionValues;
+    StrongId<NSArray> _continuityValues;
+    StrongId<NSArray> _biasValues;
+    CGPathRef _path;
+
+    // Built on first evaluation, and rebuilt after any property that feeds it changes.
+    CAKeyframeTrack _track;
+    KeyframeValueType _valueType;
+    bool _trackValid;
+}
+
 /**
  @Status Caveat
  @Notes Only position, bounds, and transform properties supported
@@ -33,4 +220,323 @@ NSString* const kCAAnimationRotateAutoReverse = @"kCAAnimationRotateAutoReverse"
 + (instancetype)animationWithKeyPath:(NSString*)path {
     return [super animationWithKeyPath:path];
 }
+
+/**
+ @Status Interoperable
+*/
+- (void)setValues:(NSArray*)values {
+    _values.attach([values copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)values {
+    return _values;
+}
+
+/**
+ @Status Interoperable
+ @Notes When set, the path takes precedence over values.
+*/
+- (void)setPath:(CGPathRef)path {
+    CGPathRef old = _path;
+    _path = path ? CGPathRetain(path) : nullptr;
+    if (old) {
+        CGPathRelease(old);
+    }
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (CGPathRef)path {
+    return _path;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setKeyTimes:(NSArray*)keyTimes {
+    _keyTimes.attach([keyTimes copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)keyTimes {
+    return _keyTimes;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setTimingFunctions:(NSArray*)timingFunctions {
+    _timingFunctions.attach([timingFunctions copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)timingFunctions {
+    return _timingFunctions;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setCalculationMode:(NSString*)calculationMode {
+    _calculationMode.attach([calculationMode copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSString*)calculationMode {
+    return _calculationMode ? static_cast<NSString*>(_calculationMode) : kCAAnimationLinear;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setRotationMode:(NSString*)rotationMode {
+    _rotationMode.attach([rotationMode copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSString*)rotationMode {
+    return _rotationMode;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setTensionValues:(NSArray*)tensionValues {
+    _tensionValues.attach([tensionValues copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)tensionValues {
+    return _tensionValues;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setContinuityValues:(NSArray*)continuityValues {
+    _continuityValues.attach([continuityValues copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)continuityValues {
+    return _continuityValues;
+}
+
+/**
+ @Status Interoperable
+*/
+- (void)setBiasValues:(NSArray*)biasValues {
+    _biasValues.attach([biasValues copy]);
+    _trackValid = false;
+}
+
+/**
+ @Status Interoperable
+*/
+- (NSArray*)biasValues {
+    return _biasValues;
+}
+
+- (void)_buildTrack {
+    _trackValid = true;
+
+    CAKeyframeTrack::Parameters parameters;
+    parameters.calculationMode = _CalculationModeFromString(_calculationMode);
+    parameters.rotationMode = _RotationModeFromString(_rotationMode);
+
+    std::vector<float> keyTimes;
+    parameters.keyTimes = _FloatsFromArray(_keyTimes, keyTimes);
+    parameters.keyTimeCount = keyTimes.size();
+
+    // The curves live in the timing functions, which _timingFunctions keeps alive for as long as the track.
+    std::vector<const CATimingCurve*> timingCurves;
+    for (CAMediaTimingFunction* function in static_cast<NSArray*>(_timingFunctions)) {
+        timingCurves.push_back([function isKindOfClass:[CAMediaTimingFunction class]] ? [function _timingCurve] : nullptr);
+    }
+    parameters.timingCurves = timingCurves.data();
+    parameters.timingCurveCount = timingCurves.size();
+
+    if (_path) {
+        _valueType = KeyframeValueType::Point;
+        _track.InitWithPath(_path, parameters);
+        return;
+    }
+
+    NSArray* values = _values;
+    _valueType = values.count > 0 ? _ValueType(values[0]) : KeyframeValueType::Unsupported;
+    size_t componentCount = _ComponentCountForType(_valueType);
+
+    // Path-only rotation doesn't apply to values.
+    parameters.rotationMode = CAKeyframeTrack::RotationMode::None;
+
+    std::vector<float> components(values.count * componentCount);
+    for (NSUInteger i = 0; i < values.count; ++i) {
+        if (_ValueType(values[i]) != _valueType) {
+            TraceVerbose(TAG, L"Keyframe values must all have the same type; animation for %hs will not interpolate", [_keyPath UTF8String]);
+            _valueType = KeyframeValueType::Unsupported;
+            break;
+        }
+        _GetComponents(values[i], _valueType, &components[i * componentCount]);
+    }
+
+    // Kochanek-Bartels parameters need one entry per key to be meaningful.
+    std::vector<float> tension;
+    std::vector<float> continuity;
+    std::vector<float> bias;
+    if ([_tensionValues count] == values.count) {
+        parameters.tensionValues = _FloatsFromArray(_tensionValues, tension);
+    }
+    if ([_continuityValues count] == values.count) {
+        parameters.continuityValues = _FloatsFromArray(_continuityValues, continuity);
+    }
+    if ([_biasValues count] == values.count) {
+        parameters.biasValues = _FloatsFromArray(_biasValues, bias);
+    }
+
+    if (_valueType == KeyframeValueType::Unsupported) {
+        _track = CAKeyframeTrack();
+        return;
+    }
+
+    _track.InitWithValues(components.data(), values.count, componentCount, parameters);
+}
+
+- (const CAKeyframeTrack*)_track {
+    if (!_trackValid) {
+        [self _buildTrack];
+    }
+
+    return _track.IsValid() ? &_track : nullptr;
+}
+
+- (id)_valueForProgress:(float)progress {
+    const CAKeyframeTrack* track = [self _track];
+    if (!track) {
+        return nil;
+    }
+
+    float components[CAKeyframeTrack::c_maxComponents + 1];
+    track->Evaluate(progress, components);
+    return _ValueFromComponents(_valueType, components);
+}
+
+- (std::shared_ptr<ILayerAnimation>)_createAnimation:(CALayer*)layer forKey:(id)forKey {
+    _attachedLayer = layer;
+
+    if (_keyPath == nil) {
+        _keyPath = forKey;
+    }
+
+    const CAKeyframeTrack* track = [self _track];
+    if (!track) {
+        TraceVerbose(TAG, L"Keyframe animation for %hs has no interpolatable values", [_keyPath UTF8String]);
+        return nullptr;
+    }
+
+    // Hand the compositor the track sampled at even steps of time, with the animation's timing function applied, so
+    // intermediate keyframes, path curvature and per-segment timing all reach the screen. A path track with a rotation
+    // mode also produces the tangent angle, which becomes a second keyframe animation of the layer's rotation.
+    size_t componentCount = _ComponentCountForType(_valueType);
+    bool rotates = track->GetComponentCount() > componentCount;
+    size_t sampleCount = std::min(track->GetSegmentCount() * c_compositorSamplesPerSegment, c_maxCompositorSamples) + 1;
+    NSMutableArray* values = [NSMutableArray arrayWithCapacity:sampleCount];
+    NSMutableArray* rotations = rotates ? [NSMutableArray arrayWithCapacity:sampleCount] : nil;
+    float components[CAKeyframeTrack::c_maxComponents + 1];
+    for (size_t i = 0; i < sampleCount; ++i) {
+        float time = static_cast<float>(i) / (sampleCount - 1);
+        track->Evaluate(applyMediaTimingFunction(_timingProperties._timingFunction, time), components);
+        [values addObject:_ValueFromComponents(_valueType, components)];
+        if (rotates) {
+            [rotations addObject:[NSNumber numberWithFloat:components[componentCount]]];
+        }
+    }
+
+    _runningAnimation = _globalCompositor->CreateKeyframeAnimation(self, _keyPath, values, &_timingProperties);
+
+    if (rotates && _runningAnimation) {
+        std::shared_ptr<ILayerAnimation> rotation =
+            _globalCompositor->CreateKeyframeAnimation(self, @"transform.rotation.z", rotations, &_timingProperties);
+        if (rotation) {
+            _globalCompositor->AttachKeyframeAnimation(_runningAnimation, rotation);
+        }
+    }
+
+    return _runningAnimation;
+}
+
+/**
+ @Status Interoperable
+ @Public No
+*/
+- (id)copyWithZone:(NSZone*)zone {
+    CAKeyframeAnimation* ret = [super copyWithZone:zone];
+
+    ret->_values.attach([_values copy]);
+    ret->_keyTimes.attach([_keyTimes copy]);
+    ret->_timingFunctions.attach([_timingFunctions copy]);
+    ret->_calculationMode.attach([_calculationMode copy]);
+    ret->_rotationMode.attach([_rotationMode copy]);
+    ret->_tensionValues.attach([_tensionValues copy]);
+    ret->_continuityValues.attach([_continuityValues copy]);
+    ret->_biasValues.attach([_biasValues copy]);
+    ret->_path = _path ? CGPathRetain(_path) : nullptr;
+
+    return ret;
+}
+
+- (void)dealloc {
+    if (_path) {
+        CGPathRelease(_path);
+    }
+    [super dealloc];
+}
+
 @end
+
+size_t _CAKeyframeAnimationGetComponentCount(CAKeyframeAnimation* animation) {
+    const CAKeyframeTrack* track = [animation _track];
+    return track ? track->GetComponentCount() : 0;
+}
+
+void _CAKeyframeAnimationEvaluateBatch(CAKeyframeAnimation* const* animations,
+                                       const float* progress,
+                                       float* results,
+                                       size_t resultStride,
+                                       size_t count) {
+    // Resolve tracks a chunk at a time so the evaluation loop itself stays free of message sends.
+    static const size_t c_chunkSize = 256;
+    const CAKeyframeTrack* tracks[c_chunkSize];
+
+    for (size_t start = 0; start < count; start += c_chunkSize) {
+        size_t chunk = std::min(c_chunkSize, count - start);
+        for (size_t i = 0; i < chunk; ++i) {
+            tracks[i] = [animations[start + i] _track];
+        }
+
+        CAKeyframeTrackEvaluateBatch(tracks, progress + start, results + start * resultStride, resultStride, chunk);
+    }
+}
@@ -0,0 +1,512 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "Starboard.h"
+#include "CAKeyframeAnimationInternal.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define CA_KEYFRAME_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+inline float _Clamp01(float value) {
+    return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+// Kochanek-Bartels tangent at a key, given the neighbouring keys; outgoing selects the tangent leaving the key.
+void _KochanekBartelsTangent(const float* previous,
+                             const float* key,
+                             const float* next,
+                             size_t componentCount,
+                             float tension,
+                             float continuity,
+                             float bias,
+                             bool outgoing,
+                             float* tangent) {
+    float incomingWeight = (1.0f - tension) * (outgoing ? (1.0f + continuity) : (1.0f - continuity)) * (1.0f + bias) * 0.5f;
+    float outgoingWeight = (1.0f - tension) * (outgoing ? (1.0f - continuity) : (1.0f + continuity)) * (1.0f - bias) * 0.5f;
+    for (size_t i = 0; i < componentCount; ++i) {
+        tangent[i] = incomingWeight * (key[i] - previous[i]) + outgoingWeight * (next[i] - key[i]);
+    }
+}
+
+struct PathElement {
+    CGPathElementType type;
+    float points[6];
+};
+
+void _CollectPathElement(void* info, const CGPathElement* element) {
+    PathElement collected{ element->type, {} };
+    size_t pointCount = 0;
+    switch (element->type) {
+        case kCGPathElementMoveToPoint:
+        case kCGPathElementAddLineToPoint:
+            pointCount = 1;
+            break;
+        case kCGPathElementAddQuadCurveToPoint:
+            pointCount = 2;
+            break;
+        case kCGPathElementAddCurveToPoint:
+            pointCount = 3;
+            break;
+        case kCGPathElementCloseSubpath:
+            break;
+    }
+
+    for (size_t i = 0; i < pointCount; ++i) {
+        collected.points[i * 2] = static_cast<float>(element->points[i].x);
+        collected.points[i * 2 + 1] = static_cast<float>(element->points[i].y);
+    }
+
+    static_cast<std::vector<PathElement>*>(info)->push_back(collected);
+}
+
+} // namespace
+
+void CAKeyframeTrack::_AddSegment(const float* a, const float* b, const float* c, const float* d) {
+    Segment segment{};
+    segment.coefficientOffset = static_cast<uint32_t>(_coefficients.size());
+    segment.arcLengthOffset = -1;
+
+    _coefficients.insert(_coefficients.end(), a, a + _componentCount);
+    _coefficients.insert(_coefficients.end(), b, b + _componentCount);
+    _coefficients.insert(_coefficients.end(), c, c + _componentCount);
+    _coefficients.insert(_coefficients.end(), d, d + _componentCount);
+
+    _segments.push_back(segment);
+}
+
+float CAKeyframeTrack::_SegmentLength(size_t index, bool needsTable) {
+    Segment& segment = _segments[index];
+    const float* a = &_coefficients[segment.coefficientOffset];
+    const float* b = a + _componentCount;
+    const float* c = b + _componentCount;
+    const float* d = c + _componentCount;
+
+    bool curved = false;
+    float chord = 0.0f;
+    for (size_t i = 0; i < _componentCount; ++i) {
+        curved |= (a[i] != 0.0f || b[i] != 0.0f);
+        chord += c[i] * c[i];
+    }
+
+    if (!curved) {
+        return sqrtf(chord);
+    }
+
+    // Sample the curve; the normalized cumulative lengths become the segment's arc-length table when pacing.
+    float cumulative[c_arcLengthSamples + 1];
+    float previous[c_maxComponents];
+    std::copy(d, d + _componentCount, previous);
+
+    float length = 0.0f;
+    cumulative[0] = 0.0f;
+    for (size_t sample = 1; sample <= c_arcLengthSamples; ++sample) {
+        float u = static_cast<float>(sample) / c_arcLengthSamples;
+        float distance = 0.0f;
+        for (size_t i = 0; i < _componentCount; ++i) {
+            float value = ((a[i] * u + b[i]) * u + c[i]) * u + d[i];
+            distance += (value - previous[i]) * (value - previous[i]);
+            previous[i] = value;
+        }
+
+        length += sqrtf(distance);
+        cumulative[sample] = length;
+    }
+
+    if (needsTable && length > 0.0f) {
+        segment.arcLengthOffset = static_cast<int32_t>(_arcLengths.size());
+        for (float value : cumulative) {
+            _arcLengths.push_back(value / length);
+        }
+    }
+
+    return length;
+}
+
+bool CAKeyframeTrack::_FinishSegments(const Parameters& parameters) {
+    size_t count = _segments.size();
+    if (count == 0) {
+        return false;
+    }
+
+    // Every mode expects one key time per segment boundary.
+    std::vector<float> boundaries(count + 1);
+    bool haveBoundaries = false;
+
+    if (_paced) {
+        // Paced animations ignore key times and move at constant speed, so each segment's share of the duration is its share of the length.
+        std::vector<float> lengths(count);
+        float total = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            lengths[i] = _SegmentLength(i, true);
+            total += lengths[i];
+        }
+
+        if (total > 0.0f) {
+            float elapsed = 0.0f;
+            for (size_t i = 0; i < count; ++i) {
+                boundaries[i] = elapsed / total;
+                elapsed += lengths[i];
+            }
+            boundaries[count] = 1.0f;
+            haveBoundaries = true;
+        }
+    } else if (parameters.keyTimes && parameters.keyTimeCount == count + 1) {
+        float previous = 0.0f;
+        for (size_t i = 0; i <= count; ++i) {
+            boundaries[i] = std::max(previous, _Clamp01(parameters.keyTimes[i]));
+            previous = boundaries[i];
+        }
+        haveBoundaries = true;
+    }
+
+    if (!haveBoundaries) {
+        for (size_t i = 0; i <= count; ++i) {
+            boundaries[i] = static_cast<float>(i) / count;
+        }
+    }
+
+    _startTimes.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Segment& segment = _segments[i];
+        float duration = boundaries[i + 1] - boundaries[i];
+        segment.startTime = boundaries[i];
+        segment.inverseDuration = duration > 0.0f ? 1.0f / duration : 0.0f;
+        segment.timing = (!_paced && i < parameters.timingCurveCount && parameters.timingCurves) ? parameters.timingCurves[i] : nullptr;
+        _startTimes[i] = segment.startTime;
+    }
+
+    return true;
+}
+
+bool CAKeyframeTrack::InitWithValues(const float* values, size_t keyCount, size_t componentCount, const Parameters& parameters) {
+    *this = CAKeyframeTrack();
+    if (values == nullptr || keyCount == 0 || componentCount == 0 || componentCount > c_maxComponents) {
+        return false;
+    }
+
+    _componentCount = componentCount;
+    _paced = (parameters.calculationMode == CalculationMode::Paced || parameters.calculationMode == CalculationMode::CubicPaced);
+
+    auto key = [values, componentCount](size_t index) { return values + index * componentCount; };
+    const float zero[c_maxComponents] = {};
+
+    if (keyCount == 1) {
+        _AddSegment(zero, zero, zero, key(0));
+        return _FinishSegments(parameters);
+    }
+
+    switch (parameters.calculationMode) {
+        case CalculationMode::Discrete:
+            for (size_t i = 0; i < keyCount; ++i) {
+                _AddSegment(zero, zero, zero, key(i));
+            }
+            break;
+
+        case CalculationMode::Linear:
+        case CalculationMode::Paced:
+            for (size_t i = 0; i + 1 < keyCount; ++i) {
+                float delta[c_maxComponents];
+                for (size_t c = 0; c < componentCount; ++c) {
+                    delta[c] = key(i + 1)[c] - key(i)[c];
+                }
+                _AddSegment(zero, zero, delta, key(i));
+            }
+            break;
+
+        case CalculationMode::Cubic:
+        case CalculationMode::CubicPaced:
+            for (size_t i = 0; i + 1 < keyCount; ++i) {
+                const float* p0 = key(i);
+                const float* p1 = key(i + 1);
+                const float* previous = key(i > 0 ? i - 1 : 0);
+                const float* next = key(std::min(i + 2, keyCount - 1));
+
+                auto parameter = [](const float* values, size_t index) { return values ? values[index] : 0.0f; };
+
+                float m0[c_maxComponents];
+                float m1[c_maxComponents];
+                _KochanekBartelsTangent(previous,
+                                        p0,
+                                        p1,
+                                        componentCount,
+                                        parameter(parameters.tensionValues, i),
+                                        parameter(parameters.continuityValues, i),
+                                        parameter(parameters.biasValues, i),
+                                        true,
+                                        m0);
+                _KochanekBartelsTangent(p0,
+                                        p1,
+                                        next,
+                                        componentCount,
+                                        parameter(parameters.tensionValues, i + 1),
+                                        parameter(parameters.continuityValues, i + 1),
+                                        parameter(parameters.biasValues, i + 1),
+                                        false,
+                                        m1);
+
+                // Hermite basis expanded into polynomial coefficients.
+                float a[c_maxComponents];
+                float b[c_maxComponents];
+                for (size_t c = 0; c < componentCount; ++c) {
+                    a[c] = 2.0f * p0[c] - 2.0f * p1[c] + m0[c] + m1[c];
+                    b[c] = -3.0f * p0[c] + 3.0f * p1[c] - 2.0f * m0[c] - m1[c];
+                }
+                _AddSegment(a, b, m0, p0);
+            }
+            break;
+    }
+
+    return _FinishSegments(parameters);
+}
+
+bool CAKeyframeTrack::InitWithPath(CGPathRef path, const Parameters& parameters) {
+    *this = CAKeyframeTrack();
+    if (path == nullptr) {
+        return false;
+    }
+
+    std::vector<PathElement> elements;
+    CGPathApply(path, &elements, _CollectPathElement);
+
+    if (parameters.calculationMode == CalculationMode::Discrete) {
+        // Discrete path animations jump between the path's vertices.
+        std::vector<float> vertices;
+        float subpathStart[2] = {};
+        for (const PathElement& element : elements) {
+            switch (element.type) {
+                case kCGPathElementMoveToPoint:
+                    subpathStart[0] = element.points[0];
+                    subpathStart[1] = element.points[1];
+                    vertices.insert(vertices.end(), element.points, element.points + 2);
+                    break;
+                case kCGPathElementAddLineToPoint:
+                    vertices.insert(vertices.end(), element.points, element.points + 2);
+                    break;
+                case kCGPathElementAddQuadCurveToPoint:
+                    vertices.insert(vertices.end(), element.points + 2, element.points + 4);
+                    break;
+                case kCGPathElementAddCurveToPoint:
+                    vertices.insert(vertices.end(), element.points + 4, element.points + 6);
+                    break;
+                case kCGPathElementCloseSubpath:
+                    vertices.insert(vertices.end(), subpathStart, subpathStart + 2);
+                    break;
+            }
+        }
+
+        if (!InitWithValues(vertices.data(), vertices.size() / 2, 2, parameters)) {
+            return false;
+        }
+        _rotationMode = parameters.rotationMode;
+        return true;
+    }
+
+    _componentCount = 2;
+    _rotationMode = parameters.rotationMode;
+    _paced = (parameters.calculationMode == CalculationMode::Paced || parameters.calculationMode == CalculationMode::CubicPaced);
+
+    const float zero[2] = {};
+    float current[2] = {};
+    float subpathStart[2] = {};
+
+    auto addLine = [this, &zero, &current](const float* to) {
+        float delta[2] = { to[0] - current[0], to[1] - current[1] };
+        _AddSegment(zero, zero, delta, current);
+        current[0] = to[0];
+        current[1] = to[1];
+    };
+
+    // Cubic Bezier P0..P3 in power basis.
+    auto addCurve = [this, &current](const float* p1, const float* p2, const float* p3) {
+        float a[2];
+        float b[2];
+        float c[2];
+        for (size_t i = 0; i < 2; ++i) {
+            a[i] = -current[i] + 3.0f * p1[i] - 3.0f * p2[i] + p3[i];
+            b[i] = 3.0f * current[i] - 6.0f * p1[i] + 3.0f * p2[i];
+            c[i] = 3.0f * (p1[i] - current[i]);
+        }
+        _AddSegment(a, b, c, current);
+        current[0] = p3[0];
+        current[1] = p3[1];
+    };
+
+    for (const PathElement& element : elements) {
+        switch (element.type) {
+            case kCGPathElementMoveToPoint:
+                current[0] = subpathStart[0] = element.points[0];
+                current[1] = subpathStart[1] = element.points[1];
+                break;
+
+            case kCGPathElementAddLineToPoint:
+                addLine(element.points);
+                break;
+
+            case kCGPathElementAddQuadCurveToPoint: {
+                // Degree-elevate the quadratic to a cubic.
+                const float* control = element.points;
+                const float* end = element.points + 2;
+                float p1[2];
+                float p2[2];
+                for (size_t i = 0; i < 2; ++i) {
+                    p1[i] = current[i] + (2.0f / 3.0f) * (control[i] - current[i]);
+                    p2[i] = end[i] + (2.0f / 3.0f) * (control[i] - end[i]);
+                }
+                addCurve(p1, p2, end);
+                break;
+            }
+
+            case kCGPathElementAddCurveToPoint:
+                addCurve(element.points, element.points + 2, element.points + 4);
+                break;
+
+            case kCGPathElementCloseSubpath:
+                if (current[0] != subpathStart[0] || current[1] != subpathStart[1]) {
+                    addLine(subpathStart);
+                }
+                break;
+        }
+    }
+
+    if (_segments.empty()) {
+        // A path that is only a move still has a position.
+        _AddSegment(zero, zero, zero, current);
+    }
+
+    return _FinishSegments(parameters);
+}
+
+float CAKeyframeTrack::_RemapArcLength(const Segment& segment, float distance) const {
+    const float* table = &_arcLengths[segment.arcLengthOffset];
+    size_t sample = std::upper_bound(table, table + c_arcLengthSamples + 1, distance) - table;
+    sample = (sample < 1) ? 0 : (sample > c_arcLengthSamples) ? c_arcLengthSamples - 1 : sample - 1;
+
+    float span = table[sample + 1] - table[sample];
+    float fraction = span > 0.0f ? (distance - table[sample]) / span : 0.0f;
+    return (sample + _Clamp01(fraction)) / c_arcLengthSamples;
+}
+
+const CAKeyframeTrack::Segment& CAKeyframeTrack::_SegmentForProgress(float progress, float* u) const {
+    size_t index = std::upper_bound(_startTimes.begin(), _startTimes.end(), progress) - _startTimes.begin();
+    const Segment& segment = _segments[index > 0 ? index - 1 : 0];
+
+    *u = segment.inverseDuration > 0.0f ? _Clamp01((progress - segment.startTime) * segment.inverseDuration) : 1.0f;
+    return segment;
+}
+
+void CAKeyframeTrack::_EvaluateSegment(const Segment& segment, float u, float* result) const {
+    const float* a = &_coefficients[segment.coefficientOffset];
+    const float* b = a + _componentCount;
+    const float* c = b + _componentCount;
+    const float* d = c + _componentCount;
+
+    size_t i = 0;
+#if CA_KEYFRAME_SSE
+    const __m128 vu = _mm_set1_ps(u);
+    for (; i + 4 <= _componentCount; i += 4) {
+        __m128 value = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), vu), _mm_loadu_ps(b + i));
+        value = _mm_add_ps(_mm_mul_ps(value, vu), _mm_loadu_ps(c + i));
+        value = _mm_add_ps(_mm_mul_ps(value, vu), _mm_loadu_ps(d + i));
+        _mm_storeu_ps(result + i, value);
+    }
+#endif
+    for (; i < _componentCount; ++i) {
+        result[i] = ((a[i] * u + b[i]) * u + c[i]) * u + d[i];
+    }
+
+    if (_rotationMode != RotationMode::None) {
+        float dx = (3.0f * a[0] * u + 2.0f * b[0]) * u + c[0];
+        float dy = (3.0f * a[1] * u + 2.0f * b[1]) * u + c[1];
+        float angle = (dx == 0.0f && dy == 0.0f) ? 0.0f : atan2f(dy, dx);
+        if (_rotationMode == RotationMode::AutoReverse) {
+            angle += static_cast<float>(M_PI);
+        }
+        result[_componentCount] = angle;
+    }
+}
+
+void CAKeyframeTrack::Evaluate(float progress, float* result) const {
+    float u;
+    const Segment& segment = _SegmentForProgress(_Clamp01(progress), &u);
+
+    if (segment.timing) {
+        u = segment.timing->Evaluate(u);
+    }
+    if (segment.arcLengthOffset >= 0) {
+        u = _RemapArcLength(segment, u);
+    }
+
+    _EvaluateSegment(segment, u, result);
+}
+
+void CAKeyframeTrackEvaluateBatch(const CAKeyframeTrack* const* tracks, const float* progress, float* results, size_t resultStride, size_t count) {
+    // A chunk at a time: locate every element's segment, solve all of the chunk's timing curves in one batched call, then
+    // evaluate the polynomials. Only elements whose segment has a timing curve go through the solver.
+    static const size_t c_chunkSize = 256;
+    const CAKeyframeTrack::Segment* segments[c_chunkSize];
+    size_t elements[c_chunkSize];
+    float u[c_chunkSize];
+
+    const CATimingCurve* curves[c_chunkSize];
+    size_t timed[c_chunkSize];
+    float timedU[c_chunkSize];
+
+    for (size_t start = 0; start < count; start += c_chunkSize) {
+        size_t chunk = std::min(c_chunkSize, count - start);
+        size_t live = 0;
+        size_t timedCount = 0;
+
+        for (size_t i = 0; i < chunk; ++i) {
+            const CAKeyframeTrack* track = tracks[start + i];
+            if (!track || !track->IsValid()) {
+                continue;
+            }
+
+            const CAKeyframeTrack::Segment& segment = track->_SegmentForProgress(_Clamp01(progress[start + i]), &u[live]);
+            if (segment.timing) {
+                curves[timedCount] = segment.timing;
+                timedU[timedCount] = u[live];
+                timed[timedCount] = live;
+                ++timedCount;
+            }
+
+            segments[live] = &segment;
+            elements[live] = start + i;
+            ++live;
+        }
+
+        if (timedCount > 0) {
+            CATimingCurveEvaluateBatch(curves, timedU, timedU, timedCount);
+            for (size_t i = 0; i < timedCount; ++i) {
+                u[timed[i]] = timedU[i];
+            }
+        }
+
+        for (size_t i = 0; i < live; ++i) {
+            const CAKeyframeTrack* track = tracks[elements[i]];
+            const CAKeyframeTrack::Segment& segment = *segments[i];
+            float segmentU = segment.arcLengthOffset >= 0 ? track->_RemapArcLength(segment, u[i]) : u[i];
+            track->_EvaluateSegment(segment, segmentU, results + elements[i] * resultStride);
+        }
+    }
+}
@@ -40,12 +40,14 @@
 #include "CAEAGLLayerInternal.h"
 
 #include "CACompositor.h"
+#include "CABackingStorePool.h"
 #include "CAAnimationInternal.h"
 #include "CABasicAnimationInternal.h"
 #include "CATransactionInternal.h"
 #include "Quaternion.h"
 
 #include "LoggingNative.h"
+#include "Instrumentation.h"
 #include "NSLogging.h"
 #include "CALayerInternal.h"
 #include "CppWinRTHelpers.h"
@@ -183,6 +185,7 @@ static void GetNeededLayouts(CAPrivateInfo* state, NodeList<CAPrivateInfo>* list
 }
 
 void DoLayerLayouts(CALayer* window) {
+    INSTRUMENT_SPAN("QuartzCore", "CALayer.layoutPass");
     NodeList<CAPrivateInfo> list;
     for (;;) {
         GetNeededLayouts(window->priv, &list);
@@ -217,8 +220,10 @@ static void GetNeededDisplays(CAPrivateInfo* state, NodeList<CAPrivateInfo>* lis
 }
 
 static void DoDisplayList(CALayer* layer) {
+    INSTRUMENT_SPAN("QuartzCore", "CALayer.displayPass");
     NodeList<CAPrivateInfo> list;
     GetNeededDisplays(layer->priv, &list);
+    INSTRUMENT_COUNTER_ADD("QuartzCore", "CALayer.layersDisplayed", list.count);
 
     while (list.curPos < list.count) {
         CAPrivateInfo* cur = list.items[list.curPos];
@@ -277,6 +282,7 @@ CAPrivateInfo::CAPrivateInfo(CALayer* self, const FrameworkElement& xamlElement)
     isOpaque = FALSE;
     delegate = nil;
     needsDisplay = TRUE;
+    _dirtyRect = CGRectInfinite;
     needsUpdate = FALSE;
     backgroundColor.r = 0.0f;
     backgroundColor.g = 0.0f;
@@ -310,7 +316,19 @@ CAPrivateInfo::~CAPrivateInfo() {
         CGImageRelease(contents);
     }
     if (savedContext) {
-        CGContextRelease(savedContext);
+        CABackingStorePool::Shared().Recycle(savedContext, contentsScale);
+    }
+}
+
+// Releases the layer's owned contents and hands its backing store back to the shared pool.
+static void _ReleaseBackingStore(CAPrivateInfo* priv) {
+    if (priv->ownsContents && priv->contents) {
+        CGImageRelease(priv->contents);
+        priv->contents = NULL;
+    }
+    if (priv->savedContext) {
+        CABackingStorePool::Shared().Recycle(priv->savedContext, priv->contentsScale);
+        priv->savedContext = NULL;
     }
 }
 
@@ -382,6 +400,7 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
 */
 - (void)setNeedsDisplay {
     priv->needsDisplay = TRUE;
+    priv->_dirtyRect = CGRectInfinite;
     [self _displayChanged];
 }
 
@@ -475,6 +494,7 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
  @Status Interoperable
 */
 - (void)display {
+    INSTRUMENT_SPAN("QuartzCore", "CALayer.display");
     if (DEBUG_VERBOSE) {
         TraceVerbose(TAG,
                      L"Displaying for 0x%p (%hs, %hs)",
@@ -483,22 +503,11 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
                      priv->delegate ? object_getClassName(priv->delegate) : "nil");
     }
 
-    if (priv->savedContext != NULL) {
-        CGContextRelease(priv->savedContext);
-        priv->savedContext = NULL;
-    }
+    // Consume the accumulated dirty region; anything invalidated while drawing schedules another pass.
+    CGRect dirtyRect = priv->_dirtyRect;
+    priv->_dirtyRect = CGRectNull;
 
     if (priv->contents == NULL || priv->ownsContents || [self isKindOfClass:[CAShapeLayer class]]) {
-        if (priv->contents) {
-            if (priv->ownsContents) {
-                if (DEBUG_VERBOSE) {
-                    TraceVerbose(TAG, L"Freeing 0x%x with refcount %d", priv->contents, CFGetRetainCount((CFTypeRef)priv->contents));
-                }
-                CGImageRelease(priv->contents);
-            }
-            priv->contents = NULL;
-        }
-
         // Update content size, even in case of the early out below.
         int widthInPoints = ceilf(priv->bounds.size.width);
         int heightInPoints = ceilf(priv->bounds.size.height);
@@ -506,6 +515,22 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
         int width = (int)(widthInPoints * priv->contentsScale);
         int height = (int)(heightInPoints * priv->contentsScale);
 
+        // A backing store we drew on a previous pass can be redrawn in place if the layer's pixel size is unchanged
+        // and nobody else holds on to its image. Pixels outside the dirty region are then preserved rather than redrawn.
+        woc::StrongCF<CGContextRef> drawContext;
+        if (priv->ownsContents && priv->savedContext && width > 0 && height > 0 &&
+            CGBitmapContextGetWidth(priv->savedContext) == width && CGBitmapContextGetHeight(priv->savedContext) == height &&
+            CFGetRetainCount(_CGBitmapContextGetImage(priv->savedContext)) <= 2) {
+            drawContext = woc::MakeStrongCF(priv->savedContext);
+            priv->savedContext = NULL;
+        }
+
+        if (DEBUG_VERBOSE && priv->contents && priv->ownsContents) {
+            TraceVerbose(TAG, L"Freeing 0x%x with refcount %d", priv->contents, CFGetRetainCount((CFTypeRef)priv->contents));
+        }
+        _ReleaseBackingStore(priv);
+        priv->contents = NULL;
+
         if (width <= 0 || height <= 0) {
             TraceVerbose(TAG, L"Not drawing due to invalid layer dimensions; width=%d, height=%d", width, height);
             return;
@@ -530,24 +555,37 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
             if (DEBUG_DRAWING) {
                 TraceVerbose(TAG, L"Not drawing because no drawing callback was found for this layer.");
             }
+            if (drawContext) {
+                CABackingStorePool::Shared().Recycle(drawContext.detach(), priv->contentsScale);
+            }
             return;
         }
 
-        unsigned int tries = 0;
-        do {
-            // Create the contents
-            woc::StrongCF<CGContextRef> drawContext{ woc::MakeStrongCF(
-                CreateLayerContentsBitmapContext32(width, height, priv->contentsScale)) };
-            _CGContextPushBeginDraw(drawContext);
+        // Only a reused backing store has pixels worth preserving; everything else is drawn in full.
+        CGRect layerRect = CGRectMake(priv->bounds.origin.x, priv->bounds.origin.y, widthInPoints, heightInPoints);
+        CGRect clipRect = layerRect;
+        if (drawContext && !CGRectIsInfinite(dirtyRect) && !CGRectIsNull(dirtyRect)) {
+            clipRect = CGRectIntegral(CGRectIntersection(dirtyRect, layerRect));
+        }
 
-            if (priv->_backgroundColor != nil && (int)[static_cast<UIColor*>(priv->_backgroundColor) _type] != solidBrush) {
-                CGContextSaveGState(drawContext);
-                CGContextSetFillColorWithColor(drawContext, [static_cast<UIColor*>(priv->_backgroundColor) CGColor]);
+        if (CGRectIsEmpty(clipRect) && drawContext) {
+            // The dirty region lies entirely outside the layer; the existing contents are still valid.
+            CGImageRef target = _CGBitmapContextGetImage(drawContext);
+            priv->ownsContents = TRUE;
+            priv->contents = CGImageRetain(target);
+            priv->savedContext = drawContext.detach();
+            return;
+        }
 
-                CGRect wholeRect = CGRectMake(0, 0, width, height);
-                CGContextFillRect(drawContext, wholeRect);
-                CGContextRestoreGState(drawContext);
+        unsigned int tries = 0;
+        do {
+            // Create the contents, reusing a pooled backing store of the same size if one is available
+            if (!drawContext) {
+                drawContext = woc::MakeStrongCF(CABackingStorePool::Shared().Acquire(width, height, priv->contentsScale));
+                clipRect = layerRect;
             }
+            _CGContextPushBeginDraw(drawContext);
+            CGContextSaveGState(drawContext);
 
             // UIKit and CALayer consumers expect the origin to be in the top left.
             // CoreGraphics defaults to the bottom left, so we must flip and translate the canvas.
@@ -555,6 +593,17 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
             CGContextScaleCTM(drawContext, 1.0f, -1.0f);
             CGContextTranslateCTM(drawContext, -priv->bounds.origin.x, -priv->bounds.origin.y);
 
+            // Restrict drawing to the dirty region and wipe only what is about to be redrawn.
+            CGContextClipToRect(drawContext, clipRect);
+            CGContextClearRect(drawContext, clipRect);
+
+            if (priv->_backgroundColor != nil && (int)[static_cast<UIColor*>(priv->_backgroundColor) _type] != solidBrush) {
+                CGContextSaveGState(drawContext);
+                CGContextSetFillColorWithColor(drawContext, [static_cast<UIColor*>(priv->_backgroundColor) CGColor]);
+                CGContextFillRect(drawContext, clipRect);
+                CGContextRestoreGState(drawContext);
+            }
+
             _CGContextSetShadowProjectionTransform(drawContext, CGAffineTransformMakeScale(1.0, -1.0));
 
             [self drawInContext:drawContext];
@@ -567,6 +616,7 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
                 }
             }
 
+            CGContextRestoreGState(drawContext);
             _CGContextPopEndDraw(drawContext);
 
             woc::StrongCF<CFErrorRef> renderError;
@@ -574,6 +624,8 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
                 switch (CFErrorGetCode(renderError)) {
                     case kCGContextErrorDeviceReset:
                         NSTraceInfo(TAG, @"Hardware device disappeared when rendering %@; retrying.", self);
+                        // The device owning this backing store is gone; start over with a fresh one.
+                        drawContext.attach(nullptr);
                         ++tries;
                         continue;
                     default: {
@@ -588,8 +640,8 @@ CGContextRef CreateLayerContentsBitmapContext32(int width, int height, float sca
 
             CGImageRef target = _CGBitmapContextGetImage(drawContext);
             priv->ownsContents = TRUE;
-            priv->savedContext = CGContextRetain(drawContext);
             priv->contents = CGImageRetain(target);
+            priv->savedContext = drawContext.detach();
             break;
         } while (tries < _kCALayerRenderAttempts);
 
@@ -619,7 +671,7 @@ static void doRecursiveAction(CALayer* layer, NSString* actionName) {
         [layer _releaseContents:FALSE];
 
         if (layer->priv->savedContext) {
-            CGContextRelease(layer->priv->savedContext);
+            CABackingStorePool::Shared().Recycle(layer->priv->savedContext, layer->priv->contentsScale);
             layer->priv->savedContext = NULL;
         }
     }
@@ -1318,14 +1370,7 @@ static void doRecursiveAction(CALayer* layer, NSString* actionName) {
 
 - (void)_releaseContents:(BOOL)immediately {
     if (priv->ownsContents) {
-        if (priv->contents) {
-            CGImageRelease(priv->contents);
-            priv->contents = NULL;
-        }
-        if (priv->savedContext) {
-            CGContextRelease(priv->savedContext);
-            priv->savedContext = NULL;
-        }
+        _ReleaseBackingStore(priv);
     }
 
     // Clear out the display texture for this layer
@@ -2536,12 +2581,10 @@ bool _floatAlmostEqual(float a, float b) {
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
 */
 - (BOOL)needsDisplay {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return priv->needsDisplay;
 }
 
 /**
@@ -2554,11 +2597,22 @@ bool _floatAlmostEqual(float a, float b) {
 }
 
 /**
- @Status Stub
- @Notes
+ @Status Interoperable
+ @Notes Invalidated rects are accumulated as their bounding union; only that region is cleared and redrawn on the next display.
 */
 - (void)setNeedsDisplayInRect:(CGRect)theRect {
-    UNIMPLEMENTED();
+    if (CGRectIsEmpty(theRect)) {
+        return;
+    }
+
+    if (!priv->needsDisplay) {
+        priv->_dirtyRect = theRect;
+    } else if (!CGRectIsInfinite(priv->_dirtyRect)) {
+        priv->_dirtyRect = CGRectUnion(priv->_dirtyRect, theRect);
+    }
+
+    priv->needsDisplay = TRUE;
+    [self _displayChanged];
 }
 
 /**
@@ -19,6 +19,15 @@
 #include "Etc.h"
 #include "QuartzCore/CAMediaTimingFunction.h"
 #include "QuartzCore/CALayer.h"
+#include "CAMediaTimingFunctionInternal.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define CA_TIMING_SSE2 1
+#include <emmintrin.h>
+#endif
 
 NSString* const kCAMediaTimingFunctionLinear = @"kCAMediaTimingFunctionLinear";
 NSString* const kCAMediaTimingFunctionEaseIn = @"kCAMediaTimingFunctionEaseIn";
@@ -26,28 +35,231 @@ NSString* const kCAMediaTimingFunctionEaseOut = @"kCAMediaTimingFunctionEaseOut"
 NSString* const kCAMediaTimingFunctionEaseInEaseOut = @"kCAMediaTimingFunctionEaseInEaseOut";
 NSString* const kCAMediaTimingFunctionDefault = @"kCAMediaTimingFunctionDefault";
 
-float applyMediaTimingFunction(id function, float t) {
-    if (function == nil) {
-        return t;
+namespace {
+
+// Slopes below this are too flat for a Newton step to be trusted; the solver bisects instead.
+const double c_minSlope = 1e-12;
+
+// The solver stops once t is known to within this, well below what a float result can distinguish.
+const double c_solveTolerance = 1e-10;
+
+// Solves x(t) == x by bisection; only used while building the lookup table.
+double _SolveForTPrecise(double ax, double bx, double cx, double x) {
+    double lo = 0.0;
+    double hi = 1.0;
+    for (int i = 0; i < 60; ++i) {
+        double mid = (lo + hi) * 0.5;
+        if (((ax * mid + bx) * mid + cx) * mid < x) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo + hi) * 0.5;
+}
+
+inline float _Clamp01(float value) {
+    return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+// Coefficients of a*t^3 + b*t^2 + c*t, the x or y of a curve from 0 to 1 with control values c1 and c2.
+void _Coefficients(double c1, double c2, double* a, double* b, double* c) {
+    *c = 3.0 * c1;
+    *b = 3.0 * (c2 - c1) - *c;
+    *a = 1.0 - *c - *b;
+}
+
+std::shared_ptr<const CATimingCurve::TForXTable> _BuildTable(float c1x, float c2x) {
+    double ax, bx, cx;
+    _Coefficients(c1x, c2x, &ax, &bx, &cx);
+
+    auto table = std::make_shared<CATimingCurve::TForXTable>();
+    for (size_t i = 0; i <= CATimingCurve::c_tableSize; ++i) {
+        (*table)[i] = _SolveForTPrecise(ax, bx, cx, static_cast<double>(i) / CATimingCurve::c_tableSize);
+    }
+    return table;
+}
+
+// The x control points of the linear, ease-in, ease-out, ease-in-ease-out and default functions, in that order. These
+// are created over and over by +functionWithName: and implicit animations, so their tables are built once.
+const size_t c_namedCurveCount = 5;
+const float c_namedControlX[c_namedCurveCount][2] = { { 0.0f, 1.0f }, { 0.5f, 1.0f }, { 0.0f, 0.5f }, { 0.5f, 0.5f }, { 0.25f, 0.25f } };
+
+} // namespace
+
+std::shared_ptr<const CATimingCurve::TForXTable> CATimingCurve::_TableFor(float c1x, float c2x) {
+    static const auto s_namedTables = []() {
+        std::array<std::shared_ptr<const TForXTable>, c_namedCurveCount> tables;
+        for (size_t i = 0; i < tables.size(); ++i) {
+            tables[i] = _BuildTable(c_namedControlX[i][0], c_namedControlX[i][1]);
+        }
+        return tables;
+    }();
+
+    for (size_t i = 0; i < s_namedTables.size(); ++i) {
+        if (c1x == c_namedControlX[i][0] && c2x == c_namedControlX[i][1]) {
+            return s_namedTables[i];
+        }
+    }
+
+    return _BuildTable(c1x, c2x);
+}
+
+CATimingCurve::CATimingCurve() : CATimingCurve(0.0f, 0.0f, 1.0f, 1.0f) {
+}
+
+CATimingCurve::CATimingCurve(float c1x, float c1y, float c2x, float c2y) {
+    // x(t) must be monotonic for the curve to describe progress over time, which holds while both control x values lie in [0, 1].
+    c1x = _Clamp01(c1x);
+    c2x = _Clamp01(c2x);
+
+    _Coefficients(c1x, c2x, &_ax, &_bx, &_cx);
+    _Coefficients(c1y, c2y, &_ay, &_by, &_cy);
+
+    _isLinear = (c1x == c1y) && (c2x == c2y);
+
+    _table = _TableFor(c1x, c2x);
+    _tForX = _table->data();
+}
+
+double CATimingCurve::SolveForT(double x) const {
+    x = std::min(std::max(x, 0.0), 1.0);
+
+    // Interpolate a first guess from the table; the table entries also bracket the root.
+    double scaled = x * c_tableSize;
+    size_t index = std::min(static_cast<size_t>(scaled), c_tableSize - 1);
+    double lo = _tForX[index];
+    double hi = _tForX[index + 1];
+    double t = lo + (hi - lo) * (scaled - index);
+
+    // Safeguarded Newton: bisect whenever the slope is too flat or a step would leave the bracket, and stop once the
+    // step or the bracket is below the tolerance.
+    for (int i = 0; i < c_maxSolveIterations; ++i) {
+        double error = _SampleX(t) - x;
+        if (error == 0.0) {
+            break;
+        }
+
+        if (error > 0.0) {
+            hi = t;
+        } else {
+            lo = t;
+        }
+
+        double slope = _SampleDerivativeX(t);
+        double next = t - error / slope;
+        if (!(slope > c_minSlope && next > lo && next < hi)) {
+            next = (lo + hi) * 0.5;
+        }
+
+        bool converged = std::abs(next - t) <= c_solveTolerance || hi - lo <= c_solveTolerance;
+        t = next;
+        if (converged) {
+            break;
+        }
     }
-    float cp1[2];
-    float cp2[2];
 
-    CAMediaTimingFunction* pFunc = (CAMediaTimingFunction*)function;
+    return t;
+}
+
+float CATimingCurve::Evaluate(float x) const {
+    if (_isLinear) {
+        return _Clamp01(x);
+    }
+
+    return static_cast<float>(_SampleY(SolveForT(x)));
+}
+
+void CATimingCurveEvaluateBatch(const CATimingCurve* const* curves, const float* progress, float* results, size_t count) {
+    size_t i = 0;
+
+#if CA_TIMING_SSE2
+    // Two curves per iteration in double precision. Lanes iterate in lockstep until both have converged; a lane that
+    // converges first keeps its t.
+    static const CATimingCurve s_linearCurve;
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d two = _mm_set1_pd(2.0);
+    const __m128d three = _mm_set1_pd(3.0);
+    const __m128d minSlope = _mm_set1_pd(c_minSlope);
+    const __m128d tolerance = _mm_set1_pd(c_solveTolerance);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+
+    auto select = [](__m128d mask, __m128d a, __m128d b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); };
+
+    for (; i + 2 <= count; i += 2) {
+        // Gather each lane's curve coefficients and table bracket.
+        alignas(16) double xs[2];
+        alignas(16) double lo[2], hi[2], guess[2];
+        alignas(16) double ax[2], bx[2], cx[2], ay[2], by[2], cy[2];
+        alignas(16) uint64_t linear[2];
+        for (size_t lane = 0; lane < 2; ++lane) {
+            const CATimingCurve* curve = curves[i + lane] ? curves[i + lane] : &s_linearCurve;
+            xs[lane] = _Clamp01(progress[i + lane]);
+            double scaled = xs[lane] * CATimingCurve::c_tableSize;
+            size_t index = std::min(static_cast<size_t>(scaled), CATimingCurve::c_tableSize - 1);
+            lo[lane] = curve->_tForX[index];
+            hi[lane] = curve->_tForX[index + 1];
+            guess[lane] = lo[lane] + (hi[lane] - lo[lane]) * (scaled - index);
+            ax[lane] = curve->_ax;
+            bx[lane] = curve->_bx;
+            cx[lane] = curve->_cx;
+            ay[lane] = curve->_ay;
+            by[lane] = curve->_by;
+            cy[lane] = curve->_cy;
+            linear[lane] = curve->_isLinear ? ~0ULL : 0;
+        }
+
+        __m128d x = _mm_load_pd(xs);
+        __m128d vlo = _mm_load_pd(lo);
+        __m128d vhi = _mm_load_pd(hi);
+        __m128d t = _mm_load_pd(guess);
+        __m128d vax = _mm_load_pd(ax);
+        __m128d vbx = _mm_load_pd(bx);
+        __m128d vcx = _mm_load_pd(cx);
+        __m128d done = _mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(linear)));
+
+        for (int iteration = 0; iteration < CATimingCurve::c_maxSolveIterations && _mm_movemask_pd(done) != 3; ++iteration) {
+            __m128d error = _mm_sub_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(vax, t), vbx), t), vcx), t), x);
+            __m128d slope = _mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_mul_pd(three, vax), t), _mm_mul_pd(two, vbx)), t), vcx);
+            done = _mm_or_pd(done, _mm_cmpeq_pd(error, zero));
+
+            __m128d overshot = _mm_cmpgt_pd(error, zero);
+            vhi = select(overshot, t, vhi);
+            vlo = select(overshot, vlo, t);
+
+            __m128d next = _mm_sub_pd(t, _mm_div_pd(error, slope));
+            __m128d useNewton =
+                _mm_and_pd(_mm_cmpgt_pd(slope, minSlope), _mm_and_pd(_mm_cmpgt_pd(next, vlo), _mm_cmplt_pd(next, vhi)));
+            next = select(useNewton, next, _mm_mul_pd(_mm_add_pd(vlo, vhi), half));
 
-    cp1[0] = pFunc->_c1x;
-    cp1[1] = pFunc->_c1y;
-    cp2[0] = pFunc->_c2x;
-    cp2[1] = pFunc->_c2y;
+            __m128d step = _mm_andnot_pd(signMask, _mm_sub_pd(next, t));
+            t = select(done, t, next);
+            done = _mm_or_pd(done, _mm_or_pd(_mm_cmple_pd(step, tolerance), _mm_cmple_pd(_mm_sub_pd(vhi, vlo), tolerance)));
+        }
 
-    double x = cubed(1.0 - t) * 0.0 + 3 * squared(1 - t) * t * cp1[0] + 3 * (1 - t) * squared(t) * cp2[0] + cubed(t) * 1.0;
-    double y = cubed(1.0 - t) * 0.0 + 3 * squared(1 - t) * t * cp1[1] + 3 * (1 - t) * squared(t) * cp2[1] + cubed(t) * 1.0;
+        __m128d y = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_load_pd(ay), t), _mm_load_pd(by)), t), _mm_load_pd(cy)), t);
+        y = select(_mm_castsi128_pd(_mm_load_si128(reinterpret_cast<const __m128i*>(linear))), x, y);
+        _mm_storel_pi(reinterpret_cast<__m64*>(results + i), _mm_cvtpd_ps(y));
+    }
+#endif
 
-    // this is wrong
-    return (float)y;
+    for (; i < count; ++i) {
+        results[i] = curves[i] ? curves[i]->Evaluate(progress[i]) : _Clamp01(progress[i]);
+    }
 }
 
-@implementation CAMediaTimingFunction : NSObject
+float applyMediaTimingFunction(id function, float t) {
+    if (function == nil) {
+        return t;
+    }
+
+    return [static_cast<CAMediaTimingFunction*>(function) _timingCurve]->Evaluate(t);
+}
+
+@implementation CAMediaTimingFunction {
+    CATimingCurve _curve;
+}
 
 /**
  @Status Interoperable
@@ -91,6 +303,7 @@ float applyMediaTimingFunction(id function, float t) {
     _c1y = c1y;
     _c2x = c2x;
     _c2y = c2y;
+    _curve = CATimingCurve(c1x, c1y, c2x, c2y);
     return self;
 }
 // clang-format on
@@ -108,6 +321,26 @@ float applyMediaTimingFunction(id function, float t) {
     }
 }
 
+- (const CATimingCurve*)_timingCurve {
+    return &_curve;
+}
+
+void _CAMediaTimingFunctionEvaluateBatch(CAMediaTimingFunction* const* functions, const float* progress, float* results, size_t count) {
+    // Resolve the curves a chunk at a time so the batch evaluation never needs to message the functions.
+    static const size_t c_chunkSize = 256;
+    const CATimingCurve* curves[c_chunkSize];
+
+    for (size_t start = 0; start < count; start += c_chunkSize) {
+        size_t chunk = std::min(c_chunkSize, count - start);
+        for (size_t i = 0; i < chunk; ++i) {
+            CAMediaTimingFunction* function = functions[start + i];
+            curves[i] = function ? &function->_curve : nullptr;
+        }
+
+        CATimingCurveEvaluateBatch(curves, progress + start, results + start, chunk);
+    }
+}
+
 /**
  @Status Stub
  @Notes
@@ -0,0 +1,369 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "Starboard.h"
+#include "CAEmitterLayerInternal.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define CA_PARTICLES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline float _Clamp01(float value) {
+    return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+// Sets p[i] = clamp01(p[i] + speed * dt) for a color channel.
+void _AdvanceChannel(float* channel, size_t count, float delta) {
+    if (delta == 0.0f) {
+        return;
+    }
+
+    size_t i = 0;
+#if CA_PARTICLES_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 step = _mm_set1_ps(delta);
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_add_ps(_mm_loadu_ps(channel + i), step);
+        _mm_storeu_ps(channel + i, _mm_min_ps(_mm_max_ps(value, zero), one));
+    }
+#endif
+    for (; i < count; ++i) {
+        channel[i] = _Clamp01(channel[i] + delta);
+    }
+}
+
+} // namespace
+
+void CAParticleBuffer::Reserve(size_t capacity) {
+    if (capacity <= GetCapacity()) {
+        return;
+    }
+
+    for (std::vector<float>* array : { &x, &y, &velocityX, &velocityY, &rotation, &spinRate, &scale, &red, &green, &blue, &alpha, &age, &lifetime }) {
+        array->resize(capacity);
+    }
+}
+
+CAParticleSystem::CAParticleSystem(uint32_t seed) {
+    SetSeed(seed);
+}
+
+void CAParticleSystem::SetSeed(uint32_t seed) {
+    // xorshift has a fixed point at zero.
+    _randomState = seed ? seed : 0x9E3779B9u;
+}
+
+void CAParticleSystem::SetEmitter(const CAParticleEmitterParameters& emitter) {
+    _emitter = emitter;
+}
+
+size_t CAParticleSystem::AddCell(const CAParticleCellParameters& parameters) {
+    Cell cell;
+    cell.parameters = parameters;
+    if (cell.parameters.parentCell >= static_cast<int32_t>(_cells.size())) {
+        cell.parameters.parentCell = -1;
+    }
+
+    _cells.emplace_back(std::move(cell));
+    return _cells.size() - 1;
+}
+
+void CAParticleSystem::RemoveAllCells() {
+    _cells.clear();
+}
+
+size_t CAParticleSystem::GetParticleCount() const {
+    size_t count = 0;
+    for (const Cell& cell : _cells) {
+        count += cell.particles.count;
+    }
+
+    return count;
+}
+
+float CAParticleSystem::_Random() {
+    _randomState ^= _randomState << 13;
+    _randomState ^= _randomState >> 17;
+    _randomState ^= _randomState << 5;
+    return (_randomState >> 8) * (1.0f / 16777216.0f);
+}
+
+void CAParticleSystem::_Integrate(Cell& cell, float dt) {
+    CAParticleBuffer& particles = cell.particles;
+    const CAParticleCellParameters& parameters = cell.parameters;
+    size_t count = particles.count;
+
+    float* x = particles.x.data();
+    float* y = particles.y.data();
+    float* velocityX = particles.velocityX.data();
+    float* velocityY = particles.velocityY.data();
+    float* rotation = particles.rotation.data();
+    float* spinRate = particles.spinRate.data();
+    float* scale = particles.scale.data();
+    float* age = particles.age.data();
+
+    float deltaVelocityX = parameters.xAcceleration * dt;
+    float deltaVelocityY = parameters.yAcceleration * dt;
+    float deltaScale = parameters.scaleSpeed * _emitter.scale * dt;
+
+    size_t i = 0;
+#if CA_PARTICLES_SSE2
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 stepVelocityX = _mm_set1_ps(deltaVelocityX);
+    const __m128 stepVelocityY = _mm_set1_ps(deltaVelocityY);
+    const __m128 stepScale = _mm_set1_ps(deltaScale);
+    for (; i + 4 <= count; i += 4) {
+        // Semi-implicit Euler: velocity first, then position from the new velocity.
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(velocityX + i), stepVelocityX);
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(velocityY + i), stepVelocityY);
+        _mm_storeu_ps(velocityX + i, vx);
+        _mm_storeu_ps(velocityY + i, vy);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vx, step)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(vy, step)));
+
+        _mm_storeu_ps(rotation + i, _mm_add_ps(_mm_loadu_ps(rotation + i), _mm_mul_ps(_mm_loadu_ps(spinRate + i), step)));
+        _mm_storeu_ps(scale + i, _mm_add_ps(_mm_loadu_ps(scale + i), stepScale));
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), step));
+    }
+#endif
+    for (; i < count; ++i) {
+        velocityX[i] += deltaVelocityX;
+        velocityY[i] += deltaVelocityY;
+        x[i] += velocityX[i] * dt;
+        y[i] += velocityY[i] * dt;
+        rotation[i] += spinRate[i] * dt;
+        scale[i] += deltaScale;
+        age[i] += dt;
+    }
+
+    _AdvanceChannel(particles.red.data(), count, parameters.colorSpeed[0] * dt);
+    _AdvanceChannel(particles.green.data(), count, parameters.colorSpeed[1] * dt);
+    _AdvanceChannel(particles.blue.data(), count, parameters.colorSpeed[2] * dt);
+    _AdvanceChannel(particles.alpha.data(), count, parameters.colorSpeed[3] * dt);
+}
+
+void CAParticleSystem::_Reap(Cell& cell) {
+    CAParticleBuffer& particles = cell.particles;
+    std::vector<float>* arrays[] = { &particles.x,     &particles.y,     &particles.velocityX, &particles.velocityY, &particles.rotation,
+                                     &particles.spinRate, &particles.scale, &particles.red,       &particles.green,     &particles.blue,
+                                     &particles.alpha, &particles.age,   &particles.lifetime };
+
+    size_t i = 0;
+    while (i < particles.count) {
+        if (particles.age[i] < particles.lifetime[i]) {
+            ++i;
+            continue;
+        }
+
+        // Fill the dead slot with the last live particle so the live range stays packed.
+        size_t last = --particles.count;
+        if (i != last) {
+            for (std::vector<float>* array : arrays) {
+                (*array)[i] = (*array)[last];
+            }
+        }
+    }
+}
+
+void CAParticleSystem::_EmissionPoint(float* x, float* y) {
+    const CAParticleEmitterParameters& emitter = _emitter;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+
+    switch (emitter.shape) {
+        case CAEmitterShape::Point:
+            break;
+
+        case CAEmitterShape::Line:
+            if (emitter.mode == CAEmitterMode::Points) {
+                offsetX = (_Random() < 0.5f ? -0.5f : 0.5f) * emitter.width;
+            } else {
+                offsetX = _RandomSigned() * 0.5f * emitter.width;
+            }
+            break;
+
+        case CAEmitterShape::Rectangle:
+        case CAEmitterShape::Cuboid: {
+            // A cuboid seen along z is its rectangle.
+            float halfWidth = 0.5f * emitter.width;
+            float halfHeight = 0.5f * emitter.height;
+            if (emitter.mode == CAEmitterMode::Points) {
+                offsetX = _Random() < 0.5f ? -halfWidth : halfWidth;
+                offsetY = _Random() < 0.5f ? -halfHeight : halfHeight;
+            } else if (emitter.mode == CAEmitterMode::Outline) {
+                // Pick a point along the perimeter, weighting the sides by length.
+                float distance = _Random() * 2.0f * (emitter.width + emitter.height);
+                if (distance < emitter.width) {
+                    offsetX = distance - halfWidth;
+                    offsetY = -halfHeight;
+                } else if ((distance -= emitter.width) < emitter.height) {
+                    offsetX = halfWidth;
+                    offsetY = distance - halfHeight;
+                } else if ((distance -= emitter.height) < emitter.width) {
+                    offsetX = halfWidth - distance;
+                    offsetY = halfHeight;
+                } else {
+                    offsetX = -halfWidth;
+                    offsetY = halfHeight - (distance - emitter.width);
+                }
+            } else {
+                offsetX = _RandomSigned() * halfWidth;
+                offsetY = _RandomSigned() * halfHeight;
+            }
+            break;
+        }
+
+        case CAEmitterShape::Circle: {
+            // emitterSize.width is the radius.
+            if (emitter.mode == CAEmitterMode::Points) {
+                break;
+            }
+            float angle = _Random() * 2.0f * static_cast<float>(M_PI);
+            float radius = emitter.width;
+            if (emitter.mode != CAEmitterMode::Outline) {
+                radius *= sqrtf(_Random());
+            }
+            offsetX = radius * cosf(angle);
+            offsetY = radius * sinf(angle);
+            break;
+        }
+
+        case CAEmitterShape::Sphere: {
+            if (emitter.mode == CAEmitterMode::Points) {
+                break;
+            }
+            // Uniform direction on the sphere, projected onto the layer.
+            float z = _RandomSigned();
+            float angle = _Random() * 2.0f * static_cast<float>(M_PI);
+            float planar = sqrtf(std::max(0.0f, 1.0f - z * z));
+            float radius = emitter.width;
+            if (emitter.mode == CAEmitterMode::Volume) {
+                radius *= cbrtf(_Random());
+            }
+            offsetX = radius * planar * cosf(angle);
+            offsetY = radius * planar * sinf(angle);
+            break;
+        }
+    }
+
+    *x = emitter.positionX + offsetX;
+    *y = emitter.positionY + offsetY;
+}
+
+void CAParticleSystem::_Emit(Cell& cell, size_t count) {
+    CAParticleBuffer& particles = cell.particles;
+    const CAParticleCellParameters& parameters = cell.parameters;
+
+    const CAParticleBuffer* parent = nullptr;
+    if (parameters.parentCell >= 0) {
+        parent = &_cells[parameters.parentCell].particles;
+        if (parent->count == 0) {
+            return;
+        }
+    }
+
+    count = std::min(count, c_maxParticlesPerCell - particles.count);
+    if (particles.count + count > particles.GetCapacity()) {
+        particles.Reserve(std::max(particles.count + count, particles.GetCapacity() * 2));
+    }
+
+    for (size_t emitted = 0; emitted < count; ++emitted) {
+        float lifetime = (parameters.lifetime + parameters.lifetimeRange * _RandomSigned()) * _emitter.lifetime;
+        if (lifetime <= 0.0f) {
+            continue;
+        }
+
+        float originX;
+        float originY;
+        float baseVelocityX = 0.0f;
+        float baseVelocityY = 0.0f;
+        if (parent) {
+            // Sub-cells are born at a random live particle of their parent and inherit its motion.
+            size_t source = std::min(static_cast<size_t>(_Random() * parent->count), parent->count - 1);
+            originX = parent->x[source];
+            originY = parent->y[source];
+            baseVelocityX = parent->velocityX[source];
+            baseVelocityY = parent->velocityY[source];
+        } else {
+            _EmissionPoint(&originX, &originY);
+        }
+
+        float longitude = parameters.emissionLongitude + 0.5f * parameters.emissionRange * _RandomSigned();
+        float latitude = parameters.emissionLatitude;
+        float speed = (parameters.velocity + parameters.velocityRange * _RandomSigned()) * _emitter.velocity;
+
+        size_t slot = particles.count++;
+        particles.x[slot] = originX;
+        particles.y[slot] = originY;
+        particles.velocityX[slot] = baseVelocityX + speed * cosf(longitude) * cosf(latitude);
+        particles.velocityY[slot] = baseVelocityY + speed * sinf(longitude) * cosf(latitude);
+        particles.rotation[slot] = 0.0f;
+        particles.spinRate[slot] = (parameters.spin + parameters.spinRange * _RandomSigned()) * _emitter.spin;
+        particles.scale[slot] = (parameters.scale + parameters.scaleRange * _RandomSigned()) * _emitter.scale;
+        particles.red[slot] = _Clamp01(parameters.color[0] + parameters.colorRange[0] * _RandomSigned());
+        particles.green[slot] = _Clamp01(parameters.color[1] + parameters.colorRange[1] * _RandomSigned());
+        particles.blue[slot] = _Clamp01(parameters.color[2] + parameters.colorRange[2] * _RandomSigned());
+        particles.alpha[slot] = _Clamp01(parameters.color[3] + parameters.colorRange[3] * _RandomSigned());
+        particles.age[slot] = 0.0f;
+        particles.lifetime[slot] = lifetime;
+    }
+}
+
+void CAParticleSystem::Emit(size_t cell, size_t count) {
+    _Emit(_cells[cell], count);
+}
+
+void CAParticleSystem::Step(float dt) {
+    if (dt <= 0.0f) {
+        return;
+    }
+
+    for (Cell& cell : _cells) {
+        _Integrate(cell, dt);
+        _Reap(cell);
+    }
+
+    // Parents come first, so sub-cells see this frame's parent particles.
+    for (Cell& cell : _cells) {
+        float rate = cell.parameters.birthRate * _emitter.birthRate;
+        if (cell.parameters.parentCell >= 0) {
+            rate *= _cells[cell.parameters.parentCell].particles.count;
+        }
+
+        float births = cell.pendingBirths + rate * dt;
+        if (!(births > 0.0f)) {
+            // A negative rate doesn't build up a debt that would hold back births once it turns positive again.
+            cell.pendingBirths = 0.0f;
+            continue;
+        }
+
+        // Clamp before converting, since births can exceed what a size_t holds. Births beyond what a cell can hold are
+        // dropped rather than carried over.
+        const float maxBirths = static_cast<float>(c_maxParticlesPerCell);
+        size_t count = static_cast<size_t>(std::min(births, maxBirths));
+        cell.pendingBirths = (births < maxBirths) ? births - count : 0.0f;
+        if (count > 0) {
+            _Emit(cell, count);
+        }
+    }
+}
@@ -26,6 +26,7 @@
 
 #import "CALayerInternal.h"
 #import "LoggingNative.h"
+#import "Instrumentation.h"
 
 #import "CACompositor.h"
 
@@ -94,6 +95,7 @@ __declspec(thread) CATransaction* g_curTransaction, *g_rootTransaction;
  @Status Interoperable
 */
 + (void)commit {
+    INSTRUMENT_SPAN("QuartzCore", "CATransaction.commit");
     if (g_curTransaction != NULL) {
         CATransaction* rel = g_curTransaction;
         GetCACompositor()->QueueLayerTransaction(g_curTransaction->_transactionQueue, g_curTransaction->_parent->_transactionQueue);
@@ -108,6 +110,7 @@ __declspec(thread) CATransaction* g_curTransaction, *g_rootTransaction;
 }
 
 + (void)_commitAndProcessRootQueue {
+    INSTRUMENT_SPAN("QuartzCore", "CATransaction.commitRoot");
     while (g_curTransaction) {
         [self commit];
     }
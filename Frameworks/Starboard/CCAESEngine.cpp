@@ -0,0 +1,873 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "CCAESEngine.h"
+#include "CCAESKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+static inline uint32_t _Load32LE(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void _Store32LE(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static inline uint64_t _Load64BE(const uint8_t* p) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static inline void _Store64BE(uint8_t* p, uint64_t value) {
+    for (size_t i = 0; i < 8; ++i) {
+        p[7 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static inline void _XorBlock(uint8_t* out, const uint8_t* a, const uint8_t* b) {
+    for (size_t i = 0; i < CCAESKey::c_blockSize; ++i) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+// Clears key material with stores the optimizer can't drop as dead.
+static void _Wipe(void* data, size_t length) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(data);
+    while (length-- > 0) {
+        *bytes++ = 0;
+    }
+}
+
+// Portable AES, bitsliced over two blocks at a time.
+//
+// The eight words q[0..7] hold bit i of every state byte of both blocks in q[i]. Within a word each byte is one row of
+// the state, with the two blocks' columns interleaved, so ShiftRows is a per-byte rotation and MixColumns combines a
+// word with itself rotated by whole rows. SubBytes is the Boyar-Peralta circuit, 113 gates with no table lookups.
+
+#define CC_AES_SWAP(mask, shift, x, y)                                             \
+    {                                                                              \
+        uint32_t a = (x);                                                          \
+        uint32_t b = (y);                                                          \
+        (x) = (a & (mask)) | ((b & (mask)) << (shift));                            \
+        (y) = ((a & ~(mask)) >> (shift)) | (b & ~(mask));                          \
+    }
+
+// Converts between two blocks' worth of little-endian words (block 0 in the even words) and the bitsliced layout. It's
+// an involution.
+static void _Ortho(uint32_t* q) {
+    CC_AES_SWAP(0x55555555, 1, q[0], q[1]);
+    CC_AES_SWAP(0x55555555, 1, q[2], q[3]);
+    CC_AES_SWAP(0x55555555, 1, q[4], q[5]);
+    CC_AES_SWAP(0x55555555, 1, q[6], q[7]);
+
+    CC_AES_SWAP(0x33333333, 2, q[0], q[2]);
+    CC_AES_SWAP(0x33333333, 2, q[1], q[3]);
+    CC_AES_SWAP(0x33333333, 2, q[4], q[6]);
+    CC_AES_SWAP(0x33333333, 2, q[5], q[7]);
+
+    CC_AES_SWAP(0x0f0f0f0f, 4, q[0], q[4]);
+    CC_AES_SWAP(0x0f0f0f0f, 4, q[1], q[5]);
+    CC_AES_SWAP(0x0f0f0f0f, 4, q[2], q[6]);
+    CC_AES_SWAP(0x0f0f0f0f, 4, q[3], q[7]);
+}
+
+static void _SubBytes(uint32_t* q) {
+    const uint32_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // Top linear transformation.
+    const uint32_t y14 = x3 ^ x5;
+    const uint32_t y13 = x0 ^ x6;
+    const uint32_t y9 = x0 ^ x3;
+    const uint32_t y8 = x0 ^ x5;
+    const uint32_t t0 = x1 ^ x2;
+    const uint32_t y1 = t0 ^ x7;
+    const uint32_t y4 = y1 ^ x3;
+    const uint32_t y12 = y13 ^ y14;
+    const uint32_t y2 = y1 ^ x0;
+    const uint32_t y5 = y1 ^ x6;
+    const uint32_t y3 = y5 ^ y8;
+    const uint32_t t1 = x4 ^ y12;
+    const uint32_t y15 = t1 ^ x5;
+    const uint32_t y20 = t1 ^ x1;
+    const uint32_t y6 = y15 ^ x7;
+    const uint32_t y10 = y15 ^ t0;
+    const uint32_t y11 = y20 ^ y9;
+    const uint32_t y7 = x7 ^ y11;
+    const uint32_t y17 = y10 ^ y11;
+    const uint32_t y19 = y10 ^ y8;
+    const uint32_t y16 = t0 ^ y11;
+    const uint32_t y21 = y13 ^ y16;
+    const uint32_t y18 = x0 ^ y16;
+
+    // Inversion in GF(2^8) through GF(2^4).
+    const uint32_t t2 = y12 & y15;
+    const uint32_t t3 = y3 & y6;
+    const uint32_t t4 = t3 ^ t2;
+    const uint32_t t5 = y4 & x7;
+    const uint32_t t6 = t5 ^ t2;
+    const uint32_t t7 = y13 & y16;
+    const uint32_t t8 = y5 & y1;
+    const uint32_t t9 = t8 ^ t7;
+    const uint32_t t10 = y2 & y7;
+    const uint32_t t11 = t10 ^ t7;
+    const uint32_t t12 = y9 & y11;
+    const uint32_t t13 = y14 & y17;
+    const uint32_t t14 = t13 ^ t12;
+    const uint32_t t15 = y8 & y10;
+    const uint32_t t16 = t15 ^ t12;
+    const uint32_t t17 = t4 ^ t14;
+    const uint32_t t18 = t6 ^ t16;
+    const uint32_t t19 = t9 ^ t14;
+    const uint32_t t20 = t11 ^ t16;
+    const uint32_t t21 = t17 ^ y20;
+    const uint32_t t22 = t18 ^ y19;
+    const uint32_t t23 = t19 ^ y21;
+    const uint32_t t24 = t20 ^ y18;
+
+    const uint32_t t25 = t21 ^ t22;
+    const uint32_t t26 = t21 & t23;
+    const uint32_t t27 = t24 ^ t26;
+    const uint32_t t28 = t25 & t27;
+    const uint32_t t29 = t28 ^ t22;
+    const uint32_t t30 = t23 ^ t24;
+    const uint32_t t31 = t22 ^ t26;
+    const uint32_t t32 = t31 & t30;
+    const uint32_t t33 = t32 ^ t24;
+    const uint32_t t34 = t23 ^ t33;
+    const uint32_t t35 = t27 ^ t33;
+    const uint32_t t36 = t24 & t35;
+    const uint32_t t37 = t36 ^ t34;
+    const uint32_t t38 = t27 ^ t36;
+    const uint32_t t39 = t29 & t38;
+    const uint32_t t40 = t25 ^ t39;
+
+    const uint32_t t41 = t40 ^ t37;
+    const uint32_t t42 = t29 ^ t33;
+    const uint32_t t43 = t29 ^ t40;
+    const uint32_t t44 = t33 ^ t37;
+    const uint32_t t45 = t42 ^ t41;
+    const uint32_t z0 = t44 & y15;
+    const uint32_t z1 = t37 & y6;
+    const uint32_t z2 = t33 & x7;
+    const uint32_t z3 = t43 & y16;
+    const uint32_t z4 = t40 & y1;
+    const uint32_t z5 = t29 & y7;
+    const uint32_t z6 = t42 & y11;
+    const uint32_t z7 = t45 & y17;
+    const uint32_t z8 = t41 & y10;
+    const uint32_t z9 = t44 & y12;
+    const uint32_t z10 = t37 & y3;
+    const uint32_t z11 = t33 & y4;
+    const uint32_t z12 = t43 & y13;
+    const uint32_t z13 = t40 & y5;
+    const uint32_t z14 = t29 & y2;
+    const uint32_t z15 = t42 & y9;
+    const uint32_t z16 = t45 & y14;
+    const uint32_t z17 = t41 & y8;
+
+    // Bottom linear transformation, including the affine constant.
+    const uint32_t t46 = z15 ^ z16;
+    const uint32_t t47 = z10 ^ z11;
+    const uint32_t t48 = z5 ^ z13;
+    const uint32_t t49 = z9 ^ z10;
+    const uint32_t t50 = z2 ^ z12;
+    const uint32_t t51 = z2 ^ z5;
+    const uint32_t t52 = z7 ^ z8;
+    const uint32_t t53 = z0 ^ z3;
+    const uint32_t t54 = z6 ^ z7;
+    const uint32_t t55 = z16 ^ z17;
+    const uint32_t t56 = z12 ^ t48;
+    const uint32_t t57 = t50 ^ t53;
+    const uint32_t t58 = z4 ^ t46;
+    const uint32_t t59 = z3 ^ t54;
+    const uint32_t t60 = t46 ^ t57;
+    const uint32_t t61 = z14 ^ t57;
+    const uint32_t t62 = t52 ^ t58;
+    const uint32_t t63 = t49 ^ t58;
+    const uint32_t t64 = z4 ^ t59;
+    const uint32_t t65 = t61 ^ t62;
+    const uint32_t t66 = z1 ^ t63;
+    const uint32_t s0 = t59 ^ t63;
+    const uint32_t s6 = t56 ^ ~t62;
+    const uint32_t s7 = t48 ^ ~t60;
+    const uint32_t t67 = t64 ^ t65;
+    const uint32_t s3 = t53 ^ t66;
+    const uint32_t s4 = t51 ^ t66;
+    const uint32_t s5 = t47 ^ t65;
+    const uint32_t s1 = t64 ^ ~s3;
+    const uint32_t s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+// The inverse of the affine part of SubBytes.
+static void _InverseAffine(uint32_t* q) {
+    uint32_t x[8];
+    memcpy(x, q, sizeof(x));
+    for (size_t i = 0; i < 8; ++i) {
+        q[i] = x[(i + 2) & 7] ^ x[(i + 5) & 7] ^ x[(i + 7) & 7];
+    }
+    q[0] = ~q[0];
+    q[2] = ~q[2];
+}
+
+// SubBytes is the affine map after inversion, so inversion is the inverse affine map after SubBytes, and InvSubBytes
+// is inversion after the inverse affine map.
+static void _InvSubBytes(uint32_t* q) {
+    _InverseAffine(q);
+    _SubBytes(q);
+    _InverseAffine(q);
+}
+
+static void _ShiftRows(uint32_t* q) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint32_t x = q[i];
+        q[i] = (x & 0x000000ff) | ((x & 0x0000fc00) >> 2) | ((x & 0x00000300) << 6) | ((x & 0x00f00000) >> 4) |
+               ((x & 0x000f0000) << 4) | ((x & 0xc0000000) >> 6) | ((x & 0x3f000000) << 2);
+    }
+}
+
+static void _InvShiftRows(uint32_t* q) {
+    for (size_t i = 0; i < 8; ++i) {
+        uint32_t x = q[i];
+        q[i] = (x & 0x000000ff) | ((x & 0x00003f00) << 2) | ((x & 0x0000c000) >> 6) | ((x & 0x000f0000) << 4) |
+               ((x & 0x00f00000) >> 4) | ((x & 0x03000000) << 6) | ((x & 0xfc000000) >> 2);
+    }
+}
+
+static inline uint32_t _Rotate16(uint32_t x) {
+    return (x << 16) | (x >> 16);
+}
+
+// Each output byte is 2a ^ 3b ^ c ^ d for the column's bytes a, b, c, d starting at its own row, which is
+// 2(a ^ b) ^ b ^ (c ^ d): the doubling shows up as the q7 terms, b as the words rotated by one row, and c ^ d as the
+// rotation by two rows.
+static void _MixColumns(uint32_t* q) {
+    const uint32_t q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    const uint32_t r0 = (q0 >> 8) | (q0 << 24);
+    const uint32_t r1 = (q1 >> 8) | (q1 << 24);
+    const uint32_t r2 = (q2 >> 8) | (q2 << 24);
+    const uint32_t r3 = (q3 >> 8) | (q3 << 24);
+    const uint32_t r4 = (q4 >> 8) | (q4 << 24);
+    const uint32_t r5 = (q5 >> 8) | (q5 << 24);
+    const uint32_t r6 = (q6 >> 8) | (q6 << 24);
+    const uint32_t r7 = (q7 >> 8) | (q7 << 24);
+
+    q[0] = q7 ^ r7 ^ r0 ^ _Rotate16(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ _Rotate16(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ _Rotate16(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ _Rotate16(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ _Rotate16(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ _Rotate16(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ _Rotate16(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ _Rotate16(q7 ^ r7);
+}
+
+// InvMixColumns is MixColumns after multiplying each column by 4x^2 + 5, i.e. a ^= 4(a ^ c) for each byte a and the
+// byte c two rows below it.
+static void _InvMixColumns(uint32_t* q) {
+    uint32_t t[8];
+    for (size_t i = 0; i < 8; ++i) {
+        t[i] = q[i] ^ _Rotate16(q[i]);
+    }
+
+    // Two doublings in GF(2^8), reducing by x^8 + x^4 + x^3 + x + 1 each time.
+    for (size_t doubling = 0; doubling < 2; ++doubling) {
+        uint32_t high = t[7];
+        t[7] = t[6];
+        t[6] = t[5];
+        t[5] = t[4];
+        t[4] = t[3] ^ high;
+        t[3] = t[2] ^ high;
+        t[2] = t[1];
+        t[1] = t[0] ^ high;
+        t[0] = high;
+    }
+
+    for (size_t i = 0; i < 8; ++i) {
+        q[i] ^= t[i];
+    }
+    _MixColumns(q);
+}
+
+static inline void _AddRoundKey(uint32_t* q, const uint32_t* roundKey) {
+    for (size_t i = 0; i < 8; ++i) {
+        q[i] ^= roundKey[i];
+    }
+}
+
+static void _LoadTwoBlocks(uint32_t* q, const uint8_t* first, const uint8_t* second) {
+    for (size_t i = 0; i < 4; ++i) {
+        q[2 * i] = _Load32LE(first + 4 * i);
+        q[2 * i + 1] = _Load32LE(second + 4 * i);
+    }
+    _Ortho(q);
+}
+
+static void _StoreTwoBlocks(uint32_t* q, uint8_t* first, uint8_t* second) {
+    _Ortho(q);
+    for (size_t i = 0; i < 4; ++i) {
+        _Store32LE(first + 4 * i, q[2 * i]);
+        _Store32LE(second + 4 * i, q[2 * i + 1]);
+    }
+}
+
+static void _EncryptBitsliced(const uint32_t (*roundKeys)[8], uint32_t rounds, uint32_t* q) {
+    _AddRoundKey(q, roundKeys[0]);
+    for (uint32_t round = 1; round < rounds; ++round) {
+        _SubBytes(q);
+        _ShiftRows(q);
+        _MixColumns(q);
+        _AddRoundKey(q, roundKeys[round]);
+    }
+    _SubBytes(q);
+    _ShiftRows(q);
+    _AddRoundKey(q, roundKeys[rounds]);
+}
+
+static void _DecryptBitsliced(const uint32_t (*roundKeys)[8], uint32_t rounds, uint32_t* q) {
+    _AddRoundKey(q, roundKeys[rounds]);
+    for (uint32_t round = rounds - 1; round > 0; --round) {
+        _InvShiftRows(q);
+        _InvSubBytes(q);
+        _AddRoundKey(q, roundKeys[round]);
+        _InvMixColumns(q);
+    }
+    _InvShiftRows(q);
+    _InvSubBytes(q);
+    _AddRoundKey(q, roundKeys[0]);
+}
+
+// SubWord for the key schedule, through the same circuit as the cipher.
+static uint32_t _SubWord(uint32_t x) {
+    uint32_t q[8] = { x };
+    _Ortho(q);
+    _SubBytes(q);
+    _Ortho(q);
+    return q[0];
+}
+
+static std::atomic<uint32_t> s_enabledImplementations(UINT32_MAX);
+
+uint32_t CCAESGetAvailableImplementations() {
+    static const uint32_t s_available = CCAESDetectImplementations();
+    return s_available;
+}
+
+void CCAESSetEnabledImplementations(uint32_t implementations) {
+    s_enabledImplementations.store(implementations, std::memory_order_relaxed);
+}
+
+static uint32_t _EnabledImplementations() {
+    return CCAESGetAvailableImplementations() & s_enabledImplementations.load(std::memory_order_relaxed);
+}
+
+bool CCAESKey::IsValidKeyLength(size_t keyLength) {
+    return keyLength == 16 || keyLength == 24 || keyLength == 32;
+}
+
+bool CCAESKey::Init(const void* key, size_t keyLength) {
+    static const uint8_t c_roundConstants[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+
+    _rounds = 0;
+    _usesAESNI = false;
+    if (!IsValidKeyLength(keyLength)) {
+        return false;
+    }
+
+    const size_t keyWords = keyLength / 4;
+    _rounds = static_cast<uint32_t>(keyWords + 6);
+    const size_t scheduleWords = 4 * (_rounds + 1);
+
+    uint32_t schedule[4 * (c_maxRounds + 1)];
+    for (size_t i = 0; i < keyWords; ++i) {
+        schedule[i] = _Load32LE(static_cast<const uint8_t*>(key) + 4 * i);
+    }
+
+    // Words are little-endian, so RotWord is a rotation right by one byte.
+    uint32_t previous = schedule[keyWords - 1];
+    for (size_t i = keyWords, j = 0, round = 0; i < scheduleWords; ++i) {
+        if (j == 0) {
+            previous = _SubWord((previous >> 8) | (previous << 24)) ^ c_roundConstants[round];
+        } else if (keyWords > 6 && j == 4) {
+            previous = _SubWord(previous);
+        }
+        previous ^= schedule[i - keyWords];
+        schedule[i] = previous;
+
+        if (++j == keyWords) {
+            j = 0;
+            round++;
+        }
+    }
+
+    for (uint32_t round = 0; round <= _rounds; ++round) {
+        uint32_t q[8];
+        for (size_t i = 0; i < 4; ++i) {
+            _Store32LE(_roundKeys[round] + 4 * i, schedule[4 * round + i]);
+            q[2 * i] = q[2 * i + 1] = schedule[4 * round + i];
+        }
+        _Ortho(q);
+        memcpy(_bitslicedKeys[round], q, sizeof(q));
+    }
+    _Wipe(schedule, sizeof(schedule));
+
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_EnabledImplementations() & CCAESImplementationAESNI) {
+        _usesAESNI = true;
+        CCAESDecryptRoundKeysAESNI(&_roundKeys[0][0], _rounds, &_decryptRoundKeys[0][0]);
+    }
+#endif
+
+    return true;
+}
+
+void CCAESKey::Clear() {
+    _Wipe(_roundKeys, sizeof(_roundKeys));
+    _Wipe(_decryptRoundKeys, sizeof(_decryptRoundKeys));
+    _Wipe(_bitslicedKeys, sizeof(_bitslicedKeys));
+    _rounds = 0;
+}
+
+void CCAESKey::EncryptBlocks(const uint8_t* in, uint8_t* out, size_t blockCount) const {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesAESNI) {
+        CCAESEncryptBlocksAESNI(&_roundKeys[0][0], _rounds, in, out, blockCount);
+        return;
+    }
+#endif
+
+    uint32_t q[8];
+    for (size_t i = 0; i < blockCount; i += 2) {
+        // An odd block out rides along with a copy of itself.
+        const uint8_t* second = i + 1 < blockCount ? in + (i + 1) * c_blockSize : in + i * c_blockSize;
+        uint8_t secondOut[c_blockSize];
+
+        _LoadTwoBlocks(q, in + i * c_blockSize, second);
+        _EncryptBitsliced(_bitslicedKeys, _rounds, q);
+        _StoreTwoBlocks(q, out + i * c_blockSize, i + 1 < blockCount ? out + (i + 1) * c_blockSize : secondOut);
+    }
+    _Wipe(q, sizeof(q));
+}
+
+void CCAESKey::DecryptBlocks(const uint8_t* in, uint8_t* out, size_t blockCount) const {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesAESNI) {
+        CCAESDecryptBlocksAESNI(&_decryptRoundKeys[0][0], _rounds, in, out, blockCount);
+        return;
+    }
+#endif
+
+    uint32_t q[8];
+    for (size_t i = 0; i < blockCount; i += 2) {
+        const uint8_t* second = i + 1 < blockCount ? in + (i + 1) * c_blockSize : in + i * c_blockSize;
+        uint8_t secondOut[c_blockSize];
+
+        _LoadTwoBlocks(q, in + i * c_blockSize, second);
+        _DecryptBitsliced(_bitslicedKeys, _rounds, q);
+        _StoreTwoBlocks(q, out + i * c_blockSize, i + 1 < blockCount ? out + (i + 1) * c_blockSize : secondOut);
+    }
+    _Wipe(q, sizeof(q));
+}
+
+void CCAESKey::EncryptCBC(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) const {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesAESNI) {
+        CCAESEncryptCBCAESNI(&_roundKeys[0][0], _rounds, iv, in, out, blockCount);
+        return;
+    }
+#endif
+
+    // CBC encryption is inherently serial, so the second bitsliced lane goes unused.
+    uint8_t block[c_blockSize];
+    for (size_t i = 0; i < blockCount; ++i) {
+        _XorBlock(block, iv, in + i * c_blockSize);
+
+        uint32_t q[8];
+        _LoadTwoBlocks(q, block, block);
+        _EncryptBitsliced(_bitslicedKeys, _rounds, q);
+        _StoreTwoBlocks(q, iv, block);
+        memcpy(out + i * c_blockSize, iv, c_blockSize);
+    }
+    _Wipe(block, sizeof(block));
+}
+
+void CCAESKey::DecryptCBC(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) const {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesAESNI) {
+        CCAESDecryptCBCAESNI(&_decryptRoundKeys[0][0], _rounds, iv, in, out, blockCount);
+        return;
+    }
+#endif
+
+    // Blocks decrypt independently; the ciphertext is saved first since out may alias in.
+    uint8_t ciphertext[2][c_blockSize];
+    uint8_t plaintext[2][c_blockSize];
+    for (size_t i = 0; i < blockCount; i += 2) {
+        size_t count = std::min<size_t>(2, blockCount - i);
+        memcpy(ciphertext[0], in + i * c_blockSize, c_blockSize);
+        memcpy(ciphertext[1], in + (i + count - 1) * c_blockSize, c_blockSize);
+
+        uint32_t q[8];
+        _LoadTwoBlocks(q, ciphertext[0], ciphertext[1]);
+        _DecryptBitsliced(_bitslicedKeys, _rounds, q);
+        _StoreTwoBlocks(q, plaintext[0], plaintext[1]);
+
+        _XorBlock(out + i * c_blockSize, plaintext[0], iv);
+        if (count == 2) {
+            _XorBlock(out + (i + 1) * c_blockSize, plaintext[1], ciphertext[0]);
+        }
+        memcpy(iv, ciphertext[count - 1], c_blockSize);
+    }
+    _Wipe(plaintext, sizeof(plaintext));
+}
+
+static void _IncrementCounter(uint8_t* counter, bool increment32) {
+    size_t end = increment32 ? 12 : 0;
+    for (size_t i = CCAESKey::c_blockSize; i-- > end;) {
+        if (++counter[i] != 0) {
+            break;
+        }
+    }
+}
+
+void CCAESKey::CTRBlocks(uint8_t* counter, bool increment32, const uint8_t* in, uint8_t* out, size_t blockCount) const {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesAESNI) {
+        CCAESCTRAESNI(&_roundKeys[0][0], _rounds, counter, increment32, in, out, blockCount);
+        return;
+    }
+#endif
+
+    uint8_t keystream[2][c_blockSize];
+    for (size_t i = 0; i < blockCount; i += 2) {
+        size_t count = std::min<size_t>(2, blockCount - i);
+
+        uint8_t counters[2][c_blockSize];
+        memcpy(counters[0], counter, c_blockSize);
+        _IncrementCounter(counter, increment32);
+        memcpy(counters[1], counter, c_blockSize);
+        if (count == 2) {
+            _IncrementCounter(counter, increment32);
+        }
+
+        uint32_t q[8];
+        _LoadTwoBlocks(q, counters[0], counters[1]);
+        _EncryptBitsliced(_bitslicedKeys, _rounds, q);
+        _StoreTwoBlocks(q, keystream[0], keystream[1]);
+
+        for (size_t b = 0; b < count; ++b) {
+            _XorBlock(out + (i + b) * c_blockSize, in + (i + b) * c_blockSize, keystream[b]);
+        }
+    }
+    _Wipe(keystream, sizeof(keystream));
+}
+
+void CCAESCTR::Init(const CCAESKey* key, const uint8_t* iv, bool increment32) {
+    _key = key;
+    _increment32 = increment32;
+    memcpy(_counter, iv, sizeof(_counter));
+    _keystreamOffset = sizeof(_keystream);
+}
+
+void CCAESCTR::Process(const void* in, void* out, size_t length) {
+    const uint8_t* input = static_cast<const uint8_t*>(in);
+    uint8_t* output = static_cast<uint8_t*>(out);
+
+    // Finish the keystream block left over from the last call.
+    while (length > 0 && _keystreamOffset < sizeof(_keystream)) {
+        *output++ = *input++ ^ _keystream[_keystreamOffset++];
+        length--;
+    }
+
+    size_t blockCount = length / CCAESKey::c_blockSize;
+    if (blockCount > 0) {
+        _key->CTRBlocks(_counter, _increment32, input, output, blockCount);
+        input += blockCount * CCAESKey::c_blockSize;
+        output += blockCount * CCAESKey::c_blockSize;
+        length -= blockCount * CCAESKey::c_blockSize;
+    }
+
+    if (length > 0) {
+        memset(_keystream, 0, sizeof(_keystream));
+        _key->CTRBlocks(_counter, _increment32, _keystream, _keystream, 1);
+        _keystreamOffset = 0;
+        while (length > 0) {
+            *output++ = *input++ ^ _keystream[_keystreamOffset++];
+            length--;
+        }
+    }
+}
+
+// Portable GHASH: 64-bit carry-less multiplication by integer multiplication with the operands' bits spread four
+// apart, so that carries land in bits that are masked off. It returns the low half of the 128-bit product; the high
+// half comes from multiplying the bit-reversed operands.
+static inline uint64_t _CarrylessMultiply(uint64_t x, uint64_t y) {
+    const uint64_t m0 = 0x1111111111111111ULL, m1 = 0x2222222222222222ULL, m2 = 0x4444444444444444ULL, m3 = 0x8888888888888888ULL;
+    const uint64_t x0 = x & m0, x1 = x & m1, x2 = x & m2, x3 = x & m3;
+    const uint64_t y0 = y & m0, y1 = y & m1, y2 = y & m2, y3 = y & m3;
+
+    uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+    uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+    uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+    uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+    return (z0 & m0) | (z1 & m1) | (z2 & m2) | (z3 & m3);
+}
+
+static inline uint64_t _Reverse64(uint64_t x) {
+    x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+    x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+    x = ((x & 0x0f0f0f0f0f0f0f0fULL) << 4) | ((x >> 4) & 0x0f0f0f0f0f0f0f0fULL);
+    x = ((x & 0x00ff00ff00ff00ffULL) << 8) | ((x >> 8) & 0x00ff00ff00ff00ffULL);
+    x = ((x & 0x0000ffff0000ffffULL) << 16) | ((x >> 16) & 0x0000ffff0000ffffULL);
+    return (x << 32) | (x >> 32);
+}
+
+static void _GHASHBlocksPortable(uint8_t* y, const uint64_t* hashKey, const uint8_t* blocks, size_t blockCount) {
+    const uint64_t h1 = hashKey[0], h0 = hashKey[1], h2 = h0 ^ h1;
+    const uint64_t h1r = _Reverse64(h1), h0r = _Reverse64(h0), h2r = _Reverse64(h2);
+    uint64_t y1 = _Load64BE(y), y0 = _Load64BE(y + 8);
+
+    for (size_t i = 0; i < blockCount; ++i, blocks += 16) {
+        y1 ^= _Load64BE(blocks);
+        y0 ^= _Load64BE(blocks + 8);
+
+        // Karatsuba over the two halves, in both bit orders.
+        const uint64_t y1r = _Reverse64(y1), y0r = _Reverse64(y0), y2 = y0 ^ y1, y2r = y0r ^ y1r;
+        uint64_t z0 = _CarrylessMultiply(y0, h0);
+        uint64_t z1 = _CarrylessMultiply(y1, h1);
+        uint64_t z2 = _CarrylessMultiply(y2, h2);
+        uint64_t z0h = _CarrylessMultiply(y0r, h0r);
+        uint64_t z1h = _CarrylessMultiply(y1r, h1r);
+        uint64_t z2h = _CarrylessMultiply(y2r, h2r);
+        z2 ^= z0 ^ z1;
+        z2h ^= z0h ^ z1h;
+        z0h = _Reverse64(z0h) >> 1;
+        z1h = _Reverse64(z1h) >> 1;
+        z2h = _Reverse64(z2h) >> 1;
+
+        uint64_t v0 = z0, v1 = z0h ^ z2, v2 = z1 ^ z2h, v3 = z1h;
+
+        // GCM's bit order is reflected, so the 255-bit product is shifted up one bit before reducing modulo
+        // x^128 + x^7 + x^2 + x + 1.
+        v3 = (v3 << 1) | (v2 >> 63);
+        v2 = (v2 << 1) | (v1 >> 63);
+        v1 = (v1 << 1) | (v0 >> 63);
+        v0 = (v0 << 1);
+
+        v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+        v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+        v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+        v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+        y0 = v2;
+        y1 = v3;
+    }
+
+    _Store64BE(y, y1);
+    _Store64BE(y + 8, y0);
+}
+
+void CCAESGCM::Init(const CCAESKey* key) {
+    _key = key;
+
+    uint8_t hashKey[16] = {};
+    key->EncryptBlocks(hashKey, hashKey, 1);
+    _hashKey[0] = _Load64BE(hashKey);
+    _hashKey[1] = _Load64BE(hashKey + 8);
+
+    _usesCLMUL = false;
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_EnabledImplementations() & CCAESImplementationCLMUL) {
+        _usesCLMUL = true;
+        CCGHASHPowersCLMUL(hashKey, _hashKeyPowers);
+    }
+#endif
+    _Wipe(hashKey, sizeof(hashKey));
+
+    SetIV(nullptr, 0);
+}
+
+void CCAESGCM::SetIV(const void* iv, size_t ivLength) {
+    memset(_ghash, 0, sizeof(_ghash));
+    _partialLength = 0;
+    _aadLength = 0;
+    _textLength = 0;
+    _aadFinished = false;
+
+    // A 96-bit IV is used directly with a 32-bit counter; anything else is hashed into the first counter block.
+    if (ivLength == 12) {
+        memcpy(_preCounterBlock, iv, 12);
+        _preCounterBlock[12] = _preCounterBlock[13] = _preCounterBlock[14] = 0;
+        _preCounterBlock[15] = 1;
+    } else {
+        _Hash(static_cast<const uint8_t*>(iv), ivLength);
+        _FlushPartial();
+
+        uint8_t lengthBlock[16] = {};
+        _Store64BE(lengthBlock + 8, static_cast<uint64_t>(ivLength) * 8);
+        _Hash(lengthBlock, sizeof(lengthBlock));
+
+        memcpy(_preCounterBlock, _ghash, sizeof(_preCounterBlock));
+        memset(_ghash, 0, sizeof(_ghash));
+        _partialLength = 0;
+    }
+
+    uint8_t counter[CCAESKey::c_blockSize];
+    memcpy(counter, _preCounterBlock, sizeof(counter));
+    _IncrementCounter(counter, true);
+    _ctr.Init(_key, counter, true);
+}
+
+void CCAESGCM::_GHASHBlocks(const uint8_t* blocks, size_t blockCount) {
+#if defined(CC_AES_HAS_X86_KERNELS)
+    if (_usesCLMUL) {
+        CCGHASHBlocksCLMUL(_ghash, _hashKeyPowers, blocks, blockCount);
+        return;
+    }
+#endif
+    _GHASHBlocksPortable(_ghash, _hashKey, blocks, blockCount);
+}
+
+// Feeds data into GHASH, buffering a partial block.
+void CCAESGCM::_Hash(const uint8_t* data, size_t length) {
+    if (_partialLength > 0) {
+        size_t count = std::min(sizeof(_partial) - _partialLength, length);
+        memcpy(_partial + _partialLength, data, count);
+        _partialLength += count;
+        data += count;
+        length -= count;
+
+        if (_partialLength < sizeof(_partial)) {
+            return;
+        }
+
+        _partialLength = 0;
+        _GHASHBlocks(_partial, 1);
+    }
+
+    size_t blockCount = length / 16;
+    if (blockCount > 0) {
+        _GHASHBlocks(data, blockCount);
+        data += blockCount * 16;
+        length -= blockCount * 16;
+    }
+
+    if (length > 0) {
+        memcpy(_partial, data, length);
+        _partialLength = length;
+    }
+}
+
+// Zero-pads and hashes a buffered partial block.
+void CCAESGCM::_FlushPartial() {
+    if (_partialLength > 0) {
+        memset(_partial + _partialLength, 0, sizeof(_partial) - _partialLength);
+        _partialLength = 0;
+        _GHASHBlocks(_partial, 1);
+    }
+}
+
+// The additional data is zero-padded to a whole block before the text starts.
+void CCAESGCM::_FinishAAD() {
+    if (_aadFinished) {
+        return;
+    }
+    _aadFinished = true;
+
+    _FlushPartial();
+}
+
+void CCAESGCM::AddAAD(const void* data, size_t length) {
+    _Hash(static_cast<const uint8_t*>(data), length);
+    _aadLength += length;
+}
+
+void CCAESGCM::Encrypt(const void* in, void* out, size_t length) {
+    _FinishAAD();
+
+    // Ciphertext is hashed in cache-sized chunks right after it's produced.
+    static const size_t c_chunkSize = 4096;
+    const uint8_t* input = static_cast<const uint8_t*>(in);
+    uint8_t* output = static_cast<uint8_t*>(out);
+    while (length > 0) {
+        size_t count = std::min(length, c_chunkSize);
+        _ctr.Process(input, output, count);
+        _Hash(output, count);
+        input += count;
+        output += count;
+        length -= count;
+        _textLength += count;
+    }
+}
+
+void CCAESGCM::Decrypt(const void* in, void* out, size_t length) {
+    _FinishAAD();
+
+    static const size_t c_chunkSize = 4096;
+    const uint8_t* input = static_cast<const uint8_t*>(in);
+    uint8_t* output = static_cast<uint8_t*>(out);
+    while (length > 0) {
+        size_t count = std::min(length, c_chunkSize);
+        _Hash(input, count);
+        _ctr.Process(input, output, count);
+        input += count;
+        output += count;
+        length -= count;
+        _textLength += count;
+    }
+}
+
+void CCAESGCM::Final(uint8_t* tag) {
+    _FinishAAD();
+
+    _FlushPartial();
+
+    uint8_t lengthBlock[16];
+    _Store64BE(lengthBlock, _aadLength * 8);
+    _Store64BE(lengthBlock + 8, _textLength * 8);
+    _Hash(lengthBlock, sizeof(lengthBlock));
+
+    uint8_t mask[CCAESKey::c_blockSize];
+    _key->EncryptBlocks(_preCounterBlock, mask, 1);
+    _XorBlock(tag, _ghash, mask);
+    _Wipe(mask, sizeof(mask));
+}
+
+void CCAESGCM::Clear() {
+    _Wipe(_hashKey, sizeof(_hashKey));
+    _Wipe(_hashKeyPowers, sizeof(_hashKeyPowers));
+    _Wipe(_ghash, sizeof(_ghash));
+    _Wipe(_partial, sizeof(_partial));
+    _Wipe(&_ctr, sizeof(_ctr));
+}
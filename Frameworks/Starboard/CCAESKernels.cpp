@@ -0,0 +1,358 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "CCAESEngine.h"
+#include "CCAESKernels.h"
+
+#if defined(CC_AES_HAS_X86_KERNELS)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+// Each kernel is compiled for its own instruction set and only called once detection has vouched for it, so the rest
+// of the library keeps the baseline target.
+#define CC_AES_TARGET(features) __attribute__((target(features)))
+
+uint32_t CCAESDetectImplementations() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return CCAESImplementationPortable;
+    }
+
+    const bool ssse3 = (ecx & bit_SSSE3) != 0;
+    const bool sse41 = (ecx & bit_SSE4_1) != 0;
+
+    uint32_t implementations = CCAESImplementationPortable;
+    if ((ecx & bit_AES) && sse41) {
+        implementations |= CCAESImplementationAESNI;
+    }
+    if ((ecx & bit_PCLMUL) && ssse3 && sse41) {
+        implementations |= CCAESImplementationCLMUL;
+    }
+    return implementations;
+}
+
+// Blocks in flight at once. AESENC has a latency of several cycles but issues every cycle, so interleaving independent
+// blocks keeps the unit busy.
+static const size_t c_pipelineDepth = 8;
+
+CC_AES_TARGET("aes,sse4.1") static inline __m128i _EncryptBlock(const __m128i* keys, uint32_t rounds, __m128i block) {
+    block = _mm_xor_si128(block, keys[0]);
+    for (uint32_t round = 1; round < rounds; ++round) {
+        block = _mm_aesenc_si128(block, keys[round]);
+    }
+    return _mm_aesenclast_si128(block, keys[rounds]);
+}
+
+CC_AES_TARGET("aes,sse4.1") static inline __m128i _DecryptBlock(const __m128i* keys, uint32_t rounds, __m128i block) {
+    block = _mm_xor_si128(block, keys[0]);
+    for (uint32_t round = 1; round < rounds; ++round) {
+        block = _mm_aesdec_si128(block, keys[round]);
+    }
+    return _mm_aesdeclast_si128(block, keys[rounds]);
+}
+
+CC_AES_TARGET("aes,sse4.1") static inline void _EncryptPipeline(const __m128i* keys, uint32_t rounds, __m128i* blocks) {
+    for (size_t i = 0; i < c_pipelineDepth; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys[0]);
+    }
+    for (uint32_t round = 1; round < rounds; ++round) {
+        for (size_t i = 0; i < c_pipelineDepth; ++i) {
+            blocks[i] = _mm_aesenc_si128(blocks[i], keys[round]);
+        }
+    }
+    for (size_t i = 0; i < c_pipelineDepth; ++i) {
+        blocks[i] = _mm_aesenclast_si128(blocks[i], keys[rounds]);
+    }
+}
+
+CC_AES_TARGET("aes,sse4.1") static inline void _DecryptPipeline(const __m128i* keys, uint32_t rounds, __m128i* blocks) {
+    for (size_t i = 0; i < c_pipelineDepth; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys[0]);
+    }
+    for (uint32_t round = 1; round < rounds; ++round) {
+        for (size_t i = 0; i < c_pipelineDepth; ++i) {
+            blocks[i] = _mm_aesdec_si128(blocks[i], keys[round]);
+        }
+    }
+    for (size_t i = 0; i < c_pipelineDepth; ++i) {
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], keys[rounds]);
+    }
+}
+
+CC_AES_TARGET("aes,sse4.1") static inline void _LoadKeys(const uint8_t* roundKeys, uint32_t rounds, __m128i* keys) {
+    for (uint32_t round = 0; round <= rounds; ++round) {
+        keys[round] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + 16 * round));
+    }
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESEncryptBlocksAESNI(const uint8_t* roundKeys, uint32_t rounds, const uint8_t* in, uint8_t* out, size_t blockCount) {
+    __m128i keys[CCAESKey::c_maxRounds + 1];
+    _LoadKeys(roundKeys, rounds, keys);
+
+    const __m128i* input = reinterpret_cast<const __m128i*>(in);
+    __m128i* output = reinterpret_cast<__m128i*>(out);
+    size_t i = 0;
+    for (; i + c_pipelineDepth <= blockCount; i += c_pipelineDepth) {
+        __m128i blocks[c_pipelineDepth];
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            blocks[b] = _mm_loadu_si128(input + i + b);
+        }
+        _EncryptPipeline(keys, rounds, blocks);
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            _mm_storeu_si128(output + i + b, blocks[b]);
+        }
+    }
+    for (; i < blockCount; ++i) {
+        _mm_storeu_si128(output + i, _EncryptBlock(keys, rounds, _mm_loadu_si128(input + i)));
+    }
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESDecryptBlocksAESNI(const uint8_t* decryptRoundKeys, uint32_t rounds, const uint8_t* in, uint8_t* out, size_t blockCount) {
+    __m128i keys[CCAESKey::c_maxRounds + 1];
+    _LoadKeys(decryptRoundKeys, rounds, keys);
+
+    const __m128i* input = reinterpret_cast<const __m128i*>(in);
+    __m128i* output = reinterpret_cast<__m128i*>(out);
+    size_t i = 0;
+    for (; i + c_pipelineDepth <= blockCount; i += c_pipelineDepth) {
+        __m128i blocks[c_pipelineDepth];
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            blocks[b] = _mm_loadu_si128(input + i + b);
+        }
+        _DecryptPipeline(keys, rounds, blocks);
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            _mm_storeu_si128(output + i + b, blocks[b]);
+        }
+    }
+    for (; i < blockCount; ++i) {
+        _mm_storeu_si128(output + i, _DecryptBlock(keys, rounds, _mm_loadu_si128(input + i)));
+    }
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESEncryptCBCAESNI(const uint8_t* roundKeys, uint32_t rounds, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) {
+    __m128i keys[CCAESKey::c_maxRounds + 1];
+    _LoadKeys(roundKeys, rounds, keys);
+
+    const __m128i* input = reinterpret_cast<const __m128i*>(in);
+    __m128i* output = reinterpret_cast<__m128i*>(out);
+    __m128i chain = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+    for (size_t i = 0; i < blockCount; ++i) {
+        chain = _EncryptBlock(keys, rounds, _mm_xor_si128(chain, _mm_loadu_si128(input + i)));
+        _mm_storeu_si128(output + i, chain);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(iv), chain);
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESDecryptCBCAESNI(
+    const uint8_t* decryptRoundKeys, uint32_t rounds, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) {
+    __m128i keys[CCAESKey::c_maxRounds + 1];
+    _LoadKeys(decryptRoundKeys, rounds, keys);
+
+    // Unlike encryption, CBC decryption parallelizes: every ciphertext block is already known.
+    const __m128i* input = reinterpret_cast<const __m128i*>(in);
+    __m128i* output = reinterpret_cast<__m128i*>(out);
+    __m128i chain = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+    size_t i = 0;
+    for (; i + c_pipelineDepth <= blockCount; i += c_pipelineDepth) {
+        __m128i ciphertext[c_pipelineDepth];
+        __m128i blocks[c_pipelineDepth];
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            ciphertext[b] = blocks[b] = _mm_loadu_si128(input + i + b);
+        }
+        _DecryptPipeline(keys, rounds, blocks);
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            _mm_storeu_si128(output + i + b, _mm_xor_si128(blocks[b], chain));
+            chain = ciphertext[b];
+        }
+    }
+    for (; i < blockCount; ++i) {
+        __m128i ciphertext = _mm_loadu_si128(input + i);
+        _mm_storeu_si128(output + i, _mm_xor_si128(_DecryptBlock(keys, rounds, ciphertext), chain));
+        chain = ciphertext;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(iv), chain);
+}
+
+// Counters are big-endian; they're kept byte-swapped so the increment is a vector add.
+CC_AES_TARGET("aes,sse4.1") static inline __m128i _ByteSwap(__m128i x) {
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+// Adds one to a byte-swapped counter, carrying across all 128 bits or only within the low 32.
+CC_AES_TARGET("aes,sse4.1") static inline __m128i _Increment(__m128i counter, bool increment32) {
+    if (increment32) {
+        return _mm_add_epi32(counter, _mm_set_epi32(0, 0, 0, 1));
+    }
+
+    __m128i next = _mm_add_epi64(counter, _mm_set_epi64x(0, 1));
+    // The low half wrapped to zero: carry into the high half.
+    __m128i wrapped = _mm_cmpeq_epi64(_mm_and_si128(next, _mm_set_epi64x(0, -1)), _mm_setzero_si128());
+    return _mm_sub_epi64(next, _mm_slli_si128(_mm_and_si128(wrapped, _mm_set_epi64x(0, -1)), 8));
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESCTRAESNI(
+    const uint8_t* roundKeys, uint32_t rounds, uint8_t* counter, bool increment32, const uint8_t* in, uint8_t* out, size_t blockCount) {
+    __m128i keys[CCAESKey::c_maxRounds + 1];
+    _LoadKeys(roundKeys, rounds, keys);
+
+    const __m128i* input = reinterpret_cast<const __m128i*>(in);
+    __m128i* output = reinterpret_cast<__m128i*>(out);
+    __m128i current = _ByteSwap(_mm_loadu_si128(reinterpret_cast<const __m128i*>(counter)));
+    size_t i = 0;
+    for (; i + c_pipelineDepth <= blockCount; i += c_pipelineDepth) {
+        __m128i blocks[c_pipelineDepth];
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            blocks[b] = _ByteSwap(current);
+            current = _Increment(current, increment32);
+        }
+        _EncryptPipeline(keys, rounds, blocks);
+        for (size_t b = 0; b < c_pipelineDepth; ++b) {
+            _mm_storeu_si128(output + i + b, _mm_xor_si128(blocks[b], _mm_loadu_si128(input + i + b)));
+        }
+    }
+    for (; i < blockCount; ++i) {
+        __m128i keystream = _EncryptBlock(keys, rounds, _ByteSwap(current));
+        current = _Increment(current, increment32);
+        _mm_storeu_si128(output + i, _mm_xor_si128(keystream, _mm_loadu_si128(input + i)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(counter), _ByteSwap(current));
+}
+
+CC_AES_TARGET("aes,sse4.1")
+void CCAESDecryptRoundKeysAESNI(const uint8_t* roundKeys, uint32_t rounds, uint8_t* decryptRoundKeys) {
+    __m128i* keys = reinterpret_cast<__m128i*>(decryptRoundKeys);
+    const __m128i* source = reinterpret_cast<const __m128i*>(roundKeys);
+    _mm_storeu_si128(keys, _mm_loadu_si128(source + rounds));
+    for (uint32_t round = 1; round < rounds; ++round) {
+        _mm_storeu_si128(keys + round, _mm_aesimc_si128(_mm_loadu_si128(source + rounds - round)));
+    }
+    _mm_storeu_si128(keys + rounds, _mm_loadu_si128(source));
+}
+
+// GHASH with PCLMULQDQ. GCM numbers bits from the most significant end, so blocks are byte-reversed on load, which
+// leaves each 128-bit value bit-reflected; the product of two reflected values is the reflected product shifted right
+// by one, which the reduction accounts for by shifting the 256-bit product left first.
+
+CC_AES_TARGET("pclmul,sse4.1") static inline __m128i _ByteReverse(__m128i x) {
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+// The 256-bit carry-less product of a and b, as low and high halves, by Karatsuba.
+CC_AES_TARGET("pclmul,sse4.1") static inline void _Multiply(__m128i a, __m128i b, __m128i* low, __m128i* high) {
+    __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+    __m128i mid = _mm_clmulepi64_si128(_mm_xor_si128(a, _mm_shuffle_epi32(a, 0x4e)), _mm_xor_si128(b, _mm_shuffle_epi32(b, 0x4e)), 0x00);
+    mid = _mm_xor_si128(mid, _mm_xor_si128(lo, hi));
+    *low = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    *high = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+}
+
+// Reduces a 256-bit reflected product modulo x^128 + x^7 + x^2 + x + 1.
+CC_AES_TARGET("pclmul,sse4.1") static inline __m128i _Reduce(__m128i low, __m128i high) {
+    // Shift the product left by one bit.
+    __m128i lowCarry = _mm_srli_epi32(low, 31);
+    __m128i highCarry = _mm_srli_epi32(high, 31);
+    low = _mm_slli_epi32(low, 1);
+    high = _mm_slli_epi32(high, 1);
+    __m128i crossCarry = _mm_srli_si128(lowCarry, 12);
+    highCarry = _mm_slli_si128(highCarry, 4);
+    lowCarry = _mm_slli_si128(lowCarry, 4);
+    low = _mm_or_si128(low, lowCarry);
+    high = _mm_or_si128(_mm_or_si128(high, highCarry), crossCarry);
+
+    // First phase.
+    __m128i a = _mm_slli_epi32(low, 31);
+    __m128i b = _mm_slli_epi32(low, 30);
+    __m128i c = _mm_slli_epi32(low, 25);
+    a = _mm_xor_si128(_mm_xor_si128(a, b), c);
+    b = _mm_srli_si128(a, 4);
+    a = _mm_slli_si128(a, 12);
+    low = _mm_xor_si128(low, a);
+
+    // Second phase.
+    __m128i d = _mm_srli_epi32(low, 1);
+    __m128i e = _mm_srli_epi32(low, 2);
+    __m128i f = _mm_srli_epi32(low, 7);
+    d = _mm_xor_si128(_mm_xor_si128(d, e), f);
+    d = _mm_xor_si128(d, b);
+    low = _mm_xor_si128(low, d);
+    return _mm_xor_si128(high, low);
+}
+
+CC_AES_TARGET("pclmul,sse4.1") void CCGHASHPowersCLMUL(const uint8_t* hashKey, uint8_t (*powers)[16]) {
+    __m128i h = _ByteReverse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hashKey)));
+    __m128i power = h;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(powers[0]), power);
+    for (size_t i = 1; i < 4; ++i) {
+        __m128i low, high;
+        _Multiply(power, h, &low, &high);
+        power = _Reduce(low, high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(powers[i]), power);
+    }
+}
+
+CC_AES_TARGET("pclmul,sse4.1")
+void CCGHASHBlocksCLMUL(uint8_t* y, const uint8_t (*powers)[16], const uint8_t* blocks, size_t blockCount) {
+    const __m128i h1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[0]));
+    const __m128i h2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[1]));
+    const __m128i h3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[2]));
+    const __m128i h4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(powers[3]));
+    const __m128i* input = reinterpret_cast<const __m128i*>(blocks);
+    __m128i accumulator = _ByteReverse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y)));
+
+    // Four blocks at a time: (Y + X1)H^4 + X2 H^3 + X3 H^2 + X4 H, with a single reduction.
+    size_t i = 0;
+    for (; i + 4 <= blockCount; i += 4) {
+        __m128i x1 = _mm_xor_si128(accumulator, _ByteReverse(_mm_loadu_si128(input + i)));
+        __m128i x2 = _ByteReverse(_mm_loadu_si128(input + i + 1));
+        __m128i x3 = _ByteReverse(_mm_loadu_si128(input + i + 2));
+        __m128i x4 = _ByteReverse(_mm_loadu_si128(input + i + 3));
+
+        __m128i low, high, partialLow, partialHigh;
+        _Multiply(x1, h4, &low, &high);
+        _Multiply(x2, h3, &partialLow, &partialHigh);
+        low = _mm_xor_si128(low, partialLow);
+        high = _mm_xor_si128(high, partialHigh);
+        _Multiply(x3, h2, &partialLow, &partialHigh);
+        low = _mm_xor_si128(low, partialLow);
+        high = _mm_xor_si128(high, partialHigh);
+        _Multiply(x4, h1, &partialLow, &partialHigh);
+        low = _mm_xor_si128(low, partialLow);
+        high = _mm_xor_si128(high, partialHigh);
+        accumulator = _Reduce(low, high);
+    }
+    for (; i < blockCount; ++i) {
+        __m128i low, high;
+        _Multiply(_mm_xor_si128(accumulator, _ByteReverse(_mm_loadu_si128(input + i))), h1, &low, &high);
+        accumulator = _Reduce(low, high);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(y), _ByteReverse(accumulator));
+}
+
+#else
+
+uint32_t CCAESDetectImplementations() {
+    return CCAESImplementationPortable;
+}
+
+#endif
@@ -0,0 +1,45 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hardware kernels for CCAESEngine.cpp. Round keys are the standard byte-order schedule, one 16-byte block per round.
+
+// CCAESImplementation bits the CPU supports.
+uint32_t CCAESDetectImplementations();
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#define CC_AES_HAS_X86_KERNELS 1
+
+void CCAESEncryptBlocksAESNI(const uint8_t* roundKeys, uint32_t rounds, const uint8_t* in, uint8_t* out, size_t blockCount);
+void CCAESDecryptBlocksAESNI(const uint8_t* decryptRoundKeys, uint32_t rounds, const uint8_t* in, uint8_t* out, size_t blockCount);
+void CCAESEncryptCBCAESNI(const uint8_t* roundKeys, uint32_t rounds, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount);
+void CCAESDecryptCBCAESNI(
+    const uint8_t* decryptRoundKeys, uint32_t rounds, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount);
+void CCAESCTRAESNI(
+    const uint8_t* roundKeys, uint32_t rounds, uint8_t* counter, bool increment32, const uint8_t* in, uint8_t* out, size_t blockCount);
+
+// The equivalent inverse cipher's round keys (InvMixColumns applied to the middle rounds, order reversed).
+void CCAESDecryptRoundKeysAESNI(const uint8_t* roundKeys, uint32_t rounds, uint8_t* decryptRoundKeys);
+
+// H through H^4, byte-reflected, from the hash key H in GCM byte order.
+void CCGHASHPowersCLMUL(const uint8_t* hashKey, uint8_t (*powers)[16]);
+// Folds blockCount 16-byte blocks into the GHASH accumulator y (GCM byte order).
+void CCGHASHBlocksCLMUL(uint8_t* y, const uint8_t (*powers)[16], const uint8_t* blocks, size_t blockCount);
+#endif
@@ -0,0 +1,951 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "CCDigestEngine.h"
+#include "CCDigestKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+const uint32_t c_md5InitialState[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+const uint32_t c_sha1InitialState[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+const uint32_t c_sha224InitialState[8] = {
+    0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939, 0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4,
+};
+
+const uint32_t c_sha256InitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+const uint64_t c_sha384InitialState[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL,
+};
+
+const uint64_t c_sha512InitialState[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+const uint32_t c_md5Constants[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+const uint8_t c_md5Rotations[64] = {
+    7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+    4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+};
+
+const uint8_t c_md5MessageOrder[64] = {
+    0, 1, 2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 1, 6, 11, 0,  5,  10, 15, 4,  9,  14, 3,  8,  13, 2,  7,  12,
+    5, 8, 11, 14, 1,  4,  7,  10, 13, 0, 3,  6,  9,  12, 15, 2,  0, 7, 14, 5,  12, 3,  10, 1,  8,  15, 6,  13, 4,  11, 2,  9,
+};
+
+const uint32_t c_sha256Constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+const uint64_t c_sha512Constants[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL,
+    0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL, 0x12835b0145706fbeULL,
+    0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL, 0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL, 0x983e5152ee66dfabULL,
+    0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL,
+    0x53380d139d95b3dfULL, 0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL, 0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL,
+    0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL,
+    0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL, 0xca273eceea26619cULL,
+    0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL,
+    0x113f9804bef90daeULL, 0x1b710b35131c471bULL, 0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static inline uint32_t _Rotl32(uint32_t x, unsigned int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+static inline uint32_t _Rotr32(uint32_t x, unsigned int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint64_t _Rotr64(uint64_t x, unsigned int n) {
+    return (x >> n) | (x << (64 - n));
+}
+
+static inline uint32_t _Load32LE(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline uint32_t _Load32BE(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+static inline uint64_t _Load64BE(const uint8_t* p) {
+    return (static_cast<uint64_t>(_Load32BE(p)) << 32) | _Load32BE(p + 4);
+}
+
+static inline void _Store32LE(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static inline void _Store32BE(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+static inline void _Store64BE(uint8_t* p, uint64_t value) {
+    _Store32BE(p, static_cast<uint32_t>(value >> 32));
+    _Store32BE(p + 4, static_cast<uint32_t>(value));
+}
+
+void CCDigestMD5Compress(void* state, const uint8_t* blocks, size_t blockCount) {
+    uint32_t* h = static_cast<uint32_t*>(state);
+
+    for (; blockCount > 0; --blockCount, blocks += 64) {
+        uint32_t m[16];
+        for (size_t i = 0; i < 16; ++i) {
+            m[i] = _Load32LE(blocks + 4 * i);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+
+#define CC_MD5_STEP(f, i)                                                                                     \
+    {                                                                                                         \
+        uint32_t rotated = _Rotl32(a + (f) + c_md5Constants[i] + m[c_md5MessageOrder[i]], c_md5Rotations[i]); \
+        a = d;                                                                                                \
+        d = c;                                                                                                \
+        c = b;                                                                                                \
+        b += rotated;                                                                                         \
+    }
+
+        for (size_t i = 0; i < 16; ++i) {
+            CC_MD5_STEP((b & c) | (~b & d), i);
+        }
+        for (size_t i = 16; i < 32; ++i) {
+            CC_MD5_STEP((d & b) | (~d & c), i);
+        }
+        for (size_t i = 32; i < 48; ++i) {
+            CC_MD5_STEP(b ^ c ^ d, i);
+        }
+        for (size_t i = 48; i < 64; ++i) {
+            CC_MD5_STEP(c ^ (b | ~d), i);
+        }
+
+#undef CC_MD5_STEP
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+    }
+}
+
+void CCDigestSHA1Compress(void* state, const uint8_t* blocks, size_t blockCount) {
+    uint32_t* h = static_cast<uint32_t*>(state);
+
+    for (; blockCount > 0; --blockCount, blocks += 64) {
+        uint32_t w[80];
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = _Load32BE(blocks + 4 * i);
+        }
+        for (size_t i = 16; i < 80; ++i) {
+            w[i] = _Rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+#define CC_SHA1_STEP(f, k, i)                              \
+    {                                                      \
+        uint32_t t = _Rotl32(a, 5) + (f) + e + (k) + w[i]; \
+        e = d;                                             \
+        d = c;                                             \
+        c = _Rotl32(b, 30);                                \
+        b = a;                                             \
+        a = t;                                             \
+    }
+
+        for (size_t i = 0; i < 20; ++i) {
+            CC_SHA1_STEP((b & c) | (~b & d), 0x5a827999, i);
+        }
+        for (size_t i = 20; i < 40; ++i) {
+            CC_SHA1_STEP(b ^ c ^ d, 0x6ed9eba1, i);
+        }
+        for (size_t i = 40; i < 60; ++i) {
+            CC_SHA1_STEP((b & c) | (b & d) | (c & d), 0x8f1bbcdc, i);
+        }
+        for (size_t i = 60; i < 80; ++i) {
+            CC_SHA1_STEP(b ^ c ^ d, 0xca62c1d6, i);
+        }
+
+#undef CC_SHA1_STEP
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+}
+
+void CCDigestSHA256Compress(void* state, const uint8_t* blocks, size_t blockCount) {
+    uint32_t* h = static_cast<uint32_t*>(state);
+
+    for (; blockCount > 0; --blockCount, blocks += 64) {
+        uint32_t w[64];
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = _Load32BE(blocks + 4 * i);
+        }
+        for (size_t i = 16; i < 64; ++i) {
+            uint32_t s0 = _Rotr32(w[i - 15], 7) ^ _Rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = _Rotr32(w[i - 2], 17) ^ _Rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (size_t i = 0; i < 64; ++i) {
+            uint32_t s1 = _Rotr32(e, 6) ^ _Rotr32(e, 11) ^ _Rotr32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = hh + s1 + ch + c_sha256Constants[i] + w[i];
+            uint32_t s0 = _Rotr32(a, 2) ^ _Rotr32(a, 13) ^ _Rotr32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+    }
+}
+
+void CCDigestSHA512Compress(void* state, const uint8_t* blocks, size_t blockCount) {
+    uint64_t* h = static_cast<uint64_t*>(state);
+
+    for (; blockCount > 0; --blockCount, blocks += 128) {
+        uint64_t w[80];
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = _Load64BE(blocks + 8 * i);
+        }
+        for (size_t i = 16; i < 80; ++i) {
+            uint64_t s0 = _Rotr64(w[i - 15], 1) ^ _Rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            uint64_t s1 = _Rotr64(w[i - 2], 19) ^ _Rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint64_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (size_t i = 0; i < 80; ++i) {
+            uint64_t s1 = _Rotr64(e, 14) ^ _Rotr64(e, 18) ^ _Rotr64(e, 41);
+            uint64_t ch = (e & f) ^ (~e & g);
+            uint64_t t1 = hh + s1 + ch + c_sha512Constants[i] + w[i];
+            uint64_t s0 = _Rotr64(a, 28) ^ _Rotr64(a, 34) ^ _Rotr64(a, 39);
+            uint64_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint64_t t2 = s0 + maj;
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+    }
+}
+
+static std::atomic<uint32_t> s_enabledImplementations(UINT32_MAX);
+
+uint32_t CCDigestGetAvailableImplementations() {
+    static const uint32_t s_available = CCDigestDetectImplementations();
+    return s_available;
+}
+
+void CCDigestSetEnabledImplementations(uint32_t implementations) {
+    s_enabledImplementations.store(implementations, std::memory_order_relaxed);
+}
+
+namespace {
+struct Kernels {
+    CCDigestCompressFunction compress;
+    // Null if no enabled implementation can hash several messages at once.
+    CCDigestLanesFunction lanes;
+    size_t laneCount;
+};
+}
+
+static Kernels _GetKernels(CCDigestAlgorithm algorithm) {
+    uint32_t implementations = CCDigestGetAvailableImplementations() & s_enabledImplementations.load(std::memory_order_relaxed);
+    (void)implementations;
+
+    switch (algorithm) {
+        case kCCDigestMD5: {
+            Kernels kernels = { CCDigestMD5Compress, nullptr, 1 };
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+            if (implementations & CCDigestImplementationAVX2) {
+                kernels.lanes = CCDigestMD5Lanes8;
+                kernels.laneCount = 8;
+                return kernels;
+            }
+#endif
+#if defined(CC_DIGEST_HAS_VECTOR_LANES)
+            if (implementations & CCDigestImplementationVector) {
+                kernels.lanes = CCDigestMD5Lanes4;
+                kernels.laneCount = 4;
+            }
+#endif
+            return kernels;
+        }
+
+        case kCCDigestSHA1: {
+            Kernels kernels = { CCDigestSHA1Compress, nullptr, 1 };
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+            // Eight AVX2 lanes still outrun the SHA extensions on batches of messages, but four SSE2 lanes don't.
+            if (implementations & CCDigestImplementationSHAExtensions) {
+                kernels.compress = CCDigestSHA1CompressSHAExtensions;
+            }
+            if (implementations & CCDigestImplementationAVX2) {
+                kernels.lanes = CCDigestSHA1Lanes8;
+                kernels.laneCount = 8;
+                return kernels;
+            }
+#endif
+#if defined(CC_DIGEST_HAS_VECTOR_LANES)
+            if ((implementations & CCDigestImplementationVector) && kernels.compress == CCDigestSHA1Compress) {
+                kernels.lanes = CCDigestSHA1Lanes4;
+                kernels.laneCount = 4;
+            }
+#endif
+            return kernels;
+        }
+
+        case kCCDigestSHA224:
+        case kCCDigestSHA256: {
+            Kernels kernels = { CCDigestSHA256Compress, nullptr, 1 };
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+            if (implementations & CCDigestImplementationSHAExtensions) {
+                kernels.compress = CCDigestSHA256CompressSHAExtensions;
+            }
+            if (implementations & CCDigestImplementationAVX2) {
+                kernels.lanes = CCDigestSHA256Lanes8;
+                kernels.laneCount = 8;
+                return kernels;
+            }
+#endif
+#if defined(CC_DIGEST_HAS_VECTOR_LANES)
+            if ((implementations & CCDigestImplementationVector) && kernels.compress == CCDigestSHA256Compress) {
+                kernels.lanes = CCDigestSHA256Lanes4;
+                kernels.laneCount = 4;
+            }
+#endif
+            return kernels;
+        }
+
+        case kCCDigestSHA384:
+        case kCCDigestSHA512: {
+            Kernels kernels = { CCDigestSHA512Compress, nullptr, 1 };
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+            if (implementations & CCDigestImplementationAVX2) {
+                kernels.lanes = CCDigestSHA512Lanes4;
+                kernels.laneCount = 4;
+                return kernels;
+            }
+#endif
+#if defined(CC_DIGEST_HAS_VECTOR_LANES)
+            if (implementations & CCDigestImplementationVector) {
+                kernels.lanes = CCDigestSHA512Lanes2;
+                kernels.laneCount = 2;
+            }
+#endif
+            return kernels;
+        }
+
+        default:
+            return Kernels{ nullptr, nullptr, 1 };
+    }
+}
+
+static bool _IsBigEndian(CCDigestAlgorithm algorithm) {
+    return algorithm != kCCDigestMD5;
+}
+
+static bool _HasWideWords(CCDigestAlgorithm algorithm) {
+    return algorithm == kCCDigestSHA384 || algorithm == kCCDigestSHA512;
+}
+
+static size_t _StateWordCount(CCDigestAlgorithm algorithm) {
+    switch (algorithm) {
+        case kCCDigestMD5:
+            return 4;
+        case kCCDigestSHA1:
+            return 5;
+        default:
+            return 8;
+    }
+}
+
+static const void* _InitialState(CCDigestAlgorithm algorithm) {
+    switch (algorithm) {
+        case kCCDigestMD5:
+            return c_md5InitialState;
+        case kCCDigestSHA1:
+            return c_sha1InitialState;
+        case kCCDigestSHA224:
+            return c_sha224InitialState;
+        case kCCDigestSHA256:
+            return c_sha256InitialState;
+        case kCCDigestSHA384:
+            return c_sha384InitialState;
+        case kCCDigestSHA512:
+            return c_sha512InitialState;
+        default:
+            return nullptr;
+    }
+}
+
+// Appends the padding and message length to the final tailLength bytes of a message, writing one or two whole blocks
+// to blocks. Returns the number of blocks written.
+static size_t _PadFinalBlocks(CCDigestAlgorithm algorithm, const uint8_t* tail, size_t tailLength, uint64_t messageLength, uint8_t* blocks) {
+    size_t blockSize = CCDigestContext::GetBlockSize(algorithm);
+    size_t lengthFieldSize = _HasWideWords(algorithm) ? 16 : 8;
+    size_t blockCount = (tailLength + 1 + lengthFieldSize + blockSize - 1) / blockSize;
+    size_t paddedLength = blockCount * blockSize;
+
+    if (tailLength > 0) {
+        memmove(blocks, tail, tailLength);
+    }
+    blocks[tailLength] = 0x80;
+    memset(blocks + tailLength + 1, 0, paddedLength - tailLength - 1);
+
+    uint8_t* lengthField = blocks + paddedLength - 8;
+    if (_IsBigEndian(algorithm)) {
+        _Store64BE(lengthField, messageLength << 3);
+        if (lengthFieldSize == 16) {
+            _Store64BE(lengthField - 8, messageLength >> 61);
+        }
+    } else {
+        _Store32LE(lengthField, static_cast<uint32_t>(messageLength << 3));
+        _Store32LE(lengthField + 4, static_cast<uint32_t>(messageLength >> 29));
+    }
+
+    return blockCount;
+}
+
+static void _WriteDigest(CCDigestAlgorithm algorithm, const void* state, unsigned char* digest) {
+    size_t digestLength = CCDigestContext::GetDigestLength(algorithm);
+
+    if (_HasWideWords(algorithm)) {
+        const uint64_t* words = static_cast<const uint64_t*>(state);
+        for (size_t i = 0; i < digestLength / 8; ++i) {
+            _Store64BE(digest + 8 * i, words[i]);
+        }
+    } else {
+        const uint32_t* words = static_cast<const uint32_t*>(state);
+        for (size_t i = 0; i < digestLength / 4; ++i) {
+            if (_IsBigEndian(algorithm)) {
+                _Store32BE(digest + 4 * i, words[i]);
+            } else {
+                _Store32LE(digest + 4 * i, words[i]);
+            }
+        }
+    }
+}
+
+bool CCDigestContext::IsSupported(CCDigestAlgorithm algorithm) {
+    return _InitialState(algorithm) != nullptr;
+}
+
+size_t CCDigestContext::GetDigestLength(CCDigestAlgorithm algorithm) {
+    switch (algorithm) {
+        case kCCDigestMD5:
+            return CC_MD5_DIGEST_LENGTH;
+        case kCCDigestSHA1:
+            return CC_SHA1_DIGEST_LENGTH;
+        case kCCDigestSHA224:
+            return CC_SHA224_DIGEST_LENGTH;
+        case kCCDigestSHA256:
+            return CC_SHA256_DIGEST_LENGTH;
+        case kCCDigestSHA384:
+            return CC_SHA384_DIGEST_LENGTH;
+        case kCCDigestSHA512:
+            return CC_SHA512_DIGEST_LENGTH;
+        default:
+            return 0;
+    }
+}
+
+size_t CCDigestContext::GetBlockSize(CCDigestAlgorithm algorithm) {
+    return _HasWideWords(algorithm) ? 128 : 64;
+}
+
+void CCDigestContext::Init(CCDigestAlgorithm algorithm) {
+    _algorithm = algorithm;
+    _length = 0;
+    _bufferLength = 0;
+
+    size_t wordSize = _HasWideWords(algorithm) ? sizeof(uint64_t) : sizeof(uint32_t);
+    memcpy(&_state, _InitialState(algorithm), _StateWordCount(algorithm) * wordSize);
+}
+
+void CCDigestContext::Update(const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t blockSize = GetBlockSize(_algorithm);
+    if (length == 0) {
+        return;
+    }
+
+    CCDigestCompressFunction compress = _GetKernels(_algorithm).compress;
+    _length += length;
+
+    if (_bufferLength > 0) {
+        size_t count = std::min(blockSize - _bufferLength, length);
+        memcpy(_buffer + _bufferLength, bytes, count);
+        _bufferLength += count;
+        bytes += count;
+        length -= count;
+
+        if (_bufferLength < blockSize) {
+            return;
+        }
+
+        compress(&_state, _buffer, 1);
+        _bufferLength = 0;
+    }
+
+    size_t blockCount = length / blockSize;
+    if (blockCount > 0) {
+        compress(&_state, bytes, blockCount);
+        bytes += blockCount * blockSize;
+        length -= blockCount * blockSize;
+    }
+
+    memcpy(_buffer, bytes, length);
+    _bufferLength = length;
+}
+
+void CCDigestContext::Final(unsigned char* digest) {
+    uint8_t blocks[2 * c_maxBlockSize];
+    size_t blockCount = _PadFinalBlocks(_algorithm, _buffer, _bufferLength, _length, blocks);
+    _GetKernels(_algorithm).compress(&_state, blocks, blockCount);
+    _WriteDigest(_algorithm, &_state, digest);
+}
+
+namespace {
+// One message being hashed in a vector lane: its whole blocks are read in place, then the padded tail.
+struct Lane {
+    size_t message;
+    const uint8_t* data;
+    size_t dataBlockCount;
+    size_t blockCount;
+    size_t nextBlock;
+    uint8_t tail[2 * CCDigestContext::c_maxBlockSize];
+
+    const uint8_t* GetBlock(size_t index, size_t blockSize) const {
+        return index < dataBlockCount ? data + index * blockSize : tail + (index - dataBlockCount) * blockSize;
+    }
+};
+}
+
+static const size_t c_maxLaneCount = 8;
+static const size_t c_idleLane = SIZE_MAX;
+
+template <typename Word>
+static void _DigestLanes(CCDigestAlgorithm algorithm,
+                         const Kernels& kernels,
+                         const void* const* data,
+                         const size_t* lengths,
+                         size_t count,
+                         unsigned char* const* digests) {
+    static const uint8_t s_idleBlock[CCDigestContext::c_maxBlockSize] = {};
+
+    const size_t laneCount = kernels.laneCount;
+    const size_t blockSize = CCDigestContext::GetBlockSize(algorithm);
+    const size_t stateWordCount = _StateWordCount(algorithm);
+    const Word* initialState = static_cast<const Word*>(_InitialState(algorithm));
+
+    alignas(32) Word state[8 * c_maxLaneCount];
+    Lane lanes[c_maxLaneCount];
+    const uint8_t* blocks[c_maxLaneCount];
+    size_t nextMessage = 0;
+    size_t activeLanes = 0;
+
+    auto startMessage = [&](size_t l) {
+        Lane& lane = lanes[l];
+        if (nextMessage == count) {
+            lane.message = c_idleLane;
+            return;
+        }
+
+        lane.message = nextMessage++;
+        lane.data = static_cast<const uint8_t*>(data[lane.message]);
+        size_t length = lengths[lane.message];
+        lane.dataBlockCount = length / blockSize;
+        size_t tailLength = length - lane.dataBlockCount * blockSize;
+        lane.blockCount = lane.dataBlockCount + _PadFinalBlocks(algorithm, lane.data + lane.dataBlockCount * blockSize, tailLength, length, lane.tail);
+        lane.nextBlock = 0;
+
+        for (size_t i = 0; i < stateWordCount; ++i) {
+            state[i * laneCount + l] = initialState[i];
+        }
+        activeLanes++;
+    };
+
+    auto finishMessage = [&](size_t l) {
+        Word words[8];
+        for (size_t i = 0; i < stateWordCount; ++i) {
+            words[i] = state[i * laneCount + l];
+        }
+        _WriteDigest(algorithm, words, digests[lanes[l].message]);
+        activeLanes--;
+    };
+
+    for (size_t l = 0; l < laneCount; ++l) {
+        startMessage(l);
+    }
+
+    // Lanes are refilled as soon as their message is done, so messages of different lengths keep every lane busy
+    // until the queue runs dry.
+    while (activeLanes > 1) {
+        for (size_t l = 0; l < laneCount; ++l) {
+            blocks[l] = lanes[l].message == c_idleLane ? s_idleBlock : lanes[l].GetBlock(lanes[l].nextBlock, blockSize);
+        }
+
+        kernels.lanes(state, blocks);
+
+        for (size_t l = 0; l < laneCount; ++l) {
+            Lane& lane = lanes[l];
+            if (lane.message != c_idleLane && ++lane.nextBlock == lane.blockCount) {
+                finishMessage(l);
+                startMessage(l);
+            }
+        }
+    }
+
+    // A straggler runs faster on the single-message kernel than alongside idle lanes.
+    for (size_t l = 0; l < laneCount; ++l) {
+        Lane& lane = lanes[l];
+        if (lane.message == c_idleLane) {
+            continue;
+        }
+
+        Word words[8];
+        for (size_t i = 0; i < stateWordCount; ++i) {
+            words[i] = state[i * laneCount + l];
+        }
+
+        if (lane.nextBlock < lane.dataBlockCount) {
+            kernels.compress(words, lane.GetBlock(lane.nextBlock, blockSize), lane.dataBlockCount - lane.nextBlock);
+            lane.nextBlock = lane.dataBlockCount;
+        }
+        kernels.compress(words, lane.GetBlock(lane.nextBlock, blockSize), lane.blockCount - lane.nextBlock);
+
+        _WriteDigest(algorithm, words, digests[lane.message]);
+    }
+}
+
+void CCDigestMultiple(CCDigestAlgorithm algorithm, const void* const* data, const size_t* lengths, size_t count, unsigned char* const* digests) {
+    Kernels kernels = _GetKernels(algorithm);
+
+    if (kernels.lanes == nullptr || count < 2) {
+        CCDigestContext context;
+        for (size_t i = 0; i < count; ++i) {
+            context.Init(algorithm);
+            context.Update(data[i], lengths[i]);
+            context.Final(digests[i]);
+        }
+        return;
+    }
+
+    if (_HasWideWords(algorithm)) {
+        _DigestLanes<uint64_t>(algorithm, kernels, data, lengths, count, digests);
+    } else {
+        _DigestLanes<uint32_t>(algorithm, kernels, data, lengths, count, digests);
+    }
+}
+
+// Clears key material with stores the optimizer can't drop as dead.
+static void _Wipe(void* data, size_t length) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(data);
+    while (length-- > 0) {
+        *bytes++ = 0;
+    }
+}
+
+void CCDigestHmacInit(CCDigestAlgorithm algorithm, const void* key, size_t keyLength, CCDigestContext* inner, CCDigestContext* outer) {
+    size_t blockSize = CCDigestContext::GetBlockSize(algorithm);
+    uint8_t keyBlock[CCDigestContext::c_maxBlockSize] = {};
+
+    // Keys longer than a block are hashed first.
+    if (keyLength > blockSize) {
+        CCDigestContext keyDigest;
+        keyDigest.Init(algorithm);
+        keyDigest.Update(key, keyLength);
+        keyDigest.Final(keyBlock);
+    } else if (keyLength > 0) {
+        memcpy(keyBlock, key, keyLength);
+    }
+
+    for (size_t i = 0; i < blockSize; ++i) {
+        keyBlock[i] ^= 0x36;
+    }
+    inner->Init(algorithm);
+    inner->Update(keyBlock, blockSize);
+
+    for (size_t i = 0; i < blockSize; ++i) {
+        keyBlock[i] ^= 0x36 ^ 0x5c;
+    }
+    outer->Init(algorithm);
+    outer->Update(keyBlock, blockSize);
+
+    _Wipe(keyBlock, sizeof(keyBlock));
+}
+
+static CCDigestCompressFunction _PortableCompress(CCDigestAlgorithm algorithm) {
+    switch (algorithm) {
+        case kCCDigestMD5:
+            return CCDigestMD5Compress;
+        case kCCDigestSHA1:
+            return CCDigestSHA1Compress;
+        case kCCDigestSHA224:
+        case kCCDigestSHA256:
+            return CCDigestSHA256Compress;
+        default:
+            return CCDigestSHA512Compress;
+    }
+}
+
+// After the first round, both halves of a PBKDF2 round hash one digest behind an already absorbed key block, so each
+// message is a single block whose padding never changes. These blocks are padded once and each round only rewrites
+// their leading digest bytes.
+template <typename Word>
+static void _PBKDF2Rounds(CCDigestAlgorithm algorithm,
+                          CCDigestCompressFunction compress,
+                          const Word* innerState,
+                          const Word* outerState,
+                          uint8_t* innerBlock,
+                          uint8_t* outerBlock,
+                          uint32_t rounds,
+                          uint8_t* result) {
+    const size_t stateSize = _StateWordCount(algorithm) * sizeof(Word);
+    const size_t digestLength = CCDigestContext::GetDigestLength(algorithm);
+    Word state[8];
+
+    for (uint32_t round = 1; round < rounds; ++round) {
+        memcpy(state, innerState, stateSize);
+        compress(state, innerBlock, 1);
+        _WriteDigest(algorithm, state, outerBlock);
+
+        memcpy(state, outerState, stateSize);
+        compress(state, outerBlock, 1);
+        _WriteDigest(algorithm, state, innerBlock);
+
+        for (size_t i = 0; i < digestLength; ++i) {
+            result[i] ^= innerBlock[i];
+        }
+    }
+
+    _Wipe(state, sizeof(state));
+}
+
+// The same rounds for up to laneCount output blocks at once. Idle lanes rehash lane 0's blocks and are ignored.
+template <typename Word>
+static void _PBKDF2RoundsLanes(CCDigestAlgorithm algorithm,
+                               const Kernels& kernels,
+                               const Word* innerState,
+                               const Word* outerState,
+                               uint8_t (*innerBlocks)[CCDigestContext::c_maxBlockSize],
+                               uint8_t (*outerBlocks)[CCDigestContext::c_maxBlockSize],
+                               size_t activeLanes,
+                               uint32_t rounds,
+                               uint8_t (*results)[CCDigestContext::c_maxDigestLength]) {
+    const size_t laneCount = kernels.laneCount;
+    const size_t stateWordCount = _StateWordCount(algorithm);
+    const size_t digestLength = CCDigestContext::GetDigestLength(algorithm);
+
+    alignas(32) Word state[8 * c_maxLaneCount];
+    Word words[8];
+    const uint8_t* inner[c_maxLaneCount];
+    const uint8_t* outer[c_maxLaneCount];
+    for (size_t l = 0; l < laneCount; ++l) {
+        size_t source = l < activeLanes ? l : 0;
+        inner[l] = innerBlocks[source];
+        outer[l] = outerBlocks[source];
+    }
+
+    auto broadcast = [&](const Word* from) {
+        for (size_t i = 0; i < stateWordCount; ++i) {
+            for (size_t l = 0; l < laneCount; ++l) {
+                state[i * laneCount + l] = from[i];
+            }
+        }
+    };
+
+    auto writeDigest = [&](size_t l, uint8_t* block) {
+        for (size_t i = 0; i < stateWordCount; ++i) {
+            words[i] = state[i * laneCount + l];
+        }
+        _WriteDigest(algorithm, words, block);
+    };
+
+    for (uint32_t round = 1; round < rounds; ++round) {
+        broadcast(innerState);
+        kernels.lanes(state, inner);
+        for (size_t l = 0; l < activeLanes; ++l) {
+            writeDigest(l, outerBlocks[l]);
+        }
+
+        broadcast(outerState);
+        kernels.lanes(state, outer);
+        for (size_t l = 0; l < activeLanes; ++l) {
+            writeDigest(l, innerBlocks[l]);
+            for (size_t i = 0; i < digestLength; ++i) {
+                results[l][i] ^= innerBlocks[l][i];
+            }
+        }
+    }
+
+    _Wipe(state, sizeof(state));
+    _Wipe(words, sizeof(words));
+}
+
+void CCDigestPBKDF2(CCDigestAlgorithm algorithm,
+                    const void* password,
+                    size_t passwordLength,
+                    const void* salt,
+                    size_t saltLength,
+                    uint32_t rounds,
+                    unsigned char* derivedKey,
+                    size_t derivedKeyLength) {
+    const size_t blockSize = CCDigestContext::GetBlockSize(algorithm);
+    const size_t digestLength = CCDigestContext::GetDigestLength(algorithm);
+    const size_t outputBlockCount = (derivedKeyLength + digestLength - 1) / digestLength;
+    const Kernels kernels = _GetKernels(algorithm);
+
+    CCDigestContext inner;
+    CCDigestContext outer;
+    CCDigestHmacInit(algorithm, password, passwordLength, &inner, &outer);
+
+    uint8_t innerBlocks[c_maxLaneCount][CCDigestContext::c_maxBlockSize];
+    uint8_t outerBlocks[c_maxLaneCount][CCDigestContext::c_maxBlockSize];
+    uint8_t results[c_maxLaneCount][CCDigestContext::c_maxDigestLength];
+
+    for (size_t first = 0; first < outputBlockCount;) {
+        // Against the portable single-stream kernel any two output blocks are worth running in lanes; against the SHA
+        // extensions only a full set of lanes keeps up.
+        size_t remaining = outputBlockCount - first;
+        size_t groupSize = 1;
+        if (kernels.lanes != nullptr && remaining > 1 &&
+            (kernels.compress == _PortableCompress(algorithm) || remaining >= kernels.laneCount)) {
+            groupSize = std::min(remaining, kernels.laneCount);
+        }
+
+        // The first round hashes the salt and the big-endian output block index.
+        for (size_t l = 0; l < groupSize; ++l) {
+            uint8_t index[4];
+            _Store32BE(index, static_cast<uint32_t>(first + l + 1));
+
+            CCDigestContext context = inner;
+            context.Update(salt, saltLength);
+            context.Update(index, sizeof(index));
+            context.Final(innerBlocks[l]);
+
+            context = outer;
+            context.Update(innerBlocks[l], digestLength);
+            context.Final(innerBlocks[l]);
+            memcpy(results[l], innerBlocks[l], digestLength);
+
+            _PadFinalBlocks(algorithm, innerBlocks[l], digestLength, blockSize + digestLength, innerBlocks[l]);
+            _PadFinalBlocks(algorithm, innerBlocks[l], digestLength, blockSize + digestLength, outerBlocks[l]);
+        }
+
+        if (_HasWideWords(algorithm)) {
+            const uint64_t* innerState = inner._state.words64;
+            const uint64_t* outerState = outer._state.words64;
+            if (groupSize > 1) {
+                _PBKDF2RoundsLanes(algorithm, kernels, innerState, outerState, innerBlocks, outerBlocks, groupSize, rounds, results);
+            } else {
+                _PBKDF2Rounds(algorithm, kernels.compress, innerState, outerState, innerBlocks[0], outerBlocks[0], rounds, results[0]);
+            }
+        } else {
+            const uint32_t* innerState = inner._state.words32;
+            const uint32_t* outerState = outer._state.words32;
+            if (groupSize > 1) {
+                _PBKDF2RoundsLanes(algorithm, kernels, innerState, outerState, innerBlocks, outerBlocks, groupSize, rounds, results);
+            } else {
+                _PBKDF2Rounds(algorithm, kernels.compress, innerState, outerState, innerBlocks[0], outerBlocks[0], rounds, results[0]);
+            }
+        }
+
+        for (size_t l = 0; l < groupSize; ++l) {
+            size_t offset = (first + l) * digestLength;
+            memcpy(derivedKey + offset, results[l], std::min(digestLength, derivedKeyLength - offset));
+        }
+        first += groupSize;
+    }
+
+    _Wipe(&inner, sizeof(inner));
+    _Wipe(&outer, sizeof(outer));
+    _Wipe(innerBlocks, sizeof(innerBlocks));
+    _Wipe(outerBlocks, sizeof(outerBlocks));
+    _Wipe(results, sizeof(results));
+}
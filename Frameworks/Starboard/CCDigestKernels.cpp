@@ -0,0 +1,447 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include "CCDigestEngine.h"
+#include "CCDigestKernels.h"
+
+#include <string.h>
+
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(CC_DIGEST_HAS_VECTOR_LANES)
+
+// The multi-message kernels are written once against the compiler's generic vector types and instantiated for each lane
+// width. Every helper is forced inline so that the instantiations inside AVX2-targeted entry points are compiled with
+// AVX2 enabled, while the 128-bit ones only need the baseline instruction set (SSE2 on x86, NEON on ARM).
+#define CC_DIGEST_INLINE inline __attribute__((always_inline))
+
+typedef uint32_t CCDigestU32x4 __attribute__((vector_size(16)));
+typedef uint32_t CCDigestU32x8 __attribute__((vector_size(32)));
+typedef uint64_t CCDigestU64x2 __attribute__((vector_size(16)));
+typedef uint64_t CCDigestU64x4 __attribute__((vector_size(32)));
+
+// Rotations are macros rather than functions so that no 256-bit vector crosses a function boundary outside AVX2 code.
+#define CC_DIGEST_ROTL(x, bits, n) (((x) << (n)) | ((x) >> ((bits) - (n))))
+
+// Word word of each lane's block, byte swapped for the big-endian algorithms.
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _Gather32(V* result, const uint8_t* const* blocks, size_t word, bool bigEndian) {
+    for (size_t l = 0; l < laneCount; ++l) {
+        uint32_t value;
+        memcpy(&value, blocks[l] + 4 * word, sizeof(value));
+        (*result)[l] = bigEndian ? __builtin_bswap32(value) : value;
+    }
+}
+
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _Gather64BE(V* result, const uint8_t* const* blocks, size_t word) {
+    for (size_t l = 0; l < laneCount; ++l) {
+        uint64_t value;
+        memcpy(&value, blocks[l] + 8 * word, sizeof(value));
+        (*result)[l] = __builtin_bswap64(value);
+    }
+}
+
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _MD5Lanes(void* statePointer, const uint8_t* const* blocks) {
+    V* state = static_cast<V*>(statePointer);
+
+    V m[16];
+    for (size_t i = 0; i < 16; ++i) {
+        _Gather32<V, laneCount>(&m[i], blocks, i, false);
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+
+#define CC_MD5_STEP(f, i)                                                                                         \
+    {                                                                                                             \
+        V rotated = CC_DIGEST_ROTL(a + (f) + c_md5Constants[i] + m[c_md5MessageOrder[i]], 32, c_md5Rotations[i]); \
+        a = d;                                                                                                    \
+        d = c;                                                                                                    \
+        c = b;                                                                                                    \
+        b += rotated;                                                                                             \
+    }
+
+    for (size_t i = 0; i < 16; ++i) {
+        CC_MD5_STEP((b & c) | (~b & d), i);
+    }
+    for (size_t i = 16; i < 32; ++i) {
+        CC_MD5_STEP((d & b) | (~d & c), i);
+    }
+    for (size_t i = 32; i < 48; ++i) {
+        CC_MD5_STEP(b ^ c ^ d, i);
+    }
+    for (size_t i = 48; i < 64; ++i) {
+        CC_MD5_STEP(c ^ (b | ~d), i);
+    }
+
+#undef CC_MD5_STEP
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _SHA1Lanes(void* statePointer, const uint8_t* const* blocks) {
+    V* state = static_cast<V*>(statePointer);
+
+    // The message schedule only ever looks 16 words back, so it's kept in a ring.
+    V w[16];
+    for (size_t i = 0; i < 16; ++i) {
+        _Gather32<V, laneCount>(&w[i], blocks, i, true);
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+#define CC_SHA1_STEP(f, k, i)                                                                                    \
+    {                                                                                                            \
+        if (i >= 16) {                                                                                           \
+            w[i & 15] = CC_DIGEST_ROTL(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^ w[(i - 14) & 15] ^ w[i & 15], 32, 1); \
+        }                                                                                                        \
+        V t = CC_DIGEST_ROTL(a, 32, 5) + (f) + e + static_cast<uint32_t>(k) + w[i & 15];                         \
+        e = d;                                                                                                   \
+        d = c;                                                                                                   \
+        c = CC_DIGEST_ROTL(b, 32, 30);                                                                           \
+        b = a;                                                                                                   \
+        a = t;                                                                                                   \
+    }
+
+    for (size_t i = 0; i < 20; ++i) {
+        CC_SHA1_STEP((b & c) | (~b & d), 0x5a827999, i);
+    }
+    for (size_t i = 20; i < 40; ++i) {
+        CC_SHA1_STEP(b ^ c ^ d, 0x6ed9eba1, i);
+    }
+    for (size_t i = 40; i < 60; ++i) {
+        CC_SHA1_STEP((b & c) | (b & d) | (c & d), 0x8f1bbcdc, i);
+    }
+    for (size_t i = 60; i < 80; ++i) {
+        CC_SHA1_STEP(b ^ c ^ d, 0xca62c1d6, i);
+    }
+
+#undef CC_SHA1_STEP
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _SHA256Lanes(void* statePointer, const uint8_t* const* blocks) {
+    V* state = static_cast<V*>(statePointer);
+
+    V w[16];
+    for (size_t i = 0; i < 16; ++i) {
+        _Gather32<V, laneCount>(&w[i], blocks, i, true);
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            V w15 = w[(i - 15) & 15];
+            V w2 = w[(i - 2) & 15];
+            V s0 = CC_DIGEST_ROTL(w15, 32, 25) ^ CC_DIGEST_ROTL(w15, 32, 14) ^ (w15 >> 3);
+            V s1 = CC_DIGEST_ROTL(w2, 32, 15) ^ CC_DIGEST_ROTL(w2, 32, 13) ^ (w2 >> 10);
+            w[i & 15] += s0 + w[(i - 7) & 15] + s1;
+        }
+
+        V s1 = CC_DIGEST_ROTL(e, 32, 26) ^ CC_DIGEST_ROTL(e, 32, 21) ^ CC_DIGEST_ROTL(e, 32, 7);
+        V ch = (e & f) ^ (~e & g);
+        V t1 = h + s1 + ch + c_sha256Constants[i] + w[i & 15];
+        V s0 = CC_DIGEST_ROTL(a, 32, 30) ^ CC_DIGEST_ROTL(a, 32, 19) ^ CC_DIGEST_ROTL(a, 32, 10);
+        V maj = (a & b) ^ (a & c) ^ (b & c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + s0 + maj;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+template <typename V, size_t laneCount>
+static CC_DIGEST_INLINE void _SHA512Lanes(void* statePointer, const uint8_t* const* blocks) {
+    V* state = static_cast<V*>(statePointer);
+
+    V w[16];
+    for (size_t i = 0; i < 16; ++i) {
+        _Gather64BE<V, laneCount>(&w[i], blocks, i);
+    }
+
+    V a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t i = 0; i < 80; ++i) {
+        if (i >= 16) {
+            V w15 = w[(i - 15) & 15];
+            V w2 = w[(i - 2) & 15];
+            V s0 = CC_DIGEST_ROTL(w15, 64, 63) ^ CC_DIGEST_ROTL(w15, 64, 56) ^ (w15 >> 7);
+            V s1 = CC_DIGEST_ROTL(w2, 64, 45) ^ CC_DIGEST_ROTL(w2, 64, 3) ^ (w2 >> 6);
+            w[i & 15] += s0 + w[(i - 7) & 15] + s1;
+        }
+
+        V s1 = CC_DIGEST_ROTL(e, 64, 50) ^ CC_DIGEST_ROTL(e, 64, 46) ^ CC_DIGEST_ROTL(e, 64, 23);
+        V ch = (e & f) ^ (~e & g);
+        V t1 = h + s1 + ch + c_sha512Constants[i] + w[i & 15];
+        V s0 = CC_DIGEST_ROTL(a, 64, 36) ^ CC_DIGEST_ROTL(a, 64, 30) ^ CC_DIGEST_ROTL(a, 64, 25);
+        V maj = (a & b) ^ (a & c) ^ (b & c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + s0 + maj;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void CCDigestMD5Lanes4(void* state, const uint8_t* const* blocks) {
+    _MD5Lanes<CCDigestU32x4, 4>(state, blocks);
+}
+
+void CCDigestSHA1Lanes4(void* state, const uint8_t* const* blocks) {
+    _SHA1Lanes<CCDigestU32x4, 4>(state, blocks);
+}
+
+void CCDigestSHA256Lanes4(void* state, const uint8_t* const* blocks) {
+    _SHA256Lanes<CCDigestU32x4, 4>(state, blocks);
+}
+
+void CCDigestSHA512Lanes2(void* state, const uint8_t* const* blocks) {
+    _SHA512Lanes<CCDigestU64x2, 2>(state, blocks);
+}
+
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+
+#define CC_DIGEST_TARGET(features) __attribute__((target(features)))
+
+CC_DIGEST_TARGET("avx2") void CCDigestMD5Lanes8(void* state, const uint8_t* const* blocks) {
+    _MD5Lanes<CCDigestU32x8, 8>(state, blocks);
+}
+
+CC_DIGEST_TARGET("avx2") void CCDigestSHA1Lanes8(void* state, const uint8_t* const* blocks) {
+    _SHA1Lanes<CCDigestU32x8, 8>(state, blocks);
+}
+
+CC_DIGEST_TARGET("avx2") void CCDigestSHA256Lanes8(void* state, const uint8_t* const* blocks) {
+    _SHA256Lanes<CCDigestU32x8, 8>(state, blocks);
+}
+
+CC_DIGEST_TARGET("avx2") void CCDigestSHA512Lanes4(void* state, const uint8_t* const* blocks) {
+    _SHA512Lanes<CCDigestU64x4, 4>(state, blocks);
+}
+
+// The SHA extensions keep SHA-1 state as ABCD in one register (A in the top lane) and E in the top lane of another.
+CC_DIGEST_TARGET("sha,sse4.1") void CCDigestSHA1CompressSHAExtensions(void* statePointer, const uint8_t* blocks, size_t blockCount) {
+    uint32_t* state = static_cast<uint32_t*>(statePointer);
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+    for (; blockCount > 0; --blockCount, blocks += 64) {
+        __m128i abcdSaved = abcd;
+        __m128i e0Saved = e0;
+        __m128i e1 = abcd;
+        __m128i message[4];
+
+        // Four rounds per group; message words for later groups are derived as soon as their inputs exist. E alternates
+        // between two registers: one feeds the current group while the other captures ABCD for the next.
+#define CC_SHA1_GROUP(group, function)                                                                                      \
+    {                                                                                                                       \
+        __m128i& current = message[(group)&3];                                                                              \
+        if ((group) < 4) {                                                                                                  \
+            current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * (group))), byteSwap); \
+        }                                                                                                                   \
+        if ((group) == 0) {                                                                                                 \
+            e0 = _mm_add_epi32(e0, current);                                                                                \
+            e1 = abcd;                                                                                                      \
+            abcd = _mm_sha1rnds4_epu32(abcd, e0, function);                                                                 \
+        } else if ((group)&1) {                                                                                             \
+            e1 = _mm_sha1nexte_epu32(e1, current);                                                                          \
+            e0 = abcd;                                                                                                      \
+            abcd = _mm_sha1rnds4_epu32(abcd, e1, function);                                                                 \
+        } else {                                                                                                            \
+            e0 = _mm_sha1nexte_epu32(e0, current);                                                                          \
+            e1 = abcd;                                                                                                      \
+            abcd = _mm_sha1rnds4_epu32(abcd, e0, function);                                                                 \
+        }                                                                                                                   \
+        if ((group) >= 3 && (group) <= 18) {                                                                                \
+            message[((group) + 1) & 3] = _mm_sha1msg2_epu32(message[((group) + 1) & 3], current);                           \
+        }                                                                                                                   \
+        if ((group) >= 1 && (group) <= 16) {                                                                                \
+            message[((group)-1) & 3] = _mm_sha1msg1_epu32(message[((group)-1) & 3], current);                               \
+        }                                                                                                                   \
+        if ((group) >= 2 && (group) <= 17) {                                                                                \
+            message[((group)-2) & 3] = _mm_xor_si128(message[((group)-2) & 3], current);                                    \
+        }                                                                                                                   \
+    }
+
+        // The round function selector has to be an immediate, hence one loop per function.
+        for (size_t group = 0; group < 5; ++group) {
+            CC_SHA1_GROUP(group, 0);
+        }
+        for (size_t group = 5; group < 10; ++group) {
+            CC_SHA1_GROUP(group, 1);
+        }
+        for (size_t group = 10; group < 15; ++group) {
+            CC_SHA1_GROUP(group, 2);
+        }
+        for (size_t group = 15; group < 20; ++group) {
+            CC_SHA1_GROUP(group, 3);
+        }
+
+#undef CC_SHA1_GROUP
+
+        e0 = _mm_sha1nexte_epu32(e0, e0Saved);
+        abcd = _mm_add_epi32(abcd, abcdSaved);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+// The SHA extensions split SHA-256 state into ABEF and CDGH registers.
+CC_DIGEST_TARGET("sha,sse4.1") void CCDigestSHA256CompressSHAExtensions(void* statePointer, const uint8_t* blocks, size_t blockCount) {
+    uint32_t* state = static_cast<uint32_t*>(statePointer);
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+    __m128i hgfe = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+    __m128i abef = _mm_alignr_epi8(dcba, hgfe, 8);
+    __m128i cdgh = _mm_blend_epi16(hgfe, dcba, 0xf0);
+
+    for (; blockCount > 0; --blockCount, blocks += 64) {
+        __m128i abefSaved = abef;
+        __m128i cdghSaved = cdgh;
+        __m128i message[4];
+
+        for (size_t group = 0; group < 16; ++group) {
+            __m128i& current = message[group & 3];
+            if (group < 4) {
+                current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks + 16 * group)), byteSwap);
+            }
+
+            __m128i input = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(c_sha256Constants + 4 * group)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, input);
+
+            if (group >= 3 && group <= 14) {
+                __m128i& next = message[(group + 1) & 3];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(current, message[(group - 1) & 3], 4));
+                next = _mm_sha256msg2_epu32(next, current);
+            }
+
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(input, 0x0e));
+
+            if (group >= 1 && group <= 12) {
+                message[(group - 1) & 3] = _mm_sha256msg1_epu32(message[(group - 1) & 3], current);
+            }
+        }
+
+        abef = _mm_add_epi32(abef, abefSaved);
+        cdgh = _mm_add_epi32(cdgh, cdghSaved);
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+static void _Cpuid(uint32_t leaf, uint32_t registers[4]) {
+    __cpuid_count(leaf, 0, registers[0], registers[1], registers[2], registers[3]);
+}
+
+// XCR0, which says which register files the OS saves across context switches.
+static uint64_t _ReadExtendedControlRegister() {
+    uint32_t low;
+    uint32_t high;
+    __asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+#endif // CC_DIGEST_HAS_X86_KERNELS
+#endif // CC_DIGEST_HAS_VECTOR_LANES
+
+uint32_t CCDigestDetectImplementations() {
+    uint32_t implementations = CCDigestImplementationPortable;
+
+#if defined(CC_DIGEST_HAS_X86_KERNELS)
+    uint32_t registers[4];
+    _Cpuid(0, registers);
+    uint32_t maximumLeaf = registers[0];
+
+    _Cpuid(1, registers);
+    const uint32_t features1 = registers[3];
+    const uint32_t features2 = registers[2];
+
+    const bool hasSSE2 = (features1 & (1u << 26)) != 0;
+    const bool hasSSSE3 = (features2 & (1u << 9)) != 0;
+    const bool hasSSE41 = (features2 & (1u << 19)) != 0;
+    const bool hasOSXSAVE = (features2 & (1u << 27)) != 0;
+    const bool hasAVX = (features2 & (1u << 28)) != 0;
+
+    if (hasSSE2) {
+        implementations |= CCDigestImplementationVector;
+    }
+
+    if (maximumLeaf >= 7) {
+        _Cpuid(7, registers);
+        const uint32_t extendedFeatures = registers[1];
+
+        // AVX2 also needs the OS to preserve the upper halves of the YMM registers.
+        bool hasAVX2 = (extendedFeatures & (1u << 5)) != 0;
+        if (hasAVX2 && hasAVX && hasOSXSAVE && (_ReadExtendedControlRegister() & 0x6) == 0x6) {
+            implementations |= CCDigestImplementationAVX2;
+        }
+
+        bool hasSHA = (extendedFeatures & (1u << 29)) != 0;
+        if (hasSHA && hasSSSE3 && hasSSE41) {
+            implementations |= CCDigestImplementationSHAExtensions;
+        }
+    }
+#elif defined(CC_DIGEST_HAS_VECTOR_LANES) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    implementations |= CCDigestImplementationVector;
+#endif
+
+    return implementations;
+}
@@ -0,0 +1,73 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernels shared between CCDigestEngine.cpp and CCDigestKernels.cpp.
+
+// Hashes blockCount consecutive blocks into state (uint32_t[8] or uint64_t[8], in the algorithm's word order).
+typedef void (*CCDigestCompressFunction)(void* state, const uint8_t* blocks, size_t blockCount);
+
+// Hashes one block into each lane. state is word-major: word i of lane l is at state[i * laneCount + l], and must be
+// aligned to the vector size.
+typedef void (*CCDigestLanesFunction)(void* state, const uint8_t* const* blocks);
+
+extern const uint32_t c_md5InitialState[4];
+extern const uint32_t c_sha1InitialState[5];
+extern const uint32_t c_sha224InitialState[8];
+extern const uint32_t c_sha256InitialState[8];
+extern const uint64_t c_sha384InitialState[8];
+extern const uint64_t c_sha512InitialState[8];
+
+extern const uint32_t c_md5Constants[64];
+extern const uint8_t c_md5Rotations[64];
+extern const uint8_t c_md5MessageOrder[64];
+extern const uint32_t c_sha256Constants[64];
+extern const uint64_t c_sha512Constants[80];
+
+// Portable kernels, in CCDigestEngine.cpp.
+void CCDigestMD5Compress(void* state, const uint8_t* blocks, size_t blockCount);
+void CCDigestSHA1Compress(void* state, const uint8_t* blocks, size_t blockCount);
+void CCDigestSHA256Compress(void* state, const uint8_t* blocks, size_t blockCount);
+void CCDigestSHA512Compress(void* state, const uint8_t* blocks, size_t blockCount);
+
+// CCDigestImplementation bits the CPU supports, in CCDigestKernels.cpp.
+uint32_t CCDigestDetectImplementations();
+
+// Vector kernels. Each is only defined when the build can produce it; CCDigestDetectImplementations never reports an
+// implementation whose kernels are missing.
+#if defined(__GNUC__) || defined(__clang__)
+#define CC_DIGEST_HAS_VECTOR_LANES 1
+
+void CCDigestMD5Lanes4(void* state, const uint8_t* const* blocks);
+void CCDigestSHA1Lanes4(void* state, const uint8_t* const* blocks);
+void CCDigestSHA256Lanes4(void* state, const uint8_t* const* blocks);
+void CCDigestSHA512Lanes2(void* state, const uint8_t* const* blocks);
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define CC_DIGEST_HAS_X86_KERNELS 1
+
+void CCDigestMD5Lanes8(void* state, const uint8_t* const* blocks);
+void CCDigestSHA1Lanes8(void* state, const uint8_t* const* blocks);
+void CCDigestSHA256Lanes8(void* state, const uint8_t* const* blocks);
+void CCDigestSHA512Lanes4(void* state, const uint8_t* const* blocks);
+
+void CCDigestSHA1CompressSHAExtensions(void* state, const uint8_t* blocks, size_t blockCount);
+void CCDigestSHA256CompressSHAExtensions(void* state, const uint8_t* blocks, size_t blockCount);
+#endif
+#endif
@@ -16,6 +16,7 @@
 
 #include <Windows.h>
 #include <CommonCrypto\CommonCryptor.h>
+#include <CommonCrypto\CommonCryptorSPI.h>
 #include <COMIncludes.h>
 #include <wrl\wrappers\corewrappers.h>
 #include <wrl\client.h>
@@ -25,6 +26,8 @@
 #include <ErrorHandling.h>
 #include <StubReturn.h>
 #include <RawBuffer.h>
+#include "CCAESEngine.h"
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -59,17 +62,50 @@ static CCCryptorStatus _cryptorStatusFromHRESULT(HRESULT result) {
     return result;
 }
 
+// Wipes a buffer with stores the optimizer can't drop as dead.
+static void _wipe(void* data, size_t length) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(data);
+    while (length-- > 0) {
+        *bytes++ = 0;
+    }
+}
+
+static bool _constantTimeEquals(const uint8_t* a, const uint8_t* b, size_t length) {
+    uint8_t difference = 0;
+    for (size_t i = 0; i < length; ++i) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+// SP 800-38D allows tags of 128, 120, 112, 104, 96, 64 and 32 bits.
+static bool _isValidGCMTagLength(size_t tagLength) {
+    return (tagLength >= 12 && tagLength <= CCAESGCM::c_tagLength) || tagLength == 8 || tagLength == 4;
+}
+
 struct CC_Cryptor_State {
-    CC_Cryptor_State(CCOperation op, CCAlgorithm alg, CCOptions options, const void* key, size_t keyLength, const void* iv)
+    CC_Cryptor_State(CCOperation op,
+                     CCAlgorithm alg,
+                     CCMode mode,
+                     CCPadding padding,
+                     CCModeOptions modeOptions,
+                     const void* key,
+                     size_t keyLength,
+                     const void* iv)
         : _op(op),
           _alg(alg),
-          _options(options),
+          _mode(mode),
+          _padding(padding),
+          _modeOptions(modeOptions),
+          _options(0),
           _key(key),
           _keyLength(keyLength),
           _blockSize(0),
           _iv(iv),
           _ivBuffer(nullptr),
-          _inputBuffer() {
+          _inputBuffer(),
+          _bufferLength(0),
+          _gcmStarted(false) {
         if (_alg == kCCAlgorithmAES) {
             _blockSize = 16;
         } else if (_alg == kCCAlgorithmRC4) {
@@ -77,15 +113,48 @@ struct CC_Cryptor_State {
         } else {
             _blockSize = 8;
         }
+
+        if (_padding == ccPKCS7Padding) {
+            _options |= kCCOptionPKCS7Padding;
+        }
+        if (_mode == kCCModeECB) {
+            _options |= kCCOptionECBMode;
+        }
     }
 
     ~CC_Cryptor_State() {
+        if (_usesEngine()) {
+            _aesKey.Clear();
+            _aesGCM.Clear();
+            _wipe(_buffer, sizeof(_buffer));
+            _wipe(_aesIV, sizeof(_aesIV));
+        }
+        if (!_keyCopy.empty()) {
+            _wipe(_keyCopy.data(), _keyCopy.size());
+        }
     }
 
-    static std::unique_ptr<CC_Cryptor_State> init(
-        CCOperation op, CCAlgorithm alg, CCOptions options, const void* key, size_t keyLength, const void* iv, CCCryptorStatus* statusOut) {
+    // Maps the CCOptions of CCCryptorCreate onto a mode and padding.
+    static void modeFromOptions(CCAlgorithm alg, CCOptions options, CCMode* mode, CCPadding* padding) {
+        if (alg == kCCAlgorithmRC4) {
+            *mode = kCCModeRC4;
+        } else {
+            *mode = (options & kCCOptionECBMode) ? kCCModeECB : kCCModeCBC;
+        }
+        *padding = (options & kCCOptionPKCS7Padding) ? ccPKCS7Padding : ccNoPadding;
+    }
 
-        std::unique_ptr<CC_Cryptor_State> pState = std::make_unique<CC_Cryptor_State>(op, alg, options, key, keyLength, iv);
+    static std::unique_ptr<CC_Cryptor_State> init(CCOperation op,
+                                                  CCAlgorithm alg,
+                                                  CCMode mode,
+                                                  CCPadding padding,
+                                                  CCModeOptions modeOptions,
+                                                  const void* key,
+                                                  size_t keyLength,
+                                                  const void* iv,
+                                                  CCCryptorStatus* statusOut) {
+        std::unique_ptr<CC_Cryptor_State> pState =
+            std::make_unique<CC_Cryptor_State>(op, alg, mode, padding, modeOptions, key, keyLength, iv);
 
         HRESULT initResult = pState->_init();
         if (FAILED(initResult)) {
@@ -98,14 +167,30 @@ struct CC_Cryptor_State {
     }
 
     CCCryptorStatus update(const void* dataIn, size_t dataInLength, void* dataOut, size_t dataOutAvailable, size_t* dataOutMoved) {
+        if (_usesEngine()) {
+            return _cryptorStatusFromHRESULT(_engineUpdate(dataIn, dataInLength, dataOut, dataOutAvailable, dataOutMoved));
+        }
         return _cryptorStatusFromHRESULT(_update(dataIn, dataInLength, dataOut, dataOutAvailable, dataOutMoved));
     }
 
     CCCryptorStatus final(void* dataOut, size_t dataOutAvailable, size_t* dataOutMoved) {
+        if (_usesEngine()) {
+            return _cryptorStatusFromHRESULT(_engineFinal(dataOut, dataOutAvailable, dataOutMoved));
+        }
         return _cryptorStatusFromHRESULT(_final(dataOut, dataOutAvailable, dataOutMoved));
     }
 
     CCCryptorStatus reset(const void* iv) {
+        // The AES key schedule is kept; only the chaining state starts over.
+        if (_usesEngine()) {
+            if (_mode == kCCModeGCM) {
+                UNIMPLEMENTED_WITH_MSG("Use CCCryptorGCMReset to reset a GCM cryptor");
+                return kCCUnimplemented;
+            }
+            _engineReset(iv);
+            return kCCSuccess;
+        }
+
         _iv = iv;
         _ivBuffer = nullptr;
         _inputBuffer.clear();
@@ -119,6 +204,60 @@ struct CC_Cryptor_State {
         return kCCSuccess;
     }
 
+    CCCryptorStatus gcmAddIV(const void* iv, size_t ivLength) {
+        if (_mode != kCCModeGCM || _gcmStarted || (!iv && ivLength > 0)) {
+            return kCCParamError;
+        }
+        _gcmIV.insert(_gcmIV.end(), static_cast<const uint8_t*>(iv), static_cast<const uint8_t*>(iv) + ivLength);
+        return kCCSuccess;
+    }
+
+    CCCryptorStatus gcmAddAAD(const void* data, size_t length) {
+        CCCryptorStatus status = _gcmStart();
+        if (status != kCCSuccess) {
+            return status;
+        }
+        if (!data && length > 0) {
+            return kCCParamError;
+        }
+        _aesGCM.AddAAD(data, length);
+        return kCCSuccess;
+    }
+
+    CCCryptorStatus gcmProcess(CCOperation op, const void* dataIn, size_t dataInLength, void* dataOut) {
+        CCCryptorStatus status = _gcmStart();
+        if (status != kCCSuccess) {
+            return status;
+        }
+        if (op != _op || (dataInLength > 0 && (!dataIn || !dataOut))) {
+            return kCCParamError;
+        }
+        if (op == kCCEncrypt) {
+            _aesGCM.Encrypt(dataIn, dataOut, dataInLength);
+        } else {
+            _aesGCM.Decrypt(dataIn, dataOut, dataInLength);
+        }
+        return kCCSuccess;
+    }
+
+    CCCryptorStatus gcmFinal(uint8_t* tag) {
+        CCCryptorStatus status = _gcmStart();
+        if (status != kCCSuccess) {
+            return status;
+        }
+        _aesGCM.Final(tag);
+        return kCCSuccess;
+    }
+
+    CCCryptorStatus gcmReset() {
+        if (_mode != kCCModeGCM) {
+            return kCCParamError;
+        }
+        _gcmIV.clear();
+        _gcmStarted = false;
+        return kCCSuccess;
+    }
+
     static CCCryptorStatus oneShot(CCOperation op,
                                    CCAlgorithm alg,
                                    CCOptions options,
@@ -130,35 +269,79 @@ struct CC_Cryptor_State {
                                    void* dataOut,
                                    size_t dataOutAvailable,
                                    size_t* dataOutMoved) {
-        CCCryptorStatus status;
         *dataOutMoved = 0;
 
-        std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, options, key, keyLength, iv, &status);
-        if (status != kCCSuccess) {
-            return status;
+        // One-shot calls keep their state on the stack; for small AES messages the heap allocation would be a
+        // noticeable share of the cost.
+        CCMode mode;
+        CCPadding padding;
+        modeFromOptions(alg, options, &mode, &padding);
+        CC_Cryptor_State state(op, alg, mode, padding, 0, key, keyLength, iv);
+        HRESULT initResult = state._init();
+        if (FAILED(initResult)) {
+            return _cryptorStatusFromHRESULT(initResult);
         }
 
         size_t dataMoved1 = 0;
-        status = pState->update(dataIn, dataInLength, dataOut, dataOutAvailable, &dataMoved1);
+        CCCryptorStatus status = state.update(dataIn, dataInLength, dataOut, dataOutAvailable, &dataMoved1);
         *dataOutMoved = dataMoved1;
         if (status != kCCSuccess) {
             return status;
         }
 
         size_t dataMoved2 = 0;
-        status = pState->final((uint8_t*)dataOut + dataMoved1, dataOutAvailable - dataMoved1, &dataMoved2);
+        status = state.final((uint8_t*)dataOut + dataMoved1, dataOutAvailable - dataMoved1, &dataMoved2);
         *dataOutMoved = dataMoved1 + dataMoved2;
         return status;
     }
 
+    // GCM one-shots share the stack-allocated setup with CCCrypt and always produce the full tag.
+    static CCCryptorStatus gcmOneShot(CCOperation op,
+                                      CCAlgorithm alg,
+                                      const void* key,
+                                      size_t keyLength,
+                                      const void* iv,
+                                      size_t ivLength,
+                                      const void* aData,
+                                      size_t aDataLength,
+                                      const void* dataIn,
+                                      size_t dataInLength,
+                                      void* dataOut,
+                                      uint8_t* tag) {
+        CC_Cryptor_State state(op, alg, kCCModeGCM, ccNoPadding, 0, key, keyLength, nullptr);
+        HRESULT initResult = state._init();
+        if (FAILED(initResult)) {
+            return _cryptorStatusFromHRESULT(initResult);
+        }
+
+        CCCryptorStatus status = state.gcmAddIV(iv, ivLength);
+        if (status == kCCSuccess) {
+            status = state.gcmAddAAD(aData, aDataLength);
+        }
+        if (status == kCCSuccess) {
+            status = state.gcmProcess(op, dataIn, dataInLength, dataOut);
+        }
+        if (status == kCCSuccess) {
+            status = state.gcmFinal(tag);
+        }
+        return status;
+    }
+
+    CCOperation operation() const {
+        return _op;
+    }
+
     size_t outputLength(size_t inputLength, bool final) {
         // For stream ciphers, the output size is always equal to the input size. For block ciphers, the output size will always be less
         // than or equal to the input size plus the size of one block
 
-        if (_alg == kCCAlgorithmRC4) {
+        if (_alg == kCCAlgorithmRC4 || _mode == kCCModeCTR || _mode == kCCModeGCM) {
             return inputLength;
         }
 
+        // Data buffered by earlier updates comes out along with the new input.
+        inputLength += _usesEngine() ? _bufferLength : _inputBuffer.size();
+
         // Round down the input length to the nearest block
         size_t output = inputLength - (inputLength % _blockSize);
 
@@ -182,6 +365,46 @@ private:
             RETURN_HR_MSG(E_INVALIDARG, "Expected operation kCCEncrypt or kCCDecrypt");
         }
 
+        // Validate mode parameter
+        switch (_mode) {
+            case kCCModeECB:
+            case kCCModeCBC:
+                if (_alg == kCCAlgorithmRC4) {
+                    RETURN_HR_MSG(E_INVALIDARG, "Block modes are not valid on stream ciphers.");
+                }
+                break;
+            case kCCModeRC4:
+                if (_alg != kCCAlgorithmRC4) {
+                    RETURN_HR_MSG(E_INVALIDARG, "kCCModeRC4 requires kCCAlgorithmRC4.");
+                }
+                break;
+            case kCCModeCTR:
+            case kCCModeGCM:
+                if (_alg != kCCAlgorithmAES) {
+                    UNIMPLEMENTED_WITH_MSG("Counter modes are only supported with kCCAlgorithmAES");
+                    return E_NOTIMPL;
+                }
+                if (_padding != ccNoPadding) {
+                    RETURN_HR_MSG(E_INVALIDARG, "Padding is not a valid option on counter modes.");
+                }
+                if (_mode == kCCModeCTR && (_modeOptions & kCCModeOptionCTR_LE)) {
+                    UNIMPLEMENTED_WITH_MSG("kCCModeOptionCTR_LE is not supported");
+                    return E_NOTIMPL;
+                }
+                break;
+            case kCCModeCFB:
+            case kCCModeOFB:
+            case kCCModeCFB8:
+                UNIMPLEMENTED_WITH_MSG("CFB and OFB modes are not supported");
+                return E_NOTIMPL;
+            default:
+                RETURN_HR_MSG(E_INVALIDARG, "Unknown mode");
+        }
+
+        if (_padding != ccNoPadding && _padding != ccPKCS7Padding) {
+            RETURN_HR_MSG(E_INVALIDARG, "Unknown padding");
+        }
+
         // Validate algorithm/key parameter
         switch (_alg) {
         case kCCAlgorithmAES:
@@ -223,9 +446,31 @@ private:
         return S_OK;
     }
 
+    bool _usesEngine() const {
+        return _alg == kCCAlgorithmAES;
+    }
+
     HRESULT _init() {
         RETURN_IF_FAILED(_validateParams());
 
+        if (_usesEngine()) {
+            // Expanding the key is the expensive part of setup, so it's done once here and kept until release.
+            _aesKey.Init(_key, _keyLength);
+            _key = nullptr;
+            if (_mode == kCCModeGCM) {
+                _aesGCM.Init(&_aesKey);
+            }
+            _engineReset(_iv);
+            _iv = nullptr;
+            return S_OK;
+        }
+
+        // The caller's key only has to live until create returns, but BCrypt keys are rebuilt on reset.
+        if (_keyCopy.empty()) {
+            _keyCopy.assign(static_cast<const uint8_t*>(_key), static_cast<const uint8_t*>(_key) + _keyLength);
+            _key = _keyCopy.data();
+        }
+
         ComPtr<ISymmetricKeyAlgorithmProviderStatics> symmetricKeyAlgorithmProviderStatics;
         ComPtr<ISymmetricAlgorithmNamesStatics> symmetricAlgorithmNamesStatics;
         ComPtr<ICryptographicBufferStatics> cryptographicBufferStatics;
@@ -391,9 +636,15 @@ private:
         RETURN_IF_FAILED_LOG(dataOutBuffer.As(&bufferAccess));
         BYTE* pRawOutput;
         RETURN_IF_FAILED_LOG(bufferAccess->Buffer(&pRawOutput));
-        memcpy_s(dataOut, dataOutAvailable, pRawOutput, dataOutSize);
 
-        *dataOutMoved = dataOutSize;
+        // Decrypting with padding strips it, so the result can be shorter than the input; encrypting an update with padding
+        // appends a block that isn't part of the stream.
+        UINT32 rawOutputLength;
+        RETURN_IF_FAILED_LOG(dataOutBuffer->get_Length(&rawOutputLength));
+        size_t dataOutLength = std::min(static_cast<size_t>(rawOutputLength), dataOutSize);
+        memcpy_s(dataOut, dataOutAvailable, pRawOutput, dataOutLength);
+
+        *dataOutMoved = dataOutLength;
 
         // If this is the final operation, we are done
         if (final) {
@@ -460,8 +711,186 @@ private:
         return _performOp(dataOut, dataOutAvailable, _blockSize, _inputBuffer.size(), dataOutMoved, true);
     }
 
+    void _engineReset(const void* iv) {
+        _bufferLength = 0;
+        if (iv) {
+            memcpy(_aesIV, iv, sizeof(_aesIV));
+        } else {
+            memset(_aesIV, 0, sizeof(_aesIV));
+        }
+
+        if (_mode == kCCModeCTR) {
+            _aesCTR.Init(&_aesKey, _aesIV, false);
+        } else if (_mode == kCCModeGCM) {
+            _gcmIV.clear();
+            _gcmStarted = false;
+        }
+    }
+
+    // GCM takes its IV through CCCryptorGCMAddIV, so the message starts with the first AAD, data or tag request.
+    CCCryptorStatus _gcmStart() {
+        if (_mode != kCCModeGCM) {
+            return kCCParamError;
+        }
+        if (!_gcmStarted) {
+            if (_gcmIV.empty()) {
+                return kCCParamError;
+            }
+            _aesGCM.SetIV(_gcmIV.data(), _gcmIV.size());
+            _gcmStarted = true;
+        }
+        return kCCSuccess;
+    }
+
+    void _engineBlocks(const uint8_t* in, uint8_t* out, size_t blockCount) {
+        if (_mode == kCCModeECB) {
+            if (_op == kCCEncrypt) {
+                _aesKey.EncryptBlocks(in, out, blockCount);
+            } else {
+                _aesKey.DecryptBlocks(in, out, blockCount);
+            }
+        } else {
+            if (_op == kCCEncrypt) {
+                _aesKey.EncryptCBC(_aesIV, in, out, blockCount);
+            } else {
+                _aesKey.DecryptCBC(_aesIV, in, out, blockCount);
+            }
+        }
+    }
+
+    HRESULT _engineUpdate(const void* dataIn, size_t dataInLength, void* dataOut, size_t dataOutAvailable, size_t* dataOutMoved) {
+        *dataOutMoved = 0;
+        if (dataInLength == 0) {
+            return S_OK;
+        }
+        if (!dataIn || !dataOut) {
+            return E_INVALIDARG;
+        }
+
+        if (_mode == kCCModeCTR || _mode == kCCModeGCM) {
+            if (dataOutAvailable < dataInLength) {
+                return SEC_E_BUFFER_TOO_SMALL;
+            }
+            if (_mode == kCCModeCTR) {
+                _aesCTR.Process(dataIn, dataOut, dataInLength);
+            } else {
+                CCCryptorStatus status = gcmProcess(_op, dataIn, dataInLength, dataOut);
+                if (status != kCCSuccess) {
+                    return E_INVALIDARG;
+                }
+            }
+            *dataOutMoved = dataInLength;
+            return S_OK;
+        }
+
+        // Whole blocks go straight through; a trailing partial block is buffered. Decrypting with padding also holds back
+        // the last whole block, since only final knows whether it carries the padding.
+        size_t total = _bufferLength + dataInLength;
+        size_t held = total % _blockSize;
+        if (held == 0 && _op == kCCDecrypt && _padding == ccPKCS7Padding) {
+            held = _blockSize;
+        }
+        size_t outputLength = total - held;
+        if (outputLength > dataOutAvailable) {
+            return SEC_E_BUFFER_TOO_SMALL;
+        }
+
+        const uint8_t* input = static_cast<const uint8_t*>(dataIn);
+        uint8_t* output = static_cast<uint8_t*>(dataOut);
+
+        // The output trails the input by the buffered bytes, so working in place would overwrite input not yet read.
+        std::vector<uint8_t> inputCopy;
+        if (_bufferLength > 0 && outputLength > 0 && output < input + dataInLength && input < output + outputLength) {
+            inputCopy.assign(input, input + dataInLength);
+            input = inputCopy.data();
+        }
+        const uint8_t* inputEnd = input + dataInLength;
+
+        if (outputLength > 0 && _bufferLength > 0) {
+            size_t fill = _blockSize - _bufferLength;
+            memcpy(_buffer + _bufferLength, input, fill);
+            _engineBlocks(_buffer, output, 1);
+            input += fill;
+            output += _blockSize;
+            outputLength -= _blockSize;
+            _bufferLength = 0;
+        }
+
+        if (outputLength > 0) {
+            _engineBlocks(input, output, outputLength / _blockSize);
+            input += outputLength;
+        }
+
+        size_t remaining = inputEnd - input;
+        memcpy(_buffer + _bufferLength, input, remaining);
+        _bufferLength += remaining;
+
+        *dataOutMoved = total - held;
+        return S_OK;
+    }
+
+    HRESULT _engineFinal(void* dataOut, size_t dataOutAvailable, size_t* dataOutMoved) {
+        *dataOutMoved = 0;
+        if (_mode == kCCModeCTR || _mode == kCCModeGCM) {
+            return S_OK;
+        }
+
+        if (_padding != ccPKCS7Padding) {
+            // There can be no leftover data unless kCCOptionPKCS7Padding is specified
+            return _bufferLength == 0 ? S_OK : SEC_E_CANNOT_PACK;
+        }
+
+        uint8_t block[kCCBlockSizeAES128];
+        if (_op == kCCEncrypt) {
+            if (dataOutAvailable < _blockSize) {
+                return SEC_E_BUFFER_TOO_SMALL;
+            }
+
+            // PKCS7 always adds padding, a whole block of it when the input ends on a block boundary.
+            uint8_t pad = static_cast<uint8_t>(_blockSize - _bufferLength);
+            memset(_buffer + _bufferLength, pad, pad);
+            _engineBlocks(_buffer, block, 1);
+            memcpy(dataOut, block, _blockSize);
+            _bufferLength = 0;
+            *dataOutMoved = _blockSize;
+            return S_OK;
+        }
+
+        if (_bufferLength != _blockSize) {
+            return _bufferLength == 0 ? CRYPT_E_BAD_ENCODE : SEC_E_CANNOT_PACK;
+        }
+
+        _engineBlocks(_buffer, block, 1);
+        _bufferLength = 0;
+
+        // Check every padding byte without branching on their values.
+        uint8_t pad = block[_blockSize - 1];
+        uint8_t invalid = static_cast<uint8_t>((pad == 0) | (pad > _blockSize));
+        for (size_t i = 0; i < _blockSize; ++i) {
+            uint8_t inPadding = static_cast<uint8_t>(i >= _blockSize - pad);
+            invalid |= inPadding & static_cast<uint8_t>(block[i] != pad);
+        }
+        if (invalid) {
+            _wipe(block, sizeof(block));
+            return CRYPT_E_BAD_ENCODE;
+        }
+
+        size_t plaintextLength = _blockSize - pad;
+        if (dataOutAvailable < plaintextLength) {
+            _wipe(block, sizeof(block));
+            return SEC_E_BUFFER_TOO_SMALL;
+        }
+        memcpy(dataOut, block, plaintextLength);
+        _wipe(block, sizeof(block));
+        *dataOutMoved = plaintextLength;
+        return S_OK;
+    }
+
     CCOperation _op;
     CCAlgorithm _alg;
+    CCMode _mode;
+    CCPadding _padding;
+    CCModeOptions _modeOptions;
     CCOptions _options;
     const void* _key;
     size_t _keyLength;
@@ -470,6 +899,17 @@ private:
     ComPtr<ICryptographicKey> _cryptographicKey;
     ComPtr<IBuffer> _ivBuffer;
     std::vector<uint8_t> _inputBuffer;
+    std::vector<uint8_t> _keyCopy;
+
+    // AES runs in-process on the cached key schedule rather than through BCrypt.
+    CCAESKey _aesKey;
+    CCAESCTR _aesCTR;
+    CCAESGCM _aesGCM;
+    uint8_t _aesIV[kCCBlockSizeAES128];
+    uint8_t _buffer[kCCBlockSizeAES128];
+    size_t _bufferLength;
+    std::vector<uint8_t> _gcmIV;
+    bool _gcmStarted;
 };
 
 /**
@@ -480,8 +920,12 @@ CCCryptorStatus CCCryptorCreate(
     CCOperation op, CCAlgorithm alg, CCOptions options, const void* key, size_t keyLength, const void* iv, CCCryptorRef* cryptorRef) {
     *cryptorRef = nullptr;
 
+    CCMode mode;
+    CCPadding padding;
+    CC_Cryptor_State::modeFromOptions(alg, options, &mode, &padding);
+
     CCCryptorStatus status;
-    std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, options, key, keyLength, iv, &status);
+    std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, mode, padding, 0, key, keyLength, iv, &status);
     if (status == kCCSuccess) {
         *cryptorRef = pState.release();
     }
@@ -510,8 +954,44 @@ CCCryptorStatus CCCryptorCreateFromData(CCOperation op,
     *dataUsed = 0;
     *cryptorRef = nullptr;
 
+    CCMode mode;
+    CCPadding padding;
+    CC_Cryptor_State::modeFromOptions(alg, options, &mode, &padding);
+
     CCCryptorStatus status;
-    std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, options, key, keyLength, iv, &status);
+    std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, mode, padding, 0, key, keyLength, iv, &status);
+    if (status == kCCSuccess) {
+        *cryptorRef = pState.release();
+    }
+
+    return status;
+}
+
+/**
+@Status Caveat
+@Notes kCCModeCFB, kCCModeOFB, kCCModeCFB8 and kCCModeOptionCTR_LE are unsupported, as are kCCModeCTR and kCCModeGCM with
+       algorithms other than kCCAlgorithmAES. tweak and numRounds are ignored.
+*/
+CCCryptorStatus CCCryptorCreateWithMode(CCOperation op,
+                                        CCMode mode,
+                                        CCAlgorithm alg,
+                                        CCPadding padding,
+                                        const void* iv,
+                                        const void* key,
+                                        size_t keyLength,
+                                        const void* tweak,
+                                        size_t tweakLength,
+                                        int numRounds,
+                                        CCModeOptions options,
+                                        CCCryptorRef* cryptorRef) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    *cryptorRef = nullptr;
+
+    CCCryptorStatus status;
+    std::unique_ptr<CC_Cryptor_State> pState = CC_Cryptor_State::init(op, alg, mode, padding, options, key, keyLength, iv, &status);
     if (status == kCCSuccess) {
         *cryptorRef = pState.release();
     }
@@ -588,4 +1068,213 @@ CCCryptorStatus CCCrypt(CCOperation op,
                         size_t dataOutAvailable,
                         size_t* dataOutMoved) {
     return CC_Cryptor_State::oneShot(op, alg, options, key, keyLength, iv, dataIn, dataInLength, dataOut, dataOutAvailable, dataOutMoved);
-}
\ No newline at end of file
+}
+
+/**
+@Status Interoperable
+@Notes IV bytes from repeated calls are concatenated, up until the first AAD or data.
+*/
+CCCryptorStatus CCCryptorGCMAddIV(CCCryptorRef cryptorRef, const void* iv, size_t ivLen) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmAddIV(iv, ivLen);
+}
+
+/**
+@Status Interoperable
+*/
+CCCryptorStatus CCCryptorGCMSetIV(CCCryptorRef cryptorRef, const void* iv, size_t ivLen) {
+    if (!cryptorRef || !iv || ivLen == 0) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmAddIV(iv, ivLen);
+}
+
+/**
+@Status Interoperable
+*/
+CCCryptorStatus CCCryptorGCMAddAAD(CCCryptorRef cryptorRef, const void* aData, size_t aDataLen) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmAddAAD(aData, aDataLen);
+}
+
+/**
+@Status Interoperable
+*/
+CCCryptorStatus CCCryptorGCMEncrypt(CCCryptorRef cryptorRef, const void* dataIn, size_t dataInLength, void* dataOut) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmProcess(kCCEncrypt, dataIn, dataInLength, dataOut);
+}
+
+/**
+@Status Interoperable
+*/
+CCCryptorStatus CCCryptorGCMDecrypt(CCCryptorRef cryptorRef, const void* dataIn, size_t dataInLength, void* dataOut) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmProcess(kCCDecrypt, dataIn, dataInLength, dataOut);
+}
+
+/**
+@Status Interoperable
+@Notes Writes the first *tagLength bytes of the tag, up to 16. Decrypting callers must compare it themselves;
+       CCCryptorGCMFinalize does that in constant time.
+*/
+CCCryptorStatus CCCryptorGCMFinal(CCCryptorRef cryptorRef, void* tagOut, size_t* tagLength) {
+    if (!cryptorRef || !tagOut || !tagLength || *tagLength == 0) {
+        return kCCParamError;
+    }
+
+    uint8_t tag[CCAESGCM::c_tagLength];
+    CCCryptorStatus status = cryptorRef->gcmFinal(tag);
+    if (status != kCCSuccess) {
+        return status;
+    }
+
+    *tagLength = std::min(*tagLength, sizeof(tag));
+    memcpy(tagOut, tag, *tagLength);
+    return kCCSuccess;
+}
+
+/**
+@Status Interoperable
+@Notes Encrypting cryptors write the tag; decrypting cryptors verify it, returning kCCDecodeError on a mismatch.
+*/
+CCCryptorStatus CCCryptorGCMFinalize(CCCryptorRef cryptorRef, void* tag, size_t tagSize) {
+    if (!cryptorRef || !tag || !_isValidGCMTagLength(tagSize)) {
+        return kCCParamError;
+    }
+
+    uint8_t computedTag[CCAESGCM::c_tagLength];
+    CCCryptorStatus status = cryptorRef->gcmFinal(computedTag);
+    if (status != kCCSuccess) {
+        return status;
+    }
+
+    if (cryptorRef->operation() == kCCEncrypt) {
+        memcpy(tag, computedTag, tagSize);
+        return kCCSuccess;
+    }
+
+    return _constantTimeEquals(computedTag, static_cast<const uint8_t*>(tag), tagSize) ? kCCSuccess : kCCDecodeError;
+}
+
+/**
+@Status Interoperable
+@Notes Keeps the key and hash key; the next message needs a new IV.
+*/
+CCCryptorStatus CCCryptorGCMReset(CCCryptorRef cryptorRef) {
+    if (!cryptorRef) {
+        return kCCParamError;
+    }
+
+    return cryptorRef->gcmReset();
+}
+
+/**
+@Status Interoperable
+@Notes Decryption writes the computed tag to tagOut; compare it against the received tag, or use CCCryptorGCMOneshotDecrypt.
+*/
+CCCryptorStatus CCCryptorGCM(CCOperation op,
+                             CCAlgorithm alg,
+                             const void* key,
+                             size_t keyLength,
+                             const void* iv,
+                             size_t ivLen,
+                             const void* aData,
+                             size_t aDataLen,
+                             const void* dataIn,
+                             size_t dataInLength,
+                             void* dataOut,
+                             void* tagOut,
+                             size_t* tagLength) {
+    if (!tagOut || !tagLength || *tagLength == 0 || !iv || ivLen == 0) {
+        return kCCParamError;
+    }
+
+    uint8_t tag[CCAESGCM::c_tagLength];
+    CCCryptorStatus status = CC_Cryptor_State::gcmOneShot(op, alg, key, keyLength, iv, ivLen, aData, aDataLen, dataIn, dataInLength, dataOut, tag);
+    if (status != kCCSuccess) {
+        return status;
+    }
+
+    *tagLength = std::min(*tagLength, sizeof(tag));
+    memcpy(tagOut, tag, *tagLength);
+    return kCCSuccess;
+}
+
+/**
+@Status Interoperable
+*/
+CCCryptorStatus CCCryptorGCMOneshotEncrypt(CCAlgorithm alg,
+                                           const void* key,
+                                           size_t keyLength,
+                                           const void* iv,
+                                           size_t ivLen,
+                                           const void* aData,
+                                           size_t aDataLen,
+                                           const void* dataIn,
+                                           size_t dataInLength,
+                                           void* dataOut,
+                                           void* tagOut,
+                                           size_t tagLength) {
+    if (!tagOut || !_isValidGCMTagLength(tagLength) || !iv || ivLen == 0) {
+        return kCCParamError;
+    }
+
+    uint8_t tag[CCAESGCM::c_tagLength];
+    CCCryptorStatus status =
+        CC_Cryptor_State::gcmOneShot(kCCEncrypt, alg, key, keyLength, iv, ivLen, aData, aDataLen, dataIn, dataInLength, dataOut, tag);
+    if (status != kCCSuccess) {
+        return status;
+    }
+
+    memcpy(tagOut, tag, tagLength);
+    return kCCSuccess;
+}
+
+/**
+@Status Interoperable
+@Notes The tag is compared in constant time. On a mismatch dataOut is zeroed and kCCDecodeError returned.
+*/
+CCCryptorStatus CCCryptorGCMOneshotDecrypt(CCAlgorithm alg,
+                                           const void* key,
+                                           size_t keyLength,
+                                           const void* iv,
+                                           size_t ivLen,
+                                           const void* aData,
+                                           size_t aDataLen,
+                                           const void* dataIn,
+                                           size_t dataInLength,
+                                           void* dataOut,
+                                           const void* tagIn,
+                                           size_t tagLength) {
+    if (!tagIn || !_isValidGCMTagLength(tagLength) || !iv || ivLen == 0) {
+        return kCCParamError;
+    }
+
+    uint8_t tag[CCAESGCM::c_tagLength];
+    CCCryptorStatus status =
+        CC_Cryptor_State::gcmOneShot(kCCDecrypt, alg, key, keyLength, iv, ivLen, aData, aDataLen, dataIn, dataInLength, dataOut, tag);
+    if (status != kCCSuccess) {
+        return status;
+    }
+
+    if (!_constantTimeEquals(tag, static_cast<const uint8_t*>(tagIn), tagLength)) {
+        _wipe(dataOut, dataInLength);
+        return kCCDecodeError;
+    }
+
+    return kCCSuccess;
+}
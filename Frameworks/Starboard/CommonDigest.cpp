@@ -20,18 +20,34 @@
 #include <CommonCrypto\CommonCryptor.h>
 #include <ErrorHandling.h>
 #include <assert.h>
-#include <StubReturn.h>
 
+#include "CCDigestEngine.h"
+
+#include <algorithm>
+
+// MD2 and MD4 go through BCrypt; everything else is hashed in-process by CCDigestContext, which avoids a provider
+// handle and a hash object allocation per digest.
 struct CC_Digest_State {
     CC_Digest_State(const unsigned int digestLength, const LPCWSTR algorithm) :
         _hAlg(INVALID_HANDLE_VALUE),
         _hHash(INVALID_HANDLE_VALUE),
         _pHashObject(nullptr),
         _algorithm(algorithm),
-        _digestLength(digestLength) {
+        _digestLength(digestLength),
+        _usesEngine(false) {
         _init();
     }
 
+    explicit CC_Digest_State(CCDigestAlgorithm algorithm) :
+        _hAlg(INVALID_HANDLE_VALUE),
+        _hHash(INVALID_HANDLE_VALUE),
+        _pHashObject(nullptr),
+        _algorithm(nullptr),
+        _digestLength(CCDigestContext::GetDigestLength(algorithm)),
+        _usesEngine(true) {
+        _context.Init(algorithm);
+    }
+
     ~CC_Digest_State() {
         if (_hAlg != INVALID_HANDLE_VALUE) {
             BCryptCloseAlgorithmProvider(_hAlg, 0);
@@ -61,6 +77,15 @@ struct CC_Digest_State {
         return 1;
     }
 
+    static int init(CC_Digest_State** ctx, CCDigestAlgorithm algorithm) {
+        if (!ctx) {
+            return -1;
+        }
+
+        *ctx = new CC_Digest_State(algorithm);
+        return 1;
+    }
+
     // internal implemention of update for all hash contexts
     static int update(CC_Digest_State** ctx, const void* data, CC_LONG len) {
         CC_Digest_State* state = ctx ? *ctx : nullptr;
@@ -113,6 +138,15 @@ struct CC_Digest_State {
         return digest;
     }
 
+    // one shot digests that don't need a heap allocated context
+    static unsigned char* oneShotDigest(CCDigestAlgorithm algorithm, const void* input, CC_LONG length, unsigned char* digest) {
+        CCDigestContext context;
+        context.Init(algorithm);
+        context.Update(input, length);
+        context.Final(digest);
+        return digest;
+    }
+
 private:
     NTSTATUS _init() {
         DWORD cbHashObject;
@@ -138,7 +172,7 @@ private:
         }
 
         // at this point, state has to be either NULL or valid
-        if (state->_hHash == INVALID_HANDLE_VALUE) {
+        if (!state->_usesEngine && state->_hHash == INVALID_HANDLE_VALUE) {
             delete state;
             return false;
         }
@@ -147,6 +181,11 @@ private:
     }
 
     int _hashData(const BYTE* data, CC_LONG length) {
+        if (_usesEngine) {
+            _context.Update(data, length);
+            return 1;
+        }
+
         NTSTATUS status = BCryptHashData(_hHash, const_cast<BYTE*>(data), length, 0);
         if (SUCCEEDED_NTSTATUS(status)) {
             return 1;
@@ -157,14 +196,21 @@ private:
     }
 
     void _finishHash(BYTE* digest) {
+        if (_usesEngine) {
+            _context.Final(digest);
+            return;
+        }
+
         LOG_IF_NTSTATUS_FAILED(BCryptFinishHash(_hHash, digest, _digestLength, 0));
     }
 
     const unsigned int _digestLength;
     const LPCWSTR _algorithm;
+    const bool _usesEngine;
     BCRYPT_ALG_HANDLE _hAlg;
     BCRYPT_HASH_HANDLE _hHash;
     PBYTE _pHashObject;
+    CCDigestContext _context;
 };
 
 /**
@@ -227,7 +273,7 @@ extern "C" unsigned char* CC_MD4(const void* input, CC_LONG length, unsigned cha
 @Status Interoperable
 */
 extern "C" int CC_MD5_Init(CC_MD5_CTX* ctx) {
-    return CC_Digest_State::init(ctx, CC_MD5_DIGEST_LENGTH, BCRYPT_MD5_ALGORITHM);
+    return CC_Digest_State::init(ctx, kCCDigestMD5);
 }
 
 /**
@@ -248,14 +294,14 @@ extern "C" int CC_MD5_Final(unsigned char* digest, CC_MD5_CTX* ctx) {
 @Status Interoperable
 */
 extern "C" unsigned char* CC_MD5(const void* input, CC_LONG length, unsigned char* digest) {
-    return CC_Digest_State::oneShotDigest(CC_MD5_Init, CC_MD5_Update, CC_MD5_Final, input, length, digest);
+    return CC_Digest_State::oneShotDigest(kCCDigestMD5, input, length, digest);
 }
 
 /**
 @Status Interoperable
 */
 extern "C" int CC_SHA1_Init(CC_SHA1_CTX* ctx) {
-    return CC_Digest_State::init(ctx, CC_SHA1_DIGEST_LENGTH, BCRYPT_SHA1_ALGORITHM);
+    return CC_Digest_State::init(ctx, kCCDigestSHA1);
 }
 
 /**
@@ -276,46 +322,42 @@ extern "C" int CC_SHA1_Final(unsigned char* digest, CC_SHA1_CTX* ctx) {
 @Status Interoperable
 */
 extern "C" unsigned char* CC_SHA1(const void* input, CC_LONG length, unsigned char* digest) {
-    return CC_Digest_State::oneShotDigest(CC_SHA1_Init, CC_SHA1_Update, CC_SHA1_Final, input, length, digest);
+    return CC_Digest_State::oneShotDigest(kCCDigestSHA1, input, length, digest);
 }
 
 /**
-@Status Stub
+@Status Interoperable
 */
 extern "C" int CC_SHA224_Init(CC_SHA224_CTX* ctx) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CC_Digest_State::init(ctx, kCCDigestSHA224);
 }
 
 /**
-@Status Stub
+@Status Interoperable
 */
 extern "C" int CC_SHA224_Update(CC_SHA224_CTX* ctx, const void* data, CC_LONG len) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CC_Digest_State::update(ctx, data, len);
 }
 
 /**
-@Status Stub
+@Status Interoperable
 */
 extern "C" int CC_SHA224_Final(unsigned char* digest, CC_SHA224_CTX* ctx) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CC_Digest_State::final(digest, ctx);
 }
 
 /**
-@Status Stub
+@Status Interoperable
 */
 extern "C" unsigned char* CC_SHA224(const void* input, CC_LONG length, unsigned char* digest) {
-    UNIMPLEMENTED();
-    return StubReturn();
+    return CC_Digest_State::oneShotDigest(kCCDigestSHA224, input, length, digest);
 }
 
 /**
 @Status Interoperable
 */
 extern "C" int CC_SHA256_Init(CC_SHA256_CTX* ctx) {
-    return CC_Digest_State::init(ctx, CC_SHA256_DIGEST_LENGTH, BCRYPT_SHA256_ALGORITHM);
+    return CC_Digest_State::init(ctx, kCCDigestSHA256);
 }
 
 /**
@@ -336,14 +378,14 @@ extern "C" int CC_SHA256_Final(unsigned char* digest, CC_SHA256_CTX* ctx) {
 @Status Interoperable
 */
 extern "C" unsigned char* CC_SHA256(const void* input, CC_LONG length, unsigned char* digest) {
-    return CC_Digest_State::oneShotDigest(CC_SHA256_Init, CC_SHA256_Update, CC_SHA256_Final, input, length, digest);
+    return CC_Digest_State::oneShotDigest(kCCDigestSHA256, input, length, digest);
 }
 
 /**
 @Status Interoperable
 */
 extern "C" int CC_SHA384_Init(CC_SHA384_CTX* ctx) {
-    return CC_Digest_State::init(ctx, CC_SHA384_DIGEST_LENGTH, BCRYPT_SHA384_ALGORITHM);
+    return CC_Digest_State::init(ctx, kCCDigestSHA384);
 }
 
 /**
@@ -364,14 +406,14 @@ extern "C" int CC_SHA384_Final(unsigned char* digest, CC_SHA384_CTX* ctx) {
 @Status Interoperable
 */
 extern "C" unsigned char* CC_SHA384(const void* input, CC_LONG length, unsigned char* digest) {
-    return CC_Digest_State::oneShotDigest(CC_SHA384_Init, CC_SHA384_Update, CC_SHA384_Final, input, length, digest);
+    return CC_Digest_State::oneShotDigest(kCCDigestSHA384, input, length, digest);
 }
 
 /**
 @Status Interoperable
 */
 extern "C" int CC_SHA512_Init(CC_SHA512_CTX* ctx) {
-    return CC_Digest_State::init(ctx, CC_SHA512_DIGEST_LENGTH, BCRYPT_SHA512_ALGORITHM);
+    return CC_Digest_State::init(ctx, kCCDigestSHA512);
 }
 
 /**
@@ -392,5 +434,31 @@ extern "C" int CC_SHA512_Final(unsigned char* digest, CC_SHA512_CTX* ctx) {
 @Status Interoperable
 */
 extern "C" unsigned char* CC_SHA512(const void* input, CC_LONG length, unsigned char* digest) {
-    return CC_Digest_State::oneShotDigest(CC_SHA512_Init, CC_SHA512_Update, CC_SHA512_Final, input, length, digest);
+    return CC_Digest_State::oneShotDigest(kCCDigestSHA512, input, length, digest);
+}
+
+/**
+@Status Interoperable
+@Notes Microsoft Extension. Messages are hashed side by side in SIMD lanes when the CPU supports it.
+*/
+extern "C" int CC_DigestMultiple(CCDigestAlgorithm algorithm,
+                                 const void* const* data,
+                                 const CC_LONG* lengths,
+                                 size_t count,
+                                 unsigned char* const* digests) {
+    if (!CCDigestContext::IsSupported(algorithm)) {
+        return -1;
+    }
+
+    // CC_LONG is narrower than size_t on 64-bit targets, so lengths are widened a batch at a time.
+    static const size_t c_batchSize = 64;
+    size_t batchLengths[c_batchSize];
+
+    for (size_t start = 0; start < count; start += c_batchSize) {
+        size_t batchCount = std::min(c_batchSize, count - start);
+        std::copy(lengths + start, lengths + start + batchCount, batchLengths);
+        CCDigestMultiple(algorithm, data + start, batchLengths, batchCount, digests + start);
+    }
+
+    return 1;
 }
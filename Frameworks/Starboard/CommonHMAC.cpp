@@ -17,33 +17,15 @@
 #include <Windows.h>
 #include <CommonCrypto\CommonHMAC.h>
 #include <CommonCrypto\CommonDigest.h>
-#include <COMIncludes.h>
-#include <wrl\wrappers\corewrappers.h>
-#include <wrl\client.h>
-#include <windows.security.cryptography.h>
-#include <windows.storage.streams.h>
-#include <COMIncludes_End.h>
 #include <ErrorHandling.h>
-#include <StubReturn.h>
-#include <RawBuffer.h>
 
-using namespace Microsoft::WRL;
-using namespace ABI::Windows::Storage::Streams;
-using namespace ABI::Windows::Security::Cryptography::Core;
-using namespace Windows::Foundation;
+#include "CCDigestEngine.h"
 
+// HMAC (RFC 2104) over the in-process digests. The key is folded into the inner and outer digest states once at init,
+// so each message only pays for hashing itself plus one extra block.
 struct CC_Hmac_State {
-    CC_Hmac_State(CCHmacAlgorithm algorithm, const void* key, size_t keyLength) :
-        _algorithm(algorithm),
-        _key(key),
-        _keyLength(keyLength),
-        _isValid(true) {
-        if (FAILED(_init())) {
-            invalidate();
-        }
-    }
-
-    ~CC_Hmac_State() {
+    CC_Hmac_State(CCDigestAlgorithm algorithm, const void* key, size_t keyLength) {
+        CCDigestHmacInit(algorithm, key, keyLength, &_inner, &_outer);
     }
 
     static void init(CC_Hmac_State** ctx, CCHmacAlgorithm algorithm, const void* key, size_t keyLength) {
@@ -54,14 +36,13 @@ struct CC_Hmac_State {
 
         *ctx = nullptr;
 
-        CC_Hmac_State* state = new CC_Hmac_State(algorithm, key, keyLength);
-        if (!_validState(&state)) {
-            LOG_HR(E_UNEXPECTED);
+        CCDigestAlgorithm digestAlgorithm;
+        if (!_digestAlgorithm(algorithm, &digestAlgorithm)) {
+            LOG_HR(E_INVALIDARG);
             return;
         }
 
-        *ctx = state;
-        return;
+        *ctx = new CC_Hmac_State(digestAlgorithm, key, keyLength);
     }
 
     static void update(CC_Hmac_State** ctx, const void* data, size_t len) {
@@ -70,139 +51,73 @@ struct CC_Hmac_State {
             return;
         }
 
-        if (FAILED((*ctx)->_update(data, len))) {
-            delete *ctx;
-            *ctx = nullptr;
-        }
+        (*ctx)->_inner.Update(data, len);
     }
 
     static void final(void* digest, CC_Hmac_State** ctx) {
-       if (!_validState(ctx)) {
-           LOG_HR(E_INVALIDARG);
-           return;
-       }
-
-        if (FAILED((*ctx)->_finishHash(digest))) {
-            LOG_HR(E_UNEXPECTED);
+        if (!_validState(ctx)) {
+            LOG_HR(E_INVALIDARG);
+            return;
         }
+
+        (*ctx)->_finish(static_cast<unsigned char*>(digest));
         delete *ctx;
         *ctx = nullptr;
     }
 
     static void oneShot(CCHmacAlgorithm algorithm, const void* key, size_t keyLength, const void* data, size_t dataLength, void* macOut) {
-        CC_Hmac_State* ctx;
-
-        init(&ctx, algorithm, key, keyLength);
-
-        update(&ctx, data, dataLength);
+        CCDigestAlgorithm digestAlgorithm;
+        if (!_digestAlgorithm(algorithm, &digestAlgorithm)) {
+            LOG_HR(E_INVALIDARG);
+            return;
+        }
 
-        final(macOut, &ctx);
+        CC_Hmac_State state(digestAlgorithm, key, keyLength);
+        state._inner.Update(data, dataLength);
+        state._finish(static_cast<unsigned char*>(macOut));
     }
 
 private:
     static bool _validState(CC_Hmac_State** ctx) {
-        if (!ctx) {
-            return false;
-        }
-
-        CC_Hmac_State* state = *ctx;
-        if (!state) {
-            return false;
-        }
-
-        if (!state->_isValid) {
-            delete state;
-            *ctx = nullptr;
-            return false;
-        }
-
-        return true;
-    }
-
-    void invalidate() {
-        _isValid = false;
+        return ctx && *ctx;
     }
 
-    HRESULT _init() {
-        ComPtr<IMacAlgorithmProviderStatics> macAlgorithmProviderStatics;
-        ComPtr<IMacAlgorithmNamesStatics> macAlgorithmNamesStatics;
-
-        RETURN_IF_FAILED_LOG(
-            GetActivationFactory(Wrappers::HStringReference(RuntimeClass_Windows_Security_Cryptography_Core_MacAlgorithmProvider).Get(),
-                 &macAlgorithmProviderStatics));
-
-        RETURN_IF_FAILED_LOG(
-            GetActivationFactory(Wrappers::HStringReference(RuntimeClass_Windows_Security_Cryptography_Core_MacAlgorithmNames).Get(),
-                &macAlgorithmNamesStatics));
-
-        HSTRING name;
-
-        switch (_algorithm) {
+    static bool _digestAlgorithm(CCHmacAlgorithm algorithm, CCDigestAlgorithm* digestAlgorithm) {
+        switch (algorithm) {
             case kCCHmacAlgSHA1:
-                RETURN_IF_FAILED_LOG(macAlgorithmNamesStatics->get_HmacSha1(&name));
-                _digestLength = CC_SHA1_DIGEST_LENGTH;
-                break;
+                *digestAlgorithm = kCCDigestSHA1;
+                return true;
             case kCCHmacAlgMD5:
-                RETURN_IF_FAILED_LOG(macAlgorithmNamesStatics->get_HmacMd5(&name));
-                _digestLength = CC_MD5_DIGEST_LENGTH;
-                break;
+                *digestAlgorithm = kCCDigestMD5;
+                return true;
             case kCCHmacAlgSHA256:
-                RETURN_IF_FAILED_LOG(macAlgorithmNamesStatics->get_HmacSha256(&name));
-                _digestLength = CC_SHA256_DIGEST_LENGTH;
-                break;
+                *digestAlgorithm = kCCDigestSHA256;
+                return true;
             case kCCHmacAlgSHA384:
-                RETURN_IF_FAILED_LOG(macAlgorithmNamesStatics->get_HmacSha384(&name));
-                _digestLength = CC_SHA384_DIGEST_LENGTH;
-                break;
+                *digestAlgorithm = kCCDigestSHA384;
+                return true;
             case kCCHmacAlgSHA512:
-                RETURN_IF_FAILED_LOG(macAlgorithmNamesStatics->get_HmacSha512(&name));
-                _digestLength = CC_SHA512_DIGEST_LENGTH;
-                break;
+                *digestAlgorithm = kCCDigestSHA512;
+                return true;
             case kCCHmacAlgSHA224:
+                *digestAlgorithm = kCCDigestSHA224;
+                return true;
             default:
-                UNIMPLEMENTED_WITH_MSG("Requested HMAC algorithm is not supported");
-                return E_NOTIMPL;
+                return false;
         }
-
-        RETURN_IF_FAILED_LOG(macAlgorithmProviderStatics->OpenAlgorithm(name, &_macAlgorithmProvider));
-
-        ComPtr<IBuffer> keyBuffer;
-        RETURN_IF_FAILED_LOG(BufferFromRawData(&keyBuffer, (unsigned char*)_key, _keyLength));
-        ComPtr<IMacAlgorithmProvider2> macAlgorithmProvider2;
-        RETURN_IF_FAILED_LOG(_macAlgorithmProvider.As(&macAlgorithmProvider2));
-        RETURN_IF_FAILED_LOG(macAlgorithmProvider2->CreateHash(keyBuffer.Get(), &_hash));
-        return S_OK;
-    }
-
-    HRESULT _update(const void* data, size_t length) {
-        ComPtr<IBuffer> dataBuffer;
-        RETURN_IF_FAILED_LOG(BufferFromRawData(&dataBuffer, (unsigned char*)data, length));
-        RETURN_IF_FAILED_LOG(_hash->Append(dataBuffer.Get()));
-        return S_OK;
     }
 
-    HRESULT _finishHash(void* digest) {
-        memset(digest, 0, _digestLength);
-        RETURN_IF_FAILED_LOG(_hash->GetValueAndReset(&_outBuffer));
-        ComPtr<IBufferByteAccess> bufferAccess;
-        RETURN_IF_FAILED_LOG(_outBuffer.As(&bufferAccess));
-        BYTE* pRawHash;
-        RETURN_IF_FAILED_LOG(bufferAccess->Buffer(&pRawHash));
-        memcpy_s(digest, _digestLength, pRawHash, _digestLength);
-        return S_OK;
+    void _finish(unsigned char* mac) {
+        unsigned char innerDigest[CCDigestContext::c_maxDigestLength];
+        _inner.Final(innerDigest);
+        _outer.Update(innerDigest, CCDigestContext::GetDigestLength(_outer.GetAlgorithm()));
+        _outer.Final(mac);
     }
 
-    const CCHmacAlgorithm _algorithm;
-    const void* _key;
-    const size_t _keyLength;
-    ComPtr<IMacAlgorithmProvider> _macAlgorithmProvider;
-    ComPtr<IHashComputation> _hash;
-    ComPtr<IBuffer> _outBuffer;
-    size_t _digestLength;
-    bool _isValid;
+    CCDigestContext _inner;
+    CCDigestContext _outer;
 };
 
-
 /**
 @Status Interoperable
 */
@@ -0,0 +1,117 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <Windows.h>
+#include <CommonCrypto\CommonKeyDerivation.h>
+#include <ErrorHandling.h>
+
+#include "CCDigestEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+static bool _digestAlgorithm(CCPseudoRandomAlgorithm prf, CCDigestAlgorithm* digestAlgorithm) {
+    switch (prf) {
+        case kCCPRFHmacAlgSHA1:
+            *digestAlgorithm = kCCDigestSHA1;
+            return true;
+        case kCCPRFHmacAlgSHA224:
+            *digestAlgorithm = kCCDigestSHA224;
+            return true;
+        case kCCPRFHmacAlgSHA256:
+            *digestAlgorithm = kCCDigestSHA256;
+            return true;
+        case kCCPRFHmacAlgSHA384:
+            *digestAlgorithm = kCCDigestSHA384;
+            return true;
+        case kCCPRFHmacAlgSHA512:
+            *digestAlgorithm = kCCDigestSHA512;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+@Status Interoperable
+*/
+int CCKeyDerivationPBKDF(CCPBKDFAlgorithm algorithm,
+                         const char* password,
+                         size_t passwordLen,
+                         const uint8_t* salt,
+                         size_t saltLen,
+                         CCPseudoRandomAlgorithm prf,
+                         unsigned rounds,
+                         uint8_t* derivedKey,
+                         size_t derivedKeyLen) {
+    CCDigestAlgorithm digestAlgorithm;
+    if (algorithm != kCCPBKDF2 || !_digestAlgorithm(prf, &digestAlgorithm) || rounds == 0 || !derivedKey || derivedKeyLen == 0 ||
+        (!password && passwordLen > 0) || (!salt && saltLen > 0)) {
+        LOG_HR(E_INVALIDARG);
+        return kCCParamError;
+    }
+
+    // RFC 8018 caps the output at 2^32 - 1 blocks.
+    if (derivedKeyLen / CCDigestContext::GetDigestLength(digestAlgorithm) >= UINT32_MAX) {
+        LOG_HR(E_INVALIDARG);
+        return kCCParamError;
+    }
+
+    CCDigestPBKDF2(digestAlgorithm, password, passwordLen, salt, saltLen, rounds, derivedKey, derivedKeyLen);
+    return kCCSuccess;
+}
+
+/**
+@Status Interoperable
+@Notes Times derivations of the requested shape on the calling thread and scales the round count to fill msec.
+*/
+unsigned CCCalibratePBKDF(CCPBKDFAlgorithm algorithm,
+                          size_t passwordLen,
+                          size_t saltLen,
+                          CCPseudoRandomAlgorithm prf,
+                          size_t derivedKeyLen,
+                          uint32_t msec) {
+    CCDigestAlgorithm digestAlgorithm;
+    if (algorithm != kCCPBKDF2 || !_digestAlgorithm(prf, &digestAlgorithm) || derivedKeyLen == 0) {
+        LOG_HR(E_INVALIDARG);
+        return static_cast<unsigned>(-1);
+    }
+
+    std::vector<char> password(passwordLen, 'p');
+    std::vector<uint8_t> salt(saltLen, 's');
+    std::vector<uint8_t> derivedKey(derivedKeyLen);
+
+    // Double the sample until it runs long enough for the clock to measure it well, then extrapolate. Key setup and the
+    // first round are a fixed cost, so a sample that's too short would underestimate how many rounds fit.
+    static const std::chrono::microseconds c_minimumSample(10000);
+    unsigned sampleRounds = 1000;
+    std::chrono::steady_clock::duration elapsed;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        CCDigestPBKDF2(digestAlgorithm, password.data(), passwordLen, salt.data(), saltLen, sampleRounds, derivedKey.data(), derivedKeyLen);
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed >= c_minimumSample || sampleRounds >= UINT32_MAX / 2) {
+            break;
+        }
+        sampleRounds *= 2;
+    }
+
+    double elapsedMilliseconds = std::chrono::duration<double, std::milli>(elapsed).count();
+    double rounds = static_cast<double>(sampleRounds) * msec / std::max(elapsedMilliseconds, 1e-3);
+    return static_cast<unsigned>(std::min(std::max(rounds, 1.0), static_cast<double>(UINT32_MAX - 1)));
+}
@@ -24,6 +24,7 @@
 
 #include "CoreTextInternal.h"
 #include "CGContextInternal.h"
+#include "Instrumentation.h"
 
 #include <vector>
 #include <functional>
@@ -194,6 +195,7 @@ static inline CGSize __CTLineGetBounds(CTLineRef line) {
 
 - (void)layoutIfNeeded {
     if (_needsLayout) {
+        INSTRUMENT_SPAN("UIKit", "NSLayoutManager.layout");
         _needsLayout = FALSE;
         [self __layoutAllText];
     }
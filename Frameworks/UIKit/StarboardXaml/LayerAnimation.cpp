@@ -123,6 +123,15 @@ concurrency::task<void> LayerAnimation::_AddAnimation(ILayerProxy& layer, const
     return concurrency::task_from_result();
 }
 
+concurrency::task<void> LayerAnimation::_AddKeyframeAnimation(ILayerProxy& layer, const char* propertyName, const std::vector<float>& values) {
+    auto xamlLayer = _GetXamlElement(layer);
+    auto storyboardManager = _GetStoryboardManager(_storyboardManager);
+
+    storyboardManager->AnimateKeyframes(xamlLayer, propertyName, std::vector<double>(values.begin(), values.end()));
+
+    return concurrency::task_from_result();
+}
+
 concurrency::task<Layer^> _SnapshotLayer(Layer^ layer) {
     if (((layer->Height == 0) && (layer->Width == 0)) || (layer->Opacity == 0)) {
         return concurrency::task_from_result<Layer^>(nullptr);
@@ -20,6 +20,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <vector>
 #include <ppltasks.h>
 
 class LayerAnimation : public ILayerAnimation, public std::enable_shared_from_this<LayerAnimation> {
@@ -32,6 +33,13 @@ public:
                                                                  NSObject* byValue,
                                                                  CAMediaTimingProperties* timingProperties);
 
+    static std::shared_ptr<ILayerAnimation> CreateKeyframeAnimation(CAAnimation* animation,
+                                                                    NSString* propertyName,
+                                                                    NSArray* values,
+                                                                    CAMediaTimingProperties* timingProperties);
+
+    static void AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation, const std::shared_ptr<ILayerAnimation>& companion);
+
     static std::shared_ptr<ILayerAnimation> CreateTransitionAnimation(CAAnimation* animation, NSString* type, NSString* subType);
 #endif
 
@@ -47,6 +55,7 @@ protected:
     virtual void _Completed() = 0;
 
     concurrency::task<void> _AddAnimation(ILayerProxy& layer, const char* propertyName, bool fromValid, float from, bool toValid, float to);
+    concurrency::task<void> _AddKeyframeAnimation(ILayerProxy& layer, const char* propertyName, const std::vector<float>& values);
     concurrency::task<void> _AddTransitionAnimation(ILayerProxy& layer, const char* type, const char* subtype);
 
     Microsoft::WRL::ComPtr<IInspectable> _storyboardManager;
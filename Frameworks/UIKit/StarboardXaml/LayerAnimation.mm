@@ -577,6 +577,136 @@ public:
         return concurrency::task_from_result();
     }
 };
+
+// Animates through values sampled from a keyframe animation, as linear keyframes. The first and last samples serve as
+// the from and to values of the BasicAnimation, which supplies the timing and completion handling.
+class KeyframeAnimation : public BasicAnimation {
+private:
+    static const size_t c_maxComponents = 5;
+
+    NSArray* _values;
+
+    // Keyframe animations of other properties that run in this one's storyboard.
+    std::vector<std::shared_ptr<KeyframeAnimation>> _companions;
+
+    // Splits value into the layer properties it animates, in a fixed order for a given property name.
+    static size_t _GetComponents(const char* propName, NSObject* value, const char** names, float* components) {
+        if (strcmp(propName, "transform.scale") == 0) {
+            names[0] = "transform.scale.x";
+            names[1] = "transform.scale.y";
+            components[0] = components[1] = [(NSNumber*)value floatValue];
+            return 2;
+        } else if (strcmp(propName, "transform.rotation.z") == 0) {
+            names[0] = "transform.rotation";
+            components[0] = [(NSNumber*)value floatValue] * 180.0f / M_PI;
+            return 1;
+        } else if (strcmp(propName, "transform.translation.x") == 0 || strcmp(propName, "transform.translation.y") == 0 ||
+                   strcmp(propName, "opacity") == 0) {
+            names[0] = propName;
+            components[0] = [(NSNumber*)value floatValue];
+            return 1;
+        } else if (strcmp(propName, "position") == 0) {
+            CGPoint point = [(NSValue*)value CGPointValue];
+            names[0] = "position.x";
+            names[1] = "position.y";
+            components[0] = point.x;
+            components[1] = point.y;
+            return 2;
+        } else if (strcmp(propName, "bounds") == 0) {
+            CGRect rect = [(NSValue*)value CGRectValue];
+            names[0] = "origin.x";
+            names[1] = "origin.y";
+            names[2] = "size.width";
+            names[3] = "size.height";
+            components[0] = rect.origin.x;
+            components[1] = rect.origin.y;
+            components[2] = rect.size.width;
+            components[3] = rect.size.height;
+            return 4;
+        } else if (strcmp(propName, "transform") == 0) {
+            CATransform3D transform = [(NSValue*)value CATransform3DValue];
+            float scale[3] = { 1.0f, 1.0f, 1.0f };
+            float translation[3] = { 0 };
+            Quaternion qval;
+            qval.CreateFromMatrix(reinterpret_cast<float*>(&transform));
+            CATransform3DGetScale(transform, scale);
+            CATransform3DGetPosition(transform, translation);
+
+            names[0] = "transform.scale.x";
+            names[1] = "transform.scale.y";
+            names[2] = "transform.translation.x";
+            names[3] = "transform.translation.y";
+            names[4] = "transform.rotation";
+            components[0] = scale[0];
+            components[1] = scale[1];
+            components[2] = translation[0];
+            components[3] = translation[1];
+            components[4] = (float)-qval.roll() * 180.0f / M_PI;
+            return 5;
+        }
+
+        return 0;
+    }
+
+    // Adds a Xaml keyframe animation for each layer property that propName's values animate. Returns false if propName
+    // isn't supported.
+    bool _AddKeyframeAnimations(ILayerProxy& layer, const char* propName, NSArray* values) {
+        const char* names[c_maxComponents];
+        float components[c_maxComponents];
+        size_t componentCount = 0;
+        std::vector<float> tracks[c_maxComponents];
+
+        for (NSObject* value in values) {
+            componentCount = _GetComponents(propName, value, names, components);
+            for (size_t i = 0; i < componentCount; ++i) {
+                tracks[i].emplace_back(components[i]);
+            }
+        }
+
+        if (componentCount == 0) {
+            UNIMPLEMENTED_WITH_MSG("Stubbed function called! Unsupported property name: %hs", propName);
+            return false;
+        }
+
+        for (size_t i = 0; i < componentCount; ++i) {
+            _AddKeyframeAnimation(layer, names[i], tracks[i]);
+        }
+
+        return true;
+    }
+
+public:
+    KeyframeAnimation(id animHandler, NSString* propertyName, NSArray* values, CAMediaTimingProperties* timingProperties)
+        : BasicAnimation(animHandler, propertyName, [values firstObject], [values lastObject], nil, timingProperties) {
+        _values = [values retain];
+
+        // The samples already have the timing function applied.
+        easingFunction = Linear;
+    }
+
+    ~KeyframeAnimation() {
+        [_values release];
+    }
+
+    void AddCompanion(const std::shared_ptr<KeyframeAnimation>& companion) {
+        _companions.emplace_back(companion);
+    }
+
+    concurrency::task<void> AddToLayer(ILayerProxy& layer) {
+        _CreateXamlAnimation();
+
+        if (!_AddKeyframeAnimations(layer, [_propertyName UTF8String], _values)) {
+            return concurrency::task_from_result();
+        }
+
+        for (const auto& companion : _companions) {
+            _AddKeyframeAnimations(layer, [companion->_propertyName UTF8String], companion->_values);
+        }
+        _Start();
+
+        return concurrency::task_from_result();
+    }
+};
 }
 
 std::shared_ptr<ILayerAnimation> LayerAnimation::CreateBasicAnimation(CAAnimation* animation,
@@ -588,6 +718,22 @@ std::shared_ptr<ILayerAnimation> LayerAnimation::CreateBasicAnimation(CAAnimatio
     return std::make_shared<BasicAnimation>(animation, propertyName, fromValue, toValue, byValue, timingProperties);
 }
 
+std::shared_ptr<ILayerAnimation> LayerAnimation::CreateKeyframeAnimation(CAAnimation* animation,
+                                                                         NSString* propertyName,
+                                                                         NSArray* values,
+                                                                         CAMediaTimingProperties* timingProperties) {
+    return std::make_shared<KeyframeAnimation>(animation, propertyName, values, timingProperties);
+}
+
+void LayerAnimation::AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation,
+                                             const std::shared_ptr<ILayerAnimation>& companion) {
+    auto keyframeAnimation = std::dynamic_pointer_cast<KeyframeAnimation>(animation);
+    auto keyframeCompanion = std::dynamic_pointer_cast<KeyframeAnimation>(companion);
+    if (keyframeAnimation && keyframeCompanion) {
+        keyframeAnimation->AddCompanion(keyframeCompanion);
+    }
+}
+
 std::shared_ptr<ILayerAnimation> LayerAnimation::CreateTransitionAnimation(CAAnimation* animation, NSString* type, NSString* subType) {
     return std::make_shared<TransitionAnimation>(animation, type, subType);
 }
\ No newline at end of file
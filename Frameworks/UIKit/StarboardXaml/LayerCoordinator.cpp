@@ -684,6 +684,62 @@ void LayerCoordinator::AnimateValue(
     s_animatableProperties[propertyName].AnimateValue(target, storyboard, timeline, fromValue, toValue);
 }
 
+void LayerCoordinator::AnimateKeyframes(
+    FrameworkElement^ target,
+    Storyboard^ storyboard,
+    DoubleAnimation^ timeline,
+    const char* propertyName,
+    const std::vector<double>& values) {
+    if (values.size() < 2) {
+        return;
+    }
+
+    // Run every value through the property's animation function into a scratch storyboard, so keyframes get the same
+    // mapping onto Xaml properties (negated origins, clip transforms, dependent sizes) as AnimateValue. Each value yields
+    // the same animations in the same order; the nth animation of every value becomes a keyframe of the nth track.
+    Storyboard^ scratch = ref new Storyboard();
+    const AnimatableProperty& property = s_animatableProperties[propertyName];
+    for (double value : values) {
+        property.AnimateValue(target, scratch, timeline, nullptr, value);
+    }
+
+    unsigned int valueCount = static_cast<unsigned int>(values.size());
+    unsigned int trackCount = scratch->Children->Size / valueCount;
+    if (trackCount == 0 || trackCount * valueCount != scratch->Children->Size) {
+        TraceWarning(TAG, L"Keyframes for %hs did not map onto a fixed set of animations; not animating", propertyName);
+        return;
+    }
+
+    TimeSpan duration = timeline->Duration.TimeSpan;
+    for (unsigned int track = 0; track < trackCount; ++track) {
+        DoubleAnimation^ first = static_cast<DoubleAnimation^>(scratch->Children->GetAt(track));
+
+        DoubleAnimationUsingKeyFrames^ keyframes = ref new DoubleAnimationUsingKeyFrames();
+        for (unsigned int i = 0; i < valueCount; ++i) {
+            DoubleAnimation^ sample = static_cast<DoubleAnimation^>(scratch->Children->GetAt(i * trackCount + track));
+
+            TimeSpan keyTime = TimeSpan();
+            keyTime.Duration = duration.Duration * i / (valueCount - 1);
+
+            LinearDoubleKeyFrame^ frame = ref new LinearDoubleKeyFrame();
+            frame->KeyTime = KeyTimeHelper::FromTimeSpan(keyTime);
+            frame->Value = sample->To->Value;
+            keyframes->KeyFrames->Append(frame);
+        }
+
+        keyframes->Duration = first->Duration;
+        keyframes->RepeatBehavior = first->RepeatBehavior;
+        keyframes->AutoReverse = first->AutoReverse;
+        keyframes->EnableDependentAnimation = first->EnableDependentAnimation;
+        keyframes->FillBehavior = first->FillBehavior;
+        keyframes->BeginTime = first->BeginTime;
+        storyboard->Children->Append(keyframes);
+
+        Storyboard::SetTarget(keyframes, target);
+        Storyboard::SetTargetProperty(keyframes, Storyboard::GetTargetProperty(first));
+    }
+}
+
 // CALayer content support
 void LayerCoordinator::SetContent(FrameworkElement^ element, ImageSource^ source, float width, float height, float scale) {
     // Get content
@@ -17,6 +17,8 @@
 // clang-format off
 #pragma once
 
+#include <vector>
+
 namespace CoreAnimation {
 
 public enum class ContentGravity {
@@ -51,6 +53,14 @@ internal:
         Platform::Object^ fromValue,
         Platform::Object^ toValue);
 
+    // Animates propertyName through values, spaced evenly over the duration of properties, by linear keyframes.
+    static void AnimateKeyframes(
+        Windows::UI::Xaml::FrameworkElement^ element,
+        Windows::UI::Xaml::Media::Animation::Storyboard^ storyboard,
+        Windows::UI::Xaml::Media::Animation::DoubleAnimation^ properties,
+        const char* propertyName,
+        const std::vector<double>& values);
+
     // CALayer content support
     static void SetContent(
         Windows::UI::Xaml::FrameworkElement^ element, 
@@ -291,6 +291,13 @@ void LayerProxy::_SetContents(const Microsoft::WRL::ComPtr<IInspectable>& bitmap
     FrameworkElement^ xamlLayer = _FrameworkElementFromInspectable(_xamlElement);
     if (bitmap) {
         auto content = dynamic_cast<Media::ImageSource^>(reinterpret_cast<Platform::Object^>(bitmap.Get()));
+
+        // Layer backing stores are redrawn in place, so make sure Xaml picks up the new pixels.
+        auto writableBitmap = dynamic_cast<Media::Imaging::WriteableBitmap^>(content);
+        if (writableBitmap) {
+            writableBitmap->Invalidate();
+        }
+
         CoreAnimation::LayerCoordinator::SetContent(xamlLayer, content, width, height, scale);
     } else {
         CoreAnimation::LayerCoordinator::SetContent(xamlLayer, nullptr, width, height, scale);
@@ -369,6 +369,13 @@ void StoryboardManager::Animate(FrameworkElement^ layer, const char* propertyNam
     LayerCoordinator::AnimateValue(layer, m_container, timeline, propertyName, from, to);
 }
 
+void StoryboardManager::AnimateKeyframes(FrameworkElement^ layer, const char* propertyName, const std::vector<double>& values) {
+    // The values already have the animation's timing applied, so they are interpolated linearly rather than eased.
+    DoubleAnimation^ timeline = ref new DoubleAnimation();
+    timeline->Duration = m_container->Duration;
+    LayerCoordinator::AnimateKeyframes(layer, m_container, timeline, propertyName, values);
+}
+
 } /* namespace CoreAnimation */
 
 // clang-format on
\ No newline at end of file
@@ -58,6 +58,7 @@ internal:
     void Start();
     void Stop();
     void Animate(Windows::UI::Xaml::FrameworkElement^ layer, const char* propertyName, Platform::Object^ from, Platform::Object^ to);
+    void AnimateKeyframes(Windows::UI::Xaml::FrameworkElement^ layer, const char* propertyName, const std::vector<double>& values);
 
     void AddTransition(
         UIKit::Xaml::Private::CoreAnimation::Layer^ realLayer,
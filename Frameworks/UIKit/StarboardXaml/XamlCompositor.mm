@@ -89,6 +89,18 @@ public:
         return LayerAnimation::CreateBasicAnimation(animation, propertyName, fromValue, toValue, byValue, timingProperties);
     }
 
+    virtual std::shared_ptr<ILayerAnimation> CreateKeyframeAnimation(CAAnimation* animation,
+                                                                     NSString* propertyName,
+                                                                     NSArray* values,
+                                                                     CAMediaTimingProperties* timingProperties) override {
+        return LayerAnimation::CreateKeyframeAnimation(animation, propertyName, values, timingProperties);
+    }
+
+    void AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation,
+                                 const std::shared_ptr<ILayerAnimation>& companion) override {
+        LayerAnimation::AttachKeyframeAnimation(animation, companion);
+    }
+
     virtual std::shared_ptr<ILayerAnimation> CreateTransitionAnimation(CAAnimation* animation, NSString* type, NSString* subType) override {
         return LayerAnimation::CreateTransitionAnimation(animation, type, subType);
     }
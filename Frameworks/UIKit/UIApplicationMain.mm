@@ -38,6 +38,7 @@
 
 #import <StringHelpers.h>
 #import <CollectionHelpers.h>
+#import "NSMemoryPressure.h"
 #import "NSThread-Internal.h"
 #import "NSUserDefaultsInternal.h"
 #import "StarboardXaml/StarboardXaml.h"
@@ -316,6 +317,8 @@ void _UIApplicationShutdown() {
 }
 
 extern "C" void UIApplicationMainHandleHighMemoryUsageEvent() {
+    // Foundation's caches shed what they can before the app and its view controllers are warned.
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelWarning);
     [[UIApplication sharedApplication] _sendHighMemoryWarning];
 }
 
@@ -30,8 +30,11 @@
 #import "NSLogging.h"
 #import "AssertARCEnabled.h"
 #import "ErrorHandling.h"
+#import "UIReusePool.h"
 #import <MacTypes.h>
 
+#include <cmath>
+
 static const wchar_t* TAG = L"UICollectionView";
 static CGFloat UIAnimationDragCoefficient = 1.f;
 static CGFloat UISimulatorAnimationDragCoefficient(void) {
@@ -81,9 +84,15 @@ static char kUIColletionViewExt;
     __unsafe_unretained id<UICollectionViewDataSource> _dataSource;
     UIView* _backgroundView;
     NSMutableSet* _indexPathsForSelectedItems;
-    NSMutableDictionary* _cellReuseQueues;
-    NSMutableDictionary* _supplementaryViewReuseQueues;
-    NSMutableDictionary* _decorationViewReuseQueues;
+    UIReusePool<UICollectionReusableView*> _cellReuseQueues;
+    UIReusePool<UICollectionReusableView*> _supplementaryViewReuseQueues;
+    UIReusePool<UICollectionReusableView*> _decorationViewReuseQueues;
+    __unsafe_unretained id<UICollectionViewDataSourcePrefetching> _prefetchDataSource;
+    BOOL _prefetchingEnabled;
+    // Items handed to the prefetch data source that haven't been displayed or cancelled yet.
+    NSMutableSet* _prefetchedIndexPaths;
+    CGPoint _lastPrefetchOffset;
+    CGPoint _prefetchDirection;
     NSMutableSet* _indexPathsForHighlightedItems;
     int _reloadingSuspendedCount;
     UICollectionReusableView* _firstResponderView;
@@ -161,9 +170,10 @@ static char kUIColletionViewExt;
     _collectionViewFlags.allowsSelection = YES;
     _indexPathsForSelectedItems = [NSMutableSet new];
     _indexPathsForHighlightedItems = [NSMutableSet new];
-    _cellReuseQueues = [NSMutableDictionary new];
-    _supplementaryViewReuseQueues = [NSMutableDictionary new];
-    _decorationViewReuseQueues = [NSMutableDictionary new];
+    _prefetchingEnabled = YES;
+    _prefetchedIndexPaths = [NSMutableSet new];
+    _lastPrefetchOffset = CGPointMake(NAN, NAN);
+    _prefetchDirection = CGPointMake(0, 1);
     _allVisibleViewsDict = [NSMutableDictionary new];
     _cellClassDict = [NSMutableDictionary new];
     _cellNibDict = [NSMutableDictionary new];
@@ -538,13 +548,12 @@ static char kUIColletionViewExt;
 */
 - (id)dequeueReusableCellWithReuseIdentifier:(NSString*)identifier forIndexPath:(NSIndexPath*)indexPath {
     // de-queue cell (if available)
-    NSMutableArray* reusableCells = _cellReuseQueues[identifier];
-    UICollectionViewCell* cell = [reusableCells lastObject];
+    UICollectionReusableView* reusableCell = nil;
+    _cellReuseQueues.Dequeue(_UIInternReuseIdentifier(identifier), &reusableCell);
+    UICollectionViewCell* cell = (UICollectionViewCell*)reusableCell;
     UICollectionViewLayoutAttributes* attributes = [self.collectionViewLayout layoutAttributesForItemAtIndexPath:indexPath];
 
-    if (cell) {
-        [reusableCells removeObjectAtIndex:reusableCells.count - 1];
-    } else {
+    if (!cell) {
         if (_cellNibDict[identifier]) {
             // Cell was registered via registerNib:forCellWithReuseIdentifier:
             UINib* cellNib = _cellNibDict[identifier];
@@ -589,12 +598,10 @@ static char kUIColletionViewExt;
 - (id)dequeueReusableSupplementaryViewOfKind:(NSString*)elementKind
                          withReuseIdentifier:(NSString*)identifier
                                 forIndexPath:(NSIndexPath*)indexPath {
-    NSString* kindAndIdentifier = [NSString stringWithFormat:@"%@/%@", elementKind, identifier];
-    NSMutableArray* reusableViews = _supplementaryViewReuseQueues[kindAndIdentifier];
-    UICollectionReusableView* view = [reusableViews lastObject];
-    if (view) {
-        [reusableViews removeObjectAtIndex:reusableViews.count - 1];
-    } else {
+    UICollectionReusableView* view = nil;
+    _supplementaryViewReuseQueues.Dequeue(_UIInternReuseIdentifier(identifier), &view, _UIInternReuseIdentifier(elementKind));
+    if (!view) {
+        NSString* kindAndIdentifier = [NSString stringWithFormat:@"%@/%@", elementKind, identifier];
         if (_supplementaryViewNibDict[kindAndIdentifier]) {
             // supplementary view was registered via registerNib:forCellWithReuseIdentifier:
             UINib* supplementaryViewNib = _supplementaryViewNibDict[kindAndIdentifier];
@@ -639,15 +646,13 @@ static char kUIColletionViewExt;
    @Notes This appears to be an extension.
 */
 - (id)dequeueReusableOrCreateDecorationViewOfKind:(NSString*)elementKind forIndexPath:(NSIndexPath*)indexPath {
-    NSMutableArray* reusableViews = _decorationViewReuseQueues[elementKind];
-    UICollectionReusableView* view = [reusableViews lastObject];
+    UICollectionReusableView* view = nil;
+    _decorationViewReuseQueues.Dequeue(_UIInternReuseIdentifier(elementKind), &view);
     UICollectionViewLayout* collectionViewLayout = self.collectionViewLayout;
     UICollectionViewLayoutAttributes* attributes =
         [collectionViewLayout layoutAttributesForDecorationViewOfKind:elementKind atIndexPath:indexPath];
 
-    if (view) {
-        [reusableViews removeObjectAtIndex:reusableViews.count - 1];
-    } else {
+    if (!view) {
         NSDictionary* decorationViewNibDict = collectionViewLayout.decorationViewNibDict;
         NSDictionary* decorationViewExternalObjects = collectionViewLayout.decorationViewExternalObjectsTables;
         if (decorationViewNibDict[elementKind]) {
@@ -751,6 +756,7 @@ static char kUIColletionViewExt;
     }
     [_indexPathsForSelectedItems removeAllObjects];
     [_indexPathsForHighlightedItems removeAllObjects];
+    [self _resetPrefetching];
 
     [self setNeedsLayout];
 }
@@ -1632,6 +1638,35 @@ static char kUIColletionViewExt;
     }
 }
 
+- (id<UICollectionViewDataSourcePrefetching>)prefetchDataSource {
+    return _prefetchDataSource;
+}
+
+- (void)setPrefetchDataSource:(id<UICollectionViewDataSourcePrefetching>)prefetchDataSource {
+    _prefetchDataSource = prefetchDataSource;
+    [self _resetPrefetching];
+}
+
+- (BOOL)isPrefetchingEnabled {
+    return _prefetchingEnabled;
+}
+
+- (void)setPrefetchingEnabled:(BOOL)prefetchingEnabled {
+    _prefetchingEnabled = prefetchingEnabled;
+    [self _resetPrefetching];
+}
+
+// Forgets outstanding prefetches without cancelling them, and makes the next layout pass compute a fresh window.
+- (void)_resetPrefetching {
+    [_prefetchedIndexPaths removeAllObjects];
+    _lastPrefetchOffset = CGPointMake(NAN, NAN);
+}
+
+// Microsoft Extension. Cells that would overflow the queue are released instead; by default the queue is unbounded.
+- (void)setMaximumReusableCellCount:(NSUInteger)count forReuseIdentifier:(NSString*)identifier {
+    _cellReuseQueues.SetMaximumCount(_UIInternReuseIdentifier(identifier), count, [](UICollectionReusableView*) {});
+}
+
 - (BOOL)allowsSelection {
     return _collectionViewFlags.allowsSelection;
 }
@@ -1751,6 +1786,8 @@ static char kUIColletionViewExt;
             }
         }
     }
+
+    [self _updatePrefetching];
 }
 
 // fetches a cell from the dataSource and sets the layoutAttributes
@@ -1783,36 +1820,103 @@ static char kUIColletionViewExt;
 }
 
 // @steipete optimization
-- (void)queueReusableView:(UICollectionReusableView*)reusableView inQueue:(NSMutableDictionary*)queue withIdentifier:(NSString*)identifier {
+- (void)queueReusableView:(UICollectionReusableView*)reusableView
+                  inQueue:(UIReusePool<UICollectionReusableView*>*)queue
+           withIdentifier:(NSString*)identifier
+                     kind:(NSString*)kind {
     THROW_HR_IF_FALSE(E_INVALIDARG, identifier.length > 0);
 
     [reusableView removeFromSuperview];
-    [reusableView prepareForReuse];
 
-    // enqueue cell
-    NSMutableArray* reuseableViews = queue[identifier];
-    if (!reuseableViews) {
-        reuseableViews = [NSMutableArray array];
-        queue[identifier] = reuseableViews;
+    // enqueue cell; a full queue simply lets the view go
+    if (queue->Enqueue(_UIInternReuseIdentifier(identifier), reusableView, _UIInternReuseIdentifier(kind))) {
+        [reusableView prepareForReuse];
     }
-    [reuseableViews addObject:reusableView];
 }
 
 // enqueue cell for reuse
 - (void)reuseCell:(UICollectionViewCell*)cell {
-    [self queueReusableView:cell inQueue:_cellReuseQueues withIdentifier:cell.reuseIdentifier];
+    [self queueReusableView:cell inQueue:&_cellReuseQueues withIdentifier:cell.reuseIdentifier kind:nil];
 }
 
 // enqueue supplementary view for reuse
 - (void)reuseSupplementaryView:(UICollectionReusableView*)supplementaryView {
-    NSString* kindAndIdentifier =
-        [NSString stringWithFormat:@"%@/%@", supplementaryView.layoutAttributes.elementKind, supplementaryView.reuseIdentifier];
-    [self queueReusableView:supplementaryView inQueue:_supplementaryViewReuseQueues withIdentifier:kindAndIdentifier];
+    [self queueReusableView:supplementaryView
+                    inQueue:&_supplementaryViewReuseQueues
+             withIdentifier:supplementaryView.reuseIdentifier
+                       kind:supplementaryView.layoutAttributes.elementKind];
 }
 
 // enqueue decoration view for reuse
 - (void)reuseDecorationView:(UICollectionReusableView*)decorationView {
-    [self queueReusableView:decorationView inQueue:_decorationViewReuseQueues withIdentifier:decorationView.reuseIdentifier];
+    [self queueReusableView:decorationView inQueue:&_decorationViewReuseQueues withIdentifier:decorationView.reuseIdentifier kind:nil];
+}
+
+// Tells the prefetch data source about items up to one screen beyond the visible bounds in the direction of scrolling,
+// and cancels items that fell out of that window without ever being displayed.
+- (void)_updatePrefetching {
+    id<UICollectionViewDataSourcePrefetching> prefetchDataSource = _prefetchDataSource;
+    if (!_prefetchingEnabled || prefetchDataSource == nil || self.collectionViewLayout == nil) {
+        return;
+    }
+
+    CGRect bounds = self.bounds;
+    CGPoint offset = bounds.origin;
+    if (offset.x == _lastPrefetchOffset.x && offset.y == _lastPrefetchOffset.y) {
+        return;
+    }
+    if (!std::isnan(_lastPrefetchOffset.x)) {
+        // Follow whichever axis moved further, so a vertical fling with a little horizontal jitter still looks down.
+        CGFloat dx = offset.x - _lastPrefetchOffset.x;
+        CGFloat dy = offset.y - _lastPrefetchOffset.y;
+        if (fabs(dx) > fabs(dy)) {
+            _prefetchDirection = CGPointMake(dx > 0 ? 1 : -1, 0);
+        } else {
+            _prefetchDirection = CGPointMake(0, dy > 0 ? 1 : -1);
+        }
+    } else if (self.contentSize.width > bounds.size.width && self.contentSize.height <= bounds.size.height) {
+        _prefetchDirection = CGPointMake(1, 0);
+    }
+    _lastPrefetchOffset = offset;
+
+    CGRect window = CGRectOffset(bounds, _prefetchDirection.x * bounds.size.width, _prefetchDirection.y * bounds.size.height);
+
+    // Ask the layout directly; going through the collection view data would evict its cached visible attributes.
+    NSMutableSet* current = [NSMutableSet set];
+    NSMutableArray* toPrefetch = [NSMutableArray array];
+    for (UICollectionViewLayoutAttributes* attributes in [self.collectionViewLayout layoutAttributesForElementsInRect:window]) {
+        if (![attributes isKindOfClass:[UICollectionViewLayoutAttributes class]] || ![attributes isCell]) {
+            continue;
+        }
+
+        NSIndexPath* indexPath = attributes.indexPath;
+        if (CGRectIntersectsRect(attributes.frame, bounds) || [current containsObject:indexPath]) {
+            continue;
+        }
+
+        [current addObject:indexPath];
+        if (![_prefetchedIndexPaths containsObject:indexPath]) {
+            [toPrefetch addObject:indexPath];
+        }
+    }
+
+    // Whatever is left was prefetched earlier and is no longer coming up; only items that never made it on screen are cancelled.
+    [_prefetchedIndexPaths minusSet:current];
+    NSMutableArray* toCancel = [NSMutableArray array];
+    for (NSIndexPath* indexPath in _prefetchedIndexPaths) {
+        UICollectionViewItemKey* itemKey = [UICollectionViewItemKey collectionItemKeyForCellWithIndexPath:indexPath];
+        if (_allVisibleViewsDict[itemKey] == nil) {
+            [toCancel addObject:indexPath];
+        }
+    }
+    _prefetchedIndexPaths = current;
+
+    if (toCancel.count > 0 && [prefetchDataSource respondsToSelector:@selector(collectionView:cancelPrefetchingForItemsAtIndexPaths:)]) {
+        [prefetchDataSource collectionView:self cancelPrefetchingForItemsAtIndexPaths:toCancel];
+    }
+    if (toPrefetch.count > 0) {
+        [prefetchDataSource collectionView:self prefetchItemsAtIndexPaths:toPrefetch];
+    }
 }
 
 - (void)addControlledSubview:(UICollectionReusableView*)subview {
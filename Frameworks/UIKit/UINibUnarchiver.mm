@@ -27,6 +27,8 @@
 #import "NSCoderInternal.h"
 #import "LoggingNative.h"
 
+#include <vector>
+
 static const wchar_t* TAG = L"UINibUnarchiver";
 
 #define NIBOBJ_INT8 0x00
@@ -43,52 +45,132 @@ static const wchar_t* TAG = L"UINibUnarchiver";
 
 class UINibArchiver;
 
+static const unsigned int c_noKey = 0xFFFFFFFF;
+
+// Objects with at most this many items are searched linearly by key ID; larger ones get a hashed key table
+static const int c_linearKeyScanLimit = 8;
+
+// How constructObject builds an object, resolved once per class name when the nib is loaded
+enum ObjectKind : unsigned char {
+    ObjectKindCoded,
+    ObjectKindArray,
+    ObjectKindMutableArray,
+    ObjectKindDictionary,
+    ObjectKindMutableDictionary,
+    ObjectKindString,
+    ObjectKindMutableString,
+    ObjectKindData,
+    ObjectKindNull,
+};
+
+static const struct {
+    const char* className;
+    ObjectKind kind;
+} c_objectKinds[] = {
+    { "NSArray", ObjectKindArray },
+    { "NSMutableArray", ObjectKindMutableArray },
+    { "NSDictionary", ObjectKindDictionary },
+    { "NSMutableDictionary", ObjectKindMutableDictionary },
+    { "NSString", ObjectKindString },
+    { "NSMutableString", ObjectKindMutableString },
+    { "NSLocalizableString", ObjectKindMutableString },
+    { "NSData", ObjectKindData },
+    { "", ObjectKindNull },
+};
+
+static ObjectKind objectKindForClassName(const char* className) {
+    for (const auto& cur : c_objectKinds) {
+        if (strcmp(cur.className, className) == 0) {
+            return cur.kind;
+        }
+    }
+
+    return ObjectKindCoded;
+}
+
 class Item {
 public:
     int type;
-    void* data;
+    // Points into the nib data, which the unarchiver keeps alive; may be unaligned, so read through itemValue()
+    const char* data;
     int dataLen;
-    char* key;
+    unsigned int keyId;
     id cachedId;
 
     Item() {
         type = 0;
         data = NULL;
         dataLen = 0;
-        key = NULL;
+        keyId = c_noKey;
         cachedId = nil;
     }
 
-    ~Item() {
-        if (data) {
-            IwFree(data);
-        }
-    }
-
-    void setItemData(void* pData, int len) {
-        data = (void*)IwMalloc(len);
-        memcpy(data, pData, len);
+    void setItemData(const char* pData, int len) {
+        data = pData;
         dataLen = len;
     }
 };
 
+template <typename T>
+static T itemValue(const Item* item) {
+    T ret;
+    memcpy(&ret, item->data, sizeof(T));
+    return ret;
+}
+
 class Object {
 public:
     char* className;
     id classType;
+    ObjectKind kind;
 
-    Item** items;
+    Item* items;
     int itemCount;
     id cachedId;
 
+    // Open-addressed table of item indices (plus one) hashed by key ID, built on the first lookup into a large object
+    unsigned int* keyTable;
+    unsigned int keyTableMask;
+
     Object() {
         cachedId = nil;
         className = NULL;
+        classType = nil;
+        kind = ObjectKindCoded;
         items = NULL;
         itemCount = 0;
+        keyTable = NULL;
+        keyTableMask = 0;
+    }
+
+    ~Object() {
+        if (keyTable) {
+            IwFree(keyTable);
+        }
     }
 };
 
+static unsigned int hashKeyName(const char* keyName) {
+    unsigned int hash = 2166136261U;
+    for (; *keyName; keyName++) {
+        hash = (hash ^ static_cast<unsigned char>(*keyName)) * 16777619U;
+    }
+    return hash;
+}
+
+static unsigned int hashKeyId(unsigned int keyId) {
+    return keyId * 2654435769U;
+}
+
+// Smallest power of two that keeps a table of count entries at most half full
+static unsigned int tableCapacity(unsigned int count) {
+    unsigned int capacity = 8;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
 @implementation UINibUnarchiver
 static void pushObject(UINibUnarchiver* self, Object* pCur) {
     assert(self->_curObjectLevel < 16);
@@ -103,122 +185,191 @@ static Object* curObject(UINibUnarchiver* self) {
     return self->_curObject[self->_curObjectLevel];
 }
 
-static Item* itemForKey(UINibUnarchiver* self, const char* keyName) {
-    Object* cur = curObject(self);
+static unsigned int keyIdForName(UINibUnarchiver* self, const char* keyName) {
+    if (!self->_keyIndex) {
+        return c_noKey;
+    }
 
-    for (int i = 0; i < cur->itemCount; i++) {
-        if (strcmp(cur->items[i]->key, keyName) == 0) {
-            return cur->items[i];
+    for (unsigned int slot = hashKeyName(keyName) & self->_keyIndexMask;; slot = (slot + 1) & self->_keyIndexMask) {
+        unsigned int entry = self->_keyIndex[slot];
+        if (entry == 0) {
+            return c_noKey;
+        }
+        if (strcmp(self->_keyNames[entry - 1], keyName) == 0) {
+            return entry - 1;
         }
     }
+}
 
-    return NULL;
+static void buildKeyTable(Object* pObj) {
+    unsigned int capacity = tableCapacity(pObj->itemCount);
+    pObj->keyTable = (unsigned int*)IwCalloc(capacity, sizeof(unsigned int));
+    pObj->keyTableMask = capacity - 1;
+
+    for (int i = 0; i < pObj->itemCount; i++) {
+        unsigned int keyId = pObj->items[i].keyId;
+        for (unsigned int slot = hashKeyId(keyId) & pObj->keyTableMask;; slot = (slot + 1) & pObj->keyTableMask) {
+            unsigned int entry = pObj->keyTable[slot];
+            if (entry == 0) {
+                pObj->keyTable[slot] = i + 1;
+                break;
+            }
+            if (pObj->items[entry - 1].keyId == keyId) {
+                // Keep the first item for a repeated key, as a linear search would
+                break;
+            }
+        }
+    }
+}
+
+static Item* itemForKeyId(Object* pObj, unsigned int keyId) {
+    if (keyId == c_noKey) {
+        return NULL;
+    }
+
+    if (pObj->itemCount <= c_linearKeyScanLimit) {
+        for (int i = 0; i < pObj->itemCount; i++) {
+            if (pObj->items[i].keyId == keyId) {
+                return &pObj->items[i];
+            }
+        }
+        return NULL;
+    }
+
+    if (!pObj->keyTable) {
+        buildKeyTable(pObj);
+    }
+
+    for (unsigned int slot = hashKeyId(keyId) & pObj->keyTableMask;; slot = (slot + 1) & pObj->keyTableMask) {
+        unsigned int entry = pObj->keyTable[slot];
+        if (entry == 0) {
+            return NULL;
+        }
+        if (pObj->items[entry - 1].keyId == keyId) {
+            return &pObj->items[entry - 1];
+        }
+    }
+}
+
+static Item* itemForKey(UINibUnarchiver* self, const char* keyName) {
+    return itemForKeyId(curObject(self), keyIdForName(self, keyName));
 }
 
 static Object* objectForUid(UINibUnarchiver* self, int uid) {
-    return self->_objects[uid];
+    return &self->_objects[uid];
 }
 
+static id idForItem(UINibUnarchiver* self, Item* item);
+
 static id constructObject(UINibUnarchiver* self, Object* pObj) {
-    if (strcmp(pObj->className, "NSArray") == 0 || strcmp(pObj->className, "NSMutableArray") == 0) {
-        id* arrayItems;
-        int numArrayItems = 0;
+    switch (pObj->kind) {
+        case ObjectKindArray:
+        case ObjectKindMutableArray: {
+            id* arrayItems;
+            int numArrayItems = 0;
 
-        arrayItems = (id*)IwMalloc(pObj->itemCount * sizeof(id));
+            arrayItems = (id*)IwMalloc(pObj->itemCount * sizeof(id));
 
-        pObj->cachedId = (id)(void*)0xBAADF00D;
+            pObj->cachedId = (id)(void*)0xBAADF00D;
 
-        for (int i = 0; i < pObj->itemCount; i++) {
-            Item* curItem = pObj->items[i];
+            for (int i = 0; i < pObj->itemCount; i++) {
+                Item* curItem = &pObj->items[i];
 
-            if (strcmp(curItem->key, "UINibEncoderEmptyKey") == 0) {
-                id item = idForItem(self, curItem);
-                if (item == nil) {
-                    TraceWarning(TAG, L"Unable to create item for UINibEncoderEmptyKey.");
-                } else {
-                    arrayItems[numArrayItems++] = item;
+                if (curItem->keyId == self->_emptyKeyId) {
+                    id item = idForItem(self, curItem);
+                    if (item == nil) {
+                        TraceWarning(TAG, L"Unable to create item for UINibEncoderEmptyKey.");
+                    } else {
+                        arrayItems[numArrayItems++] = item;
+                    }
                 }
             }
-        }
 
-        if (strcmp(pObj->className, "NSArray") == 0) {
-            pObj->cachedId = [NSArray arrayWithObjects:arrayItems count:numArrayItems];
-        } else {
-            pObj->cachedId = [NSMutableArray arrayWithObjects:arrayItems count:numArrayItems];
-        }
-        IwFree(arrayItems);
-    } else if (strcmp(pObj->className, "NSDictionary") == 0 || strcmp(pObj->className, "NSMutableDictionary") == 0) {
-        id* keys;
-        id* values;
-        int numKeys = 0, numValues = 0;
+            if (pObj->kind == ObjectKindArray) {
+                pObj->cachedId = [NSArray arrayWithObjects:arrayItems count:numArrayItems];
+            } else {
+                pObj->cachedId = [NSMutableArray arrayWithObjects:arrayItems count:numArrayItems];
+            }
+            IwFree(arrayItems);
+        } break;
 
-        keys = (id*)IwMalloc(pObj->itemCount * sizeof(id));
-        values = (id*)IwMalloc(pObj->itemCount * sizeof(id));
+        case ObjectKindDictionary:
+        case ObjectKindMutableDictionary: {
+            id* keys;
+            id* values;
+            int numKeys = 0, numValues = 0;
 
-        pObj->cachedId = (id)(void*)0xBAADF00D;
+            keys = (id*)IwMalloc(pObj->itemCount * sizeof(id));
+            values = (id*)IwMalloc(pObj->itemCount * sizeof(id));
 
-        for (int i = 1; i < pObj->itemCount; i += 2) {
-            Item* curItem = pObj->items[i];
+            pObj->cachedId = (id)(void*)0xBAADF00D;
 
-            id item = idForItem(self, curItem);
-            keys[numKeys++] = item;
+            for (int i = 1; i < pObj->itemCount; i += 2) {
+                Item* curItem = &pObj->items[i];
 
-            curItem = pObj->items[i + 1];
+                id item = idForItem(self, curItem);
+                keys[numKeys++] = item;
 
-            item = idForItem(self, curItem);
-            values[numValues++] = item;
-        }
+                curItem = &pObj->items[i + 1];
 
-        if (strcmp(pObj->className, "NSDictionary") == 0) {
-            pObj->cachedId = [NSDictionary dictionaryWithObjects:values forKeys:keys count:numKeys];
-        } else {
-            pObj->cachedId = [NSMutableDictionary dictionaryWithObjects:values forKeys:keys count:numKeys];
-        }
-        IwFree(values);
-        IwFree(keys);
-    } else if (strcmp(pObj->className, "NSString") == 0 || strcmp(pObj->className, "NSMutableString") == 0 ||
-               strcmp(pObj->className, "NSLocalizableString") == 0) {
-        pushObject(self, pObj);
-        Item* strContents = itemForKey(self, "NS.bytes");
-
-        if (strcmp(pObj->className, "NSString") == 0) {
-            pObj->cachedId =
-                [[[NSString alloc] initWithBytes:strContents->data length:strContents->dataLen encoding:NSUTF8StringEncoding] autorelease];
-        } else {
-            pObj->cachedId =
-                [[[NSMutableString alloc] initWithBytes:strContents->data length:strContents->dataLen encoding:NSUTF8StringEncoding]
-                    autorelease];
-        }
-        popObject(self);
-    } else if (strcmp(pObj->className, "NSData") == 0) {
-        pushObject(self, pObj);
-        Item* dataContents = itemForKey(self, "NS.bytes");
-        pObj->cachedId = [NSData dataWithBytes:dataContents->data length:dataContents->dataLen];
-        popObject(self);
-    } else if (strcmp(pObj->className, "") == 0) {
-        pushObject(self, pObj);
-        pObj->cachedId = [NSNull null];
-        popObject(self);
-    } else {
-        id classId = pObj->classType; // objc_getClass(pObj->className);
-        assert(classId != nil);
-
-        pObj->cachedId = [classId alloc];
-
-        pushObject(self, pObj);
-        if ([pObj->cachedId respondsToSelector:@selector(initWithCoder:)]) {
-            pObj->cachedId = [pObj->cachedId initWithCoder:(id)self];
-        } else {
-            if (pObj->cachedId) {
-                TraceVerbose(TAG, L"%hs does not respond to initWithCoder", object_getClassName(pObj->cachedId));
+                item = idForItem(self, curItem);
+                values[numValues++] = item;
             }
-        }
 
-        if ([pObj->cachedId respondsToSelector:@selector(awakeAfterUsingCoder:)]) {
-            pObj->cachedId = [pObj->cachedId awakeAfterUsingCoder:(id)self];
-        }
-        [pObj->cachedId autorelease];
-        popObject(self);
+            if (pObj->kind == ObjectKindDictionary) {
+                pObj->cachedId = [NSDictionary dictionaryWithObjects:values forKeys:keys count:numKeys];
+            } else {
+                pObj->cachedId = [NSMutableDictionary dictionaryWithObjects:values forKeys:keys count:numKeys];
+            }
+            IwFree(values);
+            IwFree(keys);
+        } break;
+
+        case ObjectKindString:
+        case ObjectKindMutableString: {
+            Item* strContents = itemForKeyId(pObj, self->_bytesKeyId);
+
+            if (pObj->kind == ObjectKindString) {
+                pObj->cachedId =
+                    [[[NSString alloc] initWithBytes:strContents->data length:strContents->dataLen encoding:NSUTF8StringEncoding]
+                        autorelease];
+            } else {
+                pObj->cachedId =
+                    [[[NSMutableString alloc] initWithBytes:strContents->data length:strContents->dataLen encoding:NSUTF8StringEncoding]
+                        autorelease];
+            }
+        } break;
+
+        case ObjectKindData: {
+            Item* dataContents = itemForKeyId(pObj, self->_bytesKeyId);
+            pObj->cachedId = [NSData dataWithBytes:dataContents->data length:dataContents->dataLen];
+        } break;
+
+        case ObjectKindNull:
+            pObj->cachedId = [NSNull null];
+            break;
+
+        case ObjectKindCoded: {
+            id classId = pObj->classType; // objc_getClass(pObj->className);
+            assert(classId != nil);
+
+            pObj->cachedId = [classId alloc];
+
+            pushObject(self, pObj);
+            if ([pObj->cachedId respondsToSelector:@selector(initWithCoder:)]) {
+                pObj->cachedId = [pObj->cachedId initWithCoder:(id)self];
+            } else {
+                if (pObj->cachedId) {
+                    TraceVerbose(TAG, L"%hs does not respond to initWithCoder", object_getClassName(pObj->cachedId));
+                }
+            }
+
+            if ([pObj->cachedId respondsToSelector:@selector(awakeAfterUsingCoder:)]) {
+                pObj->cachedId = [pObj->cachedId awakeAfterUsingCoder:(id)self];
+            }
+            [pObj->cachedId autorelease];
+            popObject(self);
+        } break;
     }
     return pObj->cachedId;
 }
@@ -227,7 +378,8 @@ static id idForItem(UINibUnarchiver* self, Item* item) {
     if (item->cachedId == nil) {
         switch (item->type) {
             case NIBOBJ_UID: {
-                Object* pObj = objectForUid(self, *((DWORD*)item->data));
+                // Objects are only constructed once something references them
+                Object* pObj = objectForUid(self, itemValue<DWORD>(item));
 
                 if (pObj->cachedId == nil) {
                     pObj->cachedId = constructObject(self, pObj);
@@ -244,7 +396,7 @@ static id idForItem(UINibUnarchiver* self, Item* item) {
                 break;
 
             case NIBOBJ_FLOAT:
-                item->cachedId = [NSNumber numberWithFloat:*((float*)item->data)];
+                item->cachedId = [NSNumber numberWithFloat:itemValue<float>(item)];
                 break;
 
             case NIBOBJ_DATA:
@@ -276,6 +428,8 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
 - (instancetype)initForReadingWithData:(NSData*)data {
     _curObjectLevel = -1;
 
+    //  Items point into the nib data rather than copying it
+    _data = [data retain];
     _nibData = (char*)[data bytes];
     _nibLen = [data length];
 
@@ -286,6 +440,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
     //  Read classes
     _classNames = (char**)IwCalloc(_fixed[8], sizeof(char*));
     _classTypes = (id*)IwCalloc(_fixed[8], sizeof(id));
+    std::vector<ObjectKind> classKinds(_fixed[8]);
     _curOffset = &_nibData[_fixed[9]];
 
     for (unsigned int i = 0; i < _fixed[8]; i++) {
@@ -312,6 +467,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
         if (_classTypes[i] == nil) {
             TraceVerbose(TAG, L"Couldn't find class");
         }
+        classKinds[i] = objectKindForClassName(_classNames[i]);
         _curOffset += len;
     }
 
@@ -333,13 +489,29 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
         _curOffset += len;
     }
 
+    //  Index keys by name
+    if (_fixed[4] > 0) {
+        unsigned int capacity = tableCapacity(_fixed[4]);
+        _keyIndex = (unsigned int*)IwCalloc(capacity, sizeof(unsigned int));
+        _keyIndexMask = capacity - 1;
+
+        for (unsigned int i = 0; i < _fixed[4]; i++) {
+            unsigned int slot = hashKeyName(_keyNames[i]) & _keyIndexMask;
+            while (_keyIndex[slot] != 0) {
+                slot = (slot + 1) & _keyIndexMask;
+            }
+            _keyIndex[slot] = i + 1;
+        }
+    }
+    _emptyKeyId = keyIdForName(self, "UINibEncoderEmptyKey");
+    _bytesKeyId = keyIdForName(self, "NS.bytes");
+
     //  Read items
-    _objectItems = (Item**)IwMalloc(_fixed[6] * sizeof(Item*));
+    _items = new Item[_fixed[6]];
     _curOffset = &_nibData[_fixed[7]];
 
     for (unsigned int i = 0; i < _fixed[6]; i++) {
-        Item* curItem = new Item();
-        _objectItems[i] = curItem;
+        Item* curItem = &_items[i];
 
         WORD itemKeyName = 0;
 
@@ -352,7 +524,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
             assert(0);
         }
         // itemKeyName -= 0x80;
-        curItem->key = _keyNames[itemKeyName];
+        curItem->keyId = itemKeyName;
 
         WORD itemType = 0;
 
@@ -438,12 +610,11 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
     }
 
     //  Read objects
-    _objects = (Object**)IwMalloc(_fixed[2] * sizeof(Object*));
+    _objects = new Object[_fixed[2]];
     _curOffset = &_nibData[_fixed[3]];
 
     for (unsigned int i = 0; i < _fixed[2]; i++) {
-        Object* curObject = new Object();
-        _objects[i] = curObject;
+        Object* curObject = &_objects[i];
 
         WORD objectClassName = 0;
 
@@ -458,6 +629,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
         if (curObject->className == NULL || objectClassName >= _fixed[8]) {
             assert(0);
         }
+        curObject->kind = classKinds[objectClassName];
 
         WORD objectItemStart = 0;
 
@@ -477,7 +649,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
             objectItemStart -= 0x80;
         }
 
-        curObject->items = &_objectItems[objectItemStart];
+        curObject->items = &_items[objectItemStart];
 
         WORD objectItemCount = 0;
 
@@ -499,7 +671,7 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
         curObject->itemCount = objectItemCount;
     }
 
-    pushObject(self, _objects[0]);
+    pushObject(self, &_objects[0]);
     return self;
 }
 
@@ -548,11 +720,11 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
     DWORD ret = 0;
     switch (pItem->type) {
         case NIBOBJ_INT8:
-            ret = *((BYTE*)pItem->data);
+            ret = itemValue<BYTE>(pItem);
             break;
 
         case NIBOBJ_INT16:
-            ret = *((WORD*)pItem->data);
+            ret = itemValue<WORD>(pItem);
             break;
 
         case NIBOBJ_TRUE:
@@ -564,12 +736,12 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
             break;
 
         case NIBOBJ_INT32:
-            ret = *((DWORD*)pItem->data);
+            ret = itemValue<DWORD>(pItem);
             break;
 
         case NIBOBJ_INT64:
             TraceWarning(TAG, L"Warning: 64-bit NIB item truncated to 32 bits");
-            ret = *((DWORD*)pItem->data);
+            ret = itemValue<DWORD>(pItem);
             break;
 
         default:
@@ -588,11 +760,11 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
     float ret = 0;
     switch (pItem->type) {
         case NIBOBJ_FLOAT:
-            ret = *((float*)pItem->data);
+            ret = itemValue<float>(pItem);
             break;
 
         case NIBOBJ_DOUBLE:
-            ret = (float)(*((double*)pItem->data));
+            ret = (float)itemValue<double>(pItem);
             break;
 
         default:
@@ -611,11 +783,11 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
     double ret = 0;
     switch (pItem->type) {
         case NIBOBJ_FLOAT:
-            ret = *((float*)pItem->data);
+            ret = itemValue<float>(pItem);
             break;
 
         case NIBOBJ_DOUBLE:
-            ret = *((double*)pItem->data);
+            ret = itemValue<double>(pItem);
             break;
 
         default:
@@ -673,20 +845,15 @@ static id getObjectForKey(UINibUnarchiver* self, const char* keyName) {
         IwFree(_keyNames);
     }
 
-    if (_objectItems) {
-        for (unsigned int i = 0; i < _fixed[6]; i++) {
-            delete _objectItems[i];
-        }
-        IwFree(_objectItems);
-    }
+    delete[] _items;
+    delete[] _objects;
 
-    if (_objects) {
-        for (unsigned int i = 0; i < _fixed[2]; i++) {
-            delete _objects[i];
-        }
-        IwFree(_objects);
+    if (_keyIndex) {
+        IwFree(_keyIndex);
     }
 
+    [_data release];
+
     _bundle = nil;
 
     [super dealloc];
@@ -0,0 +1,79 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+
+#include "UIReusePool.h"
+
+// Reuse identifiers are almost always string literals or strings held by a cell, so the same few instances come back
+// on every dequeue. A tiny direct-mapped cache keyed by pointer catches those before the dictionary has to hash them.
+// Only immutable strings are cached, and each cached string is retained so its address can't be reused by another.
+struct InternCacheEntry {
+    NSString* string;
+    UIReuseIdentifier handle;
+};
+
+static const size_t c_internCacheSize = 16;
+static InternCacheEntry s_internCache[c_internCacheSize];
+
+static NSMutableDictionary* s_internedIdentifiers;
+static UIReuseIdentifier s_nextHandle = UIReuseIdentifierNone + 1;
+
+static size_t _InternCacheSlot(NSString* string) {
+    // Objects are at least 8-byte aligned; mix the higher bits in so neighbouring allocations spread out.
+    uintptr_t bits = reinterpret_cast<uintptr_t>(string) >> 4;
+    return (bits ^ (bits >> 5)) & (c_internCacheSize - 1);
+}
+
+UIReuseIdentifier _UIInternReuseIdentifier(NSString* identifier) {
+    if (identifier == nil) {
+        return UIReuseIdentifierNone;
+    }
+
+    InternCacheEntry& entry = s_internCache[_InternCacheSlot(identifier)];
+    if (entry.string == identifier) {
+        return entry.handle;
+    }
+
+    if ([identifier length] == 0) {
+        return UIReuseIdentifierNone;
+    }
+
+    if (s_internedIdentifiers == nil) {
+        s_internedIdentifiers = [NSMutableDictionary new];
+    }
+
+    UIReuseIdentifier handle;
+    NSNumber* existing = [s_internedIdentifiers objectForKey:identifier];
+    if (existing != nil) {
+        handle = static_cast<UIReuseIdentifier>([existing unsignedIntValue]);
+    } else {
+        handle = s_nextHandle++;
+        // setObject:forKey: copies the key, so a mutable identifier changing later doesn't disturb the table.
+        [s_internedIdentifiers setObject:[NSNumber numberWithUnsignedInt:handle] forKey:identifier];
+    }
+
+    NSString* immutable = [identifier copy];
+    if (immutable == identifier) {
+        [entry.string release];
+        entry.string = immutable;
+        entry.handle = handle;
+    } else {
+        [immutable release];
+    }
+
+    return handle;
+}
@@ -24,6 +24,7 @@
 #import "LinkedList.h"
 #import "UIViewInternal.h"
 #import <algorithm>
+#import <cmath>
 #import <memory>
 #import <UIKit/UINib.h>
 #import "UITableViewInternal.h"
@@ -228,15 +229,15 @@ class ReusableCell {
 public:
     ReusableCell() {
         sourceRow = NULL;
+        _reuseIdentifier = UIReuseIdentifierNone;
     }
     ~ReusableCell() {
         _cell = nil;
-        _reuseIdentifier = nil;
     }
 
     TableViewRow* sourceRow;
     idretain _cell;
-    idretain _reuseIdentifier;
+    UIReuseIdentifier _reuseIdentifier;
 };
 
 void VisibleComponents::AddVisibleNode(TableViewNode* node) {
@@ -526,18 +527,16 @@ void UITableViewPriv::addReusableCell(TableViewRow* row) {
     NSString* reuse = [static_cast<UITableViewCell*>(row->_view) reuseIdentifier];
     assert(reuse != nil);
 
-    auto& arr = _reusableCells[[reuse UTF8String]];
+    ReusableCell* newReusableCell = new ReusableCell();
+    newReusableCell->sourceRow = row;
+    newReusableCell->_cell = row->_view;
+    newReusableCell->_reuseIdentifier = _UIInternReuseIdentifier(reuse);
 
-    if (arr.size() <= 5) {
-        ReusableCell* newReusableCell = new ReusableCell();
-
-        newReusableCell->sourceRow = row;
-        newReusableCell->_cell = row->_view;
+    if (_reusableCells.Enqueue(newReusableCell->_reuseIdentifier, newReusableCell)) {
         [newReusableCell->_cell setHidden:TRUE];
-        newReusableCell->_reuseIdentifier = reuse;
         row->_reusable = newReusableCell;
-        arr.push_back(newReusableCell);
     } else {
+        delete newReusableCell;
         row->removeFromView();
     }
 }
@@ -546,34 +545,49 @@ void UITableViewPriv::addReusableCell(id cell) {
     NSString* reuse = [cell reuseIdentifier];
     assert(reuse != nil);
 
-    auto& arr = _reusableCells[[reuse UTF8String]];
-
-    if (arr.size() <= 5) {
-        ReusableCell* newReusableCell = new ReusableCell();
+    ReusableCell* newReusableCell = new ReusableCell();
+    newReusableCell->sourceRow = NULL;
+    newReusableCell->_cell = cell;
+    newReusableCell->_reuseIdentifier = _UIInternReuseIdentifier(reuse);
 
-        newReusableCell->sourceRow = NULL;
-        newReusableCell->_cell = cell;
+    if (_reusableCells.Enqueue(newReusableCell->_reuseIdentifier, newReusableCell)) {
         [newReusableCell->_cell setHidden:TRUE];
-        newReusableCell->_reuseIdentifier = reuse;
-        arr.push_back(newReusableCell);
     } else {
+        delete newReusableCell;
         [cell removeFromSuperview];
     }
 }
 
 void UITableViewPriv::removeReusableCell(ReusableCell* cell) {
-    id reuse = cell->_reuseIdentifier;
-    assert(reuse != nil);
+    assert(cell->_reuseIdentifier != UIReuseIdentifierNone);
 
-    auto it = _reusableCells.find([reuse UTF8String]);
-    if (it != _reusableCells.end()) {
-        auto& arr = it->second;
-        arr.erase(std::remove(arr.begin(), arr.end(), cell), arr.end());
-    }
+    _reusableCells.Remove(cell->_reuseIdentifier, cell);
 
     delete cell;
 }
 
+// Pops a queued cell for identifier and detaches it from the row that last displayed it, or returns nil.
+static id dequeueQueuedCell(UITableViewPriv* priv, NSString* identifier) {
+    ReusableCell* reusable;
+    if (!priv->_reusableCells.Dequeue(_UIInternReuseIdentifier(identifier), &reusable)) {
+        return nil;
+    }
+
+    TableViewRow* row = reusable->sourceRow;
+    if (row) {
+        row->detachView();
+        row->_reusable = NULL;
+    }
+
+    id ret = reusable->_cell;
+    [ret retain];
+    [ret prepareForReuse];
+
+    delete reusable;
+
+    return [ret autorelease];
+}
+
 @interface UITableView () <UIScrollViewDelegate>
 @end
 
@@ -637,6 +651,10 @@ static void initInternal(UITableView* self) {
     priv->_reusableCellNibs.attach([NSMutableDictionary new]);
     priv->_reusableHeaderClasses.attach([NSMutableDictionary new]);
     priv->_reusableCellClasses.attach([NSMutableDictionary new]);
+    priv->_prefetchDataSource = nil;
+    priv->_prefetchedIndexPaths.attach([NSMutableSet new]);
+    priv->_lastPrefetchOffset = NAN;
+    priv->_prefetchingForward = true;
     self->_indexPathsForSelectedItems.attach([NSMutableSet new]);
     self->_indexPathsForHighlightedItems.attach([NSMutableSet new]);
     priv->_separatorStyle = 0;
@@ -759,6 +777,40 @@ static void initInternal(UITableView* self) {
     return tablePriv->_dataSource;
 }
 
+/**
+ @Status Interoperable
+*/
+- (void)setPrefetchDataSource:(id<UITableViewDataSourcePrefetching>)prefetchDataSource {
+    tablePriv->_prefetchDataSource = prefetchDataSource;
+    [tablePriv->_prefetchedIndexPaths removeAllObjects];
+    tablePriv->_lastPrefetchOffset = NAN;
+
+    [self setNeedsLayout];
+}
+
+/**
+ @Status Interoperable
+*/
+- (id<UITableViewDataSourcePrefetching>)prefetchDataSource {
+    return tablePriv->_prefetchDataSource;
+}
+
+/**
+ @Status Interoperable
+ @Notes Microsoft extension. Offscreen cells beyond the maximum are discarded instead of being queued; the default is 6.
+*/
+- (void)setMaximumReusableCellCount:(NSUInteger)count forReuseIdentifier:(NSString*)identifier {
+    tablePriv->_reusableCells.SetMaximumCount(_UIInternReuseIdentifier(identifier), count, [](ReusableCell* cell) {
+        if (cell->sourceRow) {
+            cell->sourceRow->removeFromView();
+            cell->sourceRow->_reusable = NULL;
+        } else {
+            [(UITableViewCell*)cell->_cell removeFromSuperview];
+        }
+        delete cell;
+    });
+}
+
 /**
  @Status Interoperable
 */
@@ -847,6 +899,79 @@ static void initInternal(UITableView* self) {
     [super layoutIfNeeded];
 }
 
+// Tells the prefetch data source about rows up to one screen beyond the visible rect in the direction of scrolling,
+// and cancels rows that fell out of that window without ever being displayed.
+static void updatePrefetching(UITableView* self, const CGRect& visibleRect) {
+    auto priv = self->tablePriv;
+    id<UITableViewDataSourcePrefetching> prefetchDataSource = priv->_prefetchDataSource;
+    if (prefetchDataSource == nil) {
+        return;
+    }
+
+    float offset = visibleRect.origin.y;
+    if (offset == priv->_lastPrefetchOffset) {
+        return;
+    }
+    if (!std::isnan(priv->_lastPrefetchOffset)) {
+        priv->_prefetchingForward = offset > priv->_lastPrefetchOffset;
+    }
+    priv->_lastPrefetchOffset = offset;
+
+    CGRect window = visibleRect;
+    window.origin.y += priv->_prefetchingForward ? visibleRect.size.height : -visibleRect.size.height;
+    CGRect searchRect = CGRectUnion(visibleRect, window);
+
+    NSMutableSet* previous = priv->_prefetchedIndexPaths;
+    NSMutableSet* current = [NSMutableSet set];
+    NSMutableArray* toPrefetch = [NSMutableArray array];
+
+    LLTREE_FOREACH(curNode, priv->_rootNode) {
+        TableViewSection* curSection = (TableViewSection*)curNode;
+        if (!curSection->isSectionVisible(searchRect)) {
+            continue;
+        }
+
+        LLTREE_FOREACH(curRowNode, ((TableViewNode*)curSection)) {
+            TableViewRow* curRow = (TableViewRow*)curRowNode;
+            if (curRow->_height == 0.0f || curRow->_yPos + curRow->_height <= searchRect.origin.y ||
+                curRow->_yPos >= searchRect.origin.y + searchRect.size.height) {
+                continue;
+            }
+
+            // Rows already on screen were consumed by cellForRowAtIndexPath: and need neither a prefetch nor a cancel.
+            bool displayed = curRow->_view != nil && curRow->_reusable == NULL;
+            bool upcoming = curRow->_yPos + curRow->_height > window.origin.y && curRow->_yPos < window.origin.y + window.size.height;
+            if (!displayed && !upcoming) {
+                continue;
+            }
+
+            NSIndexPath* indexPath = [NSIndexPath indexPathForRow:curRow->_rowIndex inSection:curSection->_sectionIndex];
+            if (displayed) {
+                [previous removeObject:indexPath];
+                continue;
+            }
+
+            [current addObject:indexPath];
+            if (![previous containsObject:indexPath]) {
+                [toPrefetch addObject:indexPath];
+            }
+        }
+    }
+
+    // Whatever is left was prefetched earlier, never displayed, and is no longer coming up.
+    [previous minusSet:current];
+    NSArray* toCancel = [previous allObjects];
+
+    priv->_prefetchedIndexPaths = current;
+
+    if ([toCancel count] > 0 && [prefetchDataSource respondsToSelector:@selector(tableView:cancelPrefetchingForRowsAtIndexPaths:)]) {
+        [prefetchDataSource tableView:self cancelPrefetchingForRowsAtIndexPaths:toCancel];
+    }
+    if ([toPrefetch count] > 0) {
+        [prefetchDataSource tableView:self prefetchRowsAtIndexPaths:toPrefetch];
+    }
+}
+
 static void showVisibleCells(UITableView* self, BOOL animated = FALSE) {
     auto priv = self->tablePriv;
     priv->_isEnumerating++;
@@ -909,6 +1034,8 @@ static void showVisibleCells(UITableView* self, BOOL animated = FALSE) {
         footerBounds.size.width = bounds.size.width;
         [(UIView*)(priv->_footerView) setFrame:footerBounds];
     }
+
+    updatePrefetching(self, visibleRect);
     priv->_isEnumerating--;
 }
 
@@ -1237,6 +1364,8 @@ static void recalcTableSize(UITableView* self, bool changedWidth) {
     tablePriv->_needsReload = FALSE;
     tablePriv->_isEnumerating++;
     [_indexPathsForSelectedItems removeAllObjects];
+    [tablePriv->_prefetchedIndexPaths removeAllObjects];
+    tablePriv->_lastPrefetchOffset = NAN;
     [_indexPathsForHighlightedItems removeAllObjects];
     tablePriv->_visibleComponents->ClearVisibleNodes();
 
@@ -1372,33 +1501,9 @@ static void recalcTableSize(UITableView* self, bool changedWidth) {
  @Status Interoperable
 */
 - (id)dequeueReusableCellWithIdentifier:(NSString*)identifier {
-    auto it = tablePriv->_reusableCells.find([identifier UTF8String]);
-
-    if (it != tablePriv->_reusableCells.end()) {
-        auto& arr = it->second;
-        if (arr.size() > 0) {
-            ReusableCell* reusable = arr.back();
-            TableViewRow* row = reusable->sourceRow;
-
-            arr.pop_back();
-
-            if (row) {
-                row->detachView();
-                row->_reusable = NULL;
-            }
-
-            id ret = reusable->_cell;
-            [ret retain];
-            [ret prepareForReuse];
-
-            delete reusable;
-
-            return [ret autorelease];
-        }
-
-        if (arr.size() <= 1) {
-            tablePriv->_reusableCells.erase([identifier UTF8String]);
-        }
+    id queued = dequeueQueuedCell(tablePriv, identifier);
+    if (queued != nil) {
+        return queued;
     }
 
     id classId = [tablePriv->_reusableCellClasses objectForKey:identifier];
@@ -1421,33 +1526,9 @@ static void recalcTableSize(UITableView* self, bool changedWidth) {
  @Status Interoperable
 */
 - (id)dequeueReusableCellWithIdentifier:(NSString*)identifier forIndexPath:(NSIndexPath*)indexPath {
-    auto it = tablePriv->_reusableCells.find([identifier UTF8String]);
-
-    if (it != tablePriv->_reusableCells.end()) {
-        auto& arr = it->second;
-        if (arr.size() > 0) {
-            ReusableCell* reusable = arr.back();
-            TableViewRow* row = reusable->sourceRow;
-
-            arr.pop_back();
-
-            if (row) {
-                row->detachView();
-                row->_reusable = NULL;
-            }
-
-            id ret = reusable->_cell;
-            [ret retain];
-            [ret prepareForReuse];
-
-            delete reusable;
-
-            return [ret autorelease];
-        }
-
-        if (arr.size() <= 1) {
-            tablePriv->_reusableCells.erase([identifier UTF8String]);
-        }
+    id queued = dequeueQueuedCell(tablePriv, identifier);
+    if (queued != nil) {
+        return queued;
     }
 
     id classId = [tablePriv->_reusableCellClasses objectForKey:identifier];
@@ -2210,16 +2291,15 @@ static void recalcTableSize(UITableView* self, bool changedWidth) {
  @Status Interoperable
 */
 - (void)dealloc {
-    for (const auto& rc : tablePriv->_reusableCells) {
-        for (auto& cell : rc.second) {
-            [(UITableViewCell*)cell->_cell removeFromSuperview];
-            if (cell->sourceRow) {
-                cell->sourceRow->_view = nil;
-                cell->sourceRow->_reusable = NULL;
-            }
-            delete cell;
+    tablePriv->_reusableCells.ForEach([](ReusableCell* cell) {
+        [(UITableViewCell*)cell->_cell removeFromSuperview];
+        if (cell->sourceRow) {
+            cell->sourceRow->_view = nil;
+            cell->sourceRow->_reusable = NULL;
         }
-    }
+        delete cell;
+    });
+    tablePriv->_reusableCells.Clear();
 
     LLTREE_FOREACH(curNode, tablePriv->_rootNode) {
         TableViewSection* curSection = (TableViewSection*)curNode;
@@ -2243,6 +2323,7 @@ static void recalcTableSize(UITableView* self, bool changedWidth) {
     tablePriv->_reusableCellNibs = nil;
     tablePriv->_reusableHeaderClasses = nil;
     tablePriv->_reusableCellClasses = nil;
+    tablePriv->_prefetchedIndexPaths = nil;
     tablePriv->_headerView = nil;
     tablePriv->_footerView = nil;
     tablePriv->_backgroundView = nil;
@@ -50,6 +50,7 @@
 #import <UIView+AutoLayout.h>
 #import <windows.h>
 #import <LoggingNative.h>
+#import <Instrumentation.h>
 #import <NSLogging.h>
 #import <objc/blocks_runtime.h>
 #import "UIEventInternal.h"
@@ -950,6 +951,7 @@ static std::string _printViewhierarchy(UIView* leafView) {
 */
 - (void)layoutSublayersOfLayer:(CALayer*)forLayer {
     if (forLayer == layer) {
+        INSTRUMENT_SPAN("UIKit", "UIView.layout");
         UIViewController* controller = [UIViewController controllerForView:self];
         if (controller != nil) {
             [controller viewWillLayoutSubviews];
@@ -957,7 +959,10 @@ static std::string _printViewhierarchy(UIView* leafView) {
 
         [self updateConstraintsIfNeeded];
         [self autoLayoutUpdateConstraints];
-        [self layoutSubviews];
+        {
+            INSTRUMENT_SPAN("UIKit", "UIView.layoutSubviews");
+            [self layoutSubviews];
+        }
         [self __didLayout];
 
         if (controller != nil) {
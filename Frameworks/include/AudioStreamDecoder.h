@@ -0,0 +1,125 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <AudioToolbox/AudioFile.h>
+
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Random access to the bytes of an encoded audio file. Decoders pull only the ranges they need, so a file is never
+// loaded whole.
+class AudioByteSource {
+public:
+    virtual ~AudioByteSource() {
+    }
+
+    // Reads up to length bytes starting at offset. Returns the number of bytes read, 0 at the end of the file, or -1 on error.
+    virtual int64_t ReadAt(int64_t offset, void* buffer, uint32_t length) = 0;
+    virtual int64_t Length() = 0;
+
+    static std::unique_ptr<AudioByteSource> CreateWithPath(const char* path);
+    static std::unique_ptr<AudioByteSource> CreateWithCallbacks(void* context,
+                                                                AudioFile_ReadProc readFunc,
+                                                                AudioFile_GetSizeProc getSizeFunc);
+};
+
+// Pull decoder that produces interleaved signed 16-bit PCM frames from an AudioByteSource.
+class AudioStreamDecoder {
+public:
+    virtual ~AudioStreamDecoder() {
+    }
+
+    uint32_t ChannelCount() const {
+        return _channelCount;
+    }
+
+    double SampleRate() const {
+        return _sampleRate;
+    }
+
+    // Total number of frames in the stream, or -1 if it is not known.
+    int64_t FrameCount() const {
+        return _frameCount;
+    }
+
+    // Decodes up to frameCount frames into samples. Returns fewer only at the end of the stream.
+    virtual uint32_t Decode(int16_t* samples, uint32_t frameCount) = 0;
+
+    // Positions the decoder so that the next Decode starts at frame. Seeking at or past the end leaves the decoder at the end.
+    virtual bool Seek(int64_t frame) = 0;
+
+    // Both return null if the source does not hold a stream of the expected format.
+    static std::unique_ptr<AudioStreamDecoder> CreateOggVorbis(std::unique_ptr<AudioByteSource> source);
+    static std::unique_ptr<AudioStreamDecoder> CreateCAF(std::unique_ptr<AudioByteSource> source);
+
+protected:
+    AudioStreamDecoder() : _channelCount(0), _sampleRate(0), _frameCount(-1) {
+    }
+
+    uint32_t _channelCount;
+    double _sampleRate;
+    int64_t _frameCount;
+};
+
+// Bounded ring of decoded frames kept ahead of the reader. Refills run on a background queue whenever the ring drops
+// below half full, so reads only wait on the decoder when they outrun it.
+class AudioDecodeAheadBuffer {
+public:
+    static const uint32_t c_defaultCapacityFrames = 32768;
+    static const uint32_t c_decodeChunkFrames = 4096;
+
+    AudioDecodeAheadBuffer(std::unique_ptr<AudioStreamDecoder> decoder, uint32_t capacityFrames = c_defaultCapacityFrames);
+    ~AudioDecodeAheadBuffer();
+
+    const AudioStreamDecoder& Decoder() const {
+        return *_decoder;
+    }
+
+    // Copies up to frameCount frames into samples, waiting for the decoder as needed. Returns fewer only at the end of the stream.
+    uint32_t Read(int16_t* samples, uint32_t frameCount);
+
+    // Discards buffered frames and restarts decoding at frame.
+    bool Seek(int64_t frame);
+
+    // Frame index of the next frame Read returns.
+    int64_t Position();
+
+private:
+    void _ScheduleFillLocked();
+    void _Fill();
+
+    std::unique_ptr<AudioStreamDecoder> _decoder;
+    uint32_t _channelCount;
+    uint32_t _capacityFrames;
+    std::vector<int16_t> _scratch;
+
+    // Held by whoever drives _decoder, taken before _lock.
+    std::mutex _decodeLock;
+
+    std::mutex _lock;
+    std::condition_variable _changed;
+    std::vector<int16_t> _ring;
+    uint32_t _head;
+    uint32_t _bufferedFrames;
+    int64_t _position;
+    bool _endOfStream;
+    bool _filling;
+    bool _closing;
+};
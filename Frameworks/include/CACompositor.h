@@ -127,6 +127,15 @@ public:
                                                                   NSObject* toValue,
                                                                   NSObject* byValue,
                                                                   CAMediaTimingProperties* timingProperties) = 0;
+    // values are samples spaced evenly over the animation's duration, with its timing function already applied.
+    virtual std::shared_ptr<ILayerAnimation> CreateKeyframeAnimation(CAAnimation* animation,
+                                                                     NSString* propertyName,
+                                                                     NSArray* values,
+                                                                     CAMediaTimingProperties* timingProperties) = 0;
+    // Runs companion, another keyframe animation created for the same CAAnimation, in animation's storyboard, so the two
+    // share one timeline and complete once. Only animation is then added to the layer.
+    virtual void AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation,
+                                         const std::shared_ptr<ILayerAnimation>& companion) = 0;
     virtual std::shared_ptr<ILayerAnimation> CreateTransitionAnimation(CAAnimation* animation, NSString* type, NSString* subtype) = 0;
 
     // DisplayTexture support
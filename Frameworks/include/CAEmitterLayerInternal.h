@@ -0,0 +1,170 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <QuartzCore/CAEmitterLayer.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Per-cell emission and behaviour, snapshotted from a CAEmitterCell.
+struct CAParticleCellParameters {
+    float birthRate = 0.0f;
+    float lifetime = 0.0f;
+    float lifetimeRange = 0.0f;
+
+    float velocity = 0.0f;
+    float velocityRange = 0.0f;
+    float xAcceleration = 0.0f;
+    float yAcceleration = 0.0f;
+
+    float emissionLongitude = 0.0f;
+    float emissionLatitude = 0.0f;
+    float emissionRange = 0.0f;
+
+    float scale = 1.0f;
+    float scaleRange = 0.0f;
+    float scaleSpeed = 0.0f;
+
+    float spin = 0.0f;
+    float spinRange = 0.0f;
+
+    // RGBA.
+    float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float colorRange[4] = {};
+    float colorSpeed[4] = {};
+
+    // Index of the cell whose particles emit this cell's particles, or -1 if the emitter itself does.
+    int32_t parentCell = -1;
+};
+
+enum class CAEmitterShape { Point, Line, Rectangle, Cuboid, Circle, Sphere };
+enum class CAEmitterMode { Points, Outline, Surface, Volume };
+
+// Where new top-level particles are born, and the layer-wide multipliers applied to every cell.
+struct CAParticleEmitterParameters {
+    CAEmitterShape shape = CAEmitterShape::Point;
+    CAEmitterMode mode = CAEmitterMode::Volume;
+
+    float positionX = 0.0f;
+    float positionY = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float depth = 0.0f;
+
+    float birthRate = 1.0f;
+    float lifetime = 1.0f;
+    float velocity = 1.0f;
+    float scale = 1.0f;
+    float spin = 1.0f;
+};
+
+// Structure-of-arrays storage for the live particles of one cell.
+// Live particles are always packed into [0, count); a dead particle's slot is refilled by the last live one, and capacity
+// is kept between frames so steady-state emission doesn't allocate.
+struct CAParticleBuffer {
+    size_t count = 0;
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> rotation;
+    std::vector<float> spinRate;
+    std::vector<float> scale;
+    std::vector<float> red;
+    std::vector<float> green;
+    std::vector<float> blue;
+    std::vector<float> alpha;
+    std::vector<float> age;
+    std::vector<float> lifetime;
+
+    size_t GetCapacity() const {
+        return x.size();
+    }
+
+    void Reserve(size_t capacity);
+};
+
+// CPU particle simulation behind CAEmitterLayer. Particles move in the layer's plane; z components of the emitter
+// geometry only affect where on a cuboid or sphere a particle is born.
+class CAParticleSystem {
+public:
+    // Hard cap per cell, to bound memory when birthRate * lifetime is unreasonable.
+    static const size_t c_maxParticlesPerCell = 1 << 20;
+
+    explicit CAParticleSystem(uint32_t seed = 0);
+
+    void SetSeed(uint32_t seed);
+    void SetEmitter(const CAParticleEmitterParameters& emitter);
+
+    // Cells must be added parents first. Returns the new cell's index.
+    size_t AddCell(const CAParticleCellParameters& parameters);
+    void RemoveAllCells();
+
+    // Ages, moves and reaps every particle, then emits dt worth of new ones.
+    void Step(float dt);
+
+    // Emits count particles of cell immediately, regardless of its birth rate.
+    void Emit(size_t cell, size_t count);
+
+    size_t GetCellCount() const {
+        return _cells.size();
+    }
+
+    const CAParticleCellParameters& GetCellParameters(size_t cell) const {
+        return _cells[cell].parameters;
+    }
+
+    const CAParticleBuffer& GetParticles(size_t cell) const {
+        return _cells[cell].particles;
+    }
+
+    size_t GetParticleCount() const;
+
+private:
+    struct Cell {
+        CAParticleCellParameters parameters;
+        CAParticleBuffer particles;
+        float pendingBirths = 0.0f;
+    };
+
+    void _Integrate(Cell& cell, float dt);
+    void _Reap(Cell& cell);
+    void _Emit(Cell& cell, size_t count);
+    void _EmissionPoint(float* x, float* y);
+
+    // Uniform in [0, 1) and [-1, 1).
+    float _Random();
+    float _RandomSigned() {
+        return _Random() * 2.0f - 1.0f;
+    }
+
+    std::vector<Cell> _cells;
+    CAParticleEmitterParameters _emitter;
+    uint32_t _randomState;
+};
+
+@interface CAEmitterLayer (Internal)
+// Rebuilds the simulation from the layer's emitter properties and cells, discarding live particles.
+- (void)_resetParticleSystem;
+// Advances the simulation by dt seconds without waiting for a display link tick.
+- (void)_advanceParticles:(CFTimeInterval)dt;
+- (size_t)_particleCount;
+// Bounds, in layer coordinates, of everything the live particles draw.
+- (CGRect)_particleBounds;
+@end
@@ -0,0 +1,145 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <QuartzCore/CAKeyframeAnimation.h>
+#import <CoreGraphics/CGPath.h>
+
+#include "CAMediaTimingFunctionInternal.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Precomputed evaluation tables for a keyframe animation.
+//
+// Every track is flattened into segments, each a cubic polynomial per component
+// (value(u) = ((a * u + b) * u + c) * u + d for local parameter u in [0, 1]).
+// Linear, discrete and Kochanek-Bartels cubic interpolation of values, as well as
+// line/quad/cubic path elements, all reduce to this form; evaluating a track is a
+// segment lookup, optional timing and arc-length remapping of u, and a polynomial.
+class CAKeyframeTrack {
+public:
+    enum class CalculationMode { Linear, Discrete, Paced, Cubic, CubicPaced };
+    enum class RotationMode { None, Auto, AutoReverse };
+
+    // CATransform3D is the widest value type.
+    static const size_t c_maxComponents = 16;
+
+    // Samples per curved segment in the arc-length tables used by the paced modes.
+    static const size_t c_arcLengthSamples = 32;
+
+    struct Parameters {
+        CalculationMode calculationMode = CalculationMode::Linear;
+
+        // Only meaningful for path tracks.
+        RotationMode rotationMode = RotationMode::None;
+
+        // Optional; ignored if the count doesn't match the number of keys the mode expects, and in the paced modes.
+        const float* keyTimes = nullptr;
+        size_t keyTimeCount = 0;
+
+        // Optional per-segment timing; missing or nullptr entries are linear. Ignored in the paced modes.
+        const CATimingCurve* const* timingCurves = nullptr;
+        size_t timingCurveCount = 0;
+
+        // Optional per-key Kochanek-Bartels parameters for the cubic modes; each has one entry per key.
+        const float* tensionValues = nullptr;
+        const float* continuityValues = nullptr;
+        const float* biasValues = nullptr;
+    };
+
+    CAKeyframeTrack() = default;
+
+    // values holds keyCount keys of componentCount floats each, one key after the other.
+    bool InitWithValues(const float* values, size_t keyCount, size_t componentCount, const Parameters& parameters);
+
+    // Each path element after the initial move becomes a segment. Path tracks produce x and y, followed by the
+    // tangent angle in radians when a rotation mode is set.
+    bool InitWithPath(CGPathRef path, const Parameters& parameters);
+
+    bool IsValid() const {
+        return !_segments.empty();
+    }
+
+    size_t GetComponentCount() const {
+        return _componentCount + (_rotationMode != RotationMode::None ? 1 : 0);
+    }
+
+    size_t GetSegmentCount() const {
+        return _segments.size();
+    }
+
+    // Writes GetComponentCount() floats for linear progress in [0, 1] to result.
+    void Evaluate(float progress, float* result) const;
+
+private:
+    struct Segment {
+        float startTime;
+        float inverseDuration;
+        const CATimingCurve* timing;
+        uint32_t coefficientOffset;
+        // Offset of this segment's normalized arc-length table, or -1 if u maps to the segment linearly.
+        int32_t arcLengthOffset;
+    };
+
+    void _AddSegment(const float* a, const float* b, const float* c, const float* d);
+    float _SegmentLength(size_t segment, bool needsTable);
+    bool _FinishSegments(const Parameters& parameters);
+    float _RemapArcLength(const Segment& segment, float u) const;
+
+    // The segment containing progress, which must be in [0, 1], and the segment's linear local parameter there.
+    const Segment& _SegmentForProgress(float progress, float* u) const;
+
+    // Writes GetComponentCount() floats for segment at its (timed and remapped) local parameter u.
+    void _EvaluateSegment(const Segment& segment, float u, float* result) const;
+
+    friend void CAKeyframeTrackEvaluateBatch(const CAKeyframeTrack* const* tracks,
+                                             const float* progress,
+                                             float* results,
+                                             size_t resultStride,
+                                             size_t count);
+
+    size_t _componentCount = 0;
+    RotationMode _rotationMode = RotationMode::None;
+    bool _paced = false;
+
+    std::vector<Segment> _segments;
+    std::vector<float> _startTimes;
+
+    // Per segment: componentCount a coefficients, then b, c and d.
+    std::vector<float> _coefficients;
+    std::vector<float> _arcLengths;
+};
+
+// results + i * resultStride receives tracks[i]->Evaluate(progress[i]). Used to tick many animations in one pass per frame:
+// the timing curves of every element are solved together, and the segment polynomials are evaluated several components at a time.
+void CAKeyframeTrackEvaluateBatch(const CAKeyframeTrack* const* tracks, const float* progress, float* results, size_t resultStride, size_t count);
+
+// Number of floats each evaluation of animation produces, or 0 if its values can't be interpolated.
+CA_EXPORT size_t _CAKeyframeAnimationGetComponentCount(CAKeyframeAnimation* animation);
+
+// Evaluates animations[i] at progress[i] into results + i * resultStride. Animations that can't be interpolated are skipped.
+CA_EXPORT void _CAKeyframeAnimationEvaluateBatch(CAKeyframeAnimation* const* animations,
+                                                 const float* progress,
+                                                 float* results,
+                                                 size_t resultStride,
+                                                 size_t count);
+
+@interface CAKeyframeAnimation (Internal)
+// The interpolated value at linear progress in [0, 1], in the type of the animation's values (or an NSValue CGPoint for paths).
+- (id)_valueForProgress:(float)progress;
+- (const CAKeyframeTrack*)_track;
+@end
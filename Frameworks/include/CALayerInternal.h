@@ -59,6 +59,8 @@ public:
     CGContextRef savedContext;
     BOOL isRootLayer;
     BOOL needsDisplay;
+    // Union of the rects invalidated since the last display, in layer coordinates; CGRectInfinite for the whole layer.
+    CGRect _dirtyRect;
     BOOL needsUpdate;
     idretain _name;
     NSMutableDictionary* _animations;
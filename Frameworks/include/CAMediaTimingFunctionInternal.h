@@ -0,0 +1,103 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <QuartzCore/CAMediaTimingFunction.h>
+
+#include <array>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cubic Bezier timing curve from (0,0) to (1,1) with control points (c1x,c1y) and (c2x,c2y).
+// x is the animation's linear progress and y the eased progress; evaluating the curve means solving x(t) = x for the
+// curve parameter t, then returning y(t).
+class CATimingCurve {
+public:
+    // Number of uniform x intervals in the precomputed x -> t table.
+    static const size_t c_tableSize = 256;
+
+    // The t for each of the c_tableSize + 1 evenly spaced x values, from 0 to 1.
+    typedef std::array<double, c_tableSize + 1> TForXTable;
+
+    // Upper bound on the safeguarded Newton iterations that refine the table guess. A Newton step can shrink the bracket
+    // around the root by any amount; only the bisection fallback is guaranteed to halve it. From the table guess the
+    // solver converges in a few iterations, so the bound only guards against a non-monotonic curve.
+    static const int c_maxSolveIterations = 64;
+
+    // Linear curve.
+    CATimingCurve();
+    CATimingCurve(float c1x, float c1y, float c2x, float c2y);
+
+    // Returns the eased progress for linear progress x; x is clamped to [0, 1].
+    float Evaluate(float x) const;
+
+    // Returns the curve parameter t at which x(t) == x.
+    double SolveForT(double x) const;
+
+    bool IsLinear() const {
+        return _isLinear;
+    }
+
+private:
+    friend void CATimingCurveEvaluateBatch(const CATimingCurve* const* curves, const float* progress, float* results, size_t count);
+
+    double _SampleX(double t) const {
+        return ((_ax * t + _bx) * t + _cx) * t;
+    }
+
+    double _SampleY(double t) const {
+        return ((_ay * t + _by) * t + _cy) * t;
+    }
+
+    double _SampleDerivativeX(double t) const {
+        return (3.0 * _ax * t + 2.0 * _bx) * t + _cx;
+    }
+
+    // Polynomial coefficients of x(t) = ax*t^3 + bx*t^2 + cx*t, and likewise for y. Solving in double precision keeps
+    // curves whose x slope reaches zero, such as (0, 0, 0, 1) or (1, 0, 0, 1), accurate near the flat point.
+    double _ax, _bx, _cx;
+    double _ay, _by, _cy;
+    bool _isLinear;
+
+    // Builds the table for the given x coefficients, or returns the shared one if they are those of a named function.
+    static std::shared_ptr<const TForXTable> _TableFor(float c1x, float c2x);
+
+    // (*_table)[i] = t such that x(t) == i / c_tableSize; consecutive entries bracket every root in between. The table
+    // only depends on the x control points, and is shared between copies of the curve.
+    std::shared_ptr<const TForXTable> _table;
+
+    // _table's entries, so lookups don't go through the shared pointer.
+    const double* _tForX;
+};
+
+// Evaluates count timing curves at once: results[i] = curves[i]->Evaluate(progress[i]).
+// A nullptr curve is treated as linear. Intended for per-frame ticking of many active animations.
+void CATimingCurveEvaluateBatch(const CATimingCurve* const* curves, const float* progress, float* results, size_t count);
+
+// Evaluates function at linear progress t; nil is linear.
+CA_EXPORT float applyMediaTimingFunction(id function, float t);
+
+// Batched applyMediaTimingFunction: results[i] = applyMediaTimingFunction(functions[i], progress[i]).
+// Called once per frame tick with the progress of every active animation.
+CA_EXPORT void _CAMediaTimingFunctionEvaluateBatch(CAMediaTimingFunction* const* functions,
+                                                   const float* progress,
+                                                   float* results,
+                                                   size_t count);
+
+@interface CAMediaTimingFunction (Internal)
+- (const CATimingCurve*)_timingCurve;
+@end
@@ -0,0 +1,131 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// In-process AES behind CommonCryptor: ECB, CBC, CTR and GCM.
+// The portable kernels are bitsliced, so they never index memory with key or data bits; AES-NI and PCLMULQDQ are used
+// when the CPU has them.
+
+enum CCAESImplementation : uint32_t {
+    CCAESImplementationPortable = 0,
+    // AES rounds with the x86 AES-NI instructions.
+    CCAESImplementationAESNI = 1 << 0,
+    // GHASH with the x86 carry-less multiply instruction.
+    CCAESImplementationCLMUL = 1 << 1,
+};
+
+// Every implementation this CPU and build can run.
+uint32_t CCAESGetAvailableImplementations();
+
+// Restricts kernel selection to the given implementations. Keys and GCM contexts pick their kernels when they're
+// initialized, so this only affects ones initialized afterwards.
+void CCAESSetEnabledImplementations(uint32_t implementations);
+
+// An expanded AES-128, AES-192 or AES-256 key. Expansion is the expensive part of setting up a cipher, so cryptors keep
+// one of these for their lifetime and only reset IVs and counters.
+class CCAESKey {
+public:
+    static const size_t c_blockSize = 16;
+    static const size_t c_maxRounds = 14;
+
+    static bool IsValidKeyLength(size_t keyLength);
+
+    // Returns false, leaving the key unusable, if keyLength isn't 16, 24 or 32.
+    bool Init(const void* key, size_t keyLength);
+
+    // Overwrites the schedule. Destruction doesn't do this on its own, since keys are often copied around by value.
+    void Clear();
+
+    void EncryptBlocks(const uint8_t* in, uint8_t* out, size_t blockCount) const;
+    void DecryptBlocks(const uint8_t* in, uint8_t* out, size_t blockCount) const;
+
+    // iv is updated to the last ciphertext block, so consecutive calls continue one CBC stream.
+    void EncryptCBC(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) const;
+    void DecryptCBC(uint8_t* iv, const uint8_t* in, uint8_t* out, size_t blockCount) const;
+
+    // XORs the keystream for blockCount counter blocks into in. The counter is big-endian and advanced past every block
+    // used; increment32 wraps only its low 32 bits, as GCM does.
+    void CTRBlocks(uint8_t* counter, bool increment32, const uint8_t* in, uint8_t* out, size_t blockCount) const;
+
+    bool UsesAESNI() const {
+        return _usesAESNI;
+    }
+
+private:
+    uint32_t _rounds;
+    bool _usesAESNI;
+    // Standard round keys, and the equivalent inverse cipher's keys for AES-NI decryption.
+    alignas(16) uint8_t _roundKeys[c_maxRounds + 1][c_blockSize];
+    alignas(16) uint8_t _decryptRoundKeys[c_maxRounds + 1][c_blockSize];
+    // Round keys in the portable kernel's bitsliced layout.
+    uint32_t _bitslicedKeys[c_maxRounds + 1][8];
+};
+
+// A counter mode stream over a CCAESKey, which must outlive it. Encryption and decryption are the same operation.
+class CCAESCTR {
+public:
+    void Init(const CCAESKey* key, const uint8_t* iv, bool increment32);
+    void Process(const void* in, void* out, size_t length);
+
+private:
+    const CCAESKey* _key;
+    bool _increment32;
+    uint8_t _counter[CCAESKey::c_blockSize];
+    // Keystream left over from a partial block.
+    uint8_t _keystream[CCAESKey::c_blockSize];
+    size_t _keystreamOffset;
+};
+
+// GCM (NIST SP 800-38D) over a CCAESKey, which must outlive it. Init derives the hash key once; SetIV starts each
+// message, followed by any additional authenticated data, then the text, then Final.
+class CCAESGCM {
+public:
+    static const size_t c_tagLength = 16;
+
+    void Init(const CCAESKey* key);
+    void SetIV(const void* iv, size_t ivLength);
+    void AddAAD(const void* data, size_t length);
+    void Encrypt(const void* in, void* out, size_t length);
+    void Decrypt(const void* in, void* out, size_t length);
+    void Final(uint8_t* tag);
+
+    // Overwrites the hash key and message state.
+    void Clear();
+
+private:
+    void _GHASHBlocks(const uint8_t* blocks, size_t blockCount);
+    void _Hash(const uint8_t* data, size_t length);
+    void _FlushPartial();
+    void _FinishAAD();
+
+    const CCAESKey* _key;
+    bool _usesCLMUL;
+    // H, and for CLMUL H through H^4 in the kernel's byte-reflected layout.
+    uint64_t _hashKey[2];
+    alignas(16) uint8_t _hashKeyPowers[4][16];
+
+    CCAESCTR _ctr;
+    uint8_t _preCounterBlock[CCAESKey::c_blockSize];
+    uint8_t _ghash[16];
+    uint8_t _partial[16];
+    size_t _partialLength;
+    uint64_t _aadLength;
+    uint64_t _textLength;
+    bool _aadFinished;
+};
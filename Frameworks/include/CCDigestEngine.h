@@ -0,0 +1,102 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <CommonCrypto/CommonDigest.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// In-process MD5, SHA-1 and SHA-2 behind CommonDigest and CommonHMAC.
+// Portable kernels are always available; faster ones are picked at runtime from what the CPU supports.
+
+enum CCDigestImplementation : uint32_t {
+    CCDigestImplementationPortable = 0,
+    // Several messages at once in 128-bit vector lanes (SSE2 or NEON).
+    CCDigestImplementationVector = 1 << 0,
+    // Several messages at once in 256-bit AVX2 lanes.
+    CCDigestImplementationAVX2 = 1 << 1,
+    // SHA-1 and SHA-256 with the x86 SHA extensions.
+    CCDigestImplementationSHAExtensions = 1 << 2,
+};
+
+// Every implementation this CPU and build can run.
+uint32_t CCDigestGetAvailableImplementations();
+
+// Restricts kernel selection to the given implementations (the portable ones can't be disabled). Everything available
+// is enabled by default; this exists so tests and benchmarks can exercise each kernel in turn.
+void CCDigestSetEnabledImplementations(uint32_t implementations);
+
+// Streaming state for one digest. It's trivially copyable, so a caller can snapshot a partially hashed prefix (HMAC
+// keeps its keyed inner and outer states this way).
+class CCDigestContext {
+public:
+    static const size_t c_maxBlockSize = 128;
+    static const size_t c_maxDigestLength = CC_SHA512_DIGEST_LENGTH;
+
+    // True for MD5, SHA-1, SHA-224, SHA-256, SHA-384 and SHA-512.
+    static bool IsSupported(CCDigestAlgorithm algorithm);
+    static size_t GetDigestLength(CCDigestAlgorithm algorithm);
+    static size_t GetBlockSize(CCDigestAlgorithm algorithm);
+
+    void Init(CCDigestAlgorithm algorithm);
+    void Update(const void* data, size_t length);
+
+    // Writes GetDigestLength() bytes. The context must be initialized again before it's reused.
+    void Final(unsigned char* digest);
+
+    CCDigestAlgorithm GetAlgorithm() const {
+        return _algorithm;
+    }
+
+private:
+    friend void CCDigestPBKDF2(CCDigestAlgorithm algorithm,
+                               const void* password,
+                               size_t passwordLength,
+                               const void* salt,
+                               size_t saltLength,
+                               uint32_t rounds,
+                               unsigned char* derivedKey,
+                               size_t derivedKeyLength);
+
+    union {
+        uint32_t words32[8];
+        uint64_t words64[8];
+    } _state;
+    uint64_t _length;
+    uint8_t _buffer[c_maxBlockSize];
+    size_t _bufferLength;
+    CCDigestAlgorithm _algorithm;
+};
+
+// Digests count independent messages, hashing several of them side by side in SIMD lanes when an implementation that
+// supports it is enabled. digests[i] receives GetDigestLength(algorithm) bytes for data[i].
+void CCDigestMultiple(CCDigestAlgorithm algorithm, const void* const* data, const size_t* lengths, size_t count, unsigned char* const* digests);
+
+// HMAC (RFC 2104) keying. Leaves inner and outer having absorbed the key XORed with ipad and opad; a MAC is inner over
+// the message, then outer over inner's digest.
+void CCDigestHmacInit(CCDigestAlgorithm algorithm, const void* key, size_t keyLength, CCDigestContext* inner, CCDigestContext* outer);
+
+// PBKDF2 (RFC 8018) over HMAC-algorithm. Every round after the first hashes exactly two blocks against the precomputed
+// pad states, and independent output blocks are derived side by side in SIMD lanes when an implementation allows it.
+void CCDigestPBKDF2(CCDigestAlgorithm algorithm,
+                    const void* password,
+                    size_t passwordLength,
+                    const void* salt,
+                    size_t saltLength,
+                    uint32_t rounds,
+                    unsigned char* derivedKey,
+                    size_t derivedKeyLength);
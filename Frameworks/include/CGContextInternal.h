@@ -39,6 +39,12 @@ COREGRAPHICS_EXPORT CGContextRef _CGContextCreateWithD2DRenderTarget(ID2D1Render
 COREGRAPHICS_EXPORT void _CGContextSetShadowProjectionTransform(CGContextRef context, CGAffineTransform transform);
 COREGRAPHICS_EXPORT void _CGContextDrawImageRect(CGContextRef ctx, CGImageRef img, CGRect src, CGRect dst);
 
+// Draws count sprites of the src region of img. Sprite i fills the size-sized rect centered on the origin, transformed by
+// transforms[i] and then the CTM, with its pixels multiplied by the RGBA color at colors + 4 * i. Equivalent to a
+// CGContextDrawImage per sprite, but the image is uploaded once and the sprites are drawn as one batch.
+COREGRAPHICS_EXPORT void _CGContextDrawImageSprites(
+    CGContextRef ctx, CGImageRef img, CGRect src, CGSize size, const CGAffineTransform* transforms, const float* colors, size_t count);
+
 // Bitmap Context Internal
 COREGRAPHICS_EXPORT CGContextRef _CGBitmapContextCreateWithRenderTarget(ID2D1RenderTarget* renderTarget,
                                                                         CGImageRef img,
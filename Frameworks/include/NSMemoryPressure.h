@@ -0,0 +1,61 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+#import <Foundation/FoundationExport.h>
+#import <Foundation/NSObject.h>
+
+typedef NS_ENUM(NSUInteger, _NSMemoryPressureLevel) {
+    _NSMemoryPressureLevelNormal = 0,
+    // Memory is getting tight: clients drop what is cheap to rebuild.
+    _NSMemoryPressureLevelWarning,
+    // Memory is exhausted or about to be: clients drop everything they can rebuild.
+    _NSMemoryPressureLevelCritical,
+};
+
+// Clients are asked to shed memory in ascending priority order, so that the content that is cheapest to rebuild goes first.
+enum : NSInteger {
+    _NSMemoryPressurePriorityPurgeableData = 0,
+    _NSMemoryPressurePriorityCache = 100,
+    _NSMemoryPressurePriorityURLCache = 200,
+};
+
+@protocol _NSMemoryPressureClient <NSObject>
+// Called on a worker thread, or on the thread that called _NSMemoryPressureSignal.
+- (void)_shedMemoryForPressureLevel:(_NSMemoryPressureLevel)level;
+@end
+
+// Registers client, which is held weakly. Clients should still remove themselves when they are deallocated.
+FOUNDATION_EXPORT void _NSMemoryPressureAddClient(id<_NSMemoryPressureClient> client, NSInteger priority);
+FOUNDATION_EXPORT void _NSMemoryPressureRemoveClient(id<_NSMemoryPressureClient> client);
+
+// Asks every client to shed memory for level, in priority order, on the calling thread. The monitor calls this when the
+// system runs low on memory, UIKit calls it when the app's memory usage level goes high, and tests call it to simulate
+// pressure.
+FOUNDATION_EXPORT void _NSMemoryPressureSignal(_NSMemoryPressureLevel level);
+
+// Limits the private bytes of the process. While a budget is set, the monitor raises warning pressure at three quarters
+// of it and critical pressure at all of it, and stops asking clients to shed memory as soon as usage is back under the
+// warning mark. A budget of 0 removes the limit.
+FOUNDATION_EXPORT void _NSMemoryPressureSetBudget(size_t bytes);
+
+// Samples the process and the system, as the monitor does on each tick, and sheds memory when the pressure has risen
+// since the last sample or is still critical. Tests call this to drive the monitor without waiting for it.
+FOUNDATION_EXPORT void _NSMemoryPressurePoll();
+
+// Returns the private bytes of the process.
+FOUNDATION_EXPORT size_t _NSMemoryPressureProcessUsage();
@@ -0,0 +1,31 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+#import <Foundation/NSNotificationQueue.h>
+#import <Foundation/NSString.h>
+
+// Called by NSRunLoop on the queue of the thread it runs on.
+@interface NSNotificationQueue (Internal)
+// Posts the NSPostASAP notifications queued for mode. Called once per pass of the run loop, after timers have fired.
+- (void)asapProcessMode:(NSString*)mode;
+
+// Returns whether any NSPostWhenIdle notifications are queued for mode.
+- (BOOL)hasIdleNotificationsInMode:(NSString*)mode;
+
+// Posts the NSPostWhenIdle notifications queued for mode. Called when the run loop would otherwise wait for input.
+- (void)idleProcessMode:(NSString*)mode;
+@end
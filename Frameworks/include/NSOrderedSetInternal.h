@@ -18,15 +18,41 @@
 #import <Foundation/NSOrderedSet.h>
 #import <Starboard.h>
 
+#import <unordered_map>
+
+// Hashes and compares elements the way NSSet does, with -hash and -isEqual:.
+struct _NSOrderedSetHash {
+    size_t operator()(id object) const {
+        return [object hash];
+    }
+};
+
+struct _NSOrderedSetEqual {
+    bool operator()(id left, id right) const {
+        return (left == right) || [left isEqual:right];
+    }
+};
+
+// Element to position in _arrayContainer. The elements are retained by _arrayContainer.
+typedef std::unordered_map<id, NSUInteger, _NSOrderedSetHash, _NSOrderedSetEqual> _NSOrderedSetIndex;
+
 @interface NSOrderedSet () {
 @package
-    StrongId<NSMutableSet*> _setContainer;
     StrongId<NSMutableArray*> _arrayContainer;
+
+    // Membership is always exact, but only the positions below _validIndexCount are. Inserting or removing anywhere but at
+    // the end lowers _validIndexCount instead of shifting every later position, and the stale positions are recomputed in a
+    // single pass the next time one of them is asked for, so a run of edits costs one fix-up rather than one per edit.
+    _NSOrderedSetIndex _index;
+    NSUInteger _validIndexCount;
 }
+- (void)_insertObject:(id)object;
+- (void)_invalidateIndexesFrom:(NSUInteger)index;
+- (NSUInteger)_positionOfObject:(id)object;
 @end
 
 @interface _NSProxyOrderedSetArray : NSArray {
     StrongId<NSArray*> _array;
 }
 - (id)initWithOrderedSet:(NSOrderedSet*)orderedSet;
-@end
\ No newline at end of file
+@end
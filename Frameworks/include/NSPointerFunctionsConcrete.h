@@ -22,4 +22,9 @@
 @property BOOL copyIn;
 @property BOOL weakMemory;
 @property (readonly) NSPointerFunctionsOptions options;
-@end
\ No newline at end of file
+@end
+
+// Default hash/isEqual functions for the address-based personalities, which NSHashTable and NSMapTable recognize and inline
+NSUInteger _NSPointerFunctionsHashShiftedPointer(const void* item, NSUInteger (*size)(const void* item));
+NSUInteger _NSPointerFunctionsHashUnshiftedPointer(const void* item, NSUInteger (*size)(const void* item));
+BOOL _NSPointerFunctionsIsEqualDirectCompare(const void* item1, const void* item2, NSUInteger (*size)(const void* item));
@@ -0,0 +1,137 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <Foundation/NSEnumerator.h>
+#import <Foundation/NSPointerFunctions.h>
+
+#import <memory>
+#import <vector>
+
+// Open-addressing (linear probing) table of pointers, backing both NSHashTable and NSMapTable.
+//
+// Keys and values are stored according to their NSPointerFunctions. Weak keys and values are held as zeroing weak references
+// in the slots themselves, rather than through a per-key dealloc observer: when a weak key is deallocated its entry stays put
+// until a probe runs into it, the table rehashes, or Count() is asked for, and is reclaimed then.
+//
+// Relinquishing a key or value can deallocate an object whose dealloc reenters the table, so relinquishes are deferred until
+// the outermost operation on the table has finished.
+class _NSPointerTable {
+public:
+    // valueFunctions is nil for tables that only hold keys (NSHashTable).
+    _NSPointerTable(NSPointerFunctions* keyFunctions, NSPointerFunctions* valueFunctions, NSUInteger capacity);
+    ~_NSPointerTable();
+
+    _NSPointerTable(const _NSPointerTable&) = delete;
+    _NSPointerTable& operator=(const _NSPointerTable&) = delete;
+
+    bool Contains(id key);
+    // The stored key equal to key, or nil. Weakly held keys are returned autoreleased.
+    id Member(id key);
+    // The value stored for key, or nil. Weakly held values are returned autoreleased.
+    id ObjectForKey(id key);
+
+    // Acquires key and value and stores them. If an equal key is already stored, its entry is replaced when replaceExisting is
+    // true, and the table is left unchanged otherwise.
+    void Insert(id key, id value, bool replaceExisting);
+    void Remove(id key);
+    void RemoveAll();
+
+    // The number of entries, after reclaiming those whose weak keys have been deallocated.
+    NSUInteger Count();
+
+    // Slot order enumeration. Returns false for empty slots and for slots whose weak key has been deallocated.
+    NSUInteger SlotCount() const {
+        return _capacity;
+    }
+    bool EntryAtSlot(NSUInteger index, id* key, id* value);
+
+    NSUInteger CountByEnumerating(NSFastEnumerationState* state, id* stackbuf, NSUInteger len, bool returnKeys);
+
+private:
+    struct _Functions {
+        NSUInteger (*hash)(const void*, NSUInteger (*)(const void*));
+        BOOL (*isEqual)(const void*, const void*, NSUInteger (*)(const void*));
+        NSUInteger (*size)(const void*);
+        void* (*acquire)(const void*, NSUInteger (*)(const void*), BOOL);
+        void (*relinquish)(const void*, NSUInteger (*)(const void*));
+        bool copyIn;
+        bool weak;
+        // hash and isEqual are the default address-based functions, so neither needs to be called.
+        bool addressIdentity;
+    };
+
+    enum class _SlotState : uint8_t { Empty = 0, Occupied, Deleted };
+
+    struct _Slot {
+        // Zeroing weak references when the corresponding functions use weak memory.
+        id key;
+        id value;
+        // The key's address when it was stored, so that address-identity tables can compare weak keys without loading them.
+        uintptr_t identity;
+        NSUInteger hash;
+        _SlotState state;
+    };
+
+    // Scopes a public operation, relinquishing deferred keys and values when the outermost one ends.
+    class _Operation {
+    public:
+        explicit _Operation(_NSPointerTable& table);
+        ~_Operation();
+
+    private:
+        _NSPointerTable& _table;
+    };
+
+    static _Functions _FunctionsFrom(NSPointerFunctions* functions);
+
+    NSUInteger _Hash(id key) const;
+    bool _IsEqual(id key, id storedKey) const;
+    bool _IsLive(_Slot& slot);
+    id _Acquire(const _Functions& functions, id item);
+    void _Relinquish(const _Functions& functions, id item);
+    void _Store(const _Functions& functions, id* location, id item);
+
+    _Slot* _Find(id key);
+    void _Clear(_Slot& slot);
+    void _Rehash(NSUInteger capacity);
+    bool _ReclaimDeadKeys();
+    void _DrainRelinquished();
+
+    _Functions _keys;
+    _Functions _values;
+    bool _hasValues;
+
+    std::unique_ptr<_Slot[]> _slots;
+    NSUInteger _capacity; // Zero, or a power of two
+    NSUInteger _count; // Occupied slots, including those whose weak key has been deallocated but not yet reclaimed
+    NSUInteger _deleted;
+    unsigned long _mutations;
+
+    struct _Relinquished {
+        id item;
+        void (*relinquish)(const void*, NSUInteger (*)(const void*));
+        NSUInteger (*size)(const void*);
+    };
+
+    unsigned int _operationDepth;
+    std::vector<_Relinquished> _relinquished;
+};
+
+// Enumerates the keys or the values of a _NSPointerTable, retaining the collection that owns it.
+@interface _NSPointerTableEnumerator : NSEnumerator
+- (instancetype)initWithCollection:(id)collection table:(_NSPointerTable*)table returnKeys:(BOOL)returnKeys;
+@end
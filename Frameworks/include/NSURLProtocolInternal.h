@@ -21,4 +21,12 @@
 @interface NSURLProtocol ()
 + (id)_URLProtocolClassForRequest:(id)request;
 
-@end
\ No newline at end of file
+@end
+
+// Implemented by protocol clients that track request bodies. Protocols that stream bodies report each piece once it is written.
+@protocol _NSURLProtocolClientBodyProgress <NSURLProtocolClient>
+- (void)URLProtocol:(NSURLProtocol*)protocol
+             didSendBodyData:(int64_t)bytesSent
+              totalBytesSent:(int64_t)totalBytesSent
+    totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend;
+@end
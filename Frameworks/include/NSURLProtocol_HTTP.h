@@ -0,0 +1,35 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+#import <Foundation/NSURLProtocol.h>
+
+// An HTTP/1.1 protocol built directly on nonblocking sockets. Requests to the same host and port share a pool of persistent
+// connections, capped at the session's HTTPMaximumConnectionsPerHost; GET and HEAD requests that allow pipelining are queued
+// behind one another on connections the server has kept alive. Response bodies are handed to the client as views into the
+// receive buffers rather than as copies. Request bodies are streamed a piece at a time as the socket drains, chunked when
+// their length is unknown.
+//
+// The class only handles plain http, and is not registered globally: sessions opt in through
+// NSURLSessionConfiguration.protocolClasses, ahead of the default WinHTTP-backed protocol. Upload tasks use it in place of
+// the default protocol for plain http without being asked, since the default protocol needs the whole body in memory;
+// protocols registered with +[NSURLProtocol registerClass:] still take precedence.
+@interface NSURLProtocol_HTTP : NSURLProtocol
+// The number of connections opened and requests written by every instance since the process started.
++ (NSUInteger)_connectionsOpened;
++ (NSUInteger)_requestsSent;
+@end
@@ -57,7 +57,10 @@
                  identifier:(NSUInteger)identifier
               configuration:(NSURLSessionConfiguration*)configuration
                     request:(NSURLRequest*)request;
++ (Class)_protocolClassForRequest:(NSURLRequest*)request;
+- (void)_signalCompletionInState:(NSURLSessionTaskState)state withError:(NSError*)error;
 @property (readwrite, assign) id<_NSURLSessionTaskDelegate> _taskDelegate;
+@property (readonly) NSURLSessionConfiguration* _configuration;
 - (void)_updateWithURLResponse:(NSURLResponse*)response;
 
 @property (readwrite, assign) NSURLSessionTaskState state;
@@ -85,3 +88,20 @@
 - (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate identifier:(NSUInteger)identifier configuration:(NSURLSessionConfiguration*)configuration resumeData:(NSData*)resumeData;
 //- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate configuration:(NSURLSessionConfiguration*)configuration dataTask:(NSURLSessionDataTask*)dataTask;
 @end
+
+@interface NSURLSessionUploadTask ()
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+                    request:(NSURLRequest*)request
+                   fromData:(NSData*)data;
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+                    request:(NSURLRequest*)request
+                   fromFile:(NSURL*)fileURL;
+- (id)_initWithTaskDelegate:(id<_NSURLSessionTaskDelegate>)taskDelegate
+                 identifier:(NSUInteger)identifier
+              configuration:(NSURLSessionConfiguration*)configuration
+            streamedRequest:(NSURLRequest*)request;
+@end
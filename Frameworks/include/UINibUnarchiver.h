@@ -28,13 +28,20 @@ class Item;
     char** _classNames;
     id* _classTypes;
     char** _keyNames;
-    Object** _objects;
-    Item** _objectItems;
+    Object* _objects;
+    Item* _items;
     Object* _curObject[16];
 
+    // Open-addressed table of key IDs (plus one) hashed by key name, so decode*ForKey: resolves its key once per call
+    unsigned int* _keyIndex;
+    unsigned int _keyIndexMask;
+    unsigned int _emptyKeyId;
+    unsigned int _bytesKeyId;
+
     int _curObjectLevel;
 
     id _bundle;
+    NSData* _data;
 }
 - (double)decodeDoubleForKey:(id)key;
 - (float)decodeFloatForKey:(id)key;
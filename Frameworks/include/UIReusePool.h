@@ -0,0 +1,153 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <Foundation/NSString.h>
+#import <UIKit/UIKitExport.h>
+
+#include <algorithm>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Small integer standing in for a reuse identifier (or element kind) string.
+typedef uint32_t UIReuseIdentifier;
+
+static const UIReuseIdentifier UIReuseIdentifierNone = 0;
+
+// Returns the handle for identifier; strings that compare equal always share a handle, and nil or empty strings map to
+// UIReuseIdentifierNone. Handles are never recycled. Repeated lookups of the same immutable string instance skip hashing.
+// Like the views that use it, this must only be called on the main thread.
+UIKIT_EXPORT UIReuseIdentifier _UIInternReuseIdentifier(NSString* identifier);
+
+// Reusable views queued by (kind, identifier) handle, each queue with its own maximum size.
+// T is whatever the owning view needs to remember about a queued view; the pool never inspects it.
+template <typename T>
+class UIReusePool {
+public:
+    static const size_t c_unlimited = SIZE_MAX;
+
+    explicit UIReusePool(size_t defaultMaximumCount = c_unlimited) : _defaultMaximumCount(defaultMaximumCount) {
+    }
+
+    UIReusePool(const UIReusePool&) = delete;
+    UIReusePool& operator=(const UIReusePool&) = delete;
+
+    // Returns false, leaving item with the caller, if the queue is already at its maximum size.
+    bool Enqueue(UIReuseIdentifier identifier, T item, UIReuseIdentifier kind = UIReuseIdentifierNone) {
+        Queue& queue = _QueueFor(identifier, kind);
+        if (queue.items.size() >= queue.maximumCount) {
+            return false;
+        }
+
+        queue.items.push_back(std::move(item));
+        return true;
+    }
+
+    // Pops the most recently enqueued item into *item. Returns false if the queue is empty.
+    bool Dequeue(UIReuseIdentifier identifier, T* item, UIReuseIdentifier kind = UIReuseIdentifierNone) {
+        auto it = _queues.find(_Key(identifier, kind));
+        if (it == _queues.end() || it->second.items.empty()) {
+            return false;
+        }
+
+        *item = std::move(it->second.items.back());
+        it->second.items.pop_back();
+        return true;
+    }
+
+    // Removes item from its queue wherever it is. Returns false if it wasn't queued.
+    bool Remove(UIReuseIdentifier identifier, const T& item, UIReuseIdentifier kind = UIReuseIdentifierNone) {
+        auto it = _queues.find(_Key(identifier, kind));
+        if (it == _queues.end()) {
+            return false;
+        }
+
+        auto& items = it->second.items;
+        auto found = std::find(items.begin(), items.end(), item);
+        if (found == items.end()) {
+            return false;
+        }
+
+        items.erase(found);
+        return true;
+    }
+
+    size_t GetCount(UIReuseIdentifier identifier, UIReuseIdentifier kind = UIReuseIdentifierNone) const {
+        auto it = _queues.find(_Key(identifier, kind));
+        return it == _queues.end() ? 0 : it->second.items.size();
+    }
+
+    size_t GetMaximumCount(UIReuseIdentifier identifier, UIReuseIdentifier kind = UIReuseIdentifierNone) const {
+        auto it = _queues.find(_Key(identifier, kind));
+        return it == _queues.end() ? _defaultMaximumCount : it->second.maximumCount;
+    }
+
+    // Items beyond the new maximum are evicted oldest first and handed to evict(T&).
+    template <typename EvictFunction>
+    void SetMaximumCount(UIReuseIdentifier identifier, size_t maximumCount, EvictFunction evict, UIReuseIdentifier kind = UIReuseIdentifierNone) {
+        Queue& queue = _QueueFor(identifier, kind);
+        queue.maximumCount = maximumCount;
+
+        if (queue.items.size() > maximumCount) {
+            size_t excess = queue.items.size() - maximumCount;
+            for (size_t i = 0; i < excess; i++) {
+                evict(queue.items[i]);
+            }
+            queue.items.erase(queue.items.begin(), queue.items.begin() + excess);
+        }
+    }
+
+    // Calls function(T&) for every queued item.
+    template <typename Function>
+    void ForEach(Function function) {
+        for (auto& entry : _queues) {
+            for (auto& item : entry.second.items) {
+                function(item);
+            }
+        }
+    }
+
+    // Drops every queued item but keeps per-queue maximums.
+    void Clear() {
+        for (auto& entry : _queues) {
+            entry.second.items.clear();
+        }
+    }
+
+private:
+    struct Queue {
+        std::vector<T> items;
+        size_t maximumCount;
+    };
+
+    static uint64_t _Key(UIReuseIdentifier identifier, UIReuseIdentifier kind) {
+        return (static_cast<uint64_t>(kind) << 32) | identifier;
+    }
+
+    Queue& _QueueFor(UIReuseIdentifier identifier, UIReuseIdentifier kind) {
+        auto result = _queues.emplace(_Key(identifier, kind), Queue());
+        if (result.second) {
+            result.first->second.maximumCount = _defaultMaximumCount;
+        }
+        return result.first->second;
+    }
+
+    std::unordered_map<uint64_t, Queue> _queues;
+    size_t _defaultMaximumCount;
+};
@@ -19,10 +19,10 @@
 #include <UIKit/UIStoryboardSegueTemplate.h>
 #include <UIKit/UITableView.h>
 #include <UIKit/UITableViewDataSource.h>
+#include <UIKit/UITableViewDataSourcePrefetching.h>
 #include <UIKit/UITableViewDelegate.h>
 
-#include <unordered_map>
-#include <vector>
+#include "UIReusePool.h"
 
 class TableViewNode;
 class TableViewSection;
@@ -34,14 +34,18 @@ class VisibleComponents;
 @class UICollectionViewData;
 
 struct UITableViewPriv {
+    // Matches the historical behaviour of keeping at most six offscreen cells per reuse identifier.
+    static const size_t c_defaultMaximumReusableCells = 6;
+
     id<UITableViewDelegate> _delegate; // this should be idweak
     id<UITableViewDataSource> _dataSource;
+    id<UITableViewDataSourcePrefetching> _prefetchDataSource; // this should be idweak
     idretain _footerView;
     idretain _externalObjects;
     float _footerYPos;
     StrongId<UIView> _headerView;
     StrongId<UIView> _backgroundView;
-    std::unordered_map<std::string, std::vector<ReusableCell*>> _reusableCells;
+    UIReusePool<ReusableCell*> _reusableCells{ c_defaultMaximumReusableCells };
     StrongId<NSMutableDictionary> _reusableCellNibs;
     StrongId<NSMutableDictionary> _reusableHeaderClasses;
     StrongId<NSMutableDictionary> _reusableCellClasses;
@@ -67,6 +71,11 @@ struct UITableViewPriv {
 
     CGSize _lastSize;
 
+    // Rows handed to the prefetch data source that haven't been displayed or cancelled yet.
+    StrongId<NSMutableSet> _prefetchedIndexPaths;
+    float _lastPrefetchOffset;
+    bool _prefetchingForward;
+
     void removeReusableCell(ReusableCell* cell);
     void addReusableCell(id cell);
     void addReusableCell(TableViewRow* row);
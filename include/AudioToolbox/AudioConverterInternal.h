@@ -16,46 +16,14 @@
 //******************************************************************************
 #pragma once
 
-// This is needed for getting mfapi.h to build in unit tests. 
-#ifndef OUT
-#define OUT
-#endif
-
-#include <COMIncludes.h>
-#import <wrl\client.h>
-#import <wrl\wrappers\corewrappers.h>
-#include <mfapi.h>
-#include <mfidl.h>
-#include <mferror.h>
-#include <wmcodecdsp.h>
-#include <COMIncludes_End.h>
-
 #import <Foundation/NSObject.h>
 #import <CoreAudio/CoreAudioTypes.h>
 
-using namespace Microsoft::WRL;
-using namespace Microsoft::WRL::Wrappers;
-
-#define RETURN_AUDIOERR_IF_FAILED_WITH_MSG(hr, msg) \
-    if (FAILED(hr)) {                               \
-        NSTraceInfo(TAG, @"%@  %@", msg, hr);       \
-        return kAudioConverterErr_UnspecifiedError; \
-    }
-
-#define RETURN_NIL_IF_FAILED(hr)       \
-    if (FAILED(hr)) {                  \
-        self = nil;                    \
-        return nil;                    \
-    }
+#include <memory>
 
+class AudioConverterPipeline;
 
 @interface AudioConverter : NSObject
-@property (atomic) ComPtr<IMFTransform> transform;
-@property (atomic) float sizeChangeMultiplier;
-- (instancetype)initWithSourceFormat:(const AudioStreamBasicDescription*)srcFormat
-                   destinationFormat:(const AudioStreamBasicDescription*)destFormat;
-- (ComPtr<IMFTransform>)getTransform;
-- (float)getSizeChangeMultiplier;
+- (instancetype)initWithPipeline:(std::unique_ptr<AudioConverterPipeline>)pipeline;
+- (AudioConverterPipeline*)pipeline;
 @end
-
-OSStatus _setMFProperties(const AudioStreamBasicDescription* format, IMFMediaType** mediaType);
\ No newline at end of file
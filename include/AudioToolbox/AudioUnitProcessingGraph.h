@@ -55,44 +55,44 @@ typedef struct OpaqueAUGraph* AUGraph;
 typedef struct AudioUnitNodeConnection AudioUnitNodeConnection;
 typedef struct AUNodeInteraction AUNodeInteraction;
 
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphAddNode(AUGraph inGraph, const AudioComponentDescription* inDescription, AUNode* outNode) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphAddRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphClearConnections(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphClose(AUGraph inGraph) STUB_METHOD;
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphAddNode(AUGraph inGraph, const AudioComponentDescription* inDescription, AUNode* outNode);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphAddRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphClearConnections(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphClose(AUGraph inGraph);
 AUDIOTOOLBOX_EXPORT OSStatus AUGraphConnectNodeInput(
-    AUGraph inGraph, AUNode inSourceNode, UInt32 inSourceOutputNumber, AUNode inDestNode, UInt32 inDestInputNumber) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphCountNodeInteractions(AUGraph inGraph, AUNode inNode, UInt32* outNumInteractions) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphDisconnectNodeInput(AUGraph inGraph, AUNode inDestNode, UInt32 inDestInputNumber) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetCPULoad(AUGraph inGraph, Float32* outAverageCPULoad) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetIndNode(AUGraph inGraph, UInt32 inIndex, AUNode* outNode) STUB_METHOD;
+    AUGraph inGraph, AUNode inSourceNode, UInt32 inSourceOutputNumber, AUNode inDestNode, UInt32 inDestInputNumber);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphCountNodeInteractions(AUGraph inGraph, AUNode inNode, UInt32* outNumInteractions);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphDisconnectNodeInput(AUGraph inGraph, AUNode inDestNode, UInt32 inDestInputNumber);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetCPULoad(AUGraph inGraph, Float32* outAverageCPULoad);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetIndNode(AUGraph inGraph, UInt32 inIndex, AUNode* outNode);
 AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetInteractionInfo(AUGraph inGraph,
                                                        UInt32 inInteractionIndex,
-                                                       AUNodeInteraction* outInteraction) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetMaxCPULoad(AUGraph inGraph, Float32* outMaxLoad) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetNodeCount(AUGraph inGraph, UInt32* outNumberOfNodes) STUB_METHOD;
+                                                       AUNodeInteraction* outInteraction);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetMaxCPULoad(AUGraph inGraph, Float32* outMaxLoad);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetNodeCount(AUGraph inGraph, UInt32* outNumberOfNodes);
 AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetNodeInteractions(AUGraph inGraph,
                                                         AUNode inNode,
                                                         UInt32* ioNumInteractions,
-                                                        AUNodeInteraction* outInteractions) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetNumberOfInteractions(AUGraph inGraph, UInt32* outNumInteractions) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphInitialize(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsInitialized(AUGraph inGraph, Boolean* outIsInitialized) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsOpen(AUGraph inGraph, Boolean* outIsOpen) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsRunning(AUGraph inGraph, Boolean* outIsRunning) STUB_METHOD;
+                                                        AUNodeInteraction* outInteractions);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphGetNumberOfInteractions(AUGraph inGraph, UInt32* outNumInteractions);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphInitialize(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsInitialized(AUGraph inGraph, Boolean* outIsInitialized);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsOpen(AUGraph inGraph, Boolean* outIsOpen);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphIsRunning(AUGraph inGraph, Boolean* outIsRunning);
 AUDIOTOOLBOX_EXPORT OSStatus AUGraphNodeInfo(AUGraph inGraph,
                                              AUNode inNode,
                                              AudioComponentDescription* outDescription,
-                                             AudioUnit _Nullable* outAudioUnit) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphOpen(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphRemoveNode(AUGraph inGraph, AUNode inNode) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphRemoveRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon) STUB_METHOD;
+                                             AudioUnit _Nullable* outAudioUnit);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphOpen(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphRemoveNode(AUGraph inGraph, AUNode inNode);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphRemoveRenderNotify(AUGraph inGraph, AURenderCallback inCallback, void* inRefCon);
 AUDIOTOOLBOX_EXPORT OSStatus AUGraphSetNodeInputCallback(AUGraph inGraph,
                                                          AUNode inDestNode,
                                                          UInt32 inDestInputNumber,
-                                                         const AURenderCallbackStruct* inInputCallback) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphStart(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphStop(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphUninitialize(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus AUGraphUpdate(AUGraph inGraph, Boolean* outIsUpdated) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus DisposeAUGraph(AUGraph inGraph) STUB_METHOD;
-AUDIOTOOLBOX_EXPORT OSStatus NewAUGraph(AUGraph _Nullable* outGraph) STUB_METHOD;
\ No newline at end of file
+                                                         const AURenderCallbackStruct* inInputCallback);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphStart(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphStop(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphUninitialize(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus AUGraphUpdate(AUGraph inGraph, Boolean* outIsUpdated);
+AUDIOTOOLBOX_EXPORT OSStatus DisposeAUGraph(AUGraph inGraph);
+AUDIOTOOLBOX_EXPORT OSStatus NewAUGraph(AUGraph _Nullable* outGraph);
\ No newline at end of file
@@ -88,17 +88,17 @@ enum {
     kAudioUnitRenderAction_DoNotCheckRenderArgs = (1 << 9)
 };
 
-AUDIOUNIT_EXPORT OSStatus AudioUnitInitialize(AudioUnit inUnit) STUB_METHOD;
-AUDIOUNIT_EXPORT OSStatus AudioUnitUninitialize(AudioUnit inUnit) STUB_METHOD;
-AUDIOUNIT_EXPORT OSStatus AudioUnitAddRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData) STUB_METHOD;
-AUDIOUNIT_EXPORT OSStatus AudioUnitRemoveRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData) STUB_METHOD;
+AUDIOUNIT_EXPORT OSStatus AudioUnitInitialize(AudioUnit inUnit);
+AUDIOUNIT_EXPORT OSStatus AudioUnitUninitialize(AudioUnit inUnit);
+AUDIOUNIT_EXPORT OSStatus AudioUnitAddRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData);
+AUDIOUNIT_EXPORT OSStatus AudioUnitRemoveRenderNotify(AudioUnit inUnit, AURenderCallback inProc, void* inProcUserData);
 AUDIOUNIT_EXPORT OSStatus AudioUnitRender(AudioUnit inUnit,
                                           AudioUnitRenderActionFlags* ioActionFlags,
                                           const AudioTimeStamp* inTimeStamp,
                                           UInt32 inOutputBusNumber,
                                           UInt32 inNumberFrames,
-                                          AudioBufferList* ioData) STUB_METHOD;
-AUDIOUNIT_EXPORT OSStatus AudioUnitReset(AudioUnit inUnit, AudioUnitScope inScope, AudioUnitElement inElement) STUB_METHOD;
+                                          AudioBufferList* ioData);
+AUDIOUNIT_EXPORT OSStatus AudioUnitReset(AudioUnit inUnit, AudioUnitScope inScope, AudioUnitElement inElement);
 AUDIOUNIT_EXPORT OSStatus AudioUnitAddPropertyListener(AudioUnit inUnit,
                                                        AudioUnitPropertyID inID,
                                                        AudioUnitPropertyListenerProc inProc,
@@ -112,33 +112,33 @@ AUDIOUNIT_EXPORT OSStatus AudioUnitGetProperty(AudioUnit inUnit,
                                                AudioUnitScope inScope,
                                                AudioUnitElement inElement,
                                                void* outData,
-                                               UInt32* ioDataSize) STUB_METHOD;
+                                               UInt32* ioDataSize);
 AUDIOUNIT_EXPORT OSStatus AudioUnitGetPropertyInfo(AudioUnit inUnit,
                                                    AudioUnitPropertyID inID,
                                                    AudioUnitScope inScope,
                                                    AudioUnitElement inElement,
                                                    UInt32* outDataSize,
-                                                   Boolean* outWritable) STUB_METHOD;
+                                                   Boolean* outWritable);
 AUDIOUNIT_EXPORT OSStatus AudioUnitSetProperty(AudioUnit inUnit,
                                                AudioUnitPropertyID inID,
                                                AudioUnitScope inScope,
                                                AudioUnitElement inElement,
                                                const void* inData,
-                                               UInt32 inDataSize) STUB_METHOD;
+                                               UInt32 inDataSize);
 AUDIOUNIT_EXPORT OSStatus AudioUnitGetParameter(AudioUnit inUnit,
                                                 AudioUnitParameterID inID,
                                                 AudioUnitScope inScope,
                                                 AudioUnitElement inElement,
-                                                AudioUnitParameterValue* outValue) STUB_METHOD;
+                                                AudioUnitParameterValue* outValue);
 AUDIOUNIT_EXPORT OSStatus AudioUnitSetParameter(AudioUnit inUnit,
                                                 AudioUnitParameterID inID,
                                                 AudioUnitScope inScope,
                                                 AudioUnitElement inElement,
                                                 AudioUnitParameterValue inValue,
-                                                UInt32 inBufferOffsetInFrames) STUB_METHOD;
+                                                UInt32 inBufferOffsetInFrames);
 AUDIOUNIT_EXPORT OSStatus AudioUnitScheduleParameters(AudioUnit inUnit,
                                                       const AudioUnitParameterEvent* inParameterEvent,
-                                                      UInt32 inNumParamEvents) STUB_METHOD;
+                                                      UInt32 inNumParamEvents);
 enum {
     kAudioUnitType_Output = 'auou',
     kAudioUnitType_MusicDevice = 'aumu',
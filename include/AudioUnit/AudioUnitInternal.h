@@ -0,0 +1,56 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#import <AudioUnit/AudioUnitComponent.h>
+#import <AudioUnit/AudioUnitProperties.h>
+
+// The AudioUnit* functions dispatch through this interface, so audio units can be implemented by whichever framework
+// creates them (the AUGraph in AudioToolbox creates its nodes' units) without AudioUnit depending on that framework.
+struct OpaqueAudioComponentInstance {
+    virtual ~OpaqueAudioComponentInstance() {
+    }
+
+    virtual OSStatus Initialize() = 0;
+    virtual OSStatus Uninitialize() = 0;
+    virtual OSStatus Reset(AudioUnitScope scope, AudioUnitElement element) = 0;
+
+    virtual OSStatus GetPropertyInfo(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, UInt32* outSize, Boolean* outWritable) = 0;
+    virtual OSStatus GetProperty(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, void* outData, UInt32* ioSize) = 0;
+    virtual OSStatus SetProperty(
+        AudioUnitPropertyID propertyID, AudioUnitScope scope, AudioUnitElement element, const void* data, UInt32 size) = 0;
+
+    virtual OSStatus GetParameter(AudioUnitParameterID parameterID,
+                                  AudioUnitScope scope,
+                                  AudioUnitElement element,
+                                  AudioUnitParameterValue* outValue) = 0;
+    virtual OSStatus SetParameter(AudioUnitParameterID parameterID,
+                                  AudioUnitScope scope,
+                                  AudioUnitElement element,
+                                  AudioUnitParameterValue value,
+                                  UInt32 bufferOffsetInFrames) = 0;
+
+    virtual OSStatus AddRenderNotify(AURenderCallback proc, void* userData) = 0;
+    virtual OSStatus RemoveRenderNotify(AURenderCallback proc, void* userData) = 0;
+
+    virtual OSStatus Render(AudioUnitRenderActionFlags* ioActionFlags,
+                            const AudioTimeStamp* timeStamp,
+                            UInt32 outputBusNumber,
+                            UInt32 frames,
+                            AudioBufferList* ioData) = 0;
+};
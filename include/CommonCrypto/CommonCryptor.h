@@ -82,6 +82,32 @@ enum { kCCOptionPKCS7Padding = 1, kCCOptionECBMode = 2 };
 
 typedef int32_t CCOptions;
 
+enum {
+    kCCModeECB = 1,
+    kCCModeCBC = 2,
+    kCCModeCFB = 3,
+    kCCModeCTR = 4,
+    kCCModeOFB = 7,
+    kCCModeRC4 = 9,
+    kCCModeCFB8 = 10,
+};
+
+typedef uint32_t CCMode;
+
+enum {
+    ccNoPadding = 0,
+    ccPKCS7Padding = 1,
+};
+
+typedef uint32_t CCPadding;
+
+enum {
+    kCCModeOptionCTR_LE = 0x0001,
+    kCCModeOptionCTR_BE = 0x0002,
+};
+
+typedef uint32_t CCModeOptions;
+
 struct CC_Cryptor_State;
 typedef struct CC_Cryptor_State* CCCryptorRef;
 
@@ -101,6 +127,19 @@ SB_IMPEXP CCCryptorStatus CCCryptorCreateFromData(CCOperation op,
                                                   CCCryptorRef* cryptorRef,
                                                   size_t* dataUsed);
 
+SB_IMPEXP CCCryptorStatus CCCryptorCreateWithMode(CCOperation op,
+                                                  CCMode mode,
+                                                  CCAlgorithm alg,
+                                                  CCPadding padding,
+                                                  const void* iv,
+                                                  const void* key,
+                                                  size_t keyLength,
+                                                  const void* tweak,
+                                                  size_t tweakLength,
+                                                  int numRounds,
+                                                  CCModeOptions options,
+                                                  CCCryptorRef* cryptorRef);
+
 SB_IMPEXP CCCryptorStatus CCCryptorRelease(CCCryptorRef cryptorRef);
 
 SB_IMPEXP CCCryptorStatus CCCryptorUpdate(
@@ -0,0 +1,77 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include <StarboardExport.h>
+#include <CommonCrypto/CommonCryptor.h>
+#include <stddef.h>
+
+enum {
+    kCCModeGCM = 11,
+};
+
+SB_EXTERNC_BEGIN
+
+SB_IMPEXP CCCryptorStatus CCCryptorGCMAddIV(CCCryptorRef cryptorRef, const void* iv, size_t ivLen);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMSetIV(CCCryptorRef cryptorRef, const void* iv, size_t ivLen);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMAddAAD(CCCryptorRef cryptorRef, const void* aData, size_t aDataLen);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMEncrypt(CCCryptorRef cryptorRef, const void* dataIn, size_t dataInLength, void* dataOut);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMDecrypt(CCCryptorRef cryptorRef, const void* dataIn, size_t dataInLength, void* dataOut);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMFinal(CCCryptorRef cryptorRef, void* tagOut, size_t* tagLength);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMFinalize(CCCryptorRef cryptorRef, void* tag, size_t tagSize);
+SB_IMPEXP CCCryptorStatus CCCryptorGCMReset(CCCryptorRef cryptorRef);
+
+SB_IMPEXP CCCryptorStatus CCCryptorGCM(CCOperation op,
+                                       CCAlgorithm alg,
+                                       const void* key,
+                                       size_t keyLength,
+                                       const void* iv,
+                                       size_t ivLen,
+                                       const void* aData,
+                                       size_t aDataLen,
+                                       const void* dataIn,
+                                       size_t dataInLength,
+                                       void* dataOut,
+                                       void* tagOut,
+                                       size_t* tagLength);
+
+SB_IMPEXP CCCryptorStatus CCCryptorGCMOneshotEncrypt(CCAlgorithm alg,
+                                                     const void* key,
+                                                     size_t keyLength,
+                                                     const void* iv,
+                                                     size_t ivLen,
+                                                     const void* aData,
+                                                     size_t aDataLen,
+                                                     const void* dataIn,
+                                                     size_t dataInLength,
+                                                     void* dataOut,
+                                                     void* tagOut,
+                                                     size_t tagLength);
+
+SB_IMPEXP CCCryptorStatus CCCryptorGCMOneshotDecrypt(CCAlgorithm alg,
+                                                     const void* key,
+                                                     size_t keyLength,
+                                                     const void* iv,
+                                                     size_t ivLen,
+                                                     const void* aData,
+                                                     size_t aDataLen,
+                                                     const void* dataIn,
+                                                     size_t dataInLength,
+                                                     void* dataOut,
+                                                     const void* tagIn,
+                                                     size_t tagLength);
+
+SB_EXTERNC_END
@@ -18,6 +18,8 @@
 
 #include <StarboardExport.h>
 #include <StubIncludes.h>
+#include <stddef.h>
+#include <stdint.h>
 
 struct CC_Digest_State;
 typedef struct CC_Digest_State* CC_MD2_CTX;
@@ -40,6 +42,22 @@ typedef unsigned long CC_LONG;
 #define CC_SHA384_DIGEST_LENGTH 48
 #define CC_SHA512_DIGEST_LENGTH 64
 
+// Microsoft Extension
+typedef uint32_t CCDigestAlgorithm;
+
+// Microsoft Extension
+enum {
+    kCCDigestNone = 0,
+    kCCDigestMD2 = 1,
+    kCCDigestMD4 = 2,
+    kCCDigestMD5 = 3,
+    kCCDigestSHA1 = 8,
+    kCCDigestSHA224 = 9,
+    kCCDigestSHA256 = 10,
+    kCCDigestSHA384 = 11,
+    kCCDigestSHA512 = 12,
+};
+
 SB_EXTERNC_BEGIN
 
 int CC_MD2_Init(CC_MD2_CTX* c);
@@ -62,10 +80,10 @@ int CC_SHA1_Update(CC_SHA1_CTX* ctx, const void* data, CC_LONG len);
 int CC_SHA1_Final(unsigned char* digest, CC_SHA1_CTX* ctx);
 unsigned char* CC_SHA1(const void* data, CC_LONG len, unsigned char* md);
 
-int CC_SHA224_Init(CC_SHA224_CTX* ctx) STUB_METHOD;
-int CC_SHA224_Update(CC_SHA224_CTX* ctx, const void* data, CC_LONG len) STUB_METHOD;
-int CC_SHA224_Final(unsigned char* digest, CC_SHA224_CTX* ctx) STUB_METHOD;
-unsigned char* CC_SHA224(const void* data, CC_LONG len, unsigned char* md) STUB_METHOD;
+int CC_SHA224_Init(CC_SHA224_CTX* ctx);
+int CC_SHA224_Update(CC_SHA224_CTX* ctx, const void* data, CC_LONG len);
+int CC_SHA224_Final(unsigned char* digest, CC_SHA224_CTX* ctx);
+unsigned char* CC_SHA224(const void* data, CC_LONG len, unsigned char* md);
 
 int CC_SHA256_Init(CC_SHA256_CTX* ctx);
 int CC_SHA256_Update(CC_SHA256_CTX* ctx, const void* data, CC_LONG len);
@@ -82,4 +100,9 @@ int CC_SHA512_Update(CC_SHA512_CTX* ctx, const void* data, CC_LONG len);
 int CC_SHA512_Final(unsigned char* digest, CC_SHA512_CTX* ctx);
 unsigned char* CC_SHA512(const void* data, CC_LONG len, unsigned char* md);
 
+// Microsoft Extension
+// Digests count independent messages, several at a time where the CPU has wide enough vector units. Supports MD5, SHA-1
+// and the SHA-2 family. digests[i] receives the digest of data[i]. Returns 1 on success or -1 for an unsupported algorithm.
+int CC_DigestMultiple(CCDigestAlgorithm algorithm, const void* const* data, const CC_LONG* lengths, size_t count, unsigned char* const* digests);
+
 SB_EXTERNC_END
\ No newline at end of file
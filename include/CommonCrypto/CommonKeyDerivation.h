@@ -14,4 +14,46 @@
 //
 //******************************************************************************
 
-// This header file is not yet implemented
+#pragma once
+
+#include <StarboardExport.h>
+#include <CommonCrypto/CommonCryptor.h>
+#include <CommonCrypto/CommonDigest.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum {
+    kCCPBKDF2 = 2,
+};
+
+typedef uint32_t CCPBKDFAlgorithm;
+
+enum {
+    kCCPRFHmacAlgSHA1 = 1,
+    kCCPRFHmacAlgSHA224 = 2,
+    kCCPRFHmacAlgSHA256 = 3,
+    kCCPRFHmacAlgSHA384 = 4,
+    kCCPRFHmacAlgSHA512 = 5,
+};
+
+typedef uint32_t CCPseudoRandomAlgorithm;
+
+SB_EXTERNC_BEGIN
+
+int CCKeyDerivationPBKDF(CCPBKDFAlgorithm algorithm,
+                         const char* password,
+                         size_t passwordLen,
+                         const uint8_t* salt,
+                         size_t saltLen,
+                         CCPseudoRandomAlgorithm prf,
+                         unsigned rounds,
+                         uint8_t* derivedKey,
+                         size_t derivedKeyLen);
+unsigned CCCalibratePBKDF(CCPBKDFAlgorithm algorithm,
+                          size_t passwordLen,
+                          size_t saltLen,
+                          CCPseudoRandomAlgorithm prf,
+                          size_t derivedKeyLen,
+                          uint32_t msec);
+
+SB_EXTERNC_END
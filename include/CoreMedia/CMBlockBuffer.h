@@ -30,9 +30,9 @@ typedef struct {
 } CMBlockBufferCustomBlockSource;
 
 COREMEDIA_EXPORT OSStatus CMBlockBufferAccessDataBytes(
-    CMBlockBufferRef theBuffer, size_t offset, size_t length, void* temporaryBlock, char* _Nullable* returnedPointer) STUB_METHOD;
+    CMBlockBufferRef theBuffer, size_t offset, size_t length, void* temporaryBlock, char* _Nullable* returnedPointer);
 COREMEDIA_EXPORT OSStatus CMBlockBufferAppendBufferReference(
-    CMBlockBufferRef theBuffer, CMBlockBufferRef targetBBuf, size_t offsetToData, size_t dataLength, CMBlockBufferFlags flags) STUB_METHOD;
+    CMBlockBufferRef theBuffer, CMBlockBufferRef targetBBuf, size_t offsetToData, size_t dataLength, CMBlockBufferFlags flags);
 COREMEDIA_EXPORT OSStatus CMBlockBufferAppendMemoryBlock(CMBlockBufferRef theBuffer,
                                                          void* memoryBlock,
                                                          size_t blockLength,
@@ -40,12 +40,12 @@ COREMEDIA_EXPORT OSStatus CMBlockBufferAppendMemoryBlock(CMBlockBufferRef theBuf
                                                          const CMBlockBufferCustomBlockSource* customBlockSource,
                                                          size_t offsetToData,
                                                          size_t dataLength,
-                                                         CMBlockBufferFlags flags) STUB_METHOD;
-COREMEDIA_EXPORT OSStatus CMBlockBufferAssureBlockMemory(CMBlockBufferRef theBuffer) STUB_METHOD;
+                                                         CMBlockBufferFlags flags);
+COREMEDIA_EXPORT OSStatus CMBlockBufferAssureBlockMemory(CMBlockBufferRef theBuffer);
 COREMEDIA_EXPORT OSStatus CMBlockBufferCopyDataBytes(CMBlockBufferRef theSourceBuffer,
                                                      size_t offsetToData,
                                                      size_t dataLength,
-                                                     void* destination) STUB_METHOD;
+                                                     void* destination);
 COREMEDIA_EXPORT OSStatus CMBlockBufferCreateContiguous(CFAllocatorRef structureAllocator,
                                                         CMBlockBufferRef sourceBuffer,
                                                         CFAllocatorRef blockAllocator,
@@ -53,17 +53,17 @@ COREMEDIA_EXPORT OSStatus CMBlockBufferCreateContiguous(CFAllocatorRef structure
                                                         size_t offsetToData,
                                                         size_t dataLength,
                                                         CMBlockBufferFlags flags,
-                                                        CMBlockBufferRef _Nullable* newBBufOut) STUB_METHOD;
+                                                        CMBlockBufferRef _Nullable* newBBufOut);
 COREMEDIA_EXPORT OSStatus CMBlockBufferCreateEmpty(CFAllocatorRef structureAllocator,
                                                    uint32_t subBlockCapacity,
                                                    CMBlockBufferFlags flags,
-                                                   CMBlockBufferRef _Nullable* newBBufOut) STUB_METHOD;
+                                                   CMBlockBufferRef _Nullable* newBBufOut);
 COREMEDIA_EXPORT OSStatus CMBlockBufferCreateWithBufferReference(CFAllocatorRef structureAllocator,
                                                                  CMBlockBufferRef targetBuffer,
                                                                  size_t offsetToData,
                                                                  size_t dataLength,
                                                                  CMBlockBufferFlags flags,
-                                                                 CMBlockBufferRef _Nullable* newBBufOut) STUB_METHOD;
+                                                                 CMBlockBufferRef _Nullable* newBBufOut);
 COREMEDIA_EXPORT OSStatus CMBlockBufferCreateWithMemoryBlock(CFAllocatorRef structureAllocator,
                                                              void* memoryBlock,
                                                              size_t blockLength,
@@ -72,21 +72,21 @@ COREMEDIA_EXPORT OSStatus CMBlockBufferCreateWithMemoryBlock(CFAllocatorRef stru
                                                              size_t offsetToData,
                                                              size_t dataLength,
                                                              CMBlockBufferFlags flags,
-                                                             CMBlockBufferRef _Nullable* newBBufOut) STUB_METHOD;
+                                                             CMBlockBufferRef _Nullable* newBBufOut);
 COREMEDIA_EXPORT OSStatus CMBlockBufferFillDataBytes(char fillByte,
                                                      CMBlockBufferRef destinationBuffer,
                                                      size_t offsetIntoDestination,
-                                                     size_t dataLength) STUB_METHOD;
-COREMEDIA_EXPORT size_t CMBlockBufferGetDataLength(CMBlockBufferRef theBuffer) STUB_METHOD;
+                                                     size_t dataLength);
+COREMEDIA_EXPORT size_t CMBlockBufferGetDataLength(CMBlockBufferRef theBuffer);
 COREMEDIA_EXPORT OSStatus CMBlockBufferGetDataPointer(
-    CMBlockBufferRef theBuffer, size_t offset, size_t* lengthAtOffset, size_t* totalLength, char* _Nullable* dataPointer) STUB_METHOD;
-COREMEDIA_EXPORT CFTypeID CMBlockBufferGetTypeID() STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBlockBufferIsEmpty(CMBlockBufferRef theBuffer) STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBlockBufferIsRangeContiguous(CMBlockBufferRef theBuffer, size_t offset, size_t length) STUB_METHOD;
+    CMBlockBufferRef theBuffer, size_t offset, size_t* lengthAtOffset, size_t* totalLength, char* _Nullable* dataPointer);
+COREMEDIA_EXPORT CFTypeID CMBlockBufferGetTypeID();
+COREMEDIA_EXPORT Boolean CMBlockBufferIsEmpty(CMBlockBufferRef theBuffer);
+COREMEDIA_EXPORT Boolean CMBlockBufferIsRangeContiguous(CMBlockBufferRef theBuffer, size_t offset, size_t length);
 COREMEDIA_EXPORT OSStatus CMBlockBufferReplaceDataBytes(const void* sourceBytes,
                                                         CMBlockBufferRef destinationBuffer,
                                                         size_t offsetIntoDestination,
-                                                        size_t dataLength) STUB_METHOD;
+                                                        size_t dataLength);
 
 enum { kCMBlockBufferCustomBlockSourceVersion = 0 };
 
@@ -95,4 +95,17 @@ enum {
     kCMBlockBufferAlwaysCopyDataFlag = (1L << 1),
     kCMBlockBufferDontOptimizeDepthFlag = (1L << 2),
     kCMBlockBufferPermitEmptyReferenceFlag = (1L << 3)
-};
\ No newline at end of file
+};
+
+enum {
+    kCMBlockBufferNoErr = 0,
+    kCMBlockBufferStructureAllocationFailedErr = -12700,
+    kCMBlockBufferBlockAllocationFailedErr = -12701,
+    kCMBlockBufferBadCustomBlockSourceErr = -12702,
+    kCMBlockBufferBadOffsetParameterErr = -12703,
+    kCMBlockBufferBadLengthParameterErr = -12704,
+    kCMBlockBufferBadPointerParameterErr = -12705,
+    kCMBlockBufferEmptyBBufErr = -12706,
+    kCMBlockBufferUnallocatedBlockErr = -12707,
+    kCMBlockBufferInsufficientSpaceErr = -12708,
+};
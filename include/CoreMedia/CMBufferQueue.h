@@ -25,6 +25,7 @@ typedef CFTypeRef CMBufferRef;
 typedef CMTime (*CMBufferGetTimeCallback)(CMBufferRef buf, void* refcon);
 typedef Boolean (*CMBufferGetBooleanCallback)(CMBufferRef buf, void* refcon);
 typedef CFComparisonResult (*CMBufferCompareCallback)(CMBufferRef buf1, CMBufferRef buf2, void* refcon);
+typedef size_t (*CMBufferGetSizeCallback)(CMBufferRef buf, void* refcon);
 typedef struct opaqueCMBufferQueue* CMBufferQueueRef;
 typedef struct {
     uint32_t version;
@@ -35,6 +36,7 @@ typedef struct {
     CMBufferGetBooleanCallback isDataReady;
     CMBufferCompareCallback compare;
     CFStringRef dataBecameReadyNotification;
+    CMBufferGetSizeCallback getSize; // Only present when version is 1.
 } CMBufferCallbacks;
 typedef struct opaqueCMBufferQueueTriggerToken* CMBufferQueueTriggerToken;
 typedef int32_t CMBufferQueueTriggerCondition;
@@ -44,49 +46,50 @@ typedef void (*CMBufferQueueTriggerCallback)(void* triggerRefcon, CMBufferQueueT
 COREMEDIA_EXPORT OSStatus CMBufferQueueCreate(CFAllocatorRef allocator,
                                               CMItemCount capacity,
                                               const CMBufferCallbacks* callbacks,
-                                              CMBufferQueueRef _Nullable* queueOut) STUB_METHOD;
+                                              CMBufferQueueRef _Nullable* queueOut);
 COREMEDIA_EXPORT OSStatus CMBufferQueueCallForEachBuffer(CMBufferQueueRef queue,
                                                          OSStatus (*callback)(CMBufferRef, void*),
-                                                         void* refcon) STUB_METHOD;
-COREMEDIA_EXPORT CMBufferRef CMBufferQueueDequeueAndRetain(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMBufferRef CMBufferQueueDequeueIfDataReadyAndRetain(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT OSStatus CMBufferQueueEnqueue(CMBufferQueueRef queue, CMBufferRef buf) STUB_METHOD;
+                                                         void* refcon);
+COREMEDIA_EXPORT CMBufferRef CMBufferQueueDequeueAndRetain(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMBufferRef CMBufferQueueDequeueIfDataReadyAndRetain(CMBufferQueueRef queue);
+COREMEDIA_EXPORT OSStatus CMBufferQueueEnqueue(CMBufferQueueRef queue, CMBufferRef buf);
 COREMEDIA_EXPORT OSStatus CMBufferQueueInstallTrigger(CMBufferQueueRef queue,
                                                       CMBufferQueueTriggerCallback triggerCallback,
                                                       void* triggerRefcon,
                                                       CMBufferQueueTriggerCondition triggerCondition,
                                                       CMTime triggerTime,
-                                                      CMBufferQueueTriggerToken _Nullable* triggerTokenOut) STUB_METHOD;
+                                                      CMBufferQueueTriggerToken _Nullable* triggerTokenOut);
 COREMEDIA_EXPORT OSStatus CMBufferQueueInstallTriggerWithIntegerThreshold(CMBufferQueueRef queue,
                                                                           CMBufferQueueTriggerCallback triggerCallback,
                                                                           void* triggerRefcon,
                                                                           CMBufferQueueTriggerCondition triggerCondition,
                                                                           CMItemCount triggerThreshold,
-                                                                          CMBufferQueueTriggerToken _Nullable* triggerTokenOut) STUB_METHOD;
-COREMEDIA_EXPORT OSStatus CMBufferQueueMarkEndOfData(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT OSStatus CMBufferQueueRemoveTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken) STUB_METHOD;
-COREMEDIA_EXPORT OSStatus CMBufferQueueReset(CMBufferQueueRef queue) STUB_METHOD;
+                                                                          CMBufferQueueTriggerToken _Nullable* triggerTokenOut);
+COREMEDIA_EXPORT OSStatus CMBufferQueueMarkEndOfData(CMBufferQueueRef queue);
+COREMEDIA_EXPORT OSStatus CMBufferQueueRemoveTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken);
+COREMEDIA_EXPORT OSStatus CMBufferQueueReset(CMBufferQueueRef queue);
 COREMEDIA_EXPORT OSStatus CMBufferQueueResetWithCallback(CMBufferQueueRef queue,
                                                          void (*callback)(CMBufferRef, void*),
-                                                         void* refcon) STUB_METHOD;
+                                                         void* refcon);
 COREMEDIA_EXPORT OSStatus CMBufferQueueSetValidationCallback(CMBufferQueueRef queue,
                                                              CMBufferValidationCallback validationCallback,
-                                                             void* validationRefCon) STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBufferQueueContainsEndOfData(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBufferQueueIsAtEndOfData(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBufferQueueIsEmpty(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT Boolean CMBufferQueueTestTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken) STUB_METHOD;
-COREMEDIA_EXPORT CMItemCount CMBufferQueueGetBufferCount(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetMaxPresentationTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT const CMBufferCallbacks* CMBufferQueueGetCallbacksForUnsortedSampleBuffers() STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetDuration(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetEndPresentationTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetFirstDecodeTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetMinDecodeTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetFirstPresentationTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMBufferRef CMBufferQueueGetHead(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMBufferQueueGetMinPresentationTimeStamp(CMBufferQueueRef queue) STUB_METHOD;
-COREMEDIA_EXPORT CFTypeID CMBufferQueueGetTypeID() STUB_METHOD;
+                                                             void* validationRefCon);
+COREMEDIA_EXPORT Boolean CMBufferQueueContainsEndOfData(CMBufferQueueRef queue);
+COREMEDIA_EXPORT Boolean CMBufferQueueIsAtEndOfData(CMBufferQueueRef queue);
+COREMEDIA_EXPORT Boolean CMBufferQueueIsEmpty(CMBufferQueueRef queue);
+COREMEDIA_EXPORT Boolean CMBufferQueueTestTrigger(CMBufferQueueRef queue, CMBufferQueueTriggerToken triggerToken);
+COREMEDIA_EXPORT CMItemCount CMBufferQueueGetBufferCount(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetMaxPresentationTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT const CMBufferCallbacks* CMBufferQueueGetCallbacksForUnsortedSampleBuffers();
+COREMEDIA_EXPORT CMTime CMBufferQueueGetDuration(CMBufferQueueRef queue);
+COREMEDIA_EXPORT size_t CMBufferQueueGetTotalSize(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetEndPresentationTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetFirstDecodeTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetMinDecodeTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetFirstPresentationTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMBufferRef CMBufferQueueGetHead(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CMTime CMBufferQueueGetMinPresentationTimeStamp(CMBufferQueueRef queue);
+COREMEDIA_EXPORT CFTypeID CMBufferQueueGetTypeID();
 
 enum {
     kCMBufferQueueTrigger_WhenDurationBecomesLessThan = 1,
@@ -101,3 +104,16 @@ enum {
     kCMBufferQueueTrigger_WhenBufferCountBecomesLessThan = 10,
     kCMBufferQueueTrigger_WhenBufferCountBecomesGreaterThan = 11,
 };
+
+enum {
+    kCMBufferQueueError_AllocationFailed = -12760,
+    kCMBufferQueueError_RequiredParameterMissing = -12761,
+    kCMBufferQueueError_InvalidCMBufferCallbacksStruct = -12762,
+    kCMBufferQueueError_EnqueueAfterEndOfData = -12763,
+    kCMBufferQueueError_QueueIsFull = -12764,
+    kCMBufferQueueError_BadTriggerDuration = -12765,
+    kCMBufferQueueError_CannotModifyQueueFromTriggerCallback = -12766,
+    kCMBufferQueueError_InvalidTriggerCondition = -12767,
+    kCMBufferQueueError_InvalidTriggerToken = -12768,
+    kCMBufferQueueError_InvalidBuffer = -12769,
+};
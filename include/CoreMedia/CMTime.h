@@ -33,23 +33,23 @@ typedef struct {
 
 typedef uint32_t CMTimeRoundingMethod;
 
-COREMEDIA_EXPORT CMTime CMTimeMake(int64_t value, int32_t timescale) STUB_METHOD;
+COREMEDIA_EXPORT CMTime CMTimeMake(int64_t value, int32_t timescale);
 COREMEDIA_EXPORT CMTime CMTimeMakeFromDictionary(CFDictionaryRef dict) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeMakeWithEpoch(int64_t value, int32_t timescale, int64_t epoch) STUB_METHOD;
+COREMEDIA_EXPORT CMTime CMTimeMakeWithEpoch(int64_t value, int32_t timescale, int64_t epoch);
 COREMEDIA_EXPORT CMTime CMTimeMakeWithSeconds(Float64 seconds, int32_t preferredTimeScale) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeAbsoluteValue(CMTime time) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeAdd(CMTime addend1, CMTime addend2) STUB_METHOD;
-COREMEDIA_EXPORT int32_t CMTimeCompare(CMTime time1, CMTime time2) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeConvertScale(CMTime time, int32_t newTimescale, CMTimeRoundingMethod method) STUB_METHOD;
+COREMEDIA_EXPORT CMTime CMTimeAbsoluteValue(CMTime time);
+COREMEDIA_EXPORT CMTime CMTimeAdd(CMTime addend1, CMTime addend2);
+COREMEDIA_EXPORT int32_t CMTimeCompare(CMTime time1, CMTime time2);
+COREMEDIA_EXPORT CMTime CMTimeConvertScale(CMTime time, int32_t newTimescale, CMTimeRoundingMethod method);
 COREMEDIA_EXPORT CFDictionaryRef CMTimeCopyAsDictionary(CMTime time, CFAllocatorRef allocator) STUB_METHOD;
 COREMEDIA_EXPORT CFStringRef CMTimeCopyDescription(CFAllocatorRef allocator, CMTime time) STUB_METHOD;
-COREMEDIA_EXPORT Float64 CMTimeGetSeconds(CMTime time) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeMaximum(CMTime time1, CMTime time2) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeMinimum(CMTime time1, CMTime time2) STUB_METHOD;
+COREMEDIA_EXPORT Float64 CMTimeGetSeconds(CMTime time);
+COREMEDIA_EXPORT CMTime CMTimeMaximum(CMTime time1, CMTime time2);
+COREMEDIA_EXPORT CMTime CMTimeMinimum(CMTime time1, CMTime time2);
 COREMEDIA_EXPORT CMTime CMTimeMultiply(CMTime time, int32_t multiplier) STUB_METHOD;
 COREMEDIA_EXPORT CMTime CMTimeMultiplyByFloat64(CMTime time, Float64 multiplier) STUB_METHOD;
 COREMEDIA_EXPORT void CMTimeShow(CMTime time) STUB_METHOD;
-COREMEDIA_EXPORT CMTime CMTimeSubtract(CMTime minuend, CMTime subtrahend) STUB_METHOD;
+COREMEDIA_EXPORT CMTime CMTimeSubtract(CMTime minuend, CMTime subtrahend);
 
 #define CMTIME_COMPARE_INLINE(time1, comparator, time2) ((Boolean)(CMTimeCompare(time1, time2) comparator 0))
 #define CMTIME_IS_VALID(time) ((Boolean)(((time).flags & kCMTimeFlags_Valid) != 0))
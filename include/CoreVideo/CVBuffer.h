@@ -34,10 +34,10 @@ enum {
 COREVIDEO_EXPORT CFTypeRef CVBufferGetAttachment(CVBufferRef buffer, CFStringRef key, CVAttachmentMode* attachmentMode) STUB_METHOD;
 COREVIDEO_EXPORT CFDictionaryRef CVBufferGetAttachments(CVBufferRef buffer, CVAttachmentMode attachmentMode) STUB_METHOD;
 COREVIDEO_EXPORT void CVBufferPropagateAttachments(CVBufferRef sourceBuffer, CVBufferRef destinationBuffer) STUB_METHOD;
-COREVIDEO_EXPORT void CVBufferRelease(CVBufferRef buffer) STUB_METHOD;
+COREVIDEO_EXPORT void CVBufferRelease(CVBufferRef buffer);
 COREVIDEO_EXPORT void CVBufferRemoveAllAttachments(CVBufferRef buffer) STUB_METHOD;
 COREVIDEO_EXPORT void CVBufferRemoveAttachment(CVBufferRef buffer, CFStringRef key) STUB_METHOD;
-COREVIDEO_EXPORT CVBufferRef CVBufferRetain(CVBufferRef buffer) STUB_METHOD;
+COREVIDEO_EXPORT CVBufferRef CVBufferRetain(CVBufferRef buffer);
 COREVIDEO_EXPORT void CVBufferSetAttachment(CVBufferRef buffer, CFStringRef key, CFTypeRef value, CVAttachmentMode attachmentMode)
     STUB_METHOD;
 COREVIDEO_EXPORT void CVBufferSetAttachments(CVBufferRef buffer,
@@ -63,10 +63,10 @@ COREVIDEO_EXPORT CVReturn CVPixelBufferCreate(CFAllocatorRef allocator,
                                               size_t height,
                                               OSType pixelFormatType,
                                               CFDictionaryRef pixelBufferAttributes,
-                                              CVPixelBufferRef _Nullable* pixelBufferOut) STUB_METHOD;
+                                              CVPixelBufferRef _Nullable* pixelBufferOut);
 COREVIDEO_EXPORT CVReturn CVPixelBufferCreateResolvedAttributesDictionary(CFAllocatorRef allocator,
                                                                           CFArrayRef attributes,
-                                                                          CFDictionaryRef _Nullable* resolvedDictionaryOut) STUB_METHOD;
+                                                                          CFDictionaryRef _Nullable* resolvedDictionaryOut);
 COREVIDEO_EXPORT CVReturn CVPixelBufferCreateWithBytes(CFAllocatorRef allocator,
                                                        size_t width,
                                                        size_t height,
@@ -76,7 +76,7 @@ COREVIDEO_EXPORT CVReturn CVPixelBufferCreateWithBytes(CFAllocatorRef allocator,
                                                        CVPixelBufferReleaseBytesCallback releaseCallback,
                                                        void* releaseRefCon,
                                                        CFDictionaryRef pixelBufferAttributes,
-                                                       CVPixelBufferRef _Nullable* pixelBufferOut) STUB_METHOD;
+                                                       CVPixelBufferRef _Nullable* pixelBufferOut);
 COREVIDEO_EXPORT CVReturn CVPixelBufferCreateWithPlanarBytes(CFAllocatorRef allocator,
                                                              size_t width,
                                                              size_t height,
@@ -91,30 +91,30 @@ COREVIDEO_EXPORT CVReturn CVPixelBufferCreateWithPlanarBytes(CFAllocatorRef allo
                                                              CVPixelBufferReleasePlanarBytesCallback releaseCallback,
                                                              void* releaseRefCon,
                                                              CFDictionaryRef pixelBufferAttributes,
-                                                             CVPixelBufferRef _Nullable* pixelBufferOut) STUB_METHOD;
-COREVIDEO_EXPORT CVReturn CVPixelBufferFillExtendedPixels(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT void* CVPixelBufferGetBaseAddress(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT void* CVPixelBufferGetBaseAddressOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetBytesPerRow(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetBytesPerRowOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetDataSize(CVPixelBufferRef pixelBuffer) STUB_METHOD;
+                                                             CVPixelBufferRef _Nullable* pixelBufferOut);
+COREVIDEO_EXPORT CVReturn CVPixelBufferFillExtendedPixels(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT void* CVPixelBufferGetBaseAddress(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT void* CVPixelBufferGetBaseAddressOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex);
+COREVIDEO_EXPORT size_t CVPixelBufferGetBytesPerRow(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT size_t CVPixelBufferGetBytesPerRowOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex);
+COREVIDEO_EXPORT size_t CVPixelBufferGetDataSize(CVPixelBufferRef pixelBuffer);
 COREVIDEO_EXPORT void CVPixelBufferGetExtendedPixels(CVPixelBufferRef pixelBuffer,
                                                      size_t* extraColumnsOnLeft,
                                                      size_t* extraColumnsOnRight,
                                                      size_t* extraRowsOnTop,
-                                                     size_t* extraRowsOnBottom) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetHeight(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetHeightOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) STUB_METHOD;
-COREVIDEO_EXPORT OSType CVPixelBufferGetPixelFormatType(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetPlaneCount(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT CFTypeID CVPixelBufferGetTypeID() STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetWidth(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT size_t CVPixelBufferGetWidthOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex) STUB_METHOD;
-COREVIDEO_EXPORT Boolean CVPixelBufferIsPlanar(CVPixelBufferRef pixelBuffer) STUB_METHOD;
-COREVIDEO_EXPORT CVReturn CVPixelBufferLockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags lockFlags) STUB_METHOD;
-COREVIDEO_EXPORT void CVPixelBufferRelease(CVPixelBufferRef texture) STUB_METHOD;
-COREVIDEO_EXPORT CVPixelBufferRef CVPixelBufferRetain(CVPixelBufferRef texture) STUB_METHOD;
-COREVIDEO_EXPORT CVReturn CVPixelBufferUnlockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags unlockFlags) STUB_METHOD;
+                                                     size_t* extraRowsOnBottom);
+COREVIDEO_EXPORT size_t CVPixelBufferGetHeight(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT size_t CVPixelBufferGetHeightOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex);
+COREVIDEO_EXPORT OSType CVPixelBufferGetPixelFormatType(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT size_t CVPixelBufferGetPlaneCount(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT CFTypeID CVPixelBufferGetTypeID();
+COREVIDEO_EXPORT size_t CVPixelBufferGetWidth(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT size_t CVPixelBufferGetWidthOfPlane(CVPixelBufferRef pixelBuffer, size_t planeIndex);
+COREVIDEO_EXPORT Boolean CVPixelBufferIsPlanar(CVPixelBufferRef pixelBuffer);
+COREVIDEO_EXPORT CVReturn CVPixelBufferLockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags lockFlags);
+COREVIDEO_EXPORT void CVPixelBufferRelease(CVPixelBufferRef texture);
+COREVIDEO_EXPORT CVPixelBufferRef CVPixelBufferRetain(CVPixelBufferRef texture);
+COREVIDEO_EXPORT CVReturn CVPixelBufferUnlockBaseAddress(CVPixelBufferRef pixelBuffer, CVPixelBufferLockFlags unlockFlags);
 
 COREVIDEO_EXPORT const CFStringRef kCVPixelBufferPixelFormatTypeKey;
 COREVIDEO_EXPORT const CFStringRef kCVPixelBufferMemoryAllocatorKey;
@@ -24,22 +24,27 @@
 
 typedef struct _CVPixelBufferPool* CVPixelBufferPoolRef;
 
+typedef CF_OPTIONS(CVOptionFlags, CVPixelBufferPoolFlushFlags) {
+    kCVPixelBufferPoolFlushExcessBuffers = 1,
+};
+
 COREVIDEO_EXPORT CVReturn CVPixelBufferPoolCreate(CFAllocatorRef allocator,
                                                   CFDictionaryRef poolAttributes,
                                                   CFDictionaryRef pixelBufferAttributes,
-                                                  CVPixelBufferPoolRef _Nullable* poolOut) STUB_METHOD;
+                                                  CVPixelBufferPoolRef _Nullable* poolOut);
 COREVIDEO_EXPORT CVReturn CVPixelBufferPoolCreatePixelBuffer(CFAllocatorRef allocator,
                                                              CVPixelBufferPoolRef pixelBufferPool,
-                                                             CVPixelBufferRef _Nullable* pixelBufferOut) STUB_METHOD;
+                                                             CVPixelBufferRef _Nullable* pixelBufferOut);
 COREVIDEO_EXPORT CVReturn CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(CFAllocatorRef allocator,
                                                                               CVPixelBufferPoolRef pixelBufferPool,
                                                                               CFDictionaryRef auxAttributes,
-                                                                              CVPixelBufferRef _Nullable* pixelBufferOut) STUB_METHOD;
-COREVIDEO_EXPORT CFDictionaryRef CVPixelBufferPoolGetAttributes(CVPixelBufferPoolRef pool) STUB_METHOD;
-COREVIDEO_EXPORT CFDictionaryRef CVPixelBufferPoolGetPixelBufferAttributes(CVPixelBufferPoolRef pool) STUB_METHOD;
-COREVIDEO_EXPORT CFTypeID CVPixelBufferPoolGetTypeID() STUB_METHOD;
-COREVIDEO_EXPORT void CVPixelBufferPoolRelease(CVPixelBufferPoolRef pixelBufferPool) STUB_METHOD;
-COREVIDEO_EXPORT CVPixelBufferPoolRef CVPixelBufferPoolRetain(CVPixelBufferPoolRef pixelBufferPool) STUB_METHOD;
+                                                                              CVPixelBufferRef _Nullable* pixelBufferOut);
+COREVIDEO_EXPORT void CVPixelBufferPoolFlush(CVPixelBufferPoolRef pool, CVPixelBufferPoolFlushFlags options);
+COREVIDEO_EXPORT CFDictionaryRef CVPixelBufferPoolGetAttributes(CVPixelBufferPoolRef pool);
+COREVIDEO_EXPORT CFDictionaryRef CVPixelBufferPoolGetPixelBufferAttributes(CVPixelBufferPoolRef pool);
+COREVIDEO_EXPORT CFTypeID CVPixelBufferPoolGetTypeID();
+COREVIDEO_EXPORT void CVPixelBufferPoolRelease(CVPixelBufferPoolRef pixelBufferPool);
+COREVIDEO_EXPORT CVPixelBufferPoolRef CVPixelBufferPoolRetain(CVPixelBufferPoolRef pixelBufferPool);
 COREVIDEO_EXPORT const CFStringRef kCVPixelBufferPoolMinimumBufferCountKey;
 COREVIDEO_EXPORT const CFStringRef kCVPixelBufferPoolMaximumBufferAgeKey;
 COREVIDEO_EXPORT const CFStringRef kCVPixelBufferPoolAllocationThresholdKey;
@@ -27,36 +27,36 @@
 
 FOUNDATION_EXPORT_CLASS
 @interface NSMutableOrderedSet <ObjectType> : NSOrderedSet <NSCopying, NSFastEnumeration, NSMutableCopying, NSSecureCoding>
-+ (instancetype)orderedSetWithCapacity:(NSUInteger)numItems STUB_METHOD;
-- (instancetype)initWithCapacity:(NSUInteger)numItems STUB_METHOD;
++ (instancetype)orderedSetWithCapacity:(NSUInteger)numItems;
+- (instancetype)initWithCapacity:(NSUInteger)numItems;
 - (instancetype)init;
 - (void)addObject:(ObjectType)object;
-- (void)addObjects:(const ObjectType _Nonnull[])objects count:(NSUInteger)count STUB_METHOD;
-- (void)addObjectsFromArray:(NSArray<ObjectType>*)array STUB_METHOD;
+- (void)addObjects:(const ObjectType _Nonnull[])objects count:(NSUInteger)count;
+- (void)addObjectsFromArray:(NSArray<ObjectType>*)array;
 - (void)insertObject:(ObjectType)object atIndex:(NSUInteger)idx;
-- (void)setObject:(ObjectType)object atIndexedSubscript:(NSUInteger)idx STUB_METHOD;
-- (void)insertObjects:(NSArray<ObjectType>*)objects atIndexes:(NSIndexSet*)indexes STUB_METHOD;
-- (void)removeObject:(ObjectType)object STUB_METHOD;
-- (void)removeObjectAtIndex:(NSUInteger)idx STUB_METHOD;
-- (void)removeObjectsAtIndexes:(NSIndexSet*)indexes STUB_METHOD;
-- (void)removeObjectsInArray:(NSArray<ObjectType>*)array STUB_METHOD;
-- (void)removeObjectsInRange:(NSRange)range STUB_METHOD;
-- (void)removeAllObjects STUB_METHOD;
-- (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(ObjectType)object STUB_METHOD;
-- (void)replaceObjectsAtIndexes:(NSIndexSet*)indexes withObjects:(NSArray<ObjectType>*)objects STUB_METHOD;
-- (void)replaceObjectsInRange:(NSRange)range withObjects:(const ObjectType _Nonnull[])objects count:(NSUInteger)count STUB_METHOD;
-- (void)setObject:(ObjectType)obj atIndex:(NSUInteger)idx STUB_METHOD;
-- (void)moveObjectsAtIndexes:(NSIndexSet*)indexes toIndex:(NSUInteger)idx STUB_METHOD;
-- (void)exchangeObjectAtIndex:(NSUInteger)idx1 withObjectAtIndex:(NSUInteger)idx2 STUB_METHOD;
-- (void)filterUsingPredicate:(NSPredicate*)predicate STUB_METHOD;
-- (void)sortUsingDescriptors:(NSArray<ObjectType>*)sortDescriptors STUB_METHOD;
-- (void)sortUsingComparator:(NSComparator)cmptr STUB_METHOD;
-- (void)sortWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr STUB_METHOD;
-- (void)sortRange:(NSRange)range options:(NSSortOptions)opts usingComparator:(NSComparator)cmptr STUB_METHOD;
-- (void)intersectOrderedSet:(NSOrderedSet<ObjectType>*)other STUB_METHOD;
-- (void)intersectSet:(NSSet<ObjectType>*)other STUB_METHOD;
-- (void)minusOrderedSet:(NSOrderedSet<ObjectType>*)other STUB_METHOD;
-- (void)minusSet:(NSSet<ObjectType>*)other STUB_METHOD;
-- (void)unionOrderedSet:(NSOrderedSet<ObjectType>*)other STUB_METHOD;
-- (void)unionSet:(NSSet<ObjectType>*)other STUB_METHOD;
+- (void)setObject:(ObjectType)object atIndexedSubscript:(NSUInteger)idx;
+- (void)insertObjects:(NSArray<ObjectType>*)objects atIndexes:(NSIndexSet*)indexes;
+- (void)removeObject:(ObjectType)object;
+- (void)removeObjectAtIndex:(NSUInteger)idx;
+- (void)removeObjectsAtIndexes:(NSIndexSet*)indexes;
+- (void)removeObjectsInArray:(NSArray<ObjectType>*)array;
+- (void)removeObjectsInRange:(NSRange)range;
+- (void)removeAllObjects;
+- (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(ObjectType)object;
+- (void)replaceObjectsAtIndexes:(NSIndexSet*)indexes withObjects:(NSArray<ObjectType>*)objects;
+- (void)replaceObjectsInRange:(NSRange)range withObjects:(const ObjectType _Nonnull[])objects count:(NSUInteger)count;
+- (void)setObject:(ObjectType)obj atIndex:(NSUInteger)idx;
+- (void)moveObjectsAtIndexes:(NSIndexSet*)indexes toIndex:(NSUInteger)idx;
+- (void)exchangeObjectAtIndex:(NSUInteger)idx1 withObjectAtIndex:(NSUInteger)idx2;
+- (void)filterUsingPredicate:(NSPredicate*)predicate;
+- (void)sortUsingDescriptors:(NSArray<ObjectType>*)sortDescriptors;
+- (void)sortUsingComparator:(NSComparator)cmptr;
+- (void)sortWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr;
+- (void)sortRange:(NSRange)range options:(NSSortOptions)opts usingComparator:(NSComparator)cmptr;
+- (void)intersectOrderedSet:(NSOrderedSet<ObjectType>*)other;
+- (void)intersectSet:(NSSet<ObjectType>*)other;
+- (void)minusOrderedSet:(NSOrderedSet<ObjectType>*)other;
+- (void)minusSet:(NSSet<ObjectType>*)other;
+- (void)unionOrderedSet:(NSOrderedSet<ObjectType>*)other;
+- (void)unionSet:(NSSet<ObjectType>*)other;
 @end
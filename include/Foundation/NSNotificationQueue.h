@@ -31,12 +31,12 @@ typedef enum { NSPostWhenIdle = 1, NSPostASAP = 2, NSPostNow = 3 } NSPostingStyl
 
 FOUNDATION_EXPORT_CLASS
 @interface NSNotificationQueue : NSObject
-- (instancetype)initWithNotificationCenter:(NSNotificationCenter*)notificationCenter STUB_METHOD;
+- (instancetype)initWithNotificationCenter:(NSNotificationCenter*)notificationCenter;
 + (NSNotificationQueue*)defaultQueue;
-- (void)enqueueNotification:(NSNotification*)notification postingStyle:(NSPostingStyle)postingStyle STUB_METHOD;
+- (void)enqueueNotification:(NSNotification*)notification postingStyle:(NSPostingStyle)postingStyle;
 - (void)enqueueNotification:(NSNotification*)notification
                postingStyle:(NSPostingStyle)postingStyle
                coalesceMask:(NSNotificationCoalescing)coalesceMask
-                   forModes:(NSArray*)modes STUB_METHOD;
-- (void)dequeueNotificationsMatching:(NSNotification*)notification coalesceMask:(NSUInteger)coalesceMask STUB_METHOD;
+                   forModes:(NSArray*)modes;
+- (void)dequeueNotificationsMatching:(NSNotification*)notification coalesceMask:(NSUInteger)coalesceMask;
 @end
@@ -70,24 +70,24 @@ FOUNDATION_EXPORT_CLASS
 - (NSUInteger)indexOfObject:(ObjectType)object
               inSortedRange:(NSRange)range
                     options:(NSBinarySearchingOptions)opts
-            usingComparator:(NSComparator)cmp STUB_METHOD;
+            usingComparator:(NSComparator)cmp;
 - (NSUInteger)indexOfObjectAtIndexes:(NSIndexSet*)indexSet
                              options:(NSEnumerationOptions)opts
-                         passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate STUB_METHOD;
-- (NSUInteger)indexOfObjectPassingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate STUB_METHOD;
+                         passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate;
+- (NSUInteger)indexOfObjectPassingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate;
 - (NSUInteger)indexOfObjectWithOptions:(NSEnumerationOptions)opts
-                           passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate STUB_METHOD;
+                           passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate;
 - (NSIndexSet*)indexesOfObjectsAtIndexes:(NSIndexSet*)indexSet
                                  options:(NSEnumerationOptions)opts
-                             passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate STUB_METHOD;
-- (NSIndexSet*)indexesOfObjectsPassingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate STUB_METHOD;
-- (NSIndexSet*)indexesOfObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id, NSUInteger, BOOL*))predicate STUB_METHOD;
+                             passingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate;
+- (NSIndexSet*)indexesOfObjectsPassingTest:(BOOL (^)(ObjectType, NSUInteger, BOOL*))predicate;
+- (NSIndexSet*)indexesOfObjectsWithOptions:(NSEnumerationOptions)opts passingTest:(BOOL (^)(id, NSUInteger, BOOL*))predicate;
 - (NSEnumerator<ObjectType>*)objectEnumerator;
 - (NSEnumerator<ObjectType>*)reverseObjectEnumerator;
-@property (readonly, copy) NSOrderedSet<ObjectType>* reversedOrderedSet STUB_PROPERTY;
+@property (readonly, copy) NSOrderedSet<ObjectType>* reversedOrderedSet;
 - (void)getObjects:(ObjectType __unsafe_unretained _Nonnull[])objects range:(NSRange)range;
-- (void)setValue:(id)value forKey:(NSString*)key STUB_METHOD;
-- (id)valueForKey:(NSString*)key STUB_METHOD;
+- (void)setValue:(id)value forKey:(NSString*)key;
+- (id)valueForKey:(NSString*)key;
 - (void)addObserver:(NSObject*)observer
          forKeyPath:(NSString*)keyPath
             options:(NSKeyValueObservingOptions)options
@@ -100,12 +100,12 @@ FOUNDATION_EXPORT_CLASS
 - (BOOL)isSubsetOfOrderedSet:(NSOrderedSet<ObjectType>*)other;
 - (BOOL)isSubsetOfSet:(NSSet<ObjectType>*)set;
 - (NSArray<ObjectType>*)sortedArrayUsingDescriptors:(NSArray<NSSortDescriptor*>*)sortDescriptors;
-- (NSArray<ObjectType>*)sortedArrayUsingComparator:(NSComparator)cmptr STUB_METHOD;
-- (NSArray<ObjectType>*)sortedArrayWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr STUB_METHOD;
-- (NSOrderedSet<ObjectType>*)filteredOrderedSetUsingPredicate:(NSPredicate*)predicate STUB_METHOD;
-@property (readonly, copy) NSString* description STUB_PROPERTY;
-- (NSString*)descriptionWithLocale:(id)locale STUB_METHOD;
-- (NSString*)descriptionWithLocale:(id)locale indent:(NSUInteger)level STUB_METHOD;
+- (NSArray<ObjectType>*)sortedArrayUsingComparator:(NSComparator)cmptr;
+- (NSArray<ObjectType>*)sortedArrayWithOptions:(NSSortOptions)opts usingComparator:(NSComparator)cmptr;
+- (NSOrderedSet<ObjectType>*)filteredOrderedSetUsingPredicate:(NSPredicate*)predicate;
+@property (readonly, copy) NSString* description;
+- (NSString*)descriptionWithLocale:(id)locale;
+- (NSString*)descriptionWithLocale:(id)locale indent:(NSUInteger)level;
 @property (readonly, strong) NSArray<ObjectType>* array;
 @property (readonly, strong) NSSet<ObjectType>* set;
 @end
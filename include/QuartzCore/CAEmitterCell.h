@@ -31,15 +31,15 @@ CA_EXPORT_CLASS
 @property CGRect contentsRect;
 @property (copy) NSArray* emitterCells;
 @property (getter=isEnabled) BOOL enabled;
-@property CGColorRef color STUB_PROPERTY;
+@property CGColorRef color;
 @property float redRange;
 @property float greenRange;
 @property float blueRange;
 @property float alphaRange;
-@property float redSpeed STUB_PROPERTY;
-@property float greenSpeed STUB_PROPERTY;
-@property float blueSpeed STUB_PROPERTY;
-@property float alphaSpeed STUB_PROPERTY;
+@property float redSpeed;
+@property float greenSpeed;
+@property float blueSpeed;
+@property float alphaSpeed;
 @property (copy) NSString* magnificationFilter STUB_PROPERTY;
 @property (copy) NSString* minificationFilter STUB_PROPERTY;
 @property float minificationFilterBias STUB_PROPERTY;
@@ -48,7 +48,7 @@ CA_EXPORT_CLASS
 @property (copy) NSString* name;
 @property (copy) NSDictionary* style STUB_PROPERTY;
 @property CGFloat spin;
-@property CGFloat spinRange STUB_PROPERTY;
+@property CGFloat spinRange;
 @property CGFloat emissionLatitude;
 @property CGFloat emissionLongitude;
 @property CGFloat emissionRange;
@@ -58,7 +58,7 @@ CA_EXPORT_CLASS
 @property CGFloat scaleSpeed;
 @property CGFloat velocity;
 @property CGFloat velocityRange;
-@property CGFloat xAcceleration STUB_PROPERTY;
+@property CGFloat xAcceleration;
 @property CGFloat yAcceleration;
 @property CGFloat zAcceleration STUB_PROPERTY;
 + (id)defaultValueForKey:(NSString*)key STUB_METHOD;
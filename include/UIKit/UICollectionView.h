@@ -25,6 +25,7 @@
 #import <UIKit/UICollectionViewUpdateItem.h>
 #import <UIKit/UICollectionViewLayoutAttributes.h>
 #import <UIKit/UIScrollView.h>
+#import <UIKit/UICollectionViewDataSourcePrefetching.h>
 
 @class UICollectionViewLayout, UICollectionViewLayoutAttributes, UICollectionViewController, UICollectionViewCell,
     UICollectionViewTransitionLayout;
@@ -107,8 +108,13 @@ startInteractiveTransitionToCollectionViewLayout:(UICollectionViewLayout*)layout
 @property (nonatomic) BOOL allowsSelection;
 @property (nonatomic) BOOL remembersLastFocusedIndexPath STUB_PROPERTY;
 @property (nonatomic, assign) IBOutlet id<UICollectionViewDataSource> dataSource;
+@property (nonatomic, assign) id<UICollectionViewDataSourcePrefetching> prefetchDataSource;
+@property (nonatomic, getter=isPrefetchingEnabled) BOOL prefetchingEnabled;
 @property (nonatomic, assign) IBOutlet id<UICollectionViewDelegate> delegate;
 @property (nonatomic, strong) UICollectionViewLayout* collectionViewLayout;
 @property (nonatomic, strong) UIView* backgroundView;
 
+// Microsoft Extension
+- (void)setMaximumReusableCellCount:(NSUInteger)count forReuseIdentifier:(NSString*)identifier;
+
 @end
@@ -1,6 +1,6 @@
 //******************************************************************************
 //
-// Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+// Copyright (c) Microsoft Corporation. All rights reserved.
 //
 // This code is licensed under the MIT License (MIT).
 //
@@ -13,16 +13,18 @@
 // THE SOFTWARE.
 //
 //******************************************************************************
+
 #pragma once
 
-#import <QuartzCore/CAEmitterCell.h>
+#import <UIKit/UIKitExport.h>
+#import <Foundation/Foundation.h>
+
+@class UICollectionView;
+@class NSArray;
+
+@protocol UICollectionViewDataSourcePrefetching <NSObject>
+- (void)collectionView:(UICollectionView*)collectionView prefetchItemsAtIndexPaths:(NSArray*)indexPaths;
 
-@interface CAEmitterCell () {
-}
-@property BOOL birthed;
-- (CALayer*)generateCALayerFromEmitterCell:(CGPoint)startingPosition
-                      withParentOffsetLong:(CGFloat)offsetLong
-                       withParentOffsetLat:(CGFloat)offsetLat
-                         withParentCALayer:(CALayer*)parent
-                       withBabyEmitterCell:(CAEmitterCell*)babyCell;
+@optional
+- (void)collectionView:(UICollectionView*)collectionView cancelPrefetchingForItemsAtIndexPaths:(NSArray*)indexPaths;
 @end
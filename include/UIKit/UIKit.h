@@ -88,6 +88,7 @@
 #import <UIKit/UICollectionViewCell.h>
 #import <UIKit/UICollectionViewController.h>
 #import <UIKit/UICollectionViewDataSource.h>
+#import <UIKit/UICollectionViewDataSourcePrefetching.h>
 #import <UIKit/UICollectionViewDelegate.h>
 #import <UIKit/UICollectionViewDelegateFlowLayout.h>
 #import <UIKit/UICollectionViewFlowLayout.h>
@@ -256,6 +257,7 @@
 #import <UIKit/UITableViewCell.h>
 #import <UIKit/UITableViewController.h>
 #import <UIKit/UITableViewDataSource.h>
+#import <UIKit/UITableViewDataSourcePrefetching.h>
 #import <UIKit/UITableViewDelegate.h>
 #import <UIKit/UITableViewFocusUpdateContext.h>
 #import <UIKit/UITableViewHeaderFooterView.h>
@@ -35,6 +35,7 @@
 #import <UIKit/NSIndexPath+UITableView.h>
 #import <UIKit/UITableViewDelegate.h>
 #import <UIKit/UITableViewDataSource.h>
+#import <UIKit/UITableViewDataSourcePrefetching.h>
 
 UIKIT_EXPORT NSString* const UITableViewIndexSearch;
 UIKIT_EXPORT const CGFloat UITableViewAutomaticDimension;
@@ -131,6 +132,7 @@ UIKIT_EXPORT_CLASS
 @property (nonatomic) UIEdgeInsets separatorInset;
 @property (nonatomic) UITableViewCellSeparatorStyle separatorStyle;
 @property (nonatomic, assign) id<UITableViewDataSource> dataSource;
+@property (nonatomic, assign) id<UITableViewDataSourcePrefetching> prefetchDataSource;
 @property (nonatomic, assign) id<UITableViewDelegate> delegate;
 @property (nonatomic, getter=isEditing) BOOL editing;
 @property (nonatomic, readonly) UITableViewStyle style;
@@ -146,4 +148,8 @@ UIKIT_EXPORT_CLASS
 @property (readonly, nonatomic) NSArray* visibleCells;
 @property (readonly, nonatomic) NSIndexPath* indexPathForSelectedRow;
 @property (readonly, nonatomic) NSInteger numberOfSections;
+
+// Microsoft Extension
+- (void)setMaximumReusableCellCount:(NSUInteger)count forReuseIdentifier:(NSString*)identifier;
+
 @end
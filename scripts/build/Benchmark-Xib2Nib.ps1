@@ -0,0 +1,83 @@
+<#
+    .SYNOPSIS
+    Times converting every XIB and storyboard under a source directory with xib2nib:
+    once with one xib2nib process per input (as builds did before batch mode), then
+    with batch mode from a cold cache, then again with a warm cache.
+#>
+param(
+    [string]$xib2nibExe = $(throw 'Mandatory parameter "xib2nibExe" is not set.'),
+    [string]$sourceDir = $(throw 'Mandatory parameter "sourceDir" is not set.'),
+    [string]$outputDir = $(throw 'Mandatory parameter "outputDir" is not set.'),
+    [int]$jobs = 0
+    )
+
+write-host $MyInvocation.Line
+$ErrorActionPreference = "Stop"
+
+$inputs = gci -recurse -include *.xib,*.storyboard $sourceDir
+if ($inputs.Count -eq 0)
+{
+    throw "No XIBs or storyboards found under $sourceDir"
+}
+
+function Reset-OutputDir
+{
+    if (Test-Path $outputDir)
+    {
+        Remove-Item $outputDir -Force -Recurse
+    }
+    New-Item -ItemType Directory $outputDir | Out-Null
+}
+
+function Get-OutputPath($source)
+{
+    $extension = if ($source.Extension -eq ".storyboard") { ".storyboardc" } else { ".nib" }
+    $relative = $source.FullName.Substring((Resolve-Path $sourceDir).Path.Length).TrimStart("\")
+    return Join-Path $outputDir ([IO.Path]::ChangeExtension($relative, $extension))
+}
+
+function Prepare-Outputs
+{
+    foreach ($source in $inputs)
+    {
+        New-Item -ItemType Directory -Force (Split-Path (Get-OutputPath $source)) | Out-Null
+    }
+}
+
+Reset-OutputDir
+Prepare-Outputs
+$serial = Measure-Command {
+    foreach ($source in $inputs)
+    {
+        & $xib2nibExe $source.FullName (Get-OutputPath $source) | Out-Null
+        if ($lastexitcode -ne 0)
+        {
+            throw "xib2nib failed on $($source.FullName) with error code: $lastexitcode"
+        }
+    }
+}
+
+Reset-OutputDir
+Prepare-Outputs
+$listFile = Join-Path $outputDir "xib2nib.batch"
+$cacheFile = Join-Path $outputDir "xib2nib.cache"
+$inputs | % { "$($_.FullName)`t$(Get-OutputPath $_)" } | Set-Content -Encoding Ascii $listFile
+
+$times = @{}
+foreach ($pass in "Cold", "Warm")
+{
+    $times[$pass] = Measure-Command {
+        & $xib2nibExe --batch $listFile --cache $cacheFile --jobs $jobs | write-host
+        if ($lastexitcode -ne 0)
+        {
+            throw "xib2nib --batch exited with error code: $lastexitcode"
+        }
+    }
+}
+
+write-host ("{0} inputs" -f $inputs.Count)
+write-host ("  one process per input: {0,8:N2}s" -f $serial.TotalSeconds)
+write-host ("  batch, cold cache:     {0,8:N2}s" -f $times["Cold"].TotalSeconds)
+write-host ("  batch, warm cache:     {0,8:N2}s" -f $times["Warm"].TotalSeconds)
+
+exit 0
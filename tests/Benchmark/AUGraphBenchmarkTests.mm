@@ -0,0 +1,132 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import <AudioUnit/AudioUnit.h>
+
+#import "Benchmark.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+// Ten seconds of 44.1kHz stereo per run, pulled from the output unit in 512 frame buffers.
+static const UInt32 sc_frameCount = 10 * 44100;
+static const UInt32 sc_bufferFrames = 512;
+
+// Copies a precomputed tone into the mixer's input.
+static OSStatus _toneSource(void* inRefCon,
+                            AudioUnitRenderActionFlags* ioActionFlags,
+                            const AudioTimeStamp* inTimeStamp,
+                            UInt32 inBusNumber,
+                            UInt32 inNumberFrames,
+                            AudioBufferList* ioData) {
+    const std::vector<float>& tone = *static_cast<std::vector<float>*>(inRefCon);
+    for (UInt32 channel = 0; channel < ioData->mNumberBuffers; ++channel) {
+        memcpy(ioData->mBuffers[channel].mData, tone.data(), inNumberFrames * sizeof(float));
+    }
+    return noErr;
+}
+
+class AUGraphMixerBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    AUGraphMixerBase(UInt32 sources)
+        : _tone(sc_bufferFrames),
+          _list(new uint8_t[offsetof(AudioBufferList, mBuffers) + 2 * sizeof(AudioBuffer)]),
+          _samples(2 * sc_bufferFrames) {
+        for (UInt32 i = 0; i < sc_bufferFrames; ++i) {
+            _tone[i] = static_cast<float>(0.1 * sin(i * 0.05));
+        }
+
+        AudioComponentDescription mixerDescription = {
+            kAudioUnitType_Mixer, kAudioUnitSubType_MultiChannelMixer, kAudioUnitManufacturer_Apple, 0, 0
+        };
+        AudioComponentDescription outputDescription = {
+            kAudioUnitType_Output, kAudioUnitSubType_GenericOutput, kAudioUnitManufacturer_Apple, 0, 0
+        };
+
+        AUNode mixerNode, outputNode;
+        AudioUnit mixer;
+        NewAUGraph(&_graph);
+        AUGraphAddNode(_graph, &mixerDescription, &mixerNode);
+        AUGraphAddNode(_graph, &outputDescription, &outputNode);
+        AUGraphOpen(_graph);
+        AUGraphNodeInfo(_graph, mixerNode, nullptr, &mixer);
+        AUGraphNodeInfo(_graph, outputNode, nullptr, &_output);
+        AudioUnitSetProperty(mixer, kAudioUnitProperty_ElementCount, kAudioUnitScope_Input, 0, &sources, sizeof(sources));
+        AUGraphConnectNodeInput(_graph, mixerNode, 0, outputNode, 0);
+
+        for (UInt32 bus = 0; bus < sources; ++bus) {
+            AURenderCallbackStruct callback = { _toneSource, &_tone };
+            AUGraphSetNodeInputCallback(_graph, mixerNode, bus, &callback);
+            AudioUnitSetParameter(mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Input, bus, (bus % 3) * 0.5f - 0.5f, 0);
+        }
+        AUGraphInitialize(_graph);
+
+        AudioBufferList* list = reinterpret_cast<AudioBufferList*>(_list.get());
+        list->mNumberBuffers = 2;
+        for (UInt32 channel = 0; channel < 2; ++channel) {
+            list->mBuffers[channel].mNumberChannels = 1;
+            list->mBuffers[channel].mDataByteSize = sc_bufferFrames * sizeof(float);
+            list->mBuffers[channel].mData = &_samples[channel * sc_bufferFrames];
+        }
+    }
+
+    ~AUGraphMixerBase() {
+        DisposeAUGraph(_graph);
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    inline void Run() {
+        AudioBufferList* list = reinterpret_cast<AudioBufferList*>(_list.get());
+        AudioTimeStamp timeStamp = {};
+        timeStamp.mFlags = kAudioTimeStampSampleTimeValid;
+        for (UInt32 frame = 0; frame + sc_bufferFrames <= sc_frameCount; frame += sc_bufferFrames) {
+            AudioUnitRenderActionFlags flags = 0;
+            timeStamp.mSampleTime = frame;
+            AudioUnitRender(_output, &flags, &timeStamp, 0, sc_bufferFrames, list);
+        }
+    }
+
+private:
+    AUGraph _graph;
+    AudioUnit _output;
+    std::vector<float> _tone;
+    std::unique_ptr<uint8_t[]> _list;
+    std::vector<float> _samples;
+};
+
+class MixTwoSources : public AUGraphMixerBase {
+public:
+    MixTwoSources() : AUGraphMixerBase(2) {
+    }
+};
+
+BENCHMARK_F(AUGraph, MixTwoSources);
+
+class MixSixteenSources : public AUGraphMixerBase {
+public:
+    MixSixteenSources() : AUGraphMixerBase(16) {
+    }
+};
+
+BENCHMARK_F(AUGraph, MixSixteenSources);
@@ -0,0 +1,139 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioConverter.h>
+
+#import "Benchmark.h"
+
+#include <math.h>
+#include <vector>
+
+static AudioStreamBasicDescription _format(double sampleRate, UInt32 channels, bool isFloat) {
+    AudioStreamBasicDescription format = {};
+    format.mSampleRate = sampleRate;
+    format.mFormatID = kAudioFormatLinearPCM;
+    format.mFormatFlags = (isFloat ? kAudioFormatFlagIsFloat : kAudioFormatFlagIsSignedInteger) | kAudioFormatFlagIsPacked;
+    format.mFramesPerPacket = 1;
+    format.mChannelsPerFrame = channels;
+    format.mBitsPerChannel = isFloat ? 32 : 16;
+    format.mBytesPerFrame = channels * format.mBitsPerChannel / 8;
+    format.mBytesPerPacket = format.mBytesPerFrame;
+    return format;
+}
+
+// Ten seconds of 44.1kHz audio per run, pushed through AudioConverterConvertBuffer in 4096 frame buffers.
+static const UInt32 sc_frameCount = 10 * 44100;
+static const UInt32 sc_bufferFrames = 4096;
+
+class AudioConverterBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    AudioConverterBase(const AudioStreamBasicDescription& source,
+                       const AudioStreamBasicDescription& destination,
+                       UInt32 quality = kAudioConverterQuality_Medium)
+        : _source(source), _input(sc_frameCount * source.mBytesPerFrame) {
+        AudioConverterNew(&source, &destination, &_converter);
+        AudioConverterSetProperty(_converter, kAudioConverterSampleRateConverterQuality, sizeof(quality), &quality);
+
+        UInt32 outputSize = sc_bufferFrames * source.mBytesPerFrame;
+        UInt32 propertySize = sizeof(outputSize);
+        AudioConverterGetProperty(_converter, kAudioConverterPropertyCalculateOutputBufferSize, &propertySize, &outputSize);
+        _output.resize(outputSize);
+
+        for (size_t i = 0; i < _input.size(); ++i) {
+            _input[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+        }
+
+        // Keep float input in range so clipping does not decide the timing.
+        if (source.mFormatFlags & kAudioFormatFlagIsFloat) {
+            float* samples = reinterpret_cast<float*>(_input.data());
+            for (size_t i = 0; i < _input.size() / sizeof(float); ++i) {
+                samples[i] = static_cast<float>(0.5 * sin(i * 0.01));
+            }
+        }
+    }
+
+    ~AudioConverterBase() {
+        AudioConverterDispose(_converter);
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    inline void Run() {
+        UInt32 bufferSize = sc_bufferFrames * _source.mBytesPerFrame;
+        for (size_t offset = 0; offset + bufferSize <= _input.size(); offset += bufferSize) {
+            UInt32 outputSize = _output.size();
+            AudioConverterConvertBuffer(_converter, bufferSize, _input.data() + offset, &outputSize, _output.data());
+        }
+    }
+
+private:
+    AudioStreamBasicDescription _source;
+    AudioConverterRef _converter;
+    std::vector<uint8_t> _input;
+    std::vector<uint8_t> _output;
+};
+
+class Int16ToFloatStereo : public AudioConverterBase {
+public:
+    Int16ToFloatStereo() : AudioConverterBase(_format(44100, 2, false), _format(44100, 2, true)) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, Int16ToFloatStereo);
+
+class FloatToInt16Stereo : public AudioConverterBase {
+public:
+    FloatToInt16Stereo() : AudioConverterBase(_format(44100, 2, true), _format(44100, 2, false)) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, FloatToInt16Stereo);
+
+class DownmixStereoToMono : public AudioConverterBase {
+public:
+    DownmixStereoToMono() : AudioConverterBase(_format(44100, 2, false), _format(44100, 1, false)) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, DownmixStereoToMono);
+
+class Resample44100To48000Medium : public AudioConverterBase {
+public:
+    Resample44100To48000Medium() : AudioConverterBase(_format(44100, 2, false), _format(48000, 2, true)) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, Resample44100To48000Medium);
+
+class Resample44100To48000High : public AudioConverterBase {
+public:
+    Resample44100To48000High()
+        : AudioConverterBase(_format(44100, 2, false), _format(48000, 2, true), kAudioConverterQuality_High) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, Resample44100To48000High);
+
+class Resample44100To16000Mono : public AudioConverterBase {
+public:
+    Resample44100To16000Mono() : AudioConverterBase(_format(44100, 1, true), _format(16000, 1, false)) {
+    }
+};
+
+BENCHMARK_F(AudioConverter, Resample44100To16000Mono);
@@ -0,0 +1,151 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioFile.h>
+#import <AudioToolbox/ExtendedAudioFile.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+#include <vector>
+
+static void _appendBigEndian(NSMutableData* data, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        uint8_t byte = static_cast<uint8_t>(value >> (8 * i));
+        [data appendBytes:&byte length:1];
+    }
+}
+
+// Ten minutes of mono 16-bit linear PCM in a CAF file, long enough that loading it whole dominates opening it.
+static const uint32_t sc_sampleRate = 22050;
+static const uint32_t sc_frameCount = 10 * 60 * sc_sampleRate;
+
+static NSString* _writeLongCAF() {
+    NSMutableData* data = [NSMutableData data];
+    [data appendBytes:"caff" length:4];
+    _appendBigEndian(data, 1, 2);
+    _appendBigEndian(data, 0, 2);
+
+    double sampleRate = sc_sampleRate;
+    uint64_t sampleRateBits;
+    memcpy(&sampleRateBits, &sampleRate, sizeof(sampleRateBits));
+    [data appendBytes:"desc" length:4];
+    _appendBigEndian(data, 32, 8);
+    _appendBigEndian(data, sampleRateBits, 8);
+    _appendBigEndian(data, 'lpcm', 4);
+    _appendBigEndian(data, 0, 4);
+    _appendBigEndian(data, 2, 4);
+    _appendBigEndian(data, 1, 4);
+    _appendBigEndian(data, 1, 4);
+    _appendBigEndian(data, 16, 4);
+
+    [data appendBytes:"data" length:4];
+    _appendBigEndian(data, sc_frameCount * 2 + 4, 8);
+    _appendBigEndian(data, 0, 4);
+    std::vector<uint8_t> samples(sc_frameCount * 2);
+    for (uint32_t i = 0; i < sc_frameCount; ++i) {
+        samples[2 * i] = static_cast<uint8_t>(i >> 3);
+        samples[2 * i + 1] = static_cast<uint8_t>(i * 7);
+    }
+    [data appendBytes:samples.data() length:samples.size()];
+
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"AudioFileBenchmark.caf"];
+    [data writeToFile:path atomically:NO];
+    return path;
+}
+
+class LongAudioFileBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    LongAudioFileBase() : _path(_writeLongCAF()), _samples(4096) {
+        _url = [NSURL fileURLWithPath:_path];
+    }
+
+    ~LongAudioFileBase() {
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+protected:
+    UInt32 _read(ExtAudioFileRef file, UInt32 frames) {
+        AudioBufferList buffers;
+        buffers.mNumberBuffers = 1;
+        buffers.mBuffers[0].mNumberChannels = 1;
+        buffers.mBuffers[0].mDataByteSize = frames * sizeof(int16_t);
+        buffers.mBuffers[0].mData = _samples.data();
+        ExtAudioFileRead(file, &frames, &buffers);
+        return frames;
+    }
+
+    StrongId<NSString> _path;
+    StrongId<NSURL> _url;
+    std::vector<int16_t> _samples;
+};
+
+// Opening the file and reading its first samples, which no longer waits for the whole file to be read and decoded.
+class TimeToFirstSample : public LongAudioFileBase {
+public:
+    inline void Run() {
+        ExtAudioFileRef file = nullptr;
+        ExtAudioFileOpenURL((__bridge CFURLRef)(NSURL*)_url, &file);
+        _read(file, 4096);
+        ExtAudioFileDispose(file);
+    }
+};
+
+BENCHMARK_F(AudioFile, TimeToFirstSample);
+
+// Reading a few packets at a time from positions spread through the file.
+class ReadPacketDataScattered : public LongAudioFileBase {
+public:
+    ReadPacketDataScattered() {
+        AudioFileOpenURL((__bridge CFURLRef)(NSURL*)_url, kAudioFileReadPermission, 0, &_file);
+    }
+
+    ~ReadPacketDataScattered() {
+        AudioFileClose(_file);
+    }
+
+    inline void Run() {
+        for (uint32_t i = 0; i < 100; ++i) {
+            UInt32 bytes = _samples.size() * sizeof(int16_t);
+            UInt32 packets = 1024;
+            AudioFileReadPacketData(_file, false, &bytes, nullptr, (i * 7919 * 1024) % sc_frameCount, &packets, _samples.data());
+        }
+    }
+
+private:
+    AudioFileID _file;
+};
+
+BENCHMARK_F(AudioFile, ReadPacketDataScattered);
+
+// Streaming the whole file through the decode-ahead buffer.
+class StreamWholeFile : public LongAudioFileBase {
+public:
+    inline void Run() {
+        ExtAudioFileRef file = nullptr;
+        ExtAudioFileOpenURL((__bridge CFURLRef)(NSURL*)_url, &file);
+        while (_read(file, 4096) > 0) {
+        }
+        ExtAudioFileDispose(file);
+    }
+};
+
+BENCHMARK_F(AudioFile, StreamWholeFile);
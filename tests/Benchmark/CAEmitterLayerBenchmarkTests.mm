@@ -0,0 +1,78 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <QuartzCore/QuartzCore.h>
+#import <Starboard/SmartTypes.h>
+#import <CppUtils.h>
+
+#import "Benchmark.h"
+#import "HeadlessCompositor.h"
+#import "CAEmitterLayerInternal.h"
+
+static const size_t sc_framesPerRun = 60;
+static const float sc_frameInterval = 1.0f / 60.0f;
+
+// Headless emitter with about 100k live particles: two cells, each emitting 25k particles a second that live two seconds,
+// from a rectangle, with gravity, spin, scale and fade.
+class EmitterStep100k : public ::benchmark::BenchmarkCaseBase {
+public:
+    EmitterStep100k() {
+        static HeadlessCompositor s_compositor;
+        SetCACompositor(&s_compositor);
+
+        _layer = [CAEmitterLayer layer];
+        [_layer setEmitterPosition:CGPointMake(512, 384)];
+        [_layer setEmitterSize:CGSizeMake(800, 20)];
+        [_layer setEmitterShape:kCAEmitterLayerRectangle];
+
+        NSMutableArray* cells = [NSMutableArray array];
+        for (size_t i = 0; i < 2; ++i) {
+            CAEmitterCell* cell = [CAEmitterCell emitterCell];
+            cell.birthRate = 25000.0f;
+            cell.lifetime = 2.0f;
+            cell.velocity = 120.0f;
+            cell.velocityRange = 40.0f;
+            cell.emissionRange = static_cast<CGFloat>(M_PI);
+            cell.yAcceleration = 98.0f;
+            cell.spin = 1.0f;
+            cell.spinRange = 0.5f;
+            cell.scaleSpeed = -0.2f;
+            cell.alphaSpeed = -0.4f;
+            [cells addObject:cell];
+        }
+        [_layer setEmitterCells:cells];
+
+        // Warm up to the steady-state population.
+        for (size_t frame = 0; frame < 2 * sc_framesPerRun + 1; ++frame) {
+            [_layer _advanceParticles:sc_frameInterval];
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            [_layer _advanceParticles:sc_frameInterval];
+        }
+    }
+
+private:
+    StrongId<CAEmitterLayer> _layer;
+};
+
+BENCHMARK_F(CAEmitterLayer, EmitterStep100k);
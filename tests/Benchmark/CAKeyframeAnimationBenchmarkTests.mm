@@ -0,0 +1,104 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <QuartzCore/QuartzCore.h>
+#import <Starboard/SmartTypes.h>
+#import <CppUtils.h>
+
+#import "Benchmark.h"
+#import "CAKeyframeAnimationInternal.h"
+
+#include <vector>
+
+static const size_t sc_animationCount = 5000;
+static const size_t sc_framesPerRun = 60;
+
+// 5k concurrently running position animations with eight keyframes each, cycling through the calculation modes.
+class KeyframeAnimationBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    KeyframeAnimationBase() : _progress(sc_animationCount) {
+        NSArray* modes = @[ kCAAnimationLinear, kCAAnimationDiscrete, kCAAnimationPaced, kCAAnimationCubic, kCAAnimationCubicPaced ];
+
+        _animations.attach([NSMutableArray new]);
+        for (size_t i = 0; i < sc_animationCount; ++i) {
+            NSMutableArray* values = [NSMutableArray array];
+            for (size_t key = 0; key < 8; ++key) {
+                [values addObject:[NSValue valueWithCGPoint:CGPointMake(key * 40.0f, ((key + i) % 3) * 25.0f)]];
+            }
+
+            CAKeyframeAnimation* animation = [CAKeyframeAnimation animationWithKeyPath:@"position"];
+            animation.values = values;
+            animation.calculationMode = modes[i % modes.count];
+            animation.timingFunctions = @[ [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseInEaseOut] ];
+
+            [_animations addObject:animation];
+            _rawAnimations.push_back(animation);
+            _progress[i] = static_cast<float>(i) / sc_animationCount;
+        }
+
+        _results.resize(sc_animationCount * _CAKeyframeAnimationGetComponentCount(_rawAnimations[0]));
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+protected:
+    void _AdvanceFrame() {
+        for (float& progress : _progress) {
+            progress += 1.0f / sc_framesPerRun;
+            if (progress > 1.0f) {
+                progress -= 1.0f;
+            }
+        }
+    }
+
+    StrongId<NSMutableArray> _animations;
+    std::vector<CAKeyframeAnimation*> _rawAnimations;
+    std::vector<float> _progress;
+    std::vector<float> _results;
+};
+
+// Boxes every interpolated value, as a per-animation object API would.
+class KeyframeValuePerAnimation : public KeyframeAnimationBase {
+public:
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            _AdvanceFrame();
+            @autoreleasepool {
+                for (size_t i = 0; i < sc_animationCount; ++i) {
+                    CGPoint point = [[_rawAnimations[i] _valueForProgress:_progress[i]] CGPointValue];
+                    _results[i * 2] = point.x;
+                    _results[i * 2 + 1] = point.y;
+                }
+            }
+        }
+    }
+};
+
+BENCHMARK_F(CAKeyframeAnimation, KeyframeValuePerAnimation);
+
+class KeyframeEvaluateBatched : public KeyframeAnimationBase {
+public:
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            _AdvanceFrame();
+            _CAKeyframeAnimationEvaluateBatch(_rawAnimations.data(), _progress.data(), _results.data(), 2, sc_animationCount);
+        }
+    }
+};
+
+BENCHMARK_F(CAKeyframeAnimation, KeyframeEvaluateBatched);
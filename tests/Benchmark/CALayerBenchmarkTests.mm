@@ -0,0 +1,109 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <QuartzCore/QuartzCore.h>
+#import <UIKit/UIKit.h>
+#import <Starboard/SmartTypes.h>
+#import <CppUtils.h>
+
+#import "Benchmark.h"
+#import "HeadlessCompositor.h"
+
+#include <vector>
+
+static constexpr CGFloat sc_layerSize = 1024.0f;
+static constexpr CGFloat sc_barHeight = 16.0f;
+static constexpr size_t sc_framesPerRun = 60;
+
+// A large layer with a small progress bar that advances every frame, like a progress indicator on a full-screen view.
+@interface ProgressBarLayer : CALayer
+@property (nonatomic) CGFloat progress;
+@end
+
+@implementation ProgressBarLayer
+- (void)drawInContext:(CGContextRef)ctx {
+    CGContextSetRGBFillColor(ctx, 0.2f, 0.4f, 0.8f, 1.0f);
+    CGContextFillRect(ctx, CGRectMake(0, 0, self.bounds.size.width * self.progress, sc_barHeight));
+}
+@end
+
+class CALayerDisplayBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    CALayerDisplayBase() {
+        static HeadlessCompositor s_compositor;
+        SetCACompositor(&s_compositor);
+
+        _layer.attach([ProgressBarLayer new]);
+        [_layer setBounds:CGRectMake(0, 0, sc_layerSize, sc_layerSize)];
+        [_layer displayIfNeeded];
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+protected:
+    void _AdvanceProgress(size_t frame) {
+        [_layer setProgress:(frame + 1) / static_cast<CGFloat>(sc_framesPerRun)];
+    }
+
+    StrongId<ProgressBarLayer> _layer;
+};
+
+// Baseline: every frame invalidates and redraws the whole layer.
+class CALayerFullRedraw : public CALayerDisplayBase {
+public:
+    inline void Run() {
+        for (size_t i = 0; i < sc_framesPerRun; ++i) {
+            _AdvanceProgress(i);
+            [_layer setNeedsDisplay];
+            [_layer displayIfNeeded];
+        }
+    }
+};
+
+BENCHMARK_F(CALayer, CALayerFullRedraw);
+
+// Every frame only invalidates the sliver of the bar that changed; the rest of the backing store is preserved.
+class CALayerPartialRedraw : public CALayerDisplayBase {
+public:
+    inline void Run() {
+        CGFloat step = sc_layerSize / sc_framesPerRun;
+        for (size_t i = 0; i < sc_framesPerRun; ++i) {
+            _AdvanceProgress(i);
+            [_layer setNeedsDisplayInRect:CGRectMake(i * step, 0, step, sc_barHeight)];
+            [_layer displayIfNeeded];
+        }
+    }
+};
+
+BENCHMARK_F(CALayer, CALayerPartialRedraw);
+
+// Many short-lived layers of the same size, as in a scrolling list; backing stores come from the shared pool.
+class CALayerChurn : public CALayerDisplayBase {
+public:
+    inline void Run() {
+        for (size_t i = 0; i < sc_framesPerRun; ++i) {
+            StrongId<ProgressBarLayer> layer;
+            layer.attach([ProgressBarLayer new]);
+            [layer setBounds:CGRectMake(0, 0, 320.0f, 44.0f)];
+            [layer setProgress:0.5f];
+            [layer displayIfNeeded];
+        }
+    }
+};
+
+BENCHMARK_F(CALayer, CALayerChurn);
@@ -0,0 +1,94 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <QuartzCore/QuartzCore.h>
+#import <Starboard/SmartTypes.h>
+#import <CppUtils.h>
+
+#import "Benchmark.h"
+#import "CAMediaTimingFunctionInternal.h"
+
+#include <vector>
+
+static const size_t sc_animationCount = 10000;
+static const size_t sc_framesPerRun = 60;
+
+// 10k concurrently running animations, spread over the named timing functions, each at a different point in its timeline.
+class TimingFunctionBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    TimingFunctionBase() : _progress(sc_animationCount), _results(sc_animationCount) {
+        NSArray* names = @[
+            kCAMediaTimingFunctionLinear,
+            kCAMediaTimingFunctionEaseIn,
+            kCAMediaTimingFunctionEaseOut,
+            kCAMediaTimingFunctionEaseInEaseOut,
+            kCAMediaTimingFunctionDefault
+        ];
+
+        _functions.attach([NSMutableArray new]);
+        for (size_t i = 0; i < sc_animationCount; ++i) {
+            CAMediaTimingFunction* function = [CAMediaTimingFunction functionWithName:names[i % names.count]];
+            [_functions addObject:function];
+            _rawFunctions.push_back(function);
+            _progress[i] = static_cast<float>(i) / sc_animationCount;
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 50;
+    }
+
+protected:
+    void _AdvanceFrame() {
+        for (float& progress : _progress) {
+            progress += 1.0f / sc_framesPerRun;
+            if (progress > 1.0f) {
+                progress -= 1.0f;
+            }
+        }
+    }
+
+    StrongId<NSMutableArray> _functions;
+    std::vector<CAMediaTimingFunction*> _rawFunctions;
+    std::vector<float> _progress;
+    std::vector<float> _results;
+};
+
+class EvaluatePerAnimation : public TimingFunctionBase {
+public:
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            _AdvanceFrame();
+            for (size_t i = 0; i < sc_animationCount; ++i) {
+                _results[i] = applyMediaTimingFunction(_rawFunctions[i], _progress[i]);
+            }
+        }
+    }
+};
+
+BENCHMARK_F(CAMediaTimingFunction, EvaluatePerAnimation);
+
+class EvaluateBatched : public TimingFunctionBase {
+public:
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            _AdvanceFrame();
+            _CAMediaTimingFunctionEvaluateBatch(_rawFunctions.data(), _progress.data(), _results.data(), sc_animationCount);
+        }
+    }
+};
+
+BENCHMARK_F(CAMediaTimingFunction, EvaluateBatched);
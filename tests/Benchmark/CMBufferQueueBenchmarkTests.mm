@@ -0,0 +1,163 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <CoreMedia/CoreMedia.h>
+
+#import "Benchmark.h"
+
+#include <thread>
+
+// Each run pushes 20000 transport-sized packets through five stages on their own threads, connected by four bounded
+// queues: a demuxer, a depacketizer that strips each packet's header, an assembler that joins four payloads into a frame,
+// an inspector that reads each frame's leading bytes, and a sink.
+static const size_t sc_packetCount = 20000;
+static const size_t sc_packetSize = 1316;
+static const size_t sc_headerSize = 12;
+static const size_t sc_packetsPerFrame = 4;
+static const CMItemCount sc_queueCapacity = 64;
+
+static void _enqueue(CMBufferQueueRef queue, CMBlockBufferRef buffer) {
+    while (CMBufferQueueEnqueue(queue, buffer) == kCMBufferQueueError_QueueIsFull) {
+        std::this_thread::yield();
+    }
+    CFRelease(buffer);
+}
+
+// Returns nullptr once the upstream stage has finished and the queue is drained.
+static CMBlockBufferRef _dequeue(CMBufferQueueRef queue) {
+    for (;;) {
+        CMBufferRef buffer = CMBufferQueueDequeueAndRetain(queue);
+        if (buffer) {
+            return static_cast<CMBlockBufferRef>(const_cast<void*>(buffer));
+        }
+        if (CMBufferQueueIsAtEndOfData(queue)) {
+            return nullptr;
+        }
+        std::this_thread::yield();
+    }
+}
+
+class CMBufferQueuePipelineBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    // flags are passed to every stage that references upstream data; kCMBlockBufferAlwaysCopyDataFlag copies it instead.
+    CMBufferQueuePipelineBase(CMBlockBufferFlags flags) : _flags(flags) {
+        CMBufferCallbacks callbacks = {};
+        for (CMBufferQueueRef& queue : _queues) {
+            CMBufferQueueCreate(nullptr, sc_queueCapacity, &callbacks, &queue);
+        }
+    }
+
+    ~CMBufferQueuePipelineBase() {
+        for (CMBufferQueueRef queue : _queues) {
+            CFRelease(queue);
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    inline void Run() {
+        for (CMBufferQueueRef queue : _queues) {
+            CMBufferQueueReset(queue);
+        }
+
+        std::thread demuxer([this]() {
+            for (size_t index = 0; index < sc_packetCount; ++index) {
+                CMBlockBufferRef packet = nullptr;
+                CMBlockBufferCreateWithMemoryBlock(
+                    nullptr, nullptr, sc_packetSize, nullptr, nullptr, 0, sc_packetSize, kCMBlockBufferAssureMemoryNowFlag, &packet);
+                CMBlockBufferFillDataBytes(static_cast<char>(index), packet, 0, sc_packetSize);
+                _enqueue(_queues[0], packet);
+            }
+            CMBufferQueueMarkEndOfData(_queues[0]);
+        });
+
+        std::thread depacketizer([this]() {
+            while (CMBlockBufferRef packet = _dequeue(_queues[0])) {
+                CMBlockBufferRef payload = nullptr;
+                CMBlockBufferCreateWithBufferReference(nullptr, packet, sc_headerSize, sc_packetSize - sc_headerSize, _flags, &payload);
+                CFRelease(packet);
+                _enqueue(_queues[1], payload);
+            }
+            CMBufferQueueMarkEndOfData(_queues[1]);
+        });
+
+        std::thread assembler([this]() {
+            CMBlockBufferRef frame = nullptr;
+            size_t payloads = 0;
+            while (CMBlockBufferRef payload = _dequeue(_queues[1])) {
+                if (!frame) {
+                    CMBlockBufferCreateEmpty(nullptr, sc_packetsPerFrame, 0, &frame);
+                }
+                CMBlockBufferAppendBufferReference(frame, payload, 0, CMBlockBufferGetDataLength(payload), _flags);
+                CFRelease(payload);
+                if (++payloads % sc_packetsPerFrame == 0) {
+                    _enqueue(_queues[2], frame);
+                    frame = nullptr;
+                }
+            }
+            if (frame) {
+                _enqueue(_queues[2], frame);
+            }
+            CMBufferQueueMarkEndOfData(_queues[2]);
+        });
+
+        std::thread inspector([this]() {
+            char header[16];
+            while (CMBlockBufferRef frame = _dequeue(_queues[2])) {
+                char* pointer = nullptr;
+                CMBlockBufferAccessDataBytes(frame, 0, sizeof(header), header, &pointer);
+                _checksum += static_cast<unsigned char>(pointer[0]);
+                _enqueue(_queues[3], frame);
+            }
+            CMBufferQueueMarkEndOfData(_queues[3]);
+        });
+
+        while (CMBlockBufferRef frame = _dequeue(_queues[3])) {
+            _bytes += CMBlockBufferGetDataLength(frame);
+            CFRelease(frame);
+        }
+
+        demuxer.join();
+        depacketizer.join();
+        assembler.join();
+        inspector.join();
+    }
+
+private:
+    CMBlockBufferFlags _flags;
+    CMBufferQueueRef _queues[4];
+    size_t _checksum = 0;
+    size_t _bytes = 0;
+};
+
+class PipelineByReference : public CMBufferQueuePipelineBase {
+public:
+    PipelineByReference() : CMBufferQueuePipelineBase(0) {
+    }
+};
+
+BENCHMARK_F(CMBufferQueue, PipelineByReference);
+
+class PipelineCopyingPackets : public CMBufferQueuePipelineBase {
+public:
+    PipelineCopyingPackets() : CMBufferQueuePipelineBase(kCMBlockBufferAlwaysCopyDataFlag) {
+    }
+};
+
+BENCHMARK_F(CMBufferQueue, PipelineCopyingPackets);
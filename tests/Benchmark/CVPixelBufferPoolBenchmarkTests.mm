@@ -0,0 +1,138 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <CoreVideo/CoreVideo.h>
+
+#import "Benchmark.h"
+
+#include <stdint.h>
+
+// One second of 4K video at 60 fps per run. Like a decoder feeding a display, three frames are in flight at any time, and
+// each frame writes to every row of every plane so that freshly allocated pages are actually faulted in.
+static const int sc_width = 3840;
+static const int sc_height = 2160;
+static const size_t sc_frameCount = 60;
+static const size_t sc_framesInFlight = 3;
+
+class CVPixelBufferAllocationBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    CVPixelBufferAllocationBase(OSType pixelFormat, bool pooled) : _pixelFormat(pixelFormat), _pool(nullptr), _frames() {
+        if (!pooled) {
+            return;
+        }
+
+        CFMutableDictionaryRef attributes =
+            CFDictionaryCreateMutable(nullptr, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        _setNumber(attributes, kCVPixelBufferWidthKey, sc_width);
+        _setNumber(attributes, kCVPixelBufferHeightKey, sc_height);
+        _setNumber(attributes, kCVPixelBufferPixelFormatTypeKey, static_cast<int>(pixelFormat));
+        CVPixelBufferPoolCreate(nullptr, nullptr, attributes, &_pool);
+        CFRelease(attributes);
+    }
+
+    ~CVPixelBufferAllocationBase() {
+        CVPixelBufferPoolRelease(_pool);
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_frameCount; ++frame) {
+            CVPixelBufferRef& slot = _frames[frame % sc_framesInFlight];
+            CVPixelBufferRelease(slot);
+            slot = nullptr;
+
+            if (_pool) {
+                CVPixelBufferPoolCreatePixelBuffer(nullptr, _pool, &slot);
+            } else {
+                CVPixelBufferCreate(nullptr, sc_width, sc_height, _pixelFormat, nullptr, &slot);
+            }
+
+            CVPixelBufferLockBaseAddress(slot, CVPixelBufferLockFlags(0));
+            if (CVPixelBufferIsPlanar(slot)) {
+                for (size_t plane = 0; plane < CVPixelBufferGetPlaneCount(slot); ++plane) {
+                    _touchRows(static_cast<uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(slot, plane)),
+                               CVPixelBufferGetBytesPerRowOfPlane(slot, plane),
+                               CVPixelBufferGetHeightOfPlane(slot, plane),
+                               frame);
+                }
+            } else {
+                _touchRows(static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(slot)),
+                           CVPixelBufferGetBytesPerRow(slot),
+                           CVPixelBufferGetHeight(slot),
+                           frame);
+            }
+            CVPixelBufferUnlockBaseAddress(slot, CVPixelBufferLockFlags(0));
+        }
+
+        for (CVPixelBufferRef& slot : _frames) {
+            CVPixelBufferRelease(slot);
+            slot = nullptr;
+        }
+    }
+
+private:
+    static void _touchRows(uint8_t* rows, size_t bytesPerRow, size_t height, size_t frame) {
+        for (size_t row = 0; row < height; ++row) {
+            rows[row * bytesPerRow] = static_cast<uint8_t>(frame);
+        }
+    }
+
+    static void _setNumber(CFMutableDictionaryRef dictionary, CFStringRef key, int value) {
+        CFNumberRef number = CFNumberCreate(nullptr, kCFNumberIntType, &value);
+        CFDictionarySetValue(dictionary, key, number);
+        CFRelease(number);
+    }
+
+    OSType _pixelFormat;
+    CVPixelBufferPoolRef _pool;
+    CVPixelBufferRef _frames[sc_framesInFlight];
+};
+
+class PooledBiPlanar420 : public CVPixelBufferAllocationBase {
+public:
+    PooledBiPlanar420() : CVPixelBufferAllocationBase(kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange, true) {
+    }
+};
+
+BENCHMARK_F(CVPixelBufferPool, PooledBiPlanar420);
+
+class UnpooledBiPlanar420 : public CVPixelBufferAllocationBase {
+public:
+    UnpooledBiPlanar420() : CVPixelBufferAllocationBase(kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange, false) {
+    }
+};
+
+BENCHMARK_F(CVPixelBufferPool, UnpooledBiPlanar420);
+
+class PooledBGRA : public CVPixelBufferAllocationBase {
+public:
+    PooledBGRA() : CVPixelBufferAllocationBase(kCVPixelFormatType_32BGRA, true) {
+    }
+};
+
+BENCHMARK_F(CVPixelBufferPool, PooledBGRA);
+
+class UnpooledBGRA : public CVPixelBufferAllocationBase {
+public:
+    UnpooledBGRA() : CVPixelBufferAllocationBase(kCVPixelFormatType_32BGRA, false) {
+    }
+};
+
+BENCHMARK_F(CVPixelBufferPool, UnpooledBGRA);
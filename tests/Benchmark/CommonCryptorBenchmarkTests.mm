@@ -0,0 +1,203 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <CommonCrypto/CommonCrypto.h>
+#import <CommonCrypto/CommonCryptorSPI.h>
+
+#import "Benchmark.h"
+
+#include <algorithm>
+#include <vector>
+
+static const unsigned char sc_key[kCCKeySizeAES256] = { 0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+                                                        0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+                                                        0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4 };
+static const unsigned char sc_iv[kCCBlockSizeAES128] = { 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88 };
+
+// Messages of one size, encrypted one at a time, so each run measures per-message latency including setup.
+class CryptorMessagesBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    CryptorMessagesBase(size_t length) : _length(length), _count(std::max<size_t>(1, (4 * 1024 * 1024) / length)) {
+        _plaintext.resize(length);
+        for (size_t i = 0; i < length; ++i) {
+            _plaintext[i] = static_cast<unsigned char>(i * 31 + 7);
+        }
+        _ciphertext.resize(length + kCCBlockSizeAES128);
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+protected:
+    size_t _length;
+    size_t _count;
+    std::vector<unsigned char> _plaintext;
+    std::vector<unsigned char> _ciphertext;
+};
+
+class GCMOneshotBase : public CryptorMessagesBase {
+public:
+    GCMOneshotBase(size_t length) : CryptorMessagesBase(length) {
+    }
+
+    inline void Run() {
+        unsigned char tag[16];
+        for (size_t i = 0; i < _count; ++i) {
+            CCCryptorGCMOneshotEncrypt(kCCAlgorithmAES,
+                                       sc_key,
+                                       sizeof(sc_key),
+                                       sc_iv,
+                                       12,
+                                       nullptr,
+                                       0,
+                                       _plaintext.data(),
+                                       _length,
+                                       _ciphertext.data(),
+                                       tag,
+                                       sizeof(tag));
+        }
+    }
+};
+
+class CBCCryptBase : public CryptorMessagesBase {
+public:
+    CBCCryptBase(size_t length) : CryptorMessagesBase(length) {
+    }
+
+    inline void Run() {
+        size_t moved;
+        for (size_t i = 0; i < _count; ++i) {
+            CCCrypt(kCCEncrypt,
+                    kCCAlgorithmAES,
+                    kCCOptionPKCS7Padding,
+                    sc_key,
+                    sizeof(sc_key),
+                    sc_iv,
+                    _plaintext.data(),
+                    _length,
+                    _ciphertext.data(),
+                    _ciphertext.size(),
+                    &moved);
+        }
+    }
+};
+
+// A long-lived cryptor reset per message, which keeps the expanded key.
+class GCMReusedCryptorBase : public CryptorMessagesBase {
+public:
+    GCMReusedCryptorBase(size_t length) : CryptorMessagesBase(length) {
+        CCCryptorCreateWithMode(kCCEncrypt, kCCModeGCM, kCCAlgorithmAES, ccNoPadding, nullptr, sc_key, sizeof(sc_key), nullptr, 0, 0, 0, &_cryptor);
+    }
+
+    ~GCMReusedCryptorBase() {
+        CCCryptorRelease(_cryptor);
+    }
+
+    inline void Run() {
+        unsigned char tag[16];
+        for (size_t i = 0; i < _count; ++i) {
+            size_t tagLength = sizeof(tag);
+            CCCryptorGCMReset(_cryptor);
+            CCCryptorGCMSetIV(_cryptor, sc_iv, 12);
+            CCCryptorGCMEncrypt(_cryptor, _plaintext.data(), _length, _ciphertext.data());
+            CCCryptorGCMFinal(_cryptor, tag, &tagLength);
+        }
+    }
+
+private:
+    CCCryptorRef _cryptor;
+};
+
+class GCMOneshot64B : public GCMOneshotBase {
+public:
+    GCMOneshot64B() : GCMOneshotBase(64) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMOneshot64B);
+
+class GCMOneshot1KB : public GCMOneshotBase {
+public:
+    GCMOneshot1KB() : GCMOneshotBase(1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMOneshot1KB);
+
+class GCMOneshot16KB : public GCMOneshotBase {
+public:
+    GCMOneshot16KB() : GCMOneshotBase(16 * 1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMOneshot16KB);
+
+class GCMOneshot1MB : public GCMOneshotBase {
+public:
+    GCMOneshot1MB() : GCMOneshotBase(1024 * 1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMOneshot1MB);
+
+class GCMReusedCryptor64B : public GCMReusedCryptorBase {
+public:
+    GCMReusedCryptor64B() : GCMReusedCryptorBase(64) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMReusedCryptor64B);
+
+class GCMReusedCryptor1KB : public GCMReusedCryptorBase {
+public:
+    GCMReusedCryptor1KB() : GCMReusedCryptorBase(1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, GCMReusedCryptor1KB);
+
+class CBCCrypt64B : public CBCCryptBase {
+public:
+    CBCCrypt64B() : CBCCryptBase(64) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, CBCCrypt64B);
+
+class CBCCrypt1KB : public CBCCryptBase {
+public:
+    CBCCrypt1KB() : CBCCryptBase(1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, CBCCrypt1KB);
+
+class CBCCrypt16KB : public CBCCryptBase {
+public:
+    CBCCrypt16KB() : CBCCryptBase(16 * 1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, CBCCrypt16KB);
+
+class CBCCrypt1MB : public CBCCryptBase {
+public:
+    CBCCrypt1MB() : CBCCryptBase(1024 * 1024) {
+    }
+};
+
+BENCHMARK_F(CommonCryptor, CBCCrypt1MB);
@@ -0,0 +1,145 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <CommonCrypto/CommonCrypto.h>
+
+#import "Benchmark.h"
+
+#include <vector>
+
+static const size_t sc_smallMessageCount = 16 * 1024;
+static const size_t sc_smallMessageLength = 64;
+static const size_t sc_largeMessageCount = 8;
+static const size_t sc_largeMessageLength = 1024 * 1024;
+
+// A batch of independent messages, as a content-addressed cache or a signature check over many records would hash them.
+class DigestBatchBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    DigestBatchBase(size_t count, size_t length)
+        : _storage(count * length), _digests(count * CC_SHA512_DIGEST_LENGTH), _lengths(count, static_cast<CC_LONG>(length)) {
+        for (size_t i = 0; i < _storage.size(); ++i) {
+            _storage[i] = static_cast<unsigned char>(i * 31 + 7);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            _data.push_back(&_storage[i * length]);
+            _digestPointers.push_back(&_digests[i * CC_SHA512_DIGEST_LENGTH]);
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+protected:
+    std::vector<unsigned char> _storage;
+    std::vector<unsigned char> _digests;
+    std::vector<CC_LONG> _lengths;
+    std::vector<const void*> _data;
+    std::vector<unsigned char*> _digestPointers;
+};
+
+class SHA256SmallOneAtATime : public DigestBatchBase {
+public:
+    SHA256SmallOneAtATime() : DigestBatchBase(sc_smallMessageCount, sc_smallMessageLength) {
+    }
+
+    inline void Run() {
+        for (size_t i = 0; i < _data.size(); ++i) {
+            CC_SHA256(_data[i], _lengths[i], _digestPointers[i]);
+        }
+    }
+};
+
+BENCHMARK_F(CommonDigest, SHA256SmallOneAtATime);
+
+class SHA256SmallMultiple : public DigestBatchBase {
+public:
+    SHA256SmallMultiple() : DigestBatchBase(sc_smallMessageCount, sc_smallMessageLength) {
+    }
+
+    inline void Run() {
+        CC_DigestMultiple(kCCDigestSHA256, _data.data(), _lengths.data(), _data.size(), _digestPointers.data());
+    }
+};
+
+BENCHMARK_F(CommonDigest, SHA256SmallMultiple);
+
+class SHA256LargeOneAtATime : public DigestBatchBase {
+public:
+    SHA256LargeOneAtATime() : DigestBatchBase(sc_largeMessageCount, sc_largeMessageLength) {
+    }
+
+    inline void Run() {
+        for (size_t i = 0; i < _data.size(); ++i) {
+            CC_SHA256(_data[i], _lengths[i], _digestPointers[i]);
+        }
+    }
+};
+
+BENCHMARK_F(CommonDigest, SHA256LargeOneAtATime);
+
+class SHA256LargeMultiple : public DigestBatchBase {
+public:
+    SHA256LargeMultiple() : DigestBatchBase(sc_largeMessageCount, sc_largeMessageLength) {
+    }
+
+    inline void Run() {
+        CC_DigestMultiple(kCCDigestSHA256, _data.data(), _lengths.data(), _data.size(), _digestPointers.data());
+    }
+};
+
+BENCHMARK_F(CommonDigest, SHA256LargeMultiple);
+
+class MD5SmallMultiple : public DigestBatchBase {
+public:
+    MD5SmallMultiple() : DigestBatchBase(sc_smallMessageCount, sc_smallMessageLength) {
+    }
+
+    inline void Run() {
+        CC_DigestMultiple(kCCDigestMD5, _data.data(), _lengths.data(), _data.size(), _digestPointers.data());
+    }
+};
+
+BENCHMARK_F(CommonDigest, MD5SmallMultiple);
+
+class SHA512LargeOneAtATime : public DigestBatchBase {
+public:
+    SHA512LargeOneAtATime() : DigestBatchBase(sc_largeMessageCount, sc_largeMessageLength) {
+    }
+
+    inline void Run() {
+        for (size_t i = 0; i < _data.size(); ++i) {
+            CC_SHA512(_data[i], _lengths[i], _digestPointers[i]);
+        }
+    }
+};
+
+BENCHMARK_F(CommonDigest, SHA512LargeOneAtATime);
+
+class HmacSHA256Small : public DigestBatchBase {
+public:
+    HmacSHA256Small() : DigestBatchBase(sc_smallMessageCount, sc_smallMessageLength) {
+    }
+
+    inline void Run() {
+        static const char key[] = "benchmark key";
+        for (size_t i = 0; i < _data.size(); ++i) {
+            CCHmac(kCCHmacAlgSHA256, key, sizeof(key) - 1, _data[i], _lengths[i], _digestPointers[i]);
+        }
+    }
+};
+
+BENCHMARK_F(CommonDigest, HmacSHA256Small);
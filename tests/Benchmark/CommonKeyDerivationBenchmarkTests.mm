@@ -0,0 +1,84 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <CommonCrypto/CommonCrypto.h>
+
+#import "Benchmark.h"
+
+// Each run derives one key with sc_rounds iterations, so rounds per second is sc_rounds divided by the time per run.
+static const unsigned sc_rounds = 100000;
+static const char sc_password[] = "correct horse battery staple";
+static const uint8_t sc_salt[] = { 0x8e, 0x1f, 0x4a, 0x3c, 0x77, 0x02, 0xd9, 0x61, 0x5b, 0xa0, 0x13, 0xee, 0x40, 0x9c, 0x26, 0xf5 };
+
+class PBKDF2Base : public ::benchmark::BenchmarkCaseBase {
+public:
+    PBKDF2Base(CCPseudoRandomAlgorithm prf, size_t derivedKeyLength) : _prf(prf), _derivedKeyLength(derivedKeyLength) {
+    }
+
+    inline void Run() {
+        CCKeyDerivationPBKDF(kCCPBKDF2,
+                             sc_password,
+                             sizeof(sc_password) - 1,
+                             sc_salt,
+                             sizeof(sc_salt),
+                             _prf,
+                             sc_rounds,
+                             _derivedKey,
+                             _derivedKeyLength);
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+private:
+    CCPseudoRandomAlgorithm _prf;
+    size_t _derivedKeyLength;
+    uint8_t _derivedKey[8 * CC_SHA512_DIGEST_LENGTH];
+};
+
+class PBKDF2SHA1Key32 : public PBKDF2Base {
+public:
+    PBKDF2SHA1Key32() : PBKDF2Base(kCCPRFHmacAlgSHA1, 32) {
+    }
+};
+
+BENCHMARK_F(CommonKeyDerivation, PBKDF2SHA1Key32);
+
+class PBKDF2SHA256Key32 : public PBKDF2Base {
+public:
+    PBKDF2SHA256Key32() : PBKDF2Base(kCCPRFHmacAlgSHA256, 32) {
+    }
+};
+
+BENCHMARK_F(CommonKeyDerivation, PBKDF2SHA256Key32);
+
+// Eight output blocks: enough to fill every lane of the multi-buffer kernels.
+class PBKDF2SHA256Key256 : public PBKDF2Base {
+public:
+    PBKDF2SHA256Key256() : PBKDF2Base(kCCPRFHmacAlgSHA256, 8 * CC_SHA256_DIGEST_LENGTH) {
+    }
+};
+
+BENCHMARK_F(CommonKeyDerivation, PBKDF2SHA256Key256);
+
+class PBKDF2SHA512Key64 : public PBKDF2Base {
+public:
+    PBKDF2SHA512Key64() : PBKDF2Base(kCCPRFHmacAlgSHA512, 64) {
+    }
+};
+
+BENCHMARK_F(CommonKeyDerivation, PBKDF2SHA512Key64);
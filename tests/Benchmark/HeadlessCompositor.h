@@ -0,0 +1,75 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "../unittests/UIKit/NullCompositor.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Display texture backed by plain memory, so layers can be drawn without a Xaml host.
+class HeadlessDisplayTexture : public IDisplayTexture {
+public:
+    HeadlessDisplayTexture(int width, int height) : _stride(width * 4), _pixels(width * height * 4) {
+    }
+
+    Microsoft::WRL::ComPtr<IInspectable> GetContent() override {
+        return nullptr;
+    }
+
+    void* Lock(int* stride) override {
+        *stride = _stride;
+        return _pixels.data();
+    }
+
+    void Unlock() override {
+    }
+
+private:
+    int _stride;
+    std::vector<uint8_t> _pixels;
+};
+
+class HeadlessLayerProxy : public ILayerProxy {
+public:
+    Microsoft::WRL::ComPtr<IInspectable> GetXamlElement() override {
+        return nullptr;
+    }
+    Microsoft::WRL::ComPtr<IInspectable> GetSublayerXamlElement() override {
+        return nullptr;
+    }
+    void* GetPropertyValue(const char* propertyName) override {
+        return nullptr;
+    }
+    void SetShouldRasterize(bool shouldRasterize) override {
+    }
+    void SetTopMost() override {
+    }
+};
+
+class HeadlessCompositor : public NullCompositor {
+public:
+    std::shared_ptr<ILayerProxy> CreateLayerProxy(const Microsoft::WRL::ComPtr<IInspectable>& xamlElement) override {
+        return std::make_shared<HeadlessLayerProxy>();
+    }
+
+    std::shared_ptr<IDisplayTexture> CreateDisplayTexture(int width, int height) override {
+        return std::make_shared<HeadlessDisplayTexture>(width, height);
+    }
+};
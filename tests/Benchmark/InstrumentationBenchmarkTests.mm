@@ -0,0 +1,109 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+
+#import "Benchmark.h"
+#import "Instrumentation.h"
+
+#include <windows.h>
+#include <string>
+
+// Each run passes through span and counter sites shaped like a layout pass 10000 times: an outer span, a nested span
+// for each of two children, and a counter.
+static const size_t sc_passCount = 10000;
+
+static void _layoutChild() {
+    INSTRUMENT_SPAN("InstrumentationBenchmark", "layoutChild");
+}
+
+static void _layoutPass() {
+    for (size_t index = 0; index < sc_passCount; ++index) {
+        INSTRUMENT_SPAN("InstrumentationBenchmark", "layoutPass");
+        _layoutChild();
+        _layoutChild();
+        INSTRUMENT_COUNTER_ADD("InstrumentationBenchmark", "childrenLaidOut", 2);
+    }
+}
+
+// Passes through the sites with instrumentation disabled: the cost every instrumented framework pays in production.
+class SitesDisabled : public ::benchmark::BenchmarkCaseBase {
+public:
+    SitesDisabled() {
+        InstrumentationSetEnabled(false);
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _layoutPass();
+    }
+};
+
+BENCHMARK_F(Instrumentation, SitesDisabled);
+
+// Records aggregates for every span and counter update.
+class SitesEnabled : public ::benchmark::BenchmarkCaseBase {
+public:
+    SitesEnabled() {
+        InstrumentationSetEnabled(true);
+    }
+
+    ~SitesEnabled() {
+        InstrumentationSetEnabled(false);
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _layoutPass();
+    }
+};
+
+BENCHMARK_F(Instrumentation, SitesEnabled);
+
+// Records aggregates and also captures every event to a trace file, written by the collector thread.
+class SitesTraced : public ::benchmark::BenchmarkCaseBase {
+public:
+    SitesTraced() {
+        wchar_t tempPath[MAX_PATH];
+        GetTempPathW(_countof(tempPath), tempPath);
+        _tracePath = std::wstring(tempPath) + L"InstrumentationBenchmark.json";
+        InstrumentationStartTrace(_tracePath.c_str());
+    }
+
+    ~SitesTraced() {
+        InstrumentationStopTrace();
+        DeleteFileW(_tracePath.c_str());
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _layoutPass();
+    }
+
+private:
+    std::wstring _tracePath;
+};
+
+BENCHMARK_F(Instrumentation, SitesTraced);
@@ -0,0 +1,112 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+
+#import "Benchmark.h"
+#import "LoggingNative.h"
+#import "LoggingTesting.h"
+
+#include <windows.h>
+#include <string>
+
+// Each run hits a trace point shaped like the ones on the CALayer display path 10000 times.
+static const size_t sc_traceCount = 10000;
+
+static const wchar_t* sc_tag = L"LoggingBenchmark";
+
+static void _traceDisplayPass() {
+    const char* layerName = "contentLayer";
+    for (size_t index = 0; index < sc_traceCount; ++index) {
+        TraceVerbose(
+            sc_tag, L"Displaying %hs (%p) at %.2fx%.2f, pass %u", layerName, &index, 320.0, 480.0f, static_cast<unsigned int>(index));
+    }
+}
+
+// Traces under a disabled tag: the cost of a trace point that is compiled in but switched off. Release builds with no
+// ETW listener return even earlier, at the level check.
+class TraceDisabled : public ::benchmark::BenchmarkCaseBase {
+public:
+    TraceDisabled() {
+        TraceSetTagEnabled(sc_tag, false);
+    }
+
+    ~TraceDisabled() {
+        TraceSetTagEnabled(sc_tag, true);
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _traceDisplayPass();
+    }
+};
+
+BENCHMARK_F(Logging, TraceDisabled);
+
+// Traces into the buffered sink, which captures the arguments and leaves formatting to its drainer thread.
+class TraceBuffered : public ::benchmark::BenchmarkCaseBase {
+public:
+    TraceBuffered() {
+        wchar_t tempPath[MAX_PATH];
+        GetTempPathW(_countof(tempPath), tempPath);
+        _logPath = std::wstring(tempPath) + L"LoggingBenchmark.log";
+        DeleteFileW(_logPath.c_str());
+        TraceStartBufferedSink(_logPath.c_str(), TraceLevelVerbose);
+    }
+
+    ~TraceBuffered() {
+        TraceStopBufferedSink();
+        DeleteFileW(_logPath.c_str());
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _traceDisplayPass();
+    }
+
+private:
+    std::wstring _logPath;
+};
+
+BENCHMARK_F(Logging, TraceBuffered);
+
+// Traces with the test hook enabled, which formats every message on the calling thread as an ETW listener would.
+class TraceSynchronous : public ::benchmark::BenchmarkCaseBase {
+public:
+    TraceSynchronous() {
+        g_isTestHookEnabled = true;
+    }
+
+    ~TraceSynchronous() {
+        g_isTestHookEnabled = false;
+    }
+
+    size_t GetRunCount() const {
+        return 100;
+    }
+
+    inline void Run() {
+        _traceDisplayPass();
+    }
+};
+
+BENCHMARK_F(Logging, TraceSynchronous);
@@ -0,0 +1,106 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+// 1M weakly held entries. Each run deallocates 100k of the objects, adds 100k replacements, and looks up 100k live ones.
+static const size_t sc_entryCount = 1000000;
+static const size_t sc_churnCount = 100000;
+
+class WeakTableChurnBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    WeakTableChurnBase() : _nextChurn(0) {
+        _objects.attach([[NSMutableArray alloc] initWithCapacity:sc_entryCount]);
+        @autoreleasepool {
+            for (size_t i = 0; i < sc_entryCount; ++i) {
+                [_objects addObject:[[NSObject new] autorelease]];
+            }
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+protected:
+    template <typename TAdd, typename TLookup>
+    void _churn(TAdd add, TLookup lookup) {
+        @autoreleasepool {
+            for (size_t i = 0; i < sc_churnCount; ++i) {
+                NSUInteger index = (_nextChurn + i) % sc_entryCount;
+                NSObject* replacement = [NSObject new];
+                // Releases the last reference to the object being replaced, leaving a dead entry behind in the table.
+                [_objects replaceObjectAtIndex:index withObject:replacement];
+                add(replacement);
+                [replacement release];
+            }
+
+            for (size_t i = 0; i < sc_churnCount; ++i) {
+                lookup(_objects.get()[(_nextChurn + sc_entryCount / 2 + i) % sc_entryCount]);
+            }
+        }
+
+        _nextChurn = (_nextChurn + sc_churnCount) % sc_entryCount;
+    }
+
+    StrongId<NSMutableArray<NSObject*>> _objects;
+    size_t _nextChurn;
+};
+
+class WeakHashTableChurn : public WeakTableChurnBase {
+public:
+    WeakHashTableChurn() {
+        _table = [NSHashTable weakObjectsHashTable];
+        for (NSObject* object in _objects.get()) {
+            [_table addObject:object];
+        }
+    }
+
+    inline void Run() {
+        NSHashTable* table = _table;
+        _churn([table](NSObject* object) { [table addObject:object]; }, [table](NSObject* object) { [table containsObject:object]; });
+    }
+
+private:
+    StrongId<NSHashTable<NSObject*>> _table;
+};
+
+BENCHMARK_F(NSHashTable, WeakHashTableChurn);
+
+class WeakToStrongMapTableChurn : public WeakTableChurnBase {
+public:
+    WeakToStrongMapTableChurn() {
+        // The values are a shared placeholder, so that they do not keep their weak keys alive.
+        _table = [NSMapTable weakToStrongObjectsMapTable];
+        for (NSObject* object in _objects.get()) {
+            [_table setObject:[NSNull null] forKey:object];
+        }
+    }
+
+    inline void Run() {
+        NSMapTable* table = _table;
+        _churn([table](NSObject* object) { [table setObject:[NSNull null] forKey:object]; },
+               [table](NSObject* object) { [table objectForKey:object]; });
+    }
+
+private:
+    StrongId<NSMapTable<NSObject*, NSObject*>> _table;
+};
+
+BENCHMARK_F(NSMapTable, WeakToStrongMapTableChurn);
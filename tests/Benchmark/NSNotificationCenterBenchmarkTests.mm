@@ -0,0 +1,128 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+#include <atomic>
+
+// 10000 observers, spread over 200 notification names. Every fourth observer only listens to one of 50 senders.
+static const size_t sc_observerCount = 10000;
+static const size_t sc_nameCount = 200;
+static const size_t sc_senderCount = 50;
+
+static std::atomic<size_t> s_deliveredCount;
+
+@interface NSNotificationCenterBenchmarkObserver : NSObject
+@end
+
+@implementation NSNotificationCenterBenchmarkObserver
+- (void)receiveNotification:(NSNotification*)notification {
+    ++s_deliveredCount;
+}
+@end
+
+class NSNotificationCenterBenchmarkBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    NSNotificationCenterBenchmarkBase() {
+        _center.attach([NSNotificationCenter new]);
+        _names.attach([NSMutableArray new]);
+        _senders.attach([NSMutableArray new]);
+        _observers.attach([NSMutableArray new]);
+
+        @autoreleasepool {
+            for (size_t i = 0; i < sc_nameCount; ++i) {
+                [_names addObject:[NSString stringWithFormat:@"BenchmarkNotification%zu", i]];
+            }
+            for (size_t i = 0; i < sc_senderCount; ++i) {
+                [_senders addObject:[[NSObject new] autorelease]];
+            }
+            for (size_t i = 0; i < sc_observerCount; ++i) {
+                [_observers addObject:[[NSNotificationCenterBenchmarkObserver new] autorelease]];
+            }
+        }
+    }
+
+protected:
+    void _addObservers() {
+        for (size_t i = 0; i < sc_observerCount; ++i) {
+            id sender = (i % 4 == 0) ? _senders.get()[i % sc_senderCount] : nil;
+            [_center addObserver:_observers.get()[i]
+                        selector:@selector(receiveNotification:)
+                            name:_names.get()[i % sc_nameCount]
+                          object:sender];
+        }
+    }
+
+    void _removeObservers() {
+        for (id observer in _observers.get()) {
+            [_center removeObserver:observer];
+        }
+    }
+
+    StrongId<NSNotificationCenter> _center;
+    StrongId<NSMutableArray<NSString*>> _names;
+    StrongId<NSMutableArray<NSObject*>> _senders;
+    StrongId<NSMutableArray<NSNotificationCenterBenchmarkObserver*>> _observers;
+};
+
+// Posts every name once for each sender, and once with no sender.
+class PostTo10kObservers : public NSNotificationCenterBenchmarkBase {
+public:
+    PostTo10kObservers() {
+        _addObservers();
+    }
+
+    ~PostTo10kObservers() {
+        _removeObservers();
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+    inline void Run() {
+        @autoreleasepool {
+            for (NSString* name in _names.get()) {
+                [_center postNotificationName:name object:nil];
+                for (NSObject* sender in _senders.get()) {
+                    [_center postNotificationName:name object:sender];
+                }
+            }
+        }
+    }
+};
+
+BENCHMARK_F(NSNotificationCenter, PostTo10kObservers);
+
+class Remove10kObservers : public NSNotificationCenterBenchmarkBase {
+public:
+    void PreRun() {
+        _addObservers();
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+    inline void Run() {
+        _removeObservers();
+    }
+};
+
+BENCHMARK_F(NSNotificationCenter, Remove10kObservers);
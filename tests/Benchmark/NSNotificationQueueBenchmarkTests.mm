@@ -0,0 +1,106 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+// A burst of 100000 "needs refresh" notifications spread over 100 views, delivered from one run loop pass.
+static const size_t sc_burstCount = 100000;
+static const size_t sc_viewCount = 100;
+
+static NSString* const sc_needsRefreshNotification = @"NSNotificationQueueBenchmarkNeedsRefresh";
+
+class NSNotificationQueueBenchmarkBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    NSNotificationQueueBenchmarkBase(NSNotificationCoalescing coalesceMask) : _coalesceMask(coalesceMask), _refreshCount(0) {
+        _views.attach([NSMutableArray new]);
+        _notifications.attach([NSMutableArray new]);
+
+        @autoreleasepool {
+            for (size_t i = 0; i < sc_viewCount; ++i) {
+                [_views addObject:[[NSObject new] autorelease]];
+            }
+            for (size_t i = 0; i < sc_burstCount; ++i) {
+                [_notifications addObject:[NSNotification notificationWithName:sc_needsRefreshNotification
+                                                                         object:_views.get()[i % sc_viewCount]]];
+            }
+        }
+
+        size_t* refreshCount = &_refreshCount;
+        _observer = [[NSNotificationCenter defaultCenter] addObserverForName:sc_needsRefreshNotification
+                                                                      object:nil
+                                                                       queue:nil
+                                                                  usingBlock:^(NSNotification*) {
+                                                                      ++*refreshCount;
+                                                                  }];
+    }
+
+    ~NSNotificationQueueBenchmarkBase() {
+        [[NSNotificationCenter defaultCenter] removeObserver:_observer];
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    void PreRun() {
+        _refreshCount = 0;
+    }
+
+    // Every view refreshes at least once per burst; coalescing saves the rest.
+    void PostRun() {
+        ::testing::Test::RecordProperty("Refreshes", static_cast<int>(_refreshCount));
+        ::testing::Test::RecordProperty("RefreshesSaved", static_cast<int>(sc_burstCount - _refreshCount));
+        EXPECT_LE(sc_viewCount, _refreshCount);
+    }
+
+    inline void Run() {
+        NSNotificationQueue* queue = [NSNotificationQueue defaultQueue];
+        for (NSNotification* notification in _notifications.get()) {
+            [queue enqueueNotification:notification postingStyle:NSPostASAP coalesceMask:_coalesceMask forModes:nil];
+        }
+
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate date]];
+    }
+
+protected:
+    NSNotificationCoalescing _coalesceMask;
+    size_t _refreshCount;
+    StrongId<NSMutableArray<NSObject*>> _views;
+    StrongId<NSMutableArray<NSNotification*>> _notifications;
+    id _observer;
+};
+
+// Every notification in the burst is delivered: 100000 refreshes.
+class Burst100kUncoalesced : public NSNotificationQueueBenchmarkBase {
+public:
+    Burst100kUncoalesced() : NSNotificationQueueBenchmarkBase(NSNotificationNoCoalescing) {
+    }
+};
+
+BENCHMARK_F(NSNotificationQueue, Burst100kUncoalesced);
+
+// Coalescing on name and sender leaves one pending refresh per view: 100 refreshes.
+class Burst100kCoalesced : public NSNotificationQueueBenchmarkBase {
+public:
+    Burst100kCoalesced()
+        : NSNotificationQueueBenchmarkBase((NSNotificationCoalescing)(NSNotificationCoalescingOnName | NSNotificationCoalescingOnSender)) {
+    }
+};
+
+BENCHMARK_F(NSNotificationQueue, Burst100kCoalesced);
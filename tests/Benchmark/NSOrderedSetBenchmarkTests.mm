@@ -0,0 +1,109 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+// Each run inserts 100k records at the front, half of them duplicates, then checks membership of every record and
+// looks up the position of 1000 of them.
+static const size_t sc_recordCount = 100000;
+static const size_t sc_positionLookupCount = 1000;
+
+class OrderedSetBenchmarkBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    OrderedSetBenchmarkBase() {
+        _records.attach([[NSMutableArray alloc] initWithCapacity:sc_recordCount]);
+        @autoreleasepool {
+            for (size_t i = 0; i < sc_recordCount; ++i) {
+                [_records addObject:[NSString stringWithFormat:@"Record%zu", i / 2]];
+            }
+        }
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+protected:
+    template <typename TInsert, typename TContains, typename TIndexOf>
+    void _run(TInsert insertAtFront, TContains contains, TIndexOf indexOf) {
+        @autoreleasepool {
+            for (NSString* record in _records.get()) {
+                insertAtFront(record);
+            }
+
+            for (NSString* record in _records.get()) {
+                contains(record);
+            }
+
+            for (size_t i = 0; i < sc_positionLookupCount; ++i) {
+                indexOf(_records.get()[(i * sc_recordCount) / sc_positionLookupCount]);
+            }
+        }
+    }
+
+    StrongId<NSMutableArray<NSString*>> _records;
+};
+
+class MutableOrderedSet100k : public OrderedSetBenchmarkBase {
+public:
+    void PreRun() {
+        _orderedSet.attach([[NSMutableOrderedSet alloc] initWithCapacity:sc_recordCount]);
+    }
+
+    inline void Run() {
+        NSMutableOrderedSet* orderedSet = _orderedSet;
+        _run([orderedSet](NSString* record) { [orderedSet insertObject:record atIndex:0]; },
+             [orderedSet](NSString* record) { [orderedSet containsObject:record]; },
+             [orderedSet](NSString* record) { [orderedSet indexOfObject:record]; });
+    }
+
+private:
+    StrongId<NSMutableOrderedSet<NSString*>> _orderedSet;
+};
+
+BENCHMARK_F(NSOrderedSet, MutableOrderedSet100k);
+
+// The usual workaround: an array for order, and a set alongside it for membership.
+class ArrayAndSet100k : public OrderedSetBenchmarkBase {
+public:
+    void PreRun() {
+        _array.attach([[NSMutableArray alloc] initWithCapacity:sc_recordCount]);
+        _set.attach([[NSMutableSet alloc] initWithCapacity:sc_recordCount]);
+    }
+
+    inline void Run() {
+        NSMutableArray* array = _array;
+        NSMutableSet* set = _set;
+        _run(
+            [array, set](NSString* record) {
+                if (![set containsObject:record]) {
+                    [set addObject:record];
+                    [array insertObject:record atIndex:0];
+                }
+            },
+            [set](NSString* record) { [set containsObject:record]; },
+            [array](NSString* record) { [array indexOfObject:record]; });
+    }
+
+private:
+    StrongId<NSMutableArray<NSString*>> _array;
+    StrongId<NSMutableSet<NSString*>> _set;
+};
+
+BENCHMARK_F(NSOrderedSet, ArrayAndSet100k);
@@ -0,0 +1,141 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include <windows.h>
+#include <psapi.h>
+
+// The process's working set. Unlike its private bytes, this includes the pages of mapped file views, which is where a
+// file load that holds on to what it has read would grow.
+static size_t _workingSetBytes() {
+    PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+    return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+}
+
+// Discards everything it is handed, tracking the byte count and the largest working set seen while loading.
+@interface NSURLProtocolFileBenchmarkDelegate : NSObject <NSURLSessionDataDelegate>
+@property (readonly) dispatch_semaphore_t completed;
+@property (readonly) uint64_t bytesReceived;
+@property (readonly) size_t peakUsage;
+@property (readonly) BOOL failed;
+@end
+
+@implementation NSURLProtocolFileBenchmarkDelegate {
+    std::atomic<uint64_t> _bytesReceived;
+    std::atomic<size_t> _peakUsage;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _completed = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+- (void)reset {
+    _bytesReceived = 0;
+    _peakUsage = _workingSetBytes();
+    _failed = NO;
+}
+
+- (uint64_t)bytesReceived {
+    return _bytesReceived;
+}
+
+- (size_t)peakUsage {
+    return _peakUsage;
+}
+
+- (void)URLSession:(NSURLSession*)session dataTask:(NSURLSessionDataTask*)dataTask didReceiveData:(NSData*)data {
+    _bytesReceived += [data length];
+    size_t usage = _workingSetBytes();
+    size_t peak = _peakUsage;
+    while (usage > peak && !_peakUsage.compare_exchange_weak(peak, usage)) {
+    }
+}
+
+- (void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task didCompleteWithError:(NSError*)error {
+    _failed = (error != nil);
+    dispatch_semaphore_signal(_completed);
+}
+@end
+
+// Each run loads a whole file of the given size through a data task. The files are zero-extended rather than written, so setting
+// one up is quick even at 4GB; the first run warms the file cache.
+class LoadFile : public ::benchmark::BenchmarkCaseBase {
+public:
+    LoadFile(unsigned long long size) : _size(size) {
+        _path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"NSURLProtocolFile%llu.bin", size]];
+        [[NSFileManager defaultManager] createFileAtPath:_path contents:nil attributes:nil];
+        NSFileHandle* handle = [NSFileHandle fileHandleForWritingAtPath:_path];
+        [handle truncateFileAtOffset:size];
+        [handle closeFile];
+
+        _delegate.attach([NSURLProtocolFileBenchmarkDelegate new]);
+        _session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                 delegate:_delegate
+                                            delegateQueue:nil];
+    }
+
+    ~LoadFile() {
+        [_session invalidateAndCancel];
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+    }
+
+    size_t GetRunCount() const {
+        return _size >= (1ull << 30) ? 2 : 10;
+    }
+
+    void PreRun() {
+        [_delegate reset];
+        _baselineUsage = _workingSetBytes();
+    }
+
+    void PostRun() {
+        double megabytes = static_cast<double>(_size) / (1024 * 1024);
+        size_t peakGrowth = [_delegate peakUsage] - std::min([_delegate peakUsage], _baselineUsage);
+        ::testing::Test::RecordProperty("MegabytesPerSecond", static_cast<int>(megabytes / _elapsed.count()));
+        ::testing::Test::RecordProperty("PeakWorkingSetGrowthKilobytes", static_cast<int>(peakGrowth / 1024));
+        EXPECT_FALSE([_delegate failed]);
+        EXPECT_EQ(_size, [_delegate bytesReceived]);
+    }
+
+    inline void Run() {
+        auto start = std::chrono::steady_clock::now();
+        [[_session dataTaskWithURL:[NSURL fileURLWithPath:_path]] resume];
+        dispatch_semaphore_wait([_delegate completed], DISPATCH_TIME_FOREVER);
+        _elapsed = std::chrono::steady_clock::now() - start;
+    }
+
+private:
+    unsigned long long _size;
+    StrongId<NSString> _path;
+    StrongId<NSURLProtocolFileBenchmarkDelegate> _delegate;
+    StrongId<NSURLSession> _session;
+    size_t _baselineUsage;
+    std::chrono::duration<double> _elapsed;
+};
+
+static constexpr unsigned long long c_fileSizes[] = { 1ull << 20, 64ull << 20, 1ull << 30, 4ull << 30 };
+BENCHMARK_REGISTER_CASE_P(NSURLProtocolFile, LoadFile, ::testing::ValuesIn(c_fileSizes), unsigned long long);
@@ -0,0 +1,133 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+#import <NSURLProtocol_HTTP.h>
+
+#import "Benchmark.h"
+
+#include "tests/unittests/Foundation/LoopbackHTTPServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Each run fetches a 4KB body 1000 times from a loopback server, keeping 16 requests in flight.
+static const size_t sc_requestCount = 1000;
+static const long sc_requestsInFlight = 16;
+static const size_t sc_bodySize = 4096;
+
+class NSURLSessionHTTPBenchmarkBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    NSURLSessionHTTPBenchmarkBase(Class protocolClass, bool pipelining)
+        : _server([](const std::string&, const std::string&) { return LoopbackHTTPServer::Reply(std::string(sc_bodySize, 'b')); }),
+          _latencies(sc_requestCount) {
+        NSURLSessionConfiguration* configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        if (protocolClass) {
+            configuration.protocolClasses = @[ protocolClass ];
+        }
+        configuration.HTTPShouldUsePipelining = pipelining;
+        configuration.HTTPMaximumConnectionsPerHost = 4;
+        _session = [NSURLSession sessionWithConfiguration:configuration];
+        _url = [NSURL URLWithString:[NSString stringWithUTF8String:_server.URL("/benchmark").c_str()]];
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    void PreRun() {
+        _failures = 0;
+        _connectionsBefore = _server.ConnectionsAccepted();
+    }
+
+    // Latencies are measured from resume to completion, so they include the time a request waits for a connection.
+    void PostRun() {
+        std::sort(_latencies.begin(), _latencies.end());
+        size_t connections = std::max<size_t>(1, _server.ConnectionsAccepted() - _connectionsBefore);
+        ::testing::Test::RecordProperty("RequestsPerSecond", static_cast<int>(sc_requestCount / _elapsed.count()));
+        ::testing::Test::RecordProperty("P50LatencyMicroseconds", static_cast<int>(_latencies[sc_requestCount / 2]));
+        ::testing::Test::RecordProperty("P99LatencyMicroseconds", static_cast<int>(_latencies[sc_requestCount * 99 / 100]));
+        ::testing::Test::RecordProperty("RequestsPerConnection", static_cast<int>(sc_requestCount / connections));
+        EXPECT_EQ(0, _failures);
+    }
+
+    inline void Run() {
+        using Clock = std::chrono::steady_clock;
+        double* latencies = _latencies.data();
+        std::atomic<size_t>* failures = &_failures;
+        dispatch_semaphore_t window = dispatch_semaphore_create(sc_requestsInFlight);
+        dispatch_group_t group = dispatch_group_create();
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < sc_requestCount; ++i) {
+            dispatch_semaphore_wait(window, DISPATCH_TIME_FOREVER);
+            dispatch_group_enter(group);
+            auto requestStart = Clock::now();
+            NSURLSessionDataTask* task =
+                [_session dataTaskWithURL:_url
+                        completionHandler:^(NSData* data, NSURLResponse* response, NSError* error) {
+                            latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - requestStart).count();
+                            if (error || [data length] != sc_bodySize) {
+                                ++*failures;
+                            }
+                            dispatch_semaphore_signal(window);
+                            dispatch_group_leave(group);
+                        }];
+            [task resume];
+        }
+        dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+        _elapsed = Clock::now() - start;
+    }
+
+private:
+    LoopbackHTTPServer _server;
+    StrongId<NSURLSession> _session;
+    StrongId<NSURL> _url;
+    std::vector<double> _latencies;
+    std::atomic<size_t> _failures;
+    size_t _connectionsBefore;
+    std::chrono::duration<double> _elapsed;
+};
+
+// The default protocol, backed by Windows.Web.Http.
+class DefaultProtocol1k : public NSURLSessionHTTPBenchmarkBase {
+public:
+    DefaultProtocol1k() : NSURLSessionHTTPBenchmarkBase(nil, false) {
+    }
+};
+
+BENCHMARK_F(NSURLSessionHTTP, DefaultProtocol1k);
+
+// The pooled protocol, one request per connection at a time.
+class PooledProtocol1k : public NSURLSessionHTTPBenchmarkBase {
+public:
+    PooledProtocol1k() : NSURLSessionHTTPBenchmarkBase([NSURLProtocol_HTTP class], false) {
+    }
+};
+
+BENCHMARK_F(NSURLSessionHTTP, PooledProtocol1k);
+
+// The pooled protocol, with up to four requests pipelined on each connection.
+class PooledProtocolPipelined1k : public NSURLSessionHTTPBenchmarkBase {
+public:
+    PooledProtocolPipelined1k() : NSURLSessionHTTPBenchmarkBase([NSURLProtocol_HTTP class], true) {
+    }
+};
+
+BENCHMARK_F(NSURLSessionHTTP, PooledProtocolPipelined1k);
@@ -0,0 +1,140 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <Starboard/SmartTypes.h>
+#import <NSMemoryPressure.h>
+
+#import "Benchmark.h"
+
+#include "tests/unittests/Foundation/LoopbackHTTPServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+// Tracks the highest private usage seen while a body is being sent.
+@interface NSURLSessionUploadBenchmarkDelegate : NSObject <NSURLSessionDataDelegate>
+@property (readonly) dispatch_semaphore_t completed;
+@property (readonly) size_t peakUsage;
+@property (readonly) BOOL failed;
+@end
+
+@implementation NSURLSessionUploadBenchmarkDelegate {
+    std::atomic<size_t> _peakUsage;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _completed = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+- (void)reset {
+    _peakUsage = _NSMemoryPressureProcessUsage();
+    _failed = NO;
+}
+
+- (size_t)peakUsage {
+    return _peakUsage;
+}
+
+- (void)URLSession:(NSURLSession*)session
+                        task:(NSURLSessionTask*)task
+             didSendBodyData:(int64_t)bytesSent
+              totalBytesSent:(int64_t)totalBytesSent
+    totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
+    size_t usage = _NSMemoryPressureProcessUsage();
+    size_t peak = _peakUsage;
+    while (usage > peak && !_peakUsage.compare_exchange_weak(peak, usage)) {
+    }
+}
+
+- (void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task didCompleteWithError:(NSError*)error {
+    _failed = (error != nil);
+    dispatch_semaphore_signal(_completed);
+}
+@end
+
+// Each run uploads a file of the given size to a loopback server that counts the bytes and throws them away. The files are
+// zero-extended rather than written, so setting one up is quick even at 4GB.
+class UploadFile : public ::benchmark::BenchmarkCaseBase {
+public:
+    UploadFile(unsigned long long size)
+        : _size(size),
+          _server([](const std::string&, const std::string&) { return LoopbackHTTPServer::Reply("ok"); }, true /* discardBodies */) {
+        _path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"NSURLSessionUpload%llu.bin", size]];
+        [[NSFileManager defaultManager] createFileAtPath:_path contents:nil attributes:nil];
+        NSFileHandle* handle = [NSFileHandle fileHandleForWritingAtPath:_path];
+        [handle truncateFileAtOffset:size];
+        [handle closeFile];
+
+        NSMutableURLRequest* request =
+            [NSMutableURLRequest requestWithURL:[NSURL URLWithString:[NSString stringWithUTF8String:_server.URL("/upload").c_str()]]];
+        request.HTTPMethod = @"PUT";
+        _request = request;
+
+        _delegate.attach([NSURLSessionUploadBenchmarkDelegate new]);
+        _session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                 delegate:_delegate
+                                            delegateQueue:nil];
+    }
+
+    ~UploadFile() {
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+    }
+
+    size_t GetRunCount() const {
+        return _size >= (1ull << 30) ? 2 : 10;
+    }
+
+    void PreRun() {
+        [_delegate reset];
+        _baselineUsage = _NSMemoryPressureProcessUsage();
+        _bytesBefore = _server.BodyBytesReceived();
+    }
+
+    void PostRun() {
+        double megabytes = static_cast<double>(_size) / (1024 * 1024);
+        size_t peakGrowth = [_delegate peakUsage] - std::min([_delegate peakUsage], _baselineUsage);
+        ::testing::Test::RecordProperty("MegabytesPerSecond", static_cast<int>(megabytes / _elapsed.count()));
+        ::testing::Test::RecordProperty("PeakPrivateBytesGrowthKilobytes", static_cast<int>(peakGrowth / 1024));
+        EXPECT_FALSE([_delegate failed]);
+        EXPECT_EQ(_size, _server.BodyBytesReceived() - _bytesBefore);
+    }
+
+    inline void Run() {
+        auto start = std::chrono::steady_clock::now();
+        [[_session uploadTaskWithRequest:_request fromFile:[NSURL fileURLWithPath:_path]] resume];
+        dispatch_semaphore_wait([_delegate completed], DISPATCH_TIME_FOREVER);
+        _elapsed = std::chrono::steady_clock::now() - start;
+    }
+
+private:
+    unsigned long long _size;
+    LoopbackHTTPServer _server;
+    StrongId<NSString> _path;
+    StrongId<NSURLRequest> _request;
+    StrongId<NSURLSessionUploadBenchmarkDelegate> _delegate;
+    StrongId<NSURLSession> _session;
+    size_t _baselineUsage;
+    uint64_t _bytesBefore;
+    std::chrono::duration<double> _elapsed;
+};
+
+static constexpr unsigned long long c_uploadSizes[] = { 64ull << 20, 1ull << 30, 4ull << 30 };
+BENCHMARK_REGISTER_CASE_P(NSURLSessionUpload, UploadFile, ::testing::ValuesIn(c_uploadSizes), unsigned long long);
@@ -0,0 +1,325 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <UIKit/UIKit.h>
+#import <Starboard/SmartTypes.h>
+
+#import "Benchmark.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// 32 scenes of 16 views each, every subview connected to an outlet on the owner: about 10,000 items, within the 16,384
+// that the NIB format's two-byte item offsets can address.
+static const int sc_sceneCount = 32;
+static const int sc_subviewsPerScene = 15;
+
+// Decodes the keys UIView decodes from a storyboard, including the optional ones that are usually absent.
+@interface NibBenchmarkView : NSObject {
+@public
+    NSInteger _tag;
+    NSInteger _autoresizingMask;
+    NSInteger _contentMode;
+    float _alpha;
+    BOOL _opaque;
+    BOOL _hidden;
+    BOOL _clipsToBounds;
+    BOOL _userInteractionDisabled;
+    BOOL _translatesAutoresizingMask;
+    CGRect _bounds;
+    CGPoint _center;
+    StrongId<NSArray> _subviews;
+    StrongId<NSString> _text;
+    StrongId<NSString> _accessibilityLabel;
+    StrongId<NSString> _restorationIdentifier;
+    NibBenchmarkView* _superview;
+}
+@end
+
+@implementation NibBenchmarkView
+- (instancetype)initWithCoder:(NSCoder*)coder {
+    if (self = [super init]) {
+        NSData* bounds = [coder decodeObjectForKey:@"UIBounds"];
+        if ([bounds length] >= 1 + sizeof(float) * 4) {
+            float rect[4];
+            memcpy(rect, static_cast<const uint8_t*>([bounds bytes]) + 1, sizeof(rect));
+            _bounds = CGRectMake(rect[0], rect[1], rect[2], rect[3]);
+        }
+        NSData* center = [coder decodeObjectForKey:@"UICenter"];
+        if ([center length] >= 1 + sizeof(float) * 2) {
+            float point[2];
+            memcpy(point, static_cast<const uint8_t*>([center bytes]) + 1, sizeof(point));
+            _center = CGPointMake(point[0], point[1]);
+        }
+
+        _tag = [coder decodeIntegerForKey:@"UITag"];
+        _autoresizingMask = [coder decodeIntegerForKey:@"UIAutoresizingMask"];
+        _contentMode = [coder decodeIntegerForKey:@"UIContentMode"];
+        _alpha = [coder containsValueForKey:@"UIAlpha"] ? [coder decodeFloatForKey:@"UIAlpha"] : 1.0f;
+        _opaque = [coder decodeBoolForKey:@"UIOpaque"];
+        _hidden = [coder decodeBoolForKey:@"UIHidden"];
+        _clipsToBounds = [coder decodeBoolForKey:@"UIClipsToBounds"];
+        _userInteractionDisabled = [coder decodeBoolForKey:@"UIUserInteractionDisabled"];
+        _translatesAutoresizingMask = ![coder decodeBoolForKey:@"UIViewDoesNotTranslateAutoresizingMaskIntoConstraints"];
+        [coder decodeBoolForKey:@"UIMultipleTouchEnabled"];
+        [coder decodeIntegerForKey:@"UIViewSemanticContentAttribute"];
+        [coder decodeObjectForKey:@"UIViewContentHuggingPriority"];
+        [coder decodeObjectForKey:@"UIViewContentCompressionResistancePriority"];
+
+        _accessibilityLabel = [coder decodeObjectForKey:@"UIAccessibilityLabel"];
+        _restorationIdentifier = [coder decodeObjectForKey:@"UIRestorationIdentifier"];
+        _text = [coder decodeObjectForKey:@"UIText"];
+        _superview = [coder decodeObjectForKey:@"UISuperview"];
+        _subviews = [coder decodeObjectForKey:@"UISubviews"];
+    }
+    return self;
+}
+@end
+
+// Assembles a NIB archive the way xib2nib's NIBWriter lays it out.
+class NibBuilder {
+public:
+    NibBuilder() {
+        AddObject("NSObject");
+    }
+
+    uint32_t AddObject(const char* className) {
+        _objects.push_back({ _Intern(_classNames, className), {} });
+        return static_cast<uint32_t>(_objects.size() - 1);
+    }
+
+    void AddInt(uint32_t object, const char* key, int32_t value) {
+        _AddItem(object, key, 0x02, &value, sizeof(value));
+    }
+
+    void AddFloat(uint32_t object, const char* key, float value) {
+        _AddItem(object, key, 0x06, &value, sizeof(value));
+    }
+
+    void AddBool(uint32_t object, const char* key, bool value) {
+        _AddItem(object, key, value ? 0x05 : 0x04, nullptr, 0);
+    }
+
+    void AddReference(uint32_t object, const char* key, uint32_t target) {
+        _AddItem(object, key, 0x0A, &target, sizeof(target));
+    }
+
+    void AddFloats(uint32_t object, const char* key, std::initializer_list<float> values) {
+        std::vector<uint8_t> data(1, 6);
+        for (float value : values) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            data.insert(data.end(), bytes, bytes + sizeof(value));
+        }
+        _AddItem(object, key, 0x08, data.data(), data.size());
+    }
+
+    uint32_t AddString(const char* value) {
+        uint32_t string = AddObject("NSString");
+        _AddItem(string, "NS.bytes", 0x08, value, strlen(value));
+        return string;
+    }
+
+    uint32_t AddArray(const std::vector<uint32_t>& elements) {
+        uint32_t array = AddObject("NSArray");
+        for (uint32_t element : elements) {
+            AddReference(array, "UINibEncoderEmptyKey", element);
+        }
+        return array;
+    }
+
+    NSData* Data() {
+        std::vector<uint8_t> out(10 + 10 * sizeof(uint32_t));
+        memcpy(out.data(), "NIBArchive", 10);
+        uint32_t header[10] = {};
+
+        header[8] = static_cast<uint32_t>(_classNames.size());
+        header[9] = static_cast<uint32_t>(out.size());
+        for (const std::string& name : _classNames) {
+            size_t len = name.size() + 1;
+            _WriteInt(out, len, 2);
+            if (len == 0x1b) {
+                int32_t filler = 6;
+                _WriteBytes(out, &filler, sizeof(filler));
+            }
+            _WriteBytes(out, name.c_str(), len);
+        }
+
+        header[4] = static_cast<uint32_t>(_keyNames.size());
+        header[5] = static_cast<uint32_t>(out.size());
+        for (const std::string& name : _keyNames) {
+            _WriteInt(out, name.size() + 1, 1);
+            _WriteBytes(out, name.c_str(), name.size() + 1);
+        }
+
+        header[7] = static_cast<uint32_t>(out.size());
+        std::vector<size_t> firstItems;
+        size_t itemCount = 0;
+        for (const _Object& object : _objects) {
+            firstItems.push_back(itemCount);
+            for (const _Item& item : object.items) {
+                _WriteInt(out, item.key, 1);
+                out.push_back(item.type);
+                if (item.type == 0x08) {
+                    _WriteInt(out, item.data.size(), 1);
+                }
+                _WriteBytes(out, item.data.data(), item.data.size());
+                ++itemCount;
+            }
+        }
+        header[6] = static_cast<uint32_t>(itemCount);
+
+        header[3] = static_cast<uint32_t>(out.size());
+        for (size_t i = 0; i < _objects.size(); ++i) {
+            _WriteInt(out, _objects[i].className, 1);
+            _WriteInt(out, firstItems[i], 1);
+            _WriteInt(out, _objects[i].items.size(), 1);
+        }
+        header[2] = static_cast<uint32_t>(_objects.size());
+
+        memcpy(out.data() + 10, header, sizeof(header));
+        return [NSData dataWithBytes:out.data() length:out.size()];
+    }
+
+private:
+    struct _Item {
+        size_t key;
+        uint8_t type;
+        std::vector<uint8_t> data;
+    };
+
+    struct _Object {
+        size_t className;
+        std::vector<_Item> items;
+    };
+
+    static size_t _Intern(std::vector<std::string>& names, const char* name) {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) {
+                return i;
+            }
+        }
+        names.emplace_back(name);
+        return names.size() - 1;
+    }
+
+    static void _WriteInt(std::vector<uint8_t>& out, size_t value, int minimumLength) {
+        int len = 0;
+        while (value >= 0x80 || len < minimumLength - 1) {
+            out.push_back(static_cast<uint8_t>(value & 0x7F));
+            value >>= 7;
+            ++len;
+        }
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+    }
+
+    static void _WriteBytes(std::vector<uint8_t>& out, const void* bytes, size_t len) {
+        out.insert(out.end(), static_cast<const uint8_t*>(bytes), static_cast<const uint8_t*>(bytes) + len);
+    }
+
+    void _AddItem(uint32_t object, const char* key, uint8_t type, const void* data, size_t len) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        _objects[object].items.push_back({ _Intern(_keyNames, key), type, std::vector<uint8_t>(bytes, bytes + len) });
+    }
+
+    std::vector<std::string> _classNames;
+    std::vector<std::string> _keyNames;
+    std::vector<_Object> _objects;
+};
+
+static uint32_t _addView(NibBuilder& builder, uint32_t superview, int tag) {
+    uint32_t view = builder.AddObject("NibBenchmarkView");
+    builder.AddFloats(view, "UIBounds", { 0.0f, 0.0f, 320.0f, 44.0f });
+    builder.AddFloats(view, "UICenter", { 160.0f, 22.0f + tag * 44.0f });
+    builder.AddInt(view, "UITag", tag);
+    builder.AddInt(view, "UIAutoresizingMask", 18);
+    builder.AddInt(view, "UIContentMode", 4);
+    builder.AddFloat(view, "UIAlpha", 1.0f);
+    builder.AddBool(view, "UIOpaque", true);
+    builder.AddBool(view, "UIClipsToBounds", tag % 2 == 0);
+    builder.AddBool(view, "UIViewDoesNotTranslateAutoresizingMaskIntoConstraints", true);
+    builder.AddBool(view, "UIMultipleTouchEnabled", false);
+    builder.AddInt(view, "UIViewSemanticContentAttribute", 0);
+    if (superview != 0) {
+        builder.AddReference(view, "UISuperview", superview);
+        builder.AddReference(view, "UIText", builder.AddString("Label"));
+    }
+    return view;
+}
+
+static NSData* _createStoryboardNib() {
+    NibBuilder builder;
+
+    uint32_t owner = builder.AddObject("UIProxyObject");
+    builder.AddReference(owner, "UIProxiedObjectIdentifier", builder.AddString("IBFilesOwner"));
+
+    std::vector<uint32_t> topLevelObjects = { owner };
+    std::vector<uint32_t> allObjects = { owner };
+    std::vector<uint32_t> connections;
+
+    for (int scene = 0; scene < sc_sceneCount; ++scene) {
+        uint32_t root = _addView(builder, 0, 0);
+        topLevelObjects.push_back(root);
+        allObjects.push_back(root);
+
+        std::vector<uint32_t> subviews;
+        for (int i = 1; i <= sc_subviewsPerScene; ++i) {
+            uint32_t subview = _addView(builder, root, i);
+            subviews.push_back(subview);
+            allObjects.push_back(subview);
+
+            uint32_t connection = builder.AddObject("UIRuntimeOutletConnection");
+            builder.AddReference(connection, "UISource", owner);
+            builder.AddReference(connection, "UIDestination", subview);
+            builder.AddReference(connection, "UILabel", builder.AddString(("outlet" + std::to_string(connections.size())).c_str()));
+            connections.push_back(connection);
+        }
+        builder.AddReference(root, "UISubviews", builder.AddArray(subviews));
+    }
+
+    builder.AddReference(0, "UINibTopLevelObjectsKey", builder.AddArray(topLevelObjects));
+    builder.AddReference(0, "UINibObjectsKey", builder.AddArray(allObjects));
+    builder.AddReference(0, "UINibConnectionsKey", builder.AddArray(connections));
+    builder.AddReference(0, "UINibVisibleWindowsKey", builder.AddArray({}));
+    builder.AddReference(0, "UINibAccessibilityConfigurationsKey", builder.AddArray({}));
+    builder.AddReference(0, "UINibKeyValuePairsKey", builder.AddArray({}));
+
+    return builder.Data();
+}
+
+class InstantiateStoryboardNib : public ::benchmark::BenchmarkCaseBase {
+public:
+    InstantiateStoryboardNib() {
+        _nib = [UINib nibWithData:_createStoryboardNib() bundle:nil];
+    }
+
+    size_t GetRunCount() const {
+        return 10;
+    }
+
+    inline void Run() {
+        @autoreleasepool {
+            NSMutableDictionary* owner = [NSMutableDictionary dictionary];
+            [_nib instantiateWithOwner:owner options:nil];
+        }
+    }
+
+private:
+    StrongId<UINib> _nib;
+};
+
+BENCHMARK_F(UINib, InstantiateStoryboardNib);
@@ -0,0 +1,187 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <UIKit/UIKit.h>
+#import <Starboard/SmartTypes.h>
+#import <CppUtils.h>
+
+#import "Benchmark.h"
+#import "HeadlessCompositor.h"
+
+#include <mutex>
+#include <unordered_map>
+
+static constexpr NSInteger sc_rowCount = 10000;
+static constexpr CGFloat sc_rowHeight = 44.0f;
+static constexpr CGFloat sc_flingVelocity = 90.0f; // points per frame, about two rows
+static constexpr size_t sc_framesPerRun = 60;
+static constexpr size_t sc_thumbnailSize = 96;
+
+static NSString* const sc_cellIdentifier = @"Thumbnail";
+
+// Stands in for decoding a thumbnail: rasterizes a gradient one scanline at a time.
+static CGImageRef _CreateThumbnail(NSInteger row) {
+    auto colorSpace = woc::MakeStrongCF<CGColorSpaceRef>(CGColorSpaceCreateDeviceRGB());
+    auto context = woc::MakeStrongCF<CGContextRef>(
+        CGBitmapContextCreate(nullptr, sc_thumbnailSize, sc_thumbnailSize, 8, sc_thumbnailSize * 4, colorSpace, kCGImageAlphaPremultipliedLast));
+
+    for (size_t y = 0; y < sc_thumbnailSize; ++y) {
+        CGFloat t = y / static_cast<CGFloat>(sc_thumbnailSize);
+        CGContextSetRGBFillColor(context, t, (row % 7) / 7.0f, 1.0f - t, 1.0f);
+        CGContextFillRect(context, CGRectMake(0, y, sc_thumbnailSize, 1));
+    }
+
+    return CGBitmapContextCreateImage(context);
+}
+
+// A long list of thumbnail rows. Thumbnails are rendered on demand in cellForRowAtIndexPath: unless a prefetch has
+// already produced them on a background queue.
+@interface ThumbnailTableDataSource : NSObject <UITableViewDataSource, UITableViewDataSourcePrefetching> {
+    std::mutex _lock;
+    std::unordered_map<NSInteger, CGImageRef> _thumbnails;
+    StrongId<NSOperationQueue> _queue;
+}
+- (void)waitForPrefetches;
+@end
+
+@implementation ThumbnailTableDataSource
+- (instancetype)init {
+    if (self = [super init]) {
+        _queue.attach([NSOperationQueue new]);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self waitForPrefetches];
+    for (auto& entry : _thumbnails) {
+        CGImageRelease(entry.second);
+    }
+    [super dealloc];
+}
+
+- (void)waitForPrefetches {
+    [_queue waitUntilAllOperationsAreFinished];
+}
+
+- (CGImageRef)_takeThumbnailForRow:(NSInteger)row CF_RETURNS_RETAINED {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _thumbnails.find(row);
+        if (it != _thumbnails.end()) {
+            CGImageRef thumbnail = it->second;
+            _thumbnails.erase(it);
+            return thumbnail;
+        }
+    }
+    return _CreateThumbnail(row);
+}
+
+- (NSInteger)tableView:(UITableView*)tableView numberOfRowsInSection:(NSInteger)section {
+    return sc_rowCount;
+}
+
+- (UITableViewCell*)tableView:(UITableView*)tableView cellForRowAtIndexPath:(NSIndexPath*)indexPath {
+    UITableViewCell* cell = [tableView dequeueReusableCellWithIdentifier:sc_cellIdentifier];
+    if (cell == nil) {
+        cell = [[[UITableViewCell alloc] initWithStyle:UITableViewCellStyleDefault reuseIdentifier:sc_cellIdentifier] autorelease];
+    }
+
+    auto thumbnail = woc::MakeStrongCF<CGImageRef>([self _takeThumbnailForRow:indexPath.row]);
+    cell.imageView.image = [UIImage imageWithCGImage:thumbnail];
+    return cell;
+}
+
+- (void)tableView:(UITableView*)tableView prefetchRowsAtIndexPaths:(NSArray*)indexPaths {
+    for (NSIndexPath* indexPath in indexPaths) {
+        NSInteger row = indexPath.row;
+        [_queue addOperationWithBlock:^{
+            CGImageRef thumbnail = _CreateThumbnail(row);
+            std::lock_guard<std::mutex> lock(_lock);
+            if (!_thumbnails.emplace(row, thumbnail).second) {
+                CGImageRelease(thumbnail);
+            }
+        }];
+    }
+}
+
+- (void)tableView:(UITableView*)tableView cancelPrefetchingForRowsAtIndexPaths:(NSArray*)indexPaths {
+    std::lock_guard<std::mutex> lock(_lock);
+    for (NSIndexPath* indexPath in indexPaths) {
+        auto it = _thumbnails.find(indexPath.row);
+        if (it != _thumbnails.end()) {
+            CGImageRelease(it->second);
+            _thumbnails.erase(it);
+        }
+    }
+}
+@end
+
+// Flings a full-screen table at a constant speed, one layout pass per frame. The benchmark time divided by
+// sc_framesPerRun is the main-thread frame time.
+class UITableViewFlingBase : public ::benchmark::BenchmarkCaseBase {
+public:
+    UITableViewFlingBase(bool prefetch) {
+        static HeadlessCompositor s_compositor;
+        SetCACompositor(&s_compositor);
+
+        _dataSource.attach([ThumbnailTableDataSource new]);
+        _tableView.attach([[UITableView alloc] initWithFrame:CGRectMake(0, 0, 320, 568) style:UITableViewStylePlain]);
+        [_tableView setRowHeight:sc_rowHeight];
+        [_tableView setDataSource:_dataSource];
+        if (prefetch) {
+            [_tableView setPrefetchDataSource:_dataSource];
+        }
+        [_tableView reloadData];
+        _offset = 0.0f;
+    }
+
+    ~UITableViewFlingBase() {
+        [_dataSource waitForPrefetches];
+    }
+
+    size_t GetRunCount() const {
+        return 20;
+    }
+
+    inline void Run() {
+        for (size_t frame = 0; frame < sc_framesPerRun; ++frame) {
+            _offset += sc_flingVelocity;
+            [_tableView setContentOffset:CGPointMake(0, _offset)];
+        }
+    }
+
+private:
+    StrongId<ThumbnailTableDataSource> _dataSource;
+    StrongId<UITableView> _tableView;
+    CGFloat _offset;
+};
+
+class UITableViewFling : public UITableViewFlingBase {
+public:
+    UITableViewFling() : UITableViewFlingBase(false) {
+    }
+};
+
+BENCHMARK_F(UITableView, UITableViewFling);
+
+class UITableViewFlingWithPrefetching : public UITableViewFlingBase {
+public:
+    UITableViewFlingWithPrefetching() : UITableViewFlingBase(true) {
+    }
+};
+
+BENCHMARK_F(UITableView, UITableViewFlingWithPrefetching);
@@ -0,0 +1,519 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import <AudioUnit/AudioUnit.h>
+
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static const AudioComponentDescription c_mixerDescription = {
+    kAudioUnitType_Mixer, kAudioUnitSubType_MultiChannelMixer, kAudioUnitManufacturer_Apple, 0, 0
+};
+static const AudioComponentDescription c_outputDescription = {
+    kAudioUnitType_Output, kAudioUnitSubType_GenericOutput, kAudioUnitManufacturer_Apple, 0, 0
+};
+
+// Non-interleaved float buffers for rendering the graph offline.
+class RenderBuffer {
+public:
+    RenderBuffer(UInt32 channels, UInt32 frames)
+        : _list(new uint8_t[offsetof(AudioBufferList, mBuffers) + channels * sizeof(AudioBuffer)]), _samples(channels * frames) {
+        List()->mNumberBuffers = channels;
+        for (UInt32 channel = 0; channel < channels; ++channel) {
+            List()->mBuffers[channel].mNumberChannels = 1;
+            List()->mBuffers[channel].mDataByteSize = frames * sizeof(float);
+            List()->mBuffers[channel].mData = &_samples[channel * frames];
+        }
+    }
+
+    AudioBufferList* List() {
+        return reinterpret_cast<AudioBufferList*>(_list.get());
+    }
+
+    float Sample(UInt32 channel, UInt32 frame) {
+        return static_cast<float*>(List()->mBuffers[channel].mData)[frame];
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> _list;
+    std::vector<float> _samples;
+};
+
+// Fills every channel of every buffer with a constant.
+static OSStatus _constantSource(void* inRefCon,
+                                AudioUnitRenderActionFlags* ioActionFlags,
+                                const AudioTimeStamp* inTimeStamp,
+                                UInt32 inBusNumber,
+                                UInt32 inNumberFrames,
+                                AudioBufferList* ioData) {
+    float value = *static_cast<float*>(inRefCon);
+    for (UInt32 channel = 0; channel < ioData->mNumberBuffers; ++channel) {
+        float* samples = static_cast<float*>(ioData->mBuffers[channel].mData);
+        for (UInt32 frame = 0; frame < inNumberFrames; ++frame) {
+            samples[frame] = value;
+        }
+    }
+    return noErr;
+}
+
+static OSStatus _silentSource(void* inRefCon,
+                              AudioUnitRenderActionFlags* ioActionFlags,
+                              const AudioTimeStamp* inTimeStamp,
+                              UInt32 inBusNumber,
+                              UInt32 inNumberFrames,
+                              AudioBufferList* ioData) {
+    *ioActionFlags |= kAudioUnitRenderAction_OutputIsSilence;
+    return noErr;
+}
+
+static OSStatus _failingSource(void* inRefCon,
+                               AudioUnitRenderActionFlags* ioActionFlags,
+                               const AudioTimeStamp* inTimeStamp,
+                               UInt32 inBusNumber,
+                               UInt32 inNumberFrames,
+                               AudioBufferList* ioData) {
+    return kAudioUnitErr_NoConnection;
+}
+
+// Records the order render notifications arrive in.
+static OSStatus _recordNotify(void* inRefCon,
+                              AudioUnitRenderActionFlags* ioActionFlags,
+                              const AudioTimeStamp* inTimeStamp,
+                              UInt32 inBusNumber,
+                              UInt32 inNumberFrames,
+                              AudioBufferList* ioData) {
+    static_cast<std::vector<AudioUnitRenderActionFlags>*>(inRefCon)->push_back(*ioActionFlags);
+    return noErr;
+}
+
+// An opened graph of a mixer feeding the output unit.
+class MixerGraph {
+public:
+    MixerGraph() {
+        EXPECT_EQ(noErr, NewAUGraph(&graph));
+        EXPECT_EQ(noErr, AUGraphAddNode(graph, &c_mixerDescription, &mixerNode));
+        EXPECT_EQ(noErr, AUGraphAddNode(graph, &c_outputDescription, &outputNode));
+        EXPECT_EQ(noErr, AUGraphOpen(graph));
+        EXPECT_EQ(noErr, AUGraphNodeInfo(graph, mixerNode, nullptr, &mixer));
+        EXPECT_EQ(noErr, AUGraphNodeInfo(graph, outputNode, nullptr, &output));
+        EXPECT_EQ(noErr, AUGraphConnectNodeInput(graph, mixerNode, 0, outputNode, 0));
+    }
+
+    ~MixerGraph() {
+        DisposeAUGraph(graph);
+    }
+
+    OSStatus SetSource(UInt32 bus, AURenderCallback proc, void* refCon) {
+        AURenderCallbackStruct callback = { proc, refCon };
+        return AUGraphSetNodeInputCallback(graph, mixerNode, bus, &callback);
+    }
+
+    OSStatus Render(RenderBuffer& buffer, UInt32 frames) {
+        AudioUnitRenderActionFlags flags = 0;
+        AudioTimeStamp timeStamp = {};
+        return AudioUnitRender(output, &flags, &timeStamp, 0, frames, buffer.List());
+    }
+
+    AUGraph graph;
+    AUNode mixerNode;
+    AUNode outputNode;
+    AudioUnit mixer;
+    AudioUnit output;
+};
+
+TEST(AudioToolbox, AUGraphNodeLifecycle) {
+    AUGraph graph;
+    ASSERT_EQ(noErr, NewAUGraph(&graph));
+
+    AUNode mixerNode, outputNode, secondOutput;
+    AudioComponentDescription unsupported = { kAudioUnitType_Effect, 'rvb2', kAudioUnitManufacturer_Apple, 0, 0 };
+    EXPECT_EQ(kAUGraphErr_InvalidAudioUnit, AUGraphAddNode(graph, &unsupported, &mixerNode));
+    EXPECT_EQ(noErr, AUGraphAddNode(graph, &c_mixerDescription, &mixerNode));
+    EXPECT_EQ(noErr, AUGraphAddNode(graph, &c_outputDescription, &outputNode));
+    EXPECT_EQ(kAUGraphErr_OutputNodeErr, AUGraphAddNode(graph, &c_outputDescription, &secondOutput));
+
+    UInt32 count = 0;
+    EXPECT_EQ(noErr, AUGraphGetNodeCount(graph, &count));
+    EXPECT_EQ(2u, count);
+
+    AUNode node;
+    EXPECT_EQ(noErr, AUGraphGetIndNode(graph, 1, &node));
+    EXPECT_EQ(outputNode, node);
+    EXPECT_EQ(kAUGraphErr_NodeNotFound, AUGraphGetIndNode(graph, 2, &node));
+
+    // Units exist only while the graph is open.
+    AudioComponentDescription description;
+    AudioUnit unit = reinterpret_cast<AudioUnit>(1);
+    EXPECT_EQ(noErr, AUGraphNodeInfo(graph, mixerNode, &description, &unit));
+    EXPECT_EQ(kAudioUnitSubType_MultiChannelMixer, description.componentSubType);
+    EXPECT_EQ(nullptr, unit);
+
+    Boolean isOpen = true;
+    EXPECT_EQ(noErr, AUGraphIsOpen(graph, &isOpen));
+    EXPECT_FALSE(isOpen);
+    EXPECT_EQ(kAUGraphErr_CannotDoInCurrentContext, AUGraphInitialize(graph));
+
+    EXPECT_EQ(noErr, AUGraphOpen(graph));
+    EXPECT_EQ(noErr, AUGraphNodeInfo(graph, mixerNode, nullptr, &unit));
+    EXPECT_NE(nullptr, unit);
+
+    EXPECT_EQ(noErr, AUGraphConnectNodeInput(graph, mixerNode, 0, outputNode, 0));
+    Boolean flag = false;
+    EXPECT_EQ(noErr, AUGraphStart(graph));
+    EXPECT_EQ(noErr, AUGraphIsInitialized(graph, &flag));
+    EXPECT_TRUE(flag);
+    EXPECT_EQ(noErr, AUGraphIsRunning(graph, &flag));
+    EXPECT_TRUE(flag);
+
+    EXPECT_EQ(noErr, AUGraphStop(graph));
+    EXPECT_EQ(noErr, AUGraphIsRunning(graph, &flag));
+    EXPECT_FALSE(flag);
+
+    EXPECT_EQ(noErr, AUGraphClose(graph));
+    EXPECT_EQ(noErr, AUGraphIsInitialized(graph, &flag));
+    EXPECT_FALSE(flag);
+
+    EXPECT_EQ(noErr, AUGraphRemoveNode(graph, mixerNode));
+    EXPECT_EQ(kAUGraphErr_NodeNotFound, AUGraphRemoveNode(graph, mixerNode));
+    EXPECT_EQ(noErr, AUGraphGetNodeCount(graph, &count));
+    EXPECT_EQ(1u, count);
+
+    EXPECT_EQ(noErr, DisposeAUGraph(graph));
+}
+
+TEST(AudioToolbox, AUGraphRejectsInvalidConnections) {
+    MixerGraph graph;
+
+    AUNode secondMixer;
+    ASSERT_EQ(noErr, AUGraphAddNode(graph.graph, &c_mixerDescription, &secondMixer));
+
+    // The output unit cannot feed anything, units have one output bus, and an input takes one connection.
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphConnectNodeInput(graph.graph, graph.outputNode, 0, secondMixer, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphConnectNodeInput(graph.graph, secondMixer, 1, graph.mixerNode, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphConnectNodeInput(graph.graph, secondMixer, 0, graph.outputNode, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphConnectNodeInput(graph.graph, secondMixer, 0, secondMixer, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphConnectNodeInput(graph.graph, secondMixer, 0, graph.mixerNode, 8));
+    EXPECT_EQ(kAUGraphErr_NodeNotFound, AUGraphConnectNodeInput(graph.graph, 1234, 0, graph.mixerNode, 0));
+
+    // A cycle is only found when the graph is compiled.
+    EXPECT_EQ(noErr, AUGraphConnectNodeInput(graph.graph, secondMixer, 0, graph.mixerNode, 0));
+    EXPECT_EQ(noErr, AUGraphConnectNodeInput(graph.graph, graph.mixerNode, 0, secondMixer, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphInitialize(graph.graph));
+
+    EXPECT_EQ(noErr, AUGraphDisconnectNodeInput(graph.graph, secondMixer, 0));
+    EXPECT_EQ(kAUGraphErr_InvalidConnection, AUGraphDisconnectNodeInput(graph.graph, secondMixer, 0));
+    EXPECT_EQ(noErr, AUGraphInitialize(graph.graph));
+}
+
+TEST(AudioToolbox, AUGraphInteractions) {
+    MixerGraph graph;
+
+    float value = 0.5f;
+    ASSERT_EQ(noErr, graph.SetSource(0, _constantSource, &value));
+    ASSERT_EQ(noErr, graph.SetSource(1, _constantSource, &value));
+
+    UInt32 count = 0;
+    EXPECT_EQ(noErr, AUGraphGetNumberOfInteractions(graph.graph, &count));
+    EXPECT_EQ(3u, count);
+
+    AUNodeInteraction interaction;
+    EXPECT_EQ(noErr, AUGraphGetInteractionInfo(graph.graph, 0, &interaction));
+    EXPECT_EQ(kAUNodeInteraction_Connection, interaction.nodeInteractionType);
+    EXPECT_EQ(graph.mixerNode, interaction.nodeInteraction.connection.sourceNode);
+    EXPECT_EQ(graph.outputNode, interaction.nodeInteraction.connection.destNode);
+    EXPECT_EQ(kAudio_ParamError, AUGraphGetInteractionInfo(graph.graph, 3, &interaction));
+
+    EXPECT_EQ(noErr, AUGraphCountNodeInteractions(graph.graph, graph.mixerNode, &count));
+    EXPECT_EQ(3u, count);
+    EXPECT_EQ(noErr, AUGraphCountNodeInteractions(graph.graph, graph.outputNode, &count));
+    EXPECT_EQ(1u, count);
+
+    AUNodeInteraction interactions[2];
+    count = 2;
+    EXPECT_EQ(noErr, AUGraphGetNodeInteractions(graph.graph, graph.mixerNode, &count, interactions));
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(kAUNodeInteraction_InputCallback, interactions[1].nodeInteractionType);
+    EXPECT_EQ(0u, interactions[1].nodeInteraction.inputCallback.destInputNumber);
+    EXPECT_EQ(&value, interactions[1].nodeInteraction.inputCallback.cback.inputProcRefCon);
+
+    // A null callback disconnects the input.
+    EXPECT_EQ(noErr, graph.SetSource(1, nullptr, nullptr));
+    EXPECT_EQ(noErr, AUGraphGetNumberOfInteractions(graph.graph, &count));
+    EXPECT_EQ(2u, count);
+
+    EXPECT_EQ(noErr, AUGraphClearConnections(graph.graph));
+    EXPECT_EQ(noErr, AUGraphGetNumberOfInteractions(graph.graph, &count));
+    EXPECT_EQ(0u, count);
+}
+
+TEST(AudioToolbox, AUGraphMixesSourcesOffline) {
+    MixerGraph graph;
+
+    float first = 0.25f;
+    float second = 0.5f;
+    ASSERT_EQ(noErr, graph.SetSource(0, _constantSource, &first));
+    ASSERT_EQ(noErr, graph.SetSource(1, _constantSource, &second));
+    ASSERT_EQ(noErr, graph.SetSource(2, _silentSource, nullptr));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+
+    // Odd frame counts cover the vector loops' scalar tails.
+    const UInt32 frames = 515;
+    RenderBuffer buffer(2, frames);
+    ASSERT_EQ(noErr, graph.Render(buffer, frames));
+    for (UInt32 frame = 0; frame < frames; ++frame) {
+        ASSERT_FLOAT_EQ(0.75f, buffer.Sample(0, frame));
+        ASSERT_FLOAT_EQ(0.75f, buffer.Sample(1, frame));
+    }
+
+    // Parameters apply to the next buffer without an update.
+    EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Volume, kAudioUnitScope_Input, 1, 0.5f, 0));
+    EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Input, 0, -1.0f, 0));
+    EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Volume, kAudioUnitScope_Output, 0, 2.0f, 0));
+    ASSERT_EQ(noErr, graph.Render(buffer, frames));
+    EXPECT_FLOAT_EQ(2.0f * (0.25f + 0.25f), buffer.Sample(0, 0));
+    EXPECT_FLOAT_EQ(2.0f * 0.25f, buffer.Sample(1, frames - 1));
+
+    AudioUnitParameterValue pan = 0;
+    EXPECT_EQ(noErr, AudioUnitGetParameter(graph.mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Input, 0, &pan));
+    EXPECT_EQ(-1.0f, pan);
+
+    EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Enable, kAudioUnitScope_Input, 0, 0.0f, 0));
+    EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Enable, kAudioUnitScope_Input, 1, 0.0f, 0));
+    ASSERT_EQ(noErr, graph.Render(buffer, frames));
+    EXPECT_EQ(0.0f, buffer.Sample(0, 7));
+    EXPECT_EQ(0.0f, buffer.Sample(1, 7));
+
+    EXPECT_EQ(kAudioUnitErr_InvalidElement,
+              AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Volume, kAudioUnitScope_Input, 8, 1.0f, 0));
+    EXPECT_EQ(kAudioUnitErr_InvalidParameter,
+              AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Output, 0, 1.0f, 0));
+}
+
+TEST(AudioToolbox, AUGraphMixesMonoIntoStereo) {
+    MixerGraph graph;
+
+    AudioStreamBasicDescription format;
+    UInt32 size = sizeof(format);
+    ASSERT_EQ(noErr, AudioUnitGetProperty(graph.mixer, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &format, &size));
+    EXPECT_EQ(2u, format.mChannelsPerFrame);
+    EXPECT_TRUE(format.mFormatFlags & kAudioFormatFlagIsNonInterleaved);
+
+    format.mChannelsPerFrame = 1;
+    ASSERT_EQ(noErr, AudioUnitSetProperty(graph.mixer, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &format, sizeof(format)));
+
+    AudioStreamBasicDescription interleaved = format;
+    interleaved.mFormatFlags &= ~kAudioFormatFlagIsNonInterleaved;
+    EXPECT_EQ(kAudioUnitErr_FormatNotSupported,
+              AudioUnitSetProperty(
+                  graph.mixer, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 1, &interleaved, sizeof(interleaved)));
+
+    float value = 0.5f;
+    ASSERT_EQ(noErr, graph.SetSource(0, _constantSource, &value));
+    ASSERT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Input, 0, 0.5f, 0));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+
+    // Formats are fixed while the graph is initialized.
+    EXPECT_EQ(kAudioUnitErr_Initialized,
+              AudioUnitSetProperty(graph.mixer, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &format, sizeof(format)));
+
+    RenderBuffer buffer(2, 64);
+    ASSERT_EQ(noErr, graph.Render(buffer, 64));
+    EXPECT_FLOAT_EQ(0.25f, buffer.Sample(0, 63));
+    EXPECT_FLOAT_EQ(0.5f, buffer.Sample(1, 63));
+}
+
+TEST(AudioToolbox, AUGraphSchedulesChainsInDependencyOrder) {
+    MixerGraph graph;
+
+    // Three mixers in a chain, added in the opposite order to the one they render in.
+    AUNode last, middle, first;
+    ASSERT_EQ(noErr, AUGraphAddNode(graph.graph, &c_mixerDescription, &last));
+    ASSERT_EQ(noErr, AUGraphAddNode(graph.graph, &c_mixerDescription, &middle));
+    ASSERT_EQ(noErr, AUGraphAddNode(graph.graph, &c_mixerDescription, &first));
+    ASSERT_EQ(noErr, AUGraphConnectNodeInput(graph.graph, last, 0, graph.mixerNode, 0));
+    ASSERT_EQ(noErr, AUGraphConnectNodeInput(graph.graph, middle, 0, last, 0));
+    ASSERT_EQ(noErr, AUGraphConnectNodeInput(graph.graph, first, 0, middle, 0));
+
+    float value = 0.125f;
+    AURenderCallbackStruct callback = { _constantSource, &value };
+    ASSERT_EQ(noErr, AUGraphSetNodeInputCallback(graph.graph, first, 0, &callback));
+
+    AudioUnit firstUnit, lastUnit;
+    ASSERT_EQ(noErr, AUGraphNodeInfo(graph.graph, first, nullptr, &firstUnit));
+    ASSERT_EQ(noErr, AUGraphNodeInfo(graph.graph, last, nullptr, &lastUnit));
+    ASSERT_EQ(noErr, AudioUnitSetParameter(firstUnit, kMultiChannelMixerParam_Volume, kAudioUnitScope_Output, 0, 2.0f, 0));
+    ASSERT_EQ(noErr, AudioUnitSetParameter(lastUnit, kMultiChannelMixerParam_Volume, kAudioUnitScope_Output, 0, 2.0f, 0));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+
+    RenderBuffer buffer(2, 256);
+    ASSERT_EQ(noErr, graph.Render(buffer, 256));
+    EXPECT_FLOAT_EQ(0.5f, buffer.Sample(0, 0));
+    EXPECT_FLOAT_EQ(0.5f, buffer.Sample(1, 255));
+
+    // Errors from a source stop the render.
+    callback.inputProc = _failingSource;
+    ASSERT_EQ(noErr, AUGraphSetNodeInputCallback(graph.graph, first, 0, &callback));
+    ASSERT_EQ(noErr, AUGraphUpdate(graph.graph, nullptr));
+    EXPECT_EQ(kAudioUnitErr_NoConnection, graph.Render(buffer, 256));
+}
+
+TEST(AudioToolbox, AUGraphAppliesEditsOnUpdate) {
+    MixerGraph graph;
+
+    float first = 0.25f;
+    float second = 0.5f;
+    ASSERT_EQ(noErr, graph.SetSource(0, _constantSource, &first));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+
+    RenderBuffer buffer(2, 128);
+    ASSERT_EQ(noErr, graph.Render(buffer, 128));
+    EXPECT_FLOAT_EQ(0.25f, buffer.Sample(0, 0));
+
+    // Graph edits wait for AUGraphUpdate.
+    ASSERT_EQ(noErr, graph.SetSource(1, _constantSource, &second));
+    ASSERT_EQ(noErr, graph.Render(buffer, 128));
+    EXPECT_FLOAT_EQ(0.25f, buffer.Sample(0, 0));
+
+    Boolean updated = false;
+    ASSERT_EQ(noErr, AUGraphUpdate(graph.graph, &updated));
+    EXPECT_TRUE(updated);
+    ASSERT_EQ(noErr, graph.Render(buffer, 128));
+    EXPECT_FLOAT_EQ(0.75f, buffer.Sample(0, 0));
+
+    // A render callback set through the unit takes effect at once.
+    AURenderCallbackStruct callback = { _constantSource, &second };
+    ASSERT_EQ(noErr,
+              AudioUnitSetProperty(
+                  graph.mixer, kAudioUnitProperty_SetRenderCallback, kAudioUnitScope_Input, 0, &callback, sizeof(callback)));
+    ASSERT_EQ(noErr, graph.Render(buffer, 128));
+    EXPECT_FLOAT_EQ(1.0f, buffer.Sample(1, 127));
+
+    // Several updates between renders leave only the newest schedule.
+    ASSERT_EQ(noErr, AUGraphDisconnectNodeInput(graph.graph, graph.mixerNode, 0));
+    ASSERT_EQ(noErr, AUGraphUpdate(graph.graph, nullptr));
+    ASSERT_EQ(noErr, AUGraphDisconnectNodeInput(graph.graph, graph.mixerNode, 1));
+    ASSERT_EQ(noErr, AUGraphUpdate(graph.graph, nullptr));
+    ASSERT_EQ(noErr, graph.Render(buffer, 128));
+    EXPECT_EQ(0.0f, buffer.Sample(0, 0));
+}
+
+TEST(AudioToolbox, AUGraphRenderErrors) {
+    MixerGraph graph;
+
+    RenderBuffer buffer(2, 8192);
+    EXPECT_EQ(kAudioUnitErr_Uninitialized, graph.Render(buffer, 512));
+
+    UInt32 maximumFrames = 1024;
+    UInt32 size = sizeof(maximumFrames);
+    ASSERT_EQ(noErr,
+              AudioUnitSetProperty(
+                  graph.output, kAudioUnitProperty_MaximumFramesPerSlice, kAudioUnitScope_Global, 0, &maximumFrames, size));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+    EXPECT_EQ(kAudioUnitErr_TooManyFramesToProcess, graph.Render(buffer, 1025));
+    EXPECT_EQ(noErr, graph.Render(buffer, 1024));
+
+    // Only the output unit can be pulled.
+    AudioUnitRenderActionFlags flags = 0;
+    AudioTimeStamp timeStamp = {};
+    EXPECT_EQ(kAudioUnitErr_CannotDoInCurrentContext, AudioUnitRender(graph.mixer, &flags, &timeStamp, 0, 512, buffer.List()));
+
+    // Leaving mData empty renders into the graph's own buffers.
+    RenderBuffer empty(2, 512);
+    empty.List()->mBuffers[0].mData = nullptr;
+    empty.List()->mBuffers[1].mData = nullptr;
+    EXPECT_EQ(noErr, graph.Render(empty, 512));
+    EXPECT_NE(nullptr, empty.List()->mBuffers[0].mData);
+
+    ASSERT_EQ(noErr, AUGraphUninitialize(graph.graph));
+    EXPECT_EQ(kAudioUnitErr_Uninitialized, graph.Render(buffer, 512));
+}
+
+TEST(AudioToolbox, AUGraphRenderNotifyAndCPULoad) {
+    MixerGraph graph;
+
+    std::vector<AudioUnitRenderActionFlags> notifies;
+    ASSERT_EQ(noErr, AUGraphAddRenderNotify(graph.graph, _recordNotify, &notifies));
+    ASSERT_EQ(noErr, AUGraphInitialize(graph.graph));
+
+    RenderBuffer buffer(2, 512);
+    ASSERT_EQ(noErr, graph.Render(buffer, 512));
+    ASSERT_EQ(2u, notifies.size());
+    EXPECT_EQ(static_cast<AudioUnitRenderActionFlags>(kAudioUnitRenderAction_PreRender), notifies[0]);
+    EXPECT_EQ(static_cast<AudioUnitRenderActionFlags>(kAudioUnitRenderAction_PostRender), notifies[1]);
+
+    ASSERT_EQ(noErr, AUGraphRemoveRenderNotify(graph.graph, _recordNotify, &notifies));
+    EXPECT_EQ(kAudio_ParamError, AUGraphRemoveRenderNotify(graph.graph, _recordNotify, &notifies));
+    ASSERT_EQ(noErr, graph.Render(buffer, 512));
+    EXPECT_EQ(2u, notifies.size());
+
+    Float32 load = -1.0f;
+    EXPECT_EQ(noErr, AUGraphGetCPULoad(graph.graph, &load));
+    EXPECT_GT(load, 0.0f);
+
+    Float32 maximum = -1.0f;
+    EXPECT_EQ(noErr, AUGraphGetMaxCPULoad(graph.graph, &maximum));
+    EXPECT_GE(maximum, load);
+
+    // Reading the maximum resets it.
+    EXPECT_EQ(noErr, AUGraphGetMaxCPULoad(graph.graph, &maximum));
+    EXPECT_EQ(0.0f, maximum);
+}
+
+TEST(AudioToolbox, AUGraphUpdatesWhileRendering) {
+    MixerGraph graph;
+
+    float value = 0.25f;
+    ASSERT_EQ(noErr, graph.SetSource(0, _constantSource, &value));
+    ASSERT_EQ(noErr, AUGraphStart(graph.graph));
+
+    // Every buffer holds either one or two sources, never a mix of the two schedules.
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::thread renderer([&]() {
+        RenderBuffer buffer(2, 256);
+        while (!done.load()) {
+            if (graph.Render(buffer, 256) != noErr) {
+                ++failures;
+                continue;
+            }
+            float first = buffer.Sample(0, 0);
+            if ((first != 0.25f && first != 0.5f) || buffer.Sample(1, 255) != first) {
+                ++failures;
+            }
+        }
+    });
+
+    for (int i = 0; i < 500; ++i) {
+        if (i % 2) {
+            EXPECT_EQ(noErr, AUGraphDisconnectNodeInput(graph.graph, graph.mixerNode, 1));
+        } else {
+            EXPECT_EQ(noErr, graph.SetSource(1, _constantSource, &value));
+        }
+        EXPECT_EQ(noErr, AUGraphUpdate(graph.graph, nullptr));
+        EXPECT_EQ(noErr, AudioUnitSetParameter(graph.mixer, kMultiChannelMixerParam_Pan, kAudioUnitScope_Input, 0, 0.0f, 0));
+    }
+
+    done = true;
+    renderer.join();
+    EXPECT_EQ(0, failures.load());
+    EXPECT_EQ(noErr, AUGraphStop(graph.graph));
+}
@@ -18,62 +18,406 @@
 #include <TestFramework.h>
 #import <Foundation/Foundation.h>
 #import <AudioToolbox/AudioToolbox.h>
-#import <StubReturn.h>
-#import <NSBundleInternal.h>
-#import <NSLogging.h>
 
-static const wchar_t* TAG = L"AudioConverterTest";
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
 
-#import <AudioToolbox/AudioConverterInternal.h>
+static AudioStreamBasicDescription _makeFormat(double sampleRate, UInt32 channels, UInt32 bits, UInt32 flags) {
+    AudioStreamBasicDescription format = {};
+    format.mSampleRate = sampleRate;
+    format.mFormatID = kAudioFormatLinearPCM;
+    format.mFormatFlags = flags | kAudioFormatFlagIsPacked;
+    format.mFramesPerPacket = 1;
+    format.mChannelsPerFrame = channels;
+    format.mBitsPerChannel = bits;
+    format.mBytesPerFrame = (flags & kAudioFormatFlagIsNonInterleaved) ? bits / 8 : channels * bits / 8;
+    format.mBytesPerPacket = format.mBytesPerFrame;
+    return format;
+}
 
+static AudioStreamBasicDescription _int16Format(double sampleRate, UInt32 channels) {
+    return _makeFormat(sampleRate, channels, 16, kAudioFormatFlagIsSignedInteger);
+}
+
+static AudioStreamBasicDescription _floatFormat(double sampleRate, UInt32 channels) {
+    return _makeFormat(sampleRate, channels, 32, kAudioFormatFlagIsFloat);
+}
+
+static OSStatus _newConverter(const AudioStreamBasicDescription& source,
+                              const AudioStreamBasicDescription& destination,
+                              AudioConverterRef* converter) {
+    return AudioConverterNew(&source, &destination, converter);
+}
+
+template <typename Output, typename Input>
+static std::vector<Output> _convert(const AudioStreamBasicDescription& source,
+                                    const AudioStreamBasicDescription& destination,
+                                    const std::vector<Input>& input,
+                                    UInt32 quality = kAudioConverterQuality_Medium) {
+    AudioConverterRef converter = nullptr;
+    EXPECT_EQ(noErr, AudioConverterNew(&source, &destination, &converter));
+    EXPECT_EQ(noErr, AudioConverterSetProperty(converter, kAudioConverterSampleRateConverterQuality, sizeof(quality), &quality));
+
+    UInt32 outputSize = input.size() * sizeof(Input);
+    UInt32 propertySize = sizeof(outputSize);
+    EXPECT_EQ(noErr, AudioConverterGetProperty(converter, kAudioConverterPropertyCalculateOutputBufferSize, &propertySize, &outputSize));
+
+    std::vector<Output> output(outputSize / sizeof(Output));
+    EXPECT_EQ(noErr, AudioConverterConvertBuffer(converter, input.size() * sizeof(Input), input.data(), &outputSize, output.data()));
+    output.resize(outputSize / sizeof(Output));
+
+    AudioConverterDispose(converter);
+    return output;
+}
 
 TEST(AudioToolbox, AudioConverterTest) {
-    AudioStreamBasicDescription inFormat;
-    inFormat.mSampleRate = 44100;
-    inFormat.mFormatID = kAudioFormatLinearPCM;
-    inFormat.mFormatFlags = (kAudioFormatFlagIsPacked | kAudioFormatFlagIsSignedInteger);
-    inFormat.mBytesPerPacket = 4;
-    inFormat.mFramesPerPacket = 1;
-    inFormat.mBytesPerFrame = 4;
-    inFormat.mChannelsPerFrame = 2;
-    inFormat.mBitsPerChannel = 16;
-    inFormat.mReserved = 0;
-
-    AudioStreamBasicDescription outFormat;
-    outFormat.mSampleRate = 44100;
-    outFormat.mFormatID = kAudioFormatLinearPCM;
-    outFormat.mFormatFlags = (kAudioFormatFlagIsPacked | kAudioFormatFlagIsFloat);
-    outFormat.mBytesPerPacket = 8;
-    outFormat.mFramesPerPacket = 1;
-    outFormat.mBytesPerFrame = 8;
-    outFormat.mChannelsPerFrame = 2;
-    outFormat.mBitsPerChannel = 32;
-    outFormat.mReserved = 0;
+    AudioStreamBasicDescription inFormat = _int16Format(44100, 2);
+    AudioStreamBasicDescription outFormat = _floatFormat(44100, 2);
 
     AudioConverterRef converter;
-    OSStatus err = noErr;
-    err = AudioConverterNew(&inFormat, &outFormat, &converter);
+    OSStatus err = AudioConverterNew(&inFormat, &outFormat, &converter);
     ASSERT_EQ(err, 0);
 
-    DWORD flag = MF_MEDIATYPE_EQUAL_FORMAT_USER_DATA;
-    DWORD streamID = 0;
-    ComPtr<IMFTransform> mediaTransform = [(__bridge AudioConverter*)converter getTransform];
-
-    ComPtr<IMFMediaType> expectedInMediaType = nullptr;
-    _setMFProperties(&inFormat, &expectedInMediaType);
-    ComPtr<IMFMediaType> resInMediaType = nullptr;
-    mediaTransform->GetInputCurrentType(streamID, &resInMediaType);
-    HRESULT hr = resInMediaType->IsEqual(expectedInMediaType.Get(), &flag);
-    HRESULT hrExpected = S_OK;
-    ASSERT_EQ(hr, hrExpected);
-
-    ComPtr<IMFMediaType> expectedOutMediaType = nullptr;
-    _setMFProperties(&outFormat, &expectedOutMediaType);
-    ComPtr<IMFMediaType> resOutMediaType = nullptr;
-    mediaTransform->GetOutputCurrentType(streamID, &resOutMediaType);
-    hr = resOutMediaType->IsEqual(expectedOutMediaType.Get(), &flag);
-    ASSERT_EQ(hr, hrExpected);
+    AudioStreamBasicDescription current;
+    UInt32 size = sizeof(current);
+    ASSERT_EQ(noErr, AudioConverterGetProperty(converter, kAudioConverterCurrentInputStreamDescription, &size, &current));
+    EXPECT_EQ(0, memcmp(&inFormat, &current, sizeof(current)));
+    ASSERT_EQ(noErr, AudioConverterGetProperty(converter, kAudioConverterCurrentOutputStreamDescription, &size, &current));
+    EXPECT_EQ(0, memcmp(&outFormat, &current, sizeof(current)));
+
+    std::vector<int16_t> input;
+    for (int i = 0; i < 1001; ++i) {
+        input.push_back(static_cast<int16_t>(i * 65 - 32768));
+        input.push_back(static_cast<int16_t>(32767 - i * 31));
+    }
+
+    std::vector<float> output(input.size());
+    UInt32 outputSize = output.size() * sizeof(float);
+    ASSERT_EQ(noErr, AudioConverterConvertBuffer(converter, input.size() * sizeof(int16_t), input.data(), &outputSize, output.data()));
+    ASSERT_EQ(output.size() * sizeof(float), outputSize);
+    for (size_t i = 0; i < input.size(); ++i) {
+        ASSERT_EQ(input[i] / 32768.0f, output[i]);
+    }
+
+    outputSize = sizeof(float);
+    EXPECT_EQ(kAudioConverterErr_InvalidOutputSize,
+              AudioConverterConvertBuffer(converter, input.size() * sizeof(int16_t), input.data(), &outputSize, output.data()));
 
     err = AudioConverterDispose(converter);
     ASSERT_EQ(err, 0);
-}
\ No newline at end of file
+}
+
+TEST(AudioConverter, FloatToInt16RoundsAndClips) {
+    std::vector<float> input = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f, 1.5f / 32768, 2.5f / 32768, -0.4f / 32768, 0.25f };
+    std::vector<int16_t> expected = { 0, 16384, -16384, 32767, -32768, 32767, -32768, 2, 2, 0, 8192 };
+
+    EXPECT_EQ(expected, (_convert<int16_t>(_floatFormat(8000, 1), _int16Format(8000, 1), input)));
+}
+
+TEST(AudioConverter, BitDepthsAndByteOrders) {
+    std::vector<int16_t> input;
+    for (int i = -32768; i < 32768; i += 97) {
+        input.push_back(static_cast<int16_t>(i));
+    }
+
+    // 16-bit widens exactly into big-endian 24-bit and 64-bit float, and back.
+    AudioStreamBasicDescription int24 = _makeFormat(8000, 1, 24, kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsBigEndian);
+    std::vector<uint8_t> wide = _convert<uint8_t>(_int16Format(8000, 1), int24, input);
+    ASSERT_EQ(input.size() * 3, wide.size());
+    EXPECT_EQ(static_cast<uint8_t>(input[1] >> 8), wide[3]);
+    EXPECT_EQ(static_cast<uint8_t>(input[1]), wide[4]);
+    EXPECT_EQ(0, wide[5]);
+    EXPECT_EQ(input, (_convert<int16_t>(int24, _int16Format(8000, 1), wide)));
+
+    AudioStreamBasicDescription float64 = _makeFormat(8000, 1, 64, kAudioFormatFlagIsFloat);
+    EXPECT_EQ(input, (_convert<int16_t>(float64, _int16Format(8000, 1), _convert<double>(_int16Format(8000, 1), float64, input))));
+
+    // Unsigned 8-bit centers on 128.
+    std::vector<uint8_t> unsigned8 = { 0, 64, 128, 255 };
+    std::vector<int16_t> expected = { -32768, -16384, 0, 32512 };
+    EXPECT_EQ(expected, (_convert<int16_t>(_makeFormat(8000, 1, 8, 0), _int16Format(8000, 1), unsigned8)));
+}
+
+TEST(AudioConverter, ConvertComplexBufferDeinterleaves) {
+    const UInt32 frames = 333;
+    std::vector<int16_t> input(frames * 2);
+    for (UInt32 i = 0; i < frames; ++i) {
+        input[2 * i] = static_cast<int16_t>(i * 100);
+        input[2 * i + 1] = static_cast<int16_t>(-static_cast<int>(i) * 50);
+    }
+
+    AudioStreamBasicDescription planar = _makeFormat(44100, 2, 32, kAudioFormatFlagIsFloat | kAudioFormatFlagIsNonInterleaved);
+    AudioConverterRef converter;
+    ASSERT_EQ(noErr, _newConverter(_int16Format(44100, 2), planar, &converter));
+
+    AudioBufferList inputList = { 1, { { 2, static_cast<UInt32>(input.size() * sizeof(int16_t)), input.data() } } };
+
+    std::vector<float> left(frames);
+    std::vector<float> right(frames);
+    std::vector<uint8_t> outputStorage(offsetof(AudioBufferList, mBuffers) + 2 * sizeof(AudioBuffer));
+    AudioBufferList* outputList = reinterpret_cast<AudioBufferList*>(outputStorage.data());
+    outputList->mNumberBuffers = 2;
+    outputList->mBuffers[0] = { 1, frames * sizeof(float), left.data() };
+    outputList->mBuffers[1] = { 1, frames * sizeof(float), right.data() };
+
+    ASSERT_EQ(noErr, AudioConverterConvertComplexBuffer(converter, frames, &inputList, outputList));
+    for (UInt32 i = 0; i < frames; ++i) {
+        ASSERT_EQ(input[2 * i] / 32768.0f, left[i]);
+        ASSERT_EQ(input[2 * i + 1] / 32768.0f, right[i]);
+    }
+
+    AudioConverterDispose(converter);
+}
+
+TEST(AudioConverter, ChannelMixing) {
+    std::vector<float> mono = { 0.5f, -0.25f };
+    std::vector<float> duplicated = { 0.5f, 0.5f, -0.25f, -0.25f };
+    EXPECT_EQ(duplicated, (_convert<float>(_floatFormat(8000, 1), _floatFormat(8000, 2), mono)));
+
+    std::vector<float> stereo = { 0.5f, 0.25f, -1.0f, 0.0f };
+    std::vector<float> averaged = { 0.375f, -0.5f };
+    EXPECT_EQ(averaged, (_convert<float>(_floatFormat(8000, 2), _floatFormat(8000, 1), stereo)));
+
+    AudioConverterRef converter;
+    ASSERT_EQ(noErr, _newConverter(_floatFormat(8000, 2), _floatFormat(8000, 3), &converter));
+    SInt32 map[] = { 1, -1, 0 };
+    ASSERT_EQ(noErr, AudioConverterSetProperty(converter, kAudioConverterChannelMap, sizeof(map), map));
+
+    float output[6];
+    UInt32 outputSize = sizeof(output);
+    ASSERT_EQ(noErr, AudioConverterConvertBuffer(converter, stereo.size() * sizeof(float), stereo.data(), &outputSize, output));
+    float expected[] = { 0.25f, 0.0f, 0.5f, 0.0f, 0.0f, -1.0f };
+    EXPECT_EQ(0, memcmp(expected, output, sizeof(expected)));
+
+    AudioConverterDispose(converter);
+}
+
+TEST(AudioConverter, RejectsUnsupportedFormats) {
+    AudioConverterRef converter = nullptr;
+    AudioStreamBasicDescription unpacked = _int16Format(44100, 2);
+    unpacked.mBitsPerChannel = 12;
+    EXPECT_EQ(kAudioConverterErr_FormatNotSupported, _newConverter(unpacked, _floatFormat(44100, 2), &converter));
+
+    AudioStreamBasicDescription floatInt16 = _makeFormat(44100, 1, 16, kAudioFormatFlagIsFloat);
+    EXPECT_EQ(kAudioConverterErr_FormatNotSupported, _newConverter(floatInt16, _floatFormat(44100, 1), &converter));
+}
+
+//
+// Sample rate conversion
+//
+
+static std::vector<float> _sine(double frequency, double sampleRate, size_t frames) {
+    std::vector<float> samples(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        samples[i] = static_cast<float>(0.5 * sin(2 * M_PI * frequency * i / sampleRate));
+    }
+    return samples;
+}
+
+// Fits a sine of the given frequency to the middle of the signal and returns the residual relative to it, in dB.
+static double _thdPlusNoise(const std::vector<float>& signal, double frequency, double sampleRate) {
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+    size_t begin = signal.size() / 8;
+    size_t end = signal.size() - begin;
+    for (size_t i = begin; i < end; ++i) {
+        double s = sin(2 * M_PI * frequency * i / sampleRate);
+        double c = cos(2 * M_PI * frequency * i / sampleRate);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += signal[i] * s;
+        yc += signal[i] * c;
+    }
+
+    double determinant = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / determinant;
+    double b = (yc * ss - ys * sc) / determinant;
+
+    double fitted = 0;
+    double residual = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double model = a * sin(2 * M_PI * frequency * i / sampleRate) + b * cos(2 * M_PI * frequency * i / sampleRate);
+        fitted += model * model;
+        residual += (signal[i] - model) * (signal[i] - model);
+    }
+    return 10 * log10(residual / fitted);
+}
+
+static double _rmsDecibels(const std::vector<float>& signal) {
+    double sum = 0;
+    size_t begin = signal.size() / 8;
+    for (size_t i = begin; i < signal.size() - begin; ++i) {
+        sum += signal[i] * signal[i];
+    }
+    return 10 * log10(sum / (signal.size() - 2 * begin));
+}
+
+static double _resampledThdPlusNoise(double inputRate, double outputRate, double frequency, UInt32 quality) {
+    std::vector<float> input = _sine(frequency, inputRate, 20000);
+    std::vector<float> output = _convert<float>(_floatFormat(inputRate, 1), _floatFormat(outputRate, 1), input, quality);
+    EXPECT_EQ(static_cast<size_t>(ceil(input.size() * outputRate / inputRate)), output.size());
+    return _thdPlusNoise(output, frequency, outputRate);
+}
+
+TEST(AudioConverter, ResamplerTHDPlusNoise) {
+    struct Case {
+        UInt32 quality;
+        double limit;
+    } cases[] = { { kAudioConverterQuality_Min, -55 },
+                  { kAudioConverterQuality_Low, -65 },
+                  { kAudioConverterQuality_Medium, -78 },
+                  { kAudioConverterQuality_High, -88 },
+                  { kAudioConverterQuality_Max, -100 } };
+
+    for (const Case& c : cases) {
+        EXPECT_LT(_resampledThdPlusNoise(44100, 48000, 1000, c.quality), c.limit) << "Quality " << c.quality;
+        EXPECT_LT(_resampledThdPlusNoise(48000, 44100, 1000, c.quality), c.limit) << "Quality " << c.quality;
+        EXPECT_LT(_resampledThdPlusNoise(22050, 44100, 5000, c.quality), c.limit) << "Quality " << c.quality;
+    }
+
+    // Quality is a trade, so more of it must not measure worse.
+    EXPECT_LT(_resampledThdPlusNoise(44100, 48000, 15000, kAudioConverterQuality_High),
+              _resampledThdPlusNoise(44100, 48000, 15000, kAudioConverterQuality_Min));
+}
+
+TEST(AudioConverter, ResamplerRejectsAliases) {
+    // 12 kHz is above the Nyquist frequency of 16 kHz output, so it has to be filtered out rather than fold down to 4 kHz.
+    std::vector<float> input = _sine(12000, 48000, 24000);
+    std::vector<float> output = _convert<float>(_floatFormat(48000, 1), _floatFormat(16000, 1), input, kAudioConverterQuality_High);
+    EXPECT_LT(_rmsDecibels(output) - _rmsDecibels(input), -70);
+
+    std::vector<float> passband = _convert<float>(_floatFormat(48000, 1), _floatFormat(16000, 1), _sine(1000, 48000, 24000));
+    EXPECT_NEAR(_rmsDecibels(passband) - _rmsDecibels(input), 0, 0.01);
+
+    // At a larger ratio the filter has to widen to keep the transition band as narrow: 6 kHz lies only 2 kHz above the
+    // Nyquist frequency of 8 kHz output.
+    input = _sine(6000, 48000, 48000);
+    output = _convert<float>(_floatFormat(48000, 1), _floatFormat(8000, 1), input, kAudioConverterQuality_High);
+    EXPECT_LT(_rmsDecibels(output) - _rmsDecibels(input), -70);
+}
+
+TEST(AudioConverter, LinearComplexityInterpolates) {
+    AudioConverterRef converter;
+    ASSERT_EQ(noErr, _newConverter(_floatFormat(1000, 1), _floatFormat(4000, 1), &converter));
+    UInt32 complexity = kAudioConverterSampleRateConverterComplexity_Linear;
+    ASSERT_EQ(noErr, AudioConverterSetProperty(converter, kAudioConverterSampleRateConverterComplexity, sizeof(complexity), &complexity));
+
+    float input[] = { 0.0f, 1.0f, -1.0f };
+    float output[12];
+    UInt32 outputSize = sizeof(output);
+    ASSERT_EQ(noErr, AudioConverterConvertBuffer(converter, sizeof(input), input, &outputSize, output));
+    ASSERT_EQ(sizeof(output), outputSize);
+
+    float expected[] = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f, 0.5f, 0.0f, -0.5f, -1.0f, -0.75f, -0.5f, -0.25f };
+    for (size_t i = 0; i < 12; ++i) {
+        EXPECT_FLOAT_EQ(expected[i], output[i]) << i;
+    }
+
+    AudioConverterDispose(converter);
+}
+
+//
+// AudioConverterFillComplexBuffer
+//
+
+struct PullSource {
+    const std::vector<int16_t>* samples;
+    UInt32 channels;
+    size_t position;
+    UInt32 callbacks;
+    UInt32 failAtCallback;
+};
+
+static const OSStatus c_pullNotReady = 'wait';
+
+static OSStatus _pullInput(AudioConverterRef converter,
+                           UInt32* ioNumberDataPackets,
+                           AudioBufferList* ioData,
+                           AudioStreamPacketDescription** outDataPacketDescription,
+                           void* userData) {
+    PullSource* source = static_cast<PullSource*>(userData);
+    if (++source->callbacks == source->failAtCallback) {
+        *ioNumberDataPackets = 0;
+        return c_pullNotReady;
+    }
+
+    // Hand over an awkward, varying amount, never more than asked for.
+    size_t remaining = source->samples->size() / source->channels - source->position;
+    UInt32 packets = std::min<size_t>(std::min<UInt32>(*ioNumberDataPackets, 37 + (source->callbacks * 101) % 700), remaining);
+
+    ioData->mBuffers[0].mNumberChannels = source->channels;
+    ioData->mBuffers[0].mDataByteSize = packets * source->channels * sizeof(int16_t);
+    ioData->mBuffers[0].mData = const_cast<int16_t*>(source->samples->data() + source->position * source->channels);
+    source->position += packets;
+    *ioNumberDataPackets = packets;
+    return noErr;
+}
+
+static std::vector<float> _pullAll(AudioConverterRef converter, PullSource& source, UInt32 channels, OSStatus* lastStatus = nullptr) {
+    std::vector<float> output;
+    for (UInt32 request = 1;; request = (request * 7 + 13) % 2000) {
+        std::vector<float> chunk(request * channels);
+        AudioBufferList list = { 1, { { channels, static_cast<UInt32>(chunk.size() * sizeof(float)), chunk.data() } } };
+        UInt32 packets = request;
+        OSStatus status = AudioConverterFillComplexBuffer(converter, _pullInput, &source, &packets, &list, nullptr);
+        output.insert(output.end(), chunk.begin(), chunk.begin() + packets * channels);
+        if (status != noErr) {
+            if (lastStatus) {
+                *lastStatus = status;
+            }
+            return output;
+        }
+        if (packets < request) {
+            return output;
+        }
+    }
+}
+
+TEST(AudioConverter, FillComplexBufferMatchesConvertBuffer) {
+    std::vector<int16_t> input(2 * 30000);
+    for (size_t i = 0; i < input.size() / 2; ++i) {
+        input[2 * i] = static_cast<int16_t>(10000 * sin(i * 0.05));
+        input[2 * i + 1] = static_cast<int16_t>(8000 * sin(i * 0.31));
+    }
+
+    const double rates[][2] = { { 44100, 44100 }, { 44100, 48000 }, { 48000, 22050 } };
+    for (const auto& rate : rates) {
+        std::vector<float> expected = _convert<float>(_int16Format(rate[0], 2), _floatFormat(rate[1], 2), input);
+
+        AudioConverterRef converter;
+        ASSERT_EQ(noErr, _newConverter(_int16Format(rate[0], 2), _floatFormat(rate[1], 2), &converter));
+        PullSource source = { &input, 2, 0, 0, 0 };
+        EXPECT_EQ(expected, _pullAll(converter, source, 2)) << rate[0] << " to " << rate[1];
+
+        // After a reset the converter starts a new stream.
+        ASSERT_EQ(noErr, AudioConverterReset(converter));
+        source = { &input, 2, 0, 0, 0 };
+        EXPECT_EQ(expected, _pullAll(converter, source, 2)) << rate[0] << " to " << rate[1];
+        AudioConverterDispose(converter);
+    }
+}
+
+TEST(AudioConverter, FillComplexBufferStopsOnCallbackError) {
+    std::vector<int16_t> input(20000);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<int16_t>(i * 3);
+    }
+
+    std::vector<float> expected = _convert<float>(_int16Format(32000, 1), _floatFormat(44100, 1), input);
+
+    AudioConverterRef converter;
+    ASSERT_EQ(noErr, _newConverter(_int16Format(32000, 1), _floatFormat(44100, 1), &converter));
+    PullSource source = { &input, 1, 0, 0, 5 };
+
+    // The error comes back to the caller, and the next call carries on where the stream left off.
+    OSStatus status = noErr;
+    std::vector<float> output = _pullAll(converter, source, 1, &status);
+    EXPECT_EQ(c_pullNotReady, status);
+    std::vector<float> rest = _pullAll(converter, source, 1);
+    output.insert(output.end(), rest.begin(), rest.end());
+    EXPECT_EQ(expected, output);
+
+    AudioConverterDispose(converter);
+}
@@ -0,0 +1,617 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioFile.h>
+
+#include "AudioStreamDecoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+// An encoded file held in memory and served through the AudioFile callbacks.
+struct MemoryAudioFile {
+    std::vector<uint8_t> bytes;
+};
+
+static OSStatus _memoryRead(void* context, SInt64 position, UInt32 requestCount, void* buffer, UInt32* actualCount) {
+    const std::vector<uint8_t>& bytes = static_cast<MemoryAudioFile*>(context)->bytes;
+    if (position < 0 || position > (SInt64)bytes.size()) {
+        *actualCount = 0;
+        return kAudioFilePositionError;
+    }
+
+    *actualCount = std::min<UInt32>(requestCount, bytes.size() - position);
+    memcpy(buffer, bytes.data() + position, *actualCount);
+    return 0;
+}
+
+static SInt64 _memorySize(void* context) {
+    return static_cast<MemoryAudioFile*>(context)->bytes.size();
+}
+
+static std::unique_ptr<AudioByteSource> _createSource(MemoryAudioFile& file) {
+    return AudioByteSource::CreateWithCallbacks(&file, _memoryRead, _memorySize);
+}
+
+static std::vector<int16_t> _decodeAll(AudioStreamDecoder& decoder) {
+    std::vector<int16_t> samples;
+    std::vector<int16_t> chunk(1000 * decoder.ChannelCount());
+    for (;;) {
+        uint32_t frames = decoder.Decode(chunk.data(), 1000);
+        samples.insert(samples.end(), chunk.begin(), chunk.begin() + frames * decoder.ChannelCount());
+        if (frames < 1000) {
+            return samples;
+        }
+    }
+}
+
+//
+// CAF
+//
+
+static void _appendBigEndian(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static void _appendFourCC(std::vector<uint8_t>& out, const char* fourCC) {
+    out.insert(out.end(), fourCC, fourCC + 4);
+}
+
+// Writes a CAF file with a desc chunk, an optional pakt chunk and a data chunk holding audio.
+static std::vector<uint8_t> _makeCAF(uint32_t formatID,
+                                     uint32_t formatFlags,
+                                     uint32_t bytesPerPacket,
+                                     uint32_t framesPerPacket,
+                                     uint32_t channels,
+                                     uint32_t bitsPerChannel,
+                                     const std::vector<uint8_t>& audio,
+                                     int64_t validFrames = -1,
+                                     int32_t primingFrames = 0) {
+    std::vector<uint8_t> out;
+    _appendFourCC(out, "caff");
+    _appendBigEndian(out, 1, 2);
+    _appendBigEndian(out, 0, 2);
+
+    double sampleRate = 22050.0;
+    uint64_t sampleRateBits;
+    memcpy(&sampleRateBits, &sampleRate, sizeof(sampleRateBits));
+    _appendFourCC(out, "desc");
+    _appendBigEndian(out, 32, 8);
+    _appendBigEndian(out, sampleRateBits, 8);
+    _appendBigEndian(out, formatID, 4);
+    _appendBigEndian(out, formatFlags, 4);
+    _appendBigEndian(out, bytesPerPacket, 4);
+    _appendBigEndian(out, framesPerPacket, 4);
+    _appendBigEndian(out, channels, 4);
+    _appendBigEndian(out, bitsPerChannel, 4);
+
+    // An unrelated chunk the decoder has to step over
+    _appendFourCC(out, "free");
+    _appendBigEndian(out, 16, 8);
+    out.insert(out.end(), 16, 0);
+
+    if (validFrames >= 0) {
+        _appendFourCC(out, "pakt");
+        _appendBigEndian(out, 24, 8);
+        _appendBigEndian(out, audio.size() / bytesPerPacket, 8);
+        _appendBigEndian(out, validFrames, 8);
+        _appendBigEndian(out, primingFrames, 4);
+        _appendBigEndian(out, 0, 4);
+    }
+
+    _appendFourCC(out, "data");
+    _appendBigEndian(out, audio.size() + 4, 8);
+    _appendBigEndian(out, 0, 4);
+    out.insert(out.end(), audio.begin(), audio.end());
+    return out;
+}
+
+static std::vector<int16_t> _makeTone(uint32_t frames, uint32_t channels) {
+    std::vector<int16_t> samples(frames * channels);
+    for (uint32_t i = 0; i < frames; ++i) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            samples[i * channels + c] = static_cast<int16_t>((i * (97 + c * 31)) & 0xFFFF);
+        }
+    }
+    return samples;
+}
+
+static const uint32_t kLinearPCMFormat = 'lpcm';
+static const uint32_t kIMA4Format = 'ima4';
+static const uint32_t kLinearPCMLittleEndianFlag = 2;
+
+TEST(AudioStreamDecoder, CAFLinearPCMBigEndianDecodesAndSeeksExactly) {
+    const uint32_t frames = 50000;
+    std::vector<int16_t> tone = _makeTone(frames, 2);
+
+    std::vector<uint8_t> audio;
+    for (int16_t sample : tone) {
+        _appendBigEndian(audio, static_cast<uint16_t>(sample), 2);
+    }
+
+    MemoryAudioFile file{ _makeCAF(kLinearPCMFormat, 0, 4, 1, 2, 16, audio) };
+    std::unique_ptr<AudioStreamDecoder> decoder = AudioStreamDecoder::CreateCAF(_createSource(file));
+    ASSERT_NE(nullptr, decoder);
+    EXPECT_EQ(2, decoder->ChannelCount());
+    EXPECT_EQ(22050.0, decoder->SampleRate());
+    EXPECT_EQ(frames, decoder->FrameCount());
+    EXPECT_EQ(tone, _decodeAll(*decoder));
+
+    std::mt19937 random(1);
+    int16_t samples[2 * 300];
+    for (int i = 0; i < 200; ++i) {
+        int64_t frame = random() % frames;
+        ASSERT_TRUE(decoder->Seek(frame));
+        uint32_t decoded = decoder->Decode(samples, 300);
+        ASSERT_EQ(std::min<int64_t>(300, frames - frame), decoded);
+        ASSERT_EQ(0, memcmp(samples, tone.data() + frame * 2, decoded * 2 * sizeof(int16_t))) << "Seek to " << frame;
+    }
+
+    ASSERT_TRUE(decoder->Seek(frames + 10));
+    EXPECT_EQ(0, decoder->Decode(samples, 300));
+}
+
+TEST(AudioStreamDecoder, CAFLinearPCMLittleEndian) {
+    std::vector<int16_t> tone = _makeTone(1000, 1);
+    std::vector<uint8_t> audio(reinterpret_cast<uint8_t*>(tone.data()), reinterpret_cast<uint8_t*>(tone.data() + tone.size()));
+
+    MemoryAudioFile file{ _makeCAF(kLinearPCMFormat, kLinearPCMLittleEndianFlag, 2, 1, 1, 16, audio) };
+    std::unique_ptr<AudioStreamDecoder> decoder = AudioStreamDecoder::CreateCAF(_createSource(file));
+    ASSERT_NE(nullptr, decoder);
+    EXPECT_EQ(tone, _decodeAll(*decoder));
+}
+
+TEST(AudioStreamDecoder, CAFRejectsUnsupportedData) {
+    MemoryAudioFile eightBit{ _makeCAF(kLinearPCMFormat, 0, 1, 1, 1, 8, std::vector<uint8_t>(100)) };
+    EXPECT_EQ(nullptr, AudioStreamDecoder::CreateCAF(_createSource(eightBit)));
+
+    MemoryAudioFile truncated{ _makeCAF(kLinearPCMFormat, 0, 2, 1, 1, 16, std::vector<uint8_t>(100)) };
+    truncated.bytes.resize(20);
+    EXPECT_EQ(nullptr, AudioStreamDecoder::CreateCAF(_createSource(truncated)));
+
+    MemoryAudioFile notCAF{ std::vector<uint8_t>(100, 'x') };
+    EXPECT_EQ(nullptr, AudioStreamDecoder::CreateCAF(_createSource(notCAF)));
+}
+
+TEST(AudioStreamDecoder, CAFIMA4HonoursPacketTableAndSeeksToPacketHeaders) {
+    const uint32_t channels = 2;
+    const uint32_t packets = 400;
+    const uint32_t bytesPerPacket = 34 * channels;
+    const int32_t primingFrames = 40;
+    const int64_t validFrames = packets * 64 - primingFrames - 100;
+
+    std::mt19937 random(2);
+    std::vector<uint8_t> audio(packets * bytesPerPacket);
+    for (uint8_t& byte : audio) {
+        byte = static_cast<uint8_t>(random());
+    }
+    for (uint32_t packet = 0; packet < packets; ++packet) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            // Predictor in the upper 9 bits, step index in the lower 7
+            uint8_t* header = &audio[packet * bytesPerPacket + c * 34];
+            header[1] = (header[1] & 0x80) | (random() % 89);
+        }
+    }
+
+    MemoryAudioFile file{ _makeCAF(kIMA4Format, 0, bytesPerPacket, 64, channels, 0, audio, validFrames, primingFrames) };
+    std::unique_ptr<AudioStreamDecoder> decoder = AudioStreamDecoder::CreateCAF(_createSource(file));
+    ASSERT_NE(nullptr, decoder);
+    EXPECT_EQ(validFrames, decoder->FrameCount());
+
+    std::vector<int16_t> sequential = _decodeAll(*decoder);
+    ASSERT_EQ(validFrames * channels, sequential.size());
+
+    // A seek restarts from the nearest packet header, whose 9-bit predictor is within the decoder's tolerance of the
+    // running state a sequential decode would have carried over.
+    int16_t samples[channels * 200];
+    for (int i = 0; i < 200; ++i) {
+        int64_t frame = random() % validFrames;
+        ASSERT_TRUE(decoder->Seek(frame));
+        uint32_t decoded = decoder->Decode(samples, 200);
+        ASSERT_EQ(std::min<int64_t>(200, validFrames - frame), decoded);
+        for (uint32_t s = 0; s < decoded * channels; ++s) {
+            ASSERT_LE(abs(samples[s] - sequential[frame * channels + s]), 127) << "Seek to " << frame;
+        }
+    }
+}
+
+//
+// Ogg Vorbis
+//
+
+class VorbisBitWriter {
+public:
+    VorbisBitWriter() : _accumulator(0), _bits(0) {
+    }
+
+    void Write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; ++i) {
+            _accumulator |= ((value >> i) & 1) << _bits;
+            if (++_bits == 8) {
+                _bytes.push_back(_accumulator);
+                _accumulator = 0;
+                _bits = 0;
+            }
+        }
+    }
+
+    // Huffman codewords are written most significant bit first.
+    void WriteCode(uint32_t codeword, int length) {
+        for (int i = length - 1; i >= 0; --i) {
+            Write((codeword >> i) & 1, 1);
+        }
+    }
+
+    void WriteHeaderStart(uint8_t type) {
+        Write(type, 8);
+        for (const char* c = "vorbis"; *c; ++c) {
+            Write(*c, 8);
+        }
+    }
+
+    std::vector<uint8_t> Finish() {
+        if (_bits) {
+            _bytes.push_back(_accumulator);
+        }
+        return _bytes;
+    }
+
+private:
+    std::vector<uint8_t> _bytes;
+    uint8_t _accumulator;
+    int _bits;
+};
+
+static uint32_t _oggCRC(const std::vector<uint8_t>& data) {
+    uint32_t crc = 0;
+    for (uint8_t byte : data) {
+        crc ^= byte << 24;
+        for (int i = 0; i < 8; ++i) {
+            crc = (crc & 0x80000000) ? ((crc << 1) ^ 0x04c11db7) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void _appendOggPage(std::vector<uint8_t>& out,
+                           uint8_t flags,
+                           int64_t granule,
+                           uint32_t sequence,
+                           const std::vector<uint8_t>& segments,
+                           const std::vector<uint8_t>& body) {
+    std::vector<uint8_t> page = { 'O', 'g', 'g', 'S', 0, flags };
+    for (int i = 0; i < 8; ++i) {
+        page.push_back(static_cast<uint8_t>(static_cast<uint64_t>(granule) >> (8 * i)));
+    }
+    for (uint32_t value : { 0x1234u, sequence, 0u }) {
+        for (int i = 0; i < 4; ++i) {
+            page.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    page.push_back(static_cast<uint8_t>(segments.size()));
+    page.insert(page.end(), segments.begin(), segments.end());
+    page.insert(page.end(), body.begin(), body.end());
+
+    uint32_t crc = _oggCRC(page);
+    for (int i = 0; i < 4; ++i) {
+        page[22 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+    out.insert(out.end(), page.begin(), page.end());
+}
+
+// Builds a small but valid Vorbis stream: one floor and residue setup, short and long blocks in random runs, and packets
+// laced across pages of random length so that pages end mid-packet.
+static std::vector<uint8_t> _makeOggVorbis(uint32_t channels, uint32_t packetCount, uint32_t seed) {
+    std::mt19937 random(seed);
+    auto randomRange = [&random](uint32_t low, uint32_t high) { return low + random() % (high - low + 1); };
+
+    VorbisBitWriter identification;
+    identification.WriteHeaderStart(1);
+    identification.Write(0, 32);
+    identification.Write(channels, 8);
+    identification.Write(44100, 32);
+    identification.Write(0, 32);
+    identification.Write(0, 32);
+    identification.Write(0, 32);
+    identification.Write(8, 4);
+    identification.Write(11, 4);
+    identification.Write(1, 1);
+
+    VorbisBitWriter comment;
+    comment.WriteHeaderStart(3);
+    comment.Write(0, 32);
+    comment.Write(0, 32);
+    comment.Write(1, 1);
+
+    VorbisBitWriter setup;
+    setup.WriteHeaderStart(5);
+    setup.Write(1, 8); // Two codebooks: a one-entry classbook and a 16-entry book of 4-bit codewords
+    setup.Write(0x564342, 24);
+    setup.Write(1, 16);
+    setup.Write(2, 24);
+    setup.Write(0, 2);
+    setup.Write(0, 10);
+    setup.Write(0, 4);
+    setup.Write(0x564342, 24);
+    setup.Write(1, 16);
+    setup.Write(16, 24);
+    setup.Write(0, 2);
+    for (int i = 0; i < 16; ++i) {
+        setup.Write(3, 5);
+    }
+    setup.Write(1, 4);
+    setup.Write((1u << 31) | (788 << 21) | 8, 32);
+    setup.Write((788 << 21) | 1, 32);
+    setup.Write(3, 4);
+    setup.Write(0, 1);
+    for (int i = 0; i < 16; ++i) {
+        setup.Write(i, 4);
+    }
+    setup.Write(0, 6); // Time domain transforms
+    setup.Write(0, 16);
+    setup.Write(0, 6); // Floor 1 with no partitions
+    setup.Write(1, 16);
+    setup.Write(0, 5);
+    setup.Write(0, 2);
+    setup.Write(7, 4);
+    setup.Write(0, 6); // Residue 1
+    setup.Write(1, 16);
+    setup.Write(0, 24);
+    setup.Write(1024, 24);
+    setup.Write(15, 24);
+    setup.Write(0, 6);
+    setup.Write(0, 8);
+    setup.Write(1, 3);
+    setup.Write(0, 1);
+    setup.Write(1, 8);
+    setup.Write(0, 6); // Mapping
+    setup.Write(0, 16);
+    setup.Write(0, 4);
+    setup.Write(0, 8);
+    setup.Write(0, 8);
+    setup.Write(0, 8);
+    setup.Write(1, 6); // Short and long modes
+    for (uint32_t blockFlag : { 0, 1 }) {
+        setup.Write(blockFlag, 1);
+        setup.Write(0, 16);
+        setup.Write(0, 16);
+        setup.Write(0, 8);
+    }
+    setup.Write(1, 1);
+
+    std::vector<uint8_t> out;
+    uint32_t sequence = 0;
+    std::vector<uint8_t> identificationBytes = identification.Finish();
+    _appendOggPage(out, 2, 0, sequence++, { static_cast<uint8_t>(identificationBytes.size()) }, identificationBytes);
+
+    std::vector<uint8_t> headerSegments;
+    std::vector<uint8_t> headerBody;
+    for (const std::vector<uint8_t>& packet : { comment.Finish(), setup.Finish() }) {
+        size_t length = packet.size();
+        for (; length >= 255; length -= 255) {
+            headerSegments.push_back(255);
+        }
+        headerSegments.push_back(static_cast<uint8_t>(length));
+        headerBody.insert(headerBody.end(), packet.begin(), packet.end());
+    }
+    _appendOggPage(out, 0, 0, sequence++, headerSegments, headerBody);
+
+    std::vector<bool> isLong;
+    while (isLong.size() < packetCount) {
+        isLong.insert(isLong.end(), randomRange(1, 12), (random() & 1) != 0);
+    }
+    isLong.resize(packetCount);
+
+    struct Segment {
+        uint8_t length;
+        int64_t granule; // -1 unless the segment ends a packet
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<Segment> segments;
+    int64_t granule = 0;
+    for (uint32_t i = 0; i < packetCount; ++i) {
+        bool previousLong = i ? isLong[i - 1] : isLong[i];
+        bool nextLong = (i + 1 < packetCount) ? isLong[i + 1] : isLong[i];
+
+        VorbisBitWriter audio;
+        audio.Write(0, 1);
+        audio.Write(isLong[i], 1);
+        if (isLong[i]) {
+            audio.Write(previousLong, 1);
+            audio.Write(nextLong, 1);
+        }
+        for (uint32_t c = 0; c < channels; ++c) {
+            audio.Write(1, 1);
+            audio.Write(randomRange(110, 140), 8);
+            audio.Write(randomRange(110, 140), 8);
+        }
+        for (uint32_t partition = 0; partition < (isLong[i] ? 1024u : 128u) / 16; ++partition) {
+            for (uint32_t c = 0; c < channels; ++c) {
+                audio.WriteCode(0, 1);
+            }
+            for (uint32_t c = 0; c < channels; ++c) {
+                for (int k = 0; k < 16; ++k) {
+                    audio.WriteCode(randomRange(0, 15), 4);
+                }
+            }
+        }
+
+        if (i > 0) {
+            granule += (previousLong ? 2048 : 256) / 4 + (isLong[i] ? 2048 : 256) / 4;
+        }
+
+        std::vector<uint8_t> packet = audio.Finish();
+        size_t offset = 0;
+        for (; packet.size() - offset >= 255; offset += 255) {
+            segments.push_back({ 255, -1, std::vector<uint8_t>(packet.begin() + offset, packet.begin() + offset + 255) });
+        }
+        segments.push_back({ static_cast<uint8_t>(packet.size() - offset), granule, std::vector<uint8_t>(packet.begin() + offset, packet.end()) });
+    }
+
+    bool continued = false;
+    for (size_t position = 0; position < segments.size();) {
+        size_t end = std::min<size_t>(segments.size(), position + randomRange(3, 60));
+        std::vector<uint8_t> lacing;
+        std::vector<uint8_t> body;
+        int64_t pageGranule = -1;
+        for (size_t i = position; i < end; ++i) {
+            lacing.push_back(segments[i].length);
+            body.insert(body.end(), segments[i].bytes.begin(), segments[i].bytes.end());
+            if (segments[i].granule >= 0) {
+                pageGranule = segments[i].granule;
+            }
+        }
+
+        uint8_t flags = (continued ? 1 : 0) | (end == segments.size() ? 4 : 0);
+        _appendOggPage(out, flags, pageGranule, sequence++, lacing, body);
+        continued = segments[end - 1].granule < 0;
+        position = end;
+    }
+
+    return out;
+}
+
+static void _checkOggSeeks(uint32_t channels, uint32_t packetCount, uint32_t seed) {
+    MemoryAudioFile file{ _makeOggVorbis(channels, packetCount, seed) };
+    std::unique_ptr<AudioStreamDecoder> decoder = AudioStreamDecoder::CreateOggVorbis(_createSource(file));
+    ASSERT_NE(nullptr, decoder);
+    EXPECT_EQ(channels, decoder->ChannelCount());
+    EXPECT_EQ(44100.0, decoder->SampleRate());
+
+    std::vector<int16_t> sequential = _decodeAll(*decoder);
+    int64_t frames = sequential.size() / channels;
+    ASSERT_GT(frames, 0);
+    EXPECT_EQ(frames, decoder->FrameCount());
+
+    // Alternate short hops, which decode forward, with long jumps that resynchronize on the page index.
+    std::mt19937 random(seed);
+    std::vector<int16_t> samples(channels * 500);
+    int64_t frame = 0;
+    for (int i = 0; i < 300; ++i) {
+        frame = (i & 1) ? (frame + random() % 3000) % frames : random() % frames;
+        ASSERT_TRUE(decoder->Seek(frame));
+        uint32_t decoded = decoder->Decode(samples.data(), 500);
+        ASSERT_EQ(std::min<int64_t>(500, frames - frame), decoded);
+        ASSERT_EQ(0, memcmp(samples.data(), sequential.data() + frame * channels, decoded * channels * sizeof(int16_t)))
+            << "Seek to " << frame;
+    }
+
+    ASSERT_TRUE(decoder->Seek(0));
+    EXPECT_EQ(sequential, _decodeAll(*decoder));
+}
+
+TEST(AudioStreamDecoder, OggVorbisMonoSeeksMatchSequentialDecode) {
+    _checkOggSeeks(1, 600, 3);
+}
+
+TEST(AudioStreamDecoder, OggVorbisStereoSeeksMatchSequentialDecode) {
+    _checkOggSeeks(2, 400, 4);
+}
+
+TEST(AudioStreamDecoder, OggVorbisRejectsOtherData) {
+    MemoryAudioFile caf{ _makeCAF(kLinearPCMFormat, 0, 2, 1, 1, 16, std::vector<uint8_t>(2000)) };
+    EXPECT_EQ(nullptr, AudioStreamDecoder::CreateOggVorbis(_createSource(caf)));
+}
+
+//
+// Decode-ahead buffer
+//
+
+TEST(AudioStreamDecoder, DecodeAheadBufferReadsAndSeeks) {
+    MemoryAudioFile file{ _makeOggVorbis(2, 300, 5) };
+    std::unique_ptr<AudioStreamDecoder> reference = AudioStreamDecoder::CreateOggVorbis(_createSource(file));
+    ASSERT_NE(nullptr, reference);
+    std::vector<int16_t> sequential = _decodeAll(*reference);
+    int64_t frames = sequential.size() / 2;
+
+    // A ring smaller than one decode chunk wraps on nearly every read.
+    AudioDecodeAheadBuffer buffer(AudioStreamDecoder::CreateOggVorbis(_createSource(file)), 3000);
+    std::vector<int16_t> streamed;
+    std::vector<int16_t> samples(2 * 777);
+    for (;;) {
+        uint32_t read = buffer.Read(samples.data(), 777);
+        streamed.insert(streamed.end(), samples.begin(), samples.begin() + read * 2);
+        if (read < 777) {
+            break;
+        }
+    }
+    EXPECT_EQ(sequential, streamed);
+    EXPECT_EQ(frames, buffer.Position());
+
+    std::mt19937 random(6);
+    for (int i = 0; i < 100; ++i) {
+        int64_t frame = random() % frames;
+        ASSERT_TRUE(buffer.Seek(frame));
+        EXPECT_EQ(frame, buffer.Position());
+        uint32_t read = buffer.Read(samples.data(), 777);
+        ASSERT_EQ(std::min<int64_t>(777, frames - frame), read);
+        ASSERT_EQ(0, memcmp(samples.data(), sequential.data() + frame * 2, read * 2 * sizeof(int16_t))) << "Seek to " << frame;
+    }
+}
+
+//
+// AudioFile
+//
+
+TEST(AudioFile, ReadPacketDataFromCAFCallbacks) {
+    std::vector<int16_t> tone = _makeTone(20000, 1);
+    std::vector<uint8_t> audio;
+    for (int16_t sample : tone) {
+        _appendBigEndian(audio, static_cast<uint16_t>(sample), 2);
+    }
+
+    MemoryAudioFile file{ _makeCAF(kLinearPCMFormat, 0, 2, 1, 1, 16, audio) };
+    AudioFileID audioFile = nullptr;
+    ASSERT_EQ(0, AudioFileOpenWithCallbacks(&file, _memoryRead, nullptr, _memorySize, nullptr, 0, &audioFile));
+    ASSERT_NE(nullptr, audioFile);
+
+    AudioStreamBasicDescription format = {};
+    UInt32 size = sizeof(format);
+    ASSERT_EQ(0, AudioFileGetProperty(audioFile, kAudioFilePropertyDataFormat, &size, &format));
+    EXPECT_EQ(kAudioFormatLinearPCM, format.mFormatID);
+    EXPECT_EQ(1, format.mFramesPerPacket);
+    EXPECT_EQ(2, format.mBytesPerPacket);
+
+    UInt64 packetCount = 0;
+    size = sizeof(packetCount);
+    ASSERT_EQ(0, AudioFileGetProperty(audioFile, kAudioFilePropertyAudioDataPacketCount, &size, &packetCount));
+    EXPECT_EQ(tone.size(), packetCount);
+
+    // Out of order reads, and a buffer too small for the packets asked for.
+    int16_t samples[1000];
+    for (SInt64 firstPacket : { 15000, 100, 19500, 0 }) {
+        UInt32 bytes = sizeof(samples);
+        UInt32 packets = 2000;
+        ASSERT_EQ(0, AudioFileReadPacketData(audioFile, false, &bytes, nullptr, firstPacket, &packets, samples));
+        UInt32 expected = std::min<UInt32>(1000, tone.size() - firstPacket);
+        ASSERT_EQ(expected, packets);
+        ASSERT_EQ(expected * sizeof(int16_t), bytes);
+        ASSERT_EQ(0, memcmp(samples, tone.data() + firstPacket, bytes));
+    }
+
+    UInt32 bytes = sizeof(samples);
+    UInt32 packets = 10;
+    EXPECT_EQ(kAudioFileInvalidPacketOffsetError, AudioFileReadPacketData(audioFile, false, &bytes, nullptr, 30000, &packets, samples));
+    EXPECT_EQ(0, packets);
+
+    AudioFileClose(audioFile);
+}
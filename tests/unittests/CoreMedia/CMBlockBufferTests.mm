@@ -0,0 +1,269 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <CoreMedia/CoreMedia.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Counts the blocks a custom block source hands out and takes back.
+struct BlockSourceCounts {
+    int allocated;
+    int freed;
+};
+
+static void* _allocateBlock(void* refCon, size_t size) {
+    static_cast<BlockSourceCounts*>(refCon)->allocated++;
+    return malloc(size);
+}
+
+static void _freeBlock(void* refCon, void* block, size_t size) {
+    static_cast<BlockSourceCounts*>(refCon)->freed++;
+    free(block);
+}
+
+// A buffer over a copy of text, in memory the buffer owns.
+static CMBlockBufferRef _createBuffer(const char* text) {
+    size_t length = strlen(text);
+    void* memory = malloc(length);
+    memcpy(memory, text, length);
+
+    CMBlockBufferRef buffer = nullptr;
+    EXPECT_EQ(kCMBlockBufferNoErr,
+              CMBlockBufferCreateWithMemoryBlock(nullptr, memory, length, kCFAllocatorMalloc, nullptr, 0, length, 0, &buffer));
+    return buffer;
+}
+
+static std::string _contents(CMBlockBufferRef buffer) {
+    std::string contents(CMBlockBufferGetDataLength(buffer), '\0');
+    EXPECT_EQ(kCMBlockBufferNoErr, CMBlockBufferCopyDataBytes(buffer, 0, contents.size(), &contents[0]));
+    return contents;
+}
+
+TEST(CMBlockBuffer, CreateWithMemoryBlock) {
+    char bytes[] = "0123456789";
+    CMBlockBufferRef buffer = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithMemoryBlock(nullptr, bytes, 10, kCFAllocatorNull, nullptr, 2, 5, 0, &buffer));
+    EXPECT_EQ(CMBlockBufferGetTypeID(), CFGetTypeID(buffer));
+    EXPECT_EQ(5u, CMBlockBufferGetDataLength(buffer));
+    EXPECT_FALSE(CMBlockBufferIsEmpty(buffer));
+
+    char* pointer = nullptr;
+    size_t lengthAtOffset = 0;
+    size_t totalLength = 0;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferGetDataPointer(buffer, 1, &lengthAtOffset, &totalLength, &pointer));
+    EXPECT_EQ(bytes + 3, pointer);
+    EXPECT_EQ(4u, lengthAtOffset);
+    EXPECT_EQ(5u, totalLength);
+
+    EXPECT_EQ(kCMBlockBufferBadOffsetParameterErr, CMBlockBufferGetDataPointer(buffer, 5, &lengthAtOffset, &totalLength, &pointer));
+    CFRelease(buffer);
+
+    EXPECT_EQ(kCMBlockBufferBadLengthParameterErr,
+              CMBlockBufferCreateWithMemoryBlock(nullptr, bytes, 10, kCFAllocatorNull, nullptr, 8, 5, 0, &buffer));
+}
+
+TEST(CMBlockBuffer, AllocatesLazily) {
+    BlockSourceCounts counts = {};
+    CMBlockBufferCustomBlockSource source = { kCMBlockBufferCustomBlockSourceVersion, _allocateBlock, _freeBlock, &counts };
+
+    CMBlockBufferRef buffer = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithMemoryBlock(nullptr, nullptr, 16, nullptr, &source, 0, 16, 0, &buffer));
+    EXPECT_EQ(0, counts.allocated);
+
+    char* pointer = nullptr;
+    EXPECT_EQ(kCMBlockBufferUnallocatedBlockErr, CMBlockBufferGetDataPointer(buffer, 0, nullptr, nullptr, &pointer));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAssureBlockMemory(buffer));
+    EXPECT_EQ(1, counts.allocated);
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferFillDataBytes('x', buffer, 0, 16));
+    EXPECT_EQ(std::string(16, 'x'), _contents(buffer));
+
+    CFRelease(buffer);
+    EXPECT_EQ(1, counts.freed);
+
+    ASSERT_EQ(kCMBlockBufferNoErr,
+              CMBlockBufferCreateWithMemoryBlock(
+                  nullptr, nullptr, 16, nullptr, &source, 0, 16, kCMBlockBufferAssureMemoryNowFlag, &buffer));
+    EXPECT_EQ(2, counts.allocated);
+    CFRelease(buffer);
+    EXPECT_EQ(2, counts.freed);
+}
+
+TEST(CMBlockBuffer, AppendsByReference) {
+    CMBlockBufferRef hello = _createBuffer("hello ");
+    CMBlockBufferRef world = _createBuffer("world");
+
+    CMBlockBufferRef rope = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateEmpty(nullptr, 4, 0, &rope));
+    EXPECT_TRUE(CMBlockBufferIsEmpty(rope));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, hello, 0, 6, 0));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, world, 0, 5, 0));
+    EXPECT_EQ("hello world", _contents(rope));
+
+    // The rope shares the sources' memory rather than copying it.
+    char* source = nullptr;
+    char* referenced = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferGetDataPointer(world, 0, nullptr, nullptr, &source));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferGetDataPointer(rope, 6, nullptr, nullptr, &referenced));
+    EXPECT_EQ(source, referenced);
+
+    // The rope keeps the memory alive after the sources are released.
+    CFRelease(hello);
+    CFRelease(world);
+    EXPECT_EQ("hello world", _contents(rope));
+
+    EXPECT_EQ(kCMBlockBufferBadLengthParameterErr, CMBlockBufferAppendBufferReference(rope, rope, 0, 0, 0));
+    EXPECT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, rope, 0, 0, kCMBlockBufferPermitEmptyReferenceFlag));
+    EXPECT_EQ(kCMBlockBufferBadLengthParameterErr, CMBlockBufferAppendBufferReference(rope, rope, 6, 6, 0));
+
+    // Appending a buffer to itself doubles it.
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, rope, 0, 11, 0));
+    EXPECT_EQ("hello worldhello world", _contents(rope));
+    CFRelease(rope);
+}
+
+TEST(CMBlockBuffer, Subranges) {
+    CMBlockBufferRef text = _createBuffer("the quick brown fox");
+
+    CMBlockBufferRef quick = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithBufferReference(nullptr, text, 4, 5, 0, &quick));
+    EXPECT_EQ("quick", _contents(quick));
+
+    // Adjacent slices of one block merge back into a single contiguous run.
+    CMBlockBufferRef rejoined = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithBufferReference(nullptr, text, 0, 4, 0, &rejoined));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rejoined, text, 4, 15, 0));
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(rejoined, 0, 0));
+
+    // Copies don't share memory.
+    CMBlockBufferRef copy = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithBufferReference(nullptr, text, 4, 5, kCMBlockBufferAlwaysCopyDataFlag, &copy));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferReplaceDataBytes("QUICK", text, 4, 5));
+    EXPECT_EQ("QUICK", _contents(quick));
+    EXPECT_EQ("quick", _contents(copy));
+
+    EXPECT_EQ(kCMBlockBufferBadOffsetParameterErr, CMBlockBufferCreateWithBufferReference(nullptr, text, 30, 1, 0, &copy));
+    EXPECT_EQ(kCMBlockBufferInsufficientSpaceErr, CMBlockBufferReplaceDataBytes("toolong", quick, 0, 7));
+
+    CFRelease(text);
+    CFRelease(quick);
+    CFRelease(rejoined);
+    CFRelease(copy);
+}
+
+TEST(CMBlockBuffer, RangeContiguity) {
+    CMBlockBufferRef first = _createBuffer("abcd");
+    CMBlockBufferRef second = _createBuffer("efgh");
+    CMBlockBufferRef rope = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithBufferReference(nullptr, first, 0, 4, 0, &rope));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, second, 0, 4, 0));
+
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(rope, 0, 4));
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(rope, 4, 4));
+    EXPECT_FALSE(CMBlockBufferIsRangeContiguous(rope, 3, 2));
+    EXPECT_FALSE(CMBlockBufferIsRangeContiguous(rope, 0, 0));
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(rope, 5, 0));
+    EXPECT_FALSE(CMBlockBufferIsRangeContiguous(rope, 6, 4));
+
+    size_t lengthAtOffset = 0;
+    char* pointer = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferGetDataPointer(rope, 2, &lengthAtOffset, nullptr, &pointer));
+    EXPECT_EQ(2u, lengthAtOffset);
+
+    CFRelease(first);
+    CFRelease(second);
+    CFRelease(rope);
+}
+
+TEST(CMBlockBuffer, AccessDataBytes) {
+    CMBlockBufferRef first = _createBuffer("abcd");
+    CMBlockBufferRef second = _createBuffer("efgh");
+    CMBlockBufferRef third = _createBuffer("ijkl");
+    CMBlockBufferRef rope = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateEmpty(nullptr, 0, 0, &rope));
+    CMBlockBufferAppendBufferReference(rope, first, 0, 4, 0);
+    CMBlockBufferAppendBufferReference(rope, second, 0, 4, 0);
+    CMBlockBufferAppendBufferReference(rope, third, 0, 4, 0);
+
+    // A contiguous range comes back in place.
+    char* pointer = nullptr;
+    char* source = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAccessDataBytes(rope, 5, 2, nullptr, &pointer));
+    CMBlockBufferGetDataPointer(second, 1, nullptr, nullptr, &source);
+    EXPECT_EQ(source, pointer);
+
+    // A spanning range is copied to the temporary block without changing the buffer.
+    char temporary[6];
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAccessDataBytes(rope, 3, 6, temporary, &pointer));
+    EXPECT_EQ(temporary, pointer);
+    EXPECT_EQ(0, memcmp("defghi", pointer, 6));
+    EXPECT_FALSE(CMBlockBufferIsRangeContiguous(rope, 3, 6));
+
+    // Without one, the range is coalesced and stays contiguous.
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAccessDataBytes(rope, 3, 6, nullptr, &pointer));
+    EXPECT_EQ(0, memcmp("defghi", pointer, 6));
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(rope, 3, 6));
+    char* again = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAccessDataBytes(rope, 3, 6, nullptr, &again));
+    EXPECT_EQ(pointer, again);
+    EXPECT_EQ("abcdefghijkl", _contents(rope));
+
+    // Bytes outside the range still come from the original blocks.
+    CMBlockBufferGetDataPointer(rope, 0, nullptr, nullptr, &pointer);
+    CMBlockBufferGetDataPointer(first, 0, nullptr, nullptr, &source);
+    EXPECT_EQ(source, pointer);
+
+    EXPECT_EQ(kCMBlockBufferBadLengthParameterErr, CMBlockBufferAccessDataBytes(rope, 8, 5, nullptr, &pointer));
+
+    CFRelease(first);
+    CFRelease(second);
+    CFRelease(third);
+    CFRelease(rope);
+}
+
+TEST(CMBlockBuffer, CreateContiguous) {
+    CMBlockBufferRef first = _createBuffer("abcd");
+    CMBlockBufferRef second = _createBuffer("efgh");
+    CMBlockBufferRef rope = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateWithBufferReference(nullptr, first, 0, 4, 0, &rope));
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferAppendBufferReference(rope, second, 0, 4, 0));
+
+    CMBlockBufferRef contiguous = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateContiguous(nullptr, rope, nullptr, nullptr, 2, 0, 0, &contiguous));
+    EXPECT_EQ("cdefgh", _contents(contiguous));
+    EXPECT_TRUE(CMBlockBufferIsRangeContiguous(contiguous, 0, 0));
+    CFRelease(contiguous);
+
+    // A range that is already contiguous is referenced.
+    char* pointer = nullptr;
+    char* source = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateContiguous(nullptr, rope, nullptr, nullptr, 4, 4, 0, &contiguous));
+    CMBlockBufferGetDataPointer(contiguous, 0, nullptr, nullptr, &pointer);
+    CMBlockBufferGetDataPointer(second, 0, nullptr, nullptr, &source);
+    EXPECT_EQ(source, pointer);
+    CFRelease(contiguous);
+
+    CMBlockBufferRef empty = nullptr;
+    ASSERT_EQ(kCMBlockBufferNoErr, CMBlockBufferCreateEmpty(nullptr, 0, 0, &empty));
+    EXPECT_EQ(kCMBlockBufferEmptyBBufErr, CMBlockBufferCreateContiguous(nullptr, empty, nullptr, nullptr, 0, 0, 0, &contiguous));
+
+    CFRelease(empty);
+    CFRelease(first);
+    CFRelease(second);
+    CFRelease(rope);
+}
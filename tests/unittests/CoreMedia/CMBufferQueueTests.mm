@@ -0,0 +1,408 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <CoreMedia/CoreMedia.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// The queued buffers are block buffers holding their own timing, so the tests need no sample buffers.
+struct PacketTiming {
+    int64_t presentationTime;
+    int64_t duration;
+    int32_t timescale;
+    bool ready;
+};
+
+static CMBlockBufferRef _createPacket(int64_t presentationTime, int64_t duration = 1, int32_t timescale = 30, bool ready = true) {
+    PacketTiming timing = { presentationTime, duration, timescale, ready };
+    CMBlockBufferRef buffer = nullptr;
+    CMBlockBufferCreateWithMemoryBlock(
+        nullptr, nullptr, sizeof(timing), nullptr, nullptr, 0, sizeof(timing), kCMBlockBufferAssureMemoryNowFlag, &buffer);
+    CMBlockBufferReplaceDataBytes(&timing, buffer, 0, sizeof(timing));
+    return buffer;
+}
+
+static PacketTiming _timing(CMBufferRef buffer) {
+    PacketTiming timing;
+    CMBlockBufferCopyDataBytes(static_cast<CMBlockBufferRef>(const_cast<void*>(buffer)), 0, sizeof(timing), &timing);
+    return timing;
+}
+
+static CMTime _presentationTimeStamp(CMBufferRef buffer, void* refcon) {
+    PacketTiming timing = _timing(buffer);
+    return CMTimeMake(timing.presentationTime, timing.timescale);
+}
+
+static CMTime _duration(CMBufferRef buffer, void* refcon) {
+    PacketTiming timing = _timing(buffer);
+    return CMTimeMake(timing.duration, timing.timescale);
+}
+
+static Boolean _isDataReady(CMBufferRef buffer, void* refcon) {
+    return _timing(buffer).ready;
+}
+
+static size_t _size(CMBufferRef buffer, void* refcon) {
+    return CMBlockBufferGetDataLength(static_cast<CMBlockBufferRef>(const_cast<void*>(buffer)));
+}
+
+static CFComparisonResult _comparePresentationTimeStamps(CMBufferRef first, CMBufferRef second, void* refcon) {
+    int32_t result = CMTimeCompare(_presentationTimeStamp(first, refcon), _presentationTimeStamp(second, refcon));
+    return (result < 0) ? kCFCompareLessThan : (result > 0) ? kCFCompareGreaterThan : kCFCompareEqualTo;
+}
+
+static const CMBufferCallbacks c_unsortedCallbacks = {
+    0, nullptr, nullptr, _presentationTimeStamp, _duration, _isDataReady, nullptr, nullptr
+};
+static const CMBufferCallbacks c_sortedCallbacks = {
+    0, nullptr, nullptr, _presentationTimeStamp, _duration, _isDataReady, _comparePresentationTimeStamps, nullptr
+};
+
+static OSStatus _enqueuePacket(CMBufferQueueRef queue, CMBlockBufferRef packet) {
+    OSStatus status = CMBufferQueueEnqueue(queue, packet);
+    CFRelease(packet);
+    return status;
+}
+
+static int64_t _dequeuePresentationTime(CMBufferQueueRef queue) {
+    CMBufferRef buffer = CMBufferQueueDequeueAndRetain(queue);
+    if (!buffer) {
+        return -1;
+    }
+    int64_t presentationTime = _timing(buffer).presentationTime;
+    CFRelease(buffer);
+    return presentationTime;
+}
+
+static void _countTrigger(void* refcon, CMBufferQueueTriggerToken token) {
+    ++*static_cast<int*>(refcon);
+}
+
+TEST(CMBufferQueue, EnqueueAndDequeue) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    EXPECT_EQ(CMBufferQueueGetTypeID(), CFGetTypeID(queue));
+    EXPECT_TRUE(CMBufferQueueIsEmpty(queue));
+    EXPECT_EQ(nullptr, CMBufferQueueDequeueAndRetain(queue));
+
+    // Enough to grow the queue past its initial size.
+    for (int64_t index = 0; index < 100; ++index) {
+        ASSERT_EQ(noErr, _enqueuePacket(queue, _createPacket(index)));
+    }
+    EXPECT_EQ(100, CMBufferQueueGetBufferCount(queue));
+    EXPECT_EQ(0, _timing(CMBufferQueueGetHead(queue)).presentationTime);
+
+    for (int64_t index = 0; index < 100; ++index) {
+        ASSERT_EQ(index, _dequeuePresentationTime(queue));
+    }
+    EXPECT_TRUE(CMBufferQueueIsEmpty(queue));
+    CFRelease(queue);
+
+    EXPECT_EQ(kCMBufferQueueError_RequiredParameterMissing, CMBufferQueueCreate(nullptr, 0, nullptr, &queue));
+}
+
+TEST(CMBufferQueue, RetainsBuffers) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    CMBlockBufferRef packet = _createPacket(0);
+    CFIndex retainCount = CFGetRetainCount(packet);
+    ASSERT_EQ(noErr, CMBufferQueueEnqueue(queue, packet));
+    ASSERT_EQ(noErr, CMBufferQueueEnqueue(queue, packet));
+    EXPECT_EQ(retainCount + 2, CFGetRetainCount(packet));
+
+    CMBufferRef dequeued = CMBufferQueueDequeueAndRetain(queue);
+    EXPECT_EQ(packet, dequeued);
+    CFRelease(dequeued);
+
+    // Releasing the queue releases what it still holds.
+    CFRelease(queue);
+    EXPECT_EQ(retainCount, CFGetRetainCount(packet));
+    CFRelease(packet);
+}
+
+TEST(CMBufferQueue, Capacity) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 3, &c_unsortedCallbacks, &queue));
+    for (int64_t index = 0; index < 3; ++index) {
+        ASSERT_EQ(noErr, _enqueuePacket(queue, _createPacket(index)));
+    }
+    EXPECT_EQ(kCMBufferQueueError_QueueIsFull, _enqueuePacket(queue, _createPacket(3)));
+    EXPECT_EQ(0, _dequeuePresentationTime(queue));
+    EXPECT_EQ(noErr, _enqueuePacket(queue, _createPacket(3)));
+    EXPECT_EQ(3, CMBufferQueueGetBufferCount(queue));
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, Sorts) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_sortedCallbacks, &queue));
+    for (int64_t presentationTime : { 5, 1, 4, 2, 3 }) {
+        ASSERT_EQ(noErr, _enqueuePacket(queue, _createPacket(presentationTime)));
+    }
+
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(1, 30), CMBufferQueueGetFirstPresentationTimeStamp(queue)));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(1, 30), CMBufferQueueGetMinPresentationTimeStamp(queue)));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(5, 30), CMBufferQueueGetMaxPresentationTimeStamp(queue)));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(6, 30), CMBufferQueueGetEndPresentationTimeStamp(queue)));
+    EXPECT_TRUE(CMTIME_IS_INVALID(CMBufferQueueGetFirstDecodeTimeStamp(queue)));
+
+    for (int64_t presentationTime = 1; presentationTime <= 5; ++presentationTime) {
+        EXPECT_EQ(presentationTime, _dequeuePresentationTime(queue));
+    }
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, Duration) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    EXPECT_EQ(0, CMTimeCompare(kCMTimeZero, CMBufferQueueGetDuration(queue)));
+
+    _enqueuePacket(queue, _createPacket(0, 2));
+    _enqueuePacket(queue, _createPacket(2, 3));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(5, 30), CMBufferQueueGetDuration(queue)));
+
+    // A second timescale is summed exactly too.
+    _enqueuePacket(queue, _createPacket(0, 441, 44100));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(5 * 1470 + 441, 44100), CMBufferQueueGetDuration(queue)));
+
+    _dequeuePresentationTime(queue);
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(3 * 1470 + 441, 44100), CMBufferQueueGetDuration(queue)));
+    CMBufferQueueReset(queue);
+    EXPECT_EQ(0, CMTimeCompare(kCMTimeZero, CMBufferQueueGetDuration(queue)));
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, TotalSize) {
+    // Version 0 callbacks have no size callback.
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    _enqueuePacket(queue, _createPacket(0));
+    EXPECT_EQ(0u, CMBufferQueueGetTotalSize(queue));
+    CFRelease(queue);
+
+    const CMBufferCallbacks sizedCallbacks = {
+        1, nullptr, nullptr, _presentationTimeStamp, _duration, _isDataReady, nullptr, nullptr, _size
+    };
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &sizedCallbacks, &queue));
+    EXPECT_EQ(0u, CMBufferQueueGetTotalSize(queue));
+    for (int64_t index = 0; index < 3; ++index) {
+        _enqueuePacket(queue, _createPacket(index));
+    }
+    EXPECT_EQ(3 * sizeof(PacketTiming), CMBufferQueueGetTotalSize(queue));
+
+    _dequeuePresentationTime(queue);
+    EXPECT_EQ(2 * sizeof(PacketTiming), CMBufferQueueGetTotalSize(queue));
+
+    // The exclusive path, taken once a trigger is installed, accounts for sizes too.
+    int fired = 0;
+    CMBufferQueueInstallTriggerWithIntegerThreshold(
+        queue, _countTrigger, &fired, kCMBufferQueueTrigger_WhenBufferCountBecomesGreaterThan, 10, nullptr);
+    _enqueuePacket(queue, _createPacket(3));
+    EXPECT_EQ(3 * sizeof(PacketTiming), CMBufferQueueGetTotalSize(queue));
+    _dequeuePresentationTime(queue);
+    EXPECT_EQ(2 * sizeof(PacketTiming), CMBufferQueueGetTotalSize(queue));
+
+    CMBufferQueueReset(queue);
+    EXPECT_EQ(0u, CMBufferQueueGetTotalSize(queue));
+    CFRelease(queue);
+
+    CMBufferCallbacks unknownVersion = sizedCallbacks;
+    unknownVersion.version = 2;
+    EXPECT_EQ(kCMBufferQueueError_InvalidCMBufferCallbacksStruct, CMBufferQueueCreate(nullptr, 0, &unknownVersion, &queue));
+}
+
+TEST(CMBufferQueue, DequeueIfDataReady) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    _enqueuePacket(queue, _createPacket(0, 1, 30, false));
+    _enqueuePacket(queue, _createPacket(1));
+
+    EXPECT_EQ(nullptr, CMBufferQueueDequeueIfDataReadyAndRetain(queue));
+    EXPECT_EQ(2, CMBufferQueueGetBufferCount(queue));
+    EXPECT_EQ(0, _dequeuePresentationTime(queue));
+
+    CMBufferRef buffer = CMBufferQueueDequeueIfDataReadyAndRetain(queue);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_EQ(1, _timing(buffer).presentationTime);
+    CFRelease(buffer);
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, EndOfData) {
+    int reached = 0;
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    ASSERT_EQ(noErr,
+              CMBufferQueueInstallTrigger(
+                  queue, _countTrigger, &reached, kCMBufferQueueTrigger_WhenEndOfDataReached, kCMTimeInvalid, nullptr));
+
+    _enqueuePacket(queue, _createPacket(0));
+    ASSERT_EQ(noErr, CMBufferQueueMarkEndOfData(queue));
+    EXPECT_TRUE(CMBufferQueueContainsEndOfData(queue));
+    EXPECT_FALSE(CMBufferQueueIsAtEndOfData(queue));
+    EXPECT_EQ(kCMBufferQueueError_EnqueueAfterEndOfData, _enqueuePacket(queue, _createPacket(1)));
+    EXPECT_EQ(0, reached);
+
+    _dequeuePresentationTime(queue);
+    EXPECT_TRUE(CMBufferQueueIsAtEndOfData(queue));
+    EXPECT_EQ(1, reached);
+
+    // Reset clears the marker.
+    CMBufferQueueReset(queue);
+    EXPECT_FALSE(CMBufferQueueContainsEndOfData(queue));
+    EXPECT_EQ(noErr, _enqueuePacket(queue, _createPacket(1)));
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, Triggers) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+
+    int longerThanTwo = 0;
+    int fewerThanOne = 0;
+    int minChanged = 0;
+    int reset = 0;
+    CMBufferQueueTriggerToken longerToken = nullptr;
+    ASSERT_EQ(noErr,
+              CMBufferQueueInstallTrigger(queue,
+                                          _countTrigger,
+                                          &longerThanTwo,
+                                          kCMBufferQueueTrigger_WhenDurationBecomesGreaterThan,
+                                          CMTimeMake(2, 30),
+                                          &longerToken));
+    ASSERT_EQ(noErr,
+              CMBufferQueueInstallTriggerWithIntegerThreshold(
+                  queue, _countTrigger, &fewerThanOne, kCMBufferQueueTrigger_WhenBufferCountBecomesLessThan, 1, nullptr));
+    ASSERT_EQ(noErr,
+              CMBufferQueueInstallTrigger(
+                  queue, _countTrigger, &minChanged, kCMBufferQueueTrigger_WhenMinPresentationTimeStampChanges, kCMTimeInvalid, nullptr));
+    ASSERT_EQ(noErr, CMBufferQueueInstallTrigger(queue, _countTrigger, &reset, kCMBufferQueueTrigger_WhenReset, kCMTimeInvalid, nullptr));
+
+    _enqueuePacket(queue, _createPacket(10));
+    _enqueuePacket(queue, _createPacket(11));
+    EXPECT_EQ(0, longerThanTwo);
+    EXPECT_FALSE(CMBufferQueueTestTrigger(queue, longerToken));
+    _enqueuePacket(queue, _createPacket(12));
+    EXPECT_EQ(1, longerThanTwo);
+    EXPECT_TRUE(CMBufferQueueTestTrigger(queue, longerToken));
+    _enqueuePacket(queue, _createPacket(13));
+    EXPECT_EQ(1, longerThanTwo);
+    EXPECT_EQ(1, minChanged);
+
+    _dequeuePresentationTime(queue);
+    EXPECT_EQ(2, minChanged);
+    CMBufferQueueReset(queue);
+    EXPECT_EQ(1, fewerThanOne);
+    EXPECT_EQ(1, reset);
+    EXPECT_EQ(3, minChanged);
+
+    // A removed trigger no longer fires.
+    ASSERT_EQ(noErr, CMBufferQueueRemoveTrigger(queue, longerToken));
+    EXPECT_EQ(kCMBufferQueueError_InvalidTriggerToken, CMBufferQueueRemoveTrigger(queue, longerToken));
+    for (int64_t index = 0; index < 4; ++index) {
+        _enqueuePacket(queue, _createPacket(index));
+    }
+    EXPECT_EQ(1, longerThanTwo);
+
+    EXPECT_EQ(kCMBufferQueueError_BadTriggerDuration,
+              CMBufferQueueInstallTrigger(
+                  queue, _countTrigger, &reset, kCMBufferQueueTrigger_WhenDurationBecomesLessThan, kCMTimeInvalid, nullptr));
+    EXPECT_EQ(kCMBufferQueueError_InvalidTriggerCondition,
+              CMBufferQueueInstallTriggerWithIntegerThreshold(queue, _countTrigger, &reset, kCMBufferQueueTrigger_WhenReset, 1, nullptr));
+    CFRelease(queue);
+}
+
+static OSStatus _rejectOddPackets(CMBufferQueueRef queue, CMBufferRef buffer, void* refcon) {
+    if (_timing(buffer).presentationTime % 2) {
+        return kCMBufferQueueError_InvalidBuffer;
+    }
+    return noErr;
+}
+
+TEST(CMBufferQueue, Validation) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    ASSERT_EQ(noErr, CMBufferQueueSetValidationCallback(queue, _rejectOddPackets, nullptr));
+    EXPECT_EQ(noErr, _enqueuePacket(queue, _createPacket(0)));
+    EXPECT_EQ(kCMBufferQueueError_InvalidBuffer, _enqueuePacket(queue, _createPacket(1)));
+    EXPECT_EQ(1, CMBufferQueueGetBufferCount(queue));
+    CFRelease(queue);
+}
+
+static OSStatus _sumPresentationTimes(CMBufferRef buffer, void* refcon) {
+    *static_cast<int64_t*>(refcon) += _timing(buffer).presentationTime;
+    return noErr;
+}
+
+TEST(CMBufferQueue, CallForEachBuffer) {
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 0, &c_unsortedCallbacks, &queue));
+    for (int64_t index = 1; index <= 4; ++index) {
+        _enqueuePacket(queue, _createPacket(index));
+    }
+    int64_t sum = 0;
+    EXPECT_EQ(noErr, CMBufferQueueCallForEachBuffer(queue, _sumPresentationTimes, &sum));
+    EXPECT_EQ(10, sum);
+    CFRelease(queue);
+}
+
+TEST(CMBufferQueue, ConcurrentProducersAndConsumers) {
+    static const int c_threads = 4;
+    static const int64_t c_packetsPerThread = 5000;
+
+    CMBufferQueueRef queue = nullptr;
+    ASSERT_EQ(noErr, CMBufferQueueCreate(nullptr, 64, &c_unsortedCallbacks, &queue));
+
+    std::atomic<int64_t> consumed(0);
+    std::atomic<int64_t> sum(0);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < c_threads; ++thread) {
+        threads.emplace_back([queue, thread]() {
+            for (int64_t index = 0; index < c_packetsPerThread; ++index) {
+                CMBlockBufferRef packet = _createPacket(thread * c_packetsPerThread + index);
+                while (CMBufferQueueEnqueue(queue, packet) == kCMBufferQueueError_QueueIsFull) {
+                    std::this_thread::yield();
+                }
+                CFRelease(packet);
+            }
+        });
+        threads.emplace_back([queue, &consumed, &sum]() {
+            while (consumed.load() < c_threads * c_packetsPerThread) {
+                CMBufferRef buffer = CMBufferQueueDequeueAndRetain(queue);
+                if (!buffer) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                sum += _timing(buffer).presentationTime;
+                ++consumed;
+                CFRelease(buffer);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    int64_t total = c_threads * c_packetsPerThread;
+    EXPECT_EQ(total, consumed.load());
+    EXPECT_EQ(total * (total - 1) / 2, sum.load());
+    EXPECT_TRUE(CMBufferQueueIsEmpty(queue));
+    EXPECT_EQ(0, CMTimeCompare(kCMTimeZero, CMBufferQueueGetDuration(queue)));
+    CFRelease(queue);
+}
@@ -0,0 +1,107 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <CoreMedia/CoreMedia.h>
+
+#include <math.h>
+#include <stdint.h>
+
+TEST(CMTime, Make) {
+    CMTime time = CMTimeMake(3, 2);
+    EXPECT_TRUE(CMTIME_IS_NUMERIC(time));
+    EXPECT_EQ(3, time.value);
+    EXPECT_EQ(2, time.timescale);
+    EXPECT_EQ(0, time.epoch);
+    EXPECT_DOUBLE_EQ(1.5, CMTimeGetSeconds(time));
+
+    EXPECT_TRUE(CMTIME_IS_INVALID(CMTimeMake(1, 0)));
+    EXPECT_EQ(7, CMTimeMakeWithEpoch(1, 1, 7).epoch);
+    EXPECT_TRUE(isnan(CMTimeGetSeconds(kCMTimeIndefinite)));
+    EXPECT_EQ(INFINITY, CMTimeGetSeconds(kCMTimePositiveInfinity));
+}
+
+TEST(CMTime, AddAndSubtract) {
+    CMTime sum = CMTimeAdd(CMTimeMake(1, 3), CMTimeMake(1, 2));
+    EXPECT_EQ(5, sum.value);
+    EXPECT_EQ(6, sum.timescale);
+    EXPECT_FALSE(sum.flags & kCMTimeFlags_HasBeenRounded);
+
+    CMTime difference = CMTimeSubtract(CMTimeMake(1, 2), CMTimeMake(1, 3));
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(1, 6), difference));
+
+    EXPECT_TRUE(CMTIME_IS_POSITIVE_INFINITY(CMTimeAdd(kCMTimePositiveInfinity, CMTimeMake(1, 1))));
+    EXPECT_TRUE(CMTIME_IS_INVALID(CMTimeAdd(kCMTimePositiveInfinity, kCMTimeNegativeInfinity)));
+    EXPECT_TRUE(CMTIME_IS_INDEFINITE(CMTimeAdd(kCMTimeIndefinite, CMTimeMake(1, 1))));
+    EXPECT_TRUE(CMTIME_IS_INVALID(CMTimeAdd(CMTimeMakeWithEpoch(1, 1, 0), CMTimeMakeWithEpoch(1, 1, 1))));
+    EXPECT_TRUE(CMTIME_IS_POSITIVE_INFINITY(CMTimeAdd(CMTimeMake(INT64_MAX, 1), CMTimeMake(1, 1))));
+}
+
+TEST(CMTime, AddRoundsToTheFinerTimescale) {
+    // The least common multiple of two large primes does not fit in a timescale.
+    CMTime sum = CMTimeAdd(CMTimeMake(1, 1000003), CMTimeMake(1, 999983));
+    EXPECT_EQ(1000003, sum.timescale);
+    EXPECT_TRUE(sum.flags & kCMTimeFlags_HasBeenRounded);
+    EXPECT_NEAR(1.0 / 1000003 + 1.0 / 999983, CMTimeGetSeconds(sum), 1e-6);
+}
+
+TEST(CMTime, Compare) {
+    EXPECT_EQ(0, CMTimeCompare(CMTimeMake(1, 2), CMTimeMake(500, 1000)));
+    EXPECT_EQ(-1, CMTimeCompare(CMTimeMake(1, 3), CMTimeMake(1, 2)));
+    EXPECT_EQ(1, CMTimeCompare(CMTimeMake(-1, 3), CMTimeMake(-1, 2)));
+
+    // Values whose cross products would overflow still compare exactly.
+    EXPECT_EQ(-1, CMTimeCompare(CMTimeMake(INT64_MAX - 1, 1000000007), CMTimeMake(INT64_MAX, 1000000007)));
+    EXPECT_EQ(1, CMTimeCompare(CMTimeMake(INT64_MAX, 3), CMTimeMake(INT64_MAX, 4)));
+
+    EXPECT_EQ(-1, CMTimeCompare(kCMTimeNegativeInfinity, CMTimeMake(INT64_MIN, 1)));
+    EXPECT_EQ(-1, CMTimeCompare(CMTimeMake(INT64_MAX, 1), kCMTimeIndefinite));
+    EXPECT_EQ(-1, CMTimeCompare(kCMTimeIndefinite, kCMTimePositiveInfinity));
+    EXPECT_EQ(-1, CMTimeCompare(kCMTimePositiveInfinity, kCMTimeInvalid));
+    EXPECT_EQ(-1, CMTimeCompare(CMTimeMakeWithEpoch(5, 1, 0), CMTimeMakeWithEpoch(1, 1, 1)));
+
+    EXPECT_TRUE(CMTIME_IS_INVALID(CMTimeMaximum(CMTimeMake(1, 1), kCMTimeInvalid)));
+    EXPECT_EQ(2, CMTimeMaximum(CMTimeMake(1, 1), CMTimeMake(2, 1)).value);
+    EXPECT_TRUE(CMTIME_IS_NEGATIVE_INFINITY(CMTimeMinimum(CMTimeMake(1, 1), kCMTimeNegativeInfinity)));
+}
+
+TEST(CMTime, ConvertScale) {
+    CMTime exact = CMTimeConvertScale(CMTimeMake(3, 2), 10, kCMTimeRoundingMethod_Default);
+    EXPECT_EQ(15, exact.value);
+    EXPECT_FALSE(exact.flags & kCMTimeFlags_HasBeenRounded);
+
+    CMTime time = CMTimeMake(5, 3);
+    EXPECT_EQ(2, CMTimeConvertScale(time, 1, kCMTimeRoundingMethod_RoundHalfAwayFromZero).value);
+    EXPECT_EQ(1, CMTimeConvertScale(time, 1, kCMTimeRoundingMethod_RoundTowardZero).value);
+    EXPECT_EQ(1, CMTimeConvertScale(time, 1, kCMTimeRoundingMethod_RoundTowardNegativeInfinity).value);
+    EXPECT_EQ(-2, CMTimeConvertScale(CMTimeMake(-5, 3), 1, kCMTimeRoundingMethod_RoundTowardNegativeInfinity).value);
+    EXPECT_EQ(-1, CMTimeConvertScale(CMTimeMake(-5, 3), 1, kCMTimeRoundingMethod_RoundTowardPositiveInfinity).value);
+    EXPECT_TRUE(CMTimeConvertScale(time, 1, kCMTimeRoundingMethod_Default).flags & kCMTimeFlags_HasBeenRounded);
+
+    // A large value rescales without overflowing the intermediate product.
+    CMTime large = CMTimeConvertScale(CMTimeMake(INT64_MAX / 2, 90000), 48000, kCMTimeRoundingMethod_RoundTowardZero);
+    EXPECT_TRUE(CMTIME_IS_NUMERIC(large));
+    EXPECT_NEAR(CMTimeGetSeconds(CMTimeMake(INT64_MAX / 2, 90000)), CMTimeGetSeconds(large), 1e-3 * CMTimeGetSeconds(large));
+
+    EXPECT_TRUE(CMTIME_IS_POSITIVE_INFINITY(CMTimeConvertScale(CMTimeMake(INT64_MAX, 1), 2, kCMTimeRoundingMethod_Default)));
+    EXPECT_TRUE(CMTIME_IS_INDEFINITE(CMTimeConvertScale(kCMTimeIndefinite, 2, kCMTimeRoundingMethod_Default)));
+}
+
+TEST(CMTime, AbsoluteValue) {
+    EXPECT_EQ(3, CMTimeAbsoluteValue(CMTimeMake(-3, 1)).value);
+    EXPECT_EQ(3, CMTimeAbsoluteValue(CMTimeMake(3, 1)).value);
+    EXPECT_TRUE(CMTIME_IS_POSITIVE_INFINITY(CMTimeAbsoluteValue(kCMTimeNegativeInfinity)));
+}
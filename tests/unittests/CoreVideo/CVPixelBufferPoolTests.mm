@@ -0,0 +1,260 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <CoreVideo/CoreVideo.h>
+#import <CoreFoundation/CFNumber.h>
+
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static void _setNumber(CFMutableDictionaryRef dictionary, CFStringRef key, CFNumberType type, const void* value) {
+    CFNumberRef number = CFNumberCreate(nullptr, type, value);
+    CFDictionarySetValue(dictionary, key, number);
+    CFRelease(number);
+}
+
+static CFMutableDictionaryRef _createDictionary() {
+    return CFDictionaryCreateMutable(nullptr, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+}
+
+static CFMutableDictionaryRef _createPixelBufferAttributes(int width, int height, OSType pixelFormat) {
+    CFMutableDictionaryRef attributes = _createDictionary();
+    _setNumber(attributes, kCVPixelBufferWidthKey, kCFNumberIntType, &width);
+    _setNumber(attributes, kCVPixelBufferHeightKey, kCFNumberIntType, &height);
+    _setNumber(attributes, kCVPixelBufferPixelFormatTypeKey, kCFNumberSInt32Type, &pixelFormat);
+    return attributes;
+}
+
+static CVPixelBufferPoolRef _createPool(int width, int height, OSType pixelFormat, CFDictionaryRef poolAttributes = nullptr) {
+    CFDictionaryRef attributes = _createPixelBufferAttributes(width, height, pixelFormat);
+    CVPixelBufferPoolRef pool = nullptr;
+    EXPECT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreate(nullptr, poolAttributes, attributes, &pool));
+    CFRelease(attributes);
+    return pool;
+}
+
+static CFDictionaryRef _createThreshold(int threshold) {
+    CFMutableDictionaryRef auxAttributes = _createDictionary();
+    _setNumber(auxAttributes, kCVPixelBufferPoolAllocationThresholdKey, kCFNumberIntType, &threshold);
+    return auxAttributes;
+}
+
+TEST(CVPixelBufferPool, VendsBuffersMatchingAttributes) {
+    CVPixelBufferPoolRef pool = _createPool(1280, 720, kCVPixelFormatType_420YpCbCr8BiPlanarFullRange);
+    ASSERT_NE(nullptr, pool);
+    EXPECT_EQ(CVPixelBufferPoolGetTypeID(), CFGetTypeID(pool));
+    EXPECT_NE(nullptr, CVPixelBufferPoolGetAttributes(pool));
+
+    int width = 0;
+    CFDictionaryRef attributes = CVPixelBufferPoolGetPixelBufferAttributes(pool);
+    CFNumberGetValue(static_cast<CFNumberRef>(CFDictionaryGetValue(attributes, kCVPixelBufferWidthKey)), kCFNumberIntType, &width);
+    EXPECT_EQ(1280, width);
+
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &pixelBuffer));
+    EXPECT_EQ(1280u, CVPixelBufferGetWidth(pixelBuffer));
+    EXPECT_EQ(720u, CVPixelBufferGetHeight(pixelBuffer));
+    EXPECT_EQ(2u, CVPixelBufferGetPlaneCount(pixelBuffer));
+    EXPECT_EQ(640u, CVPixelBufferGetWidthOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(1280u, CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0));
+
+    CVPixelBufferRelease(pixelBuffer);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, AcceptsArrayOfPixelFormats) {
+    CFMutableDictionaryRef attributes = _createPixelBufferAttributes(64, 64, 0);
+    int formats[] = { kCVPixelFormatType_32BGRA, kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange };
+    CFNumberRef numbers[] = { CFNumberCreate(nullptr, kCFNumberIntType, &formats[0]),
+                              CFNumberCreate(nullptr, kCFNumberIntType, &formats[1]) };
+    CFArrayRef array = CFArrayCreate(nullptr, reinterpret_cast<const void**>(numbers), 2, &kCFTypeArrayCallBacks);
+    CFDictionarySetValue(attributes, kCVPixelBufferPixelFormatTypeKey, array);
+    CFRelease(array);
+    CFRelease(numbers[0]);
+    CFRelease(numbers[1]);
+
+    CVPixelBufferPoolRef pool = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreate(nullptr, nullptr, attributes, &pool));
+    CFRelease(attributes);
+
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &pixelBuffer));
+    EXPECT_EQ(static_cast<OSType>(kCVPixelFormatType_32BGRA), CVPixelBufferGetPixelFormatType(pixelBuffer));
+
+    CVPixelBufferRelease(pixelBuffer);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, RejectsIncompleteAttributes) {
+    CVPixelBufferPoolRef pool = nullptr;
+    EXPECT_EQ(kCVReturnInvalidPixelBufferAttributes, CVPixelBufferPoolCreate(nullptr, nullptr, nullptr, &pool));
+
+    CFMutableDictionaryRef attributes = _createPixelBufferAttributes(64, 64, kCVPixelFormatType_32BGRA);
+    CFDictionaryRemoveValue(attributes, kCVPixelBufferHeightKey);
+    EXPECT_EQ(kCVReturnInvalidPixelBufferAttributes, CVPixelBufferPoolCreate(nullptr, nullptr, attributes, &pool));
+    CFRelease(attributes);
+
+    attributes = _createPixelBufferAttributes(64, 64, 'none');
+    EXPECT_EQ(kCVReturnInvalidPixelFormat, CVPixelBufferPoolCreate(nullptr, nullptr, attributes, &pool));
+    CFRelease(attributes);
+    EXPECT_EQ(nullptr, pool);
+}
+
+TEST(CVPixelBufferPool, RecyclesReleasedBuffers) {
+    CVPixelBufferPoolRef pool = _createPool(640, 480, kCVPixelFormatType_32BGRA);
+
+    CVPixelBufferRef first = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &first));
+    void* memory = CVPixelBufferGetBaseAddress(first);
+    CVPixelBufferRelease(first);
+
+    CVPixelBufferRef second = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &second));
+    EXPECT_EQ(memory, CVPixelBufferGetBaseAddress(second));
+
+    // A buffer still in use is never handed out twice.
+    CVPixelBufferRef third = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &third));
+    EXPECT_NE(memory, CVPixelBufferGetBaseAddress(third));
+
+    CVPixelBufferRelease(second);
+    CVPixelBufferRelease(third);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, AllocationThreshold) {
+    CVPixelBufferPoolRef pool = _createPool(64, 64, kCVPixelFormatType_32BGRA);
+    CFDictionaryRef auxAttributes = _createThreshold(2);
+
+    CVPixelBufferRef buffers[3] = {};
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[0]));
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[1]));
+    EXPECT_EQ(kCVReturnWouldExceedAllocationThreshold,
+              CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[2]));
+
+    // Without a threshold the pool keeps allocating.
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &buffers[2]));
+    CVPixelBufferRelease(buffers[2]);
+
+    void* memory = CVPixelBufferGetBaseAddress(buffers[0]);
+    CVPixelBufferRelease(buffers[0]);
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[0]));
+    EXPECT_EQ(memory, CVPixelBufferGetBaseAddress(buffers[0]));
+
+    CVPixelBufferRelease(buffers[0]);
+    CVPixelBufferRelease(buffers[1]);
+    CFRelease(auxAttributes);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, AgesOutUnusedBuffers) {
+    CFMutableDictionaryRef poolAttributes = _createDictionary();
+    double maximumAge = 0.01;
+    int minimumCount = 1;
+    _setNumber(poolAttributes, kCVPixelBufferPoolMaximumBufferAgeKey, kCFNumberDoubleType, &maximumAge);
+    _setNumber(poolAttributes, kCVPixelBufferPoolMinimumBufferCountKey, kCFNumberIntType, &minimumCount);
+    CVPixelBufferPoolRef pool = _createPool(64, 64, kCVPixelFormatType_32BGRA, poolAttributes);
+    CFRelease(poolAttributes);
+
+    CVPixelBufferRef buffers[3] = {};
+    for (CVPixelBufferRef& buffer : buffers) {
+        ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &buffer));
+    }
+    for (CVPixelBufferRef buffer : buffers) {
+        CVPixelBufferRelease(buffer);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Two of the three free buffers aged out; the minimum count keeps the third, so a threshold of two admits one new allocation.
+    CFDictionaryRef auxAttributes = _createThreshold(2);
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[0]));
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[1]));
+    EXPECT_EQ(kCVReturnWouldExceedAllocationThreshold,
+              CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[2]));
+
+    CVPixelBufferRelease(buffers[0]);
+    CVPixelBufferRelease(buffers[1]);
+    CFRelease(auxAttributes);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, FlushFreesUnusedBuffers) {
+    CVPixelBufferPoolRef pool = _createPool(64, 64, kCVPixelFormatType_32BGRA);
+    CVPixelBufferRef buffers[3] = {};
+    for (CVPixelBufferRef& buffer : buffers) {
+        ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &buffer));
+    }
+    CVPixelBufferRelease(buffers[2]);
+    CVPixelBufferRelease(buffers[1]);
+
+    // None of the free buffers is old enough to age out, so one is reused even though the pool is over the threshold.
+    CVPixelBufferPoolFlush(pool, 0);
+    CFDictionaryRef auxAttributes = _createThreshold(1);
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[1]));
+    CVPixelBufferRelease(buffers[1]);
+    CFRelease(auxAttributes);
+
+    // Once flushed, only the buffer still in use counts against the threshold.
+    CVPixelBufferPoolFlush(pool, kCVPixelBufferPoolFlushExcessBuffers);
+    auxAttributes = _createThreshold(2);
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[1]));
+    EXPECT_EQ(kCVReturnWouldExceedAllocationThreshold,
+              CVPixelBufferPoolCreatePixelBufferWithAuxAttributes(nullptr, pool, auxAttributes, &buffers[2]));
+
+    // Flushing leaves buffers in use alone.
+    memset(CVPixelBufferGetBaseAddress(buffers[0]), 0xff, CVPixelBufferGetBytesPerRow(buffers[0]) * 64);
+    CVPixelBufferRelease(buffers[0]);
+    CVPixelBufferRelease(buffers[1]);
+    CFRelease(auxAttributes);
+    CVPixelBufferPoolRelease(pool);
+}
+
+TEST(CVPixelBufferPool, BuffersOutliveThePool) {
+    CVPixelBufferPoolRef pool = _createPool(64, 64, kCVPixelFormatType_32BGRA);
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &pixelBuffer));
+    CVPixelBufferPoolRelease(pool);
+
+    memset(CVPixelBufferGetBaseAddress(pixelBuffer), 0xff, CVPixelBufferGetBytesPerRow(pixelBuffer) * 64);
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+TEST(CVPixelBufferPool, ConcurrentUse) {
+    CVPixelBufferPoolRef pool = _createPool(256, 256, kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange);
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([pool, thread]() {
+            for (int i = 0; i < 500; ++i) {
+                CVPixelBufferRef pixelBuffer = nullptr;
+                ASSERT_EQ(kCVReturnSuccess, CVPixelBufferPoolCreatePixelBuffer(nullptr, pool, &pixelBuffer));
+                CVPixelBufferLockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0));
+                static_cast<uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0))[0] = static_cast<uint8_t>(thread);
+                CVPixelBufferUnlockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0));
+                CVPixelBufferRelease(pixelBuffer);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CVPixelBufferPoolRelease(pool);
+}
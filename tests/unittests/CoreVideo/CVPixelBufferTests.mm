@@ -0,0 +1,301 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <CoreVideo/CoreVideo.h>
+#import <CoreFoundation/CFByteOrder.h>
+#import <CoreFoundation/CFNumber.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <initializer_list>
+#include <utility>
+
+static CFDictionaryRef _createAttributes(std::initializer_list<std::pair<CFStringRef, long long>> values) {
+    CFMutableDictionaryRef attributes =
+        CFDictionaryCreateMutable(nullptr, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    for (const auto& value : values) {
+        CFNumberRef number = CFNumberCreate(nullptr, kCFNumberLongLongType, &value.second);
+        CFDictionarySetValue(attributes, value.first, number);
+        CFRelease(number);
+    }
+    return attributes;
+}
+
+static bool _isAligned(const void* pointer, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+TEST(CVPixelBuffer, ChunkyLayout) {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreate(nullptr, 100, 30, kCVPixelFormatType_32BGRA, nullptr, &pixelBuffer));
+
+    EXPECT_EQ(CVPixelBufferGetTypeID(), CFGetTypeID(pixelBuffer));
+    EXPECT_EQ(100u, CVPixelBufferGetWidth(pixelBuffer));
+    EXPECT_EQ(30u, CVPixelBufferGetHeight(pixelBuffer));
+    EXPECT_EQ(static_cast<OSType>(kCVPixelFormatType_32BGRA), CVPixelBufferGetPixelFormatType(pixelBuffer));
+    EXPECT_FALSE(CVPixelBufferIsPlanar(pixelBuffer));
+    EXPECT_EQ(0u, CVPixelBufferGetPlaneCount(pixelBuffer));
+    EXPECT_EQ(nullptr, CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0));
+
+    // 400 bytes of pixels, padded to a multiple of 64.
+    EXPECT_EQ(448u, CVPixelBufferGetBytesPerRow(pixelBuffer));
+    EXPECT_LE(448u * 30, CVPixelBufferGetDataSize(pixelBuffer));
+    EXPECT_TRUE(_isAligned(CVPixelBufferGetBaseAddress(pixelBuffer), 64));
+
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+TEST(CVPixelBuffer, BiPlanarLayout) {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess,
+              CVPixelBufferCreate(nullptr, 1921, 1081, kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange, nullptr, &pixelBuffer));
+
+    EXPECT_TRUE(CVPixelBufferIsPlanar(pixelBuffer));
+    ASSERT_EQ(2u, CVPixelBufferGetPlaneCount(pixelBuffer));
+    EXPECT_EQ(0u, CVPixelBufferGetBytesPerRow(pixelBuffer));
+
+    EXPECT_EQ(1921u, CVPixelBufferGetWidthOfPlane(pixelBuffer, 0));
+    EXPECT_EQ(1081u, CVPixelBufferGetHeightOfPlane(pixelBuffer, 0));
+    EXPECT_EQ(1984u, CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0));
+    EXPECT_EQ(961u, CVPixelBufferGetWidthOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(541u, CVPixelBufferGetHeightOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(1984u, CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(0u, CVPixelBufferGetWidthOfPlane(pixelBuffer, 2));
+
+    uint8_t* base = static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+    uint8_t* luma = static_cast<uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 0));
+    uint8_t* chroma = static_cast<uint8_t*>(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1));
+    EXPECT_TRUE(_isAligned(luma, 64));
+    EXPECT_TRUE(_isAligned(chroma, 64));
+    EXPECT_LE(luma + 1984 * 1081, chroma);
+    EXPECT_LE(chroma + 1984 * 541, base + CVPixelBufferGetDataSize(pixelBuffer));
+
+    // The base address of a planar buffer describes its planes.
+    const CVPlanarPixelBufferInfo_YCbCrBiPlanar* info = reinterpret_cast<const CVPlanarPixelBufferInfo_YCbCrBiPlanar*>(base);
+    EXPECT_EQ(luma - base, static_cast<int32_t>(CFSwapInt32BigToHost(info->componentInfoY.offset)));
+    EXPECT_EQ(1984u, CFSwapInt32BigToHost(info->componentInfoY.rowBytes));
+    EXPECT_EQ(chroma - base, static_cast<int32_t>(CFSwapInt32BigToHost(info->componentInfoCbCr.offset)));
+
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+TEST(CVPixelBuffer, ThreePlaneLayout) {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreate(nullptr, 64, 48, kCVPixelFormatType_420YpCbCr8Planar, nullptr, &pixelBuffer));
+
+    ASSERT_EQ(3u, CVPixelBufferGetPlaneCount(pixelBuffer));
+    EXPECT_EQ(64u, CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, 0));
+    for (size_t plane = 1; plane < 3; ++plane) {
+        EXPECT_EQ(32u, CVPixelBufferGetWidthOfPlane(pixelBuffer, plane));
+        EXPECT_EQ(24u, CVPixelBufferGetHeightOfPlane(pixelBuffer, plane));
+        EXPECT_EQ(64u, CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, plane));
+        EXPECT_TRUE(_isAligned(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, plane), 64));
+    }
+
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+TEST(CVPixelBuffer, AlignmentAttributes) {
+    // Rows are aligned to both the requested alignment and CoreVideo's own 64 bytes.
+    CFDictionaryRef attributes = _createAttributes({ { kCVPixelBufferBytesPerRowAlignmentKey, 48 } });
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreate(nullptr, 100, 10, kCVPixelFormatType_32BGRA, attributes, &pixelBuffer));
+    EXPECT_EQ(576u, CVPixelBufferGetBytesPerRow(pixelBuffer));
+    CVPixelBufferRelease(pixelBuffer);
+    CFRelease(attributes);
+
+    attributes = _createAttributes({ { kCVPixelBufferPlaneAlignmentKey, 4096 } });
+    ASSERT_EQ(kCVReturnSuccess,
+              CVPixelBufferCreate(nullptr, 100, 10, kCVPixelFormatType_420YpCbCr8BiPlanarFullRange, attributes, &pixelBuffer));
+    EXPECT_TRUE(_isAligned(CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1), 4096));
+    CVPixelBufferRelease(pixelBuffer);
+    CFRelease(attributes);
+}
+
+TEST(CVPixelBuffer, InvalidArguments) {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    EXPECT_EQ(kCVReturnInvalidPixelFormat, CVPixelBufferCreate(nullptr, 16, 16, 'none', nullptr, &pixelBuffer));
+    EXPECT_EQ(kCVReturnInvalidSize, CVPixelBufferCreate(nullptr, 0, 16, kCVPixelFormatType_32BGRA, nullptr, &pixelBuffer));
+    EXPECT_EQ(kCVReturnInvalidArgument, CVPixelBufferCreate(nullptr, 16, 16, kCVPixelFormatType_32BGRA, nullptr, nullptr));
+    EXPECT_EQ(nullptr, pixelBuffer);
+}
+
+TEST(CVPixelBuffer, ExtendedPixels) {
+    CFDictionaryRef attributes = _createAttributes({ { kCVPixelBufferExtendedPixelsLeftKey, 2 },
+                                                     { kCVPixelBufferExtendedPixelsRightKey, 3 },
+                                                     { kCVPixelBufferExtendedPixelsTopKey, 1 },
+                                                     { kCVPixelBufferExtendedPixelsBottomKey, 2 } });
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreate(nullptr, 4, 2, kCVPixelFormatType_32BGRA, attributes, &pixelBuffer));
+    CFRelease(attributes);
+
+    size_t left, right, top, bottom;
+    CVPixelBufferGetExtendedPixels(pixelBuffer, &left, &right, &top, &bottom);
+    EXPECT_EQ(2u, left);
+    EXPECT_EQ(3u, right);
+    EXPECT_EQ(1u, top);
+    EXPECT_EQ(2u, bottom);
+
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferLockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0)));
+    uint8_t* base = static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+    size_t bytesPerRow = CVPixelBufferGetBytesPerRow(pixelBuffer);
+    for (size_t row = 0; row < 2; ++row) {
+        uint32_t* pixels = reinterpret_cast<uint32_t*>(base + row * bytesPerRow);
+        for (size_t column = 0; column < 4; ++column) {
+            pixels[column] = static_cast<uint32_t>(row * 10 + column);
+        }
+    }
+
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferFillExtendedPixels(pixelBuffer));
+
+    auto pixel = [&](ptrdiff_t row, ptrdiff_t column) { return reinterpret_cast<uint32_t*>(base + row * ptrdiff_t(bytesPerRow))[column]; };
+    EXPECT_EQ(0u, pixel(0, -2));
+    EXPECT_EQ(0u, pixel(0, -1));
+    EXPECT_EQ(3u, pixel(0, 6));
+    EXPECT_EQ(10u, pixel(1, -1));
+    EXPECT_EQ(13u, pixel(1, 4));
+    EXPECT_EQ(0u, pixel(-1, -2));
+    EXPECT_EQ(2u, pixel(-1, 2));
+    EXPECT_EQ(13u, pixel(3, 6));
+    EXPECT_EQ(11u, pixel(3, 1));
+    EXPECT_EQ(kCVReturnSuccess, CVPixelBufferUnlockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0)));
+
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+TEST(CVPixelBuffer, LockingKeepsPointersStable) {
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreate(nullptr, 32, 32, kCVPixelFormatType_OneComponent8, nullptr, &pixelBuffer));
+
+    EXPECT_EQ(kCVReturnError, CVPixelBufferUnlockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0)));
+
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferLockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0)));
+    uint8_t* written = static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+    memset(written, 0x5a, 32);
+    EXPECT_EQ(kCVReturnSuccess, CVPixelBufferUnlockBaseAddress(pixelBuffer, CVPixelBufferLockFlags(0)));
+
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly));
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly));
+    uint8_t* read = static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+    EXPECT_EQ(written, read);
+    EXPECT_EQ(0x5a, read[31]);
+    EXPECT_EQ(kCVReturnSuccess, CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly));
+    EXPECT_EQ(kCVReturnSuccess, CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly));
+    EXPECT_EQ(kCVReturnError, CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly));
+
+    CVPixelBufferRelease(pixelBuffer);
+}
+
+struct ReleasedBytes {
+    int count;
+    const void* address;
+    size_t planes;
+};
+
+static void _releaseBytes(void* releaseRefCon, const void* baseAddress) {
+    ReleasedBytes* released = static_cast<ReleasedBytes*>(releaseRefCon);
+    released->count++;
+    released->address = baseAddress;
+}
+
+static void _releasePlanarBytes(
+    void* releaseRefCon, const void* dataPtr, size_t dataSize, size_t numberOfPlanes, const void* planeAddresses[]) {
+    ReleasedBytes* released = static_cast<ReleasedBytes*>(releaseRefCon);
+    released->count++;
+    released->address = dataPtr;
+    released->planes = numberOfPlanes;
+}
+
+TEST(CVPixelBuffer, CreateWithBytes) {
+    uint32_t pixels[8 * 4] = {};
+    ReleasedBytes released = {};
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess,
+              CVPixelBufferCreateWithBytes(
+                  nullptr, 6, 4, kCVPixelFormatType_32BGRA, pixels, 32, _releaseBytes, &released, nullptr, &pixelBuffer));
+
+    EXPECT_EQ(pixels, CVPixelBufferGetBaseAddress(pixelBuffer));
+    EXPECT_EQ(32u, CVPixelBufferGetBytesPerRow(pixelBuffer));
+    EXPECT_EQ(6u, CVPixelBufferGetWidth(pixelBuffer));
+
+    EXPECT_EQ(pixelBuffer, CVPixelBufferRetain(pixelBuffer));
+    CVPixelBufferRelease(pixelBuffer);
+    EXPECT_EQ(0, released.count);
+    CVPixelBufferRelease(pixelBuffer);
+    EXPECT_EQ(1, released.count);
+    EXPECT_EQ(pixels, released.address);
+
+    EXPECT_EQ(kCVReturnInvalidPixelFormat,
+              CVPixelBufferCreateWithBytes(
+                  nullptr, 6, 4, kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange, pixels, 32, nullptr, nullptr, nullptr, &pixelBuffer));
+}
+
+TEST(CVPixelBuffer, CreateWithPlanarBytes) {
+    uint8_t data[16 * 8 + 16 * 4] = {};
+    void* planes[] = { data, data + 16 * 8 };
+    size_t widths[] = { 16, 8 };
+    size_t heights[] = { 8, 4 };
+    size_t bytesPerRow[] = { 16, 16 };
+    ReleasedBytes released = {};
+    CVPixelBufferRef pixelBuffer = nullptr;
+    ASSERT_EQ(kCVReturnSuccess,
+              CVPixelBufferCreateWithPlanarBytes(nullptr,
+                                                 16,
+                                                 8,
+                                                 kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange,
+                                                 data,
+                                                 sizeof(data),
+                                                 2,
+                                                 planes,
+                                                 widths,
+                                                 heights,
+                                                 bytesPerRow,
+                                                 _releasePlanarBytes,
+                                                 &released,
+                                                 nullptr,
+                                                 &pixelBuffer));
+
+    EXPECT_EQ(2u, CVPixelBufferGetPlaneCount(pixelBuffer));
+    EXPECT_EQ(planes[1], CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(8u, CVPixelBufferGetWidthOfPlane(pixelBuffer, 1));
+    EXPECT_EQ(sizeof(data), CVPixelBufferGetDataSize(pixelBuffer));
+
+    CVPixelBufferRelease(pixelBuffer);
+    EXPECT_EQ(1, released.count);
+    EXPECT_EQ(data, released.address);
+    EXPECT_EQ(2u, released.planes);
+}
+
+TEST(CVPixelBuffer, ResolvedAttributes) {
+    CFDictionaryRef first = _createAttributes({ { kCVPixelBufferWidthKey, 640 } });
+    CFDictionaryRef second = _createAttributes({ { kCVPixelBufferWidthKey, 320 }, { kCVPixelBufferHeightKey, 240 } });
+    const void* values[] = { first, second };
+    CFArrayRef attributes = CFArrayCreate(nullptr, values, 2, &kCFTypeArrayCallBacks);
+
+    CFDictionaryRef resolved = nullptr;
+    ASSERT_EQ(kCVReturnSuccess, CVPixelBufferCreateResolvedAttributesDictionary(nullptr, attributes, &resolved));
+    EXPECT_EQ(2, CFDictionaryGetCount(resolved));
+
+    long long width = 0;
+    CFNumberGetValue(static_cast<CFNumberRef>(CFDictionaryGetValue(resolved, kCVPixelBufferWidthKey)), kCFNumberLongLongType, &width);
+    EXPECT_EQ(640, width);
+
+    CFRelease(resolved);
+    CFRelease(attributes);
+    CFRelease(first);
+    CFRelease(second);
+}
@@ -0,0 +1,235 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A minimal HTTP/1.1 server on 127.0.0.1, for exercising HTTP clients without leaving the machine. Every connection gets its
+// own thread, which answers the requests on it in order, so pipelined requests work too.
+class LoopbackHTTPServer {
+public:
+    struct Response {
+        std::string bytes;
+        // Closes the connection once the response has been written, whatever its headers say.
+        bool close = false;
+    };
+
+    // Receives the request head, without the final blank line, and the request body, which arrives empty when the server
+    // discards bodies. Chunked bodies are decoded.
+    using Handler = std::function<Response(const std::string& head, const std::string& body)>;
+
+    // A complete response with a Content-Length header.
+    static Response Reply(const std::string& body, const std::string& extraHeaders = "") {
+        Response response;
+        response.bytes = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n" + extraHeaders + "\r\n" + body;
+        return response;
+    }
+
+    // A server that discards request bodies only counts them, so that arbitrarily large uploads can be received.
+    explicit LoopbackHTTPServer(Handler handler, bool discardBodies = false) : _handler(std::move(handler)), _discardBodies(discardBodies) {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+
+        _listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int length = sizeof(address);
+        bind(_listener, reinterpret_cast<sockaddr*>(&address), length);
+        listen(_listener, SOMAXCONN);
+        getsockname(_listener, reinterpret_cast<sockaddr*>(&address), &length);
+        _port = ntohs(address.sin_port);
+
+        _acceptThread = std::thread([this]() { _accept(); });
+    }
+
+    ~LoopbackHTTPServer() {
+        _stopping = true;
+        closesocket(_listener);
+        _acceptThread.join();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (SOCKET client : _clients) {
+                shutdown(client, SD_BOTH);
+            }
+        }
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        WSACleanup();
+    }
+
+    std::string URL(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(_port) + path;
+    }
+
+    size_t ConnectionsAccepted() const {
+        return _connectionsAccepted;
+    }
+
+    size_t RequestsServed() const {
+        return _requestsServed;
+    }
+
+    uint64_t BodyBytesReceived() const {
+        return _bodyBytesReceived;
+    }
+
+private:
+    void _accept() {
+        while (!_stopping) {
+            SOCKET client = accept(_listener, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                continue;
+            }
+
+            BOOL noDelay = TRUE;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            ++_connectionsAccepted;
+            std::lock_guard<std::mutex> lock(_mutex);
+            _clients.push_back(client);
+            _threads.emplace_back([this, client]() { _serve(client); });
+        }
+    }
+
+    bool _receive(SOCKET client, std::string& buffer) {
+        char chunk[16384];
+        int received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, received);
+        return true;
+    }
+
+    bool _readLine(SOCKET client, std::string& buffer, std::string& line) {
+        size_t lineEnd;
+        while ((lineEnd = buffer.find("\r\n")) == std::string::npos) {
+            if (!_receive(client, buffer)) {
+                return false;
+            }
+        }
+        line = buffer.substr(0, lineEnd);
+        buffer.erase(0, lineEnd + 2);
+        return true;
+    }
+
+    // Moves length bytes of body from the buffer, and then the socket, into body.
+    bool _readBody(SOCKET client, std::string& buffer, uint64_t length, std::string& body) {
+        while (length > 0) {
+            if (buffer.empty() && !_receive(client, buffer)) {
+                return false;
+            }
+            size_t taken = static_cast<size_t>(std::min<uint64_t>(length, buffer.size()));
+            if (!_discardBodies) {
+                body.append(buffer, 0, taken);
+            }
+            buffer.erase(0, taken);
+            _bodyBytesReceived += taken;
+            length -= taken;
+        }
+        return true;
+    }
+
+    void _serve(SOCKET client) {
+        std::string buffer;
+        bool open = true;
+        while (open) {
+            size_t headEnd;
+            while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!_receive(client, buffer)) {
+                    open = false;
+                    break;
+                }
+            }
+            if (!open) {
+                break;
+            }
+
+            std::string head = buffer.substr(0, headEnd);
+            buffer.erase(0, headEnd + 4);
+            std::string lowercaseHead = head;
+            for (auto& character : lowercaseHead) {
+                character = static_cast<char>(tolower(character));
+            }
+
+            std::string body;
+            size_t contentLength = lowercaseHead.find("\r\ncontent-length:");
+            if (lowercaseHead.find("\r\ntransfer-encoding: chunked") != std::string::npos) {
+                std::string line;
+                while ((open = _readLine(client, buffer, line))) {
+                    uint64_t size = strtoull(line.c_str(), nullptr, 16);
+                    if (size == 0) {
+                        // Trailers, up to a blank line.
+                        while ((open = _readLine(client, buffer, line)) && !line.empty()) {
+                        }
+                        break;
+                    }
+                    if (!(open = _readBody(client, buffer, size, body) && _readLine(client, buffer, line))) {
+                        break;
+                    }
+                }
+            } else if (contentLength != std::string::npos) {
+                open = _readBody(client, buffer, strtoull(head.c_str() + contentLength + 17, nullptr, 10), body);
+            }
+            if (!open) {
+                break;
+            }
+
+            Response response = _handler(head, body);
+            ++_requestsServed;
+            for (size_t sent = 0; sent < response.bytes.size();) {
+                int result = send(client, response.bytes.data() + sent, static_cast<int>(response.bytes.size() - sent), 0);
+                if (result <= 0) {
+                    open = false;
+                    break;
+                }
+                sent += result;
+            }
+            if (response.close) {
+                open = false;
+            }
+        }
+
+        shutdown(client, SD_SEND);
+        std::lock_guard<std::mutex> lock(_mutex);
+        closesocket(client);
+        _clients.erase(std::remove(_clients.begin(), _clients.end(), client), _clients.end());
+    }
+
+    Handler _handler;
+    bool _discardBodies;
+    SOCKET _listener;
+    unsigned short _port;
+    std::atomic<bool> _stopping{ false };
+    std::atomic<size_t> _connectionsAccepted{ 0 };
+    std::atomic<size_t> _requestsServed{ 0 };
+    std::atomic<uint64_t> _bodyBytesReceived{ 0 };
+    std::thread _acceptThread;
+    std::mutex _mutex;
+    std::vector<SOCKET> _clients;
+    std::vector<std::thread> _threads;
+};
@@ -0,0 +1,178 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import "Foundation/Foundation.h"
+#import "Starboard/SmartTypes.h"
+#import "TestFramework.h"
+
+TEST(NSHashTable, StrongMemory) {
+    StrongId<NSHashTable> hashTable = [NSHashTable hashTableWithOptions:NSHashTableStrongMemory];
+    NSObject* object1 = [NSObject new];
+    NSObject* object2 = [NSObject new];
+
+    [hashTable addObject:object1];
+    [hashTable addObject:object2];
+    [hashTable addObject:object1];
+    ASSERT_EQ(2, [hashTable count]);
+    ASSERT_TRUE([hashTable containsObject:object1]);
+    ASSERT_OBJCEQ(object2, [hashTable member:object2]);
+
+    // The table's retains keep both objects alive
+    [object1 release];
+    [object2 release];
+    ASSERT_EQ(2, [hashTable count]);
+
+    [hashTable removeObject:object1];
+    ASSERT_EQ(1, [hashTable count]);
+    ASSERT_OBJCEQ(object2, [hashTable anyObject]);
+
+    [hashTable removeAllObjects];
+    ASSERT_EQ(0, [hashTable count]);
+    ASSERT_OBJCEQ(nil, [hashTable anyObject]);
+}
+
+TEST(NSHashTable, AddEqualObjectKeepsOriginal) {
+    StrongId<NSHashTable> hashTable = [[NSHashTable new] autorelease];
+    NSString* original = [NSString stringWithFormat:@"%@", @"equal"];
+    NSString* equal = [NSString stringWithFormat:@"%@", @"equal"];
+    ASSERT_NE(original, equal);
+
+    [hashTable addObject:original];
+    [hashTable addObject:equal];
+    ASSERT_EQ(1, [hashTable count]);
+    ASSERT_EQ(original, [hashTable member:equal]);
+}
+
+TEST(NSHashTable, ObjectPointerPersonality) {
+    StrongId<NSHashTable> hashTable = [NSHashTable hashTableWithOptions:NSHashTableObjectPointerPersonality];
+    NSString* first = [NSString stringWithFormat:@"%@", @"equal"];
+    NSString* second = [NSString stringWithFormat:@"%@", @"equal"];
+
+    [hashTable addObject:first];
+    [hashTable addObject:second];
+    ASSERT_EQ(2, [hashTable count]);
+    ASSERT_EQ(first, [hashTable member:first]);
+    ASSERT_EQ(second, [hashTable member:second]);
+}
+
+TEST(NSHashTable, WeakMemory) {
+    StrongId<NSHashTable> hashTable = [NSHashTable weakObjectsHashTable];
+    NSObject* object1 = [NSObject new];
+    NSObject* object2 = [NSObject new];
+
+    @autoreleasepool {
+        [hashTable addObject:object1];
+        [hashTable addObject:object2];
+        ASSERT_EQ(2, [hashTable count]);
+        ASSERT_TRUE([hashTable containsObject:object1]);
+    }
+
+    // The entry of a deallocated object is reclaimed, rather than left behind holding nil
+    [object1 release];
+    ASSERT_EQ(1, [hashTable count]);
+    @autoreleasepool {
+        ASSERT_OBJCEQ(@[ object2 ], [hashTable allObjects]);
+    }
+
+    [object2 release];
+    ASSERT_EQ(0, [hashTable count]);
+    ASSERT_OBJCEQ(nil, [hashTable anyObject]);
+}
+
+TEST(NSHashTable, WeakMemoryChurn) {
+    StrongId<NSHashTable> hashTable = [NSHashTable weakObjectsHashTable];
+    StrongId<NSMutableArray> live = [NSMutableArray array];
+
+    // Objects come and go; the table only ever sees the ones that are still alive
+    for (size_t round = 0; round < 10; ++round) {
+        @autoreleasepool {
+            [live removeAllObjects];
+            for (size_t i = 0; i < 100; ++i) {
+                NSObject* object = [[NSObject new] autorelease];
+                [live addObject:object];
+                [hashTable addObject:object];
+            }
+        }
+
+        ASSERT_EQ(100, [hashTable count]);
+        for (id object in live.get()) {
+            ASSERT_TRUE([hashTable containsObject:object]);
+        }
+    }
+}
+
+TEST(NSHashTable, SetAlgebra) {
+    StrongId<NSHashTable> hashTable1 = [[NSHashTable new] autorelease];
+    StrongId<NSHashTable> hashTable2 = [[NSHashTable new] autorelease];
+    for (NSNumber* number in @[ @1, @2, @3 ]) {
+        [hashTable1 addObject:number];
+    }
+    for (NSNumber* number in @[ @3, @4 ]) {
+        [hashTable2 addObject:number];
+    }
+
+    ASSERT_TRUE([hashTable1 intersectsHashTable:hashTable2]);
+    ASSERT_FALSE([hashTable2 isSubsetOfHashTable:hashTable1]);
+
+    StrongId<NSHashTable> unionTable = [[hashTable1 copy] autorelease];
+    [unionTable unionHashTable:hashTable2];
+    ASSERT_OBJCEQ([NSSet setWithArray:(@[ @1, @2, @3, @4 ])], [unionTable setRepresentation]);
+    ASSERT_TRUE([hashTable2 isSubsetOfHashTable:unionTable]);
+
+    StrongId<NSHashTable> intersection = [[hashTable1 copy] autorelease];
+    [intersection intersectHashTable:hashTable2];
+    ASSERT_OBJCEQ([NSSet setWithObject:@3], [intersection setRepresentation]);
+
+    StrongId<NSHashTable> difference = [[hashTable1 copy] autorelease];
+    [difference minusHashTable:hashTable2];
+    ASSERT_OBJCEQ([NSSet setWithArray:(@[ @1, @2 ])], [difference setRepresentation]);
+    ASSERT_FALSE([difference intersectsHashTable:hashTable2]);
+
+    ASSERT_TRUE([hashTable1 isEqualToHashTable:[[hashTable1 copy] autorelease]]);
+    ASSERT_FALSE([hashTable1 isEqualToHashTable:hashTable2]);
+}
+
+TEST(NSHashTable, Enumeration) {
+    StrongId<NSHashTable> hashTable = [[NSHashTable new] autorelease];
+    StrongId<NSMutableSet> expected = [NSMutableSet set];
+    for (int i = 0; i < 100; ++i) {
+        [hashTable addObject:@(i)];
+        [expected addObject:@(i)];
+    }
+
+    StrongId<NSMutableSet> enumerated = [NSMutableSet set];
+    for (id object in hashTable.get()) {
+        [enumerated addObject:object];
+    }
+    ASSERT_OBJCEQ(expected, enumerated);
+
+    StrongId<NSMutableSet> enumeratedByEnumerator = [NSMutableSet set];
+    NSEnumerator* enumerator = [hashTable objectEnumerator];
+    while (id object = [enumerator nextObject]) {
+        [enumeratedByEnumerator addObject:object];
+    }
+    ASSERT_OBJCEQ(expected, enumeratedByEnumerator);
+}
+
+TEST(NSHashTable, EncodeDecode) {
+    StrongId<NSHashTable> hashTable = [[NSHashTable new] autorelease];
+    [hashTable addObject:@"first"];
+    [hashTable addObject:@"second"];
+
+    StrongId<NSHashTable> hashTableDecoded =
+        [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:hashTable]];
+    ASSERT_TRUE([hashTable isEqualToHashTable:hashTableDecoded]);
+}
@@ -359,4 +359,141 @@ TEST(NSMutableOrderedSet, oneWayArray) {
     ASSERT_TRUE([arrayObjs containsObject:@"i5"]);
 
     ASSERT_ANY_THROW([((NSMutableArray*)arrayObjs) addObject:@"test"]);
-}
\ No newline at end of file
+}
+
+TEST(NSMutableOrderedSet, IndexOfObjectAfterFrontInserts) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSet];
+    for (int i = 0; i < 100; ++i) {
+        [orderedSet insertObject:@(i) atIndex:0];
+        ASSERT_EQ(0, [orderedSet indexOfObject:@(i)]);
+    }
+
+    ASSERT_EQ(100, [orderedSet count]);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(99 - i, [orderedSet indexOfObject:@(i)]);
+    }
+}
+
+TEST(NSMutableOrderedSet, RemoveObjects) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @0, @1, @2, @3, @4, @5, @6, @7 ]];
+
+    [orderedSet removeObject:@1];
+    assertOrderedSetContent(orderedSet, @0, @2, @3, @4, @5, @6, @7, nil);
+    ASSERT_EQ(1, [orderedSet indexOfObject:@2]);
+    ASSERT_FALSE([orderedSet containsObject:@1]);
+
+    [orderedSet removeObjectAtIndex:0];
+    assertOrderedSetContent(orderedSet, @2, @3, @4, @5, @6, @7, nil);
+
+    [orderedSet removeObjectsInArray:@[ @7, @3, @42 ]];
+    assertOrderedSetContent(orderedSet, @2, @4, @5, @6, nil);
+    ASSERT_EQ(3, [orderedSet indexOfObject:@6]);
+
+    [orderedSet removeObjectsInRange:NSMakeRange(1, 2)];
+    assertOrderedSetContent(orderedSet, @2, @6, nil);
+    ASSERT_EQ(1, [orderedSet indexOfObject:@6]);
+    ASSERT_EQ(NSNotFound, [orderedSet indexOfObject:@4]);
+
+    [orderedSet removeAllObjects];
+    ASSERT_EQ(0, [orderedSet count]);
+    ASSERT_FALSE([orderedSet containsObject:@2]);
+
+    [orderedSet addObject:@2];
+    ASSERT_EQ(0, [orderedSet indexOfObject:@2]);
+}
+
+TEST(NSMutableOrderedSet, InsertObjectsAtIndexes) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @"A", @"B", @"C" ]];
+
+    NSMutableIndexSet* indexes = [NSMutableIndexSet indexSetWithIndex:0];
+    [indexes addIndex:2];
+    [orderedSet insertObjects:@[ @"X", @"Y" ] atIndexes:indexes];
+
+    assertOrderedSetContent(orderedSet, @"X", @"A", @"Y", @"B", @"C", nil);
+    ASSERT_EQ(3, [orderedSet indexOfObject:@"B"]);
+}
+
+TEST(NSMutableOrderedSet, ReplaceObjects) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @"A", @"B", @"C" ]];
+
+    [orderedSet replaceObjectAtIndex:1 withObject:@"D"];
+    assertOrderedSetContent(orderedSet, @"A", @"D", @"C", nil);
+    ASSERT_EQ(1, [orderedSet indexOfObject:@"D"]);
+    ASSERT_FALSE([orderedSet containsObject:@"B"]);
+
+    // Replacing with an object already in the set at another index does nothing.
+    [orderedSet replaceObjectAtIndex:0 withObject:@"C"];
+    assertOrderedSetContent(orderedSet, @"A", @"D", @"C", nil);
+
+    orderedSet[3] = @"E";
+    orderedSet[0] = @"F";
+    assertOrderedSetContent(orderedSet, @"F", @"D", @"C", @"E", nil);
+
+    id objects[] = { @"G", @"E", @"H" };
+    [orderedSet replaceObjectsInRange:NSMakeRange(1, 2) withObjects:objects count:3];
+    assertOrderedSetContent(orderedSet, @"F", @"G", @"H", @"E", nil);
+    ASSERT_EQ(3, [orderedSet indexOfObject:@"E"]);
+}
+
+TEST(NSMutableOrderedSet, MoveAndExchangeObjects) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @0, @1, @2, @3, @4, @5 ]];
+
+    NSMutableIndexSet* indexes = [NSMutableIndexSet indexSetWithIndex:0];
+    [indexes addIndex:4];
+    [orderedSet moveObjectsAtIndexes:indexes toIndex:2];
+    assertOrderedSetContent(orderedSet, @1, @2, @0, @4, @3, @5, nil);
+    ASSERT_EQ(2, [orderedSet indexOfObject:@0]);
+    ASSERT_EQ(4, [orderedSet indexOfObject:@3]);
+
+    [orderedSet exchangeObjectAtIndex:0 withObjectAtIndex:5];
+    assertOrderedSetContent(orderedSet, @5, @2, @0, @4, @3, @1, nil);
+    ASSERT_EQ(0, [orderedSet indexOfObject:@5]);
+    ASSERT_EQ(5, [orderedSet indexOfObject:@1]);
+}
+
+TEST(NSMutableOrderedSet, SortObjects) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @3, @1, @4, @0, @2 ]];
+
+    [orderedSet sortRange:NSMakeRange(1, 3)
+                  options:0
+          usingComparator:^NSComparisonResult(id left, id right) {
+              return [left compare:right];
+          }];
+    assertOrderedSetContent(orderedSet, @3, @0, @1, @4, @2, nil);
+    ASSERT_EQ(3, [orderedSet indexOfObject:@4]);
+
+    [orderedSet sortUsingComparator:^NSComparisonResult(id left, id right) {
+        return [right compare:left];
+    }];
+    assertOrderedSetContent(orderedSet, @4, @3, @2, @1, @0, nil);
+    ASSERT_EQ(4, [orderedSet indexOfObject:@0]);
+}
+
+TEST(NSMutableOrderedSet, SetAlgebra) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @0, @1, @2, @3, @4 ]];
+
+    [orderedSet intersectSet:[NSSet setWithObjects:@4, @3, @1, @0, @9, nil]];
+    assertOrderedSetContent(orderedSet, @0, @1, @3, @4, nil);
+
+    [orderedSet minusOrderedSet:[NSOrderedSet orderedSetWithObjects:@1, @8, nil]];
+    assertOrderedSetContent(orderedSet, @0, @3, @4, nil);
+
+    [orderedSet unionOrderedSet:[NSOrderedSet orderedSetWithObjects:@3, @7, @5, nil]];
+    assertOrderedSetContent(orderedSet, @0, @3, @4, @7, @5, nil);
+    ASSERT_EQ(4, [orderedSet indexOfObject:@5]);
+
+    [orderedSet filterUsingPredicate:[NSPredicate predicateWithFormat:@"SELF > 3"]];
+    assertOrderedSetContent(orderedSet, @4, @7, @5, nil);
+    ASSERT_EQ(0, [orderedSet indexOfObject:@4]);
+}
+
+TEST(NSMutableOrderedSet, ArchiveAndUnarchive) {
+    NSMutableOrderedSet* orderedSet = [NSMutableOrderedSet orderedSetWithArray:@[ @"Tesla", @"Benz", @"BMW" ]];
+
+    NSData* data = [NSKeyedArchiver archivedDataWithRootObject:orderedSet];
+    ASSERT_NE(nil, data);
+
+    NSOrderedSet* unarchived = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+    ASSERT_OBJCEQ(orderedSet, unarchived);
+    ASSERT_EQ(2, [unarchived indexOfObject:@"BMW"]);
+}
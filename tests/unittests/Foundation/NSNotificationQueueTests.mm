@@ -0,0 +1,137 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#import <Starboard/SmartTypes.h>
+#import <Foundation/Foundation.h>
+
+static NSString* const c_queueTestNotification = @"NSNotificationQueueTestNotification";
+
+// Observes c_queueTestNotification on the default center, recording every delivered notification's object. The run loop
+// drains the current thread's default queue.
+class NotificationQueueTest {
+public:
+    NotificationQueueTest() {
+        _received.attach([NSMutableArray new]);
+
+        NSMutableArray* received = _received;
+        _observer = [[NSNotificationCenter defaultCenter] addObserverForName:c_queueTestNotification
+                                                                      object:nil
+                                                                       queue:nil
+                                                                  usingBlock:^(NSNotification* notification) {
+                                                                      [received addObject:notification.object];
+                                                                  }];
+    }
+
+    ~NotificationQueueTest() {
+        [[NSNotificationCenter defaultCenter] removeObserver:_observer];
+    }
+
+    void Enqueue(NSString* object, NSPostingStyle postingStyle, NSNotificationCoalescing coalesceMask) {
+        [[NSNotificationQueue defaultQueue] enqueueNotification:[NSNotification notificationWithName:c_queueTestNotification object:object]
+                                                   postingStyle:postingStyle
+                                                   coalesceMask:coalesceMask
+                                                       forModes:nil];
+    }
+
+    void RunLoop() {
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.1]];
+    }
+
+    StrongId<NSMutableArray> _received;
+    id _observer;
+};
+
+TEST(NSNotificationQueue, DefaultQueueIsPerThread) {
+    NSNotificationQueue* queue = [NSNotificationQueue defaultQueue];
+    ASSERT_OBJCNE(nil, queue);
+    EXPECT_EQ(queue, [NSNotificationQueue defaultQueue]);
+}
+
+TEST(NSNotificationQueue, PostNowDeliversImmediately) {
+    NotificationQueueTest test;
+    test.Enqueue(@"now", NSPostNow, NSNotificationNoCoalescing);
+    EXPECT_OBJCEQ(@[ @"now" ], test._received);
+}
+
+TEST(NSNotificationQueue, PostASAPAndWhenIdleDeliverFromRunLoop) {
+    NotificationQueueTest test;
+    test.Enqueue(@"idle", NSPostWhenIdle, NSNotificationNoCoalescing);
+    test.Enqueue(@"asap", NSPostASAP, NSNotificationNoCoalescing);
+    EXPECT_EQ(0, [test._received count]);
+
+    test.RunLoop();
+    EXPECT_OBJCEQ((@[ @"asap", @"idle" ]), test._received);
+}
+
+TEST(NSNotificationQueue, CoalescesOnName) {
+    NotificationQueueTest test;
+    test.Enqueue(@"first", NSPostASAP, NSNotificationCoalescingOnName);
+    test.Enqueue(@"second", NSPostASAP, NSNotificationCoalescingOnName);
+    test.Enqueue(@"third", NSPostASAP, NSNotificationCoalescingOnName);
+
+    test.RunLoop();
+    EXPECT_OBJCEQ(@[ @"third" ], test._received);
+}
+
+TEST(NSNotificationQueue, CoalescesOnNameAndSender) {
+    NotificationQueueTest test;
+    NSNotificationCoalescing coalesceMask = (NSNotificationCoalescing)(NSNotificationCoalescingOnName | NSNotificationCoalescingOnSender);
+    test.Enqueue(@"first", NSPostASAP, coalesceMask);
+    test.Enqueue(@"second", NSPostASAP, coalesceMask);
+    test.Enqueue(@"first", NSPostASAP, coalesceMask);
+
+    test.RunLoop();
+    EXPECT_OBJCEQ((@[ @"second", @"first" ]), test._received);
+}
+
+TEST(NSNotificationQueue, NoCoalescingKeepsEveryNotification) {
+    NotificationQueueTest test;
+    test.Enqueue(@"first", NSPostASAP, NSNotificationNoCoalescing);
+    test.Enqueue(@"first", NSPostASAP, NSNotificationNoCoalescing);
+
+    test.RunLoop();
+    EXPECT_OBJCEQ((@[ @"first", @"first" ]), test._received);
+}
+
+TEST(NSNotificationQueue, Dequeue) {
+    NotificationQueueTest test;
+    test.Enqueue(@"first", NSPostASAP, NSNotificationNoCoalescing);
+    test.Enqueue(@"second", NSPostWhenIdle, NSNotificationNoCoalescing);
+    test.Enqueue(@"third", NSPostASAP, NSNotificationNoCoalescing);
+
+    [[NSNotificationQueue defaultQueue] dequeueNotificationsMatching:[NSNotification notificationWithName:c_queueTestNotification
+                                                                                                   object:@"first"]
+                                                        coalesceMask:NSNotificationCoalescingOnSender];
+    test.RunLoop();
+    EXPECT_OBJCEQ((@[ @"third", @"second" ]), test._received);
+}
+
+TEST(NSNotificationQueue, RespectsModes) {
+    NotificationQueueTest test;
+    [[NSNotificationQueue defaultQueue] enqueueNotification:[NSNotification notificationWithName:c_queueTestNotification object:@"other"]
+                                               postingStyle:NSPostASAP
+                                               coalesceMask:NSNotificationNoCoalescing
+                                                   forModes:@[ @"NSNotificationQueueTestMode" ]];
+
+    test.RunLoop();
+    EXPECT_EQ(0, [test._received count]);
+
+    // Leave nothing queued for later tests.
+    [[NSNotificationQueue defaultQueue] dequeueNotificationsMatching:[NSNotification notificationWithName:c_queueTestNotification
+                                                                                                   object:nil]
+                                                        coalesceMask:NSNotificationCoalescingOnName];
+}
@@ -490,3 +490,63 @@ TEST(NSNotificationCenter, InvalidStates) {
     EXPECT_ANY_THROW([notificationCenter addObserverForName:s_TestNotificationName object:nil queue:nil usingBlock:nil]);
     EXPECT_ANY_THROW([notificationCenter postNotification:nil]);
 }
+
+TEST(NSNotificationCenter, BlockWithCurrentQueueDoesNotWait) {
+    static NSString* s_TestNotificationName = @(GetTestFullName().c_str());
+    NSNotificationCenter* notificationCenter = [[NSNotificationCenter new] autorelease];
+    __block int counter = 0;
+
+    NSOperationQueue* queue = [[NSOperationQueue new] autorelease];
+    queue.maxConcurrentOperationCount = 1;
+
+    id token = [notificationCenter addObserverForName:s_TestNotificationName
+                                               object:nil
+                                                queue:queue
+                                           usingBlock:^(NSNotification* note) {
+                                               ++counter;
+                                           }];
+
+    // Posting from the observer's own serial queue must deliver in place rather than wait behind the posting operation.
+    [queue addOperationWithBlock:^{
+        [notificationCenter postNotificationName:s_TestNotificationName object:nil];
+        ASSERT_EQ(1, counter);
+    }];
+
+    [queue waitUntilAllOperationsAreFinished];
+    ASSERT_EQ(1, counter);
+
+    [notificationCenter removeObserver:token];
+}
+
+TEST(NSNotificationCenter, DeliversInRegistrationOrder) {
+    static NSString* s_TestNotificationName = @(GetTestFullName().c_str());
+    NSNotificationCenter* notificationCenter = [[NSNotificationCenter new] autorelease];
+    NSObject* object = [[NSObject new] autorelease];
+    NSMutableArray<NSNumber*>* deliveries = [NSMutableArray array];
+
+    // Alternate between observers of any sender and observers of this one.
+    NSMutableArray* tokens = [NSMutableArray array];
+    for (int i = 0; i < 6; ++i) {
+        [tokens addObject:[notificationCenter addObserverForName:s_TestNotificationName
+                                                          object:(i % 2) ? object : nil
+                                                           queue:nil
+                                                      usingBlock:^(NSNotification* note) {
+                                                          [deliveries addObject:@(i)];
+                                                      }]];
+    }
+
+    [notificationCenter postNotificationName:s_TestNotificationName object:object];
+    EXPECT_OBJCEQ((@[ @0, @1, @2, @3, @4, @5 ]), deliveries);
+
+    [deliveries removeAllObjects];
+    [notificationCenter postNotificationName:s_TestNotificationName object:nil];
+    EXPECT_OBJCEQ((@[ @0, @2, @4 ]), deliveries);
+
+    for (id token in tokens) {
+        [notificationCenter removeObserver:token];
+    }
+
+    [deliveries removeAllObjects];
+    [notificationCenter postNotificationName:s_TestNotificationName object:object];
+    EXPECT_EQ(0, deliveries.count);
+}
@@ -0,0 +1,65 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <Foundation/Foundation.h>
+#import <TestFramework.h>
+
+TEST(NSPurgeableData, StartsWithContentAccess) {
+    NSPurgeableData* data = [NSPurgeableData dataWithBytes:"abcd" length:4];
+    ASSERT_EQ(4, [data length]);
+
+    // Created with an access count of 1, so the content cannot be discarded yet.
+    [data discardContentIfPossible];
+    ASSERT_FALSE([data isContentDiscarded]);
+    ASSERT_EQ(0, memcmp("abcd", [data bytes], 4));
+
+    [data endContentAccess];
+    [data discardContentIfPossible];
+    ASSERT_TRUE([data isContentDiscarded]);
+    ASSERT_FALSE([data beginContentAccess]);
+}
+
+TEST(NSPurgeableData, NestedContentAccess) {
+    NSPurgeableData* data = [NSPurgeableData dataWithLength:16];
+    ASSERT_TRUE([data beginContentAccess]);
+    [data endContentAccess];
+
+    [data discardContentIfPossible];
+    ASSERT_FALSE([data isContentDiscarded]);
+
+    [data endContentAccess];
+    ASSERT_FALSE([data isContentDiscarded]);
+
+    ASSERT_TRUE([data beginContentAccess]);
+    [data appendBytes:"ef" length:2];
+    ASSERT_EQ(18, [data length]);
+    [data endContentAccess];
+
+    [data discardContentIfPossible];
+    ASSERT_TRUE([data isContentDiscarded]);
+}
+
+TEST(NSPurgeableData, CacheEvictsDiscardedContent) {
+    NSCache* cache = [[NSCache new] autorelease];
+    NSPurgeableData* data = [NSPurgeableData dataWithLength:16];
+    [data endContentAccess];
+    [cache setObject:data forKey:@"key"];
+
+    ASSERT_OBJCEQ(data, [cache objectForKey:@"key"]);
+
+    [data discardContentIfPossible];
+    ASSERT_OBJCEQ(nil, [cache objectForKey:@"key"]);
+}
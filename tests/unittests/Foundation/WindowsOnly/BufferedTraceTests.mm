@@ -0,0 +1,290 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      TraceStartBufferedSink and the other Logging extensions
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <Starboard.h>
+
+#include "LoggingNative.h"
+
+#include <fcntl.h>
+#include <io.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const wchar_t* c_tag = L"BufferedTraceTests";
+
+// Splits what the sink wrote into lines, without line terminators.
+static std::vector<std::wstring> _lines(NSString* contents) {
+    std::vector<std::wstring> lines;
+    for (NSString* line in [contents componentsSeparatedByString:@"\n"]) {
+        std::vector<unichar> characters([line length]);
+        [line getCharacters:characters.data() range:NSMakeRange(0, characters.size())];
+        lines.emplace_back(characters.begin(), characters.end());
+        if (!lines.back().empty() && lines.back().back() == L'\r') {
+            lines.back().pop_back();
+        }
+    }
+    return lines;
+}
+
+// Returns the messages traced with c_tag, in the order they were written, without their timestamp, thread and label.
+static std::vector<std::wstring> _messages(NSString* contents) {
+    std::vector<std::wstring> messages;
+    std::wstring prefix = std::wstring(L"/") + c_tag + L": ";
+    for (const std::wstring& line : _lines(contents)) {
+        size_t found = line.find(prefix);
+        if (found != std::wstring::npos) {
+            messages.push_back(line.substr(found + prefix.size()));
+        }
+    }
+    return messages;
+}
+
+// Returns the total the sink reported as dropped.
+static unsigned long long _dropped(NSString* contents) {
+    unsigned long long dropped = 0;
+    for (const std::wstring& line : _lines(contents)) {
+        unsigned long long count = 0;
+        if (swscanf_s(line.c_str(), L"%llu trace messages were dropped", &count) == 1) {
+            dropped += count;
+        }
+    }
+    return dropped;
+}
+
+// A file in the temporary directory for the sink to write to, removed when the test ends.
+class SinkFile {
+public:
+    explicit SinkFile(NSString* name) : _path([[NSTemporaryDirectory() stringByAppendingPathComponent:name] retain]) {
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+        std::vector<unichar> characters([_path length]);
+        [_path getCharacters:characters.data() range:NSMakeRange(0, characters.size())];
+        _widePath.assign(characters.begin(), characters.end());
+    }
+
+    ~SinkFile() {
+        TraceStopBufferedSink();
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+        [_path release];
+    }
+
+    const wchar_t* Path() const {
+        return _widePath.c_str();
+    }
+
+    std::vector<std::wstring> Messages() const {
+        return _messages([NSString stringWithContentsOfFile:_path encoding:NSUTF8StringEncoding error:nil]);
+    }
+
+private:
+    NSString* _path;
+    std::wstring _widePath;
+};
+
+// Formats a message the way the synchronous listeners do.
+static std::wstring _expectedMessage(const wchar_t* format, ...) {
+    wchar_t buffer[1024];
+    va_list va;
+    va_start(va, format);
+    _vsnwprintf_s(buffer, _countof(buffer), _TRUNCATE, format, va);
+    va_end(va);
+    return buffer;
+}
+
+TEST(BufferedTrace, FormatsLikeTheSynchronousListeners) {
+    SinkFile file(@"BufferedTraceFormats.log");
+    ASSERT_TRUE(TraceStartBufferedSink(file.Path(), TraceLevelVerbose));
+
+    std::vector<std::wstring> expected;
+#define FORMAT_CASE(...)                                   \
+    do {                                                   \
+        TraceVerbose(c_tag, __VA_ARGS__);                  \
+        expected.push_back(_expectedMessage(__VA_ARGS__)); \
+    } while (0)
+
+    int value = 0;
+    const char unterminated[3] = { 'a', 'b', 'c' };
+    const wchar_t unterminatedWide[3] = { L'x', L'y', L'z' };
+
+    FORMAT_CASE(L"%d %i %u %x %X %o", -42, INT_MIN, 4000000000u, 0xBEEF, 0xBEEF, 8);
+    FORMAT_CASE(L"%lld %llu %I64d %I64x", LLONG_MIN, ULLONG_MAX, -1LL, 0x123456789ABCDEFLL);
+    FORMAT_CASE(L"%Iu %Id %zu", SIZE_MAX, static_cast<intptr_t>(-7), static_cast<size_t>(12345));
+    FORMAT_CASE(L"%hd %hu %c %C", static_cast<short>(-3), static_cast<unsigned short>(65535), L'w', 'n');
+    FORMAT_CASE(L"%f %e %g %E %G", 3.14159265, 1.5e-20, 0.0001, -2.5e300, 1e100);
+    FORMAT_CASE(L"%f %f", static_cast<double>(1.0f / 3.0f), -0.0);
+    FORMAT_CASE(L"%p %p", &value, static_cast<void*>(nullptr));
+    FORMAT_CASE(L"%s|%ls|%ws", L"wide", L"\x6587\x5b57", L"ws");
+    FORMAT_CASE(L"%hs|%S|%hS", "narrow", "upper", "both");
+    FORMAT_CASE(L"%s|%hs", static_cast<const wchar_t*>(nullptr), static_cast<const char*>(nullptr));
+
+    // Widths and precisions, both literal and taken from arguments.
+    FORMAT_CASE(L"[%8d] [%-8d] [%08d] [%+d] [% d]", 42, 42, 42, 42, 42);
+    FORMAT_CASE(L"[%.3f] [%10.2f] [%-10.4e] [%.0f] [%#.0f]", 2.71828, 2.71828, 2.71828, 2.5, 2.5);
+    FORMAT_CASE(L"[%*d] [%-*d] [%*d]", 6, 7, 6, 7, -6, 7);
+    FORMAT_CASE(L"[%.*f] [%*.*f] [%.*f]", 2, 1.23456, 9, 3, 1.23456, -1, 1.23456);
+    FORMAT_CASE(L"[%.3s] [%10.2ls] [%-6hs]", L"truncated", L"padded", "left");
+
+    // A precision bounds how much of a string is read, so it need not be terminated.
+    FORMAT_CASE(L"[%.3hs] [%.*ls] [%.0hs]", unterminated, 3, unterminatedWide, unterminated);
+
+    FORMAT_CASE(L"100%% of %d", 7);
+    FORMAT_CASE(L"no arguments");
+
+#undef FORMAT_CASE
+
+    TraceFlushBufferedSink();
+    std::vector<std::wstring> messages = file.Messages();
+    ASSERT_EQ(expected.size(), messages.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i], messages[i]) << "message " << i;
+    }
+}
+
+TEST(BufferedTrace, AccountsForDroppedMessages) {
+    // Send stderr into a pipe that nobody reads yet, so that the drainer blocks on its first write and the ring fills.
+    HANDLE readPipe;
+    HANDLE writePipe;
+    ASSERT_TRUE(CreatePipe(&readPipe, &writePipe, nullptr, 4096));
+    int pipeFd = _open_osfhandle(reinterpret_cast<intptr_t>(writePipe), _O_WRONLY | _O_BINARY);
+    ASSERT_NE(-1, pipeFd);
+    fflush(stderr);
+    int savedStderr = _dup(_fileno(stderr));
+    ASSERT_EQ(0, _dup2(pipeFd, _fileno(stderr)));
+
+    // Reading has to start before the sink is stopped, or stopping would wait on the blocked drainer forever.
+    std::string output;
+    std::thread reader;
+    auto restoreStderr = wil::ScopeExit([&]() {
+        reader = std::thread([&output, readPipe]() {
+            char buffer[4096];
+            DWORD read;
+            while (ReadFile(readPipe, buffer, sizeof(buffer), &read, nullptr) && read != 0) {
+                output.append(buffer, read);
+            }
+        });
+
+        TraceStopBufferedSink();
+        fflush(stderr);
+        _dup2(savedStderr, _fileno(stderr));
+        _close(savedStderr);
+        _close(pipeFd);
+        reader.join();
+        CloseHandle(readPipe);
+    });
+
+    ASSERT_TRUE(TraceStartBufferedSink(nullptr, TraceLevelVerbose));
+
+    // Each message is a couple of kilobytes, so the ring holds a few dozen; what the drainer took before it blocked can
+    // only be about as many again.
+    std::wstring payload(1000, L'x');
+    const unsigned int traced = 2000;
+    for (unsigned int i = 0; i < traced; i++) {
+        TraceVerbose(c_tag, L"%u %s", i, payload.c_str());
+    }
+
+    restoreStderr();
+
+    NSString* contents = [[[NSString alloc] initWithBytes:output.data() length:output.size() encoding:NSUTF8StringEncoding] autorelease];
+    std::vector<std::wstring> messages = _messages(contents);
+    unsigned long long dropped = _dropped(contents);
+    EXPECT_LT(0u, messages.size());
+    EXPECT_LT(traced / 2, dropped);
+    EXPECT_EQ(traced, messages.size() + dropped);
+
+    // What was kept is in order and intact.
+    unsigned int next = 0;
+    for (const std::wstring& message : messages) {
+        unsigned int index = wcstoul(message.c_str(), nullptr, 10);
+        EXPECT_LE(next, index);
+        EXPECT_EQ(_expectedMessage(L"%u %s", index, payload.c_str()), message);
+        next = index + 1;
+    }
+}
+
+TEST(BufferedTrace, FlushAndStopWriteEverythingInOrder) {
+    SinkFile file(@"BufferedTraceOrder.log");
+    ASSERT_TRUE(TraceStartBufferedSink(file.Path(), TraceLevelVerbose));
+    EXPECT_FALSE(TraceStartBufferedSink(file.Path(), TraceLevelVerbose));
+
+    // Messages from different threads are interleaved by when they were traced, including those of a thread that has
+    // already exited.
+    TraceVerbose(c_tag, L"first");
+    std::thread([]() { TraceVerbose(c_tag, L"second"); }).join();
+    TraceVerbose(c_tag, L"third");
+
+    TraceFlushBufferedSink();
+    std::vector<std::wstring> expected = { L"first", L"second", L"third" };
+    EXPECT_EQ(expected, file.Messages());
+
+    // Stopping writes what is still buffered, and nothing traced afterward.
+    TraceVerbose(c_tag, L"fourth");
+    TraceStopBufferedSink();
+    TraceVerbose(c_tag, L"fifth");
+    expected.push_back(L"fourth");
+    EXPECT_EQ(expected, file.Messages());
+
+    // Flushing and stopping a stopped sink do nothing.
+    TraceFlushBufferedSink();
+    TraceStopBufferedSink();
+
+    // The sink can be restarted, and appends to the file.
+    ASSERT_TRUE(TraceStartBufferedSink(file.Path(), TraceLevelVerbose));
+    TraceVerbose(c_tag, L"sixth");
+    TraceStopBufferedSink();
+    expected.push_back(L"sixth");
+    EXPECT_EQ(expected, file.Messages());
+}
+
+TEST(BufferedTrace, HonorsLevelsAndTags) {
+    SinkFile file(@"BufferedTraceTags.log");
+    ASSERT_TRUE(TraceStartBufferedSink(file.Path(), TraceLevelWarning));
+
+    EXPECT_TRUE(TraceIsEnabled(TraceLevelCritical, c_tag));
+    EXPECT_TRUE(TraceIsEnabled(TraceLevelWarning, c_tag));
+
+    TraceVerbose(c_tag, L"verbose");
+    TraceInfo(c_tag, L"info");
+    TraceWarning(c_tag, L"warning");
+    TraceError(c_tag, L"error");
+
+    TraceSetTagEnabled(c_tag, false);
+    EXPECT_FALSE(TraceIsEnabled(TraceLevelCritical, c_tag));
+    EXPECT_FALSE(TraceIsEnabled(TraceLevelVerbose, c_tag));
+    EXPECT_TRUE(TraceIsEnabled(TraceLevelCritical, L"BufferedTraceTestsOther"));
+    TraceCritical(c_tag, L"disabled");
+
+    // Disabling a tag twice and enabling it once enables it.
+    TraceSetTagEnabled(c_tag, false);
+    TraceSetTagEnabled(c_tag, true);
+    EXPECT_TRUE(TraceIsEnabled(TraceLevelCritical, c_tag));
+    TraceCritical(c_tag, L"enabled");
+
+    // Enabling a tag that was never disabled does nothing.
+    TraceSetTagEnabled(L"BufferedTraceTestsOther", true);
+    EXPECT_TRUE(TraceIsEnabled(TraceLevelCritical, L"BufferedTraceTestsOther"));
+
+    TraceStopBufferedSink();
+    std::vector<std::wstring> expected = { L"warning", L"error", L"enabled" };
+    EXPECT_EQ(expected, file.Messages());
+}
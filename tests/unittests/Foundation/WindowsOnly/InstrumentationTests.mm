@@ -0,0 +1,383 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      Instrumentation spans, counters and traces, which live in the Logging library
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <Starboard.h>
+
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Aggregates are kept for the life of the process, so every test records to sites of its own.
+static const char* c_category = "InstrumentationTests";
+
+// Returns the aggregates of the given site, or an empty entry if it has not been registered.
+static InstrumentationEntry _entry(const char* name, InstrumentationKind kind) {
+    std::vector<InstrumentationEntry> entries(InstrumentationSnapshot(nullptr, 0));
+    entries.resize(std::min(entries.size(), InstrumentationSnapshot(entries.data(), entries.size())));
+
+    InstrumentationEntry found = {};
+    for (const InstrumentationEntry& entry : entries) {
+        if (entry.kind == kind && strcmp(entry.category, c_category) == 0 && strcmp(entry.name, name) == 0) {
+            found = entry;
+        }
+    }
+    return found;
+}
+
+static uint64_t _histogramCount(const InstrumentationEntry& entry) {
+    uint64_t count = 0;
+    for (uint64_t bucket : entry.histogram) {
+        count += bucket;
+    }
+    return count;
+}
+
+TEST(Instrumentation, RegistersEachSiteOnce) {
+    unsigned int span = InstrumentationRegisterSite(c_category, "RegistersEachSiteOnce", InstrumentationKindSpan);
+    ASSERT_NE(0u, span);
+    EXPECT_EQ(span, InstrumentationRegisterSite(c_category, std::string("RegistersEachSiteOnce").c_str(), InstrumentationKindSpan));
+
+    unsigned int counter = InstrumentationRegisterSite(c_category, "RegistersEachSiteOnce", InstrumentationKindCounter);
+    ASSERT_NE(0u, counter);
+    EXPECT_NE(span, counter);
+
+    // Recording to site 0, which registration returns once it is full, does nothing.
+    InstrumentationEndSpan(0, InstrumentationBeginSpan(0));
+    InstrumentationRecordSpan(0, InstrumentationTimestamp());
+    InstrumentationAddCounter(0, 1);
+}
+
+TEST(Instrumentation, CountsSpans) {
+    {
+        InstrumentationSetEnabled(true);
+        auto disable = wil::ScopeExit([]() { InstrumentationSetEnabled(false); });
+        for (int i = 0; i < 10; i++) {
+            INSTRUMENT_SPAN(c_category, "CountsSpans");
+        }
+
+        for (int i = 0; i < 3; i++) {
+            INSTRUMENT_SPAN_SINCE(c_category, "CountsSpansSince", INSTRUMENT_TIMESTAMP());
+        }
+    }
+
+    // Nothing is recorded while instrumentation is disabled.
+    for (int i = 0; i < 5; i++) {
+        INSTRUMENT_SPAN(c_category, "CountsSpans");
+        INSTRUMENT_SPAN_SINCE(c_category, "CountsSpansSince", INSTRUMENT_TIMESTAMP());
+    }
+
+    InstrumentationEntry spans = _entry("CountsSpans", InstrumentationKindSpan);
+    EXPECT_EQ(10u, spans.count);
+    EXPECT_EQ(10u, _histogramCount(spans));
+    EXPECT_LE(spans.max, spans.total);
+    EXPECT_EQ(spans.total, spans.self);
+
+    InstrumentationEntry since = _entry("CountsSpansSince", InstrumentationKindSpan);
+    EXPECT_EQ(3u, since.count);
+    EXPECT_EQ(3u, _histogramCount(since));
+}
+
+TEST(Instrumentation, SelfTimeExcludesNestedSpans) {
+    unsigned int outer = InstrumentationRegisterSite(c_category, "SelfTimeOuter", InstrumentationKindSpan);
+    unsigned int inner = InstrumentationRegisterSite(c_category, "SelfTimeInner", InstrumentationKindSpan);
+    unsigned int innermost = InstrumentationRegisterSite(c_category, "SelfTimeInnermost", InstrumentationKindSpan);
+    unsigned int waited = InstrumentationRegisterSite(c_category, "SelfTimeWaited", InstrumentationKindSpan);
+
+    int64_t queued = InstrumentationTimestamp();
+    int64_t outerStart = InstrumentationBeginSpan(outer);
+    Sleep(20);
+    for (int i = 0; i < 2; i++) {
+        int64_t innerStart = InstrumentationBeginSpan(inner);
+        Sleep(10);
+        int64_t innermostStart = InstrumentationBeginSpan(innermost);
+        Sleep(10);
+        InstrumentationEndSpan(innermost, innermostStart);
+        InstrumentationEndSpan(inner, innerStart);
+    }
+
+    // A span recorded from a timestamp does not nest, so it is not subtracted from the outer span's self time.
+    InstrumentationRecordSpan(waited, queued);
+    InstrumentationEndSpan(outer, outerStart);
+
+    InstrumentationEntry outerEntry = _entry("SelfTimeOuter", InstrumentationKindSpan);
+    InstrumentationEntry innerEntry = _entry("SelfTimeInner", InstrumentationKindSpan);
+    InstrumentationEntry innermostEntry = _entry("SelfTimeInnermost", InstrumentationKindSpan);
+    InstrumentationEntry waitedEntry = _entry("SelfTimeWaited", InstrumentationKindSpan);
+
+    EXPECT_EQ(1u, outerEntry.count);
+    EXPECT_EQ(2u, innerEntry.count);
+    EXPECT_EQ(2u, innermostEntry.count);
+    EXPECT_EQ(1u, waitedEntry.count);
+
+    // Each span's self time is its total less the total of the spans directly inside it, give or take a nanosecond lost
+    // converting each to nanoseconds.
+    EXPECT_GE(outerEntry.total, innerEntry.total);
+    EXPECT_LE(llabs(outerEntry.self - (outerEntry.total - innerEntry.total)), 3);
+    EXPECT_LE(llabs(innerEntry.self - (innerEntry.total - innermostEntry.total)), 3);
+    EXPECT_EQ(innermostEntry.total, innermostEntry.self);
+    EXPECT_EQ(waitedEntry.total, waitedEntry.self);
+
+    // Sleep may return up to a timer tick early, so only check the self times are about what was slept outside nested spans.
+    EXPECT_GE(outerEntry.self, 15 * 1000000LL);
+    EXPECT_GE(innerEntry.self, 15 * 1000000LL);
+    EXPECT_GE(innermostEntry.self, 15 * 1000000LL);
+    EXPECT_LT(outerEntry.self, outerEntry.total);
+    EXPECT_GE(waitedEntry.total, innerEntry.total);
+
+    EXPECT_LE(innermostEntry.max, innermostEntry.total);
+    EXPECT_GE(innermostEntry.max * 2, innermostEntry.total);
+}
+
+TEST(Instrumentation, SumsCountersAcrossThreads) {
+    unsigned int counter = InstrumentationRegisterSite(c_category, "SumsCounters", InstrumentationKindCounter);
+    const int threadCount = 8;
+    const int updates = 1000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back([counter]() {
+            for (int value = 1; value <= updates; value++) {
+                InstrumentationAddCounter(counter, value);
+            }
+        });
+    }
+
+    // Snapshots taken while the threads record only ever see whole updates, and never go backwards.
+    uint64_t lastCount = 0;
+    for (int i = 0; i < 100; i++) {
+        InstrumentationEntry entry = _entry("SumsCounters", InstrumentationKindCounter);
+        EXPECT_GE(entry.count, lastCount);
+        EXPECT_LE(entry.count, static_cast<uint64_t>(threadCount * updates));
+        lastCount = entry.count;
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    InstrumentationEntry entry = _entry("SumsCounters", InstrumentationKindCounter);
+    EXPECT_EQ(static_cast<uint64_t>(threadCount * updates), entry.count);
+    EXPECT_EQ(static_cast<int64_t>(threadCount) * updates * (updates + 1) / 2, entry.total);
+    EXPECT_EQ(entry.total, entry.self);
+    EXPECT_EQ(updates, entry.max);
+    EXPECT_EQ(entry.count, _histogramCount(entry));
+    EXPECT_EQ(static_cast<uint64_t>(threadCount), entry.histogram[0]);
+
+    // Updates on this thread add to those of the threads that have exited.
+    InstrumentationAddCounter(counter, -500);
+    entry = _entry("SumsCounters", InstrumentationKindCounter);
+    EXPECT_EQ(static_cast<uint64_t>(threadCount * updates + 1), entry.count);
+    EXPECT_EQ(static_cast<int64_t>(threadCount) * updates * (updates + 1) / 2 - 500, entry.total);
+    EXPECT_EQ(updates, entry.max);
+}
+
+TEST(Instrumentation, KeepsAggregatesOfExitedThreads) {
+    unsigned int span = InstrumentationRegisterSite(c_category, "ExitedThreadSpan", InstrumentationKindSpan);
+    unsigned int counter = InstrumentationRegisterSite(c_category, "ExitedThreadCounter", InstrumentationKindCounter);
+
+    HANDLE recorded = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    HANDLE release = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    auto closeEvents = wil::ScopeExit([&]() {
+        CloseHandle(recorded);
+        CloseHandle(release);
+    });
+
+    for (uint64_t i = 1; i <= 3; i++) {
+        ResetEvent(recorded);
+        ResetEvent(release);
+        std::thread thread([&]() {
+            InstrumentationEndSpan(span, InstrumentationBeginSpan(span));
+            InstrumentationAddCounter(counter, 7);
+            SetEvent(recorded);
+            WaitForSingleObject(release, INFINITE);
+        });
+
+        // The same totals are reported while the thread is running and once it has exited.
+        ASSERT_EQ(WAIT_OBJECT_0, WaitForSingleObject(recorded, 5000));
+        InstrumentationEntry running = _entry("ExitedThreadSpan", InstrumentationKindSpan);
+        EXPECT_EQ(i, running.count);
+        EXPECT_EQ(static_cast<int64_t>(7 * i), _entry("ExitedThreadCounter", InstrumentationKindCounter).total);
+
+        SetEvent(release);
+        thread.join();
+
+        InstrumentationEntry exited = _entry("ExitedThreadSpan", InstrumentationKindSpan);
+        EXPECT_EQ(i, exited.count);
+        EXPECT_EQ(running.total, exited.total);
+        EXPECT_EQ(running.self, exited.self);
+        EXPECT_EQ(running.max, exited.max);
+        EXPECT_EQ(i, _histogramCount(exited));
+
+        InstrumentationEntry counted = _entry("ExitedThreadCounter", InstrumentationKindCounter);
+        EXPECT_EQ(i, counted.count);
+        EXPECT_EQ(static_cast<int64_t>(7 * i), counted.total);
+        EXPECT_EQ(7, counted.max);
+    }
+}
+
+// A file in the temporary directory for a trace, removed when the test ends.
+class TraceFile {
+public:
+    explicit TraceFile(NSString* name) : _path([[NSTemporaryDirectory() stringByAppendingPathComponent:name] retain]) {
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+        std::vector<unichar> characters([_path length]);
+        [_path getCharacters:characters.data() range:NSMakeRange(0, characters.size())];
+        _widePath.assign(characters.begin(), characters.end());
+    }
+
+    ~TraceFile() {
+        InstrumentationStopTrace();
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+        [_path release];
+    }
+
+    const wchar_t* Path() const {
+        return _widePath.c_str();
+    }
+
+    NSDictionary* Contents() const {
+        NSData* data = [NSData dataWithContentsOfFile:_path];
+        return data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    }
+
+private:
+    NSString* _path;
+    std::wstring _widePath;
+};
+
+// A name that must be escaped in the trace.
+static const char* c_escapedName = "Trace \"span\" \\ with\tescapes";
+
+TEST(Instrumentation, WritesWellFormedTrace) {
+    TraceFile file(@"InstrumentationTrace.json");
+    unsigned int outer = InstrumentationRegisterSite(c_category, "TraceOuter", InstrumentationKindSpan);
+    unsigned int inner = InstrumentationRegisterSite(c_category, c_escapedName, InstrumentationKindSpan);
+    unsigned int counter = InstrumentationRegisterSite(c_category, "TraceCounter", InstrumentationKindCounter);
+
+    // Spans that end before the trace starts are not in it.
+    InstrumentationEndSpan(outer, InstrumentationBeginSpan(outer));
+
+    ASSERT_FALSE(g_instrumentationEnabled);
+    ASSERT_TRUE(InstrumentationStartTrace(file.Path()));
+    EXPECT_TRUE(g_instrumentationEnabled);
+    EXPECT_FALSE(InstrumentationStartTrace(file.Path()));
+
+    DWORD otherThreadId = 0;
+    {
+        int64_t outerStart = InstrumentationBeginSpan(outer);
+        int64_t innerStart = InstrumentationBeginSpan(inner);
+        Sleep(1);
+        InstrumentationEndSpan(inner, innerStart);
+        InstrumentationAddCounter(counter, 5);
+        InstrumentationEndSpan(outer, outerStart);
+    }
+
+    std::thread thread([&]() {
+        otherThreadId = GetCurrentThreadId();
+        InstrumentationEndSpan(inner, InstrumentationBeginSpan(inner));
+        InstrumentationAddCounter(counter, 7);
+    });
+    thread.join();
+    InstrumentationAddCounter(counter, -2);
+
+    InstrumentationStopTrace();
+    EXPECT_FALSE(g_instrumentationEnabled);
+
+    NSDictionary* contents = file.Contents();
+    ASSERT_OBJCNE(nil, contents);
+    ASSERT_TRUE([contents isKindOfClass:[NSDictionary class]]);
+    EXPECT_OBJCEQ(@"0", contents[@"otherData"][@"droppedEvents"]);
+
+    NSArray* events = contents[@"traceEvents"];
+    ASSERT_TRUE([events isKindOfClass:[NSArray class]]);
+
+    NSString* category = [NSString stringWithUTF8String:c_category];
+    NSString* escapedName = [NSString stringWithUTF8String:c_escapedName];
+    NSNumber* processId = @(GetCurrentProcessId());
+    NSNumber* threadId = @(GetCurrentThreadId());
+
+    NSDictionary* outerEvent = nil;
+    std::vector<NSDictionary*> innerEvents;
+    std::vector<long long> counterValues;
+    for (NSDictionary* event in events) {
+        ASSERT_TRUE([event isKindOfClass:[NSDictionary class]]);
+        ASSERT_TRUE([event[@"name"] isKindOfClass:[NSString class]]);
+        ASSERT_TRUE([event[@"ts"] isKindOfClass:[NSNumber class]]);
+        EXPECT_GE([event[@"ts"] doubleValue], 0.0);
+        ASSERT_TRUE([event[@"tid"] isKindOfClass:[NSNumber class]]);
+        EXPECT_OBJCEQ(processId, event[@"pid"]);
+
+        if (![category isEqualToString:event[@"cat"]]) {
+            continue;
+        }
+
+        if ([event[@"name"] isEqualToString:@"TraceOuter"]) {
+            EXPECT_OBJCEQ(nil, outerEvent);
+            outerEvent = event;
+            EXPECT_OBJCEQ(@"X", event[@"ph"]);
+            EXPECT_GE([event[@"dur"] doubleValue], 0.0);
+            EXPECT_OBJCEQ(threadId, event[@"tid"]);
+        } else if ([event[@"name"] isEqualToString:escapedName]) {
+            innerEvents.push_back(event);
+            EXPECT_OBJCEQ(@"X", event[@"ph"]);
+            EXPECT_GE([event[@"dur"] doubleValue], 0.0);
+        } else if ([event[@"name"] isEqualToString:@"TraceCounter"]) {
+            // Counter events carry the running total.
+            EXPECT_OBJCEQ(@"C", event[@"ph"]);
+            counterValues.push_back([event[@"args"][@"value"] longLongValue]);
+        }
+    }
+
+    ASSERT_OBJCNE(nil, outerEvent);
+    ASSERT_EQ(2u, innerEvents.size());
+
+    // The nested span lies within the span around it.
+    NSDictionary* innerEvent = innerEvents[0];
+    EXPECT_OBJCEQ(threadId, innerEvent[@"tid"]);
+    EXPECT_GE([innerEvent[@"ts"] doubleValue], [outerEvent[@"ts"] doubleValue]);
+    EXPECT_LE([innerEvent[@"ts"] doubleValue] + [innerEvent[@"dur"] doubleValue],
+              [outerEvent[@"ts"] doubleValue] + [outerEvent[@"dur"] doubleValue] + 0.001);
+    EXPECT_OBJCEQ(@(otherThreadId), innerEvents[1][@"tid"]);
+
+    EXPECT_EQ((std::vector<long long>{ 5, 12, 10 }), counterValues);
+}
+
+TEST(Instrumentation, StartTraceFailsWithoutAFile) {
+    NSString* directory = [NSTemporaryDirectory() stringByAppendingPathComponent:@"InstrumentationTestsMissingDirectory"];
+    [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+    NSString* path = [directory stringByAppendingPathComponent:@"trace.json"];
+    std::vector<unichar> characters([path length]);
+    [path getCharacters:characters.data() range:NSMakeRange(0, characters.size())];
+    std::wstring widePath(characters.begin(), characters.end());
+
+    EXPECT_FALSE(InstrumentationStartTrace(widePath.c_str()));
+    EXPECT_FALSE(g_instrumentationEnabled);
+
+    // Stopping a trace that is not running does nothing.
+    InstrumentationStopTrace();
+    EXPECT_FALSE(g_instrumentationEnabled);
+}
@@ -0,0 +1,172 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      _NSMemoryPressure* registry and monitor
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <NSMemoryPressure.h>
+#import <Starboard.h>
+
+#include <algorithm>
+
+@interface NSMemoryPressureTestClient : NSObject <_NSMemoryPressureClient>
+- (instancetype)initWithName:(NSString*)name log:(NSMutableArray*)log;
+@end
+
+@implementation NSMemoryPressureTestClient {
+    StrongId<NSString> _name;
+    StrongId<NSMutableArray> _log;
+}
+
+- (instancetype)initWithName:(NSString*)name log:(NSMutableArray*)log {
+    if (self = [super init]) {
+        _name = name;
+        _log = log;
+    }
+    return self;
+}
+
+- (void)_shedMemoryForPressureLevel:(_NSMemoryPressureLevel)level {
+    [_log addObject:_name];
+}
+@end
+
+TEST(NSMemoryPressure, ClientsShedInPriorityOrder) {
+    NSMutableArray* log = [NSMutableArray array];
+    StrongId<NSMemoryPressureTestClient> late;
+    late.attach([[NSMemoryPressureTestClient alloc] initWithName:@"late" log:log]);
+    StrongId<NSMemoryPressureTestClient> early;
+    early.attach([[NSMemoryPressureTestClient alloc] initWithName:@"early" log:log]);
+
+    _NSMemoryPressureAddClient(late, _NSMemoryPressurePriorityURLCache + 1);
+    _NSMemoryPressureAddClient(early, _NSMemoryPressurePriorityPurgeableData - 1);
+    auto removeClients = wil::ScopeExit([&]() {
+        _NSMemoryPressureRemoveClient(late);
+        _NSMemoryPressureRemoveClient(early);
+    });
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelWarning);
+    ASSERT_EQ(2, [log count]);
+    ASSERT_OBJCEQ(@"early", log[0]);
+    ASSERT_OBJCEQ(@"late", log[1]);
+
+    [log removeAllObjects];
+    _NSMemoryPressureRemoveClient(early);
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelCritical);
+    ASSERT_EQ(1, [log count]);
+    ASSERT_OBJCEQ(@"late", log[0]);
+}
+
+TEST(NSMemoryPressure, DeallocatedClientsAreSkipped) {
+    NSMutableArray* log = [NSMutableArray array];
+    {
+        StrongId<NSMemoryPressureTestClient> client;
+        client.attach([[NSMemoryPressureTestClient alloc] initWithName:@"gone" log:log]);
+        _NSMemoryPressureAddClient(client, 0);
+    }
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelCritical);
+    ASSERT_EQ(0, [log count]);
+}
+
+TEST(NSMemoryPressure, PurgeableDataIsDiscarded) {
+    NSPurgeableData* accessed = [NSPurgeableData dataWithLength:64];
+    NSPurgeableData* idle = [NSPurgeableData dataWithLength:64];
+    [idle endContentAccess];
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelWarning);
+
+    ASSERT_FALSE([accessed isContentDiscarded]);
+    ASSERT_EQ(64, [accessed length]);
+    ASSERT_TRUE([idle isContentDiscarded]);
+    ASSERT_EQ(0, [idle length]);
+}
+
+TEST(NSMemoryPressure, CacheShedsLeastRecentlyUsed) {
+    NSCache* cache = [[NSCache new] autorelease];
+    for (int i = 0; i < 8; ++i) {
+        [cache setObject:@(i) forKey:@(i)];
+    }
+
+    // Touching 0 makes it the most recently used entry.
+    ASSERT_OBJCEQ(@0, [cache objectForKey:@0]);
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelWarning);
+    ASSERT_OBJCEQ(@0, [cache objectForKey:@0]);
+    ASSERT_OBJCEQ(@7, [cache objectForKey:@7]);
+    ASSERT_OBJCEQ(nil, [cache objectForKey:@1]);
+    ASSERT_OBJCEQ(nil, [cache objectForKey:@3]);
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelCritical);
+    ASSERT_OBJCEQ(nil, [cache objectForKey:@0]);
+    ASSERT_OBJCEQ(nil, [cache objectForKey:@7]);
+}
+
+TEST(NSMemoryPressure, URLCacheSheds) {
+    NSURLCache* cache = [[[NSURLCache alloc] initWithMemoryCapacity:1024 diskCapacity:0 diskPath:nil] autorelease];
+    for (int i = 0; i < 4; ++i) {
+        NSURL* url = [NSURL URLWithString:[NSString stringWithFormat:@"http://%d.com", i]];
+        NSURLResponse* response =
+            [[[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"1.1" headerFields:nil] autorelease];
+        NSCachedURLResponse* cachedResponse =
+            [[[NSCachedURLResponse alloc] initWithResponse:response data:[NSMutableData dataWithLength:100]] autorelease];
+        [cache storeCachedResponse:cachedResponse forRequest:[NSURLRequest requestWithURL:url]];
+    }
+    ASSERT_EQ(400, [cache currentMemoryUsage]);
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelWarning);
+    ASSERT_EQ(200, [cache currentMemoryUsage]);
+    ASSERT_OBJCNE(nil, [cache cachedResponseForRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:@"http://3.com"]]]);
+
+    _NSMemoryPressureSignal(_NSMemoryPressureLevelCritical);
+    ASSERT_EQ(0, [cache currentMemoryUsage]);
+}
+
+// Fills a cache with 512MB of purgeable data, 1MB at a time, against a 64MB budget over the starting usage. The monitor
+// has to keep the process under budget by discarding the content that is not being accessed.
+TEST(NSMemoryPressure, StaysUnderBudget) {
+    static const size_t sc_blockSize = 1024 * 1024;
+    static const size_t sc_blockCount = 512;
+    static const size_t sc_headroom = 64 * sc_blockSize;
+
+    NSCache* cache = [[NSCache new] autorelease];
+
+    size_t baseline = _NSMemoryPressureProcessUsage();
+    ASSERT_NE(0, baseline);
+    _NSMemoryPressureSetBudget(baseline + sc_headroom);
+    auto removeBudget = wil::ScopeExit([]() { _NSMemoryPressureSetBudget(0); });
+
+    size_t peak = 0;
+    for (size_t i = 0; i < sc_blockCount; ++i) {
+        @autoreleasepool {
+            NSPurgeableData* data = [NSPurgeableData dataWithLength:sc_blockSize];
+            memset([data mutableBytes], static_cast<int>(i), sc_blockSize);
+            [data endContentAccess];
+            [cache setObject:data forKey:@(i) cost:sc_blockSize];
+        }
+
+        _NSMemoryPressurePoll();
+        peak = std::max(peak, _NSMemoryPressureProcessUsage());
+    }
+
+    // One block of slack, for the allocation that tips the process over the warning mark.
+    EXPECT_GT(baseline + sc_headroom + sc_blockSize, peak);
+
+    // The most recent block may still be there; the oldest has been discarded and is evicted on access.
+    EXPECT_OBJCEQ(nil, [cache objectForKey:@0]);
+}
@@ -0,0 +1,196 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      NSURLProtocol_file streaming, mapping and Range support
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <Starboard.h>
+
+#include <atomic>
+
+static const int64_t c_fetchTimeoutInNanoseconds = 30 * NSEC_PER_SEC;
+
+struct FetchResult {
+    StrongId<NSData> data;
+    StrongId<NSURLResponse> response;
+    StrongId<NSError> error;
+};
+
+static FetchResult _fetch(NSURLRequest* request) {
+    __block FetchResult result;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]];
+    NSURLSessionDataTask* task = [session dataTaskWithRequest:request
+                                            completionHandler:^(NSData* data, NSURLResponse* response, NSError* error) {
+                                                result.data = data;
+                                                result.response = response;
+                                                result.error = error;
+                                                dispatch_semaphore_signal(done);
+                                            }];
+    [task resume];
+    EXPECT_EQ(0, dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, c_fetchTimeoutInNanoseconds)));
+    return result;
+}
+
+static NSURLRequest* _request(NSString* path, NSString* range = nil) {
+    NSMutableURLRequest* request = [NSMutableURLRequest requestWithURL:[NSURL fileURLWithPath:path]];
+    if (range) {
+        [request setValue:range forHTTPHeaderField:@"Range"];
+    }
+    return request;
+}
+
+// Writes length bytes of a repeating pattern to a new temporary file.
+static NSString* _createFile(NSString* name, NSUInteger length) {
+    NSMutableData* data = [NSMutableData dataWithLength:length];
+    uint8_t* bytes = static_cast<uint8_t*>([data mutableBytes]);
+    for (NSUInteger i = 0; i < length; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:name];
+    EXPECT_TRUE([data writeToFile:path atomically:NO]);
+    return path;
+}
+
+static NSData* _contentsOfFile(NSString* path, NSRange range) {
+    return [[NSData dataWithContentsOfFile:path] subdataWithRange:range];
+}
+
+TEST(NSURLProtocol_file, StreamsWholeFile) {
+    NSString* path = _createFile(@"NSURLProtocolFileWhole.bin", 3 * 1024 * 1024 + 17);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+
+    FetchResult result = _fetch(_request(path));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(3 * 1024 * 1024 + 17, [result.response expectedContentLength]);
+    ASSERT_OBJCEQ([NSData dataWithContentsOfFile:path], result.data.get());
+}
+
+TEST(NSURLProtocol_file, StreamsMappedFile) {
+    NSString* path = _createFile(@"NSURLProtocolFileMapped.bin", 20 * 1024 * 1024 + 3);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+
+    FetchResult result = _fetch(_request(path));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_OBJCEQ([NSData dataWithContentsOfFile:path], result.data.get());
+
+    // A range that starts off an allocation granularity boundary.
+    result = _fetch(_request(path, @"bytes=100001-"));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(206, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_OBJCEQ(_contentsOfFile(path, NSMakeRange(100001, 20 * 1024 * 1024 + 3 - 100001)), result.data.get());
+}
+
+TEST(NSURLProtocol_file, HonorsRanges) {
+    NSString* path = _createFile(@"NSURLProtocolFileRanges.bin", 1000);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+
+    FetchResult result = _fetch(_request(path, @"bytes=10-19"));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    NSHTTPURLResponse* response = static_cast<NSHTTPURLResponse*>(result.response.get());
+    ASSERT_EQ(206, [response statusCode]);
+    ASSERT_OBJCEQ(@"bytes 10-19/1000", [[response allHeaderFields] objectForKey:@"Content-Range"]);
+    ASSERT_OBJCEQ(_contentsOfFile(path, NSMakeRange(10, 10)), result.data.get());
+
+    result = _fetch(_request(path, @"bytes=-5"));
+    ASSERT_EQ(206, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_OBJCEQ(_contentsOfFile(path, NSMakeRange(995, 5)), result.data.get());
+
+    result = _fetch(_request(path, @"bytes=990-5000"));
+    ASSERT_EQ(206, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_OBJCEQ(_contentsOfFile(path, NSMakeRange(990, 10)), result.data.get());
+
+    // Lists of ranges are not supported: the whole file comes back.
+    result = _fetch(_request(path, @"bytes=0-1,5-6"));
+    ASSERT_FALSE([result.response isKindOfClass:[NSHTTPURLResponse class]]);
+    ASSERT_EQ(1000, [result.data length]);
+}
+
+TEST(NSURLProtocol_file, RejectsUnsatisfiableRanges) {
+    NSString* path = _createFile(@"NSURLProtocolFileUnsatisfiable.bin", 10);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+
+    FetchResult result = _fetch(_request(path, @"bytes=100-"));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    NSHTTPURLResponse* response = static_cast<NSHTTPURLResponse*>(result.response.get());
+    ASSERT_EQ(416, [response statusCode]);
+    ASSERT_OBJCEQ(@"bytes */10", [[response allHeaderFields] objectForKey:@"Content-Range"]);
+    ASSERT_EQ(0, [result.data length]);
+}
+
+TEST(NSURLProtocol_file, FailsForMissingFiles) {
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"NSURLProtocolFileMissing.bin"];
+    FetchResult result = _fetch(_request(path));
+    ASSERT_OBJCEQ(NSURLErrorDomain, [result.error domain]);
+    ASSERT_EQ(NSURLErrorFileDoesNotExist, [result.error code]);
+
+    result = _fetch(_request(NSTemporaryDirectory()));
+    ASSERT_EQ(NSURLErrorFileIsDirectory, [result.error code]);
+}
+
+@interface NSURLProtocolFileCancellingDelegate : NSObject <NSURLSessionDataDelegate>
+@property (readonly) dispatch_semaphore_t completed;
+@property (readonly) uint64_t bytesReceived;
+@end
+
+@implementation NSURLProtocolFileCancellingDelegate {
+    std::atomic<uint64_t> _bytesReceived;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _completed = dispatch_semaphore_create(0);
+    }
+    return self;
+}
+
+- (uint64_t)bytesReceived {
+    return _bytesReceived;
+}
+
+- (void)URLSession:(NSURLSession*)session dataTask:(NSURLSessionDataTask*)dataTask didReceiveData:(NSData*)data {
+    if ((_bytesReceived += [data length]) == [data length]) {
+        [dataTask cancel];
+    }
+}
+
+- (void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task didCompleteWithError:(NSError*)error {
+    dispatch_semaphore_signal(_completed);
+}
+@end
+
+TEST(NSURLProtocol_file, CancelsPromptly) {
+    // Extending the file is quick, and reads back as zeroes.
+    static const unsigned long long c_size = 512ull * 1024 * 1024;
+    NSString* path = _createFile(@"NSURLProtocolFileCancel.bin", 0);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+    NSFileHandle* handle = [NSFileHandle fileHandleForWritingAtPath:path];
+    [handle truncateFileAtOffset:c_size];
+    [handle closeFile];
+
+    StrongId<NSURLProtocolFileCancellingDelegate> delegate;
+    delegate.attach([NSURLProtocolFileCancellingDelegate new]);
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:delegate
+                                                     delegateQueue:nil];
+    [[session dataTaskWithRequest:_request(path)] resume];
+
+    ASSERT_EQ(0, dispatch_semaphore_wait([delegate completed], dispatch_time(DISPATCH_TIME_NOW, c_fetchTimeoutInNanoseconds)));
+    ASSERT_LT([delegate bytesReceived], c_size);
+}
@@ -0,0 +1,200 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      NSURLProtocol_HTTP, against a loopback server
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <NSURLProtocol_HTTP.h>
+#import <Starboard.h>
+
+#include "tests/unittests/Foundation/LoopbackHTTPServer.h"
+
+static const int64_t c_fetchTimeoutInNanoseconds = 10 * NSEC_PER_SEC;
+
+static NSURLSession* _pooledSession(NSInteger maximumConnections, bool pipelining = false) {
+    NSURLSessionConfiguration* configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.protocolClasses = @[ [NSURLProtocol_HTTP class] ];
+    configuration.HTTPMaximumConnectionsPerHost = maximumConnections;
+    configuration.HTTPShouldUsePipelining = pipelining;
+    return [NSURLSession sessionWithConfiguration:configuration];
+}
+
+static NSURL* _url(const LoopbackHTTPServer& server, const std::string& path) {
+    return [NSURL URLWithString:[NSString stringWithUTF8String:server.URL(path).c_str()]];
+}
+
+struct FetchResult {
+    StrongId<NSData> data;
+    StrongId<NSURLResponse> response;
+    StrongId<NSError> error;
+};
+
+// Starts a data task for each URL at once, and waits for all of them.
+static std::vector<FetchResult> _fetchAll(NSURLSession* session, NSArray<NSURL*>* urls) {
+    std::vector<FetchResult> results(urls.count);
+    FetchResult* slots = results.data();
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger i = 0; i < urls.count; ++i) {
+        dispatch_group_enter(group);
+        NSURLSessionDataTask* task = [session dataTaskWithURL:urls[i]
+                                            completionHandler:^(NSData* data, NSURLResponse* response, NSError* error) {
+                                                slots[i].data = data;
+                                                slots[i].response = response;
+                                                slots[i].error = error;
+                                                dispatch_group_leave(group);
+                                            }];
+        [task resume];
+    }
+    EXPECT_EQ(0, dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, c_fetchTimeoutInNanoseconds)));
+    return results;
+}
+
+static FetchResult _fetch(NSURLSession* session, NSURL* url) {
+    return _fetchAll(session, @[ url ])[0];
+}
+
+TEST(NSURLProtocol_HTTP, ContentLengthBody) {
+    std::string body(100000, 'x');
+    LoopbackHTTPServer server([&body](const std::string&, const std::string&) { return LoopbackHTTPServer::Reply(body); });
+
+    FetchResult result = _fetch(_pooledSession(6), _url(server, "/content-length"));
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(200, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_EQ(body.size(), [result.data length]);
+    ASSERT_EQ(0, memcmp(body.data(), [result.data bytes], body.size()));
+}
+
+TEST(NSURLProtocol_HTTP, ChunkedBody) {
+    LoopbackHTTPServer server([](const std::string&, const std::string&) {
+        LoopbackHTTPServer::Response response;
+        response.bytes = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                         "5\r\nhello\r\n7;name=value\r\n, world\r\n0\r\nX-Trailer: ignored\r\n\r\n";
+        return response;
+    });
+
+    NSURLSession* session = _pooledSession(6);
+    for (int i = 0; i < 2; ++i) {
+        FetchResult result = _fetch(session, _url(server, "/chunked"));
+        ASSERT_OBJCEQ(nil, result.error.get());
+        ASSERT_OBJCEQ([@"hello, world" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    }
+
+    // The second response was read from the same connection, right behind the trailers of the first.
+    ASSERT_EQ(1, server.ConnectionsAccepted());
+}
+
+TEST(NSURLProtocol_HTTP, ReusesConnections) {
+    LoopbackHTTPServer server([](const std::string& head, const std::string&) { return LoopbackHTTPServer::Reply(head.substr(0, 3)); });
+
+    NSURLSession* session = _pooledSession(6);
+    for (int i = 0; i < 10; ++i) {
+        FetchResult result = _fetch(session, _url(server, "/reuse"));
+        ASSERT_OBJCEQ(nil, result.error.get());
+        ASSERT_OBJCEQ([@"GET" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    }
+
+    ASSERT_EQ(1, server.ConnectionsAccepted());
+    ASSERT_EQ(10, server.RequestsServed());
+}
+
+TEST(NSURLProtocol_HTTP, HonorsMaximumConnectionsPerHost) {
+    LoopbackHTTPServer server([](const std::string&, const std::string&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return LoopbackHTTPServer::Reply("ok");
+    });
+
+    NSMutableArray* urls = [NSMutableArray array];
+    for (int i = 0; i < 12; ++i) {
+        [urls addObject:_url(server, "/limited")];
+    }
+
+    for (const FetchResult& result : _fetchAll(_pooledSession(2), urls)) {
+        ASSERT_OBJCEQ(nil, result.error.get());
+        ASSERT_OBJCEQ([@"ok" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    }
+    ASSERT_GE(2, server.ConnectionsAccepted());
+    ASSERT_EQ(12, server.RequestsServed());
+}
+
+TEST(NSURLProtocol_HTTP, PipelinesOnPersistentConnections) {
+    LoopbackHTTPServer server([](const std::string& head, const std::string&) {
+        // Echo the path, so that responses can be matched with requests.
+        size_t start = head.find(' ') + 1;
+        return LoopbackHTTPServer::Reply(head.substr(start, head.find(' ', start) - start));
+    });
+
+    NSURLSession* session = _pooledSession(1, true);
+    ASSERT_OBJCEQ(nil, _fetch(session, _url(server, "/warm-up")).error.get());
+
+    NSMutableArray* urls = [NSMutableArray array];
+    for (int i = 0; i < 8; ++i) {
+        [urls addObject:_url(server, "/pipelined/" + std::to_string(i))];
+    }
+
+    std::vector<FetchResult> results = _fetchAll(session, urls);
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_OBJCEQ(nil, results[i].error.get());
+        NSString* expected = [NSString stringWithFormat:@"/pipelined/%u", static_cast<unsigned>(i)];
+        ASSERT_OBJCEQ([expected dataUsingEncoding:NSUTF8StringEncoding], results[i].data.get());
+    }
+    ASSERT_EQ(1, server.ConnectionsAccepted());
+}
+
+TEST(NSURLProtocol_HTTP, RetriesStaleConnections) {
+    LoopbackHTTPServer server([](const std::string&, const std::string&) {
+        // Advertise a persistent connection, then drop it.
+        LoopbackHTTPServer::Response response = LoopbackHTTPServer::Reply("ok");
+        response.close = true;
+        return response;
+    });
+
+    NSURLSession* session = _pooledSession(6);
+    for (int i = 0; i < 3; ++i) {
+        FetchResult result = _fetch(session, _url(server, "/stale"));
+        ASSERT_OBJCEQ(nil, result.error.get());
+        ASSERT_OBJCEQ([@"ok" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    }
+    ASSERT_EQ(3, server.ConnectionsAccepted());
+}
+
+TEST(NSURLProtocol_HTTP, HonorsConnectionClose) {
+    LoopbackHTTPServer server(
+        [](const std::string&, const std::string&) { return LoopbackHTTPServer::Reply("ok", "Connection: close\r\n"); });
+
+    NSURLSession* session = _pooledSession(6);
+    ASSERT_OBJCEQ(nil, _fetch(session, _url(server, "/close")).error.get());
+    ASSERT_OBJCEQ(nil, _fetch(session, _url(server, "/close")).error.get());
+    ASSERT_EQ(2, server.ConnectionsAccepted());
+}
+
+TEST(NSURLProtocol_HTTP, TimesOut) {
+    LoopbackHTTPServer server([](const std::string&, const std::string&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        return LoopbackHTTPServer::Reply("late");
+    });
+
+    NSURLSessionConfiguration* configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.protocolClasses = @[ [NSURLProtocol_HTTP class] ];
+    configuration.timeoutIntervalForRequest = 0.2;
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:configuration];
+
+    FetchResult result = _fetch(session, _url(server, "/slow"));
+    ASSERT_OBJCNE(nil, result.error.get());
+    ASSERT_OBJCEQ(NSURLErrorDomain, [result.error domain]);
+    ASSERT_EQ(NSURLErrorTimedOut, [result.error code]);
+}
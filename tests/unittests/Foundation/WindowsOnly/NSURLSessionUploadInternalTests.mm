@@ -0,0 +1,368 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Windows-only:
+//      NSURLSessionUploadTask, against a loopback server
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import <Starboard.h>
+
+#include "tests/unittests/Foundation/LoopbackHTTPServer.h"
+
+#include <algorithm>
+#include <vector>
+
+static const int64_t c_uploadTimeoutInNanoseconds = 10 * NSEC_PER_SEC;
+
+static NSMutableURLRequest* _postRequest(const LoopbackHTTPServer& server, const std::string& path) {
+    NSMutableURLRequest* request =
+        [NSMutableURLRequest requestWithURL:[NSURL URLWithString:[NSString stringWithUTF8String:server.URL(path).c_str()]]];
+    request.HTTPMethod = @"POST";
+    return request;
+}
+
+static NSData* _patternData(NSUInteger length) {
+    NSMutableData* data = [NSMutableData dataWithLength:length];
+    uint8_t* bytes = static_cast<uint8_t*>([data mutableBytes]);
+    for (NSUInteger i = 0; i < length; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 13);
+    }
+    return data;
+}
+
+// Remembers the last request it saw, and answers with the length of its body.
+struct RecordingServer {
+    std::string head;
+    std::string body;
+    LoopbackHTTPServer server;
+
+    RecordingServer()
+        : server([this](const std::string& requestHead, const std::string& requestBody) {
+              head = requestHead;
+              body = requestBody;
+              return LoopbackHTTPServer::Reply(std::to_string(requestBody.size()));
+          }) {
+    }
+};
+
+struct UploadResult {
+    StrongId<NSData> data;
+    StrongId<NSURLResponse> response;
+    StrongId<NSError> error;
+};
+
+static void _wait(NSURLSessionUploadTask* task, dispatch_semaphore_t done) {
+    [task resume];
+    EXPECT_EQ(0, dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, c_uploadTimeoutInNanoseconds)));
+}
+
+@interface NSURLSessionUploadTestDelegate : NSObject <NSURLSessionDataDelegate>
+@property (retain) NSInputStream* bodyStream;
+// When set, the body stream is only handed over once the test calls the handler itself.
+@property BOOL defersBodyStream;
+@property (readonly) void (^bodyStreamHandler)(NSInputStream*);
+@property (readonly) dispatch_semaphore_t bodyStreamRequested;
+@property (readonly) int bodyStreamRequests;
+@property (readonly) dispatch_semaphore_t completed;
+@property (readonly) NSMutableData* receivedData;
+- (std::vector<int64_t>)totalsSent;
+@property (readonly) int64_t expectedToSend;
+@property (readonly) NSError* error;
+@end
+
+@implementation NSURLSessionUploadTestDelegate {
+    std::vector<int64_t> _totalsSent;
+}
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _completed = dispatch_semaphore_create(0);
+        _bodyStreamRequested = dispatch_semaphore_create(0);
+        _receivedData = [NSMutableData new];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_bodyStream release];
+    [_bodyStreamHandler release];
+    [_receivedData release];
+    [_error release];
+    [super dealloc];
+}
+
+- (std::vector<int64_t>)totalsSent {
+    return _totalsSent;
+}
+
+- (void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task needNewBodyStream:(void (^)(NSInputStream*))completionHandler {
+    ++_bodyStreamRequests;
+    if (_defersBodyStream) {
+        _bodyStreamHandler = [completionHandler copy];
+        dispatch_semaphore_signal(_bodyStreamRequested);
+        return;
+    }
+    completionHandler(_bodyStream);
+}
+
+- (void)URLSession:(NSURLSession*)session
+                        task:(NSURLSessionTask*)task
+             didSendBodyData:(int64_t)bytesSent
+              totalBytesSent:(int64_t)totalBytesSent
+    totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
+    _totalsSent.push_back(totalBytesSent);
+    _expectedToSend = totalBytesExpectedToSend;
+}
+
+- (void)URLSession:(NSURLSession*)session dataTask:(NSURLSessionDataTask*)dataTask didReceiveData:(NSData*)data {
+    [_receivedData appendData:data];
+}
+
+- (void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task didCompleteWithError:(NSError*)error {
+    _error = [error retain];
+    dispatch_semaphore_signal(_completed);
+}
+@end
+
+// Answers requests that carry an X-Upload-Test-Protocol header itself, without touching the network.
+@interface NSURLSessionUploadTestProtocol : NSURLProtocol
+@end
+
+@implementation NSURLSessionUploadTestProtocol
++ (BOOL)canInitWithRequest:(NSURLRequest*)request {
+    return [request valueForHTTPHeaderField:@"X-Upload-Test-Protocol"] != nil;
+}
+
++ (NSURLRequest*)canonicalRequestForRequest:(NSURLRequest*)request {
+    return request;
+}
+
+- (void)startLoading {
+    NSHTTPURLResponse* response =
+        [[[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:299 HTTPVersion:@"HTTP/1.1" headerFields:nil] autorelease];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocol:self didLoadData:[@"intercepted" dataUsingEncoding:NSUTF8StringEncoding]];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+}
+@end
+
+TEST(NSURLSessionUploadTask, UploadsData) {
+    RecordingServer recorder;
+    NSData* body = _patternData(300000);
+
+    __block UploadResult result;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSessionTaskCompletionHandler completionHandler = ^(NSData* data, NSURLResponse* response, NSError* error) {
+        result.data = data;
+        result.response = response;
+        result.error = error;
+        dispatch_semaphore_signal(done);
+    };
+    NSURLSessionUploadTask* task = [[NSURLSession sharedSession] uploadTaskWithRequest:_postRequest(recorder.server, "/data")
+                                                                              fromData:body
+                                                                     completionHandler:completionHandler];
+    ASSERT_TRUE([task isKindOfClass:[NSURLSessionUploadTask class]]);
+    _wait(task, done);
+
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(200, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_OBJCEQ([@"300000" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    ASSERT_NE(std::string::npos, recorder.head.find("Content-Length: 300000"));
+    ASSERT_EQ(0, memcmp([body bytes], recorder.body.data(), [body length]));
+    ASSERT_EQ(300000, [task countOfBytesSent]);
+}
+
+TEST(NSURLSessionUploadTask, UploadsFile) {
+    RecordingServer recorder;
+    NSData* body = _patternData(3 * 1024 * 1024 + 5);
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"NSURLSessionUploadFile.bin"];
+    ASSERT_TRUE([body writeToFile:path atomically:NO]);
+    auto removeFile = wil::ScopeExit([path]() { [[NSFileManager defaultManager] removeItemAtPath:path error:nil]; });
+
+    __block UploadResult result;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSessionTaskCompletionHandler completionHandler = ^(NSData* data, NSURLResponse* response, NSError* error) {
+        result.error = error;
+        dispatch_semaphore_signal(done);
+    };
+    NSURLSessionUploadTask* task = [[NSURLSession sharedSession] uploadTaskWithRequest:_postRequest(recorder.server, "/file")
+                                                                              fromFile:[NSURL fileURLWithPath:path]
+                                                                     completionHandler:completionHandler];
+    ASSERT_EQ([body length], [task countOfBytesExpectedToSend]);
+    _wait(task, done);
+
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(std::string::npos, recorder.head.find("Transfer-Encoding"));
+    ASSERT_EQ([body length], recorder.body.size());
+    ASSERT_EQ(0, memcmp([body bytes], recorder.body.data(), [body length]));
+}
+
+TEST(NSURLSessionUploadTask, FailsForMissingFiles) {
+    RecordingServer recorder;
+    NSURL* fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"NSURLSessionUploadMissing.bin"]];
+
+    __block UploadResult result;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSessionTaskCompletionHandler completionHandler = ^(NSData* data, NSURLResponse* response, NSError* error) {
+        result.error = error;
+        dispatch_semaphore_signal(done);
+    };
+    NSURLSessionUploadTask* task = [[NSURLSession sharedSession] uploadTaskWithRequest:_postRequest(recorder.server, "/missing")
+                                                                              fromFile:fileURL
+                                                                     completionHandler:completionHandler];
+    _wait(task, done);
+
+    ASSERT_OBJCEQ(NSURLErrorDomain, [result.error domain]);
+    ASSERT_EQ(NSURLErrorFileDoesNotExist, [result.error code]);
+    ASSERT_EQ(0, recorder.server.RequestsServed());
+}
+
+TEST(NSURLSessionUploadTask, StreamsChunkedBodies) {
+    RecordingServer recorder;
+    NSData* body = _patternData(500000);
+
+    StrongId<NSURLSessionUploadTestDelegate> delegate;
+    delegate.attach([NSURLSessionUploadTestDelegate new]);
+    [delegate setBodyStream:[NSInputStream inputStreamWithData:body]];
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:delegate
+                                                     delegateQueue:nil];
+
+    NSURLSessionUploadTask* task = [session uploadTaskWithStreamedRequest:_postRequest(recorder.server, "/streamed")];
+    _wait(task, [delegate completed]);
+
+    ASSERT_OBJCEQ(nil, [delegate error]);
+    ASSERT_NE(std::string::npos, recorder.head.find("Transfer-Encoding: chunked"));
+    ASSERT_EQ([body length], recorder.body.size());
+    ASSERT_EQ(0, memcmp([body bytes], recorder.body.data(), [body length]));
+    ASSERT_EQ(NSURLSessionTransferSizeUnknown, [delegate expectedToSend]);
+}
+
+TEST(NSURLSessionUploadTask, WaitsForBodyStreamWhenResumedAgain) {
+    RecordingServer recorder;
+    NSData* body = _patternData(1000);
+
+    StrongId<NSURLSessionUploadTestDelegate> delegate;
+    delegate.attach([NSURLSessionUploadTestDelegate new]);
+    [delegate setDefersBodyStream:YES];
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:delegate
+                                                     delegateQueue:nil];
+
+    NSURLSessionUploadTask* task = [session uploadTaskWithStreamedRequest:_postRequest(recorder.server, "/resumed")];
+    [task resume];
+    ASSERT_EQ(0, dispatch_semaphore_wait([delegate bodyStreamRequested], dispatch_time(DISPATCH_TIME_NOW, c_uploadTimeoutInNanoseconds)));
+
+    // Resuming again before the stream arrives neither asks for another stream nor starts the upload without one.
+    [task resume];
+    [task resume];
+    ASSERT_EQ(NSURLSessionTaskStateSuspended, [task state]);
+    ASSERT_EQ(1, [delegate bodyStreamRequests]);
+
+    [delegate bodyStreamHandler]([NSInputStream inputStreamWithData:body]);
+    ASSERT_EQ(0, dispatch_semaphore_wait([delegate completed], dispatch_time(DISPATCH_TIME_NOW, c_uploadTimeoutInNanoseconds)));
+
+    ASSERT_OBJCEQ(nil, [delegate error]);
+    ASSERT_EQ(1, [delegate bodyStreamRequests]);
+    ASSERT_EQ(1, recorder.server.RequestsServed());
+    ASSERT_EQ([body length], recorder.body.size());
+    ASSERT_EQ(0, memcmp([body bytes], recorder.body.data(), [body length]));
+}
+
+TEST(NSURLSessionUploadTask, PrefersRegisteredProtocols) {
+    RecordingServer recorder;
+    ASSERT_TRUE([NSURLProtocol registerClass:[NSURLSessionUploadTestProtocol class]]);
+    auto unregister = wil::ScopeExit([]() { [NSURLProtocol unregisterClass:[NSURLSessionUploadTestProtocol class]]; });
+
+    NSMutableURLRequest* request = _postRequest(recorder.server, "/registered");
+    [request setValue:@"1" forHTTPHeaderField:@"X-Upload-Test-Protocol"];
+
+    __block UploadResult result;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    NSURLSessionTaskCompletionHandler completionHandler = ^(NSData* data, NSURLResponse* response, NSError* error) {
+        result.data = data;
+        result.response = response;
+        result.error = error;
+        dispatch_semaphore_signal(done);
+    };
+    NSURLSessionUploadTask* task =
+        [[NSURLSession sharedSession] uploadTaskWithRequest:request fromData:_patternData(100) completionHandler:completionHandler];
+    _wait(task, done);
+
+    ASSERT_OBJCEQ(nil, result.error.get());
+    ASSERT_EQ(299, [static_cast<NSHTTPURLResponse*>(result.response.get()) statusCode]);
+    ASSERT_OBJCEQ([@"intercepted" dataUsingEncoding:NSUTF8StringEncoding], result.data.get());
+    ASSERT_EQ(0, recorder.server.RequestsServed());
+}
+
+TEST(NSURLSessionUploadTask, FailsWithoutBodyStream) {
+    RecordingServer recorder;
+
+    StrongId<NSURLSessionUploadTestDelegate> delegate;
+    delegate.attach([NSURLSessionUploadTestDelegate new]);
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:delegate
+                                                     delegateQueue:nil];
+
+    _wait([session uploadTaskWithStreamedRequest:_postRequest(recorder.server, "/no-stream")], [delegate completed]);
+    ASSERT_EQ(NSURLErrorRequestBodyStreamExhausted, [[delegate error] code]);
+}
+
+TEST(NSURLSessionUploadTask, ReportsProgress) {
+    RecordingServer recorder;
+    NSData* body = _patternData(1024 * 1024);
+
+    StrongId<NSURLSessionUploadTestDelegate> delegate;
+    delegate.attach([NSURLSessionUploadTestDelegate new]);
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]
+                                                          delegate:delegate
+                                                     delegateQueue:nil];
+
+    NSURLSessionUploadTask* task = [session uploadTaskWithRequest:_postRequest(recorder.server, "/progress") fromData:body];
+    _wait(task, [delegate completed]);
+
+    ASSERT_OBJCEQ(nil, [delegate error]);
+    ASSERT_OBJCEQ([@"1048576" dataUsingEncoding:NSUTF8StringEncoding], [delegate receivedData]);
+
+    // The body goes out a piece at a time, and each piece is reported once.
+    std::vector<int64_t> totals = [delegate totalsSent];
+    ASSERT_LT(1, totals.size());
+    ASSERT_TRUE(std::is_sorted(totals.begin(), totals.end()));
+    ASSERT_EQ([body length], totals.back());
+    ASSERT_EQ([body length], [delegate expectedToSend]);
+}
+
+TEST(NSURLSession, ListsUploadTasksApart) {
+    RecordingServer recorder;
+    NSURLSession* session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]];
+    [session uploadTaskWithRequest:_postRequest(recorder.server, "/listed") fromData:_patternData(10)];
+
+    __block NSUInteger dataTasks = 0;
+    __block NSUInteger uploadTasks = 0;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    [session getTasksWithCompletionHandler:^(NSArray* data, NSArray* uploads, NSArray* downloads) {
+        dataTasks = [data count];
+        uploadTasks = [uploads count];
+        dispatch_semaphore_signal(done);
+    }];
+    ASSERT_EQ(0, dispatch_semaphore_wait(done, dispatch_time(DISPATCH_TIME_NOW, c_uploadTimeoutInNanoseconds)));
+    ASSERT_EQ(0, dataTasks);
+    ASSERT_EQ(1, uploadTasks);
+}
@@ -0,0 +1,249 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+
+#import <QuartzCore/QuartzCore.h>
+#import <CoreGraphics/CGBitmapContext.h>
+#import "CAEmitterLayerInternal.h"
+
+#include <math.h>
+
+static const float c_frame = 1.0f / 60.0f;
+
+TEST(CAEmitterLayer, BirthRateAndLifetimeBoundPopulation) {
+    CAParticleSystem system(1);
+    CAParticleCellParameters cell;
+    cell.birthRate = 120.0f;
+    cell.lifetime = 0.5f;
+    system.AddCell(cell);
+
+    // 60 births per half second, none surviving longer than that.
+    for (size_t frame = 0; frame < 120; ++frame) {
+        system.Step(c_frame);
+    }
+    EXPECT_NEAR(60.0, static_cast<double>(system.GetParticleCount()), 2.0);
+
+    const CAParticleBuffer& particles = system.GetParticles(0);
+    for (size_t i = 0; i < particles.count; ++i) {
+        EXPECT_LT(particles.age[i], particles.lifetime[i]);
+    }
+
+    // Steady state reuses the slots freed by dead particles.
+    size_t capacity = particles.GetCapacity();
+    for (size_t frame = 0; frame < 120; ++frame) {
+        system.Step(c_frame);
+    }
+    EXPECT_EQ(capacity, particles.GetCapacity());
+}
+
+TEST(CAEmitterLayer, BirthRateExtremes) {
+    CAParticleSystem system(1);
+    CAParticleCellParameters cell;
+    cell.birthRate = 60.0f;
+    cell.lifetime = 100.0f;
+    system.AddCell(cell);
+
+    // A negative rate emits nothing, and owes nothing once the rate turns positive again.
+    CAParticleEmitterParameters emitter;
+    emitter.birthRate = -1.0f;
+    system.SetEmitter(emitter);
+    for (size_t frame = 0; frame < 60; ++frame) {
+        system.Step(c_frame);
+    }
+    EXPECT_EQ(0u, system.GetParticleCount());
+
+    emitter.birthRate = 1.0f;
+    system.SetEmitter(emitter);
+    for (size_t frame = 0; frame < 60; ++frame) {
+        system.Step(c_frame);
+    }
+    EXPECT_NEAR(60.0, static_cast<double>(system.GetParticleCount()), 1.0);
+
+    // A rate too large to count in a size_t fills the cell, without carrying the excess over.
+    const size_t maxParticles = CAParticleSystem::c_maxParticlesPerCell;
+    emitter.birthRate = 1e30f;
+    system.SetEmitter(emitter);
+    system.Step(c_frame);
+    EXPECT_EQ(maxParticles, system.GetParticleCount());
+
+    emitter.birthRate = 0.0f;
+    system.SetEmitter(emitter);
+    system.Step(c_frame);
+    EXPECT_EQ(maxParticles, system.GetParticleCount());
+}
+
+TEST(CAEmitterLayer, IntegrationMatchesClosedForm) {
+    CAParticleSystem system;
+    CAParticleEmitterParameters emitter;
+    emitter.positionX = 10.0f;
+    emitter.positionY = 20.0f;
+    system.SetEmitter(emitter);
+
+    CAParticleCellParameters cell;
+    cell.lifetime = 10.0f;
+    cell.velocity = 30.0f;
+    cell.emissionLongitude = static_cast<float>(M_PI) / 2.0f;
+    cell.xAcceleration = 4.0f;
+    cell.spin = 2.0f;
+    cell.scaleSpeed = 0.5f;
+    cell.colorSpeed[3] = -0.25f;
+    system.AddCell(cell);
+
+    // More than one SIMD width, so the vector loop and the scalar tail are both covered.
+    system.Emit(0, 7);
+    const size_t steps = 60;
+    for (size_t frame = 0; frame < steps; ++frame) {
+        system.Step(c_frame);
+    }
+
+    // Semi-implicit Euler: x = x0 + a * dt^2 * n(n+1)/2.
+    float expectedX = 10.0f + 4.0f * c_frame * c_frame * steps * (steps + 1) / 2.0f;
+    const CAParticleBuffer& particles = system.GetParticles(0);
+    ASSERT_EQ(7u, particles.count);
+    for (size_t i = 0; i < particles.count; ++i) {
+        EXPECT_NEAR(expectedX, particles.x[i], 1e-3f);
+        EXPECT_NEAR(20.0f + 30.0f, particles.y[i], 1e-3f);
+        EXPECT_NEAR(2.0f, particles.rotation[i], 1e-4f);
+        EXPECT_NEAR(1.5f, particles.scale[i], 1e-4f);
+        EXPECT_NEAR(0.75f, particles.alpha[i], 1e-4f);
+        EXPECT_NEAR(1.0f, particles.age[i], 1e-4f);
+    }
+}
+
+TEST(CAEmitterLayer, EmitterShapes) {
+    CAParticleCellParameters cell;
+    cell.lifetime = 1.0f;
+
+    struct ShapeCase {
+        CAEmitterShape shape;
+        CAEmitterMode mode;
+    };
+    const ShapeCase cases[] = {
+        { CAEmitterShape::Line, CAEmitterMode::Surface },    { CAEmitterShape::Rectangle, CAEmitterMode::Volume },
+        { CAEmitterShape::Rectangle, CAEmitterMode::Outline }, { CAEmitterShape::Circle, CAEmitterMode::Surface },
+        { CAEmitterShape::Circle, CAEmitterMode::Outline },  { CAEmitterShape::Sphere, CAEmitterMode::Volume },
+    };
+
+    for (const ShapeCase& shapeCase : cases) {
+        CAParticleSystem system(7);
+        CAParticleEmitterParameters emitter;
+        emitter.shape = shapeCase.shape;
+        emitter.mode = shapeCase.mode;
+        emitter.width = 40.0f;
+        emitter.height = 20.0f;
+        system.SetEmitter(emitter);
+        system.AddCell(cell);
+        system.Emit(0, 500);
+
+        const CAParticleBuffer& particles = system.GetParticles(0);
+        for (size_t i = 0; i < particles.count; ++i) {
+            float x = particles.x[i];
+            float y = particles.y[i];
+            switch (shapeCase.shape) {
+                case CAEmitterShape::Line:
+                    EXPECT_LE(fabsf(x), 20.0f);
+                    EXPECT_EQ(0.0f, y);
+                    break;
+                case CAEmitterShape::Rectangle:
+                    EXPECT_LE(fabsf(x), 20.0f);
+                    EXPECT_LE(fabsf(y), 10.0f);
+                    if (shapeCase.mode == CAEmitterMode::Outline) {
+                        EXPECT_TRUE(fabsf(fabsf(x) - 20.0f) < 1e-3f || fabsf(fabsf(y) - 10.0f) < 1e-3f);
+                    }
+                    break;
+                case CAEmitterShape::Circle:
+                case CAEmitterShape::Sphere: {
+                    // The radius is emitterSize.width.
+                    float radius = sqrtf(x * x + y * y);
+                    EXPECT_LE(radius, 40.0f + 1e-3f);
+                    if (shapeCase.mode == CAEmitterMode::Outline) {
+                        EXPECT_NEAR(40.0f, radius, 1e-3f);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+TEST(CAEmitterLayer, SubCellsEmitFromParentParticles) {
+    CAParticleSystem system(3);
+    CAParticleEmitterParameters emitter;
+    emitter.positionX = 100.0f;
+    system.SetEmitter(emitter);
+
+    CAParticleCellParameters parent;
+    parent.lifetime = 5.0f;
+    size_t parentIndex = system.AddCell(parent);
+
+    CAParticleCellParameters child;
+    child.birthRate = 30.0f;
+    child.lifetime = 5.0f;
+    child.parentCell = static_cast<int32_t>(parentIndex);
+    system.AddCell(child);
+
+    // No parents, no children.
+    system.Step(1.0f);
+    EXPECT_EQ(0u, system.GetParticles(1).count);
+
+    system.Emit(parentIndex, 2);
+    system.Step(1.0f);
+    EXPECT_NEAR(60.0, static_cast<double>(system.GetParticles(1).count), 1.0);
+
+    const CAParticleBuffer& children = system.GetParticles(1);
+    for (size_t i = 0; i < children.count; ++i) {
+        EXPECT_EQ(100.0f, children.x[i]);
+    }
+}
+
+TEST(CAEmitterLayer, ParticleBoundsCoverDrawnSprites) {
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(nullptr, 8, 6, 8, 8 * 4, colorSpace, kCGImageAlphaPremultipliedFirst);
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    CGColorSpaceRelease(colorSpace);
+
+    CAEmitterCell* cell = [CAEmitterCell emitterCell];
+    cell.birthRate = 100.0f;
+    cell.lifetime = 10.0f;
+    cell.velocity = 40.0f;
+    cell.emissionRange = 2.0f * M_PI;
+    cell.scale = 2.0f;
+
+    CAEmitterLayer* layer = [CAEmitterLayer layer];
+    layer.emitterPosition = CGPointMake(50.0f, 60.0f);
+    layer.emitterCells = @[ cell ];
+    [layer _advanceParticles:0.5];
+
+    // Without contents nothing is drawn.
+    ASSERT_LT(0u, [layer _particleCount]);
+    EXPECT_TRUE(CGRectIsNull([layer _particleBounds]));
+
+    cell.contents = (id)image;
+    layer.emitterCells = @[ cell ];
+    [layer _advanceParticles:0.5];
+
+    // Particles travel at most 20 points from the emitter, and each draws within its scaled half diagonal of 10 points.
+    CGRect bounds = [layer _particleBounds];
+    ASSERT_FALSE(CGRectIsNull(bounds));
+    EXPECT_TRUE(CGRectContainsPoint(bounds, layer.emitterPosition));
+    EXPECT_TRUE(CGRectContainsRect(CGRectMake(50.0f - 32.0f, 60.0f - 32.0f, 64.0f, 64.0f), bounds));
+
+    CGImageRelease(image);
+}
@@ -0,0 +1,409 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+
+#import <QuartzCore/QuartzCore.h>
+#import <CoreGraphics/CGPath.h>
+#import "CAKeyframeAnimationInternal.h"
+#import "CAAnimationInternal.h"
+#import "../UIKit/NullCompositor.h"
+
+#include <math.h>
+#include <memory>
+#include <vector>
+
+static const float c_tolerance = 1e-4f;
+
+static float _evaluate(const CAKeyframeTrack& track, float progress) {
+    float result[CAKeyframeTrack::c_maxComponents + 1];
+    track.Evaluate(progress, result);
+    return result[0];
+}
+
+TEST(CAKeyframeAnimation, LinearValues) {
+    const float values[] = { 0.0f, 10.0f, 30.0f };
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, CAKeyframeTrack::Parameters()));
+    EXPECT_EQ(2u, track.GetSegmentCount());
+
+    EXPECT_NEAR(0.0f, _evaluate(track, 0.0f), c_tolerance);
+    EXPECT_NEAR(5.0f, _evaluate(track, 0.25f), c_tolerance);
+    EXPECT_NEAR(10.0f, _evaluate(track, 0.5f), c_tolerance);
+    EXPECT_NEAR(20.0f, _evaluate(track, 0.75f), c_tolerance);
+    EXPECT_NEAR(30.0f, _evaluate(track, 1.0f), c_tolerance);
+
+    // Progress is clamped.
+    EXPECT_NEAR(0.0f, _evaluate(track, -1.0f), c_tolerance);
+    EXPECT_NEAR(30.0f, _evaluate(track, 2.0f), c_tolerance);
+}
+
+TEST(CAKeyframeAnimation, KeyTimesAndTimingCurves) {
+    const float values[] = { 0.0f, 10.0f, 30.0f };
+    const float keyTimes[] = { 0.0f, 0.8f, 1.0f };
+    CATimingCurve easeIn(0.42f, 0.0f, 1.0f, 1.0f);
+    const CATimingCurve* curves[] = { &easeIn };
+
+    CAKeyframeTrack::Parameters parameters;
+    parameters.keyTimes = keyTimes;
+    parameters.keyTimeCount = 3;
+    parameters.timingCurves = curves;
+    parameters.timingCurveCount = 1;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, parameters));
+
+    EXPECT_NEAR(10.0f * easeIn.Evaluate(0.5f), _evaluate(track, 0.4f), c_tolerance);
+    EXPECT_NEAR(10.0f, _evaluate(track, 0.8f), c_tolerance);
+    EXPECT_NEAR(20.0f, _evaluate(track, 0.9f), c_tolerance);
+
+    // Mismatched key times fall back to uniform spacing.
+    parameters.keyTimeCount = 2;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, parameters));
+    EXPECT_NEAR(10.0f, _evaluate(track, 0.5f), c_tolerance);
+}
+
+TEST(CAKeyframeAnimation, DiscreteValues) {
+    const float values[] = { 0.0f, 10.0f, 30.0f };
+    CAKeyframeTrack::Parameters parameters;
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::Discrete;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, parameters));
+
+    EXPECT_EQ(0.0f, _evaluate(track, 0.0f));
+    EXPECT_EQ(0.0f, _evaluate(track, 0.3f));
+    EXPECT_EQ(10.0f, _evaluate(track, 0.34f));
+    EXPECT_EQ(30.0f, _evaluate(track, 0.7f));
+    EXPECT_EQ(30.0f, _evaluate(track, 1.0f));
+}
+
+TEST(CAKeyframeAnimation, PacedValuesMoveAtConstantSpeed) {
+    const float values[] = { 0.0f, 10.0f, 30.0f };
+    const float keyTimes[] = { 0.0f, 0.9f, 1.0f };
+    CAKeyframeTrack::Parameters parameters;
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::Paced;
+    parameters.keyTimes = keyTimes;
+    parameters.keyTimeCount = 3;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, parameters));
+
+    for (float progress = 0.0f; progress <= 1.0f; progress += 0.05f) {
+        EXPECT_NEAR(30.0f * progress, _evaluate(track, progress), 1e-3f);
+    }
+
+    // Curved segments are reparameterized by arc length, so cubic paced is nearly uniform as well.
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::CubicPaced;
+    ASSERT_TRUE(track.InitWithValues(values, 3, 1, parameters));
+    for (float progress = 0.0f; progress <= 1.0f; progress += 0.05f) {
+        EXPECT_NEAR(30.0f * progress, _evaluate(track, progress), 0.05f);
+    }
+}
+
+TEST(CAKeyframeAnimation, CubicValuesPassThroughKeys) {
+    const float values[] = { 0.0f, 0.0f, 10.0f, 5.0f, 20.0f, 0.0f, 30.0f, 5.0f };
+    CAKeyframeTrack::Parameters parameters;
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::Cubic;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithValues(values, 4, 2, parameters));
+    EXPECT_EQ(2u, track.GetComponentCount());
+
+    float result[2];
+    for (size_t key = 0; key < 4; ++key) {
+        track.Evaluate(key / 3.0f, result);
+        EXPECT_NEAR(values[key * 2], result[0], c_tolerance);
+        EXPECT_NEAR(values[key * 2 + 1], result[1], c_tolerance);
+    }
+
+    // Default (Catmull-Rom) tangents at the middle keys are parallel to the x axis, so the middle segment is symmetric.
+    track.Evaluate(0.5f, result);
+    EXPECT_NEAR(15.0f, result[0], c_tolerance);
+    EXPECT_NEAR(2.5f, result[1], c_tolerance);
+
+    // Full tension gives zero tangents at every key, so x barely moves right around a key.
+    const float tension[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    parameters.tensionValues = tension;
+    ASSERT_TRUE(track.InitWithValues(values, 4, 2, parameters));
+    float before[2];
+    float after[2];
+    track.Evaluate(1.0f / 3.0f - 1e-3f, before);
+    track.Evaluate(1.0f / 3.0f + 1e-3f, after);
+    EXPECT_NEAR(10.0f, before[0], 1e-3f);
+    EXPECT_NEAR(10.0f, after[0], 1e-3f);
+}
+
+TEST(CAKeyframeAnimation, PathWithRotation) {
+    CGMutablePathRef path = CGPathCreateMutable();
+    CGPathMoveToPoint(path, nullptr, 0, 0);
+    CGPathAddLineToPoint(path, nullptr, 10, 0);
+    CGPathAddLineToPoint(path, nullptr, 10, 10);
+
+    CAKeyframeTrack::Parameters parameters;
+    parameters.rotationMode = CAKeyframeTrack::RotationMode::Auto;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithPath(path, parameters));
+    EXPECT_EQ(2u, track.GetSegmentCount());
+    EXPECT_EQ(3u, track.GetComponentCount());
+
+    float result[3];
+    track.Evaluate(0.25f, result);
+    EXPECT_NEAR(5.0f, result[0], c_tolerance);
+    EXPECT_NEAR(0.0f, result[1], c_tolerance);
+    EXPECT_NEAR(0.0f, result[2], c_tolerance);
+
+    track.Evaluate(0.75f, result);
+    EXPECT_NEAR(10.0f, result[0], c_tolerance);
+    EXPECT_NEAR(5.0f, result[1], c_tolerance);
+    EXPECT_NEAR(M_PI / 2, result[2], c_tolerance);
+
+    parameters.rotationMode = CAKeyframeTrack::RotationMode::AutoReverse;
+    ASSERT_TRUE(track.InitWithPath(path, parameters));
+    track.Evaluate(0.25f, result);
+    EXPECT_NEAR(M_PI, result[2], c_tolerance);
+
+    CGPathRelease(path);
+}
+
+TEST(CAKeyframeAnimation, PacedPathFollowsCurve) {
+    // A quarter circle approximated by one cubic, followed by a line of about the same length.
+    const float k = 0.5522847f * 10.0f;
+    CGMutablePathRef path = CGPathCreateMutable();
+    CGPathMoveToPoint(path, nullptr, 10, 0);
+    CGPathAddCurveToPoint(path, nullptr, 10, k, k, 10, 0, 10);
+    CGPathAddLineToPoint(path, nullptr, -15.708f, 10);
+
+    CAKeyframeTrack::Parameters parameters;
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::Paced;
+
+    CAKeyframeTrack track;
+    ASSERT_TRUE(track.InitWithPath(path, parameters));
+
+    float result[2];
+    track.Evaluate(0.25f, result);
+    EXPECT_NEAR(10.0f * cosf(M_PI / 4), result[0], 0.05f);
+    EXPECT_NEAR(10.0f * sinf(M_PI / 4), result[1], 0.05f);
+
+    track.Evaluate(0.5f, result);
+    EXPECT_NEAR(0.0f, result[0], 0.05f);
+    EXPECT_NEAR(10.0f, result[1], 0.05f);
+
+    CGPathRelease(path);
+}
+
+TEST(CAKeyframeAnimation, ValueForProgress) {
+    CAKeyframeAnimation* animation = [CAKeyframeAnimation animationWithKeyPath:@"position"];
+    animation.values = @[
+        [NSValue valueWithCGPoint:CGPointMake(0, 0)],
+        [NSValue valueWithCGPoint:CGPointMake(100, 0)],
+        [NSValue valueWithCGPoint:CGPointMake(100, 50)]
+    ];
+
+    CGPoint point = [[animation _valueForProgress:0.75f] CGPointValue];
+    EXPECT_NEAR(100.0f, point.x, c_tolerance);
+    EXPECT_NEAR(25.0f, point.y, c_tolerance);
+
+    animation.calculationMode = kCAAnimationDiscrete;
+    point = [[animation _valueForProgress:0.5f] CGPointValue];
+    EXPECT_NEAR(100.0f, point.x, c_tolerance);
+    EXPECT_NEAR(0.0f, point.y, c_tolerance);
+
+    CAKeyframeAnimation* copy = [[animation copy] autorelease];
+    EXPECT_OBJCEQ(kCAAnimationDiscrete, copy.calculationMode);
+    EXPECT_EQ(3u, copy.values.count);
+
+    // Mixed value types can't be interpolated.
+    animation.values = @[ @1.0f, [NSValue valueWithCGPoint:CGPointMake(0, 0)] ];
+    EXPECT_EQ(nil, [animation _valueForProgress:0.5f]);
+    EXPECT_EQ(0u, _CAKeyframeAnimationGetComponentCount(animation));
+}
+
+TEST(CAKeyframeAnimation, BatchMatchesScalar) {
+    std::vector<StrongId<CAKeyframeAnimation>> animations;
+    NSString* const modes[] = { kCAAnimationLinear, kCAAnimationDiscrete, kCAAnimationPaced, kCAAnimationCubic, kCAAnimationCubicPaced };
+    for (size_t i = 0; i < 5; ++i) {
+        CAKeyframeAnimation* animation = [CAKeyframeAnimation animationWithKeyPath:@"opacity"];
+        animation.values = @[ @0.0f, @(0.3f + i * 0.1f), @0.2f, @1.0f ];
+        animation.calculationMode = modes[i];
+        animations.emplace_back(animation);
+    }
+
+    const size_t count = 601;
+    std::vector<CAKeyframeAnimation*> batch(count);
+    std::vector<float> progress(count);
+    std::vector<float> results(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch[i] = animations[i % animations.size()];
+        progress[i] = static_cast<float>(i) / (count - 1);
+    }
+
+    _CAKeyframeAnimationEvaluateBatch(batch.data(), progress.data(), results.data(), 1, count);
+
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_NEAR([[batch[i] _valueForProgress:progress[i]] floatValue], results[i], 1e-6f);
+    }
+}
+
+TEST(CAKeyframeAnimation, TrackBatchMatchesScalar) {
+    // Wide values with per-segment timing, a path with rotation and a null track, interleaved.
+    const float values[] = { 0, 1, 2, 3, 4, 10, 20, 30, 40, 50, -5, 0, 5, 10, 15, 1, 1, 1, 1, 1 };
+    CATimingCurve easeIn(0.42f, 0.0f, 1.0f, 1.0f);
+    CATimingCurve easeOut(0.0f, 0.0f, 0.58f, 1.0f);
+    const CATimingCurve* curves[] = { &easeIn, nullptr, &easeOut };
+
+    CAKeyframeTrack::Parameters parameters;
+    parameters.timingCurves = curves;
+    parameters.timingCurveCount = 3;
+    CAKeyframeTrack wide;
+    ASSERT_TRUE(wide.InitWithValues(values, 4, 5, parameters));
+
+    parameters.calculationMode = CAKeyframeTrack::CalculationMode::CubicPaced;
+    CAKeyframeTrack paced;
+    ASSERT_TRUE(paced.InitWithValues(values, 5, 4, parameters));
+
+    CGMutablePathRef path = CGPathCreateMutable();
+    CGPathMoveToPoint(path, nullptr, 0, 0);
+    CGPathAddQuadCurveToPoint(path, nullptr, 10, 0, 10, 10);
+    CGPathAddLineToPoint(path, nullptr, 0, 10);
+    CAKeyframeTrack::Parameters pathParameters;
+    pathParameters.rotationMode = CAKeyframeTrack::RotationMode::Auto;
+    pathParameters.calculationMode = CAKeyframeTrack::CalculationMode::Paced;
+    CAKeyframeTrack pathTrack;
+    ASSERT_TRUE(pathTrack.InitWithPath(path, pathParameters));
+    CGPathRelease(path);
+
+    const CAKeyframeTrack* const kinds[] = { &wide, &paced, &pathTrack, nullptr };
+    const size_t stride = CAKeyframeTrack::c_maxComponents + 1;
+    const size_t count = 1001;
+    std::vector<const CAKeyframeTrack*> tracks(count);
+    std::vector<float> progress(count);
+    std::vector<float> results(count * stride, -1.0f);
+    for (size_t i = 0; i < count; ++i) {
+        tracks[i] = kinds[i % 4];
+        progress[i] = static_cast<float>(i) / (count - 1) * 1.2f - 0.1f;
+    }
+
+    CAKeyframeTrackEvaluateBatch(tracks.data(), progress.data(), results.data(), stride, count);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!tracks[i]) {
+            EXPECT_EQ(-1.0f, results[i * stride]);
+            continue;
+        }
+
+        float expected[stride];
+        tracks[i]->Evaluate(progress[i], expected);
+        for (size_t component = 0; component < tracks[i]->GetComponentCount(); ++component) {
+            EXPECT_NEAR(expected[component], results[i * stride + component], 1e-5f);
+        }
+    }
+}
+
+// Records the keyframe animations it is asked to create, and installs itself as the compositor while it exists.
+class KeyframeRecordingCompositor : public NullCompositor {
+public:
+    struct Animation : public ILayerAnimation {
+        StrongId<NSString> propertyName;
+        StrongId<NSArray> values;
+        CAMediaTimingProperties* timingProperties;
+        std::vector<std::shared_ptr<ILayerAnimation>> companions;
+    };
+
+    KeyframeRecordingCompositor() : _previous(GetCACompositor()) {
+        SetCACompositor(this);
+    }
+
+    ~KeyframeRecordingCompositor() {
+        SetCACompositor(_previous);
+    }
+
+    std::shared_ptr<ILayerAnimation> CreateKeyframeAnimation(CAAnimation* animation,
+                                                             NSString* propertyName,
+                                                             NSArray* values,
+                                                             CAMediaTimingProperties* timingProperties) override {
+        auto created = std::make_shared<Animation>();
+        created->propertyName = propertyName;
+        created->values = values;
+        created->timingProperties = timingProperties;
+        animations.emplace_back(created);
+        return created;
+    }
+
+    void AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation,
+                                 const std::shared_ptr<ILayerAnimation>& companion) override {
+        static_cast<Animation*>(animation.get())->companions.emplace_back(companion);
+    }
+
+    std::vector<std::shared_ptr<Animation>> animations;
+
+private:
+    CACompositorInterface* _previous;
+};
+
+TEST(CAKeyframeAnimation, CompositorReceivesRotation) {
+    // A quarter circle, turning from heading along +x to heading along +y.
+    const float k = 0.5522847f * 10.0f;
+    CGMutablePathRef path = CGPathCreateMutable();
+    CGPathMoveToPoint(path, nullptr, 0, 0);
+    CGPathAddCurveToPoint(path, nullptr, k, 0, 10, 10 - k, 10, 10);
+
+    CAKeyframeAnimation* animation = [CAKeyframeAnimation animationWithKeyPath:@"position"];
+    animation.path = path;
+    CGPathRelease(path);
+
+    KeyframeRecordingCompositor compositor;
+    [animation _createAnimation:nil forKey:@"position"];
+
+    // Without a rotation mode only the position is animated.
+    ASSERT_EQ(1u, compositor.animations.size());
+    EXPECT_OBJCEQ(@"position", compositor.animations[0]->propertyName);
+    EXPECT_TRUE(compositor.animations[0]->companions.empty());
+
+    const float expectedAngles[] = { 0.0f, M_PI / 4, M_PI / 2 };
+    NSString* const modes[] = { kCAAnimationRotateAuto, kCAAnimationRotateAutoReverse };
+    for (size_t mode = 0; mode < 2; ++mode) {
+        compositor.animations.clear();
+        animation.rotationMode = modes[mode];
+        [animation _createAnimation:nil forKey:@"position"];
+
+        ASSERT_EQ(2u, compositor.animations.size());
+        const auto& position = compositor.animations[0];
+        const auto& rotation = compositor.animations[1];
+        EXPECT_OBJCEQ(@"position", position->propertyName);
+        EXPECT_OBJCEQ(@"transform.rotation.z", rotation->propertyName);
+        EXPECT_EQ(position->timingProperties, rotation->timingProperties);
+        ASSERT_EQ(1u, position->companions.size());
+        EXPECT_EQ(rotation, position->companions[0]);
+
+        NSArray* points = position->values;
+        NSArray* angles = rotation->values;
+        ASSERT_EQ(points.count, angles.count);
+        ASSERT_EQ(17u, angles.count);
+
+        CGPoint end = [points.lastObject CGPointValue];
+        EXPECT_NEAR(10.0f, end.x, c_tolerance);
+        EXPECT_NEAR(10.0f, end.y, c_tolerance);
+
+        // Samples are evenly spaced in time, so the first, middle and last are the start, midpoint and end of the arc.
+        const NSUInteger samples[] = { 0, 8, 16 };
+        float offset = (modes[mode] == kCAAnimationRotateAutoReverse) ? M_PI : 0.0f;
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_NEAR(expectedAngles[i] + offset, [angles[samples[i]] floatValue], 1e-3f);
+        }
+    }
+}
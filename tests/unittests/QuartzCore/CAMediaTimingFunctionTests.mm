@@ -0,0 +1,150 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+
+#import <QuartzCore/QuartzCore.h>
+#import "CAMediaTimingFunctionInternal.h"
+
+#include <vector>
+
+static const float c_curveTolerance = 1e-4f;
+static const size_t c_sampleCount = 10000;
+
+struct ControlPoints {
+    float c1x, c1y, c2x, c2y;
+};
+
+// The named curves plus a few common CSS curves, including one that overshoots in y, and curves whose x slope reaches
+// zero: at an end point, at a steep end point and, for (1, 0, 0, 1), at an inflection in the middle.
+static const ControlPoints c_testCurves[] = {
+    { 0.0f, 0.0f, 1.0f, 1.0f },       { 0.5f, 0.0f, 1.0f, 1.0f },   { 0.0f, 0.0f, 0.5f, 1.0f },
+    { 0.5f, 0.0f, 0.5f, 1.0f },       { 0.25f, 0.1f, 0.25f, 1.0f }, { 0.42f, 0.0f, 0.58f, 1.0f },
+    { 0.68f, -0.55f, 0.265f, 1.55f }, { 0.1f, 0.9f, 0.2f, 1.0f },   { 0.9f, 0.0f, 1.0f, 1.0f },
+    { 0.0f, 0.0f, 0.0f, 1.0f },       { 1.0f, 0.0f, 0.0f, 1.0f },   { 1.0f, 0.0f, 1.0f, 1.0f },
+};
+
+static long double _bezierComponent(long double p1, long double p2, long double t) {
+    long double mt = 1.0L - t;
+    return 3.0L * p1 * mt * mt * t + 3.0L * p2 * mt * t * t + t * t * t;
+}
+
+// Reference solver: bisects x(t) == x to full long double precision.
+static double _referenceEvaluate(const ControlPoints& curve, double x) {
+    long double lo = 0.0L;
+    long double hi = 1.0L;
+    for (int i = 0; i < 128; ++i) {
+        long double mid = (lo + hi) / 2.0L;
+        if (_bezierComponent(curve.c1x, curve.c2x, mid) < x) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return static_cast<double>(_bezierComponent(curve.c1y, curve.c2y, (lo + hi) / 2.0L));
+}
+
+TEST(CAMediaTimingFunction, EvaluateMatchesReferenceSolver) {
+    for (const ControlPoints& points : c_testCurves) {
+        CATimingCurve curve(points.c1x, points.c1y, points.c2x, points.c2y);
+        for (size_t i = 0; i <= c_sampleCount; ++i) {
+            float x = static_cast<float>(i) / c_sampleCount;
+            ASSERT_NEAR_MSG(_referenceEvaluate(points, x),
+                            curve.Evaluate(x),
+                            c_curveTolerance,
+                            "Curve (%f, %f, %f, %f) diverges at x = %f",
+                            points.c1x,
+                            points.c1y,
+                            points.c2x,
+                            points.c2y,
+                            x);
+        }
+    }
+}
+
+TEST(CAMediaTimingFunction, CurvesSharingNamedTables) {
+    // Curves with a named function's x control points share its table, whatever their y control points.
+    const ControlPoints curves[] = {
+        { 0.5f, 0.3f, 1.0f, 0.8f }, { 0.0f, 0.5f, 0.5f, 0.5f }, { 0.25f, 0.9f, 0.25f, 0.1f }, { 0.5f, -0.5f, 0.5f, 1.5f },
+    };
+
+    for (const ControlPoints& points : curves) {
+        CATimingCurve curve(points.c1x, points.c1y, points.c2x, points.c2y);
+        CATimingCurve copy;
+        copy = curve;
+        for (size_t i = 0; i <= 100; ++i) {
+            float x = static_cast<float>(i) / 100;
+            EXPECT_NEAR(_referenceEvaluate(points, x), curve.Evaluate(x), c_curveTolerance);
+            EXPECT_EQ(curve.Evaluate(x), copy.Evaluate(x));
+        }
+    }
+
+    CAMediaTimingFunction* named = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionDefault];
+    CAMediaTimingFunction* custom = [CAMediaTimingFunction functionWithControlPoints:0.25f:0.1f:0.25f:1.0f];
+    for (size_t i = 0; i <= 100; ++i) {
+        float x = static_cast<float>(i) / 100;
+        EXPECT_EQ(applyMediaTimingFunction(custom, x), applyMediaTimingFunction(named, x));
+    }
+}
+
+TEST(CAMediaTimingFunction, EvaluateEndpointsAndClamping) {
+    CATimingCurve curve(0.42f, 0.0f, 0.58f, 1.0f);
+    EXPECT_EQ(0.0f, curve.Evaluate(0.0f));
+    EXPECT_NEAR(1.0f, curve.Evaluate(1.0f), 1e-6f);
+    EXPECT_EQ(curve.Evaluate(0.0f), curve.Evaluate(-0.5f));
+    EXPECT_EQ(curve.Evaluate(1.0f), curve.Evaluate(1.5f));
+
+    CATimingCurve linear;
+    EXPECT_TRUE(linear.IsLinear());
+    EXPECT_EQ(0.3f, linear.Evaluate(0.3f));
+}
+
+TEST(CAMediaTimingFunction, BatchMatchesScalar) {
+    std::vector<CATimingCurve> curves;
+    for (const ControlPoints& points : c_testCurves) {
+        curves.emplace_back(points.c1x, points.c1y, points.c2x, points.c2y);
+    }
+
+    // Use an odd count so both the vector and the scalar tail are exercised, and mix in linear (nullptr) entries.
+    const size_t count = 1003;
+    std::vector<const CATimingCurve*> batchCurves(count);
+    std::vector<float> progress(count);
+    std::vector<float> results(count);
+    for (size_t i = 0; i < count; ++i) {
+        batchCurves[i] = (i % 7 == 0) ? nullptr : &curves[i % curves.size()];
+        progress[i] = static_cast<float>((i * 37) % count) / (count - 1);
+    }
+
+    CATimingCurveEvaluateBatch(batchCurves.data(), progress.data(), results.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        float expected = batchCurves[i] ? batchCurves[i]->Evaluate(progress[i]) : progress[i];
+        EXPECT_NEAR(expected, results[i], 1e-6f);
+    }
+}
+
+TEST(CAMediaTimingFunction, NamedFunctions) {
+    CAMediaTimingFunction* easeInOut = [CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionEaseInEaseOut];
+    ASSERT_NE(nil, easeInOut);
+
+    // Ease-in-ease-out is symmetric about its midpoint.
+    EXPECT_NEAR(0.5f, applyMediaTimingFunction(easeInOut, 0.5f), 1e-5f);
+    EXPECT_NEAR(1.0f - applyMediaTimingFunction(easeInOut, 0.2f), applyMediaTimingFunction(easeInOut, 0.8f), 1e-5f);
+
+    EXPECT_EQ(0.25f, applyMediaTimingFunction(nil, 0.25f));
+    EXPECT_EQ(0.25f, applyMediaTimingFunction([CAMediaTimingFunction functionWithName:kCAMediaTimingFunctionLinear], 0.25f));
+}
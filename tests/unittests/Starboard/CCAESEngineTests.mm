@@ -0,0 +1,396 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#include "CCAESEngine.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static std::vector<uint8_t> _bytes(const char* hex) {
+    std::vector<uint8_t> result;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        unsigned int byte;
+        sscanf(hex + i, "%2x", &byte);
+        result.push_back(static_cast<uint8_t>(byte));
+    }
+    return result;
+}
+
+static std::string _hex(const uint8_t* bytes, size_t length) {
+    std::string result;
+    char digits[3];
+    for (size_t i = 0; i < length; ++i) {
+        sprintf_s(digits, "%02x", bytes[i]);
+        result += digits;
+    }
+    return result;
+}
+
+static std::string _hex(const std::vector<uint8_t>& bytes) {
+    return _hex(bytes.data(), bytes.size());
+}
+
+// Every subset of kernels worth testing on this machine: portable only, each available implementation alone, and all.
+static std::vector<uint32_t> _implementationSets() {
+    uint32_t available = CCAESGetAvailableImplementations();
+    std::vector<uint32_t> sets = { CCAESImplementationPortable };
+    for (uint32_t bit = 1; bit != 0 && bit <= available; bit <<= 1) {
+        if (available & bit) {
+            sets.push_back(bit);
+        }
+    }
+    sets.push_back(available);
+    return sets;
+}
+
+class AESImplementations {
+public:
+    ~AESImplementations() {
+        CCAESSetEnabledImplementations(UINT32_MAX);
+    }
+};
+
+struct BlockVector {
+    const char* key;
+    const char* plaintext;
+    const char* ciphertext;
+};
+
+// FIPS 197 appendix C.
+static const BlockVector c_blockVectors[] = {
+    { "000102030405060708090a0b0c0d0e0f", "00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a" },
+    { "000102030405060708090a0b0c0d0e0f1011121314151617", "00112233445566778899aabbccddeeff", "dda97ca4864cdfe06eaf70a0ec0d7191" },
+    { "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+      "00112233445566778899aabbccddeeff",
+      "8ea2b7ca516745bfeafc49904b496089" },
+};
+
+TEST(CCAESEngine, BlockKnownAnswers) {
+    AESImplementations restore;
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCAESSetEnabledImplementations(implementations);
+
+        for (const BlockVector& vector : c_blockVectors) {
+            SCOPED_TRACE(testing::Message() << "key " << vector.key << ", implementations " << implementations);
+            std::vector<uint8_t> key = _bytes(vector.key);
+            std::vector<uint8_t> plaintext = _bytes(vector.plaintext);
+
+            CCAESKey aesKey;
+            ASSERT_TRUE(aesKey.Init(key.data(), key.size()));
+
+            std::vector<uint8_t> block(CCAESKey::c_blockSize);
+            aesKey.EncryptBlocks(plaintext.data(), block.data(), 1);
+            EXPECT_EQ(vector.ciphertext, _hex(block));
+
+            aesKey.DecryptBlocks(block.data(), block.data(), 1);
+            EXPECT_EQ(vector.plaintext, _hex(block));
+        }
+    }
+}
+
+TEST(CCAESEngine, InvalidKeyLength) {
+    CCAESKey aesKey;
+    uint8_t key[33] = {};
+    EXPECT_FALSE(aesKey.Init(key, 15));
+    EXPECT_FALSE(aesKey.Init(key, 33));
+    EXPECT_FALSE(CCAESKey::IsValidKeyLength(0));
+    EXPECT_TRUE(CCAESKey::IsValidKeyLength(24));
+}
+
+// NIST SP 800-38A appendix F.
+static const char c_sp80038aPlaintext[] =
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+
+struct ModeVector {
+    const char* key;
+    const char* iv;
+    const char* ciphertext;
+};
+
+static const ModeVector c_cbcVectors[] = {
+    { "2b7e151628aed2a6abf7158809cf4f3c",
+      "000102030405060708090a0b0c0d0e0f",
+      "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b273bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7" },
+    { "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+      "000102030405060708090a0b0c0d0e0f",
+      "f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b" },
+};
+
+static const ModeVector c_ctrVectors[] = {
+    { "2b7e151628aed2a6abf7158809cf4f3c",
+      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+      "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee" },
+    { "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+      "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c52b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6" },
+};
+
+TEST(CCAESEngine, CBCKnownAnswers) {
+    AESImplementations restore;
+    std::vector<uint8_t> plaintext = _bytes(c_sp80038aPlaintext);
+    size_t blockCount = plaintext.size() / CCAESKey::c_blockSize;
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCAESSetEnabledImplementations(implementations);
+
+        for (const ModeVector& vector : c_cbcVectors) {
+            SCOPED_TRACE(testing::Message() << "key " << vector.key << ", implementations " << implementations);
+            std::vector<uint8_t> key = _bytes(vector.key);
+            CCAESKey aesKey;
+            ASSERT_TRUE(aesKey.Init(key.data(), key.size()));
+
+            // One block, then the rest, to check the IV carries over.
+            std::vector<uint8_t> iv = _bytes(vector.iv);
+            std::vector<uint8_t> ciphertext(plaintext.size());
+            aesKey.EncryptCBC(iv.data(), plaintext.data(), ciphertext.data(), 1);
+            aesKey.EncryptCBC(iv.data(), plaintext.data() + CCAESKey::c_blockSize, ciphertext.data() + CCAESKey::c_blockSize, blockCount - 1);
+            EXPECT_EQ(vector.ciphertext, _hex(ciphertext));
+
+            // In place.
+            iv = _bytes(vector.iv);
+            aesKey.DecryptCBC(iv.data(), ciphertext.data(), ciphertext.data(), blockCount);
+            EXPECT_EQ(c_sp80038aPlaintext, _hex(ciphertext));
+        }
+    }
+}
+
+TEST(CCAESEngine, CTRKnownAnswers) {
+    AESImplementations restore;
+    std::vector<uint8_t> plaintext = _bytes(c_sp80038aPlaintext);
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCAESSetEnabledImplementations(implementations);
+
+        for (const ModeVector& vector : c_ctrVectors) {
+            SCOPED_TRACE(testing::Message() << "key " << vector.key << ", implementations " << implementations);
+            std::vector<uint8_t> key = _bytes(vector.key);
+            std::vector<uint8_t> iv = _bytes(vector.iv);
+            CCAESKey aesKey;
+            ASSERT_TRUE(aesKey.Init(key.data(), key.size()));
+
+            // Pieces that straddle block boundaries. The counter's low 64 bits also carry into the high 64 here.
+            std::vector<uint8_t> ciphertext(plaintext.size());
+            CCAESCTR ctr;
+            ctr.Init(&aesKey, iv.data(), false);
+            for (size_t offset = 0, piece = 1; offset < plaintext.size(); offset += piece, piece = piece * 3 % 23 + 1) {
+                piece = std::min(piece, plaintext.size() - offset);
+                ctr.Process(plaintext.data() + offset, ciphertext.data() + offset, piece);
+            }
+            EXPECT_EQ(vector.ciphertext, _hex(ciphertext));
+        }
+    }
+}
+
+struct GCMVector {
+    const char* key;
+    const char* iv;
+    const char* aad;
+    const char* plaintext;
+    const char* ciphertext;
+    const char* tag;
+};
+
+static const char c_gcmPlaintext[] =
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+static const char c_gcmAAD[] = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+
+// Test cases 1-4, 6, 13, 14 and 16 from the GCM specification (McGrew and Viega), as used by NIST's GCM validation.
+static const GCMVector c_gcmVectors[] = {
+    { "00000000000000000000000000000000", "000000000000000000000000", "", "", "", "58e2fccefa7e3061367f1d57a4e7455a" },
+    { "00000000000000000000000000000000",
+      "000000000000000000000000",
+      "",
+      "00000000000000000000000000000000",
+      "0388dace60b6a392f328c2b971b2fe78",
+      "ab6e47d42cec13bdf53a67b21257bddf" },
+    { "feffe9928665731c6d6a8f9467308308",
+      "cafebabefacedbaddecaf888",
+      "",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+      "4d5c2af327cd64a62cf35abd2ba6fab4" },
+    { "feffe9928665731c6d6a8f9467308308",
+      "cafebabefacedbaddecaf888",
+      c_gcmAAD,
+      c_gcmPlaintext,
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+      "5bc94fbc3221a5db94fae95ae7121a47" },
+    { "feffe9928665731c6d6a8f9467308308",
+      "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+      c_gcmAAD,
+      c_gcmPlaintext,
+      "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+      "619cc5aefffe0bfa462af43c1699d050" },
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+      "000000000000000000000000",
+      "",
+      "",
+      "",
+      "530f8afbc74536b9a963b4f1c4cb738b" },
+    { "0000000000000000000000000000000000000000000000000000000000000000",
+      "000000000000000000000000",
+      "",
+      "00000000000000000000000000000000",
+      "cea7403d4d606b6e074ec5d3baf39d18",
+      "d0d1c8a799996bf0265b98b5d48ab919" },
+    { "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+      "cafebabefacedbaddecaf888",
+      c_gcmAAD,
+      c_gcmPlaintext,
+      "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+      "76fc6ece0f4e1768cddf8853bb2d551b" },
+};
+
+TEST(CCAESEngine, GCMKnownAnswers) {
+    AESImplementations restore;
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCAESSetEnabledImplementations(implementations);
+
+        for (const GCMVector& vector : c_gcmVectors) {
+            SCOPED_TRACE(testing::Message() << "key " << vector.key << ", iv " << vector.iv << ", implementations " << implementations);
+            std::vector<uint8_t> key = _bytes(vector.key);
+            std::vector<uint8_t> iv = _bytes(vector.iv);
+            std::vector<uint8_t> aad = _bytes(vector.aad);
+            std::vector<uint8_t> plaintext = _bytes(vector.plaintext);
+
+            CCAESKey aesKey;
+            ASSERT_TRUE(aesKey.Init(key.data(), key.size()));
+            CCAESGCM gcm;
+            gcm.Init(&aesKey);
+
+            // The AAD and text in uneven pieces, so partial blocks are carried between calls.
+            gcm.SetIV(iv.data(), iv.size());
+            for (size_t offset = 0; offset < aad.size(); offset += 7) {
+                gcm.AddAAD(aad.data() + offset, std::min<size_t>(7, aad.size() - offset));
+            }
+            std::vector<uint8_t> ciphertext(plaintext.size());
+            for (size_t offset = 0; offset < plaintext.size(); offset += 13) {
+                size_t length = std::min<size_t>(13, plaintext.size() - offset);
+                gcm.Encrypt(plaintext.data() + offset, ciphertext.data() + offset, length);
+            }
+            uint8_t tag[CCAESGCM::c_tagLength];
+            gcm.Final(tag);
+            EXPECT_EQ(vector.ciphertext, _hex(ciphertext));
+            EXPECT_EQ(vector.tag, _hex(tag, sizeof(tag)));
+
+            // The same key and hash key serve the next message.
+            gcm.SetIV(iv.data(), iv.size());
+            gcm.AddAAD(aad.data(), aad.size());
+            std::vector<uint8_t> decrypted(ciphertext.size());
+            gcm.Decrypt(ciphertext.data(), decrypted.data(), ciphertext.size());
+            gcm.Final(tag);
+            EXPECT_EQ(vector.plaintext, _hex(decrypted));
+            EXPECT_EQ(vector.tag, _hex(tag, sizeof(tag)));
+        }
+    }
+}
+
+TEST(CCAESEngine, ImplementationsAgree) {
+    AESImplementations restore;
+
+    uint32_t seed = 1;
+    auto random = [&seed]() {
+        seed = seed * 1664525 + 1013904223;
+        return static_cast<uint8_t>(seed >> 24);
+    };
+
+    // Lengths around the hardware kernels' 4- and 8-block groups. The counter starts just short of wrapping its low 32
+    // bits, which GCM must not carry past.
+    std::vector<uint8_t> key(32);
+    std::vector<uint8_t> iv(16);
+    std::generate(key.begin(), key.end(), random);
+    std::generate(iv.begin(), iv.end(), random);
+    iv[12] = iv[13] = iv[14] = 0xff;
+    iv[15] = 0xfc;
+
+    for (size_t keyLength : { 16, 24, 32 }) {
+        for (size_t length : { 0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 255, 256, 1000, 4097 }) {
+            SCOPED_TRACE(testing::Message() << "key length " << keyLength << ", length " << length);
+            std::vector<uint8_t> plaintext(length);
+            std::generate(plaintext.begin(), plaintext.end(), random);
+            size_t blockCount = length / CCAESKey::c_blockSize;
+
+            std::string expected[4];
+            for (uint32_t implementations : _implementationSets()) {
+                CCAESSetEnabledImplementations(implementations);
+                CCAESKey aesKey;
+                ASSERT_TRUE(aesKey.Init(key.data(), keyLength));
+
+                std::vector<uint8_t> output(length);
+                std::vector<uint8_t> chain(iv);
+                aesKey.EncryptBlocks(plaintext.data(), output.data(), blockCount);
+                std::string ecb = _hex(output.data(), blockCount * CCAESKey::c_blockSize);
+                aesKey.EncryptCBC(chain.data(), plaintext.data(), output.data(), blockCount);
+                std::string cbc = _hex(output.data(), blockCount * CCAESKey::c_blockSize);
+
+                CCAESCTR ctr;
+                ctr.Init(&aesKey, iv.data(), true);
+                ctr.Process(plaintext.data(), output.data(), length);
+                std::string ctr32 = _hex(output);
+
+                CCAESGCM gcm;
+                gcm.Init(&aesKey);
+                gcm.SetIV(iv.data(), 12);
+                gcm.AddAAD(iv.data(), iv.size());
+                gcm.Encrypt(plaintext.data(), output.data(), length);
+                uint8_t tag[CCAESGCM::c_tagLength];
+                gcm.Final(tag);
+                std::string sealed = _hex(output) + _hex(tag, sizeof(tag));
+
+                if (implementations == CCAESImplementationPortable) {
+                    expected[0] = ecb;
+                    expected[1] = cbc;
+                    expected[2] = ctr32;
+                    expected[3] = sealed;
+                } else {
+                    EXPECT_EQ(expected[0], ecb) << "implementations " << implementations;
+                    EXPECT_EQ(expected[1], cbc) << "implementations " << implementations;
+                    EXPECT_EQ(expected[2], ctr32) << "implementations " << implementations;
+                    EXPECT_EQ(expected[3], sealed) << "implementations " << implementations;
+                }
+            }
+        }
+    }
+}
+
+TEST(CCAESEngine, CounterIncrementWidth) {
+    std::vector<uint8_t> key = _bytes(c_ctrVectors[0].key);
+    CCAESKey aesKey;
+    ASSERT_TRUE(aesKey.Init(key.data(), key.size()));
+
+    // Three blocks from a counter about to wrap its low 32 bits: a full-width counter carries, a GCM counter doesn't.
+    uint8_t start[CCAESKey::c_blockSize] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x07, 0xff, 0xff, 0xff, 0xff };
+    uint8_t counter[CCAESKey::c_blockSize];
+    uint8_t zeros[3 * CCAESKey::c_blockSize] = {};
+    uint8_t keystream[3 * CCAESKey::c_blockSize];
+
+    memcpy(counter, start, sizeof(counter));
+    aesKey.CTRBlocks(counter, false, zeros, keystream, 3);
+    EXPECT_EQ("00000000000000000000000800000002", _hex(counter, sizeof(counter)));
+
+    uint8_t expected[CCAESKey::c_blockSize] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x08, 0, 0, 0, 0 };
+    aesKey.EncryptBlocks(expected, expected, 1);
+    EXPECT_EQ(_hex(expected, sizeof(expected)), _hex(keystream + CCAESKey::c_blockSize, CCAESKey::c_blockSize));
+
+    memcpy(counter, start, sizeof(counter));
+    aesKey.CTRBlocks(counter, true, zeros, keystream, 3);
+    EXPECT_EQ("00000000000000000000000700000002", _hex(counter, sizeof(counter)));
+}
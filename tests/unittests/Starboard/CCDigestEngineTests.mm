@@ -0,0 +1,315 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <TestFramework.h>
+#include <CommonCrypto/CommonCrypto.h>
+#include "CCDigestEngine.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+static const char c_message448[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static const char c_message896[] =
+    "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+
+struct DigestVector {
+    CCDigestAlgorithm algorithm;
+    const char* empty;
+    const char* abc;
+    const char* message448;
+    const char* message896;
+    const char* millionA;
+};
+
+// FIPS 180 and RFC 1321 test vectors.
+static const DigestVector c_digestVectors[] = {
+    { kCCDigestMD5,
+      "d41d8cd98f00b204e9800998ecf8427e",
+      "900150983cd24fb0d6963f7d28e17f72",
+      "8215ef0796a20bcaaae116d3876c664a",
+      "03dd8807a93175fb062dfb55dc7d359c",
+      "7707d6ae4e027c70eea2a935c2296f21" },
+    { kCCDigestSHA1,
+      "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+      "a9993e364706816aba3e25717850c26c9cd0d89d",
+      "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+      "a49b2446a02c645bf419f995b67091253a04a259",
+      "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+    { kCCDigestSHA224,
+      "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f",
+      "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7",
+      "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525",
+      "c97ca9a559850ce97a04a96def6d99a9e0e0e2ab14e6b8df265fc0b3",
+      "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67" },
+    { kCCDigestSHA256,
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+      "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+      "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { kCCDigestSHA384,
+      "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b",
+      "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7",
+      "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6b0455a8520bc4e6f5fe95b1fe3c8452b",
+      "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039",
+      "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b07b8b3dc38ecc4ebae97ddd87f3d8985" },
+    { kCCDigestSHA512,
+      "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e",
+      "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+      "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c33596fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445",
+      "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909",
+      "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+};
+
+static std::string _hex(const unsigned char* bytes, size_t length) {
+    std::string result;
+    char digits[3];
+    for (size_t i = 0; i < length; ++i) {
+        sprintf_s(digits, "%02x", bytes[i]);
+        result += digits;
+    }
+    return result;
+}
+
+static std::string _digest(CCDigestAlgorithm algorithm, const void* data, size_t length) {
+    unsigned char digest[CCDigestContext::c_maxDigestLength];
+    CCDigestContext context;
+    context.Init(algorithm);
+    context.Update(data, length);
+    context.Final(digest);
+    return _hex(digest, CCDigestContext::GetDigestLength(algorithm));
+}
+
+// Every subset of kernels worth testing on this machine: portable only, each available implementation alone, and all.
+static std::vector<uint32_t> _implementationSets() {
+    uint32_t available = CCDigestGetAvailableImplementations();
+    std::vector<uint32_t> sets = { CCDigestImplementationPortable };
+    for (uint32_t bit = 1; bit != 0 && bit <= available; bit <<= 1) {
+        if (available & bit) {
+            sets.push_back(bit);
+        }
+    }
+    sets.push_back(available);
+    return sets;
+}
+
+class DigestImplementations {
+public:
+    ~DigestImplementations() {
+        CCDigestSetEnabledImplementations(UINT32_MAX);
+    }
+};
+
+TEST(CCDigestEngine, KnownAnswers) {
+    DigestImplementations restore;
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCDigestSetEnabledImplementations(implementations);
+
+        for (const DigestVector& vector : c_digestVectors) {
+            SCOPED_TRACE(testing::Message() << "algorithm " << vector.algorithm << ", implementations " << implementations);
+
+            EXPECT_EQ(vector.empty, _digest(vector.algorithm, "", 0));
+            EXPECT_EQ(vector.abc, _digest(vector.algorithm, "abc", 3));
+            EXPECT_EQ(vector.message448, _digest(vector.algorithm, c_message448, sizeof(c_message448) - 1));
+            EXPECT_EQ(vector.message896, _digest(vector.algorithm, c_message896, sizeof(c_message896) - 1));
+        }
+    }
+}
+
+TEST(CCDigestEngine, MillionAInPieces) {
+    DigestImplementations restore;
+    std::vector<char> chunk(1000, 'a');
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCDigestSetEnabledImplementations(implementations);
+
+        for (const DigestVector& vector : c_digestVectors) {
+            SCOPED_TRACE(testing::Message() << "algorithm " << vector.algorithm << ", implementations " << implementations);
+
+            // Odd-sized pieces so updates straddle block boundaries.
+            CCDigestContext context;
+            context.Init(vector.algorithm);
+            size_t remaining = 1000000;
+            for (size_t piece = 1; remaining > 0; piece = (piece * 7 + 3) % 997 + 1) {
+                size_t length = std::min(piece, remaining);
+                context.Update(chunk.data(), length);
+                remaining -= length;
+            }
+
+            unsigned char digest[CCDigestContext::c_maxDigestLength];
+            context.Final(digest);
+            EXPECT_EQ(vector.millionA, _hex(digest, CCDigestContext::GetDigestLength(vector.algorithm)));
+        }
+    }
+}
+
+TEST(CCDigestEngine, MultipleMatchesSingle) {
+    DigestImplementations restore;
+
+    // Lengths around every padding boundary plus a few multi-block messages, in an order that makes lanes finish at
+    // different times.
+    std::vector<std::vector<unsigned char>> messages;
+    for (size_t length = 0; length <= 260; ++length) {
+        messages.emplace_back(length);
+    }
+    for (size_t length : { 4096, 1, 10000, 129, 640, 3 }) {
+        messages.emplace_back(length);
+    }
+
+    uint32_t seed = 1;
+    for (auto& message : messages) {
+        for (auto& byte : message) {
+            seed = seed * 1664525 + 1013904223;
+            byte = static_cast<unsigned char>(seed >> 24);
+        }
+    }
+
+    std::vector<const void*> data;
+    std::vector<size_t> lengths;
+    for (const auto& message : messages) {
+        data.push_back(message.data());
+        lengths.push_back(message.size());
+    }
+
+    for (uint32_t implementations : _implementationSets()) {
+        CCDigestSetEnabledImplementations(implementations);
+
+        for (const DigestVector& vector : c_digestVectors) {
+            SCOPED_TRACE(testing::Message() << "algorithm " << vector.algorithm << ", implementations " << implementations);
+            size_t digestLength = CCDigestContext::GetDigestLength(vector.algorithm);
+
+            std::vector<unsigned char> output(messages.size() * digestLength);
+            std::vector<unsigned char*> digests;
+            for (size_t i = 0; i < messages.size(); ++i) {
+                digests.push_back(&output[i * digestLength]);
+            }
+
+            CCDigestMultiple(vector.algorithm, data.data(), lengths.data(), messages.size(), digests.data());
+
+            for (size_t i = 0; i < messages.size(); ++i) {
+                ASSERT_EQ(_digest(vector.algorithm, data[i], lengths[i]), _hex(digests[i], digestLength)) << "message " << i;
+            }
+        }
+    }
+}
+
+TEST(CCDigestEngine, DigestMultipleExport) {
+    const void* data[] = { "", "abc", c_message448 };
+    const CC_LONG lengths[] = { 0, 3, sizeof(c_message448) - 1 };
+    unsigned char output[3][CC_SHA256_DIGEST_LENGTH];
+    unsigned char* digests[] = { output[0], output[1], output[2] };
+
+    ASSERT_EQ(1, CC_DigestMultiple(kCCDigestSHA256, data, lengths, 3, digests));
+    EXPECT_EQ(c_digestVectors[3].empty, _hex(output[0], CC_SHA256_DIGEST_LENGTH));
+    EXPECT_EQ(c_digestVectors[3].abc, _hex(output[1], CC_SHA256_DIGEST_LENGTH));
+    EXPECT_EQ(c_digestVectors[3].message448, _hex(output[2], CC_SHA256_DIGEST_LENGTH));
+
+    EXPECT_EQ(-1, CC_DigestMultiple(kCCDigestMD2, data, lengths, 3, digests));
+}
+
+TEST(CCDigestEngine, SHA224) {
+    unsigned char digest[CC_SHA224_DIGEST_LENGTH];
+    ASSERT_EQ(digest, CC_SHA224("abc", 3, digest));
+    EXPECT_EQ(c_digestVectors[2].abc, _hex(digest, CC_SHA224_DIGEST_LENGTH));
+
+    CC_SHA224_CTX ctx;
+    ASSERT_EQ(1, CC_SHA224_Init(&ctx));
+    ASSERT_EQ(1, CC_SHA224_Update(&ctx, c_message448, 20));
+    ASSERT_EQ(1, CC_SHA224_Update(&ctx, c_message448 + 20, sizeof(c_message448) - 21));
+    ASSERT_EQ(1, CC_SHA224_Final(digest, &ctx));
+    EXPECT_EQ(c_digestVectors[2].message448, _hex(digest, CC_SHA224_DIGEST_LENGTH));
+}
+
+struct HmacVector {
+    CCHmacAlgorithm algorithm;
+    size_t length;
+    const char* jefe;
+    const char* longKey;
+};
+
+// RFC 2202 and RFC 4231 test cases 2 ("Jefe") and 6 (131-byte key).
+static const HmacVector c_hmacVectors[] = {
+    { kCCHmacAlgMD5, CC_MD5_DIGEST_LENGTH, "750c783e6ab0b503eaa86e310a5db738", "bfecaf4efff90a3a668f3922fec3762d" },
+    { kCCHmacAlgSHA1,
+      CC_SHA1_DIGEST_LENGTH,
+      "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+      "90d0dace1c1bdc957339307803160335bde6df2b" },
+    { kCCHmacAlgSHA224,
+      CC_SHA224_DIGEST_LENGTH,
+      "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44",
+      "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e" },
+    { kCCHmacAlgSHA256,
+      CC_SHA256_DIGEST_LENGTH,
+      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+      "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+    { kCCHmacAlgSHA384,
+      CC_SHA384_DIGEST_LENGTH,
+      "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e8e2240ca5e69e2c78b3239ecfab21649",
+      "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c60c2ef6ab4030fe8296248df163f44952" },
+    { kCCHmacAlgSHA512,
+      CC_SHA512_DIGEST_LENGTH,
+      "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737",
+      "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598" },
+};
+
+TEST(CCDigestEngine, HmacKnownAnswers) {
+    static const char jefeData[] = "what do ya want for nothing?";
+    static const char longKeyData[] = "Test Using Larger Than Block-Size Key - Hash Key First";
+    std::vector<unsigned char> longKey(131, 0xaa);
+
+    for (const HmacVector& vector : c_hmacVectors) {
+        SCOPED_TRACE(testing::Message() << "algorithm " << vector.algorithm);
+        unsigned char mac[CC_SHA512_DIGEST_LENGTH];
+
+        CCHmac(vector.algorithm, "Jefe", 4, jefeData, sizeof(jefeData) - 1, mac);
+        EXPECT_EQ(vector.jefe, _hex(mac, vector.length));
+
+        CCHmacContext ctx;
+        CCHmacInit(&ctx, vector.algorithm, longKey.data(), longKey.size());
+        CCHmacUpdate(&ctx, longKeyData, 10);
+        CCHmacUpdate(&ctx, longKeyData + 10, sizeof(longKeyData) - 11);
+        CCHmacFinal(&ctx, mac);
+        EXPECT_EQ(vector.longKey, _hex(mac, vector.length));
+    }
+}
+
+TEST(CCDigestEngine, PBKDF2MatchesAcrossImplementations) {
+    DigestImplementations restore;
+    static const char password[] = "correct horse battery staple";
+    static const char salt[] = "NaCl";
+
+    // Output lengths that fill a partial lane group, a full one, and a full one plus a straggler.
+    for (const DigestVector& vector : c_digestVectors) {
+        size_t digestLength = CCDigestContext::GetDigestLength(vector.algorithm);
+        for (size_t length : { digestLength - 1, 3 * digestLength, 9 * digestLength + 5 }) {
+            SCOPED_TRACE(testing::Message() << "algorithm " << vector.algorithm << ", length " << length);
+
+            CCDigestSetEnabledImplementations(CCDigestImplementationPortable);
+            std::vector<unsigned char> expected(length);
+            CCDigestPBKDF2(vector.algorithm, password, sizeof(password) - 1, salt, sizeof(salt) - 1, 37, expected.data(), length);
+
+            for (uint32_t implementations : _implementationSets()) {
+                CCDigestSetEnabledImplementations(implementations);
+                std::vector<unsigned char> derivedKey(length);
+                CCDigestPBKDF2(vector.algorithm, password, sizeof(password) - 1, salt, sizeof(salt) - 1, 37, derivedKey.data(), length);
+                EXPECT_EQ(_hex(expected.data(), length), _hex(derivedKey.data(), length)) << "implementations " << implementations;
+            }
+        }
+    }
+}
@@ -17,6 +17,9 @@
 #include <TestFramework.h>
 #include <windows.h>
 #include <CommonCrypto/CommonCrypto.h>
+#include <CommonCrypto/CommonCryptorSPI.h>
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 #include "ByteUtils.h"
@@ -121,6 +124,7 @@ INSTANTIATE_TEST_CASE_P(
                       ::testing::make_tuple(CC_MD4_Init, CC_MD4_Update, CC_MD4_Final, CC_MD4_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_MD5_Init, CC_MD5_Update, CC_MD5_Final, CC_MD5_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA1_Init, CC_SHA1_Update, CC_SHA1_Final, CC_SHA1_DIGEST_LENGTH),
+                      ::testing::make_tuple(CC_SHA224_Init, CC_SHA224_Update, CC_SHA224_Final, CC_SHA224_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA256_Init, CC_SHA256_Update, CC_SHA256_Final, CC_SHA256_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA384_Init, CC_SHA384_Update, CC_SHA384_Final, CC_SHA384_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA512_Init, CC_SHA512_Update, CC_SHA512_Final, CC_SHA512_DIGEST_LENGTH)));
@@ -166,6 +170,7 @@ INSTANTIATE_TEST_CASE_P(
                       ::testing::make_tuple(CC_MD4_Init, CC_MD4_Update, CC_MD4_Final, CC_MD4, CC_MD4_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_MD5_Init, CC_MD5_Update, CC_MD5_Final, CC_MD5, CC_MD5_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA1_Init, CC_SHA1_Update, CC_SHA1_Final, CC_SHA1, CC_SHA1_DIGEST_LENGTH),
+                      ::testing::make_tuple(CC_SHA224_Init, CC_SHA224_Update, CC_SHA224_Final, CC_SHA224, CC_SHA224_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA256_Init, CC_SHA256_Update, CC_SHA256_Final, CC_SHA256, CC_SHA256_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA384_Init, CC_SHA384_Update, CC_SHA384_Final, CC_SHA384, CC_SHA384_DIGEST_LENGTH),
                       ::testing::make_tuple(CC_SHA512_Init, CC_SHA512_Update, CC_SHA512_Final, CC_SHA512, CC_SHA512_DIGEST_LENGTH)));
@@ -227,6 +232,7 @@ INSTANTIATE_TEST_CASE_P(CommonHmac,
                         HmacTest,
                         ::testing::Values(::testing::make_tuple(kCCHmacAlgSHA1, CC_SHA1_DIGEST_LENGTH),
                                           ::testing::make_tuple(kCCHmacAlgMD5, CC_MD5_DIGEST_LENGTH),
+                                          ::testing::make_tuple(kCCHmacAlgSHA224, CC_SHA224_DIGEST_LENGTH),
                                           ::testing::make_tuple(kCCHmacAlgSHA256, CC_SHA256_DIGEST_LENGTH),
                                           ::testing::make_tuple(kCCHmacAlgSHA384, CC_SHA384_DIGEST_LENGTH),
                                           ::testing::make_tuple(kCCHmacAlgSHA512, CC_SHA512_DIGEST_LENGTH)));
@@ -399,7 +405,7 @@ void _encryptDecryptSameAsOriginal(
                      outputSize,
                      &oneShotBytesDecrypted);
     ASSERT_EQ(kCCSuccess, status);
-    ASSERT_EQ(outputLength, oneShotBytesDecrypted);
+    ASSERT_EQ(update1Size + update2Size, oneShotBytesDecrypted);
     logBytes(singleLine, output2.data(), update1Size + update2Size);
 
     ASSERT_TRUE_MSG(equalsBytes((BYTE*)singleLine, output2.data(), update1Size + update2Size),
@@ -482,4 +488,409 @@ TEST(CommonCryptor, Sanity) {
     logBytes(multiLine2, output.data(), aesBlockLength);
     ASSERT_EQ(16, datamoved);
     CCCryptorRelease(ctx);
-}
\ No newline at end of file
+}
+
+static std::vector<uint8_t> _bytesFromHex(const char* hex) {
+    std::vector<uint8_t> result;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        unsigned int byte;
+        sscanf(hex + i, "%2x", &byte);
+        result.push_back(static_cast<uint8_t>(byte));
+    }
+    return result;
+}
+
+// NIST SP 800-38A F.2.1 and F.5.1.
+static const char c_aesKey[] = "2b7e151628aed2a6abf7158809cf4f3c";
+static const char c_aesPlaintext[] =
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+static const char c_aesCBCIV[] = "000102030405060708090a0b0c0d0e0f";
+static const char c_aesCBCCiphertext[] =
+    "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b273bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7";
+static const char c_aesCTRCounter[] = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+static const char c_aesCTRCiphertext[] =
+    "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee";
+
+TEST(CommonCryptor, AESCBCKnownAnswer) {
+    std::vector<uint8_t> key = _bytesFromHex(c_aesKey);
+    std::vector<uint8_t> iv = _bytesFromHex(c_aesCBCIV);
+    std::vector<uint8_t> plaintext = _bytesFromHex(c_aesPlaintext);
+    std::vector<uint8_t> expected = _bytesFromHex(c_aesCBCCiphertext);
+
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    size_t moved;
+    ASSERT_EQ(kCCSuccess,
+              CCCrypt(kCCEncrypt,
+                      kCCAlgorithmAES,
+                      0,
+                      key.data(),
+                      key.size(),
+                      iv.data(),
+                      plaintext.data(),
+                      plaintext.size(),
+                      ciphertext.data(),
+                      ciphertext.size(),
+                      &moved));
+    ASSERT_EQ(plaintext.size(), moved);
+    EXPECT_TRUE(equalsBytes(expected.data(), ciphertext.data(), expected.size()));
+
+    // Streamed through a reused cryptor in uneven pieces, in place.
+    CCCryptorRef cryptor;
+    ASSERT_EQ(kCCSuccess, CCCryptorCreate(kCCDecrypt, kCCAlgorithmAES, 0, key.data(), key.size(), iv.data(), &cryptor));
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint8_t> buffer(expected);
+        size_t total = 0;
+        for (size_t offset = 0, piece = 5; offset < buffer.size(); offset += piece, piece += 6) {
+            piece = std::min(piece, buffer.size() - offset);
+            ASSERT_EQ(kCCSuccess, CCCryptorUpdate(cryptor, buffer.data() + offset, piece, buffer.data() + total, buffer.size() - total, &moved));
+            total += moved;
+        }
+        ASSERT_EQ(kCCSuccess, CCCryptorFinal(cryptor, buffer.data() + total, buffer.size() - total, &moved));
+        ASSERT_EQ(plaintext.size(), total + moved);
+        EXPECT_TRUE(equalsBytes(plaintext.data(), buffer.data(), plaintext.size()));
+        ASSERT_EQ(kCCSuccess, CCCryptorReset(cryptor, iv.data()));
+    }
+    CCCryptorRelease(cryptor);
+}
+
+TEST(CommonCryptor, AESPaddingRoundTrip) {
+    std::vector<uint8_t> key = _bytesFromHex(c_aesKey);
+    std::vector<uint8_t> plaintext = _bytesFromHex(c_aesPlaintext);
+
+    for (CCOptions options : { static_cast<CCOptions>(kCCOptionPKCS7Padding), static_cast<CCOptions>(kCCOptionPKCS7Padding | kCCOptionECBMode) }) {
+        for (size_t length = 0; length <= plaintext.size(); ++length) {
+            SCOPED_TRACE(testing::Message() << "options " << options << ", length " << length);
+
+            // Padding always adds at least one byte, so whole blocks gain a whole block.
+            size_t paddedLength = (length / kCCBlockSizeAES128 + 1) * kCCBlockSizeAES128;
+            std::vector<uint8_t> ciphertext(paddedLength);
+            size_t moved;
+            ASSERT_EQ(kCCSuccess,
+                      CCCrypt(kCCEncrypt,
+                              kCCAlgorithmAES,
+                              options,
+                              key.data(),
+                              key.size(),
+                              nullptr,
+                              plaintext.data(),
+                              length,
+                              ciphertext.data(),
+                              ciphertext.size(),
+                              &moved));
+            ASSERT_EQ(paddedLength, moved);
+
+            std::vector<uint8_t> decrypted(paddedLength);
+            ASSERT_EQ(kCCSuccess,
+                      CCCrypt(kCCDecrypt,
+                              kCCAlgorithmAES,
+                              options,
+                              key.data(),
+                              key.size(),
+                              nullptr,
+                              ciphertext.data(),
+                              ciphertext.size(),
+                              decrypted.data(),
+                              decrypted.size(),
+                              &moved));
+            ASSERT_EQ(length, moved);
+            EXPECT_TRUE(equalsBytes(plaintext.data(), decrypted.data(), length));
+
+            // In CBC, flipping the top bit of the second-to-last ciphertext block flips it in the final padding byte too,
+            // which pushes that byte out of range.
+            if (!(options & kCCOptionECBMode) && paddedLength > kCCBlockSizeAES128) {
+                ciphertext[paddedLength - kCCBlockSizeAES128 - 1] ^= 0x80;
+                EXPECT_EQ(kCCDecodeError,
+                          CCCrypt(kCCDecrypt,
+                                  kCCAlgorithmAES,
+                                  options,
+                                  key.data(),
+                                  key.size(),
+                                  nullptr,
+                                  ciphertext.data(),
+                                  ciphertext.size(),
+                                  decrypted.data(),
+                                  decrypted.size(),
+                                  &moved));
+            }
+        }
+    }
+}
+
+TEST(CommonCryptor, AESUnpaddedLeftoverFails) {
+    std::vector<uint8_t> key = _bytesFromHex(c_aesKey);
+    uint8_t output[32];
+    size_t moved;
+    EXPECT_EQ(kCCAlignmentError,
+              CCCrypt(kCCEncrypt, kCCAlgorithmAES, 0, key.data(), key.size(), nullptr, singleLine, 17, output, sizeof(output), &moved));
+    EXPECT_EQ(kCCBufferTooSmall,
+              CCCrypt(kCCEncrypt, kCCAlgorithmAES, 0, key.data(), key.size(), nullptr, singleLine, 32, output, 16, &moved));
+}
+
+TEST(CommonCryptor, AESCTRKnownAnswer) {
+    std::vector<uint8_t> key = _bytesFromHex(c_aesKey);
+    std::vector<uint8_t> counter = _bytesFromHex(c_aesCTRCounter);
+    std::vector<uint8_t> plaintext = _bytesFromHex(c_aesPlaintext);
+    std::vector<uint8_t> expected = _bytesFromHex(c_aesCTRCiphertext);
+
+    CCCryptorRef cryptor;
+    ASSERT_EQ(kCCSuccess,
+              CCCryptorCreateWithMode(kCCEncrypt,
+                                      kCCModeCTR,
+                                      kCCAlgorithmAES,
+                                      ccNoPadding,
+                                      counter.data(),
+                                      key.data(),
+                                      key.size(),
+                                      nullptr,
+                                      0,
+                                      0,
+                                      kCCModeOptionCTR_BE,
+                                      &cryptor));
+    EXPECT_EQ(plaintext.size(), CCCryptorGetOutputLength(cryptor, plaintext.size(), true));
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint8_t> ciphertext(plaintext.size());
+        size_t moved;
+        ASSERT_EQ(kCCSuccess, CCCryptorUpdate(cryptor, plaintext.data(), 9, ciphertext.data(), ciphertext.size(), &moved));
+        ASSERT_EQ(9, moved);
+        ASSERT_EQ(kCCSuccess, CCCryptorUpdate(cryptor, plaintext.data() + 9, plaintext.size() - 9, ciphertext.data() + 9, ciphertext.size() - 9, &moved));
+        ASSERT_EQ(plaintext.size() - 9, moved);
+        ASSERT_EQ(kCCSuccess, CCCryptorFinal(cryptor, nullptr, 0, &moved));
+        ASSERT_EQ(0, moved);
+        EXPECT_TRUE(equalsBytes(expected.data(), ciphertext.data(), expected.size()));
+        ASSERT_EQ(kCCSuccess, CCCryptorReset(cryptor, counter.data()));
+    }
+    CCCryptorRelease(cryptor);
+
+    EXPECT_EQ(kCCUnimplemented,
+              CCCryptorCreateWithMode(
+                  kCCEncrypt, kCCModeCTR, kCCAlgorithmDES, ccNoPadding, counter.data(), key.data(), kCCKeySizeDES, nullptr, 0, 0, 0, &cryptor));
+    EXPECT_EQ(kCCParamError,
+              CCCryptorCreateWithMode(
+                  kCCEncrypt, kCCModeCTR, kCCAlgorithmAES, ccPKCS7Padding, counter.data(), key.data(), key.size(), nullptr, 0, 0, 0, &cryptor));
+}
+
+// GCM specification test case 4.
+static const char c_gcmKey[] = "feffe9928665731c6d6a8f9467308308";
+static const char c_gcmIV[] = "cafebabefacedbaddecaf888";
+static const char c_gcmAAD[] = "feedfacedeadbeeffeedfacedeadbeefabaddad2";
+static const char c_gcmPlaintext[] =
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39";
+static const char c_gcmCiphertext[] =
+    "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091";
+static const char c_gcmTag[] = "5bc94fbc3221a5db94fae95ae7121a47";
+
+TEST(CommonCryptor, GCMOneshot) {
+    std::vector<uint8_t> key = _bytesFromHex(c_gcmKey);
+    std::vector<uint8_t> iv = _bytesFromHex(c_gcmIV);
+    std::vector<uint8_t> aad = _bytesFromHex(c_gcmAAD);
+    std::vector<uint8_t> plaintext = _bytesFromHex(c_gcmPlaintext);
+    std::vector<uint8_t> expected = _bytesFromHex(c_gcmCiphertext);
+    std::vector<uint8_t> expectedTag = _bytesFromHex(c_gcmTag);
+
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    uint8_t tag[16];
+    ASSERT_EQ(kCCSuccess,
+              CCCryptorGCMOneshotEncrypt(kCCAlgorithmAES,
+                                         key.data(),
+                                         key.size(),
+                                         iv.data(),
+                                         iv.size(),
+                                         aad.data(),
+                                         aad.size(),
+                                         plaintext.data(),
+                                         plaintext.size(),
+                                         ciphertext.data(),
+                                         tag,
+                                         sizeof(tag)));
+    EXPECT_TRUE(equalsBytes(expected.data(), ciphertext.data(), expected.size()));
+    EXPECT_TRUE(equalsBytes(expectedTag.data(), tag, sizeof(tag)));
+
+    std::vector<uint8_t> decrypted(ciphertext.size());
+    ASSERT_EQ(kCCSuccess,
+              CCCryptorGCMOneshotDecrypt(kCCAlgorithmAES,
+                                         key.data(),
+                                         key.size(),
+                                         iv.data(),
+                                         iv.size(),
+                                         aad.data(),
+                                         aad.size(),
+                                         ciphertext.data(),
+                                         ciphertext.size(),
+                                         decrypted.data(),
+                                         tag,
+                                         12));
+    EXPECT_TRUE(equalsBytes(plaintext.data(), decrypted.data(), plaintext.size()));
+
+    // A tampered message yields no plaintext.
+    ciphertext[10] ^= 1;
+    EXPECT_EQ(kCCDecodeError,
+              CCCryptorGCMOneshotDecrypt(kCCAlgorithmAES,
+                                         key.data(),
+                                         key.size(),
+                                         iv.data(),
+                                         iv.size(),
+                                         aad.data(),
+                                         aad.size(),
+                                         ciphertext.data(),
+                                         ciphertext.size(),
+                                         decrypted.data(),
+                                         tag,
+                                         sizeof(tag)));
+    EXPECT_EQ(std::vector<uint8_t>(decrypted.size()), decrypted);
+
+    EXPECT_EQ(kCCParamError,
+              CCCryptorGCMOneshotDecrypt(kCCAlgorithmAES,
+                                         key.data(),
+                                         key.size(),
+                                         iv.data(),
+                                         iv.size(),
+                                         aad.data(),
+                                         aad.size(),
+                                         ciphertext.data(),
+                                         ciphertext.size(),
+                                         decrypted.data(),
+                                         tag,
+                                         2));
+}
+
+TEST(CommonCryptor, GCMStreaming) {
+    std::vector<uint8_t> key = _bytesFromHex(c_gcmKey);
+    std::vector<uint8_t> iv = _bytesFromHex(c_gcmIV);
+    std::vector<uint8_t> aad = _bytesFromHex(c_gcmAAD);
+    std::vector<uint8_t> plaintext = _bytesFromHex(c_gcmPlaintext);
+    std::vector<uint8_t> expected = _bytesFromHex(c_gcmCiphertext);
+    std::vector<uint8_t> expectedTag = _bytesFromHex(c_gcmTag);
+
+    CCCryptorRef encryptor;
+    ASSERT_EQ(kCCSuccess,
+              CCCryptorCreateWithMode(
+                  kCCEncrypt, kCCModeGCM, kCCAlgorithmAES, ccNoPadding, nullptr, key.data(), key.size(), nullptr, 0, 0, 0, &encryptor));
+
+    // Data before an IV is an error.
+    std::vector<uint8_t> ciphertext(plaintext.size());
+    EXPECT_EQ(kCCParamError, CCCryptorGCMEncrypt(encryptor, plaintext.data(), plaintext.size(), ciphertext.data()));
+
+    for (int pass = 0; pass < 2; ++pass) {
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMAddIV(encryptor, iv.data(), 5));
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMAddIV(encryptor, iv.data() + 5, iv.size() - 5));
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMAddAAD(encryptor, aad.data(), 3));
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMAddAAD(encryptor, aad.data() + 3, aad.size() - 3));
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMEncrypt(encryptor, plaintext.data(), 31, ciphertext.data()));
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMEncrypt(encryptor, plaintext.data() + 31, plaintext.size() - 31, ciphertext.data() + 31));
+
+        uint8_t tag[16];
+        size_t tagLength = sizeof(tag);
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMFinal(encryptor, tag, &tagLength));
+        ASSERT_EQ(sizeof(tag), tagLength);
+        EXPECT_TRUE(equalsBytes(expected.data(), ciphertext.data(), expected.size()));
+        EXPECT_TRUE(equalsBytes(expectedTag.data(), tag, sizeof(tag)));
+
+        ASSERT_EQ(kCCSuccess, CCCryptorGCMReset(encryptor));
+    }
+    EXPECT_EQ(kCCUnimplemented, CCCryptorReset(encryptor, nullptr));
+    CCCryptorRelease(encryptor);
+
+    CCCryptorRef decryptor;
+    ASSERT_EQ(kCCSuccess,
+              CCCryptorCreateWithMode(
+                  kCCDecrypt, kCCModeGCM, kCCAlgorithmAES, ccNoPadding, nullptr, key.data(), key.size(), nullptr, 0, 0, 0, &decryptor));
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMSetIV(decryptor, iv.data(), iv.size()));
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMAddAAD(decryptor, aad.data(), aad.size()));
+    std::vector<uint8_t> decrypted(expected.size());
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMDecrypt(decryptor, expected.data(), expected.size(), decrypted.data()));
+    EXPECT_EQ(kCCSuccess, CCCryptorGCMFinalize(decryptor, expectedTag.data(), expectedTag.size()));
+    EXPECT_TRUE(equalsBytes(plaintext.data(), decrypted.data(), plaintext.size()));
+
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMReset(decryptor));
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMSetIV(decryptor, iv.data(), iv.size()));
+    ASSERT_EQ(kCCSuccess, CCCryptorGCMDecrypt(decryptor, expected.data(), expected.size(), decrypted.data()));
+    EXPECT_EQ(kCCDecodeError, CCCryptorGCMFinalize(decryptor, expectedTag.data(), expectedTag.size()));
+    CCCryptorRelease(decryptor);
+}
+/* CommonKeyDerivation tests */
+
+static std::string _hexFromBytes(const uint8_t* bytes, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string result;
+    for (size_t i = 0; i < length; ++i) {
+        result.push_back(digits[bytes[i] >> 4]);
+        result.push_back(digits[bytes[i] & 0xf]);
+    }
+    return result;
+}
+
+struct PBKDF2Vector {
+    CCPseudoRandomAlgorithm prf;
+    std::string password;
+    std::string salt;
+    unsigned rounds;
+    size_t derivedKeyLength;
+    const char* derivedKey;
+};
+
+class PBKDF2Test : public ::testing::TestWithParam<PBKDF2Vector> {};
+
+TEST_P(PBKDF2Test, KnownAnswer) {
+    const PBKDF2Vector& vector = GetParam();
+    std::vector<uint8_t> derivedKey(vector.derivedKeyLength);
+
+    ASSERT_EQ(kCCSuccess,
+              CCKeyDerivationPBKDF(kCCPBKDF2,
+                                   vector.password.data(),
+                                   vector.password.size(),
+                                   reinterpret_cast<const uint8_t*>(vector.salt.data()),
+                                   vector.salt.size(),
+                                   vector.prf,
+                                   vector.rounds,
+                                   derivedKey.data(),
+                                   derivedKey.size()));
+    EXPECT_EQ(vector.derivedKey, _hexFromBytes(derivedKey.data(), derivedKey.size()));
+}
+
+// clang-format off
+// RFC 6070 for SHA-1; the rest were generated with Python's hashlib.pbkdf2_hmac.
+INSTANTIATE_TEST_CASE_P(CommonKeyDerivation,
+                        PBKDF2Test,
+                        ::testing::Values(
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, "password", "salt", 1, 20, "0c60c80f961f0e71f3a9b524af6012062fe037a6" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, "password", "salt", 2, 20, "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, "password", "salt", 4096, 20, "4b007901b765489abead49d926f721d065a429c1" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25, "3d2eec4fe41c849b80c8d83662c0e44a8b291a964cf2f07038" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, std::string("pass\0word", 9), std::string("sa\0lt", 5), 4096, 16, "56fa6aa75548099dcc37d7f03425e0c3" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA224, "password", "salt", 4096, 28, "218c453bf90635bd0a21a75d172703ff6108ef603f65bb821aedade1" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA256, "password", "salt", 4096, 32, "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA256, "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 40, "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1c635518c7dac47e9" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA384, "password", "salt", 4096, 48, "559726be38db125bc85ed7895f6e3cf574c7a01c080c3447db1e8a76764deb3c307b94853fbe424f6488c5f4f1289626" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA512, "password", "salt", 4096, 64, "d197b1b33db0143e018b12f3d1d1479e6cdebdcc97c5c0f87f6902e072f457b5143f30602641b3d55cd335988cb36b84376060ecd532e039b742a239434af2d5" },
+                            PBKDF2Vector{ kCCPRFHmacAlgSHA1, std::string(200, 'p'), "", 3, 100, "0bb31e6e8d362600abea9c13ac06af68f60adb2e662fa34f3826a28be6bc0ac94811610449473316ae1055136e20dc0f9190add5b617f67e8bea5524779c84bb4d75eebaf229a70bdac485f05bf4486d5f44a691c389b2500216663ff4c7c42fc90e00f8" }));
+// clang-format on
+
+TEST(CommonKeyDerivation, InvalidParameters) {
+    uint8_t derivedKey[32];
+    const uint8_t salt[] = { 's', 'a', 'l', 't' };
+
+    EXPECT_EQ(kCCParamError, CCKeyDerivationPBKDF(1, "password", 8, salt, sizeof(salt), kCCPRFHmacAlgSHA256, 1000, derivedKey, sizeof(derivedKey)));
+    EXPECT_EQ(kCCParamError, CCKeyDerivationPBKDF(kCCPBKDF2, "password", 8, salt, sizeof(salt), 42, 1000, derivedKey, sizeof(derivedKey)));
+    EXPECT_EQ(kCCParamError, CCKeyDerivationPBKDF(kCCPBKDF2, "password", 8, salt, sizeof(salt), kCCPRFHmacAlgSHA256, 0, derivedKey, sizeof(derivedKey)));
+    EXPECT_EQ(kCCParamError, CCKeyDerivationPBKDF(kCCPBKDF2, "password", 8, salt, sizeof(salt), kCCPRFHmacAlgSHA256, 1000, nullptr, sizeof(derivedKey)));
+    EXPECT_EQ(kCCParamError, CCKeyDerivationPBKDF(kCCPBKDF2, nullptr, 8, salt, sizeof(salt), kCCPRFHmacAlgSHA256, 1000, derivedKey, sizeof(derivedKey)));
+}
+
+TEST(CommonKeyDerivation, CalibrateHonorsBudget) {
+    unsigned shortRounds = CCCalibratePBKDF(kCCPBKDF2, 12, 16, kCCPRFHmacAlgSHA256, 32, 20);
+    unsigned longRounds = CCCalibratePBKDF(kCCPBKDF2, 12, 16, kCCPRFHmacAlgSHA256, 32, 200);
+    ASSERT_GT(shortRounds, 0u);
+    ASSERT_GT(longRounds, shortRounds);
+
+    // The calibrated count should land within a generous factor of the budget, even on a busy test machine.
+    uint8_t derivedKey[32];
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(kCCSuccess,
+              CCKeyDerivationPBKDF(kCCPBKDF2, "password1234", 12, reinterpret_cast<const uint8_t*>("0123456789abcdef"), 16, kCCPRFHmacAlgSHA256, longRounds, derivedKey, sizeof(derivedKey)));
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GT(elapsed, 200 / 4.0);
+    EXPECT_LT(elapsed, 200 * 4.0);
+
+    EXPECT_EQ(static_cast<unsigned>(-1), CCCalibratePBKDF(kCCPBKDF2, 12, 16, 42, 32, 100));
+}
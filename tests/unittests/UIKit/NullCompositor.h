@@ -51,6 +51,15 @@ public:
                                                           CAMediaTimingProperties* timingProperties) override {
         return nullptr;
     }
+    std::shared_ptr<ILayerAnimation> CreateKeyframeAnimation(CAAnimation* animation,
+                                                             NSString* propertyName,
+                                                             NSArray* values,
+                                                             CAMediaTimingProperties* timingProperties) override {
+        return nullptr;
+    }
+    void AttachKeyframeAnimation(const std::shared_ptr<ILayerAnimation>& animation,
+                                 const std::shared_ptr<ILayerAnimation>& companion) override {
+    }
     std::shared_ptr<ILayerAnimation> CreateTransitionAnimation(CAAnimation* animation, NSString* type, NSString* subtype) override {
         return nullptr;
     }
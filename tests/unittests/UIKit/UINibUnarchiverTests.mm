@@ -0,0 +1,411 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+
+#import <windows.h>
+
+#import "UINibUnarchiver.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+// The item types of the nib archive format.
+enum NibItemType {
+    NibItemInt8 = 0x00,
+    NibItemInt16 = 0x01,
+    NibItemInt32 = 0x02,
+    NibItemInt64 = 0x03,
+    NibItemFalse = 0x04,
+    NibItemTrue = 0x05,
+    NibItemFloat = 0x06,
+    NibItemDouble = 0x07,
+    NibItemData = 0x08,
+    NibItemNull = 0x09,
+    NibItemUid = 0x0A,
+};
+
+struct NibItem {
+    std::string key;
+    int type;
+    std::vector<char> value;
+};
+
+template <typename T>
+static NibItem _scalarItem(const char* key, int type, T value) {
+    NibItem item = { key, type, std::vector<char>(sizeof(T)) };
+    memcpy(item.value.data(), &value, sizeof(T));
+    return item;
+}
+
+static NibItem _flagItem(const char* key, int type) {
+    return { key, type, std::vector<char>() };
+}
+
+static NibItem _dataItem(const char* key, const void* bytes, size_t length) {
+    const char* begin = static_cast<const char*>(bytes);
+    return { key, NibItemData, std::vector<char>(begin, begin + length) };
+}
+
+static NibItem _uidItem(const char* key, int uid) {
+    return _scalarItem<int32_t>(key, NibItemUid, uid);
+}
+
+// Assembles a nib archive laid out the way xib2nib writes one, so the tests need no nib files. Values are packed without
+// padding, so most of them are unaligned.
+class NibBuilder {
+public:
+    // Returns the uid of the object, which is the order it was added in; the first object is the root.
+    int AddObject(const char* className, const std::vector<NibItem>& items) {
+        _objects.push_back(
+            { _Index(_classNames, className), static_cast<unsigned int>(_items.size()), static_cast<unsigned int>(items.size()) });
+        for (const NibItem& item : items) {
+            _items.push_back({ _Index(_keyNames, item.key), item });
+        }
+        return static_cast<int>(_objects.size()) - 1;
+    }
+
+    NSData* Data() const {
+        std::vector<char> out(10 + sizeof(uint32_t) * 10);
+        memcpy(out.data(), "NIBArchive", 10);
+        uint32_t header[10] = { 1, 9 };
+
+        header[8] = static_cast<uint32_t>(_classNames.size());
+        header[9] = static_cast<uint32_t>(out.size());
+        for (const std::string& name : _classNames) {
+            size_t length = name.size() + 1;
+            out.push_back(static_cast<char>(length));
+            out.push_back(static_cast<char>(0x80));
+            if (length == 0x1b) {
+                out.insert(out.end(), 4, 0);
+            }
+            out.insert(out.end(), name.c_str(), name.c_str() + length);
+        }
+
+        header[4] = static_cast<uint32_t>(_keyNames.size());
+        header[5] = static_cast<uint32_t>(out.size());
+        for (const std::string& name : _keyNames) {
+            out.push_back(static_cast<char>(0x80 | name.size()));
+            out.insert(out.end(), name.begin(), name.end());
+        }
+
+        header[6] = static_cast<uint32_t>(_items.size());
+        header[7] = static_cast<uint32_t>(out.size());
+        for (const _Item& item : _items) {
+            out.push_back(static_cast<char>(0x80 | item.keyIndex));
+            out.push_back(static_cast<char>(item.item.type));
+            if (item.item.type == NibItemData) {
+                _AppendVarInt(out, static_cast<unsigned int>(item.item.value.size()));
+            }
+            out.insert(out.end(), item.item.value.begin(), item.item.value.end());
+        }
+
+        header[2] = static_cast<uint32_t>(_objects.size());
+        header[3] = static_cast<uint32_t>(out.size());
+        for (const _Object& object : _objects) {
+            out.push_back(static_cast<char>(0x80 | object.classIndex));
+            _AppendVarInt(out, object.itemStart);
+            _AppendVarInt(out, object.itemCount);
+        }
+
+        memcpy(&out[10], header, sizeof(header));
+        return [NSData dataWithBytes:out.data() length:out.size()];
+    }
+
+private:
+    struct _Item {
+        unsigned int keyIndex;
+        NibItem item;
+    };
+
+    struct _Object {
+        unsigned int classIndex;
+        unsigned int itemStart;
+        unsigned int itemCount;
+    };
+
+    static unsigned int _Index(std::vector<std::string>& names, const std::string& name) {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) {
+                return static_cast<unsigned int>(i);
+            }
+        }
+        names.push_back(name);
+        return static_cast<unsigned int>(names.size() - 1);
+    }
+
+    // Seven bits per byte, least significant first, with the top bit marking the last byte.
+    static void _AppendVarInt(std::vector<char>& out, unsigned int value) {
+        if (value >= 0x80) {
+            out.push_back(static_cast<char>(value & 0x7F));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(0x80 | value));
+    }
+
+    std::vector<std::string> _classNames;
+    std::vector<std::string> _keyNames;
+    std::vector<_Item> _items;
+    std::vector<_Object> _objects;
+};
+
+// Its 26-character name makes its class name entry take the padded form.
+@interface UINibUnarchiverTestsObject : NSObject
+@property (nonatomic) NSInteger value;
+@property (nonatomic) BOOL sawRootKey;
+@end
+
+@implementation UINibUnarchiverTestsObject
+- (instancetype)initWithCoder:(NSCoder*)coder {
+    if (self = [super init]) {
+        _value = [coder decodeIntForKey:@"value"];
+        _sawRootKey = [coder containsValueForKey:@"int8"];
+    }
+    return self;
+}
+@end
+
+static UINibUnarchiver* _createUnarchiver(const NibBuilder& builder) {
+    // The unarchiver is internal to UIKit, so it is looked up rather than linked against.
+    return [[NSClassFromString(@"UINibUnarchiver") alloc] initForReadingWithData:builder.Data()];
+}
+
+static void _addScalarItems(std::vector<NibItem>& items) {
+    items.push_back(_scalarItem<uint8_t>("int8", NibItemInt8, 200));
+    items.push_back(_scalarItem<uint16_t>("int16", NibItemInt16, 0xBEEF));
+    items.push_back(_scalarItem<uint32_t>("int32", NibItemInt32, 0x12345678));
+    items.push_back(_scalarItem<uint64_t>("int64", NibItemInt64, 0x1122334455667788ULL));
+    items.push_back(_flagItem("true", NibItemTrue));
+    items.push_back(_flagItem("false", NibItemFalse));
+    items.push_back(_scalarItem<float>("float", NibItemFloat, 1.5f));
+    items.push_back(_scalarItem<double>("double", NibItemDouble, 2.25));
+}
+
+static void _expectScalars(UINibUnarchiver* unarchiver) {
+    EXPECT_EQ(200, [unarchiver decodeIntForKey:@"int8"]);
+    EXPECT_EQ(0xBEEF, [unarchiver decodeIntegerForKey:@"int16"]);
+    EXPECT_EQ(0x12345678, [unarchiver decodeInt32ForKey:@"int32"]);
+
+    // 64-bit values are truncated.
+    EXPECT_EQ(0x55667788, [unarchiver decodeInt32ForKey:@"int64"]);
+
+    EXPECT_TRUE([unarchiver decodeBoolForKey:@"true"]);
+    EXPECT_FALSE([unarchiver decodeBoolForKey:@"false"]);
+    EXPECT_TRUE([unarchiver decodeBoolForKey:@"int8"]);
+    EXPECT_OBJCEQ(@YES, [unarchiver decodeObjectForKey:@"true"]);
+    EXPECT_OBJCEQ(@NO, [unarchiver decodeObjectForKey:@"false"]);
+
+    EXPECT_EQ(1.5f, [unarchiver decodeFloatForKey:@"float"]);
+    EXPECT_EQ(1.5, [unarchiver decodeDoubleForKey:@"float"]);
+    EXPECT_OBJCEQ(@1.5f, [unarchiver decodeObjectForKey:@"float"]);
+    EXPECT_EQ(2.25, [unarchiver decodeDoubleForKey:@"double"]);
+    EXPECT_EQ(2.25f, [unarchiver decodeFloatForKey:@"double"]);
+
+    for (NSString* key in @[ @"int8", @"int16", @"int32", @"int64", @"true", @"false", @"float", @"double" ]) {
+        EXPECT_TRUE([unarchiver containsValueForKey:key]) << [key UTF8String];
+    }
+}
+
+static void _expectMissing(UINibUnarchiver* unarchiver, NSString* key) {
+    EXPECT_FALSE([unarchiver containsValueForKey:key]) << [key UTF8String];
+    EXPECT_EQ(0, [unarchiver decodeInt32ForKey:key]) << [key UTF8String];
+    EXPECT_FALSE([unarchiver decodeBoolForKey:key]) << [key UTF8String];
+    EXPECT_EQ(0.0f, [unarchiver decodeFloatForKey:key]) << [key UTF8String];
+    EXPECT_EQ(0.0, [unarchiver decodeDoubleForKey:key]) << [key UTF8String];
+    EXPECT_EQ(nil, [unarchiver decodeObjectForKey:key]) << [key UTF8String];
+}
+
+TEST(UINibUnarchiver, DecodesScalarsFromSmallObject) {
+    // At most eight items are searched linearly.
+    std::vector<NibItem> items;
+    _addScalarItems(items);
+    ASSERT_EQ(8u, items.size());
+
+    NibBuilder builder;
+    builder.AddObject("NSObject", items);
+    UINibUnarchiver* unarchiver = _createUnarchiver(builder);
+    _expectScalars(unarchiver);
+    [unarchiver release];
+}
+
+TEST(UINibUnarchiver, DecodesScalarsFromLargeObject) {
+    // More than eight items are looked up through a hashed key table.
+    std::vector<NibItem> items;
+    for (int i = 0; i < 16; i++) {
+        items.push_back(_scalarItem<uint8_t>([[NSString stringWithFormat:@"filler%d", i] UTF8String], NibItemInt8, i));
+    }
+    _addScalarItems(items);
+
+    // A repeated key decodes as its first item, as it does from a small object.
+    items.push_back(_scalarItem<uint8_t>("int8", NibItemInt8, 1));
+
+    NibBuilder builder;
+    builder.AddObject("NSObject", items);
+    UINibUnarchiver* unarchiver = _createUnarchiver(builder);
+    _expectScalars(unarchiver);
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(i, [unarchiver decodeIntForKey:[NSString stringWithFormat:@"filler%d", i]]);
+    }
+    [unarchiver release];
+}
+
+TEST(UINibUnarchiver, MissingKeys) {
+    NibBuilder builder;
+    std::vector<NibItem> root;
+    _addScalarItems(root);
+    for (int i = 0; i < 8; i++) {
+        root.push_back(_flagItem([[NSString stringWithFormat:@"filler%d", i] UTF8String], NibItemTrue));
+    }
+    root.push_back(_uidItem("small", 1));
+    builder.AddObject("NSObject", root);
+    builder.AddObject("UINibUnarchiverTestsObject", { _scalarItem<uint8_t>("value", NibItemInt8, 7) });
+
+    UINibUnarchiver* unarchiver = _createUnarchiver(builder);
+
+    // A key the nib never uses, and one only another object uses, from a large object.
+    _expectMissing(unarchiver, @"absent");
+    _expectMissing(unarchiver, @"value");
+    _expectMissing(unarchiver, @"");
+
+    // The same, from a small object, with the root's keys as the ones only another object uses.
+    UINibUnarchiverTestsObject* small = static_cast<UINibUnarchiverTestsObject*>([unarchiver decodeObjectForKey:@"small"]);
+    ASSERT_OBJCNE(nil, small);
+    EXPECT_EQ(7, small.value);
+    EXPECT_FALSE(small.sawRootKey);
+
+    // Decoding the nested object restores the root as the object keys are looked up in.
+    EXPECT_EQ(200, [unarchiver decodeIntForKey:@"int8"]);
+    [unarchiver release];
+}
+
+TEST(UINibUnarchiver, DecodesObjects) {
+    NibBuilder builder;
+    builder.AddObject("NSObject",
+                      {
+                          _uidItem("array", 1),
+                          _uidItem("mutableArray", 2),
+                          _uidItem("dictionary", 3),
+                          _uidItem("mutableDictionary", 4),
+                          _uidItem("string", 5),
+                          _uidItem("mutableString", 6),
+                          _uidItem("localizableString", 7),
+                          _uidItem("data", 8),
+                          _uidItem("null", 9),
+                          _uidItem("coded", 10),
+                          _uidItem("sameString", 5),
+                          _flagItem("nilValue", NibItemNull),
+                          _dataItem("inlineData", "\x01\x02\x03", 3),
+                      });
+
+    // Items under any other key, such as NSInlinedValue, are not elements.
+    builder.AddObject("NSArray",
+                      {
+                          _flagItem("NSInlinedValue", NibItemTrue),
+                          _uidItem("UINibEncoderEmptyKey", 5),
+                          _scalarItem<float>("UINibEncoderEmptyKey", NibItemFloat, 0.5f),
+                          _flagItem("UINibEncoderEmptyKey", NibItemFalse),
+                      });
+
+    // Enough elements that the item indices past the array need two bytes.
+    std::vector<NibItem> elements = { _flagItem("NSInlinedValue", NibItemTrue) };
+    for (int i = 0; i < 150; i++) {
+        elements.push_back(_flagItem("UINibEncoderEmptyKey", NibItemTrue));
+    }
+    builder.AddObject("NSMutableArray", elements);
+
+    // The first item is NSInlinedValue, followed by alternating keys and values.
+    builder.AddObject("NSDictionary",
+                      {
+                          _flagItem("NSInlinedValue", NibItemTrue),
+                          _uidItem("UINibEncoderEmptyKey", 5),
+                          _scalarItem<float>("UINibEncoderEmptyKey", NibItemFloat, 3.0f),
+                          _uidItem("UINibEncoderEmptyKey", 8),
+                          _uidItem("UINibEncoderEmptyKey", 1),
+                      });
+    builder.AddObject("NSMutableDictionary",
+                      {
+                          _flagItem("NSInlinedValue", NibItemTrue),
+                          _uidItem("UINibEncoderEmptyKey", 6),
+                          _flagItem("UINibEncoderEmptyKey", NibItemTrue),
+                      });
+
+    const char* utf8 = "Caf\xC3\xA9";
+    builder.AddObject("NSString", { _dataItem("NS.bytes", utf8, strlen(utf8)) });
+    builder.AddObject("NSMutableString", { _dataItem("NS.bytes", "key", 3) });
+    builder.AddObject("NSLocalizableString", { _dataItem("NS.bytes", "Localized", 9) });
+
+    // Long enough that its length needs two bytes.
+    std::vector<char> bytes(300);
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = static_cast<char>(i);
+    }
+    builder.AddObject("NSData", { _dataItem("NS.bytes", bytes.data(), bytes.size()) });
+
+    // An empty class name decodes as NSNull.
+    builder.AddObject("", {});
+    builder.AddObject("UINibUnarchiverTestsObject", { _scalarItem<int32_t>("value", NibItemInt32, 70000) });
+
+    UINibUnarchiver* unarchiver = _createUnarchiver(builder);
+
+    NSString* string = [NSString stringWithUTF8String:utf8];
+    NSData* data = [NSData dataWithBytes:bytes.data() length:bytes.size()];
+    NSArray* array = static_cast<NSArray*>([unarchiver decodeObjectForKey:@"array"]);
+    EXPECT_OBJCEQ((@[ string, @0.5f, @NO ]), array);
+    EXPECT_FALSE([array isKindOfClass:[NSMutableArray class]]);
+
+    NSMutableArray* mutableArray = static_cast<NSMutableArray*>([unarchiver decodeObjectForKey:@"mutableArray"]);
+    ASSERT_EQ(150u, [mutableArray count]);
+    EXPECT_OBJCEQ(@YES, [mutableArray lastObject]);
+    [mutableArray addObject:@NO];
+
+    NSDictionary* dictionary = static_cast<NSDictionary*>([unarchiver decodeObjectForKey:@"dictionary"]);
+    EXPECT_OBJCEQ((@{ string : @3.0f, data : array }), dictionary);
+    EXPECT_FALSE([dictionary isKindOfClass:[NSMutableDictionary class]]);
+
+    NSMutableDictionary* mutableDictionary = static_cast<NSMutableDictionary*>([unarchiver decodeObjectForKey:@"mutableDictionary"]);
+    EXPECT_OBJCEQ((@{ @"key" : @YES }), mutableDictionary);
+    [mutableDictionary setObject:@NO forKey:@"other"];
+
+    EXPECT_OBJCEQ(string, [unarchiver decodeObjectForKey:@"string"]);
+    NSMutableString* mutableString = static_cast<NSMutableString*>([unarchiver decodeObjectForKey:@"mutableString"]);
+    EXPECT_OBJCEQ(@"key", mutableString);
+    [mutableString appendString:@"s"];
+    EXPECT_OBJCEQ(@"Localized", [unarchiver decodeObjectForKey:@"localizableString"]);
+    EXPECT_TRUE([[unarchiver decodeObjectForKey:@"localizableString"] isKindOfClass:[NSMutableString class]]);
+
+    EXPECT_OBJCEQ(data, [unarchiver decodeObjectForKey:@"data"]);
+    EXPECT_OBJCEQ([NSData dataWithBytes:"\x01\x02\x03" length:3], [unarchiver decodeObjectForKey:@"inlineData"]);
+
+    // NSNull and null items both decode as nil, but are present.
+    EXPECT_EQ(nil, [unarchiver decodeObjectForKey:@"null"]);
+    EXPECT_TRUE([unarchiver containsValueForKey:@"null"]);
+    EXPECT_EQ(nil, [unarchiver decodeObjectForKey:@"nilValue"]);
+    EXPECT_TRUE([unarchiver containsValueForKey:@"nilValue"]);
+
+    UINibUnarchiverTestsObject* coded = static_cast<UINibUnarchiverTestsObject*>([unarchiver decodeObjectForKey:@"coded"]);
+    ASSERT_TRUE([coded isKindOfClass:[UINibUnarchiverTestsObject class]]);
+    EXPECT_EQ(70000, coded.value);
+
+    // Every reference to an object decodes to the same instance.
+    EXPECT_EQ([unarchiver decodeObjectForKey:@"string"], [unarchiver decodeObjectForKey:@"sameString"]);
+    EXPECT_EQ([array objectAtIndex:0], [unarchiver decodeObjectForKey:@"string"]);
+    EXPECT_EQ(array, [dictionary objectForKey:data]);
+    EXPECT_EQ(coded, [unarchiver decodeObjectForKey:@"coded"]);
+
+    [unarchiver release];
+}
@@ -0,0 +1,95 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#import <TestFramework.h>
+#import <Foundation/Foundation.h>
+#import "UIReusePool.h"
+
+#include <vector>
+
+TEST(UIReusePool, InternedIdentifiersCompareByValue) {
+    UIReuseIdentifier literal = _UIInternReuseIdentifier(@"Cell");
+    EXPECT_NE(UIReuseIdentifierNone, literal);
+
+    // A different instance with the same contents, including a mutable one, shares the handle.
+    NSMutableString* mutableIdentifier = [NSMutableString stringWithString:@"Ce"];
+    [mutableIdentifier appendString:@"ll"];
+    EXPECT_EQ(literal, _UIInternReuseIdentifier(mutableIdentifier));
+    EXPECT_EQ(literal, _UIInternReuseIdentifier([NSString stringWithFormat:@"%@", @"Cell"]));
+
+    // Mutating the string afterwards must not leak the old handle to the new contents.
+    [mutableIdentifier appendString:@"2"];
+    UIReuseIdentifier other = _UIInternReuseIdentifier(mutableIdentifier);
+    EXPECT_NE(literal, other);
+    EXPECT_EQ(other, _UIInternReuseIdentifier(@"Cell2"));
+
+    EXPECT_EQ(UIReuseIdentifierNone, _UIInternReuseIdentifier(nil));
+    EXPECT_EQ(UIReuseIdentifierNone, _UIInternReuseIdentifier(@""));
+}
+
+TEST(UIReusePool, QueuesAreLastInFirstOutPerKindAndIdentifier) {
+    UIReusePool<int> pool;
+    UIReuseIdentifier cell = _UIInternReuseIdentifier(@"Cell");
+    UIReuseIdentifier header = _UIInternReuseIdentifier(@"Header");
+
+    EXPECT_TRUE(pool.Enqueue(cell, 1));
+    EXPECT_TRUE(pool.Enqueue(cell, 2));
+    EXPECT_TRUE(pool.Enqueue(cell, 3, header));
+    EXPECT_EQ(2, pool.GetCount(cell));
+    EXPECT_EQ(1, pool.GetCount(cell, header));
+
+    int item = 0;
+    EXPECT_TRUE(pool.Dequeue(cell, &item));
+    EXPECT_EQ(2, item);
+    EXPECT_TRUE(pool.Dequeue(cell, &item, header));
+    EXPECT_EQ(3, item);
+    EXPECT_FALSE(pool.Dequeue(header, &item));
+
+    EXPECT_TRUE(pool.Remove(cell, 1));
+    EXPECT_FALSE(pool.Remove(cell, 1));
+    EXPECT_FALSE(pool.Dequeue(cell, &item));
+}
+
+TEST(UIReusePool, MaximumCountLimitsAndTrims) {
+    UIReusePool<int> pool(2);
+    UIReuseIdentifier cell = _UIInternReuseIdentifier(@"Cell");
+
+    EXPECT_TRUE(pool.Enqueue(cell, 1));
+    EXPECT_TRUE(pool.Enqueue(cell, 2));
+    EXPECT_FALSE(pool.Enqueue(cell, 3));
+    EXPECT_EQ(2, pool.GetMaximumCount(cell));
+
+    std::vector<int> evicted;
+    pool.SetMaximumCount(cell, 5, [&evicted](int item) { evicted.push_back(item); });
+    EXPECT_TRUE(pool.Enqueue(cell, 3));
+    EXPECT_TRUE(pool.Enqueue(cell, 4));
+    EXPECT_TRUE(evicted.empty());
+
+    // Shrinking evicts the oldest items and keeps the most recently queued ones.
+    pool.SetMaximumCount(cell, 1, [&evicted](int item) { evicted.push_back(item); });
+    EXPECT_EQ((std::vector<int>{ 1, 2, 3 }), evicted);
+    EXPECT_EQ(1, pool.GetCount(cell));
+
+    int item = 0;
+    EXPECT_TRUE(pool.Dequeue(cell, &item));
+    EXPECT_EQ(4, item);
+
+    // Clearing keeps the per-queue maximum.
+    pool.Enqueue(cell, 5);
+    pool.Clear();
+    EXPECT_EQ(0, pool.GetCount(cell));
+    EXPECT_EQ(1, pool.GetMaximumCount(cell));
+}
@@ -0,0 +1,260 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+#pragma once
+
+#include "LoggingNative.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Performance instrumentation: spans, which time a scope, and counters, which accumulate values.
+//
+// Code is instrumented with the INSTRUMENT_* macros below. Each macro names its site with a category and a name; sites
+// with the same category and name are aggregated together. Spans nest: a span's self time excludes the spans that ran
+// inside it on the same thread.
+//
+// Nothing is recorded until instrumentation is enabled. While it is disabled, each site costs one load and one branch on
+// g_instrumentationEnabled; a span also tests a local, which is always false, when its scope exits. Defining
+// INSTRUMENTATION_ENABLED to 0 removes the sites entirely.
+//
+// Recording is per thread and takes no locks. Aggregates can be read at any time with InstrumentationSnapshot or
+// written out with InstrumentationWriteHistograms; InstrumentationStartTrace additionally captures every span and counter
+// update to a Chrome trace event file, which chrome://tracing and similar viewers load.
+//
+
+#ifndef INSTRUMENTATION_ENABLED
+#define INSTRUMENTATION_ENABLED 1
+#endif
+
+// Histogram bucket i counts spans that lasted [2^i, 2^(i+1)) nanoseconds, or counter updates of that size. The first
+// bucket also holds anything shorter and the last anything longer.
+#define INSTRUMENTATION_HISTOGRAM_BUCKETS 40
+
+typedef enum {
+    InstrumentationKindSpan = 1,
+    InstrumentationKindCounter = 2,
+} InstrumentationKind;
+
+//
+// Aggregates for one site, across every thread that has recorded to it.
+//
+typedef struct {
+    const char* category;
+    const char* name;
+    InstrumentationKind kind;
+
+    // Spans: how many have ended. Counters: how many updates there have been.
+    uint64_t count;
+
+    // Spans: total time, in nanoseconds. Counters: the sum of all updates.
+    int64_t total;
+
+    // Spans: total time, in nanoseconds, not spent in nested spans. Counters: the same as total.
+    int64_t self;
+
+    // Spans: the longest, in nanoseconds. Counters: the largest update.
+    int64_t max;
+
+    uint64_t histogram[INSTRUMENTATION_HISTOGRAM_BUCKETS];
+} InstrumentationEntry;
+
+//
+// Whether instrumentation records anything. Read by every instrumented site; change it with InstrumentationSetEnabled.
+//
+LOGGING_EXPORT volatile bool g_instrumentationEnabled;
+
+//
+// Enables or disables recording. Instrumentation is disabled by default.
+// Aggregates recorded so far are kept while disabled.
+//
+LOGGING_EXPORT void InstrumentationSetEnabled(bool enabled);
+
+//
+// Returns the id of the site with the given category and name, registering it on first use.
+// The strings must remain valid for the life of the process. The INSTRUMENT_* macros call this once per site.
+//
+// Returns 0 if no more sites can be registered; recording to site 0 does nothing.
+//
+LOGGING_EXPORT unsigned int InstrumentationRegisterSite(const char* category, const char* name, InstrumentationKind kind);
+
+//
+// Returns the current time in the units span functions take.
+//
+LOGGING_EXPORT int64_t InstrumentationTimestamp();
+
+//
+// Begins a span on the calling thread and returns its start time. Every call must be paired with
+// InstrumentationEndSpan on the same thread, innermost span first.
+//
+LOGGING_EXPORT int64_t InstrumentationBeginSpan(unsigned int site);
+
+//
+// Ends the innermost span begun on the calling thread.
+//
+// site - the site given to InstrumentationBeginSpan.
+// start - the time InstrumentationBeginSpan returned.
+//
+LOGGING_EXPORT void InstrumentationEndSpan(unsigned int site, int64_t start);
+
+//
+// Records a span that started at the given time, possibly on another thread, and ends now. It does not nest: it is not
+// counted against the self time of any span open on the calling thread. Used to measure waits, such as the time an
+// operation spent queued.
+//
+// site - the site to record to.
+// start - a time returned by InstrumentationTimestamp.
+//
+LOGGING_EXPORT void InstrumentationRecordSpan(unsigned int site, int64_t start);
+
+//
+// Adds value to a counter.
+//
+LOGGING_EXPORT void InstrumentationAddCounter(unsigned int site, int64_t value);
+
+//
+// Copies the aggregates of up to capacity sites into entries, in the order the sites were registered.
+// Safe to call at any time, from any thread; values recorded concurrently may or may not be included.
+//
+// Returns the number of registered sites, which may be larger than capacity.
+//
+LOGGING_EXPORT size_t InstrumentationSnapshot(InstrumentationEntry* entries, size_t capacity);
+
+//
+// Writes a table of every site's aggregates, with percentiles estimated from its histogram, to the given file as UTF-8.
+//
+// path - the file to write, or nullptr for stderr.
+//
+// Returns false if the file could not be opened.
+//
+LOGGING_EXPORT bool InstrumentationWriteHistograms(const wchar_t* path);
+
+//
+// Starts capturing a Chrome trace event file, enabling instrumentation until InstrumentationStopTrace.
+// Each thread records its spans and counter updates into its own lock-free ring buffer; a background thread writes them
+// out. Events are dropped, rather than blocking the instrumented thread, when its ring buffer is full.
+//
+// path - the file to write. Any existing file is replaced.
+//
+// Returns false if a trace is already being captured or the file could not be opened.
+//
+LOGGING_EXPORT bool InstrumentationStartTrace(const wchar_t* path);
+
+//
+// Stops capturing the trace, writing out any events still buffered, and restores the enabled state from before
+// InstrumentationStartTrace.
+//
+LOGGING_EXPORT void InstrumentationStopTrace();
+
+#ifdef __cplusplus
+
+namespace Instrumentation {
+
+// Times the scope it is declared in. Use INSTRUMENT_SPAN rather than declaring one directly.
+class ScopedSpan {
+public:
+    // getSite returns the site id; it is only called, and the site only registered, while instrumentation is enabled.
+    template <typename TGetSite>
+    explicit ScopedSpan(TGetSite getSite) : _site(0), _start(0) {
+        if (g_instrumentationEnabled) {
+            _site = getSite();
+            if (_site) {
+                _start = InstrumentationBeginSpan(_site);
+            }
+        }
+    }
+
+    ~ScopedSpan() {
+        if (_site) {
+            InstrumentationEndSpan(_site, _start);
+        }
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    unsigned int _site;
+    int64_t _start;
+};
+
+} // namespace Instrumentation
+
+#define INSTRUMENTATION_CONCAT_INNER(left, right) left##right
+#define INSTRUMENTATION_CONCAT(left, right) INSTRUMENTATION_CONCAT_INNER(left, right)
+
+#if INSTRUMENTATION_ENABLED
+
+//
+// Times the rest of the enclosing scope as a span.
+//
+// category - a string literal grouping related sites, such as the framework.
+// name - a string literal naming the site within its category.
+//
+#define INSTRUMENT_SPAN(category, name)                                                                                    \
+    ::Instrumentation::ScopedSpan INSTRUMENTATION_CONCAT(_instrumentationSpan, __LINE__)([]() {                            \
+        static const unsigned int s_site = InstrumentationRegisterSite((category), (name), InstrumentationKindSpan);       \
+        return s_site;                                                                                                     \
+    })
+
+//
+// Adds value to a counter.
+//
+#define INSTRUMENT_COUNTER_ADD(category, name, value)                                                                      \
+    do {                                                                                                                   \
+        if (g_instrumentationEnabled) {                                                                                    \
+            static const unsigned int s_site = InstrumentationRegisterSite((category), (name), InstrumentationKindCounter); \
+            InstrumentationAddCounter(s_site, (value));                                                                    \
+        }                                                                                                                  \
+    } while (0)
+
+//
+// Evaluates to the current time while instrumentation is enabled, and to 0 otherwise. Pass the result to
+// INSTRUMENT_SPAN_SINCE, on any thread, to record the time since.
+//
+#define INSTRUMENT_TIMESTAMP() (g_instrumentationEnabled ? InstrumentationTimestamp() : static_cast<int64_t>(0))
+
+//
+// Records a span from start, a value of INSTRUMENT_TIMESTAMP, until now. Does nothing if start is 0. start is only
+// evaluated while instrumentation is enabled.
+//
+#define INSTRUMENT_SPAN_SINCE(category, name, start)                                                                       \
+    do {                                                                                                                   \
+        if (g_instrumentationEnabled) {                                                                                    \
+            int64_t _instrumentationStart = (start);                                                                       \
+            if (_instrumentationStart != 0) {                                                                              \
+                static const unsigned int s_site = InstrumentationRegisterSite((category), (name), InstrumentationKindSpan); \
+                InstrumentationRecordSpan(s_site, _instrumentationStart);                                                  \
+            }                                                                                                              \
+        }                                                                                                                  \
+    } while (0)
+
+#else
+
+#define INSTRUMENT_SPAN(category, name) \
+    do {                                \
+    } while (0)
+#define INSTRUMENT_COUNTER_ADD(category, name, value) \
+    do {                                              \
+    } while (0)
+#define INSTRUMENT_TIMESTAMP() static_cast<int64_t>(0)
+#define INSTRUMENT_SPAN_SINCE(category, name, start) \
+    do {                                             \
+    } while (0)
+
+#endif
+
+#endif
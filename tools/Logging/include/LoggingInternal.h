@@ -46,6 +46,23 @@ TRACELOGGING_DECLARE_PROVIDER(s_traceLoggingProvider);
 
 const unsigned int c_bufferCount = 1024;
 
+// Returns whether any listener other than the buffered sink wants messages at LEVEL. Debug builds always print to the
+// debug output window, so every level is wanted there.
+#ifdef _DEBUG
+#define _IS_SYNCHRONOUS_TRACE_ENABLED(LEVEL) true
+#else
+#define _IS_SYNCHRONOUS_TRACE_ENABLED(LEVEL) (g_isTestHookEnabled || TraceLoggingProviderEnabled(s_traceLoggingProvider, (LEVEL), 0))
+#endif
+
+// Returns whether messages with tag have not been disabled with TraceSetTagEnabled.
+bool _isTraceTagEnabled(const wchar_t* tag);
+
+// Returns whether the buffered sink is running and records messages at level.
+bool _isBufferedTraceEnabled(unsigned char level);
+
+// Records a message in the calling thread's ring buffer, capturing the arguments that format consumes from va.
+void _bufferedTrace(unsigned char level, const wchar_t* tag, const wchar_t* format, va_list va);
+
 // Print to debug output window using va_list
 void _vdebugPrintf(const wchar_t* format, va_list va);
 
@@ -93,3 +110,16 @@ void _debugPrintf(const wchar_t* format, ...);
     _debugPrintf(TRACE_FORMAT_NARROW, (LABEL), (TAG), narrowBuf);         \
     _V_ETL_TRACE((LEVEL), (TAG), narrowBuf)                               \
     _V_ETL_NARROW_TEST_HOOK((LEVEL), (TAG), narrowBuf)
+
+// Trace to every listener that wants messages at LEVEL, formatting only for the synchronous ones.
+// Callers have already checked the tag.
+#define _V_TRACE(LEVEL, LABEL, TAG, FMT, VA)                   \
+    if (_isBufferedTraceEnabled((LEVEL))) {                    \
+        va_list bufferedArgs;                                  \
+        va_copy(bufferedArgs, (VA));                           \
+        _bufferedTrace((LEVEL), (TAG), (FMT), bufferedArgs);   \
+        va_end(bufferedArgs);                                  \
+    }                                                          \
+    if (_IS_SYNCHRONOUS_TRACE_ENABLED((LEVEL))) {              \
+        _V_TRACE_WIDE((LEVEL), (LABEL), (TAG), (FMT), (VA))    \
+    }
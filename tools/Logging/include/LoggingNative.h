@@ -27,6 +27,21 @@
 #endif
 #endif
 
+#ifndef __cplusplus
+#include <stdbool.h>
+#endif
+
+//
+// Trace levels, in order of decreasing severity. These match the WINEVENT_LEVEL_* values used for ETW.
+//
+typedef enum {
+    TraceLevelCritical = 1,
+    TraceLevelError = 2,
+    TraceLevelWarning = 3,
+    TraceLevelInfo = 4,
+    TraceLevelVerbose = 5,
+} TraceLevel;
+
 //
 // Trace a verbose message.
 // Verbose messages log the behavior of "normal" or succesful operations.
@@ -86,3 +101,45 @@ LOGGING_EXPORT void TraceRegister();
 // Ensures the trace logging provider is unregistered.
 //
 LOGGING_EXPORT void TraceUnregister();
+
+//
+// Returns whether a message traced at level under tag would reach any listener.
+// The Trace* functions perform this check themselves before formatting anything; callers only need it to avoid
+// computing expensive arguments.
+//
+// level - the TraceLevel of the message.
+// tag - the tag the message would be given.
+//
+LOGGING_EXPORT bool TraceIsEnabled(TraceLevel level, const wchar_t* tag);
+
+//
+// Enables or disables all messages with the given tag, for every listener.
+// Tags are enabled by default.
+//
+// tag - the tag to enable or disable.
+// enabled - whether messages with this tag are traced.
+//
+LOGGING_EXPORT void TraceSetTagEnabled(const wchar_t* tag, bool enabled);
+
+//
+// Starts the buffered trace sink.
+// While it runs, each thread records messages at or above level into its own lock-free ring buffer as the raw format
+// string and arguments. A background thread formats them and writes them, as UTF-8, to the given file.
+// Messages are dropped, rather than blocking the tracing thread, when its ring buffer is full.
+//
+// path - the file to append to, or nullptr for stderr.
+// level - the least severe TraceLevel to record.
+//
+// Returns false if the sink is already running or the file could not be opened.
+//
+LOGGING_EXPORT bool TraceStartBufferedSink(const wchar_t* path, TraceLevel level);
+
+//
+// Waits until every message buffered before this call has been written.
+//
+LOGGING_EXPORT void TraceFlushBufferedSink();
+
+//
+// Stops the buffered trace sink, writing out any messages it still holds.
+//
+LOGGING_EXPORT void TraceStopBufferedSink();
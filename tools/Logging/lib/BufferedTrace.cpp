@@ -0,0 +1,867 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// The buffered trace sink.
+//
+// Tracing threads never format anything. Each one appends records to its own single-producer, single-consumer ring buffer:
+// a header, copies of the tag and format string, and the arguments the format consumes (strings copied, everything else
+// stored as 8 raw bytes). A drainer thread copies records out, orders them by timestamp, and formats each conversion
+// specification against its captured argument.
+
+#include "LoggingNative.h"
+#include "LoggingInternal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <share.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include <windows.h>
+
+namespace {
+
+// Per-thread ring buffer size. Must be a power of two.
+const size_t c_ringCapacity = 128 * 1024;
+
+// Records larger than this are dropped rather than allowed to monopolize a ring.
+const size_t c_maxRecordSize = c_ringCapacity / 4;
+
+const size_t c_maxTagLength = 256;
+const size_t c_maxFormatLength = 2048;
+
+// Captured strings are truncated to what the synchronous listeners would print.
+const size_t c_maxStringLength = c_bufferCount - 1;
+
+// How often the drainer wakes up when nobody asks it to.
+const std::chrono::milliseconds c_drainInterval(50);
+
+enum class ArgType : uint32_t {
+    Invalid,
+    Int32,
+    Int64,
+    IntPtr,
+    Double,
+    Pointer,
+    NarrowString,
+    WideString,
+    Count,
+};
+
+// A parsed conversion specification: %[flags][width][.precision][size]type, with MSVC's wide printf conventions.
+struct FormatSpec {
+    const wchar_t* flags;
+    size_t flagsLength;
+    const wchar_t* width;
+    size_t widthLength;
+    bool widthFromArg;
+    bool hasPrecision;
+    const wchar_t* precision;
+    size_t precisionLength;
+    bool precisionFromArg;
+    const wchar_t* sizeAndType;
+    size_t sizeAndTypeLength;
+    ArgType type;
+};
+
+// Parses the specification that starts just after a '%'. Returns the character after it; spec->type is ArgType::Invalid
+// for anything this sink does not understand.
+const wchar_t* _parseFormatSpec(const wchar_t* cur, FormatSpec* spec) {
+    memset(spec, 0, sizeof(*spec));
+
+    spec->flags = cur;
+    while (*cur && wcschr(L"-+0 #", *cur)) {
+        cur++;
+    }
+    spec->flagsLength = cur - spec->flags;
+
+    spec->width = cur;
+    if (*cur == L'*') {
+        spec->widthFromArg = true;
+        cur++;
+    } else {
+        while (iswdigit(*cur)) {
+            cur++;
+        }
+    }
+    spec->widthLength = cur - spec->width;
+
+    if (*cur == L'.') {
+        spec->hasPrecision = true;
+        spec->precision = ++cur;
+        if (*cur == L'*') {
+            spec->precisionFromArg = true;
+            cur++;
+        } else {
+            while (iswdigit(*cur)) {
+                cur++;
+            }
+        }
+        spec->precisionLength = cur - spec->precision;
+    }
+
+    enum { SizeDefault, SizeShort, SizeLong, Size64, SizePtr } size = SizeDefault;
+    spec->sizeAndType = cur;
+    if (cur[0] == L'h') {
+        size = SizeShort;
+        cur += (cur[1] == L'h') ? 2 : 1;
+    } else if (cur[0] == L'l' && cur[1] == L'l') {
+        size = Size64;
+        cur += 2;
+    } else if (cur[0] == L'l' || cur[0] == L'w') {
+        size = SizeLong;
+        cur++;
+    } else if (cur[0] == L'I' && cur[1] == L'6' && cur[2] == L'4') {
+        size = Size64;
+        cur += 3;
+    } else if (cur[0] == L'I' && cur[1] == L'3' && cur[2] == L'2') {
+        size = SizeDefault;
+        cur += 3;
+    } else if (cur[0] == L'I' || cur[0] == L'z' || cur[0] == L't') {
+        size = SizePtr;
+        cur++;
+    } else if (cur[0] == L'j') {
+        size = Size64;
+        cur++;
+    } else if (cur[0] == L'L') {
+        cur++;
+    }
+
+    spec->type = ArgType::Invalid;
+    switch (*cur) {
+        case L'd':
+        case L'i':
+        case L'o':
+        case L'u':
+        case L'x':
+        case L'X':
+            spec->type = (size == Size64) ? ArgType::Int64 : (size == SizePtr) ? ArgType::IntPtr : ArgType::Int32;
+            break;
+        case L'c':
+        case L'C':
+            spec->type = ArgType::Int32;
+            break;
+        case L'e':
+        case L'E':
+        case L'f':
+        case L'F':
+        case L'g':
+        case L'G':
+        case L'a':
+        case L'A':
+            spec->type = ArgType::Double;
+            break;
+        case L'p':
+            spec->type = ArgType::Pointer;
+            break;
+        case L'n':
+            spec->type = ArgType::Count;
+            break;
+        case L's':
+            // In wide printf functions, %s is a wide string and %S a narrow one unless a size says otherwise.
+            spec->type = (size == SizeShort) ? ArgType::NarrowString : ArgType::WideString;
+            break;
+        case L'S':
+            spec->type = (size == SizeLong) ? ArgType::WideString : ArgType::NarrowString;
+            break;
+    }
+
+    if (*cur) {
+        cur++;
+    }
+    spec->sizeAndTypeLength = cur - spec->sizeAndType;
+    return cur;
+}
+
+size_t _align8(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+// A record in a ring buffer. The tag and format follow it, NUL-terminated, then the captured arguments, each starting on an
+// 8 byte boundary. Only the first 8 bytes are written when a record with level 0 pads the ring out to its end, since that
+// may be all the space there is.
+struct RecordHeader {
+    uint32_t size;
+    uint8_t level;
+    uint8_t reserved;
+    uint16_t tagLength;
+    uint32_t formatLength;
+    uint32_t threadId;
+    int64_t timestamp;
+};
+
+// The part of a header present in every record, padding included.
+const size_t c_recordPrefixSize = 8;
+static_assert(offsetof(RecordHeader, tagLength) + sizeof(uint16_t) == c_recordPrefixSize, "Record size and level must lead the header");
+
+struct ArgHeader {
+    ArgType type;
+    // Bytes of payload that follow: 8 for scalars, and for strings the characters plus a NUL, or 0 for a null pointer.
+    uint32_t length;
+};
+
+class TraceRing {
+public:
+    TraceRing() : _data(new uint8_t[c_ringCapacity]), _head(0), _tail(0), _dropped(0), _abandoned(false) {
+    }
+
+    // Producer side. Returns false, and counts the record as dropped, if it does not fit.
+    bool Write(const uint8_t* record, size_t size) {
+        if (size > c_maxRecordSize) {
+            Drop();
+            return false;
+        }
+
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        uint64_t tail = _tail.load(std::memory_order_acquire);
+        size_t offset = static_cast<size_t>(head & (c_ringCapacity - 1));
+        size_t contiguous = c_ringCapacity - offset;
+        size_t needed = (contiguous < size) ? contiguous + size : size;
+
+        if (head + needed - tail > c_ringCapacity) {
+            Drop();
+            return false;
+        }
+
+        if (contiguous < size) {
+            uint8_t padding[c_recordPrefixSize] = {};
+            uint32_t paddingSize = static_cast<uint32_t>(contiguous);
+            memcpy(padding, &paddingSize, sizeof(paddingSize));
+            memcpy(_data.get() + offset, padding, sizeof(padding));
+            head += contiguous;
+            offset = 0;
+        }
+
+        memcpy(_data.get() + offset, record, size);
+        _head.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    // Whether the ring is more than half full, so the drainer should not wait for its next interval.
+    bool IsFilling() const {
+        return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed) > c_ringCapacity / 2;
+    }
+
+    // Consumer side. Appends every committed record to out, each starting at an 8 byte aligned offset.
+    void Read(std::vector<uint8_t>& out, std::vector<size_t>& offsets) {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+
+        while (tail != head) {
+            const uint8_t* record = _data.get() + static_cast<size_t>(tail & (c_ringCapacity - 1));
+            uint32_t size;
+            memcpy(&size, record, sizeof(size));
+            if (record[offsetof(RecordHeader, level)] != 0) {
+                offsets.push_back(out.size());
+                out.insert(out.end(), record, record + size);
+            }
+            tail += size;
+        }
+
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    bool IsEmpty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_relaxed);
+    }
+
+    void Drop() {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t TakeDropped() {
+        return _dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    void Abandon() {
+        _abandoned.store(true, std::memory_order_release);
+    }
+
+    bool IsAbandoned() const {
+        return _abandoned.load(std::memory_order_acquire);
+    }
+
+    // Scratch space for the record being captured; only touched by the producer.
+    std::vector<uint8_t> scratch;
+
+private:
+    std::unique_ptr<uint8_t[]> _data;
+    std::atomic<uint64_t> _head;
+    std::atomic<uint64_t> _tail;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _abandoned;
+};
+
+// Rings of every thread that has traced while the sink was running. Only registration and the drainer take the lock.
+std::mutex s_ringsLock;
+std::vector<std::shared_ptr<TraceRing>> s_rings;
+
+// Gives the ring back to the drainer when its thread exits, so that its last records are still written.
+struct ThreadRing {
+    ~ThreadRing() {
+        if (ring) {
+            ring->Abandon();
+        }
+    }
+
+    TraceRing* Get() {
+        if (!ring) {
+            ring = std::make_shared<TraceRing>();
+            std::lock_guard<std::mutex> lock(s_ringsLock);
+            s_rings.push_back(ring);
+        }
+        return ring.get();
+    }
+
+    std::shared_ptr<TraceRing> ring;
+};
+
+thread_local ThreadRing t_ring;
+
+// 0 while the sink is stopped; otherwise the least severe level it records.
+std::atomic<unsigned char> s_level(0);
+
+// Guards everything below, which belongs to the running sink.
+std::mutex s_sinkLock;
+std::condition_variable s_sinkWake;
+std::condition_variable s_sinkFlushed;
+std::thread s_drainer;
+FILE* s_output = nullptr;
+bool s_ownsOutput = false;
+bool s_stopping = false;
+bool s_wakeRequested = false;
+uint64_t s_flushRequested = 0;
+uint64_t s_flushCompleted = 0;
+LARGE_INTEGER s_startTime;
+LARGE_INTEGER s_frequency;
+
+void _appendBytes(std::vector<uint8_t>& record, const void* bytes, size_t length) {
+    const uint8_t* begin = static_cast<const uint8_t*>(bytes);
+    record.insert(record.end(), begin, begin + length);
+}
+
+void _appendPadding(std::vector<uint8_t>& record) {
+    record.resize(_align8(record.size()), 0);
+}
+
+void _appendScalar(std::vector<uint8_t>& record, ArgType type, uint64_t bits) {
+    ArgHeader arg = { type, sizeof(bits) };
+    _appendBytes(record, &arg, sizeof(arg));
+    _appendBytes(record, &bits, sizeof(bits));
+}
+
+template <typename TChar>
+void _appendString(std::vector<uint8_t>& record, ArgType type, const TChar* value, size_t maxLength) {
+    size_t length = 0;
+    if (value) {
+        while (length < maxLength && value[length]) {
+            length++;
+        }
+    }
+
+    ArgHeader arg = { type, value ? static_cast<uint32_t>((length + 1) * sizeof(TChar)) : 0 };
+    _appendBytes(record, &arg, sizeof(arg));
+    if (value) {
+        _appendBytes(record, value, length * sizeof(TChar));
+        TChar terminator = 0;
+        _appendBytes(record, &terminator, sizeof(terminator));
+    }
+    _appendPadding(record);
+}
+
+// Reads a numeric width or precision given by the format itself, or -1 if there is none.
+int _parseFieldValue(const wchar_t* text, size_t length) {
+    if (length == 0) {
+        return -1;
+    }
+
+    int value = 0;
+    for (size_t i = 0; i < length; i++) {
+        value = value * 10 + (text[i] - L'0');
+    }
+    return value;
+}
+
+// Captures the arguments format consumes from va, in order. Stops at the first specification it does not understand;
+// the drainer prints the rest of the format as it stands.
+void _captureArgs(std::vector<uint8_t>& record, const wchar_t* format, va_list va) {
+    const wchar_t* cur = format;
+    while ((cur = wcschr(cur, L'%')) != nullptr) {
+        if (cur[1] == L'%') {
+            cur += 2;
+            continue;
+        }
+
+        FormatSpec spec;
+        cur = _parseFormatSpec(cur + 1, &spec);
+        if (spec.type == ArgType::Invalid) {
+            return;
+        }
+
+        if (spec.widthFromArg) {
+            _appendScalar(record, ArgType::Int32, static_cast<uint64_t>(static_cast<int64_t>(va_arg(va, int))));
+        }
+
+        int precision = -1;
+        if (spec.precisionFromArg) {
+            precision = va_arg(va, int);
+            _appendScalar(record, ArgType::Int32, static_cast<uint64_t>(static_cast<int64_t>(precision)));
+        } else if (spec.hasPrecision) {
+            precision = std::max(_parseFieldValue(spec.precision, spec.precisionLength), 0);
+        }
+
+        // A precision bounds how much of a string printf reads, so the string need not be terminated within it.
+        size_t maxLength = (precision >= 0) ? std::min(static_cast<size_t>(precision), c_maxStringLength) : c_maxStringLength;
+
+        switch (spec.type) {
+            case ArgType::Int32:
+                _appendScalar(record, spec.type, static_cast<uint64_t>(static_cast<int64_t>(va_arg(va, int))));
+                break;
+            case ArgType::Int64:
+                _appendScalar(record, spec.type, static_cast<uint64_t>(va_arg(va, long long)));
+                break;
+            case ArgType::IntPtr:
+                _appendScalar(record, spec.type, static_cast<uint64_t>(va_arg(va, intptr_t)));
+                break;
+            case ArgType::Double: {
+                double value = va_arg(va, double);
+                uint64_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                _appendScalar(record, spec.type, bits);
+                break;
+            }
+            case ArgType::Pointer:
+            case ArgType::Count:
+                _appendScalar(record, spec.type, reinterpret_cast<uintptr_t>(va_arg(va, void*)));
+                break;
+            case ArgType::NarrowString:
+                _appendString(record, spec.type, va_arg(va, const char*), maxLength);
+                break;
+            case ArgType::WideString:
+                _appendString(record, spec.type, va_arg(va, const wchar_t*), maxLength);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Walks the arguments captured after a record's format string.
+class ArgReader {
+public:
+    ArgReader(const uint8_t* cur, const uint8_t* end) : _cur(cur), _end(end) {
+    }
+
+    // Returns false if the record holds no further arguments of the given type.
+    bool Next(ArgType type, ArgHeader* arg, const uint8_t** payload) {
+        if (_end - _cur < static_cast<ptrdiff_t>(sizeof(ArgHeader))) {
+            return false;
+        }
+
+        memcpy(arg, _cur, sizeof(*arg));
+        if (arg->type != type) {
+            return false;
+        }
+
+        *payload = _cur + sizeof(*arg);
+        _cur += _align8(sizeof(*arg) + arg->length);
+        return true;
+    }
+
+    bool NextScalar(ArgType type, uint64_t* bits) {
+        ArgHeader arg;
+        const uint8_t* payload;
+        if (!Next(type, &arg, &payload)) {
+            return false;
+        }
+        memcpy(bits, payload, sizeof(*bits));
+        return true;
+    }
+
+private:
+    const uint8_t* _cur;
+    const uint8_t* _end;
+};
+
+// Formats a captured record's message into message.
+void _formatMessage(std::wstring& message, const wchar_t* format, ArgReader& args) {
+    wchar_t buffer[c_bufferCount];
+    const wchar_t* cur = format;
+
+    while (*cur) {
+        const wchar_t* percent = wcschr(cur, L'%');
+        if (!percent) {
+            message.append(cur);
+            return;
+        }
+
+        message.append(cur, percent);
+        cur = percent;
+        if (percent[1] == L'%') {
+            message.push_back(L'%');
+            cur = percent + 2;
+            continue;
+        }
+
+        FormatSpec spec;
+        const wchar_t* next = _parseFormatSpec(percent + 1, &spec);
+
+        // Rebuild the specification with any '*' replaced by the captured value.
+        std::wstring rebuilt(L"%");
+        rebuilt.append(spec.flags, spec.flagsLength);
+
+        uint64_t bits = 0;
+        if (spec.widthFromArg) {
+            if (!args.NextScalar(ArgType::Int32, &bits)) {
+                break;
+            }
+            int width = static_cast<int>(bits);
+            if (width < 0) {
+                rebuilt.push_back(L'-');
+                width = -width;
+            }
+            rebuilt.append(std::to_wstring(width));
+        } else {
+            rebuilt.append(spec.width, spec.widthLength);
+        }
+
+        if (spec.precisionFromArg) {
+            if (!args.NextScalar(ArgType::Int32, &bits)) {
+                break;
+            }
+            int precision = static_cast<int>(bits);
+            if (precision >= 0) {
+                rebuilt.push_back(L'.');
+                rebuilt.append(std::to_wstring(precision));
+            }
+        } else if (spec.hasPrecision) {
+            rebuilt.push_back(L'.');
+            rebuilt.append(spec.precision, spec.precisionLength);
+        }
+
+        ArgHeader arg;
+        const uint8_t* payload = nullptr;
+        if (spec.type == ArgType::Invalid || !args.Next(spec.type, &arg, &payload)) {
+            break;
+        }
+
+        if (spec.type == ArgType::NarrowString) {
+            rebuilt.append(L"hs");
+        } else if (spec.type == ArgType::WideString) {
+            rebuilt.append(L"ls");
+        } else {
+            rebuilt.append(spec.sizeAndType, spec.sizeAndTypeLength);
+            memcpy(&bits, payload, sizeof(bits));
+        }
+
+        int written = 0;
+        switch (spec.type) {
+            case ArgType::Int32:
+                written = _snwprintf_s(buffer, _countof(buffer), _TRUNCATE, rebuilt.c_str(), static_cast<int>(bits));
+                break;
+            case ArgType::Int64:
+                written = _snwprintf_s(buffer, _countof(buffer), _TRUNCATE, rebuilt.c_str(), static_cast<long long>(bits));
+                break;
+            case ArgType::IntPtr:
+                written = _snwprintf_s(buffer, _countof(buffer), _TRUNCATE, rebuilt.c_str(), static_cast<intptr_t>(bits));
+                break;
+            case ArgType::Double: {
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                written = _snwprintf_s(buffer, _countof(buffer), _TRUNCATE, rebuilt.c_str(), value);
+                break;
+            }
+            case ArgType::Pointer:
+                written = _snwprintf_s(
+                    buffer, _countof(buffer), _TRUNCATE, rebuilt.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(bits)));
+                break;
+            case ArgType::NarrowString:
+                written = _snwprintf_s(buffer,
+                                       _countof(buffer),
+                                       _TRUNCATE,
+                                       rebuilt.c_str(),
+                                       arg.length ? reinterpret_cast<const char*>(payload) : static_cast<const char*>(nullptr));
+                break;
+            case ArgType::WideString:
+                written = _snwprintf_s(buffer,
+                                       _countof(buffer),
+                                       _TRUNCATE,
+                                       rebuilt.c_str(),
+                                       arg.length ? reinterpret_cast<const wchar_t*>(payload) : static_cast<const wchar_t*>(nullptr));
+                break;
+            default:
+                // The count of %n was only meaningful to the caller's own printf.
+                break;
+        }
+
+        if (written > 0) {
+            message.append(buffer, written);
+        } else if (written < 0 && spec.type != ArgType::Count) {
+            message.append(buffer);
+        }
+
+        cur = next;
+    }
+
+    // Anything past a specification that was not captured is printed as is.
+    message.append(cur);
+}
+
+const char* _labelForLevel(unsigned char level) {
+    switch (level) {
+        case WINEVENT_LEVEL_CRITICAL:
+            return LABEL_CRITICAL;
+        case WINEVENT_LEVEL_ERROR:
+            return LABEL_ERROR;
+        case WINEVENT_LEVEL_WARNING:
+            return LABEL_WARNING;
+        case WINEVENT_LEVEL_INFO:
+            return LABEL_INFO;
+        default:
+            return LABEL_VERBOSE;
+    }
+}
+
+void _writeLine(const std::wstring& line) {
+    int length = WideCharToMultiByte(CP_UTF8, 0, line.data(), static_cast<int>(line.size()), nullptr, 0, nullptr, nullptr);
+    if (length <= 0) {
+        return;
+    }
+
+    std::string narrow(length, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, line.data(), static_cast<int>(line.size()), &narrow[0], length, nullptr, nullptr);
+    fwrite(narrow.data(), 1, narrow.size(), s_output);
+}
+
+struct PendingRecord {
+    int64_t timestamp;
+    size_t offset;
+};
+
+// Writes out everything the rings hold. Runs on the drainer thread, or on the stopping thread once the drainer has exited.
+void _drain() {
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(s_ringsLock);
+        rings = s_rings;
+    }
+
+    std::vector<uint8_t> records;
+    std::vector<size_t> offsets;
+    uint64_t dropped = 0;
+    for (const auto& ring : rings) {
+        ring->Read(records, offsets);
+        dropped += ring->TakeDropped();
+    }
+
+    // Each ring is already in order; interleave the threads by when they traced.
+    std::vector<PendingRecord> pending;
+    pending.reserve(offsets.size());
+    for (size_t offset : offsets) {
+        RecordHeader header;
+        memcpy(&header, records.data() + offset, sizeof(header));
+        pending.push_back({ header.timestamp, offset });
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const PendingRecord& left, const PendingRecord& right) {
+        return left.timestamp < right.timestamp;
+    });
+
+    wchar_t prefix[64];
+    std::wstring line;
+    for (const PendingRecord& cur : pending) {
+        const uint8_t* record = records.data() + cur.offset;
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+
+        const wchar_t* tag = reinterpret_cast<const wchar_t*>(record + sizeof(header));
+        const wchar_t* format = tag + header.tagLength + 1;
+        const uint8_t* argsStart = record + _align8(sizeof(header) + (header.tagLength + header.formatLength + 2) * sizeof(wchar_t));
+        ArgReader args(argsStart, record + header.size);
+
+        double seconds = static_cast<double>(header.timestamp - s_startTime.QuadPart) / s_frequency.QuadPart;
+        _snwprintf_s(prefix, _countof(prefix), _TRUNCATE, L"%12.6f %5u ", seconds, header.threadId);
+
+        line.assign(prefix);
+        line.push_back(static_cast<wchar_t>(_labelForLevel(header.level)[0]));
+        line.push_back(L'/');
+        line.append(tag);
+        line.append(L": ");
+        _formatMessage(line, format, args);
+        line.push_back(L'\n');
+        _writeLine(line);
+    }
+
+    if (dropped != 0) {
+        fprintf(s_output,
+                "%llu trace messages were dropped because their thread's trace buffer was full\n",
+                static_cast<unsigned long long>(dropped));
+    }
+    fflush(s_output);
+
+    // Forget the rings of exited threads once nothing more can arrive in them.
+    std::lock_guard<std::mutex> lock(s_ringsLock);
+    s_rings.erase(std::remove_if(s_rings.begin(),
+                                 s_rings.end(),
+                                 [](const std::shared_ptr<TraceRing>& ring) { return ring->IsAbandoned() && ring->IsEmpty(); }),
+                  s_rings.end());
+}
+
+void _drainerMain() {
+    std::unique_lock<std::mutex> lock(s_sinkLock);
+    while (!s_stopping) {
+        s_sinkWake.wait_for(lock, c_drainInterval, []() { return s_stopping || s_wakeRequested || s_flushRequested != s_flushCompleted; });
+        s_wakeRequested = false;
+        uint64_t flushTarget = s_flushRequested;
+
+        lock.unlock();
+        _drain();
+        lock.lock();
+
+        s_flushCompleted = flushTarget;
+        s_sinkFlushed.notify_all();
+    }
+}
+
+} // namespace
+
+bool _isBufferedTraceEnabled(unsigned char level) {
+    unsigned char sinkLevel = s_level.load(std::memory_order_relaxed);
+    return sinkLevel != 0 && level <= sinkLevel;
+}
+
+void _bufferedTrace(unsigned char level, const wchar_t* tag, const wchar_t* format, va_list va) {
+    TraceRing* ring = t_ring.Get();
+
+    size_t tagLength = std::min(wcslen(tag), c_maxTagLength);
+    size_t formatLength = wcslen(format);
+    if (formatLength > c_maxFormatLength) {
+        // A truncated format could not be matched to its arguments.
+        ring->Drop();
+        return;
+    }
+
+    std::vector<uint8_t>& record = ring->scratch;
+    record.clear();
+
+    RecordHeader header = {};
+    header.level = level;
+    header.tagLength = static_cast<uint16_t>(tagLength);
+    header.formatLength = static_cast<uint32_t>(formatLength);
+    header.threadId = GetCurrentThreadId();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    header.timestamp = now.QuadPart;
+
+    _appendBytes(record, &header, sizeof(header));
+    _appendBytes(record, tag, tagLength * sizeof(wchar_t));
+    wchar_t terminator = 0;
+    _appendBytes(record, &terminator, sizeof(terminator));
+    _appendBytes(record, format, (formatLength + 1) * sizeof(wchar_t));
+    _appendPadding(record);
+
+    _captureArgs(record, format, va);
+
+    uint32_t size = static_cast<uint32_t>(record.size());
+    memcpy(record.data(), &size, sizeof(size));
+    // Wake the drainer early when this write takes the ring past half full, rather than on every write after that.
+    bool wasFilling = ring->IsFilling();
+    if (ring->Write(record.data(), record.size()) && !wasFilling && ring->IsFilling()) {
+        {
+            std::lock_guard<std::mutex> lock(s_sinkLock);
+            s_wakeRequested = true;
+        }
+        s_sinkWake.notify_one();
+    }
+}
+
+bool TraceStartBufferedSink(const wchar_t* path, TraceLevel level) {
+    std::lock_guard<std::mutex> lock(s_sinkLock);
+    if (s_output) {
+        // Running, or still stopping.
+        return false;
+    }
+
+    if (path) {
+        s_output = _wfsopen(path, L"ab", _SH_DENYWR);
+        if (!s_output) {
+            return false;
+        }
+        s_ownsOutput = true;
+    } else {
+        s_output = stderr;
+        s_ownsOutput = false;
+    }
+
+    QueryPerformanceFrequency(&s_frequency);
+    QueryPerformanceCounter(&s_startTime);
+    s_stopping = false;
+    s_wakeRequested = false;
+    s_flushRequested = s_flushCompleted = 0;
+    s_drainer = std::thread(_drainerMain);
+
+    s_level.store(static_cast<unsigned char>(level), std::memory_order_relaxed);
+    return true;
+}
+
+void TraceFlushBufferedSink() {
+    std::unique_lock<std::mutex> lock(s_sinkLock);
+    if (!s_drainer.joinable()) {
+        return;
+    }
+
+    uint64_t target = ++s_flushRequested;
+    s_sinkWake.notify_one();
+    s_sinkFlushed.wait(lock, [target]() { return s_flushCompleted >= target || s_stopping; });
+}
+
+void TraceStopBufferedSink() {
+    std::thread drainer;
+    {
+        std::lock_guard<std::mutex> lock(s_sinkLock);
+        if (!s_drainer.joinable()) {
+            return;
+        }
+
+        s_level.store(0, std::memory_order_relaxed);
+        s_stopping = true;
+        drainer = std::move(s_drainer);
+    }
+
+    s_sinkWake.notify_one();
+    s_sinkFlushed.notify_all();
+    drainer.join();
+
+    // Threads that passed the level check before it was cleared may still be writing their last record.
+    _drain();
+
+    std::lock_guard<std::mutex> lock(s_sinkLock);
+    if (s_ownsOutput) {
+        fclose(s_output);
+    }
+    s_output = nullptr;
+}
@@ -0,0 +1,690 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+// Span and counter recording.
+//
+// Each thread owns the statistics it records: blocks of per-site aggregates that only it writes, with relaxed atomic
+// stores, and that snapshots read concurrently. A thread's aggregates are folded into a shared set when it exits. While a
+// trace is being captured, each thread also appends its events to its own single-producer, single-consumer ring buffer,
+// which a collector thread drains into the trace file.
+
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <share.h>
+
+#include <windows.h>
+
+volatile bool g_instrumentationEnabled = false;
+
+namespace {
+
+// Sites are numbered from 1; 0 is never registered.
+const size_t c_maxSites = 1024;
+
+// Each thread allocates aggregates for this many sites at a time.
+const size_t c_sitesPerBlock = 64;
+const size_t c_blockCount = c_maxSites / c_sitesPerBlock;
+
+// Spans nested deeper than this are still timed, but their time is not subtracted from the self time of their parent.
+const size_t c_maxDepth = 64;
+
+// Per-thread trace ring size, in events. Must be a power of two.
+const size_t c_ringCapacity = 16 * 1024;
+
+// How often the collector wakes up when nobody asks it to.
+const std::chrono::milliseconds c_collectInterval(50);
+
+const size_t c_histogramBuckets = INSTRUMENTATION_HISTOGRAM_BUCKETS;
+
+struct SiteInfo {
+    const char* category;
+    const char* name;
+    InstrumentationKind kind;
+};
+
+// Registered sites, indexed by id - 1. Entries are never removed, so a site's info can be read without the lock once its
+// id has been handed out.
+std::mutex s_sitesLock;
+SiteInfo s_sites[c_maxSites];
+std::atomic<size_t> s_siteCount(0);
+
+int64_t _queryFrequency() {
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+
+const int64_t s_frequency = _queryFrequency();
+
+int64_t _now() {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+int64_t _ticksToNanoseconds(int64_t ticks) {
+    return (ticks / s_frequency) * 1000000000 + ((ticks % s_frequency) * 1000000000) / s_frequency;
+}
+
+size_t _bucketFor(int64_t value) {
+    if (value <= 1) {
+        return 0;
+    }
+
+    unsigned long index;
+    uint32_t high = static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32);
+    if (high) {
+        _BitScanReverse(&index, high);
+        index += 32;
+    } else {
+        _BitScanReverse(&index, static_cast<uint32_t>(value));
+    }
+    return std::min(static_cast<size_t>(index), c_histogramBuckets - 1);
+}
+
+// Aggregates for one site. Written by a single thread; read by snapshots on any thread.
+struct SiteStats {
+    std::atomic<uint64_t> count;
+    std::atomic<int64_t> total;
+    std::atomic<int64_t> self;
+    std::atomic<int64_t> max;
+    std::atomic<uint64_t> histogram[c_histogramBuckets];
+};
+
+// The single writer needs no read-modify-write instruction, only a store readers cannot see torn.
+template <typename T>
+void _add(std::atomic<T>& value, T amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void _record(SiteStats& stats, int64_t total, int64_t self) {
+    _add<uint64_t>(stats.count, 1);
+    _add(stats.total, total);
+    _add(stats.self, self);
+    if (total > stats.max.load(std::memory_order_relaxed)) {
+        stats.max.store(total, std::memory_order_relaxed);
+    }
+    _add<uint64_t>(stats.histogram[_bucketFor(total)], 1);
+}
+
+void _accumulate(InstrumentationEntry& entry, const SiteStats& stats) {
+    entry.count += stats.count.load(std::memory_order_relaxed);
+    entry.total += stats.total.load(std::memory_order_relaxed);
+    entry.self += stats.self.load(std::memory_order_relaxed);
+    entry.max = std::max(entry.max, stats.max.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < c_histogramBuckets; i++) {
+        entry.histogram[i] += stats.histogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+void _accumulate(SiteStats& stats, const SiteStats& other) {
+    _add(stats.count, other.count.load(std::memory_order_relaxed));
+    _add(stats.total, other.total.load(std::memory_order_relaxed));
+    _add(stats.self, other.self.load(std::memory_order_relaxed));
+    stats.max.store(std::max(stats.max.load(std::memory_order_relaxed), other.max.load(std::memory_order_relaxed)),
+                    std::memory_order_relaxed);
+    for (size_t i = 0; i < c_histogramBuckets; i++) {
+        _add(stats.histogram[i], other.histogram[i].load(std::memory_order_relaxed));
+    }
+}
+
+// A span, or a counter update with its value in end.
+struct TraceEvent {
+    uint32_t site;
+    uint32_t threadId;
+    int64_t start;
+    int64_t end;
+};
+
+class TraceRing {
+public:
+    TraceRing() : _events(new TraceEvent[c_ringCapacity]), _head(0), _tail(0), _dropped(0), _abandoned(false) {
+    }
+
+    // Producer side. Returns false, and counts the event as dropped, if the ring is full.
+    bool Write(const TraceEvent& event) {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= c_ringCapacity) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _events[static_cast<size_t>(head & (c_ringCapacity - 1))] = event;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Whether the ring is more than half full, so the collector should not wait for its next interval.
+    bool IsFilling() const {
+        return _head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_relaxed) > c_ringCapacity / 2;
+    }
+
+    // Consumer side. Appends every committed event to out.
+    void Read(std::vector<TraceEvent>& out) {
+        uint64_t head = _head.load(std::memory_order_acquire);
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+        for (; tail != head; tail++) {
+            out.push_back(_events[static_cast<size_t>(tail & (c_ringCapacity - 1))]);
+        }
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    bool IsEmpty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_relaxed);
+    }
+
+    uint64_t TakeDropped() {
+        return _dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    void Abandon() {
+        _abandoned.store(true, std::memory_order_release);
+    }
+
+    bool IsAbandoned() const {
+        return _abandoned.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<TraceEvent[]> _events;
+    std::atomic<uint64_t> _head;
+    std::atomic<uint64_t> _tail;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _abandoned;
+};
+
+// Rings of every thread that has recorded while a trace was being captured. Only registration and the collector take the
+// lock.
+std::mutex s_ringsLock;
+std::vector<std::shared_ptr<TraceRing>> s_rings;
+
+// Whether a trace is being captured.
+std::atomic<bool> s_tracing(false);
+
+struct ThreadState;
+
+// Threads with recorded aggregates, and the aggregates of threads that have exited. Snapshots hold the lock while reading
+// a thread's blocks, so a thread cannot free them underneath one.
+std::mutex s_threadsLock;
+std::vector<ThreadState*> s_threads;
+SiteStats s_retired[c_maxSites];
+
+struct ThreadState {
+    ThreadState() : depth(0), threadId(GetCurrentThreadId()) {
+        for (auto& block : blocks) {
+            block.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ThreadState() {
+        for (auto& block : blocks) {
+            delete[] block.load(std::memory_order_relaxed);
+        }
+    }
+
+    SiteStats& StatsFor(unsigned int site) {
+        size_t index = site - 1;
+        std::atomic<SiteStats*>& slot = blocks[index / c_sitesPerBlock];
+        SiteStats* block = slot.load(std::memory_order_relaxed);
+        if (!block) {
+            block = new SiteStats[c_sitesPerBlock]();
+            slot.store(block, std::memory_order_release);
+        }
+        return block[index % c_sitesPerBlock];
+    }
+
+    TraceRing* Ring() {
+        if (!ring) {
+            ring = std::make_shared<TraceRing>();
+            std::lock_guard<std::mutex> lock(s_ringsLock);
+            s_rings.push_back(ring);
+        }
+        return ring.get();
+    }
+
+    // Published with release ordering once allocated, for snapshots to read.
+    std::atomic<SiteStats*> blocks[c_blockCount];
+
+    // The time spent in spans nested directly inside each open span.
+    int64_t childTicks[c_maxDepth];
+    size_t depth;
+
+    uint32_t threadId;
+    std::shared_ptr<TraceRing> ring;
+};
+
+// Registers the thread's aggregates on first use, and folds them into s_retired when the thread exits.
+struct ThreadStateHolder {
+    ~ThreadStateHolder() {
+        if (!state) {
+            return;
+        }
+
+        if (state->ring) {
+            state->ring->Abandon();
+        }
+
+        std::lock_guard<std::mutex> lock(s_threadsLock);
+        s_threads.erase(std::remove(s_threads.begin(), s_threads.end(), state.get()), s_threads.end());
+        for (size_t block = 0; block < c_blockCount; block++) {
+            SiteStats* stats = state->blocks[block].load(std::memory_order_relaxed);
+            for (size_t i = 0; stats && i < c_sitesPerBlock; i++) {
+                _accumulate(s_retired[block * c_sitesPerBlock + i], stats[i]);
+            }
+        }
+    }
+
+    ThreadState* Get() {
+        if (!state) {
+            state.reset(new ThreadState());
+            std::lock_guard<std::mutex> lock(s_threadsLock);
+            s_threads.push_back(state.get());
+        }
+        return state.get();
+    }
+
+    std::unique_ptr<ThreadState> state;
+};
+
+thread_local ThreadStateHolder t_state;
+
+// Guards everything below, which belongs to the trace being captured.
+std::mutex s_traceLock;
+std::condition_variable s_traceWake;
+std::thread s_collector;
+FILE* s_traceOutput = nullptr;
+bool s_stopping = false;
+bool s_wakeRequested = false;
+bool s_wroteEvent = false;
+bool s_enabledBeforeTrace = false;
+int64_t s_traceStart = 0;
+uint64_t s_droppedEvents = 0;
+
+// The running value of each counter, for the trace's counter events. Only touched by whoever drains the rings.
+int64_t s_counterValues[c_maxSites];
+
+void _traceEvent(ThreadState* state, unsigned int site, int64_t start, int64_t end) {
+    TraceRing* ring = state->Ring();
+    bool wasFilling = ring->IsFilling();
+    if (ring->Write({ site, state->threadId, start, end }) && !wasFilling && ring->IsFilling()) {
+        {
+            std::lock_guard<std::mutex> lock(s_traceLock);
+            s_wakeRequested = true;
+        }
+        s_traceWake.notify_one();
+    }
+}
+
+// Writes a string literal as a JSON string.
+void _writeJsonString(FILE* output, const char* value) {
+    fputc('"', output);
+    for (const char* cur = value; *cur; cur++) {
+        unsigned char c = static_cast<unsigned char>(*cur);
+        if (c == '"' || c == '\\') {
+            fputc('\\', output);
+            fputc(c, output);
+        } else if (c < 0x20) {
+            fprintf(output, "\\u%04x", c);
+        } else {
+            fputc(c, output);
+        }
+    }
+    fputc('"', output);
+}
+
+double _traceMicroseconds(int64_t timestamp) {
+    return static_cast<double>(timestamp - s_traceStart) * 1000000.0 / s_frequency;
+}
+
+// Writes out everything the rings hold. Runs on the collector thread, or on the stopping thread once the collector has
+// exited.
+void _collect() {
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(s_ringsLock);
+        rings = s_rings;
+    }
+
+    std::vector<TraceEvent> events;
+    for (const auto& ring : rings) {
+        ring->Read(events);
+        s_droppedEvents += ring->TakeDropped();
+    }
+
+    // Counter events carry a running total, so they must be applied in the order they happened.
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& left, const TraceEvent& right) {
+        return left.start < right.start;
+    });
+
+    DWORD processId = GetCurrentProcessId();
+    for (const TraceEvent& event : events) {
+        if (event.start < s_traceStart) {
+            // Left in a ring by a thread that saw an earlier trace running just before it stopped.
+            continue;
+        }
+
+        const SiteInfo& info = s_sites[event.site - 1];
+
+        fputs(s_wroteEvent ? ",\n{\"name\":" : "\n{\"name\":", s_traceOutput);
+        s_wroteEvent = true;
+        _writeJsonString(s_traceOutput, info.name);
+        fputs(",\"cat\":", s_traceOutput);
+        _writeJsonString(s_traceOutput, info.category);
+
+        if (info.kind == InstrumentationKindSpan) {
+            fprintf(s_traceOutput,
+                    ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%u}",
+                    _traceMicroseconds(event.start),
+                    static_cast<double>(event.end - event.start) * 1000000.0 / s_frequency,
+                    processId,
+                    event.threadId);
+        } else {
+            int64_t& value = s_counterValues[event.site - 1];
+            value += event.end;
+            fprintf(s_traceOutput,
+                    ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%u,\"args\":{\"value\":%lld}}",
+                    _traceMicroseconds(event.start),
+                    processId,
+                    event.threadId,
+                    static_cast<long long>(value));
+        }
+    }
+    fflush(s_traceOutput);
+
+    // Forget the rings of exited threads once nothing more can arrive in them.
+    std::lock_guard<std::mutex> lock(s_ringsLock);
+    s_rings.erase(std::remove_if(s_rings.begin(),
+                                 s_rings.end(),
+                                 [](const std::shared_ptr<TraceRing>& ring) { return ring->IsAbandoned() && ring->IsEmpty(); }),
+                  s_rings.end());
+}
+
+void _collectorMain() {
+    std::unique_lock<std::mutex> lock(s_traceLock);
+    while (!s_stopping) {
+        s_traceWake.wait_for(lock, c_collectInterval, []() { return s_stopping || s_wakeRequested; });
+        s_wakeRequested = false;
+
+        lock.unlock();
+        _collect();
+        lock.lock();
+    }
+}
+
+// Estimates the given percentile as the upper bound of the histogram bucket it falls in.
+int64_t _percentile(const InstrumentationEntry& entry, double fraction) {
+    uint64_t target = static_cast<uint64_t>(entry.count * fraction);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < c_histogramBuckets; i++) {
+        seen += entry.histogram[i];
+        if (seen > target) {
+            return std::min(static_cast<int64_t>(2) << i, entry.max);
+        }
+    }
+    return entry.max;
+}
+
+} // namespace
+
+void InstrumentationSetEnabled(bool enabled) {
+    g_instrumentationEnabled = enabled;
+}
+
+unsigned int InstrumentationRegisterSite(const char* category, const char* name, InstrumentationKind kind) {
+    std::lock_guard<std::mutex> lock(s_sitesLock);
+    size_t count = s_siteCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        if (s_sites[i].kind == kind && strcmp(s_sites[i].category, category) == 0 && strcmp(s_sites[i].name, name) == 0) {
+            return static_cast<unsigned int>(i + 1);
+        }
+    }
+
+    if (count == c_maxSites) {
+        return 0;
+    }
+
+    s_sites[count] = { category, name, kind };
+    s_siteCount.store(count + 1, std::memory_order_release);
+    return static_cast<unsigned int>(count + 1);
+}
+
+int64_t InstrumentationTimestamp() {
+    return _now();
+}
+
+int64_t InstrumentationBeginSpan(unsigned int site) {
+    ThreadState* state = t_state.Get();
+    if (state->depth < c_maxDepth) {
+        state->childTicks[state->depth] = 0;
+    }
+    state->depth++;
+    return _now();
+}
+
+void InstrumentationEndSpan(unsigned int site, int64_t start) {
+    int64_t end = _now();
+    ThreadState* state = t_state.Get();
+    if (state->depth == 0) {
+        return;
+    }
+
+    int64_t ticks = end - start;
+    state->depth--;
+    int64_t childTicks = (state->depth < c_maxDepth) ? state->childTicks[state->depth] : 0;
+    if (state->depth > 0 && state->depth - 1 < c_maxDepth) {
+        state->childTicks[state->depth - 1] += ticks;
+    }
+
+    if (site == 0) {
+        return;
+    }
+
+    _record(state->StatsFor(site), _ticksToNanoseconds(ticks), _ticksToNanoseconds(ticks - childTicks));
+    if (s_tracing.load(std::memory_order_relaxed)) {
+        _traceEvent(state, site, start, end);
+    }
+}
+
+void InstrumentationRecordSpan(unsigned int site, int64_t start) {
+    if (site == 0) {
+        return;
+    }
+
+    int64_t end = _now();
+    ThreadState* state = t_state.Get();
+    int64_t nanoseconds = _ticksToNanoseconds(end - start);
+    _record(state->StatsFor(site), nanoseconds, nanoseconds);
+    if (s_tracing.load(std::memory_order_relaxed)) {
+        _traceEvent(state, site, start, end);
+    }
+}
+
+void InstrumentationAddCounter(unsigned int site, int64_t value) {
+    if (site == 0) {
+        return;
+    }
+
+    ThreadState* state = t_state.Get();
+    _record(state->StatsFor(site), value, value);
+    if (s_tracing.load(std::memory_order_relaxed)) {
+        _traceEvent(state, site, _now(), value);
+    }
+}
+
+size_t InstrumentationSnapshot(InstrumentationEntry* entries, size_t capacity) {
+    size_t count = s_siteCount.load(std::memory_order_acquire);
+    size_t copied = std::min(count, capacity);
+    for (size_t i = 0; i < copied; i++) {
+        InstrumentationEntry& entry = entries[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.category = s_sites[i].category;
+        entry.name = s_sites[i].name;
+        entry.kind = s_sites[i].kind;
+    }
+
+    std::lock_guard<std::mutex> lock(s_threadsLock);
+    for (size_t i = 0; i < copied; i++) {
+        _accumulate(entries[i], s_retired[i]);
+    }
+
+    for (ThreadState* state : s_threads) {
+        for (size_t block = 0; block < c_blockCount && block * c_sitesPerBlock < copied; block++) {
+            SiteStats* stats = state->blocks[block].load(std::memory_order_acquire);
+            for (size_t i = 0; stats && i < c_sitesPerBlock && block * c_sitesPerBlock + i < copied; i++) {
+                _accumulate(entries[block * c_sitesPerBlock + i], stats[i]);
+            }
+        }
+    }
+
+    return count;
+}
+
+bool InstrumentationWriteHistograms(const wchar_t* path) {
+    FILE* output = stderr;
+    if (path) {
+        output = _wfsopen(path, L"wb", _SH_DENYWR);
+        if (!output) {
+            return false;
+        }
+    }
+
+    std::vector<InstrumentationEntry> entries(c_maxSites);
+    entries.resize(InstrumentationSnapshot(entries.data(), entries.size()));
+
+    // Group each category's sites together, keeping registration order within a category.
+    std::stable_sort(entries.begin(), entries.end(), [](const InstrumentationEntry& left, const InstrumentationEntry& right) {
+        return strcmp(left.category, right.category) < 0;
+    });
+
+    fprintf(output,
+            "%-16s %-40s %10s %12s %12s %10s %10s %10s %10s %10s\n",
+            "Category",
+            "Span",
+            "Count",
+            "Total ms",
+            "Self ms",
+            "Mean us",
+            "p50 us",
+            "p90 us",
+            "p99 us",
+            "Max us");
+    for (const InstrumentationEntry& entry : entries) {
+        if (entry.kind != InstrumentationKindSpan || entry.count == 0) {
+            continue;
+        }
+
+        fprintf(output,
+                "%-16s %-40s %10llu %12.3f %12.3f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                entry.category,
+                entry.name,
+                static_cast<unsigned long long>(entry.count),
+                entry.total / 1000000.0,
+                entry.self / 1000000.0,
+                entry.total / 1000.0 / entry.count,
+                _percentile(entry, 0.5) / 1000.0,
+                _percentile(entry, 0.9) / 1000.0,
+                _percentile(entry, 0.99) / 1000.0,
+                entry.max / 1000.0);
+    }
+
+    fprintf(output, "\n%-16s %-40s %10s %16s %16s\n", "Category", "Counter", "Updates", "Total", "Largest update");
+    for (const InstrumentationEntry& entry : entries) {
+        if (entry.kind != InstrumentationKindCounter || entry.count == 0) {
+            continue;
+        }
+
+        fprintf(output,
+                "%-16s %-40s %10llu %16lld %16lld\n",
+                entry.category,
+                entry.name,
+                static_cast<unsigned long long>(entry.count),
+                static_cast<long long>(entry.total),
+                static_cast<long long>(entry.max));
+    }
+
+    if (path) {
+        fclose(output);
+    } else {
+        fflush(output);
+    }
+    return true;
+}
+
+bool InstrumentationStartTrace(const wchar_t* path) {
+    std::lock_guard<std::mutex> lock(s_traceLock);
+    if (s_traceOutput) {
+        return false;
+    }
+
+    s_traceOutput = _wfsopen(path, L"wb", _SH_DENYWR);
+    if (!s_traceOutput) {
+        return false;
+    }
+
+    // The array is left open until the trace stops; trace viewers also load files that end without closing it.
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", s_traceOutput);
+    memset(s_counterValues, 0, sizeof(s_counterValues));
+    s_traceStart = _now();
+    s_stopping = false;
+    s_wakeRequested = false;
+    s_wroteEvent = false;
+    s_droppedEvents = 0;
+    s_collector = std::thread(_collectorMain);
+
+    s_tracing.store(true, std::memory_order_relaxed);
+    s_enabledBeforeTrace = g_instrumentationEnabled;
+    g_instrumentationEnabled = true;
+    return true;
+}
+
+void InstrumentationStopTrace() {
+    std::thread collector;
+    {
+        std::lock_guard<std::mutex> lock(s_traceLock);
+        if (!s_collector.joinable()) {
+            return;
+        }
+
+        g_instrumentationEnabled = s_enabledBeforeTrace;
+        s_tracing.store(false, std::memory_order_relaxed);
+        s_stopping = true;
+        collector = std::move(s_collector);
+    }
+
+    s_traceWake.notify_one();
+    collector.join();
+
+    // Threads that saw the trace running before it was stopped may still be writing their last event.
+    _collect();
+
+    std::lock_guard<std::mutex> lock(s_traceLock);
+    fprintf(s_traceOutput,
+            "\n],\"otherData\":{\"droppedEvents\":\"%llu\"}}\n",
+            static_cast<unsigned long long>(s_droppedEvents));
+    fclose(s_traceOutput);
+    s_traceOutput = nullptr;
+}
@@ -17,7 +17,11 @@
 #include "LoggingNative.h"
 #include "LoggingInternal.h"
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <string>
+#include <vector>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,6 +35,11 @@
 
 bool s_isRegistered = false;
 
+// Tags disabled with TraceSetTagEnabled. The count lets the common case, with no disabled tags, skip the lock.
+static std::atomic<size_t> s_disabledTagCount(0);
+static std::mutex s_disabledTagsLock;
+static std::vector<std::wstring> s_disabledTags;
+
 // This is where we store the WIL logging hook
 namespace wil {
 namespace details {
@@ -40,45 +49,95 @@ void(__stdcall* g_pfnLoggingCallback)(wil::FailureInfo const& failure) WI_NOEXCE
 }
 
 void TraceVerbose(const wchar_t* tag, const wchar_t* format, ...) {
+    if (!TraceIsEnabled(TraceLevelVerbose, tag)) {
+        return;
+    }
+
     va_list varArgs;
     va_start(varArgs, format);
-    _V_TRACE_WIDE(WINEVENT_LEVEL_VERBOSE, LABEL_VERBOSE, tag, format, varArgs);
+    _V_TRACE(WINEVENT_LEVEL_VERBOSE, LABEL_VERBOSE, tag, format, varArgs);
     va_end(varArgs);
 }
 
 void TraceInfo(const wchar_t* tag, const wchar_t* format, ...) {
+    if (!TraceIsEnabled(TraceLevelInfo, tag)) {
+        return;
+    }
+
     va_list varArgs;
     va_start(varArgs, format);
-    _V_TRACE_WIDE(WINEVENT_LEVEL_INFO, LABEL_INFO, tag, format, varArgs);
+    _V_TRACE(WINEVENT_LEVEL_INFO, LABEL_INFO, tag, format, varArgs);
     va_end(varArgs);
 }
 
 void TraceWarning(const wchar_t* tag, const wchar_t* format, ...) {
+    if (!TraceIsEnabled(TraceLevelWarning, tag)) {
+        return;
+    }
+
     va_list varArgs;
     va_start(varArgs, format);
-    _V_TRACE_WIDE(WINEVENT_LEVEL_WARNING, LABEL_WARNING, tag, format, varArgs);
+    _V_TRACE(WINEVENT_LEVEL_WARNING, LABEL_WARNING, tag, format, varArgs);
     va_end(varArgs);
 }
 
 void TraceError(const wchar_t* tag, const wchar_t* format, ...) {
+    if (!TraceIsEnabled(TraceLevelError, tag)) {
+        return;
+    }
+
     va_list varArgs;
     va_start(varArgs, format);
-    _V_TRACE_WIDE(WINEVENT_LEVEL_ERROR, LABEL_ERROR, tag, format, varArgs);
+    _V_TRACE(WINEVENT_LEVEL_ERROR, LABEL_ERROR, tag, format, varArgs);
     va_end(varArgs);
 }
 
 void TraceCritical(const wchar_t* tag, const wchar_t* format, ...) {
+    if (!TraceIsEnabled(TraceLevelCritical, tag)) {
+        return;
+    }
+
     va_list varArgs;
     va_start(varArgs, format);
-    _V_TRACE_WIDE(WINEVENT_LEVEL_CRITICAL, LABEL_CRITICAL, tag, format, varArgs);
+    _V_TRACE(WINEVENT_LEVEL_CRITICAL, LABEL_CRITICAL, tag, format, varArgs);
     va_end(varArgs);
 }
 
+bool _isTraceTagEnabled(const wchar_t* tag) {
+    if (s_disabledTagCount.load(std::memory_order_acquire) == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(s_disabledTagsLock);
+    return std::find(s_disabledTags.begin(), s_disabledTags.end(), tag) == s_disabledTags.end();
+}
+
+bool TraceIsEnabled(TraceLevel level, const wchar_t* tag) {
+    // Check the level first; it costs a load or two, whereas the tag check may take a lock.
+    if (!_IS_SYNCHRONOUS_TRACE_ENABLED(static_cast<unsigned char>(level)) && !_isBufferedTraceEnabled(static_cast<unsigned char>(level))) {
+        return false;
+    }
+
+    return _isTraceTagEnabled(tag);
+}
+
+void TraceSetTagEnabled(const wchar_t* tag, bool enabled) {
+    std::lock_guard<std::mutex> lock(s_disabledTagsLock);
+    auto found = std::find(s_disabledTags.begin(), s_disabledTags.end(), tag);
+    if (enabled && found != s_disabledTags.end()) {
+        s_disabledTags.erase(found);
+    } else if (!enabled && found == s_disabledTags.end()) {
+        s_disabledTags.emplace_back(tag);
+    }
+
+    s_disabledTagCount.store(s_disabledTags.size(), std::memory_order_release);
+}
+
 // WIL logging hook
 void __stdcall _wilLoggingCallback(wil::FailureInfo const& failure) {
     wchar_t debugString[2048];
     wil::GetFailureLogString(debugString, _countof(debugString), failure);
-    TraceError(L"WIL", debugString);
+    TraceError(L"WIL", L"%ws", debugString);
 }
 
 void TraceRegister() {
@@ -0,0 +1,238 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <Windows.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BatchConverter.h"
+#include "Conversion.h"
+#include "versionutils.h"
+
+namespace {
+struct BatchItem {
+    std::string input;
+    std::string output;
+    unsigned long long hash;
+    bool upToDate;
+};
+
+//  Maps each output to the hash of the input it was last successfully converted from
+typedef std::unordered_map<std::string, unsigned long long> ConversionCache;
+
+const unsigned long long c_fnvOffsetBasis = 14695981039346656037ULL;
+const unsigned long long c_fnvPrime = 1099511628211ULL;
+
+unsigned long long HashBytes(unsigned long long hash, const void* bytes, size_t len) {
+    const unsigned char* pBytes = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ pBytes[i]) * c_fnvPrime;
+    }
+    return hash;
+}
+
+bool HashFile(const char* path, unsigned long long* hash) {
+    FILE* fpIn = fopen(path, "rb");
+    if (!fpIn) {
+        return false;
+    }
+
+    std::vector<char> buffer(64 * 1024);
+    size_t len;
+    while ((len = fread(buffer.data(), 1, buffer.size(), fpIn)) > 0) {
+        *hash = HashBytes(*hash, buffer.data(), len);
+    }
+
+    fclose(fpIn);
+    return true;
+}
+
+bool PathExists(const std::string& path) {
+    struct stat st = { 0 };
+    return stat(path.c_str(), &st) == 0;
+}
+
+bool ReadBatchList(const char* listFile, std::vector<BatchItem>& items) {
+    FILE* fpIn = fopen(listFile, "r");
+    if (!fpIn) {
+        printf("Error opening %s\n", listFile);
+        return false;
+    }
+
+    bool ret = true;
+    char line[4096];
+    while (fgets(line, sizeof(line), fpIn)) {
+        size_t len = strcspn(line, "\r\n");
+        if (len == 0) {
+            continue;
+        }
+
+        char* tab = (char*)memchr(line, '\t', len);
+        if (!tab) {
+            line[len] = 0;
+            printf("Malformed batch entry \"%s\", expected <input><TAB><output>\n", line);
+            ret = false;
+            break;
+        }
+
+        BatchItem item;
+        item.input.assign(line, tab);
+        item.output.assign(tab + 1, line + len);
+        item.hash = 0;
+        item.upToDate = false;
+        items.push_back(item);
+    }
+
+    fclose(fpIn);
+    return ret;
+}
+
+void ReadCache(const char* cacheFile, ConversionCache& cache) {
+    FILE* fpIn = fopen(cacheFile, "r");
+    if (!fpIn) {
+        return;
+    }
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fpIn)) {
+        unsigned long long hash;
+        int pathStart = 0;
+        if (sscanf(line, "%llx\t%n", &hash, &pathStart) == 1 && pathStart > 0) {
+            size_t len = strcspn(line + pathStart, "\r\n");
+            cache[std::string(line + pathStart, len)] = hash;
+        }
+    }
+
+    fclose(fpIn);
+}
+
+bool WriteCache(const char* cacheFile, const ConversionCache& cache) {
+    //  Write to the side and swap the result in, so an interrupted build never leaves a truncated cache behind
+    std::string tempFile = std::string(cacheFile) + ".tmp";
+    FILE* fpOut = fopen(tempFile.c_str(), "w");
+    if (!fpOut) {
+        return false;
+    }
+
+    for (const auto& cur : cache) {
+        fprintf(fpOut, "%016llx\t%s\n", cur.second, cur.first.c_str());
+    }
+
+    bool ret = fclose(fpOut) == 0;
+    return ret && MoveFileExA(tempFile.c_str(), cacheFile, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+}
+
+int RunBatchConversion(const char* listFile, const char* cacheFile, unsigned int jobs) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<BatchItem> items;
+    if (!ReadBatchList(listFile, items)) {
+        return -1;
+    }
+
+    //  Fold xib2nib itself into every hash, so that a new converter reconverts everything
+    std::string exePath = getBinaryLocation();
+    unsigned long long toolHash = c_fnvOffsetBasis;
+    HashFile(exePath.c_str(), &toolHash);
+
+    ConversionCache cache;
+    if (cacheFile) {
+        ReadCache(cacheFile, cache);
+    }
+
+    if (jobs == 0) {
+        jobs = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    jobs = static_cast<unsigned int>(std::min<size_t>(jobs, std::max<size_t>(items.size(), 1)));
+
+    std::atomic<size_t> nextItem(0);
+    std::atomic<int> upToDateCount(0);
+    std::atomic<int> failedCount(0);
+    std::mutex outputLock;
+
+    //  The cache is only read while the workers run, and only updated once they are done
+    auto worker = [&]() {
+        for (size_t i = nextItem++; i < items.size(); i = nextItem++) {
+            BatchItem& item = items[i];
+
+            item.hash = HashBytes(toolHash, item.input.c_str(), item.input.size() + 1);
+            if (!HashFile(item.input.c_str(), &item.hash)) {
+                std::lock_guard<std::mutex> lock(outputLock);
+                printf("Error opening %s\n", item.input.c_str());
+                failedCount++;
+                continue;
+            }
+
+            ConversionCache::const_iterator cached = cache.find(item.output);
+            if (cached != cache.end() && cached->second == item.hash && PathExists(item.output)) {
+                item.upToDate = true;
+                upToDateCount++;
+                continue;
+            }
+
+            item.upToDate = ConvertFile(item.input.c_str(), item.output.c_str()) == 0;
+            if (!item.upToDate) {
+                std::lock_guard<std::mutex> lock(outputLock);
+                printf("Error converting %s\n", item.input.c_str());
+                failedCount++;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < jobs; i++) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread& cur : workers) {
+        cur.join();
+    }
+
+    if (cacheFile) {
+        for (const BatchItem& item : items) {
+            if (item.upToDate) {
+                cache[item.output] = item.hash;
+            } else {
+                cache.erase(item.output);
+            }
+        }
+
+        if (!WriteCache(cacheFile, cache)) {
+            printf("Unable to write conversion cache %s\n", cacheFile);
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int convertedCount = static_cast<int>(items.size()) - upToDateCount - failedCount;
+    printf("Converted %d of %d inputs (%d up to date, %d failed) in %.2fs using %u jobs\n",
+           convertedCount,
+           static_cast<int>(items.size()),
+           upToDateCount.load(),
+           failedCount.load(),
+           elapsed,
+           jobs);
+
+    return failedCount;
+}
@@ -0,0 +1,27 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+//  Converts every input named in listFile, one "<input><TAB><output>" pair per line, running up to jobs conversions at a
+//  time (0 picks one per hardware thread). The conversions run in this process, each on a worker thread with its own
+//  ConversionContext.
+//
+//  When cacheFile is given, an input is skipped if its output still exists and the content hash of the input (and of
+//  xib2nib itself) matches the one recorded after its last successful conversion.
+//
+//  Returns the number of inputs that failed to convert, or -1 if the list could not be read.
+int RunBatchConversion(const char* listFile, const char* cacheFile, unsigned int jobs);
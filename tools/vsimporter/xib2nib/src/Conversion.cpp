@@ -0,0 +1,46 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#include <assert.h>
+
+#include "Conversion.h"
+#include "XIBObjectTypes.h"
+
+namespace {
+thread_local ConversionContext* t_currentConversion = NULL;
+}
+
+ConversionContext::ConversionContext() : isStoryboard(false), failed(false), curPlaceholder(1), _previous(t_currentConversion) {
+    t_currentConversion = this;
+}
+
+ConversionContext::~ConversionContext() {
+    assert(t_currentConversion == this);
+    t_currentConversion = _previous;
+}
+
+ConversionContext& CurrentConversion() {
+    assert(t_currentConversion);
+    return *t_currentConversion;
+}
+
+bool IsStoryboardConversion() {
+    return CurrentConversion().isStoryboard;
+}
+
+std::string GetOutputFilename(const char* filename) {
+    return CurrentConversion().outputDirectory + "\\" + std::string(filename);
+}
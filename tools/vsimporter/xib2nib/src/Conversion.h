@@ -0,0 +1,69 @@
+//******************************************************************************
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// This code is licensed under the MIT License (MIT).
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//******************************************************************************
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class XIBObject;
+
+//  The state of one conversion. The converters reach it through CurrentConversion(), so that a batch can run several
+//  conversions side by side in one process. Constructing a context makes it the calling thread's current one until it is
+//  destroyed.
+//
+//  Objects created during a conversion are not freed when it ends.
+class ConversionContext {
+public:
+    ConversionContext();
+    ~ConversionContext();
+
+    ConversionContext(const ConversionContext&) = delete;
+    ConversionContext& operator=(const ConversionContext&) = delete;
+
+    //  Set once the input is known to be a storyboard, whose controllers are written to outputDirectory
+    bool isStoryboard;
+    std::string outputDirectory;
+
+    //  Set when an object could not be written, in place of exiting the process
+    bool failed;
+
+    //  Every object scanned from the input, in the order they were scanned
+    std::vector<XIBObject*> allObjects;
+
+    //  The hashes of the XML nodes and attributes the converters consumed, for the coverage report
+    std::unordered_set<size_t> handledNodes;
+
+    //  The ids of the storyboard's view controllers, and the identifiers of those exported so far
+    std::vector<const char*> viewControllerNames;
+    std::map<std::string, std::string> exportedControllers;
+
+    //  The number given to the next placeholder proxy
+    int curPlaceholder;
+
+private:
+    ConversionContext* _previous;
+};
+
+ConversionContext& CurrentConversion();
+
+//  Converts inputFile, a xib or storyboard, to a nib at outputPath or, for a storyboard, to a directory of nibs at
+//  outputPath. Runs in its own ConversionContext.
+//
+//  Returns 0 on success, otherwise the exit code xib2nib reports for the failure.
+int ConvertFile(const char* inputFile, const char* outputPath);
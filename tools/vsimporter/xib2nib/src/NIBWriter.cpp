@@ -15,36 +15,37 @@
 //******************************************************************************
 
 #include "NIBWriter.h"
+#include "Conversion.h"
 #include "XIBObjectTypes.h"
 #include "UIRuntimeOutletConnection.h"
 #include "UIRuntimeEventConnection.h"
 #include "UIProxyObject.h"
 #include <assert.h>
+#include <string.h>
 #include <map>
+#include <string>
+#include <unordered_map>
 #include "UIViewController.h"
 #include "..\WBITelemetry\WBITelemetry.h"
 
-int curPlaceholder = 1;
-
 void NIBWriter::WriteInt(int val, int minlen) {
     int len = 0;
     while (val >= 0x80 || len < minlen - 1) {
-        int outByte = val & 0x7F;
+        _data.push_back(static_cast<unsigned char>(val & 0x7F));
         val >>= 7;
-        fwrite(&outByte, 1, 1, fpOut);
         len++;
     }
 
-    val |= 0x80;
-    fwrite(&val, 1, 1, fpOut);
+    _data.push_back(static_cast<unsigned char>(val | 0x80));
 }
 
 void NIBWriter::WriteByte(int byte) {
-    fwrite(&byte, 1, 1, fpOut);
+    _data.push_back(static_cast<unsigned char>(byte));
 }
 
-void NIBWriter::WriteBytes(void* bytes, int len) {
-    fwrite(bytes, 1, len, fpOut);
+void NIBWriter::WriteBytes(const void* bytes, int len) {
+    const unsigned char* pBytes = static_cast<const unsigned char*>(bytes);
+    _data.insert(_data.end(), pBytes, pBytes + len);
 }
 
 XIBObject* NIBWriter::AddOutputObject(XIBObject* pObj) {
@@ -67,10 +68,8 @@ XIBObject* NIBWriter::AddOutputObject(XIBObject* pObj) {
             pObj = GetProxyFor(pObj);
         }
     }
-    for (size_t i = 0; i < _outputObjects.size(); i++) {
-        if (_outputObjects[i] == pObj) {
-            return pObj;
-        }
+    if (!_outputObjectSet.insert(pObj).second) {
+        return pObj;
     }
 
     _outputObjects.push_back(pObj);
@@ -94,6 +93,7 @@ class StringCombiner {
 public:
     char** _stringTable;
     int _numStrings, _maxStrings;
+    std::unordered_map<std::string, int> _stringIndex;
 
     StringCombiner() {
         _numStrings = 0;
@@ -102,10 +102,9 @@ public:
     }
 
     int AddString(const char* str) {
-        for (int i = 0; i < _numStrings; i++) {
-            if (strcmp(_stringTable[i], str) == 0) {
-                return i;
-            }
+        std::unordered_map<std::string, int>::iterator found = _stringIndex.find(str);
+        if (found != _stringIndex.end()) {
+            return found->second;
         }
 
         if (_numStrings + 1 > _maxStrings) {
@@ -118,6 +117,7 @@ public:
 
         int ret = _numStrings;
         _numStrings++;
+        _stringIndex[str] = ret;
 
         return ret;
     }
@@ -140,7 +140,7 @@ NIBWriter::NIBWriter(FILE* out, XIBDictionary* externalReferences, XIBObject* ba
     _visibleWindows = NULL;
     fpOut = out;
 
-    curPlaceholder = 1;
+    CurrentConversion().curPlaceholder = 1;
     _baseObject = base;
 
     _allUIObjects = new XIBArray();
@@ -271,6 +271,7 @@ XIBObject* NIBWriter::GetProxyFor(XIBObject* obj) {
     UIProxyObject* newProxy = new UIProxyObject();
 
     char szName[255];
+    int& curPlaceholder = CurrentConversion().curPlaceholder;
     if (curPlaceholder == 2)
         curPlaceholder++;
     sprintf(szName, "UpstreamPlaceholder-%d", curPlaceholder++);
@@ -290,10 +291,8 @@ XIBObject* NIBWriter::GetProxyFor(XIBObject* obj) {
     return newProxy;
 }
 
-std::map<std::string, std::string> _g_exportedControllers;
-
 void NIBWriter::ExportAllControllers() {
-    for (const char* cur : UIViewController::_viewControllerNames) {
+    for (const char* cur : CurrentConversion().viewControllerNames) {
         ExportController(cur);
     }
 }
@@ -316,13 +315,14 @@ void NIBWriter::ExportController(const char* controllerId) {
     }
 
     //  Check if we've already written out the controller
-    if (_g_exportedControllers.find(controllerId) != _g_exportedControllers.end()) {
+    std::map<std::string, std::string>& exportedControllers = CurrentConversion().exportedControllers;
+    if (exportedControllers.find(controllerId) != exportedControllers.end()) {
         return;
     }
 
     sprintf(szFilename, "%s.nib", controllerIdentifier);
 
-    _g_exportedControllers[controllerIdentifier] = controllerIdentifier;
+    exportedControllers[controllerIdentifier] = controllerIdentifier;
 
     XIBArray* objects = (XIBArray*)controller->_parent;
 
@@ -353,24 +353,28 @@ void NIBWriter::ExportController(const char* controllerId) {
 }
 
 void NIBWriter::WriteData() {
-    fwrite("NIBArchive", 10, 1, fpOut);
-    int headerPos = ftell(fpOut);
+    _data.clear();
+    _data.reserve(64 * 1024);
+
+    WriteBytes("NIBArchive", 10);
+    int headerPos = static_cast<int>(_data.size());
 
     NIBHeader header = { 0 };
-    fwrite(&header, sizeof(header), 1, fpOut);
+    WriteBytes(&header, sizeof(header));
 
     //  Write out class names
     StringCombiner classNames;
-    header._classNamesOffset = ftell(fpOut);
+    header._classNamesOffset = static_cast<int>(_data.size());
 
     for (int i = 0; i < _outputObjects.size(); i++) {
         XIBObject* pObject = _outputObjects[i];
         if (pObject->_outputClassName == NULL) {
             printf("Unable to find class mapping for required object <%s>\n", pObject->_node.name());
             TELEMETRY_EVENT_DATA(L"MissingClassMapping", pObject->_node.name());
-            TELEMETRY_FLUSH();
 
-            exit(-1);
+            //  Fail this conversion without taking down the others a batch runs in the same process
+            CurrentConversion().failed = true;
+            return;
         }
         pObject->_outputClassNameIdx = classNames.AddString(pObject->_outputClassName);
         pObject->_outputObjectIdx = i;
@@ -382,16 +386,16 @@ void NIBWriter::WriteData() {
         WriteInt(len, 2);
         if (len == 0x1b) {
             int filler = 6;
-            fwrite(&filler, 1, 4, fpOut);
+            WriteBytes(&filler, 4);
         }
-        fwrite(pName, 1, len, fpOut);
+        WriteBytes(pName, len);
 
         header._numClassNames++;
     }
 
     //  Write out key names
     StringCombiner keyNames;
-    header._keyNamesOffset = ftell(fpOut);
+    header._keyNamesOffset = static_cast<int>(_data.size());
     for (int i = 0; i < _outputObjects.size(); i++) {
         XIBObject* pObject = _outputObjects[i];
 
@@ -404,13 +408,13 @@ void NIBWriter::WriteData() {
         char* pName = keyNames._stringTable[i];
         int len = strlen(pName) + 1;
         WriteInt(len, 1);
-        fwrite(pName, 1, len, fpOut);
+        WriteBytes(pName, len);
 
         header._numKeyNames++;
     }
 
     //  Write out items
-    header._itemsOffset = ftell(fpOut);
+    header._itemsOffset = static_cast<int>(_data.size());
     for (int i = 0; i < _outputObjects.size(); i++) {
         XIBObject* pObject = _outputObjects[i];
 
@@ -435,7 +439,7 @@ void NIBWriter::WriteData() {
     }
 
     //  Write out objects
-    header._objectsOffset = ftell(fpOut);
+    header._objectsOffset = static_cast<int>(_data.size());
     for (int i = 0; i < _outputObjects.size(); i++) {
         XIBObject* pObject = _outputObjects[i];
 
@@ -451,6 +455,6 @@ void NIBWriter::WriteData() {
         header._numObjects++;
     }
 
-    fseek(fpOut, headerPos, SEEK_SET);
-    fwrite(&header, sizeof(header), 1, fpOut);
+    memcpy(&_data[headerPos], &header, sizeof(header));
+    fwrite(_data.data(), 1, _data.size(), fpOut);
 }
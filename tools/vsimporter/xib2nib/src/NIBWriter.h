@@ -18,6 +18,8 @@
 #define __NIBWRITER_H
 
 #include <stdio.h>
+#include <unordered_set>
+#include <vector>
 #include "XIBObject.h"
 
 #define NIBOBJ_INT8 0x00
@@ -44,9 +46,13 @@ class XIBDictionary;
 class NIBWriter {
 private:
     xibList _outputObjects;
+    std::unordered_set<XIBObject*> _outputObjectSet;
     proxyList _proxies;
     FILE* fpOut;
 
+    //  The archive is assembled here and written to fpOut in one call once it is complete
+    std::vector<unsigned char> _data;
+
 public:
     XIBObject* _allUIObjects;
     XIBObject* _connections;
@@ -69,7 +75,7 @@ public:
 
     void WriteInt(int val, int minlen);
     void WriteByte(int byte);
-    void WriteBytes(void* bytes, int len);
+    void WriteBytes(const void* bytes, int len);
     void AddOutletConnection(XIBObject* src, XIBObject* dst, char* propName);
     XIBObject* FindProxy(char* propName);
     XIBObject* AddProxy(char* propName);
@@ -70,66 +70,98 @@
 #include "UIPongPressGestureRecognizer.h"
 
 #include <assert.h>
+#include <string.h>
+#include <unordered_map>
 
 #include "..\WBITelemetry\WBITelemetry.h"
 
-#define IS_CONVERTER(newinst, classnamevar, name, type) \
-    if (strcmp(classnamevar, name) == 0) {              \
-        newinst = new type();                           \
+namespace {
+typedef XIBObject* (*ConverterFactory)();
+
+template <typename T>
+XIBObject* CreateConverter() {
+    return new T();
+}
+
+// FNV-1a over the NUL-terminated class name, so lookups don't need to build a std::string per XML node
+struct ClassNameHash {
+    size_t operator()(const char* str) const {
+        size_t hash = 2166136261U;
+        for (; *str; str++) {
+            hash = (hash ^ static_cast<unsigned char>(*str)) * 16777619U;
+        }
+        return hash;
     }
-XIBObject* ObjectConverter::ConverterForObject(const char* className, pugi::xml_node node) {
-    XIBObject* ret = NULL;
+};
+
+struct ClassNameEqual {
+    bool operator()(const char* left, const char* right) const {
+        return strcmp(left, right) == 0;
+    }
+};
 
+typedef std::unordered_map<const char*, ConverterFactory, ClassNameHash, ClassNameEqual> ConverterRegistry;
+
+XIBObject* CreateRegisteredConverter(const ConverterRegistry& registry, const char* className) {
+    ConverterRegistry::const_iterator found = registry.find(className);
+    return found == registry.end() ? NULL : found->second();
+}
+}
+
+XIBObject* ObjectConverter::ConverterForObject(const char* className, pugi::xml_node node) {
     // NOTE: Legacy XIBs (pre-XCode5) are not really under active expansion. Developers can upgrade their XIBs to modern XIB format using
     // ibtool
-    IS_CONVERTER(ret, className, "IBCocoaTouchEventConnection", UIRuntimeEventConnection)
-    IS_CONVERTER(ret, className, "IBCocoaTouchOutletConnection", UIRuntimeOutletConnection)
-    IS_CONVERTER(ret, className, "IBCocoaTouchOutletCollectionConnection", UIRuntimeOutletCollectionConnection)
-    IS_CONVERTER(ret, className, "IBUICustomObject", ObjectConverterSwapper)
-    IS_CONVERTER(ret, className, "IBProxyObject", UIProxyObject)
-    IS_CONVERTER(ret, className, "IBUIView", UIView)
-    IS_CONVERTER(ret, className, "IBUIViewController", UIViewController)
-    IS_CONVERTER(ret, className, "NSColor", UIColor)
-    IS_CONVERTER(ret, className, "IBUIFontDescription", UIFont)
-    IS_CONVERTER(ret, className, "NSFont", UIFont)
-    IS_CONVERTER(ret, className, "IBUIButton", UIButton)
-    IS_CONVERTER(ret, className, "NSCustomResource", UICustomResource)
-    IS_CONVERTER(ret, className, "NSImage", UICustomResource)
-    IS_CONVERTER(ret, className, "IBUIWindow", UIWindow)
-    IS_CONVERTER(ret, className, "IBUIScrollView", UIScrollView)
-    IS_CONVERTER(ret, className, "IBUITableView", UITableView)
-    IS_CONVERTER(ret, className, "IBUINavigationBar", UINavigationBar)
-    IS_CONVERTER(ret, className, "IBUINavigationItem", UINavigationItem)
-    IS_CONVERTER(ret, className, "IBUIBarButtonItem", UIBarButtonItem)
-    IS_CONVERTER(ret, className, "IBUIImageView", UIImageView)
-    IS_CONVERTER(ret, className, "IBUILabel", UILabel)
-    IS_CONVERTER(ret, className, "IBUIAccessibilityConfiguration", UIRuntimeAccessibilityConfiguration)
-    IS_CONVERTER(ret, className, "IBUITableViewCell", UITableViewCell)
-    IS_CONVERTER(ret, className, "IBUITextField", UITextField)
-    IS_CONVERTER(ret, className, "IBUITextView", UITextView)
-    IS_CONVERTER(ret, className, "IBUIPickerView", UIPickerView)
-    IS_CONVERTER(ret, className, "IBUIPageControl", UIPageControl)
-    IS_CONVERTER(ret, className, "IBUIActivityIndicatorView", UIActivityIndicatorView)
-    IS_CONVERTER(ret, className, "IBUISwitch", UISwitch)
-    IS_CONVERTER(ret, className, "IBUIWebView", UIWebView)
-    IS_CONVERTER(ret, className, "IBUITabBarController", UITabBarController)
-    IS_CONVERTER(ret, className, "IBUINavigationController", UINavigationController)
-    IS_CONVERTER(ret, className, "IBUITableViewController", UITableViewController)
-    IS_CONVERTER(ret, className, "IBUITabBar", UITabBar)
-    IS_CONVERTER(ret, className, "IBUITabBarItem", UITabBarItem)
-    IS_CONVERTER(ret, className, "IBUIToolbar", UIToolbar)
-    IS_CONVERTER(ret, className, "IBUISegmentedControl", UISegmentedControl)
-    IS_CONVERTER(ret, className, "IBUIDatePicker", UIDatePicker)
-    IS_CONVERTER(ret, className, "IBUISearchBar", UISearchBar)
-    IS_CONVERTER(ret, className, "IBMKMapView", MKMapView)
-    IS_CONVERTER(ret, className, "IBUISearchDisplayController", UISearchDisplayController)
-    IS_CONVERTER(ret, className, "IBUISlider", UISlider)
-    IS_CONVERTER(ret, className, "IBNSLayoutConstraint", NSLayoutConstraint)
-
-    // Stubbed implementation
-    IS_CONVERTER(ret, className, "IBUIProgressView", UIProgressView)
-    IS_CONVERTER(ret, className, "IBUIPongPressGestureRecognizer", UIPongPressGestureRecognizer)
-
+    static const ConverterRegistry converters = {
+        { "IBCocoaTouchEventConnection", &CreateConverter<UIRuntimeEventConnection> },
+        { "IBCocoaTouchOutletConnection", &CreateConverter<UIRuntimeOutletConnection> },
+        { "IBCocoaTouchOutletCollectionConnection", &CreateConverter<UIRuntimeOutletCollectionConnection> },
+        { "IBUICustomObject", &CreateConverter<ObjectConverterSwapper> },
+        { "IBProxyObject", &CreateConverter<UIProxyObject> },
+        { "IBUIView", &CreateConverter<UIView> },
+        { "IBUIViewController", &CreateConverter<UIViewController> },
+        { "NSColor", &CreateConverter<UIColor> },
+        { "IBUIFontDescription", &CreateConverter<UIFont> },
+        { "NSFont", &CreateConverter<UIFont> },
+        { "IBUIButton", &CreateConverter<UIButton> },
+        { "NSCustomResource", &CreateConverter<UICustomResource> },
+        { "NSImage", &CreateConverter<UICustomResource> },
+        { "IBUIWindow", &CreateConverter<UIWindow> },
+        { "IBUIScrollView", &CreateConverter<UIScrollView> },
+        { "IBUITableView", &CreateConverter<UITableView> },
+        { "IBUINavigationBar", &CreateConverter<UINavigationBar> },
+        { "IBUINavigationItem", &CreateConverter<UINavigationItem> },
+        { "IBUIBarButtonItem", &CreateConverter<UIBarButtonItem> },
+        { "IBUIImageView", &CreateConverter<UIImageView> },
+        { "IBUILabel", &CreateConverter<UILabel> },
+        { "IBUIAccessibilityConfiguration", &CreateConverter<UIRuntimeAccessibilityConfiguration> },
+        { "IBUITableViewCell", &CreateConverter<UITableViewCell> },
+        { "IBUITextField", &CreateConverter<UITextField> },
+        { "IBUITextView", &CreateConverter<UITextView> },
+        { "IBUIPickerView", &CreateConverter<UIPickerView> },
+        { "IBUIPageControl", &CreateConverter<UIPageControl> },
+        { "IBUIActivityIndicatorView", &CreateConverter<UIActivityIndicatorView> },
+        { "IBUISwitch", &CreateConverter<UISwitch> },
+        { "IBUIWebView", &CreateConverter<UIWebView> },
+        { "IBUITabBarController", &CreateConverter<UITabBarController> },
+        { "IBUINavigationController", &CreateConverter<UINavigationController> },
+        { "IBUITableViewController", &CreateConverter<UITableViewController> },
+        { "IBUITabBar", &CreateConverter<UITabBar> },
+        { "IBUITabBarItem", &CreateConverter<UITabBarItem> },
+        { "IBUIToolbar", &CreateConverter<UIToolbar> },
+        { "IBUISegmentedControl", &CreateConverter<UISegmentedControl> },
+        { "IBUIDatePicker", &CreateConverter<UIDatePicker> },
+        { "IBUISearchBar", &CreateConverter<UISearchBar> },
+        { "IBMKMapView", &CreateConverter<MKMapView> },
+        { "IBUISearchDisplayController", &CreateConverter<UISearchDisplayController> },
+        { "IBUISlider", &CreateConverter<UISlider> },
+        { "IBNSLayoutConstraint", &CreateConverter<NSLayoutConstraint> },
+
+        // Stubbed implementation
+        { "IBUIProgressView", &CreateConverter<UIProgressView> },
+        { "IBUIPongPressGestureRecognizer", &CreateConverter<UIPongPressGestureRecognizer> }
+    };
+
+    XIBObject* ret = CreateRegisteredConverter(converters, className);
     if (ret == NULL) {
         ret = new XIBObject();
     }
@@ -140,74 +172,75 @@ XIBObject* ObjectConverter::ConverterForObject(const char* className, pugi::xml_
 }
 
 XIBObject* ObjectConverter::ConverterForStoryObject(const char* className, pugi::xml_node node) {
-    XIBObject* ret = NULL;
-
-    IS_CONVERTER(ret, className, "objects", XIBArray)
-    IS_CONVERTER(ret, className, "subviews", XIBArray)
-    IS_CONVERTER(ret, className, "constraints", XIBArray)
-    IS_CONVERTER(ret, className, "variation", XIBVariation)
-    IS_CONVERTER(ret, className, "items", XIBArray)
-    IS_CONVERTER(ret, className, "connections", XIBArray)
-    IS_CONVERTER(ret, className, "string", XIBObjectString)
-    IS_CONVERTER(ret, className, "viewController", UIViewController)
-    IS_CONVERTER(ret, className, "splitViewController", UIViewController)
-    IS_CONVERTER(ret, className, "placeholder", UIProxyObject)
-    IS_CONVERTER(ret, className, "tabBarController", UITabBarController)
-    IS_CONVERTER(ret, className, "navigationItem", UINavigationItem)
-    IS_CONVERTER(ret, className, "navigationBar", UINavigationBar)
-    IS_CONVERTER(ret, className, "navigationController", UINavigationController)
-    IS_CONVERTER(ret, className, "tabBarItem", UITabBarItem)
-    IS_CONVERTER(ret, className, "tabBar", UITabBar)
-    IS_CONVERTER(ret, className, "view", UIView)
-    IS_CONVERTER(ret, className, "scrollView", UIScrollView)
-    IS_CONVERTER(ret, className, "label", UILabel)
-    IS_CONVERTER(ret, className, "toolbar", UIToolbar)
-    IS_CONVERTER(ret, className, "color", UIColor)
-    IS_CONVERTER(ret, className, "barButtonItem", UIBarButtonItem)
-    IS_CONVERTER(ret, className, "outlet", UIRuntimeOutletConnection)
-    IS_CONVERTER(ret, className, "outletCollection", UIRuntimeOutletCollectionConnection)
-    IS_CONVERTER(ret, className, "segue", UIStoryboardSegue)
-    IS_CONVERTER(ret, className, "fontDescription", UIFont)
-    IS_CONVERTER(ret, className, "tableViewController", UITableViewController)
-    IS_CONVERTER(ret, className, "tableView", UITableView)
-    IS_CONVERTER(ret, className, "tableViewCell", UITableViewCell)
-    IS_CONVERTER(ret, className, "tableViewCellContentView", UITableViewCellContentView)
-    IS_CONVERTER(ret, className, "textField", UITextField)
-    IS_CONVERTER(ret, className, "textView", UITextView)
-    IS_CONVERTER(ret, className, "button", UIButton)
-    IS_CONVERTER(ret, className, "webView", UIWebView)
-    IS_CONVERTER(ret, className, "searchBar", UISearchBar)
-    IS_CONVERTER(ret, className, "searchDisplayController", UISearchDisplayController)
-    IS_CONVERTER(ret, className, "activityIndicatorView", UIActivityIndicatorView)
-    IS_CONVERTER(ret, className, "imageView", UIImageView)
-    IS_CONVERTER(ret, className, "action", UIRuntimeEventConnection)
-    IS_CONVERTER(ret, className, "switch", UISwitch)
-    IS_CONVERTER(ret, className, "constraint", NSLayoutConstraint)
-    IS_CONVERTER(ret, className, "layoutGuides", XIBVariation)
-    IS_CONVERTER(ret, className, "viewControllerLayoutGuide", _UILayoutGuide)
-    IS_CONVERTER(ret, className, "datePicker", UIDatePicker)
-    IS_CONVERTER(ret, className, "slider", UISlider)
-    IS_CONVERTER(ret, className, "collectionReusableView", UICollectionReusableView)
-    IS_CONVERTER(ret, className, "collectionViewCell", UICollectionViewCell)
-    IS_CONVERTER(ret, className, "collectionView", UICollectionView)
-    IS_CONVERTER(ret, className, "collectionViewController", UICollectionViewController)
-    IS_CONVERTER(ret, className, "pickerView", UIPickerView)
-    IS_CONVERTER(ret, className, "segmentedControl", UISegmentedControl)
-    IS_CONVERTER(ret, className, "stepper", UIStepper)
-    IS_CONVERTER(ret, className, "panGestureRecognizer", UIPanGestureRecognizer)
-    IS_CONVERTER(ret, className, "swipeGestureRecognizer", UISwipeGestureRecognizer)
-    IS_CONVERTER(ret, className, "tapGestureRecognizer", UITapGestureRecognizer)
-    IS_CONVERTER(ret, className, "window", UIWindow)
-
-    // Stubbed mapping - full functionality is not provided but these stubs will unblock the import process
-    IS_CONVERTER(ret, className, "pageControl", UIPageControl)
-    IS_CONVERTER(ret, className, "mapView", MKMapView)
-    IS_CONVERTER(ret, className, "stackView", UIStackView)
-    IS_CONVERTER(ret, className, "progressView", UIProgressView)
-    IS_CONVERTER(ret, className, "pongPressGestureRecognizer", UIPongPressGestureRecognizer)
-
-    IS_CONVERTER(ret, className, "customObject", ObjectConverterSwapper)
-
+    static const ConverterRegistry converters = {
+        { "objects", &CreateConverter<XIBArray> },
+        { "subviews", &CreateConverter<XIBArray> },
+        { "constraints", &CreateConverter<XIBArray> },
+        { "variation", &CreateConverter<XIBVariation> },
+        { "items", &CreateConverter<XIBArray> },
+        { "connections", &CreateConverter<XIBArray> },
+        { "string", &CreateConverter<XIBObjectString> },
+        { "viewController", &CreateConverter<UIViewController> },
+        { "splitViewController", &CreateConverter<UIViewController> },
+        { "placeholder", &CreateConverter<UIProxyObject> },
+        { "tabBarController", &CreateConverter<UITabBarController> },
+        { "navigationItem", &CreateConverter<UINavigationItem> },
+        { "navigationBar", &CreateConverter<UINavigationBar> },
+        { "navigationController", &CreateConverter<UINavigationController> },
+        { "tabBarItem", &CreateConverter<UITabBarItem> },
+        { "tabBar", &CreateConverter<UITabBar> },
+        { "view", &CreateConverter<UIView> },
+        { "scrollView", &CreateConverter<UIScrollView> },
+        { "label", &CreateConverter<UILabel> },
+        { "toolbar", &CreateConverter<UIToolbar> },
+        { "color", &CreateConverter<UIColor> },
+        { "barButtonItem", &CreateConverter<UIBarButtonItem> },
+        { "outlet", &CreateConverter<UIRuntimeOutletConnection> },
+        { "outletCollection", &CreateConverter<UIRuntimeOutletCollectionConnection> },
+        { "segue", &CreateConverter<UIStoryboardSegue> },
+        { "fontDescription", &CreateConverter<UIFont> },
+        { "tableViewController", &CreateConverter<UITableViewController> },
+        { "tableView", &CreateConverter<UITableView> },
+        { "tableViewCell", &CreateConverter<UITableViewCell> },
+        { "tableViewCellContentView", &CreateConverter<UITableViewCellContentView> },
+        { "textField", &CreateConverter<UITextField> },
+        { "textView", &CreateConverter<UITextView> },
+        { "button", &CreateConverter<UIButton> },
+        { "webView", &CreateConverter<UIWebView> },
+        { "searchBar", &CreateConverter<UISearchBar> },
+        { "searchDisplayController", &CreateConverter<UISearchDisplayController> },
+        { "activityIndicatorView", &CreateConverter<UIActivityIndicatorView> },
+        { "imageView", &CreateConverter<UIImageView> },
+        { "action", &CreateConverter<UIRuntimeEventConnection> },
+        { "switch", &CreateConverter<UISwitch> },
+        { "constraint", &CreateConverter<NSLayoutConstraint> },
+        { "layoutGuides", &CreateConverter<XIBVariation> },
+        { "viewControllerLayoutGuide", &CreateConverter<_UILayoutGuide> },
+        { "datePicker", &CreateConverter<UIDatePicker> },
+        { "slider", &CreateConverter<UISlider> },
+        { "collectionReusableView", &CreateConverter<UICollectionReusableView> },
+        { "collectionViewCell", &CreateConverter<UICollectionViewCell> },
+        { "collectionView", &CreateConverter<UICollectionView> },
+        { "collectionViewController", &CreateConverter<UICollectionViewController> },
+        { "pickerView", &CreateConverter<UIPickerView> },
+        { "segmentedControl", &CreateConverter<UISegmentedControl> },
+        { "stepper", &CreateConverter<UIStepper> },
+        { "panGestureRecognizer", &CreateConverter<UIPanGestureRecognizer> },
+        { "swipeGestureRecognizer", &CreateConverter<UISwipeGestureRecognizer> },
+        { "tapGestureRecognizer", &CreateConverter<UITapGestureRecognizer> },
+        { "window", &CreateConverter<UIWindow> },
+
+        // Stubbed mapping - full functionality is not provided but these stubs will unblock the import process
+        { "pageControl", &CreateConverter<UIPageControl> },
+        { "mapView", &CreateConverter<MKMapView> },
+        { "stackView", &CreateConverter<UIStackView> },
+        { "progressView", &CreateConverter<UIProgressView> },
+        { "pongPressGestureRecognizer", &CreateConverter<UIPongPressGestureRecognizer> },
+
+        { "customObject", &CreateConverter<ObjectConverterSwapper> }
+    };
+
+    XIBObject* ret = CreateRegisteredConverter(converters, className);
     if (ret == NULL) {
         TELEMETRY_EVENT_DATA(L"UnRecognizedTag", className);
         ret = new XIBObject();
@@ -14,6 +14,7 @@
 //
 //******************************************************************************
 
+#include "Conversion.h"
 #include "UIViewController.h"
 #include "UIStoryboardSegue.h"
 #include "UINavigationItem.h"
@@ -25,7 +26,6 @@ static PropertyMapper propertyMappings[] = {
 };
 
 static const int numPropertyMappings = sizeof(propertyMappings) / sizeof(PropertyMapper);
-viewControllerList UIViewController::_viewControllerNames;
 
 UIViewController::UIViewController() {
     _childViewControllers = new XIBArray();
@@ -62,7 +62,7 @@ void UIViewController::InitFromStory(XIBObject* obj) {
     ObjectConverterSwapper::InitFromStory(obj);
     _view = (UIView*)obj->FindMemberAndHandle("view");
 
-    _viewControllerNames.push_back(_id);
+    CurrentConversion().viewControllerNames.push_back(_id);
 
     if (getAttrib("storyboardIdentifier")) {
         _storyboardIdentifier = getAttrAndHandle("storyboardIdentifier");
@@ -22,8 +22,6 @@ class UINavigationItem;
 class UINavigationBar;
 class UITabBarItem;
 
-typedef std::vector<const char*> viewControllerList;
-
 class UIViewController : public ObjectConverterSwapper {
 public:
     UINavigationItem* _navigationItem;
@@ -34,7 +32,6 @@ public:
     XIBArray* _segueTemplates;
     bool _resizesToFullSize;
     const char* _storyboardIdentifier;
-    static viewControllerList _viewControllerNames;
 
     UIViewController();
     virtual void InitFromXIB(XIBObject* obj);
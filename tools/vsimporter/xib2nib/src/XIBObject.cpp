@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include "Conversion.h"
 #include "XIBObject.h"
 #include "NIBWriter.h"
 #include "XIBObjectTypes.h"
@@ -66,8 +67,6 @@ XIBMember::XIBMember() {
     _obj = NULL;
 }
 
-xibList XIBObject::_allObjs;
-
 void XIBObject::AddOutputMember(NIBWriter* writer, const char* keyName, XIBObject* obj) {
     XIBMember* pNewMember = new XIBMember();
     XIBObject* addObj = writer->AddOutputObject(obj);
@@ -170,7 +169,7 @@ XIBObject::XIBObject() {
 }
 
 void XIBObject::ScanXIBNode(pugi::xml_node node) {
-    _allObjs.push_back(this);
+    CurrentConversion().allObjects.push_back(this);
 
     _node = node;
     _needsConversion = true;
@@ -208,52 +207,52 @@ void XIBObject::ScanXIBNode(pugi::xml_node node) {
             } else if (strcmp(curNode.name(), "string") == 0) {
                 XIBObject* str = new XIBObjectString(curNode.child_value());
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "integer") == 0) {
                 XIBObject* str = new XIBObjectInt(atoi(curNode.attribute("value").value()));
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "int") == 0) {
                 XIBObject* str = new XIBObjectInt(atoi(curNode.child_value()));
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "bool") == 0) {
                 XIBObject* str = new XIBObjectBool(curNode);
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "boolean") == 0) {
                 XIBObject* str = new XIBObjectBool(curNode);
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "bytes") == 0) {
                 XIBObject* str = new XIBObjectData(curNode.child_value());
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "nil") == 0) {
                 XIBObject* str = new XIBObjectNil();
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "real") == 0) {
                 XIBObject* str = new XIBObjectReal(curNode);
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "float") == 0) {
                 XIBObject* str = new XIBObjectFloat(curNode);
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "double") == 0) {
                 XIBObject* str = new XIBObjectDouble(curNode);
                 str->_id = getNodeAttrib(curNode, "id");
-                _allObjs.push_back(str);
+                CurrentConversion().allObjects.push_back(str);
                 AddMember(keyName, str);
             } else if (strcmp(curNode.name(), "array") == 0) {
                 XIBObject* subObj = new XIBArray(curNode);
@@ -271,7 +270,7 @@ void XIBObject::ScanXIBNode(pugi::xml_node node) {
 }
 
 void XIBObject::ScanStoryObjects(pugi::xml_node node) {
-    _allObjs.push_back(this);
+    CurrentConversion().allObjects.push_back(this);
     _node = node;
     _needsConversion = true;
     _swappedClassName = NULL;
@@ -527,9 +526,10 @@ void XIBObject::ResolveReferences() {
 }
 
 XIBObject* XIBObject::findReference(const char* id) {
-    xibList::iterator cur = _allObjs.begin();
+    xibList& allObjects = CurrentConversion().allObjects;
+    xibList::iterator cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         if ((*cur)->_id == NULL)
             continue;
         if (strcmp((*cur)->_id, id) == 0)
@@ -540,41 +540,43 @@ XIBObject* XIBObject::findReference(const char* id) {
 }
 
 void XIBObject::ParseAllXIBMembers() {
-    xibList::iterator cur = _allObjs.begin();
+    xibList& allObjects = CurrentConversion().allObjects;
+    xibList::iterator cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->ResolveReferences();
     }
 
-    cur = _allObjs.begin();
+    cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->InitFromXIB((*cur));
     }
 
-    cur = _allObjs.begin();
+    cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->Awaken();
     }
 }
 
 void XIBObject::ParseAllStoryMembers() {
-    xibList::iterator cur = _allObjs.begin();
+    xibList& allObjects = CurrentConversion().allObjects;
+    xibList::iterator cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->ResolveReferences();
     }
 
-    cur = _allObjs.begin();
+    cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->InitFromStory((*cur));
     }
 
-    cur = _allObjs.begin();
+    cur = allObjects.begin();
 
-    for (; cur != _allObjs.end(); cur++) {
+    for (; cur != allObjects.end(); cur++) {
         (*cur)->Awaken();
     }
 }
@@ -596,18 +598,16 @@ void XIBObject::ConvertStaticMappings(NIBWriter* writer, XIBObject* obj) {
 void XIBObject::Awaken() {
 }
 
-std::unordered_set<size_t> XIBObject::_handledNodes;
-
 void XIBObject::setNodeHandled(pugi::xml_node node) {
-    _handledNodes.insert(node.hash_value());
+    CurrentConversion().handledNodes.insert(node.hash_value());
 }
 
 void XIBObject::setAttrHandled(pugi::xml_attribute attr) {
-    _handledNodes.insert(attr.hash_value());
+    CurrentConversion().handledNodes.insert(attr.hash_value());
 }
 
 void XIBObject::setMemberHandled(XIBObject* member) {
-    _handledNodes.insert(member->_node.hash_value());
+    CurrentConversion().handledNodes.insert(member->_node.hash_value());
 }
 
 void XIBObject::setMemberHandledByName(char* name) {
@@ -632,7 +632,7 @@ void XIBObject::getDocumentCoverage(pugi::xml_document& doc) {
 
         // Callback that is called for each node traversed
         bool for_each(pugi::xml_node& node) {
-            if (!_handledNodes.count(node.hash_value())) {
+            if (!CurrentConversion().handledNodes.count(node.hash_value())) {
                 const char* key = _getNodeAttrib(node, "key", false);
                 printf("Unhandled node:%s:%s\n", node.path().c_str(), key ? key : _getNodeValue(node));
             }
@@ -640,7 +640,7 @@ void XIBObject::getDocumentCoverage(pugi::xml_document& doc) {
             for (pugi::xml_attribute_iterator iter = node.attributes_begin(); iter != node.attributes_end(); iter++) {
                 pugi::xml_attribute attr = *iter;
 
-                if (!_handledNodes.count(attr.hash_value())) {
+                if (!CurrentConversion().handledNodes.count(attr.hash_value())) {
                     const char* key = _getNodeAttrib(node, "key", false);
                     printf("Unhandled attribute:%s:%s:%s:%s\n", node.path().c_str(), key, attr.name(), attr.value());
                 }
@@ -73,7 +73,6 @@ public:
     XIBObject* _parent;
     xibList _variations;
 
-    static xibList _allObjs;
     bool _ignoreUIObject;
 
 public:
@@ -141,7 +140,6 @@ public:
     void AddInt(NIBWriter* writer, char* pPropName, int val);
     void AddBool(NIBWriter* writer, char* pPropName, bool val);
 
-    static std::unordered_set<size_t> _handledNodes;
     static void setNodeHandled(pugi::xml_node node);
     static void setAttrHandled(pugi::xml_attribute attr);
     static void setMemberHandled(XIBObject* member);
@@ -17,6 +17,7 @@
 // Xib2Nib.cpp.cpp : Defines the entry point for the console application.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <vector>
 #include <direct.h>
@@ -24,6 +25,8 @@
 #include <map>
 #include <filesystem>
 
+#include "BatchConverter.h"
+#include "Conversion.h"
 #include "XIBObject.h"
 #include "XIBObjectTypes.h"
 #include "XIBDocument.h"
@@ -34,23 +37,6 @@
 
 #include "..\WBITelemetry\WBITelemetry.h"
 
-// These globals should only be employed when dealing with storyboard files (.storyboard)
-// They are only set once when we determine that the input format is a storyboard
-bool g_isStoryboard = false;
-static char g_outputDirectory[4096];
-
-bool IsStoryboardConversion() {
-    return g_isStoryboard;
-}
-
-std::string GetOutputFilename(const char* filename) {
-    std::string ret = std::string(g_outputDirectory) + "\\" + std::string(filename);
-
-    return ret;
-}
-
-extern std::map<std::string, std::string> _g_exportedControllers;
-
 void ConvertStoryboard(pugi::xml_document& doc) {
     pugi::xml_node curNode = doc.first_child();
 
@@ -76,7 +62,7 @@ void ConvertStoryboard(pugi::xml_document& doc) {
     viewControllerInfo[std::string("UIStoryboardVersion")] = (int)1;
 
     Plist::dictionary_type viewControllerMappings;
-    for (auto curController : _g_exportedControllers) {
+    for (auto curController : CurrentConversion().exportedControllers) {
         viewControllerMappings[curController.first] = curController.second;
     }
     viewControllerInfo[std::string("UIViewControllerIdentifiersToNibNames")] = viewControllerMappings;
@@ -238,72 +224,48 @@ void ConvertXIBToNib(FILE* fpOut, pugi::xml_document& doc) {
     writer->WriteData();
 }
 
-int main(int argc, char* argv[]) {
-    TELEMETRY_INIT(L"AIF-47606e3a-4264-4368-8f7f-ed6ec3366dca");
-
-    if (checkTelemetryOptIn()) {
-        TELEMETRY_ENABLE();
-    } else {
-        TELEMETRY_DISABLE();
-    }
-
-    TELEMETRY_SET_INTERNAL(isMSFTInternalMachine());
-    string machineID = getMachineID();
-    if (!machineID.empty()) {
-        TELEMETRY_SET_MACHINEID(machineID.c_str());
-    }
-
-    TELEMETRY_EVENT_DATA(L"Xib2NibStart", getProductVersion().c_str());
+int ConvertFile(const char* inputFile, const char* outputPath) {
+    ConversionContext context;
 
     pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(argv[1]);
+    pugi::xml_parse_result result = doc.load_file(inputFile);
     if (!result) {
-        printf("Error opening %s\n", argv[1]);
-        TELEMETRY_FLUSH();
-        exit(2);
-        return -1;
+        printf("Error opening %s\n", inputFile);
+        return 2;
     }
 
     pugi::xml_node rootNode = doc.first_child();
     const char* type = getNodeAttrib(rootNode, "type");
     if (!type) {
         printf("Unable to find input type\n");
-        TELEMETRY_FLUSH();
-        exit(3);
-        return -1;
+        return 3;
     }
     if (strcmp(rootNode.name(), "document") == 0 && strcmp(type, "com.apple.InterfaceBuilder3.CocoaTouch.Storyboard.XIB") == 0) {
-        if (argc < 3) {
+        if (!outputPath) {
             printf("Usage: xib2nib input.storyboard <outputdir>\n");
-            TELEMETRY_FLUSH();
-            exit(1);
-            return -1;
+            return 1;
         }
 
         struct stat st = { 0 };
-        stat(argv[2], &st);
-        if (!(((st.st_mode) & S_IFMT) == S_IFDIR) && _mkdir(argv[2]) != 0) {
-            printf("Unable to create directory %s err=%d\n", argv[2], errno);
+        stat(outputPath, &st);
+        if (!(((st.st_mode) & S_IFMT) == S_IFDIR) && _mkdir(outputPath) != 0) {
+            printf("Unable to create directory %s err=%d\n", outputPath, errno);
             return -1;
         }
 
-        g_isStoryboard = true;
-        strcpy_s(g_outputDirectory, arraySize(g_outputDirectory), argv[2]);
+        context.isStoryboard = true;
+        context.outputDirectory = outputPath;
         ConvertStoryboard(doc);
     } else if (strstr(type, ".XIB") != NULL) {
-        if (argc < 3) {
+        if (!outputPath) {
             printf("Usage: xib2nib input.xib output.nib\n");
-            TELEMETRY_FLUSH();
-            exit(1);
-            return -1;
+            return 1;
         }
 
-        FILE* fpOut = fopen(argv[2], "wb");
+        FILE* fpOut = fopen(outputPath, "wb");
         if (!fpOut) {
-            printf("Error opening %s\n", argv[2]);
-            TELEMETRY_FLUSH();
-            exit(3);
-            return -1;
+            printf("Error opening %s\n", outputPath);
+            return 3;
         }
 
         if (strcmp(rootNode.name(), "document") == 0) {
@@ -314,8 +276,66 @@ int main(int argc, char* argv[]) {
         fclose(fpOut);
     } else {
         printf("Unable to determine input type type=\"%s\"\n", type);
+        return 4;
+    }
+
+    return context.failed ? -1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    TELEMETRY_INIT(L"AIF-47606e3a-4264-4368-8f7f-ed6ec3366dca");
+
+    if (checkTelemetryOptIn()) {
+        TELEMETRY_ENABLE();
+    } else {
+        TELEMETRY_DISABLE();
+    }
+
+    TELEMETRY_SET_INTERNAL(isMSFTInternalMachine());
+    string machineID = getMachineID();
+    if (!machineID.empty()) {
+        TELEMETRY_SET_MACHINEID(machineID.c_str());
+    }
+
+    TELEMETRY_EVENT_DATA(L"Xib2NibStart", getProductVersion().c_str());
+
+    if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+        const char* listFile = NULL;
+        const char* cacheFile = NULL;
+        unsigned int jobs = 0;
+
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+                cacheFile = argv[++i];
+            } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+                jobs = strtoul(argv[++i], NULL, 10);
+            } else if (!listFile) {
+                listFile = argv[i];
+            } else {
+                listFile = NULL;
+                break;
+            }
+        }
+
+        if (!listFile) {
+            printf("Usage: xib2nib --batch inputs.txt [--cache <cachefile>] [--jobs <count>]\n");
+            TELEMETRY_FLUSH();
+            exit(1);
+            return -1;
+        }
+
+        int failed = RunBatchConversion(listFile, cacheFile, jobs);
+
+        TELEMETRY_EVENT_DATA(L"Xib2NibFinish", getProductVersion().c_str());
+        TELEMETRY_FLUSH();
+
+        exit(failed == 0 ? 0 : 5);
+    }
+
+    int result = ConvertFile(argv[1], argc >= 3 ? argv[2] : NULL);
+    if (result != 0) {
         TELEMETRY_FLUSH();
-        exit(4);
+        exit(result);
         return -1;
     }
 